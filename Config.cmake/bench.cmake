@@ -0,0 +1,32 @@
+#    Copyright (C) 2012 Modelon AB
+
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the BSD style license.
+
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    FMILIB_License.txt file for more details.
+
+#    You should have received a copy of the FMILIB_License.txt file
+#    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+
+# fmilib_bench measures unzip, XML parsing, variable lookup, variable lists and
+# FMI call overhead and writes the results as JSON. It uses the internal unzip
+# function and is therefore linked with the static library.
+if(FMILIB_BUILD_STATIC_LIB)
+	add_executable (fmilib_bench
+		${RTTESTDIR}/Bench/fmilib_bench.c
+		${RTTESTDIR}/Bench/fmi_bench_model.c
+		${RTTESTDIR}/Bench/fmi_bench_model.h)
+	target_link_libraries (fmilib_bench fmilib)
+	set_target_properties(fmilib_bench PROPERTIES FOLDER "Test")
+
+	# Short run to check that the benchmark works, e.g.,
+	# fmilib_bench <fmu> <dir> -n 100000 -r 5 -o bench.json for actual measurements
+	add_test(ctest_fmilib_bench fmilib_bench ${FMU2_CS_PATH} ${FMU_TEMPFOLDER}
+		-n 1000 -r 2 -c 1000 -o ${TEST_OUTPUT_FOLDER}/fmilib_bench.json)
+	if(FMILIB_BUILD_BEFORE_TESTS)
+		set_tests_properties(ctest_fmilib_bench PROPERTIES DEPENDS ctest_build_all)
+	endif()
+endif()
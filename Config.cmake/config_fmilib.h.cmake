@@ -119,6 +119,17 @@ It is redefined to "." for Makefile based build environments. Otherwise is set b
 \brief Activates debug level log messages. If not defined the debug messages are compiled out. 
 */
 
+#cmakedefine FMILIB_ENABLE_CALL_STATISTICS
+#ifndef FMILIB_ENABLE_CALL_STATISTICS
+/* Just for doxygen */
+#define FMILIB_ENABLE_CALL_STATISTICS
+#undef FMILIB_ENABLE_CALL_STATISTICS
+#endif
+/** 
+\def FMILIB_ENABLE_CALL_STATISTICS
+\brief Activates collection of per instance timing statistics of the FMI function calls. If not defined the instrumentation is compiled out. 
+*/
+
 #if defined _MSC_VER
 	#define FMILIB_SIZET_FORMAT "%Iu"
 #else 
@@ -41,6 +41,19 @@ set(FMIIMPORT_PUBHEADERS
 	include/FMI2/fmi2_import_variable.h
 	include/FMI2/fmi2_import_variable_list.h
 	include/FMI2/fmi2_import_convenience.h
+	include/FMI2/fmi2_import_me_driver.h
+	include/FMI2/fmi2_import_jacobian.h
+	include/FMI2/fmi2_import_dependency_graph.h
+	include/FMI2/fmi2_import_cosim_master.h
+	include/FMI2/fmi2_import_async.h
+	include/FMI2/fmi2_import_log_filter.h
+	include/FMI2/fmi2_import_selection.h
+	include/FMI2/fmi2_import_component.h
+	include/FMI2/fmi2_import_state_ring.h
+	include/FMI2/fmi2_import_state_store.h
+	include/FMI2/fmi2_import_warm_start.h
+	include/FMI2/fmi2_import_result_writer.h
+	include/FMI2/fmi2_import_mat_writer.h
 
 	include/FMI/fmi_import_context.h
 	include/FMI/fmi_import_util.h
@@ -52,6 +65,8 @@ set(FMIIMPORT_PRIVHEADERS
 
 	src/FMI2/fmi2_import_impl.h
 	src/FMI2/fmi2_import_variable_list_impl.h
+	src/FMI2/fmi2_import_me_driver_impl.h
+	src/FMI2/fmi2_import_sparse_lu.h
  )
  
 PREFIXLIST(FMIIMPORT_PRIVHEADERS ${FMIIMPORTDIR}/)
@@ -83,12 +98,27 @@ set(FMIIMPORTSOURCE
 	src/FMI2/fmi2_import_variable_list.c
 	src/FMI2/fmi2_import.c
 	src/FMI2/fmi2_import_convenience.c
+	src/FMI2/fmi2_import_me_driver.c
+	src/FMI2/fmi2_import_jacobian.c
+	src/FMI2/fmi2_import_dependency_graph.c
+	src/FMI2/fmi2_import_sparse_lu.c
+	src/FMI2/fmi2_import_me_bdf.c
+	src/FMI2/fmi2_import_cosim_master.c
+	src/FMI2/fmi2_import_async.c
+	src/FMI2/fmi2_import_log_filter.c
+	src/FMI2/fmi2_import_selection.c
+	src/FMI2/fmi2_import_component.c
+	src/FMI2/fmi2_import_state_ring.c
+	src/FMI2/fmi2_import_state_store.c
+	src/FMI2/fmi2_import_warm_start.c
+	src/FMI2/fmi2_import_result_writer.c
+	src/FMI2/fmi2_import_mat_writer.c
 	)
 
 PREFIXLIST(FMIIMPORTSOURCE  ${FMIIMPORTDIR}/)
 
 add_library(fmiimport ${FMILIBKIND} ${FMIIMPORTSOURCE} ${FMIIMPORTHEADERS})
-target_link_libraries(fmiimport ${JMUTIL_LIBRARIES} ${FMIXML_LIBRARIES} ${FMIZIP_LIBRARIES} ${FMICAPI_LIBRARIES})
+target_link_libraries(fmiimport ${JMUTIL_LIBRARIES} ${FMIXML_LIBRARIES} ${FMIZIP_LIBRARIES} ${FMICAPI_LIBRARIES} zlib)
 #target_link_libraries(fmiimportshared fmiimport)
 
 #add_library(fmiimport_shared SHARED ${FMIIMPORTSOURCE} ${FMIIMPORTHEADERS} )
@@ -25,6 +25,7 @@
 #include "fmilib_config.h"
 
 #include <FMI/fmi_import_context.h>
+#include <JM/jm_trace.h>
 #include <FMI1/fmi1_import.h>
 #include <FMI2/fmi2_import.h>
 
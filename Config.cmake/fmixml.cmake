@@ -44,6 +44,7 @@ set(FMIXMLHEADERS
     include/FMI2/fmi2_xml_model_structure.h
     src/FMI2/fmi2_xml_model_structure_impl.h
     src/FMI2/fmi2_xml_parser.h
+    src/FMI2/fmi2_xml_query.h
     include/FMI2/fmi2_xml_type.h
     src/FMI2/fmi2_xml_type_impl.h
     include/FMI2/fmi2_xml_unit.h
@@ -71,6 +72,7 @@ set(FMIXMLSOURCE
     src/FMI2/fmi2_xml_unit.c
 	src/FMI2/fmi2_xml_vendor_annotations.c
 	src/FMI2/fmi2_xml_variable.c
+    src/FMI2/fmi2_xml_query.c
 )
 
 SET(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} -DXML_STATIC -DFMI_XML_QUERY")
@@ -22,6 +22,14 @@ set(JMUTILSOURCE
  JM/jm_templates_inst.c
  JM/jm_named_ptr.c
  JM/jm_portability.c
+ JM/jm_thread.c
+ JM/jm_thread_pool.c
+ JM/jm_spill_file.c
+ JM/jm_call_statistics.c
+ JM/jm_trace.c
+ JM/jm_memory_accounting.c
+ JM/jm_pointer_map.c
+ JM/jm_log_sink.c
  FMI/fmi_version.c
  FMI/fmi_util.c
  
@@ -38,6 +46,14 @@ set(JMUTILHEADERS
   JM/jm_named_ptr.h
   JM/jm_string_set.h
   JM/jm_portability.h
+  JM/jm_thread.h
+  JM/jm_thread_pool.h
+  JM/jm_spill_file.h
+ JM/jm_call_statistics.h
+ JM/jm_trace.h
+ JM/jm_memory_accounting.h
+ JM/jm_pointer_map.h
+ JM/jm_log_sink.h
   FMI/fmi_version.h
   FMI/fmi_util.h
 
@@ -63,7 +79,7 @@ endif(CYGWIN)
 target_link_libraries(jmutils c99snprintf)
 
 if(UNIX) 
-	target_link_libraries(jmutils dl)
+	target_link_libraries(jmutils dl m pthread)
 endif(UNIX)
 if(WIN32)
 	target_link_libraries(jmutils Shlwapi)
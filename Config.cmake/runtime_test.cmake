@@ -158,6 +158,8 @@ ADD_TEST(ctest_fmi_zip_zip_test fmi_zip_zip_test)
 
 include(test_fmi1)
 include(test_fmi2)
+include(test_fmu_scalable)
+include(bench)
 
 ADD_TEST(ctest_fmi_import_test_no_xml fmi_import_test ${UNCOMPRESSED_DUMMY_FILE_PATH_SRC} ${TEST_OUTPUT_FOLDER})	
   set_tests_properties(ctest_fmi_import_test_no_xml PROPERTIES WILL_FAIL TRUE)
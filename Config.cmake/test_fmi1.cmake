@@ -103,6 +103,11 @@ set(logger_reference_file "${RTTESTDIR}/FMI1/fmi1_logger_test_output.txt")
 add_test(ctest_fmi1_logger_test_run fmi1_logger_test ${FMU_ME_PATH} ${FMU_TEMPFOLDER} ${logger_output_file})
 add_test(ctest_fmi1_logger_test_check ${CMAKE_COMMAND} -E compare_files ${logger_output_file}  ${logger_reference_file})
 
+##Add log forwarding stress test
+add_executable (fmi1_log_registry_test ${RTTESTDIR}/FMI1/fmi1_log_registry_test.c)
+target_link_libraries (fmi1_log_registry_test  ${FMILIBFORTEST})
+add_test(ctest_fmi1_log_registry_test fmi1_log_registry_test ${FMU_ME_PATH} ${FMU_TEMPFOLDER})
+
 set_target_properties(
 	fmi_import_me_test 
 	fmi_import_cs_test 
@@ -110,6 +115,7 @@ set_target_properties(
 	fmi1_capi_cs_test
 	fmi1_capi_me_test
 	fmi1_logger_test
+	fmi1_log_registry_test
     PROPERTIES FOLDER "Test/FMI1")
 
 SET_TESTS_PROPERTIES ( 
@@ -127,6 +133,7 @@ if(FMILIB_BUILD_BEFORE_TESTS)
 		ctest_fmi1_capi_cs_test
 		ctest_fmi1_capi_me_test
 		ctest_fmi1_logger_test_run
+		ctest_fmi1_log_registry_test
 		PROPERTIES DEPENDS ctest_build_all)
 endif()
 
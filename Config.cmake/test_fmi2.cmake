@@ -68,9 +68,62 @@ add_executable (fmi2_import_me_test ${RTTESTDIR}/FMI2/fmi2_import_me_test.c )
 target_link_libraries (fmi2_import_me_test  ${FMILIBFORTEST}  )
 add_executable (fmi2_import_cs_test ${RTTESTDIR}/FMI2/fmi2_import_cs_test.c )
 target_link_libraries (fmi2_import_cs_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_me_driver_test ${RTTESTDIR}/FMI2/fmi2_import_me_driver_test.c )
+target_link_libraries (fmi2_import_me_driver_test  ${FMILIBFORTEST}  )
+if(UNIX)
+	target_link_libraries (fmi2_import_me_driver_test m)
+endif(UNIX)
+add_executable (fmi2_import_jacobian_test ${RTTESTDIR}/FMI2/fmi2_import_jacobian_test.c )
+target_link_libraries (fmi2_import_jacobian_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_cosim_master_test ${RTTESTDIR}/FMI2/fmi2_import_cosim_master_test.c )
+target_link_libraries (fmi2_import_cosim_master_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_async_test ${RTTESTDIR}/FMI2/fmi2_import_async_test.c )
+target_link_libraries (fmi2_import_async_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_state_ring_test ${RTTESTDIR}/FMI2/fmi2_import_state_ring_test.c )
+target_link_libraries (fmi2_import_state_ring_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_state_store_test ${RTTESTDIR}/FMI2/fmi2_import_state_store_test.c )
+target_link_libraries (fmi2_import_state_store_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_warm_start_test ${RTTESTDIR}/FMI2/fmi2_import_warm_start_test.c )
+target_link_libraries (fmi2_import_warm_start_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_result_writer_test ${RTTESTDIR}/FMI2/fmi2_import_result_writer_test.c )
+target_link_libraries (fmi2_import_result_writer_test  ${FMILIBFORTEST} zlib )
+add_executable (fmi2_import_mat_writer_test ${RTTESTDIR}/FMI2/fmi2_import_mat_writer_test.c )
+target_link_libraries (fmi2_import_mat_writer_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_call_statistics_test ${RTTESTDIR}/FMI2/fmi2_import_call_statistics_test.c )
+target_link_libraries (fmi2_import_call_statistics_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_trace_test ${RTTESTDIR}/FMI2/fmi2_import_trace_test.c )
+target_link_libraries (fmi2_import_trace_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_memory_usage_test ${RTTESTDIR}/FMI2/fmi2_import_memory_usage_test.c )
+target_link_libraries (fmi2_import_memory_usage_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_log_sink_test ${RTTESTDIR}/FMI2/fmi2_import_log_sink_test.c )
+target_link_libraries (fmi2_import_log_sink_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_log_filter_test ${RTTESTDIR}/FMI2/fmi2_import_log_filter_test.c )
+target_link_libraries (fmi2_import_log_filter_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_variable_list_test ${RTTESTDIR}/FMI2/fmi2_import_variable_list_test.c )
+target_link_libraries (fmi2_import_variable_list_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_selection_test ${RTTESTDIR}/FMI2/fmi2_import_selection_test.c )
+target_link_libraries (fmi2_import_selection_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_component_test ${RTTESTDIR}/FMI2/fmi2_import_component_test.c )
+target_link_libraries (fmi2_import_component_test  ${FMILIBFORTEST}  )
+add_executable (fmi2_import_dependency_graph_test ${RTTESTDIR}/FMI2/fmi2_import_dependency_graph_test.c )
+target_link_libraries (fmi2_import_dependency_graph_test  ${FMILIBFORTEST}  )
 set_target_properties(
 	fmi2_import_xml_test 
 	fmi2_import_me_test fmi2_import_cs_test
+	fmi2_import_me_driver_test fmi2_import_jacobian_test
+	fmi2_import_cosim_master_test fmi2_import_async_test
+	fmi2_import_state_ring_test fmi2_import_state_store_test
+	fmi2_import_warm_start_test fmi2_import_result_writer_test
+	fmi2_import_mat_writer_test
+	fmi2_import_call_statistics_test
+	fmi2_import_trace_test
+	fmi2_import_memory_usage_test
+	fmi2_import_log_sink_test
+	fmi2_import_log_filter_test
+	fmi2_import_variable_list_test
+	fmi2_import_selection_test
+	fmi2_import_component_test
+	fmi2_import_dependency_graph_test
     PROPERTIES FOLDER "Test/FMI2")
 ADD_TEST(ctest_fmi2_import_xml_test_empty fmi2_import_xml_test ${FMU2_DUMMY_FOLDER})
 add_test(ctest_fmi2_import_xml_test_me fmi2_import_xml_test ${TEST_OUTPUT_FOLDER}/${FMU2_DUMMY_ME_MODEL_IDENTIFIER}_me)
@@ -79,6 +132,24 @@ add_test(ctest_fmi2_import_xml_test_mf fmi2_import_xml_test ${TEST_OUTPUT_FOLDER
   set_tests_properties(ctest_fmi2_import_xml_test_mf PROPERTIES WILL_FAIL TRUE)
 add_test(ctest_fmi2_import_test_me fmi2_import_me_test ${FMU2_ME_PATH} ${FMU_TEMPFOLDER})
 add_test(ctest_fmi2_import_test_cs fmi2_import_cs_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_me_driver_test fmi2_import_me_driver_test ${FMU2_ME_PATH} ${FMU_TEMPFOLDER} ${TEST_OUTPUT_FOLDER}/Scalable2_stiff_me.fmu)
+add_test(ctest_fmi2_import_jacobian_test fmi2_import_jacobian_test ${FMU2_ME_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_cosim_master_test fmi2_import_cosim_master_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_async_test fmi2_import_async_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_state_ring_test fmi2_import_state_ring_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_state_store_test fmi2_import_state_store_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_warm_start_test fmi2_import_warm_start_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_result_writer_test fmi2_import_result_writer_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_mat_writer_test fmi2_import_mat_writer_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_call_statistics_test fmi2_import_call_statistics_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_trace_test fmi2_import_trace_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_memory_usage_test fmi2_import_memory_usage_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_log_sink_test fmi2_import_log_sink_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_log_filter_test fmi2_import_log_filter_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_variable_list_test fmi2_import_variable_list_test ${FMU2_CS_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_selection_test fmi2_import_selection_test ${FMU2_ME_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_component_test fmi2_import_component_test ${FMU2_ME_PATH} ${FMU_TEMPFOLDER})
+add_test(ctest_fmi2_import_dependency_graph_test fmi2_import_dependency_graph_test ${FMU2_ME_PATH} ${FMU_TEMPFOLDER})
 
 if(FMILIB_BUILD_BEFORE_TESTS)
 	SET_TESTS_PROPERTIES ( 
@@ -88,6 +159,24 @@ if(FMILIB_BUILD_BEFORE_TESTS)
 		ctest_fmi2_import_xml_test_empty
 		ctest_fmi2_import_test_me
 		ctest_fmi2_import_test_cs
+		ctest_fmi2_import_me_driver_test
+		ctest_fmi2_import_jacobian_test
+		ctest_fmi2_import_cosim_master_test
+		ctest_fmi2_import_async_test
+		ctest_fmi2_import_state_ring_test
+		ctest_fmi2_import_state_store_test
+		ctest_fmi2_import_warm_start_test
+		ctest_fmi2_import_result_writer_test
+		ctest_fmi2_import_mat_writer_test
+		ctest_fmi2_import_call_statistics_test
+		ctest_fmi2_import_trace_test
+		ctest_fmi2_import_memory_usage_test
+		ctest_fmi2_import_log_sink_test
+		ctest_fmi2_import_log_filter_test
+		ctest_fmi2_import_variable_list_test
+		ctest_fmi2_import_selection_test
+		ctest_fmi2_import_component_test
+		ctest_fmi2_import_dependency_graph_test
 		PROPERTIES DEPENDS ctest_build_all)
 endif()
 
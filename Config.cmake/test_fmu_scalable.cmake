@@ -0,0 +1,79 @@
+#    Copyright (C) 2012 Modelon AB
+
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the BSD style license.
+
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#    FMILIB_License.txt file for more details.
+
+#    You should have received a copy of the FMILIB_License.txt file
+#    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+
+# Scalable test FMUs. One binary per FMI version and kind serves model descriptions of
+# any size, fmu_scalable_generator writes the model description and packs the FMU.
+set(FMILIB_SCALABLE_FMU_ARGS "-x 100 -z 10 -u 10 -y 10 -a 10 -b 2" CACHE STRING
+	"Sizes of the generated scalable test FMUs, see Test/fmu_scalable/fmu_scalable_generator.c")
+mark_as_advanced(FMILIB_SCALABLE_FMU_ARGS)
+separate_arguments(FMU_SCALABLE_ARGS UNIX_COMMAND "${FMILIB_SCALABLE_FMU_ARGS}")
+
+set(FMU_SCALABLE_FOLDER ${RTTESTDIR}/fmu_scalable)
+set(FMU_SCALABLE_MODEL
+  ${FMU_SCALABLE_FOLDER}/fmu_scalable_model.c
+  ${FMU_SCALABLE_FOLDER}/fmu_scalable_model.h
+)
+
+add_library(fmu1_scalable_me SHARED ${FMU_SCALABLE_FOLDER}/fmu1_scalable_me.c ${FMU_SCALABLE_MODEL})
+add_library(fmu1_scalable_cs SHARED ${FMU_SCALABLE_FOLDER}/fmu1_scalable_cs.c ${FMU_SCALABLE_MODEL})
+add_library(fmu2_scalable SHARED ${FMU_SCALABLE_FOLDER}/fmu2_scalable.c ${FMU_SCALABLE_MODEL})
+set_target_properties(fmu1_scalable_me PROPERTIES COMPILE_DEFINITIONS MODEL_IDENTIFIER=Scalable1_me)
+set_target_properties(fmu1_scalable_cs PROPERTIES COMPILE_DEFINITIONS MODEL_IDENTIFIER=Scalable1_cs)
+
+add_executable (fmu_scalable_generator ${FMU_SCALABLE_FOLDER}/fmu_scalable_generator.c ${FMU_SCALABLE_MODEL})
+target_link_libraries (fmu_scalable_generator ${FMIZIP_LIBRARIES})
+
+#Generate ${TEST_OUTPUT_FOLDER}/${NAME_T}.fmu with the sizes in FMILIB_SCALABLE_FMU_ARGS or the extra arguments
+function(generate_scalable_fmu NAME_T FMU_TYPE_T MODEL_IDENTIFIER_T TARGET_NAME_T)
+	set(FMU_PATH_T ${TEST_OUTPUT_FOLDER}/${NAME_T}.fmu)
+	set(ARGS_T ${FMU_SCALABLE_ARGS})
+	if(ARGN)
+		set(ARGS_T ${ARGN})
+	endif()
+	set(SHARED_LIBRARY_PATH_T ${CMAKE_CURRENT_BINARY_DIR}/${CMAKE_CFG_INTDIR}/${CMAKE_SHARED_LIBRARY_PREFIX}${TARGET_NAME_T}${CMAKE_SHARED_LIBRARY_SUFFIX})
+	add_custom_command(
+		OUTPUT ${FMU_PATH_T}
+		DEPENDS fmu_scalable_generator ${TARGET_NAME_T}
+		COMMAND fmu_scalable_generator "${FMU_PATH_T}" ${FMU_TYPE_T} ${MODEL_IDENTIFIER_T} "${SHARED_LIBRARY_PATH_T}" ${ARGS_T}
+	)
+	add_custom_target(${NAME_T}_FMU ALL DEPENDS ${FMU_PATH_T})
+	set_target_properties(${NAME_T}_FMU ${TARGET_NAME_T} PROPERTIES FOLDER "TestFMUs")
+endfunction(generate_scalable_fmu)
+
+generate_scalable_fmu(Scalable1_me fmi1_me Scalable1_me fmu1_scalable_me)
+generate_scalable_fmu(Scalable1_cs fmi1_cs Scalable1_cs fmu1_scalable_cs)
+generate_scalable_fmu(Scalable2_me fmi2_me Scalable2 fmu2_scalable)
+generate_scalable_fmu(Scalable2_cs fmi2_cs Scalable2 fmu2_scalable)
+#Stiff nonlinear model for the BDF solver of the ME driver
+generate_scalable_fmu(Scalable2_stiff_me fmi2_me Scalable2 fmu2_scalable -x 20 -z 0 -u 0 -y 1 -a 0 -b 2 -s 1000)
+
+add_executable (fmi_scalable_fmu_test ${RTTESTDIR}/fmi_scalable_fmu_test.c ${FMU_SCALABLE_MODEL})
+target_link_libraries (fmi_scalable_fmu_test ${FMILIBFORTEST})
+if(UNIX)
+	target_link_libraries (fmi_scalable_fmu_test m)
+endif(UNIX)
+set_target_properties(fmu_scalable_generator fmi_scalable_fmu_test PROPERTIES FOLDER "Test")
+
+add_test(ctest_fmi_scalable_fmu_test_me_1 fmi_scalable_fmu_test ${TEST_OUTPUT_FOLDER}/Scalable1_me.fmu ${FMU_TEMPFOLDER})
+add_test(ctest_fmi_scalable_fmu_test_cs_1 fmi_scalable_fmu_test ${TEST_OUTPUT_FOLDER}/Scalable1_cs.fmu ${FMU_TEMPFOLDER})
+add_test(ctest_fmi_scalable_fmu_test_me_2 fmi_scalable_fmu_test ${TEST_OUTPUT_FOLDER}/Scalable2_me.fmu ${FMU_TEMPFOLDER})
+add_test(ctest_fmi_scalable_fmu_test_cs_2 fmi_scalable_fmu_test ${TEST_OUTPUT_FOLDER}/Scalable2_cs.fmu ${FMU_TEMPFOLDER})
+
+if(FMILIB_BUILD_BEFORE_TESTS)
+	SET_TESTS_PROPERTIES (
+		ctest_fmi_scalable_fmu_test_me_1
+		ctest_fmi_scalable_fmu_test_cs_1
+		ctest_fmi_scalable_fmu_test_me_2
+		ctest_fmi_scalable_fmu_test_cs_2
+		PROPERTIES DEPENDS ctest_build_all)
+endif()
@@ -0,0 +1,126 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+
+#include "fmi_bench_model.h"
+
+#define FMI_BENCH_INPUT(k) ((k) % 10 == 0)
+#define FMI_BENCH_OUTPUT(k) ((k) % 10 == 1)
+
+/* Linear congruential generator so that the output does not depend on the C library */
+static double fmi_bench_random(unsigned long* state) {
+	*state = (*state * 1103515245UL + 12345UL) & 0x7fffffffUL;
+	return (double)*state / 2147483648.0;
+}
+
+void fmi_bench_model_defaults(fmi_bench_model_t* model) {
+	model->numVariables = 1000;
+	model->aliasRatio = 0.1;
+	model->dependencyDensity = 0.1;
+	model->descriptionUniqueness = 1.0;
+}
+
+void fmi_bench_model_variable_name(size_t k, char* buf) {
+	sprintf(buf, "b%u.v%u", (unsigned)(k / 100), (unsigned)k);
+}
+
+int fmi_bench_model_write_xml(const fmi_bench_model_t* model, fmi_version_enu_t version, const char* fileName) {
+	FILE* f = fopen(fileName, "w");
+	unsigned long rng = 1;
+	size_t k, j, vr = 0, lastLocalVR = 0, haveLocal = 0;
+	size_t n = model->numVariables;
+	size_t numInputs = (n + 9) / 10;
+	size_t numDeps = (size_t)(model->dependencyDensity * numInputs + 0.5);
+	int fmi1 = (version == fmi_version_1_enu);
+	char name[32];
+
+	if(!f) return -1;
+	if(numDeps > numInputs) numDeps = numInputs;
+
+	fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	if(fmi1) {
+		fprintf(f, "<fmiModelDescription fmiVersion=\"1.0\" modelName=\"Bench\" modelIdentifier=\"Bench\" guid=\"{bench}\"\n"
+			"  numberOfContinuousStates=\"0\" numberOfEventIndicators=\"0\">\n");
+	}
+	else {
+		fprintf(f, "<fmiModelDescription fmiVersion=\"2.0\" modelName=\"Bench\" guid=\"{bench}\" variableNamingConvention=\"structured\">\n"
+			"  <CoSimulation modelIdentifier=\"Bench\"/>\n");
+	}
+	fprintf(f, "  <ModelVariables>\n");
+	for(k = 0; k < n; k++) {
+		const char* causality = FMI_BENCH_INPUT(k) ? "input" : FMI_BENCH_OUTPUT(k) ? "output" : 0;
+		int isAlias = 0;
+		size_t varVR;
+
+		if(!causality && haveLocal && fmi_bench_random(&rng) < model->aliasRatio) {
+			isAlias = 1;
+			varVR = lastLocalVR;
+		}
+		else {
+			varVR = vr++;
+			if(!causality) {
+				lastLocalVR = varVR;
+				haveLocal = 1;
+			}
+		}
+		fmi_bench_model_variable_name(k, name);
+		fprintf(f, "    <ScalarVariable name=\"%s\" valueReference=\"%u\"", name, (unsigned)varVR);
+		if(causality) fprintf(f, " causality=\"%s\"", causality);
+		else if(fmi1) fprintf(f, " causality=\"internal\"");
+		if(fmi1 && isAlias) fprintf(f, " alias=\"alias\"");
+		if(fmi_bench_random(&rng) < model->descriptionUniqueness)
+			fprintf(f, " description=\"Description of variable %u\">\n", (unsigned)k);
+		else
+			fprintf(f, " description=\"Shared description\">\n");
+		if(FMI_BENCH_INPUT(k))
+			fprintf(f, "      <Real start=\"%u\"/>\n", (unsigned)k);
+		else
+			fprintf(f, "      <Real/>\n");
+		if(fmi1 && FMI_BENCH_OUTPUT(k) && numDeps) {
+			fprintf(f, "      <DirectDependency>\n");
+			for(j = 0; j < numDeps; j++) {
+				fmi_bench_model_variable_name(10 * ((k / 10 + j) % numInputs), name);
+				fprintf(f, "        <Name>%s</Name>\n", name);
+			}
+			fprintf(f, "      </DirectDependency>\n");
+		}
+		fprintf(f, "    </ScalarVariable>\n");
+	}
+	fprintf(f, "  </ModelVariables>\n");
+
+	if(!fmi1) {
+		fprintf(f, "  <ModelStructure>\n    <Outputs>\n");
+		for(k = 1; k < n; k += 10) {
+			size_t first = (k / 10 + numDeps > numInputs) ? (k / 10 + numDeps) % numInputs : 0;
+
+			fprintf(f, "      <Unknown index=\"%u\" dependencies=\"", (unsigned)(k + 1));
+			/* The inputs k/10 ... k/10 + numDeps - 1 modulo numInputs in increasing order */
+			for(j = 0; j < first; j++)
+				fprintf(f, "%s%u", j ? " " : "", (unsigned)(10 * j + 1));
+			for(j = k / 10; j < k / 10 + numDeps && j < numInputs; j++)
+				fprintf(f, "%s%u", (j > k / 10 || first) ? " " : "", (unsigned)(10 * j + 1));
+			fprintf(f, "\"/>\n");
+		}
+		fprintf(f, "    </Outputs>\n  </ModelStructure>\n");
+	}
+	fprintf(f, "</fmiModelDescription>\n");
+
+	if(ferror(f)) {
+		fclose(f);
+		return -1;
+	}
+	return fclose(f) == 0 ? 0 : -1;
+}
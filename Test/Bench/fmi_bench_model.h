@@ -0,0 +1,55 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef FMI_BENCH_MODEL_H_
+#define FMI_BENCH_MODEL_H_
+
+#include <stddef.h>
+#include <FMI/fmi_version.h>
+
+/** \file fmi_bench_model.h
+	Generator of synthetic model descriptions for benchmarks.
+
+	The model has numVariables Real variables. Every tenth variable is an input, the one after
+	it an output and the rest are local. Locals become aliases of an earlier local variable with
+	probability aliasRatio. Every output depends on round(dependencyDensity * number of inputs) inputs.
+	A variable gets a description of its own with probability descriptionUniqueness, otherwise
+	all variables share one description. The same settings always produce the same XML.
+*/
+
+/** \brief Settings of a synthetic model */
+typedef struct fmi_bench_model_t {
+	size_t numVariables;
+	double aliasRatio;
+	double dependencyDensity;
+	double descriptionUniqueness;
+} fmi_bench_model_t;
+
+/** \brief Fill in the default settings: 1000 variables, 10% aliases, 10% dependency density, unique descriptions */
+void fmi_bench_model_defaults(fmi_bench_model_t* model);
+
+/** \brief Write the name of variable k (0-based) of the model into buf (at least 32 bytes) */
+void fmi_bench_model_variable_name(size_t k, char* buf);
+
+/**
+	\brief Write a modelDescription.xml for the model.
+	\param model Model settings.
+	\param version fmi_version_1_enu or fmi_version_2_0_enu.
+	\param fileName Output file.
+	\return 0 on success, -1 if the file could not be written.
+*/
+int fmi_bench_model_write_xml(const fmi_bench_model_t* model, fmi_version_enu_t version, const char* fileName);
+
+#endif /* FMI_BENCH_MODEL_H_ */
@@ -0,0 +1,600 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/*
+	Benchmark of the load, parse and call paths of the library.
+
+	Usage: fmilib_bench <fmu2_cs_file> <temporary_dir> [options]
+		-n N      number of variables in the synthetic model description (1000)
+		-a ratio  share of local variables that are aliases (0.1)
+		-d ratio  share of the inputs every output depends on (0.1)
+		-u ratio  share of variables with a unique description (1.0)
+		-r N      repetitions of every measurement (10)
+		-c N      FMI calls per repetition in the call overhead measurements (100000)
+		-o file   write the JSON report to file instead of stdout
+
+	The FMU should be the co-simulation dummy FMU built with the tests (BouncingBall2_cs.fmu).
+	Every result reports the minimum, mean and maximum time per operation in nanoseconds
+	over the repetitions.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <fmilib.h>
+#include <JM/jm_portability.h>
+#include <FMI/fmi_zip_unzip.h>
+
+#include "fmi_bench_model.h"
+
+#define MAX_RESULTS 32
+
+/* Number of variable references in the log message of the expansion benchmark */
+#define EXPAND_REFERENCES 40
+#define EXPAND_MESSAGE_SIZE 4096
+
+typedef struct bench_result_t {
+	const char* name;
+	size_t operations;
+	size_t repetitions;
+	double min;
+	double max;
+	double sum;
+} bench_result_t;
+
+typedef struct bench_t {
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_bench_model_t model;
+	size_t repetitions;
+	size_t calls;
+	char* workDir;
+	char xmlFile[FILENAME_MAX];
+	char** names;
+	bench_result_t results[MAX_RESULTS];
+	size_t numResults;
+} bench_t;
+
+static void fail(const char* message)
+{
+	fprintf(stderr, "fmilib_bench: %s\n", message);
+	exit(1);
+}
+
+static bench_result_t* bench_new_result(bench_t* b, const char* name, size_t operations)
+{
+	bench_result_t* r = &b->results[b->numResults++];
+	r->name = name;
+	r->operations = operations;
+	r->repetitions = 0;
+	r->min = r->max = r->sum = 0;
+	return r;
+}
+
+/* Record one repetition that started at the given time */
+static void bench_record(bench_result_t* r, double start)
+{
+	double t = (jm_get_monotonic_time() - start) / r->operations;
+	if(!r->repetitions || t < r->min) r->min = t;
+	if(!r->repetitions || t > r->max) r->max = t;
+	r->sum += t;
+	r->repetitions++;
+}
+
+static void bench_unzip(bench_t* b, const char* fmuPath)
+{
+	bench_result_t* unzip = bench_new_result(b, "unzip", 1);
+	bench_result_t* probe = bench_new_result(b, "version_probe", 1);
+	char* dir;
+	double start;
+	size_t k;
+
+	for(k = 0; k < b->repetitions; k++) {
+		dir = jm_mk_temp_dir(&b->callbacks, b->workDir, "unzip");
+		if(!dir) fail("Could not create a temporary directory");
+		start = jm_get_monotonic_time();
+		if(fmi_zip_unzip(fmuPath, dir, &b->callbacks) != jm_status_success) fail("Could not unzip the FMU");
+		bench_record(unzip, start);
+		jm_rmdir(&b->callbacks, dir);
+		b->callbacks.free(dir);
+
+		dir = jm_mk_temp_dir(&b->callbacks, b->workDir, "probe");
+		if(!dir) fail("Could not create a temporary directory");
+		start = jm_get_monotonic_time();
+		if(fmi_import_get_fmi_version(b->context, fmuPath, dir) != fmi_version_2_0_enu) fail("The FMU is not an FMI 2.0 FMU");
+		bench_record(probe, start);
+		jm_rmdir(&b->callbacks, dir);
+		b->callbacks.free(dir);
+	}
+}
+
+static void bench_fmi1(bench_t* b)
+{
+	bench_result_t* parse = bench_new_result(b, "fmi1_parse", 1);
+	fmi1_import_t* fmu;
+	double start;
+	size_t k;
+
+	if(fmi_bench_model_write_xml(&b->model, fmi_version_1_enu, b->xmlFile)) fail("Could not write the model description");
+	for(k = 0; k < b->repetitions; k++) {
+		start = jm_get_monotonic_time();
+		fmu = fmi1_import_parse_xml(b->context, b->workDir);
+		if(!fmu) fail("Could not parse the FMI 1.0 model description");
+		bench_record(parse, start);
+		fmi1_import_free(fmu);
+	}
+}
+
+static int bench_is_output(fmi2_import_variable_t* v, void* data)
+{
+	return fmi2_import_get_causality(v) == fmi2_causality_enu_output;
+}
+
+static void bench_fmi2_lists(bench_t* b, fmi2_import_t* fmu)
+{
+	bench_result_t* getList = bench_new_result(b, "fmi2_variable_list_get", 1);
+	bench_result_t* getSorted = bench_new_result(b, "fmi2_variable_list_get_sorted_by_name", 1);
+	bench_result_t* clone = bench_new_result(b, "fmi2_variable_list_clone", 1);
+	bench_result_t* filter = bench_new_result(b, "fmi2_variable_list_filter", 1);
+	bench_result_t* vrs = bench_new_result(b, "fmi2_variable_list_value_references", 1);
+	bench_result_t* join = bench_new_result(b, "fmi2_variable_list_join", 1);
+	bench_result_t* sublist = bench_new_result(b, "fmi2_variable_list_sublist", 1);
+	bench_result_t* pushBack = bench_new_result(b, "fmi2_variable_list_push_back", b->model.numVariables);
+	fmi2_import_variable_list_t *all, *tmp, *other;
+	double start;
+	size_t k, j, n = b->model.numVariables;
+
+	for(k = 0; k < b->repetitions; k++) {
+		start = jm_get_monotonic_time();
+		all = fmi2_import_get_variable_list(fmu, 0);
+		bench_record(getList, start);
+		if(!all) fail("Could not get the variable list");
+
+		start = jm_get_monotonic_time();
+		tmp = fmi2_import_get_variable_list(fmu, 1);
+		bench_record(getSorted, start);
+		fmi2_import_free_variable_list(tmp);
+
+		start = jm_get_monotonic_time();
+		other = fmi2_import_clone_variable_list(all);
+		bench_record(clone, start);
+
+		start = jm_get_monotonic_time();
+		tmp = fmi2_import_filter_variables(all, bench_is_output, 0);
+		bench_record(filter, start);
+		fmi2_import_free_variable_list(tmp);
+
+		/* The value reference list is cached by the list, use a fresh clone */
+		start = jm_get_monotonic_time();
+		if(!fmi2_import_get_value_referece_list(other)) fail("Could not get the value references");
+		bench_record(vrs, start);
+
+		start = jm_get_monotonic_time();
+		tmp = fmi2_import_join_var_list(all, other);
+		bench_record(join, start);
+		fmi2_import_free_variable_list(tmp);
+
+		start = jm_get_monotonic_time();
+		tmp = fmi2_import_get_sublist(all, n / 4, 3 * n / 4);
+		bench_record(sublist, start);
+		fmi2_import_free_variable_list(tmp);
+		fmi2_import_free_variable_list(other);
+
+		other = fmi2_import_get_sublist(all, 0, 0);
+		start = jm_get_monotonic_time();
+		for(j = 0; j < n; j++) {
+			fmi2_import_var_list_push_back(other, fmi2_import_get_variable(all, j));
+		}
+		bench_record(pushBack, start);
+		fmi2_import_free_variable_list(other);
+		fmi2_import_free_variable_list(all);
+	}
+}
+
+static int bench_is_continuous(fmi2_import_variable_t* v, void* data)
+{
+	return fmi2_import_get_variability(v) == fmi2_variability_enu_continuous;
+}
+
+static int bench_is_not_alias(fmi2_import_variable_t* v, void* data)
+{
+	return fmi2_import_get_variable_alias_kind(v) == fmi2_variable_is_not_alias;
+}
+
+/* Continuous outputs that are not aliases, with chained filters and with selections */
+static void bench_fmi2_selection(bench_t* b, fmi2_import_t* fmu)
+{
+	bench_result_t* filters = bench_new_result(b, "fmi2_query_filter_variables", 1);
+	bench_result_t* query = bench_new_result(b, "fmi2_query_selection", 1);
+	bench_result_t* toList = bench_new_result(b, "fmi2_selection_to_variable_list", 1);
+	bench_result_t* compiled = bench_new_result(b, "fmi2_query_compiled", 1);
+	fmi2_import_variable_list_t *all, *tmp, *expected = 0;
+	fmi2_import_selection_t* s;
+	fmi2_import_query_t* q = fmi2_import_compile_query(fmu, "causality=output and variability=continuous and not isAlias");
+	double start;
+	size_t k;
+
+	all = fmi2_import_get_variable_list(fmu, 0);
+	if(!all) fail("Could not get the variable list");
+	for(k = 0; k < b->repetitions; k++) {
+		fmi2_import_free_variable_list(expected);
+		start = jm_get_monotonic_time();
+		tmp = fmi2_import_filter_variables(all, bench_is_output, 0);
+		expected = fmi2_import_filter_variables(tmp, bench_is_continuous, 0);
+		fmi2_import_free_variable_list(tmp);
+		tmp = expected;
+		expected = fmi2_import_filter_variables(tmp, bench_is_not_alias, 0);
+		fmi2_import_free_variable_list(tmp);
+		bench_record(filters, start);
+
+		start = jm_get_monotonic_time();
+		s = fmi2_import_clone_selection(fmi2_import_get_causality_mask(fmu, fmi2_causality_enu_output));
+		fmi2_import_selection_and(s, fmi2_import_get_variability_mask(fmu, fmi2_variability_enu_continuous));
+		fmi2_import_selection_and(s, fmi2_import_get_alias_kind_mask(fmu, fmi2_variable_is_not_alias));
+		if(fmi2_import_selection_count(s) != fmi2_import_get_variable_list_size(expected)) fail("Unexpected selection");
+		bench_record(query, start);
+
+		start = jm_get_monotonic_time();
+		tmp = fmi2_import_selection_to_variable_list(s, fmi2_import_selection_original_order);
+		bench_record(toList, start);
+		if(!tmp) fail("Could not convert the selection");
+		fmi2_import_free_variable_list(tmp);
+
+		start = jm_get_monotonic_time();
+		if(!q || fmi2_import_query_select(q, s) != jm_status_success) fail("Could not evaluate the query");
+		bench_record(compiled, start);
+		if(fmi2_import_selection_count(s) != fmi2_import_get_variable_list_size(expected)) fail("Unexpected query result");
+		fmi2_import_free_selection(s);
+	}
+	fmi2_import_free_query(q);
+	fmi2_import_free_variable_list(expected);
+	fmi2_import_free_variable_list(all);
+}
+
+static int bench_is_in_b1(fmi2_import_variable_t* v, void* data)
+{
+	return strncmp(fmi2_import_get_variable_name(v), "b1.", 3) == 0;
+}
+
+/* Variables of one component "b1" (100 variables), with a filter and with the name index */
+static void bench_fmi2_names(bench_t* b, fmi2_import_t* fmu)
+{
+	bench_result_t* filter = bench_new_result(b, "fmi2_name_filter_variables", 1);
+	bench_result_t* pattern = bench_new_result(b, "fmi2_name_pattern", 1);
+	fmi2_import_variable_list_t *all, *expected, *vl;
+	double start;
+	size_t k;
+
+	all = fmi2_import_get_variable_list(fmu, 0);
+	if(!all) fail("Could not get the variable list");
+	for(k = 0; k < b->repetitions; k++) {
+		start = jm_get_monotonic_time();
+		expected = fmi2_import_filter_variables(all, bench_is_in_b1, 0);
+		bench_record(filter, start);
+
+		start = jm_get_monotonic_time();
+		vl = fmi2_import_get_variables_by_name_pattern(fmu, "b1.*");
+		bench_record(pattern, start);
+		if(!vl || !expected || fmi2_import_get_variable_list_size(vl) != fmi2_import_get_variable_list_size(expected)) {
+			fail("Unexpected result of the name pattern");
+		}
+		fmi2_import_free_variable_list(vl);
+		fmi2_import_free_variable_list(expected);
+	}
+	fmi2_import_free_variable_list(all);
+}
+
+/* Component tree of the structured names "b<k>.v<j>": building it once and finding each component with its subtree */
+static void bench_fmi2_components(bench_t* b, fmi2_import_t* fmu)
+{
+	bench_result_t* build = bench_new_result(b, "fmi2_component_tree_build", 1);
+	size_t n = b->model.numVariables, numComponents = (n + 99) / 100;
+	bench_result_t* find = bench_new_result(b, "fmi2_component_find_subtree", numComponents);
+	fmi2_import_component_t* c;
+	fmi2_import_variable_list_view_t view;
+	char path[32];
+	double start;
+	size_t k, j, total;
+
+	start = jm_get_monotonic_time();
+	c = fmi2_import_get_root_component(fmu);
+	bench_record(build, start);
+	if(!c || fmi2_import_get_number_of_child_components(c) != numComponents) fail("Unexpected component tree");
+
+	for(k = 0; k < b->repetitions; k++) {
+		total = 0;
+		start = jm_get_monotonic_time();
+		for(j = 0; j < numComponents; j++) {
+			sprintf(path, "b%u", (unsigned)j);
+			c = fmi2_import_find_component(fmu, path);
+			if(!c) fail("Component not found");
+			fmi2_import_get_component_subtree_variables(c, &view);
+			total += view.size;
+		}
+		bench_record(find, start);
+		if(total != n) fail("Unexpected number of variables in the components");
+	}
+}
+
+/* Dependency graph of the outputs: creation, transpose to the outputs of each input and the outputs affected by one input */
+static void bench_fmi2_dependencies(bench_t* b, fmi2_import_t* fmu)
+{
+	bench_result_t* create = bench_new_result(b, "fmi2_dependency_graph_create", 1);
+	bench_result_t* transpose = bench_new_result(b, "fmi2_dependency_graph_transpose", 1);
+	bench_result_t* order = bench_new_result(b, "fmi2_dependency_graph_order", 1);
+	fmi2_import_dependency_graph_t* g;
+	fmi2_import_sparsity_pattern_t csc;
+	size_t *rows, input = 0, numOrdered;
+	double start;
+	size_t k;
+
+	for(k = 0; k < b->repetitions; k++) {
+		start = jm_get_monotonic_time();
+		g = fmi2_import_dependency_graph_create(fmu, fmi2_import_outputs_dependencies);
+		bench_record(create, start);
+		if(!g) fail("Could not create the dependency graph");
+		rows = (size_t*)malloc((fmi2_import_dependency_graph_get_size(g) + 1) * sizeof(size_t));
+		if(!rows) fail("Could not allocate memory");
+
+		start = jm_get_monotonic_time();
+		if(fmi2_import_dependency_graph_transpose(g, &csc) != jm_status_success) fail("Could not transpose the dependency graph");
+		bench_record(transpose, start);
+
+		start = jm_get_monotonic_time();
+		if(fmi2_import_dependency_graph_order(g, &input, 1, rows, &numOrdered) != jm_status_success) fail("Could not order the outputs");
+		bench_record(order, start);
+		if(numOrdered != csc.start[input + 1] - csc.start[input]) fail("The ordered outputs do not match the transpose");
+
+		fmi2_import_dependency_graph_free_pattern(g, &csc);
+		free(rows);
+		fmi2_import_dependency_graph_free(g);
+	}
+}
+
+/* Expansion of a log message with EXPAND_REFERENCES references spread over the value references */
+static void bench_fmi2_expand(bench_t* b, fmi2_import_t* fmu, const fmi2_value_reference_t* vr)
+{
+	bench_result_t* expand = bench_new_result(b, "fmi2_expand_variable_references", b->calls);
+	char message[EXPAND_MESSAGE_SIZE], expected[EXPAND_MESSAGE_SIZE], expanded[EXPAND_MESSAGE_SIZE];
+	size_t msgLen = 0, expLen = 0, k, j, n = b->model.numVariables;
+	double start;
+
+	for(j = 0; j < EXPAND_REFERENCES; j++) {
+		fmi2_value_reference_t ref = vr[j * n / EXPAND_REFERENCES];
+		fmi2_import_variable_t* v = fmi2_import_get_variable_by_vr(fmu, fmi2_base_type_real, ref);
+		if(!v) fail("Variable lookup by value reference failed");
+		msgLen += jm_snprintf(message + msgLen, EXPAND_MESSAGE_SIZE - msgLen, "v%u=#r%u#, ", (unsigned)j, (unsigned)ref);
+		expLen += jm_snprintf(expected + expLen, EXPAND_MESSAGE_SIZE - expLen, "v%u=%s, ", (unsigned)j, fmi2_import_get_variable_name(v));
+	}
+	jm_snprintf(message + msgLen, EXPAND_MESSAGE_SIZE - msgLen, "##%u", (unsigned)EXPAND_REFERENCES);
+	jm_snprintf(expected + expLen, EXPAND_MESSAGE_SIZE - expLen, "#%u", (unsigned)EXPAND_REFERENCES);
+
+	fmi2_import_expand_variable_references(fmu, message, expanded, EXPAND_MESSAGE_SIZE);
+	if(strcmp(expanded, expected)) fail("Unexpected expansion of the variable references");
+	fmi2_import_expand_variable_references(fmu, message, expanded, 16);
+	if(strncmp(expanded, expected, 15) || expanded[15]) fail("Unexpected truncation of the expanded message");
+
+	for(k = 0; k < b->repetitions; k++) {
+		start = jm_get_monotonic_time();
+		for(j = 0; j < b->calls; j++) {
+			fmi2_import_expand_variable_references(fmu, message, expanded, EXPAND_MESSAGE_SIZE);
+		}
+		bench_record(expand, start);
+	}
+}
+
+static void bench_fmi2(bench_t* b)
+{
+	bench_result_t* parse = bench_new_result(b, "fmi2_parse", 1);
+	bench_result_t* byName = bench_new_result(b, "fmi2_lookup_by_name", b->model.numVariables);
+	bench_result_t* byVR = bench_new_result(b, "fmi2_lookup_by_vr", b->model.numVariables);
+	fmi2_import_t* fmu = 0;
+	fmi2_import_variable_list_t* all;
+	const fmi2_value_reference_t* vr;
+	double start;
+	size_t k, j, n = b->model.numVariables;
+
+	if(fmi_bench_model_write_xml(&b->model, fmi_version_2_0_enu, b->xmlFile)) fail("Could not write the model description");
+	for(k = 0; k < b->repetitions; k++) {
+		if(fmu) fmi2_import_free(fmu);
+		start = jm_get_monotonic_time();
+		fmu = fmi2_import_parse_xml(b->context, b->workDir, 0);
+		if(!fmu) fail("Could not parse the FMI 2.0 model description");
+		bench_record(parse, start);
+	}
+
+	all = fmi2_import_get_variable_list(fmu, 0);
+	vr = fmi2_import_get_value_referece_list(all);
+	if(!all || !vr || fmi2_import_get_variable_list_size(all) != n) fail("Unexpected variable list of the synthetic model");
+	for(k = 0; k < b->repetitions; k++) {
+		start = jm_get_monotonic_time();
+		for(j = 0; j < n; j++) {
+			if(!fmi2_import_get_variable_by_name(fmu, b->names[j])) fail("Variable lookup by name failed");
+		}
+		bench_record(byName, start);
+
+		start = jm_get_monotonic_time();
+		for(j = 0; j < n; j++) {
+			if(!fmi2_import_get_variable_by_vr(fmu, fmi2_base_type_real, vr[j])) fail("Variable lookup by value reference failed");
+		}
+		bench_record(byVR, start);
+	}
+	bench_fmi2_expand(b, fmu, vr);
+	fmi2_import_free_variable_list(all);
+
+	bench_fmi2_lists(b, fmu);
+	bench_fmi2_selection(b, fmu);
+	bench_fmi2_names(b, fmu);
+	bench_fmi2_components(b, fmu);
+	bench_fmi2_dependencies(b, fmu);
+	fmi2_import_free(fmu);
+}
+
+static void bench_capi(bench_t* b, const char* fmuPath)
+{
+	bench_result_t* getReal = bench_new_result(b, "fmi2_capi_get_real", b->calls);
+	bench_result_t* setReal = bench_new_result(b, "fmi2_capi_set_real", b->calls);
+	bench_result_t* doStep = bench_new_result(b, "fmi2_capi_do_step", b->calls);
+	fmi2_import_t* fmu;
+	fmi2_value_reference_t hightVR = 0, gravityVR = 2;
+	fmi2_real_t value, gravity = -9.81, t = 0, h = 1e-6;
+	char* dir;
+	double start;
+	size_t k, j;
+
+	dir = jm_mk_temp_dir(&b->callbacks, b->workDir, "capi");
+	if(!dir) fail("Could not create a temporary directory");
+	if(fmi_import_get_fmi_version(b->context, fmuPath, dir) != fmi_version_2_0_enu) fail("The FMU is not an FMI 2.0 FMU");
+	fmu = fmi2_import_parse_xml(b->context, dir, 0);
+	if(!fmu) fail("Could not parse the FMU");
+	if(fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, 0) != jm_status_success) fail("Could not load the FMU binary");
+	if(fmi2_import_instantiate(fmu, "bench", fmi2_cosimulation, 0, fmi2_false) == jm_status_error ||
+		fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0) != fmi2_status_ok ||
+		fmi2_import_enter_initialization_mode(fmu) != fmi2_status_ok ||
+		fmi2_import_exit_initialization_mode(fmu) != fmi2_status_ok) fail("Could not initialize the FMU");
+
+	for(k = 0; k < b->repetitions; k++) {
+		start = jm_get_monotonic_time();
+		for(j = 0; j < b->calls; j++) {
+			fmi2_import_get_real(fmu, &hightVR, 1, &value);
+		}
+		bench_record(getReal, start);
+
+		start = jm_get_monotonic_time();
+		for(j = 0; j < b->calls; j++) {
+			fmi2_import_set_real(fmu, &gravityVR, 1, &gravity);
+		}
+		bench_record(setReal, start);
+
+		start = jm_get_monotonic_time();
+		for(j = 0; j < b->calls; j++) {
+			fmi2_import_do_step(fmu, t, h, fmi2_true);
+			t += h;
+		}
+		bench_record(doStep, start);
+	}
+
+	fmi2_import_terminate(fmu);
+	fmi2_import_free_instance(fmu);
+	fmi2_import_destroy_dllfmu(fmu);
+	fmi2_import_free(fmu);
+	jm_rmdir(&b->callbacks, dir);
+	b->callbacks.free(dir);
+}
+
+static void bench_write_json(bench_t* b, FILE* f)
+{
+	size_t k;
+
+	fprintf(f, "{\n  \"benchmark\": \"fmilib_bench\",\n  \"config\": {\n");
+	fprintf(f, "    \"variables\": %u,\n    \"alias_ratio\": %g,\n    \"dependency_density\": %g,\n"
+		"    \"description_uniqueness\": %g,\n    \"repetitions\": %u,\n    \"calls\": %u,\n",
+		(unsigned)b->model.numVariables, b->model.aliasRatio, b->model.dependencyDensity,
+		b->model.descriptionUniqueness, (unsigned)b->repetitions, (unsigned)b->calls);
+#ifdef FMILIB_ENABLE_CALL_STATISTICS
+	fprintf(f, "    \"call_statistics\": true\n");
+#else
+	fprintf(f, "    \"call_statistics\": false\n");
+#endif
+	fprintf(f, "  },\n  \"unit\": \"ns\",\n  \"results\": [\n");
+	for(k = 0; k < b->numResults; k++) {
+		bench_result_t* r = &b->results[k];
+		fprintf(f, "    {\"name\": \"%s\", \"operations\": %u, \"repetitions\": %u, \"min\": %.1f, \"mean\": %.1f, \"max\": %.1f}%s\n",
+			r->name, (unsigned)r->operations, (unsigned)r->repetitions,
+			r->min * 1e9, r->repetitions ? r->sum / r->repetitions * 1e9 : 0.0, r->max * 1e9,
+			(k + 1 < b->numResults) ? "," : "");
+	}
+	fprintf(f, "  ]\n}\n");
+}
+
+int main(int argc, char *argv[])
+{
+	bench_t b;
+	const char* fmuPath;
+	const char* tmpPath;
+	const char* outFile = 0;
+	FILE* out = stdout;
+	size_t k;
+	int i;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu2_cs_file> <temporary_dir> [-n variables] [-a alias_ratio] [-d dependency_density]"
+			" [-u description_uniqueness] [-r repetitions] [-c calls] [-o output.json]\n", argv[0]);
+		return 1;
+	}
+	fmuPath = argv[1];
+	tmpPath = argv[2];
+
+	memset(&b, 0, sizeof(b));
+	fmi_bench_model_defaults(&b.model);
+	b.repetitions = 10;
+	b.calls = 100000;
+	for(i = 3; i + 1 < argc; i += 2) {
+		const char* opt = argv[i];
+		const char* val = argv[i + 1];
+		if(!strcmp(opt, "-n")) b.model.numVariables = (size_t)atol(val);
+		else if(!strcmp(opt, "-a")) b.model.aliasRatio = atof(val);
+		else if(!strcmp(opt, "-d")) b.model.dependencyDensity = atof(val);
+		else if(!strcmp(opt, "-u")) b.model.descriptionUniqueness = atof(val);
+		else if(!strcmp(opt, "-r")) b.repetitions = (size_t)atol(val);
+		else if(!strcmp(opt, "-c")) b.calls = (size_t)atol(val);
+		else if(!strcmp(opt, "-o")) outFile = val;
+		else fail("Unknown option");
+	}
+	if(i < argc) fail("Missing option value");
+	if(b.model.numVariables < 10 || b.repetitions < 1 || b.calls < 1) fail("Invalid option value");
+
+	b.callbacks.malloc = malloc;
+	b.callbacks.calloc = calloc;
+	b.callbacks.realloc = realloc;
+	b.callbacks.free = free;
+	b.callbacks.logger = jm_default_logger;
+	b.callbacks.log_level = jm_log_level_warning;
+	b.callbacks.context = 0;
+
+	b.context = fmi_import_allocate_context(&b.callbacks);
+	if(!b.context) fail("Could not allocate the library context");
+	b.workDir = jm_mk_temp_dir(&b.callbacks, tmpPath, "fmilib_bench");
+	if(!b.workDir) fail("Could not create a temporary directory");
+	jm_snprintf(b.xmlFile, sizeof(b.xmlFile), "%s/modelDescription.xml", b.workDir);
+
+	b.names = (char**)malloc(b.model.numVariables * sizeof(char*));
+	if(!b.names) fail("Out of memory");
+	for(k = 0; k < b.model.numVariables; k++) {
+		b.names[k] = (char*)malloc(32);
+		if(!b.names[k]) fail("Out of memory");
+		fmi_bench_model_variable_name(k, b.names[k]);
+	}
+
+	bench_unzip(&b, fmuPath);
+	bench_fmi1(&b);
+	bench_fmi2(&b);
+	bench_capi(&b, fmuPath);
+
+	if(outFile) {
+		out = fopen(outFile, "w");
+		if(!out) fail("Could not open the output file");
+	}
+	bench_write_json(&b, out);
+	if(outFile && fclose(out)) fail("Could not write the output file");
+
+	for(k = 0; k < b.model.numVariables; k++) free(b.names[k]);
+	free(b.names);
+	jm_rmdir(&b.callbacks, b.workDir);
+	b.callbacks.free(b.workDir);
+	fmi_import_free_context(b.context);
+	return 0;
+}
@@ -0,0 +1,173 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/* Stress test of the routing of FMI 1.0 log messages to the FMUs when many threads
+   create, use and free instances of globally registered FMUs at the same time. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+#include <JM/jm_thread.h>
+#include <JM/jm_call_statistics.h>
+
+#define NUM_FMUS 64
+#define NUM_THREADS 8
+#define NUM_ROUNDS 20
+#define NUM_MESSAGES 50
+
+/* The dummy FMU logs the value of this string variable */
+#define VAR_S_LOGGER_TEST 0
+
+typedef struct {
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi1_import_t* fmu;
+	char tag[20];
+	size_t received;
+	size_t misrouted;
+} fmu_slot_t;
+
+typedef struct {
+	fmu_slot_t* slots;
+	size_t first;
+	jm_thread_t thread;
+	int failed;
+} worker_t;
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* Every FMU has its own callbacks, so the logger can tell where a message was routed.
+   A slot is only used by the thread that owns it. */
+static void slot_logger(jm_callbacks* c, jm_string module, jm_log_level_enu_t log_level, jm_string message)
+{
+	fmu_slot_t* slot = (fmu_slot_t*)c->context;
+	if(log_level != jm_log_level_fatal) return;
+	if(strstr(message, "stress ")) {
+		if(strstr(message, slot->tag))
+			slot->received++;
+		else
+			slot->misrouted++;
+	}
+}
+
+static void worker(void* arg)
+{
+	worker_t* w = (worker_t*)arg;
+	fmi1_value_reference_t vr = VAR_S_LOGGER_TEST;
+	char value[40];
+	fmi1_string_t str = value;
+	size_t round, k, m;
+
+	for(round = 0; round < NUM_ROUNDS; round++) {
+		for(k = w->first; k < NUM_FMUS; k += NUM_THREADS) {
+			fmu_slot_t* slot = &w->slots[k];
+			if(fmi1_import_instantiate_model(slot->fmu, slot->tag) == jm_status_error) {
+				w->failed = 1;
+				return;
+			}
+			sprintf(value, "stress %s", slot->tag);
+			for(m = 0; m < NUM_MESSAGES; m++) {
+				fmi1_import_set_string(slot->fmu, &vr, 1, &str);
+			}
+			fmi1_import_free_model_instance(slot->fmu);
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	fmi1_callback_functions_t callBackFunctions;
+	fmu_slot_t* slots;
+	worker_t workers[NUM_THREADS];
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	double start;
+	size_t k;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_warning;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+	check(fmi_import_get_fmi_version(context, argv[1], argv[2]) == fmi_version_1_enu, "Only version 1.0 is supported by this code");
+	fmi_import_free_context(context);
+
+	callBackFunctions.logger = fmi1_log_forwarding;
+	callBackFunctions.allocateMemory = calloc;
+	callBackFunctions.freeMemory = free;
+
+	slots = (fmu_slot_t*)calloc(NUM_FMUS, sizeof(fmu_slot_t));
+	check(slots != 0, "Out of memory");
+	for(k = 0; k < NUM_FMUS; k++) {
+		fmu_slot_t* slot = &slots[k];
+		slot->callbacks = callbacks;
+		slot->callbacks.logger = slot_logger;
+		slot->callbacks.log_level = jm_log_level_fatal;
+		slot->callbacks.context = slot;
+		sprintf(slot->tag, "fmu%u", (unsigned)k);
+		slot->context = fmi_import_allocate_context(&slot->callbacks);
+		slot->fmu = fmi1_import_parse_xml(slot->context, argv[2]);
+		check(slot->fmu != 0, "Error parsing XML");
+		check(fmi1_import_create_dllfmu(slot->fmu, callBackFunctions, 1) != jm_status_error,
+			"Could not create the DLL loading mechanism");
+	}
+
+	start = jm_get_monotonic_time();
+	for(k = 0; k < NUM_THREADS; k++) {
+		workers[k].slots = slots;
+		workers[k].first = k;
+		workers[k].failed = 0;
+		check(jm_thread_create(&workers[k].thread, worker, &workers[k]) == jm_status_success, "Could not start a thread");
+	}
+	for(k = 0; k < NUM_THREADS; k++) {
+		jm_thread_join(&workers[k].thread);
+		check(!workers[k].failed, "fmi1_import_instantiate_model failed");
+	}
+	printf("%u messages from %u instances in %u threads took %g s\n",
+		(unsigned)(NUM_FMUS * NUM_ROUNDS * NUM_MESSAGES), (unsigned)NUM_FMUS, (unsigned)NUM_THREADS,
+		jm_get_monotonic_time() - start);
+
+	for(k = 0; k < NUM_FMUS; k++) {
+		fmu_slot_t* slot = &slots[k];
+		check(slot->misrouted == 0, "A message was routed to the wrong FMU");
+		check(slot->received == NUM_ROUNDS * NUM_MESSAGES, "A message was lost");
+		fmi1_import_destroy_dllfmu(slot->fmu);
+		fmi1_import_free(slot->fmu);
+		fmi_import_free_context(slot->context);
+	}
+	free(slots);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+	do_exit(CTEST_RETURN_SUCCESS);
+	return 0;
+}
@@ -0,0 +1,225 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config_test.h"
+#include <fmilib.h>
+
+#define NUM_FMUS 3
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* Every FMU gets its own callbacks and context since the steps run on worker threads */
+typedef struct test_fmu_t {
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi2_import_t* fmu;
+	int numFinished;
+	fmi2_status_t lastStatus;
+} test_fmu_t;
+
+static fmi2_real_t tstart = 0.0;
+static fmi2_real_t hstep = 0.1;
+static fmi2_real_t tend = 1.0;
+
+static void load_fmu(test_fmu_t* t, const char* tmpPath)
+{
+	fmi2_status_t fmistatus;
+
+	t->callbacks.malloc = malloc;
+	t->callbacks.calloc = calloc;
+	t->callbacks.realloc = realloc;
+	t->callbacks.free = free;
+	t->callbacks.logger = jm_default_logger;
+	t->callbacks.log_level = jm_log_level_warning;
+	t->callbacks.context = 0;
+	t->numFinished = 0;
+
+	t->context = fmi_import_allocate_context(&t->callbacks);
+	t->fmu = fmi2_import_parse_xml(t->context, tmpPath, 0);
+	if(!t->fmu) {
+		printf("Error parsing XML, exiting\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	/* default callbacks: stepFinished is NULL, so the steps run on the executor */
+	if(fmi2_import_create_dllfmu(t->fmu, fmi2_fmu_kind_cs, 0) == jm_status_error) {
+		printf("Could not create the DLL loading mechanism(C-API test).\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(fmi2_import_instantiate(t->fmu, "Test CS model instance", fmi2_cosimulation, "", fmi2_false) == jm_status_error) {
+		printf("fmi2_import_instantiate failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	fmistatus = fmi2_import_setup_experiment(t->fmu, fmi2_true, 1e-4, tstart, fmi2_false, tend);
+	if(fmistatus == fmi2_status_ok) fmistatus = fmi2_import_enter_initialization_mode(t->fmu);
+	if(fmistatus == fmi2_status_ok) fmistatus = fmi2_import_exit_initialization_mode(t->fmu);
+	if(fmistatus != fmi2_status_ok) {
+		printf("Initialization of the FMU failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+}
+
+static void unload_fmu(test_fmu_t* t)
+{
+	fmi2_import_terminate(t->fmu);
+	fmi2_import_free_instance(t->fmu);
+	fmi2_import_destroy_dllfmu(t->fmu);
+	fmi2_import_free(t->fmu);
+	fmi_import_free_context(t->context);
+}
+
+static fmi2_real_t get_height(test_fmu_t* t)
+{
+	fmi2_value_reference_t vr = 0;
+	fmi2_real_t h;
+	fmi2_import_get_real(t->fmu, &vr, 1, &h);
+	return h;
+}
+
+/* Each FMU gets a different gravity so that the results differ */
+static void set_gravity(test_fmu_t* t, size_t k)
+{
+	fmi2_value_reference_t vr = 2;
+	fmi2_real_t g = -9.81 * (k + 1);
+	fmi2_import_set_real(t->fmu, &vr, 1, &g);
+}
+
+/* Called from the thread that completed the step; one call per FMU and step */
+static void step_finished(fmi2_import_t* fmu, fmi2_status_t status, void* userData)
+{
+	test_fmu_t* t = (test_fmu_t*)userData;
+	if(t->fmu != fmu) {
+		printf("Wrong FMU passed to the completion callback\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	t->numFinished++;
+	t->lastStatus = status;
+}
+
+static void test_async(const char* tmpPath)
+{
+	test_fmu_t fmus[NUM_FMUS];
+	fmi2_import_step_future_t* futures[NUM_FMUS];
+	fmi2_import_async_executor_t* executor;
+	fmi2_real_t expected[NUM_FMUS];
+	fmi2_real_t t;
+	size_t k;
+	int numSteps = 0;
+
+	/* Reference: synchronous stepping */
+	for(k = 0; k < NUM_FMUS; k++) {
+		load_fmu(&fmus[k], tmpPath);
+		set_gravity(&fmus[k], k);
+		for(t = tstart; t < tend - 1e-12; t += hstep) fmi2_import_do_step(fmus[k].fmu, t, hstep, fmi2_true);
+		expected[k] = get_height(&fmus[k]);
+		unload_fmu(&fmus[k]);
+	}
+
+	executor = fmi2_import_async_executor_create(0, 2);
+	if(!executor) {
+		printf("Could not create the executor\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	for(k = 0; k < NUM_FMUS; k++) {
+		load_fmu(&fmus[k], tmpPath);
+		set_gravity(&fmus[k], k);
+	}
+
+	for(t = tstart; t < tend - 1e-12; t += hstep) {
+		for(k = 0; k < NUM_FMUS; k++) {
+			futures[k] = fmi2_import_do_step_async(executor, fmus[k].fmu, t, hstep, fmi2_true, step_finished, &fmus[k]);
+			if(!futures[k]) {
+				printf("fmi2_import_do_step_async failed\n");
+				do_exit(CTEST_RETURN_FAIL);
+			}
+		}
+		/* Only one step per FMU can be outstanding */
+		if(fmi2_import_do_step_async(executor, fmus[0].fmu, t, hstep, fmi2_true, 0, 0)) {
+			printf("A second outstanding step was accepted\n");
+			do_exit(CTEST_RETURN_FAIL);
+		}
+		for(k = 0; k < NUM_FMUS; k++) {
+			if(fmi2_import_step_future_wait(futures[k]) != fmi2_status_ok ||
+				!fmi2_import_step_future_is_done(futures[k])) {
+				printf("Asynchronous step failed\n");
+				do_exit(CTEST_RETURN_FAIL);
+			}
+			fmi2_import_step_future_free(futures[k]);
+		}
+		numSteps++;
+	}
+
+	for(k = 0; k < NUM_FMUS; k++) {
+		fmi2_real_t h = get_height(&fmus[k]);
+		printf("FMU %u: height %g (reference %g), %d steps finished\n", (unsigned)k, h, expected[k], fmus[k].numFinished);
+		if(h != expected[k] || fmus[k].numFinished != numSteps || fmus[k].lastStatus != fmi2_status_ok) {
+			printf("Asynchronous stepping differs from synchronous stepping\n");
+			do_exit(CTEST_RETURN_FAIL);
+		}
+	}
+
+	fmi2_import_async_executor_free(executor);
+	for(k = 0; k < NUM_FMUS; k++) unload_fmu(&fmus[k]);
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_version_enu_t version;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_verbose;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	version = fmi_import_get_fmi_version(context, FMUPath, tmpPath);
+	fmi_import_free_context(context);
+
+	if(version != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	test_async(tmpPath);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
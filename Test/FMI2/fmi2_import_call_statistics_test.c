@@ -0,0 +1,151 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+
+#define NUM_STEPS 20
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+#ifdef FMILIB_ENABLE_CALL_STATISTICS
+static void check_statistics(fmi2_import_t* fmu, fmi2_function_enu_t f, size_t count)
+{
+	jm_call_statistics_t stats;
+	size_t k, sum = 0;
+
+	check(fmi2_import_get_call_statistics(fmu, f, &stats) == jm_status_success, "fmi2_import_get_call_statistics failed");
+	printf("%s: %u calls, total %g s, max %g s\n", fmi2_function_to_string(f), (unsigned)stats.count, stats.total_time, stats.max_time);
+	check(stats.count == count, "Unexpected number of calls");
+	for(k = 0; k < JM_CALL_STATISTICS_BINS; k++) sum += stats.histogram[k];
+	check(sum == count, "Histogram does not sum up to the number of calls");
+	check(stats.total_time >= 0 && stats.max_time >= 0 && stats.max_time <= stats.total_time, "Inconsistent call times");
+}
+#endif
+
+int test_call_statistics(fmi2_import_t* fmu)
+{
+	fmi2_value_reference_t vr = 0;
+	fmi2_real_t t = 0.0, hstep = 0.1, h;
+	jm_call_statistics_t stats;
+	size_t k;
+
+	check(fmi2_import_instantiate(fmu, "Test CS model instance", fmi2_cosimulation, "", fmi2_false) != jm_status_error,
+		"fmi2_import_instantiate failed");
+	check(fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0) == fmi2_status_ok &&
+		fmi2_import_enter_initialization_mode(fmu) == fmi2_status_ok &&
+		fmi2_import_exit_initialization_mode(fmu) == fmi2_status_ok, "Initialization of the FMU failed");
+
+	for(k = 0; k < NUM_STEPS; k++) {
+		check(fmi2_import_do_step(fmu, t, hstep, fmi2_true) == fmi2_status_ok, "fmi2_import_do_step failed");
+		check(fmi2_import_get_real(fmu, &vr, 1, &h) == fmi2_status_ok, "fmi2_import_get_real failed");
+		t += hstep;
+	}
+
+#ifdef FMILIB_ENABLE_CALL_STATISTICS
+	check_statistics(fmu, fmi2_function_Instantiate, 1);
+	check_statistics(fmu, fmi2_function_SetupExperiment, 1);
+	check_statistics(fmu, fmi2_function_DoStep, NUM_STEPS);
+	check_statistics(fmu, fmi2_function_GetReal, NUM_STEPS);
+	check_statistics(fmu, fmi2_function_GetDerivatives, 0);
+	check(fmi2_import_get_call_statistics(fmu, fmi2_functions_Num, &stats) == jm_status_error,
+		"Statistics of an invalid function were returned");
+	fmi2_import_log_call_statistics(fmu);
+
+	fmi2_import_reset_call_statistics(fmu);
+	check_statistics(fmu, fmi2_function_DoStep, 0);
+	check(fmi2_import_do_step(fmu, t, hstep, fmi2_true) == fmi2_status_ok, "fmi2_import_do_step failed");
+	check_statistics(fmu, fmi2_function_DoStep, 1);
+#else
+	check(fmi2_import_get_call_statistics(fmu, fmi2_function_DoStep, &stats) == jm_status_error,
+		"Statistics were returned although they are compiled out");
+#endif
+
+	fmi2_import_terminate(fmu);
+	fmi2_import_free_instance(fmu);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_version_enu_t version;
+	jm_status_enu_t status;
+
+	fmi2_import_t* fmu;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_info;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	version = fmi_import_get_fmi_version(context, FMUPath, tmpPath);
+
+	if(version != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath,0);
+
+	if(!fmu) {
+		printf("Error parsing XML, exiting\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	status = fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, 0);
+	if (status == jm_status_error) {
+		printf("Could not create the DLL loading mechanism(C-API test).\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	test_call_statistics(fmu);
+
+	fmi2_import_destroy_dllfmu(fmu);
+
+	fmi2_import_free(fmu);
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
@@ -0,0 +1,240 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* Structured names, with a component and a variable of the same name, arrays, a quoted identifier and a derivative */
+static const char* structured_names[] = {
+	"plant.pump.T", "plant.pipe[10].T", "plant.grid[1,1].T", "plantX.T", "plant.pipe[2].T", "der(plant.pump.T)",
+	"plant.pipe[1].T", "plant.'x.y'.z", "plant.pump.p", "time", "plant.pump", "plant.pipe[2].wall.T"
+};
+#define NUM_STRUCTURED_NAMES (sizeof(structured_names) / sizeof(structured_names[0]))
+
+static int name_is(const char* name, size_t len, const char* expected)
+{
+	return (len == strlen(expected)) && !strncmp(name, expected, len);
+}
+
+/* Check the links and the variables of a component and its subtree. Returns the number of components. */
+static size_t check_component(fmi2_import_component_t* c)
+{
+	fmi2_import_variable_list_view_t view, subtree;
+	const char *name, *path, *parentPath;
+	size_t nameLen, pathLen, parentLen, k, count = 1, numVariables;
+	fmi2_import_component_t* parent = fmi2_import_get_parent_component(c);
+
+	name = fmi2_import_get_component_name(c, &nameLen);
+	path = fmi2_import_get_component_path(c, &pathLen);
+	if(parent) {
+		parentPath = fmi2_import_get_component_path(parent, &parentLen);
+		check(pathLen == (parentLen ? parentLen + 1 : 0) + nameLen, "The path does not extend the path of the parent");
+		check(!strncmp(path, parentPath, parentLen) && !strncmp(path + pathLen - nameLen, name, nameLen), "Unexpected path");
+		check(fmi2_import_get_child_component_by_name(parent, name, nameLen) == c, "The component is not found by name in its parent");
+	}
+
+	fmi2_import_get_component_variables(c, &view);
+	fmi2_import_get_component_subtree_variables(c, &subtree);
+	check(view.first == subtree.first, "The variables of the component must start its subtree");
+	for(k = 0; k < subtree.size; k++) {
+		fmi2_import_variable_t* v = fmi2_import_get_view_variable(&subtree, k);
+		const char* local = fmi2_import_get_variable_local_name(c, v);
+		check(local != 0 || !pathLen, "A variable of the subtree has no local name");
+		if(k < view.size) {
+			check(!pathLen || !strchr(local, '.') || !strncmp(local, "der(", 4), "A variable of the component has a structured local name");
+			if(k) check(strcmp(fmi2_import_get_variable_name(fmi2_import_get_view_variable(&view, k - 1)),
+				fmi2_import_get_variable_name(v)) < 0, "The variables of the component are not sorted");
+		}
+	}
+
+	numVariables = view.size;
+	for(k = 0; k < fmi2_import_get_number_of_child_components(c); k++) {
+		fmi2_import_component_t* child = fmi2_import_get_child_component(c, k);
+		check(fmi2_import_get_parent_component(child) == c, "Unexpected parent");
+		fmi2_import_get_component_subtree_variables(child, &view);
+		check(view.first == subtree.first + numVariables, "The subtrees of the children are not contiguous");
+		numVariables += view.size;
+		count += check_component(child);
+	}
+	check(numVariables == subtree.size, "The subtree size does not match the children");
+	check(fmi2_import_get_child_component(c, k) == 0, "A child out of range was returned");
+	return count;
+}
+
+static fmi2_import_component_t* check_find(fmi2_import_t* fmu, const char* path, size_t numChildren, size_t numVariables, size_t numSubtreeVariables)
+{
+	fmi2_import_component_t* c = fmi2_import_find_component(fmu, path);
+	fmi2_import_variable_list_view_t view;
+	const char* found;
+	size_t len;
+
+	printf("Component \"%s\"\n", path);
+	check(c != 0, "Component not found");
+	found = fmi2_import_get_component_path(c, &len);
+	check(name_is(found, len, path), "Unexpected path of the component");
+	check(fmi2_import_get_number_of_child_components(c) == numChildren, "Unexpected number of children");
+	fmi2_import_get_component_variables(c, &view);
+	check(view.size == numVariables, "Unexpected number of variables");
+	fmi2_import_get_component_subtree_variables(c, &view);
+	check(view.size == numSubtreeVariables, "Unexpected number of subtree variables");
+	return c;
+}
+
+static void test_structured(fmi_import_context_t* context, jm_callbacks* callbacks, const char* tmpPath)
+{
+	char* dir = fmi_import_mk_temp_dir(callbacks, tmpPath, "components");
+	char fileName[1000];
+	FILE* f;
+	fmi2_import_t* fmu;
+	fmi2_import_component_t *root, *plant, *c;
+	fmi2_import_variable_list_view_t view;
+	const char* name;
+	size_t k, len;
+
+	check(dir != 0, "Could not create a temporary directory");
+	sprintf(fileName, "%s/modelDescription.xml", dir);
+	f = fopen(fileName, "w");
+	check(f != 0, "Could not write the model description");
+	fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<fmiModelDescription fmiVersion=\"2.0\" modelName=\"Components\" guid=\"{components}\" variableNamingConvention=\"structured\">\n"
+		"  <CoSimulation modelIdentifier=\"Components\"/>\n  <ModelVariables>\n");
+	for(k = 0; k < NUM_STRUCTURED_NAMES; k++) {
+		fprintf(f, "    <ScalarVariable name=\"%s\" valueReference=\"%u\"><Real/></ScalarVariable>\n", structured_names[k], (unsigned)k);
+	}
+	fprintf(f, "  </ModelVariables>\n  <ModelStructure/>\n</fmiModelDescription>\n");
+	fclose(f);
+
+	fmu = fmi2_import_parse_xml(context, dir, 0);
+	check(fmu != 0, "Error parsing XML");
+	check(fmi2_import_get_naming_convention(fmu) == fmi2_naming_enu_structured, "Unexpected naming convention");
+
+	root = fmi2_import_get_root_component(fmu);
+	check(root != 0 && fmi2_import_get_root_component(fmu) == root, "Could not get the root component");
+	check(fmi2_import_get_parent_component(root) == 0, "The root must not have a parent");
+	name = fmi2_import_get_component_name(root, &len);
+	check(len == 0, "The root must have an empty name");
+	check(check_component(root) == 10, "Unexpected number of components");
+
+	/* Derivatives and top level variables belong to the root */
+	check(check_find(fmu, "", 2, 2, NUM_STRUCTURED_NAMES) == root, "The empty path must give the root");
+	fmi2_import_get_component_variables(root, &view);
+	check(!strcmp(fmi2_import_get_variable_name(fmi2_import_get_view_variable(&view, 0)), "der(plant.pump.T)"), "Unexpected variable of the root");
+
+	/* The children are ordered as the variable names, "pipe[10]" before "pipe[1]" */
+	plant = check_find(fmu, "plant", 6, 1, 9);
+	name = fmi2_import_get_component_name(fmi2_import_get_child_component(plant, 0), &len);
+	check(name_is(name, len, "'x.y'"), "Unexpected first child");
+	name = fmi2_import_get_component_name(fmi2_import_get_child_component(plant, 2), &len);
+	check(name_is(name, len, "pipe[10]"), "Unexpected third child");
+	check(fmi2_import_get_child_component_by_name(plant, "pipe[3]", 7) == 0, "A missing child was found");
+	check(fmi2_import_get_child_component_by_name(plant, "pipe", 4) == 0, "A missing child was found");
+
+	c = check_find(fmu, "plant.pump", 0, 2, 2);
+	fmi2_import_get_component_variables(c, &view);
+	check(!strcmp(fmi2_import_get_variable_local_name(c, fmi2_import_get_view_variable(&view, 1)), "p"), "Unexpected local name");
+	check(fmi2_import_get_variable_local_name(c, fmi2_import_get_variable_by_name(fmu, "plant.pump")) == 0,
+		"A variable outside the subtree has a local name");
+	check_find(fmu, "plant.'x.y'", 0, 1, 1);
+	check_find(fmu, "plant.grid[1,1]", 0, 1, 1);
+	c = check_find(fmu, "plant.pipe[2]", 1, 1, 2);
+	check(!strcmp(fmi2_import_get_variable_local_name(plant, fmi2_import_get_variable_by_name(fmu, "plant.pipe[2].wall.T")), "pipe[2].wall.T"),
+		"Unexpected local name");
+	check_find(fmu, "plant.pipe[2].wall", 0, 1, 1);
+	check_find(fmu, "plantX", 0, 1, 1);
+
+	check(fmi2_import_find_component(fmu, "plant.pipe") == 0, "A missing component was found");
+	check(fmi2_import_find_component(fmu, "plant.pump.T") == 0, "A variable was found as a component");
+	check(fmi2_import_find_component(fmu, "plant.") == 0, "A missing component was found");
+	check(fmi2_import_find_component(fmu, "time.x") == 0, "A missing component was found");
+
+	fmi2_import_free(fmu);
+	fmi_import_rmdir(callbacks, dir);
+	callbacks->free(dir);
+}
+
+/* With the flat naming convention all the variables belong to the root */
+static void test_flat(fmi2_import_t* fmu)
+{
+	fmi2_import_component_t* root = fmi2_import_get_root_component(fmu);
+	fmi2_import_variable_list_t* all = fmi2_import_get_variable_list(fmu, 0);
+	fmi2_import_variable_list_view_t view;
+
+	check(fmi2_import_get_naming_convention(fmu) == fmi2_naming_enu_flat, "Unexpected naming convention");
+	check(root != 0, "Could not get the root component");
+	check(fmi2_import_get_number_of_child_components(root) == 0, "A flat model must not have components");
+	fmi2_import_get_component_variables(root, &view);
+	check(view.size > 0 && view.size == fmi2_import_get_variable_list_size(all), "All the variables must belong to the root");
+	check(check_component(root) == 1, "Unexpected flat tree");
+	fmi2_import_free_variable_list(all);
+	check(fmi2_import_find_component(fmu, "HIGHT") == 0, "A component was found in a flat model");
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi2_import_t* fmu;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_warning;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	if(fmi_import_get_fmi_version(context, FMUPath, tmpPath) != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath, 0);
+	check(fmu != 0, "Error parsing XML");
+	test_flat(fmu);
+	fmi2_import_free(fmu);
+
+	test_structured(context, &callbacks, tmpPath);
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
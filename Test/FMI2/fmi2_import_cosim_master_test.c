@@ -0,0 +1,276 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config_test.h"
+#include <fmilib.h>
+
+#define NUM_FMUS 4
+#define NUM_CONNECTIONS 5
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* Every FMU gets its own callbacks and context since the master calls them from several threads */
+typedef struct test_fmu_t {
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi2_callback_functions_t callBackFunctions;
+	fmi2_import_t* fmu;
+} test_fmu_t;
+
+/* The dummy bouncing ball: the height (vr 0) of one ball drives the gravity (vr 2) or
+   the bounce coefficient (vr 3) of another. The last connection closes a cycle. */
+static const size_t conSrc[NUM_CONNECTIONS] = {0, 0, 1, 2, 3};
+static const size_t conDst[NUM_CONNECTIONS] = {1, 2, 3, 3, 0};
+static const fmi2_value_reference_t conDstVr[NUM_CONNECTIONS] = {2, 2, 2, 3, 2};
+
+static fmi2_real_t tstart = 0.0;
+static fmi2_real_t hstep = 0.1;
+static fmi2_real_t tend = 1.0;
+
+static void load_fmu(test_fmu_t* t, const char* tmpPath)
+{
+	fmi2_status_t fmistatus;
+
+	t->callbacks.malloc = malloc;
+	t->callbacks.calloc = calloc;
+	t->callbacks.realloc = realloc;
+	t->callbacks.free = free;
+	t->callbacks.logger = jm_default_logger;
+	t->callbacks.log_level = jm_log_level_warning;
+	t->callbacks.context = 0;
+
+	t->context = fmi_import_allocate_context(&t->callbacks);
+	t->fmu = fmi2_import_parse_xml(t->context, tmpPath, 0);
+	if(!t->fmu) {
+		printf("Error parsing XML, exiting\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	t->callBackFunctions.logger = fmi2_log_forwarding;
+	t->callBackFunctions.allocateMemory = calloc;
+	t->callBackFunctions.freeMemory = free;
+	t->callBackFunctions.componentEnvironment = t->fmu;
+
+	if(fmi2_import_create_dllfmu(t->fmu, fmi2_fmu_kind_cs, &t->callBackFunctions) == jm_status_error) {
+		printf("Could not create the DLL loading mechanism(C-API test).\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(fmi2_import_instantiate(t->fmu, "Test CS model instance", fmi2_cosimulation, "", fmi2_false) == jm_status_error) {
+		printf("fmi2_import_instantiate failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	fmistatus = fmi2_import_setup_experiment(t->fmu, fmi2_true, 1e-4, tstart, fmi2_false, tend);
+	if(fmistatus == fmi2_status_ok) fmistatus = fmi2_import_enter_initialization_mode(t->fmu);
+	if(fmistatus == fmi2_status_ok) fmistatus = fmi2_import_exit_initialization_mode(t->fmu);
+	if(fmistatus != fmi2_status_ok) {
+		printf("Initialization of the FMU failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+}
+
+static void unload_fmu(test_fmu_t* t)
+{
+	fmi2_import_terminate(t->fmu);
+	fmi2_import_free_instance(t->fmu);
+	fmi2_import_destroy_dllfmu(t->fmu);
+	fmi2_import_free(t->fmu);
+	fmi_import_free_context(t->context);
+}
+
+static fmi2_real_t get_height(test_fmu_t* t)
+{
+	fmi2_value_reference_t vr = 0;
+	fmi2_real_t h;
+	fmi2_import_get_real(t->fmu, &vr, 1, &h);
+	return h;
+}
+
+static void set_input(test_fmu_t* t, fmi2_value_reference_t vr, fmi2_real_t value)
+{
+	fmi2_import_set_real(t->fmu, &vr, 1, &value);
+}
+
+static void propagate(test_fmu_t* fmus, size_t k)
+{
+	set_input(&fmus[conDst[k]], conDstVr[k], get_height(&fmus[conSrc[k]]));
+}
+
+/* Serial reference with the semantics documented for the master. The connection 3->0
+   closes the cycle and is delayed one step. */
+static void simulate_reference(test_fmu_t* fmus, fmi2_import_cosim_master_scheme_enu_t scheme, fmi2_real_t* result)
+{
+	fmi2_real_t t;
+	size_t k;
+
+	for(k = 0; k < NUM_CONNECTIONS; k++) propagate(fmus, k);
+
+	for(t = tstart; t < tend - 1e-12; t += hstep) {
+		if(scheme == fmi2_import_cosim_master_jacobi) {
+			for(k = 0; k < NUM_FMUS; k++) fmi2_import_do_step(fmus[k].fmu, t, hstep, fmi2_true);
+			for(k = 0; k < NUM_CONNECTIONS; k++) propagate(fmus, k);
+		}
+		else {
+			propagate(fmus, 4);
+			fmi2_import_do_step(fmus[0].fmu, t, hstep, fmi2_true);
+			propagate(fmus, 0);
+			propagate(fmus, 1);
+			fmi2_import_do_step(fmus[1].fmu, t, hstep, fmi2_true);
+			fmi2_import_do_step(fmus[2].fmu, t, hstep, fmi2_true);
+			propagate(fmus, 2);
+			propagate(fmus, 3);
+			fmi2_import_do_step(fmus[3].fmu, t, hstep, fmi2_true);
+		}
+	}
+	for(k = 0; k < NUM_FMUS; k++) result[k] = get_height(&fmus[k]);
+}
+
+static void simulate_master(test_fmu_t* fmus, fmi2_import_cosim_master_scheme_enu_t scheme, size_t numThreads, fmi2_real_t* result)
+{
+	fmi2_import_cosim_master_options_t options;
+	fmi2_import_cosim_master_t* master;
+	fmi2_real_t t;
+	size_t k;
+
+	fmi2_import_cosim_master_default_options(&options);
+	options.scheme = scheme;
+	options.num_threads = numThreads;
+
+	master = fmi2_import_cosim_master_create(0, &options);
+	if(!master) {
+		printf("Could not create the master\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	for(k = 0; k < NUM_FMUS; k++) {
+		size_t index;
+		if(fmi2_import_cosim_master_add_fmu(master, fmus[k].fmu, &index) != jm_status_success || index != k) {
+			printf("fmi2_import_cosim_master_add_fmu failed\n");
+			do_exit(CTEST_RETURN_FAIL);
+		}
+	}
+	for(k = 0; k < NUM_CONNECTIONS; k++) {
+		if(fmi2_import_cosim_master_connect(master, fmi2_base_type_real, conSrc[k], 0, conDst[k], conDstVr[k]) != jm_status_success) {
+			printf("fmi2_import_cosim_master_connect failed\n");
+			do_exit(CTEST_RETURN_FAIL);
+		}
+	}
+
+	/* An input can only be connected once and an output is not an input */
+	if(fmi2_import_cosim_master_connect(master, fmi2_base_type_real, 1, 0, 3, 2) != jm_status_error ||
+		fmi2_import_cosim_master_connect(master, fmi2_base_type_real, 1, 0, 2, 0) != jm_status_error) {
+		printf("Invalid connection was accepted\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	if(fmi2_import_cosim_master_initialize(master) != jm_status_success) {
+		printf("fmi2_import_cosim_master_initialize failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(fmi2_import_cosim_master_get_number_of_fmus(master) != NUM_FMUS ||
+		fmi2_import_cosim_master_get_number_of_connections(master) != NUM_CONNECTIONS ||
+		fmi2_import_cosim_master_get_number_of_delayed_connections(master) != 1 ||
+		fmi2_import_cosim_master_get_number_of_threads(master) != numThreads) {
+		printf("Unexpected master configuration\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	for(t = tstart; t < tend - 1e-12; t += hstep) {
+		if(fmi2_import_cosim_master_do_step(master, t, hstep) != jm_status_success) {
+			printf("fmi2_import_cosim_master_do_step failed\n");
+			do_exit(CTEST_RETURN_FAIL);
+		}
+	}
+	for(k = 0; k < NUM_FMUS; k++) result[k] = get_height(&fmus[k]);
+
+	fmi2_import_cosim_master_free(master);
+}
+
+static void test_scheme(const char* tmpPath, fmi2_import_cosim_master_scheme_enu_t scheme, size_t numThreads)
+{
+	test_fmu_t fmus[NUM_FMUS];
+	fmi2_real_t expected[NUM_FMUS], result[NUM_FMUS];
+	size_t k;
+
+	for(k = 0; k < NUM_FMUS; k++) load_fmu(&fmus[k], tmpPath);
+	simulate_reference(fmus, scheme, expected);
+	for(k = 0; k < NUM_FMUS; k++) unload_fmu(&fmus[k]);
+
+	for(k = 0; k < NUM_FMUS; k++) load_fmu(&fmus[k], tmpPath);
+	simulate_master(fmus, scheme, numThreads, result);
+	for(k = 0; k < NUM_FMUS; k++) unload_fmu(&fmus[k]);
+
+	printf("%s scheme with %u threads:\n", (scheme == fmi2_import_cosim_master_jacobi) ? "Jacobi" : "Gauss-Seidel", (unsigned)numThreads);
+	for(k = 0; k < NUM_FMUS; k++) {
+		printf("  FMU %u: height %g (reference %g)\n", (unsigned)k, result[k], expected[k]);
+		/* The master does the same calls in the same order for every FMU */
+		if(result[k] != expected[k]) {
+			printf("Result differs from the reference\n");
+			do_exit(CTEST_RETURN_FAIL);
+		}
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_version_enu_t version;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_verbose;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	version = fmi_import_get_fmi_version(context, FMUPath, tmpPath);
+	fmi_import_free_context(context);
+
+	if(version != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	test_scheme(tmpPath, fmi2_import_cosim_master_jacobi, 1);
+	test_scheme(tmpPath, fmi2_import_cosim_master_jacobi, 3);
+	test_scheme(tmpPath, fmi2_import_cosim_master_gauss_seidel, 1);
+	test_scheme(tmpPath, fmi2_import_cosim_master_gauss_seidel, 3);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
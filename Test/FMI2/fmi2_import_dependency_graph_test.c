@@ -0,0 +1,342 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* 0-based variable indices of the test model */
+#define U1 0
+#define U2 1
+#define X 2
+#define DER_X 3
+#define Y1 4
+#define Y2 5
+#define Y3 6
+#define Y4 7
+
+/* Rows of the outputs */
+#define ROW_Y1 0
+#define ROW_Y2 1
+#define ROW_Y3 2
+#define ROW_Y4 3
+
+/* One string per line: C89 compilers only need to support string literals of 509 characters */
+static const char* model_description[] = {
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n",
+	"<fmiModelDescription fmiVersion=\"2.0\" modelName=\"Dependencies\" guid=\"{dependencies}\">\n",
+	"  <ModelExchange modelIdentifier=\"Dependencies\"/>\n",
+	"  <ModelVariables>\n",
+	"    <ScalarVariable name=\"u1\" valueReference=\"0\" causality=\"input\"><Real start=\"0\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"u2\" valueReference=\"1\" causality=\"input\"><Real start=\"0\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"x\" valueReference=\"2\" initial=\"exact\"><Real start=\"1\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"der(x)\" valueReference=\"3\"><Real derivative=\"3\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"y1\" valueReference=\"4\" causality=\"output\"><Real/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"y2\" valueReference=\"5\" causality=\"output\"><Real/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"y3\" valueReference=\"6\" causality=\"output\"><Real/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"y4\" valueReference=\"7\" causality=\"output\"><Real/></ScalarVariable>\n",
+	"  </ModelVariables>\n",
+	"  <ModelStructure>\n",
+	"    <Outputs>\n",
+	"      <Unknown index=\"5\" dependencies=\"1\"/>\n",
+	"      <Unknown index=\"6\" dependencies=\"2 3\"/>\n",
+	"      <Unknown index=\"7\"/>\n",
+	"      <Unknown index=\"8\" dependencies=\"\"/>\n",
+	"    </Outputs>\n",
+	"    <Derivatives>\n",
+	"      <Unknown index=\"4\" dependencies=\"3 1\" dependenciesKind=\"dependent fixed\"/>\n",
+	"    </Derivatives>\n",
+	"    <InitialUnknowns>\n",
+	"      <Unknown index=\"4\" dependencies=\"3 1\"/>\n",
+	"      <Unknown index=\"5\" dependencies=\"1\"/>\n",
+	"      <Unknown index=\"6\" dependencies=\"2 3\"/>\n",
+	"      <Unknown index=\"7\"/>\n",
+	"      <Unknown index=\"8\" dependencies=\"\"/>\n",
+	"    </InitialUnknowns>\n",
+	"  </ModelStructure>\n",
+	"</fmiModelDescription>\n",
+	0
+};
+
+/* The aliases a1, a2 and a3 all have a start value and are removed when the XML is parsed.
+   The indices of the ModelStructure are positions among the remaining variables. */
+static const char* bad_alias_description[] = {
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n",
+	"<fmiModelDescription fmiVersion=\"2.0\" modelName=\"BadAlias\" guid=\"{badAlias}\">\n",
+	"  <ModelExchange modelIdentifier=\"BadAlias\"/>\n",
+	"  <ModelVariables>\n",
+	"    <ScalarVariable name=\"a1\" valueReference=\"10\" initial=\"exact\"><Real start=\"1\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"a2\" valueReference=\"10\" initial=\"exact\"><Real start=\"2\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"a3\" valueReference=\"10\" initial=\"exact\"><Real start=\"3\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"u\" valueReference=\"0\" causality=\"input\"><Real start=\"0\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"y\" valueReference=\"1\" causality=\"output\"><Real/></ScalarVariable>\n",
+	"  </ModelVariables>\n",
+	"  <ModelStructure>\n",
+	"    <Outputs>\n",
+	"      <Unknown index=\"2\" dependencies=\"1\"/>\n",
+	"    </Outputs>\n",
+	"  </ModelStructure>\n",
+	"</fmiModelDescription>\n",
+	0
+};
+
+static void check_row(fmi2_import_sparsity_pattern_t* p, size_t row, const size_t* expected, size_t n, const char* message)
+{
+	size_t k;
+
+	check(p->start[row + 1] - p->start[row] == n, message);
+	for(k = 0; k < n; k++) check(p->index[p->start[row] + k] == expected[k], message);
+}
+
+static size_t position(const size_t* order, size_t n, size_t row)
+{
+	size_t k;
+	for(k = 0; k < n; k++) if(order[k] == row) return k;
+	return n;
+}
+
+static void test_rows(fmi2_import_t* fmu, fmi2_import_dependency_graph_t* g)
+{
+	const size_t* dep;
+	const char* kind;
+	size_t n;
+
+	check(fmi2_import_dependency_graph_get_size(g) == 4, "Unexpected number of outputs");
+	check(fmi2_import_dependency_graph_get_number_of_variables(g) == 8, "Unexpected number of variables");
+	check(fmi2_import_dependency_graph_get_row(g, fmi2_import_get_variable_by_name(fmu, "y3")) == ROW_Y3, "Unexpected row");
+	check(fmi2_import_dependency_graph_get_row(g, fmi2_import_get_variable_by_name(fmu, "u1")) == (size_t)-1, "An input has a row");
+	check(!strcmp(fmi2_import_get_variable_name(fmi2_import_dependency_graph_get_unknown(g, ROW_Y2)), "y2"), "Unexpected unknown");
+	check(fmi2_import_dependency_graph_get_unknown(g, 4) == 0, "An unknown out of range was returned");
+
+	n = fmi2_import_dependency_graph_get_dependencies(g, ROW_Y2, &dep, &kind);
+	check(n == 2 && dep[0] == U2 && dep[1] == X, "Unexpected dependencies of y2");
+
+	/* No dependencies attribute: all the knowns, i.e., the inputs and the state */
+	check(fmi2_import_dependency_graph_depends_on_all(g, ROW_Y3), "y3 must depend on all");
+	n = fmi2_import_dependency_graph_get_dependencies(g, ROW_Y3, &dep, &kind);
+	check(n == 3 && dep[0] == U1 && dep[1] == U2 && dep[2] == X, "Unexpected knowns");
+	check(kind[0] == fmi2_dependency_factor_kind_dependent, "Unexpected factor kind of the knowns");
+
+	/* Empty dependencies attribute: no dependencies */
+	check(!fmi2_import_dependency_graph_depends_on_all(g, ROW_Y4), "y4 must not depend on all");
+	check(fmi2_import_dependency_graph_get_dependencies(g, ROW_Y4, &dep, 0) == 0, "y4 must not have dependencies");
+}
+
+static void test_transpose(fmi2_import_dependency_graph_t* g)
+{
+	fmi2_import_sparsity_pattern_t csc;
+	size_t u1[] = {ROW_Y1, ROW_Y3}, u2[] = {ROW_Y2, ROW_Y3};
+
+	check(fmi2_import_dependency_graph_transpose(g, &csc) == jm_status_success, "Transpose failed");
+	check(csc.numRows == 8 && csc.numColumns == 4 && csc.start[8] == 6, "Unexpected size of the transpose");
+	check_row(&csc, U1, u1, 2, "Unexpected column of u1");
+	check_row(&csc, U2, u2, 2, "Unexpected column of u2");
+	check_row(&csc, X, u2, 2, "Unexpected column of x");
+	check_row(&csc, Y1, 0, 0, "Unexpected column of y1");
+	fmi2_import_dependency_graph_free_pattern(g, &csc);
+}
+
+static void test_connections(fmi2_import_t* fmu, fmi2_import_dependency_graph_t* g)
+{
+	fmi2_import_variable_t* u1 = fmi2_import_get_variable_by_name(fmu, "u1");
+	fmi2_import_variable_t* u2 = fmi2_import_get_variable_by_name(fmu, "u2");
+	fmi2_import_variable_t* y1 = fmi2_import_get_variable_by_name(fmu, "y1");
+	fmi2_import_variable_t* y2 = fmi2_import_get_variable_by_name(fmu, "y2");
+	fmi2_import_sparsity_pattern_t closure;
+	size_t component[4], order[4], inputs[] = {U1}, numLoops, numOrdered;
+	size_t closureY2[] = {U1, U2, X, Y1}, closureY1[] = {U1, U2, X, Y1, Y2};
+
+	check(fmi2_import_dependency_graph_components(g, component, &numLoops) == 4 && numLoops == 0, "Unexpected components without connections");
+	check(fmi2_import_dependency_graph_order(g, inputs, 1, order, &numOrdered) == jm_status_success, "Order failed");
+	check(numOrdered == 2 && order[0] == ROW_Y1 && order[1] == ROW_Y3, "Unexpected outputs affected by u1");
+
+	check(fmi2_import_dependency_graph_connect(g, u1, u2) == jm_status_error, "An input was connected as a source");
+	check(fmi2_import_dependency_graph_connect(g, y1, y2) == jm_status_error, "An output was connected as an input");
+
+	/* Feedback y1 -> u2: y2 and y3 now depend on y1 */
+	check(fmi2_import_dependency_graph_connect(g, y1, u2) == jm_status_success, "Connect failed");
+	check(fmi2_import_dependency_graph_order(g, inputs, 1, order, &numOrdered) == jm_status_success, "Order failed");
+	check(numOrdered == 3 && order[0] == ROW_Y1, "Unexpected outputs affected by u1 with feedback");
+	check(fmi2_import_dependency_graph_closure(g, &closure) == jm_status_success, "Closure failed");
+	check_row(&closure, ROW_Y2, closureY2, 4, "Unexpected closure of y2");
+	check_row(&closure, ROW_Y3, closureY2, 4, "Unexpected closure of y3");
+	check_row(&closure, ROW_Y4, 0, 0, "Unexpected closure of y4");
+	fmi2_import_dependency_graph_free_pattern(g, &closure);
+
+	/* Feedback y2 -> u1 closes the algebraic loop y1 -> y2 -> y1 */
+	check(fmi2_import_dependency_graph_connect(g, y2, u1) == jm_status_success, "Connect failed");
+	check(fmi2_import_dependency_graph_components(g, component, &numLoops) == 3 && numLoops == 1, "The algebraic loop was not found");
+	check(component[ROW_Y1] == component[ROW_Y2] && component[ROW_Y3] > component[ROW_Y1], "Unexpected components of the loop");
+	check(fmi2_import_dependency_graph_order(g, 0, 0, order, &numOrdered) == jm_status_warning, "The loop was not reported");
+	check(numOrdered == 4, "Unexpected number of ordered outputs");
+	check(position(order, 4, ROW_Y3) > position(order, 4, ROW_Y1) && position(order, 4, ROW_Y3) > position(order, 4, ROW_Y2),
+		"y3 must come after the loop");
+	check(fmi2_import_dependency_graph_closure(g, &closure) == jm_status_success, "Closure failed");
+	check_row(&closure, ROW_Y1, closureY1, 5, "Unexpected closure of y1 in the loop");
+	fmi2_import_dependency_graph_free_pattern(g, &closure);
+}
+
+static char* write_model(jm_callbacks* callbacks, const char* tmpPath, const char** description)
+{
+	char* dir = fmi_import_mk_temp_dir(callbacks, tmpPath, "dependencies");
+	char fileName[1000];
+	FILE* f;
+	size_t k;
+
+	check(dir != 0, "Could not create a temporary directory");
+	sprintf(fileName, "%s/modelDescription.xml", dir);
+	f = fopen(fileName, "w");
+	check(f != 0, "Could not write the model description");
+	for(k = 0; description[k]; k++) fputs(description[k], f);
+	fclose(f);
+	return dir;
+}
+
+static void test_model(fmi_import_context_t* context, jm_callbacks* callbacks, const char* tmpPath)
+{
+	char* dir = write_model(callbacks, tmpPath, model_description);
+	fmi2_import_t* fmu;
+	fmi2_import_dependency_graph_t* g;
+	const size_t* dep;
+	const char* kind;
+
+	fmu = fmi2_import_parse_xml(context, dir, 0);
+	check(fmu != 0, "Error parsing XML");
+
+	g = fmi2_import_dependency_graph_create(fmu, fmi2_import_outputs_dependencies);
+	check(g != 0, "Could not create the dependency graph of the outputs");
+	test_rows(fmu, g);
+	test_transpose(g);
+	test_connections(fmu, g);
+	fmi2_import_dependency_graph_free(g);
+
+	g = fmi2_import_dependency_graph_create(fmu, fmi2_import_derivatives_dependencies);
+	check(g != 0 && fmi2_import_dependency_graph_get_size(g) == 1, "Could not create the dependency graph of the derivatives");
+	check(fmi2_import_dependency_graph_get_dependencies(g, 0, &dep, &kind) == 2 && dep[0] == X && dep[1] == U1, "Unexpected dependencies of der(x)");
+	check(kind[1] == fmi2_dependency_factor_kind_fixed, "Unexpected factor kind");
+	fmi2_import_dependency_graph_free(g);
+
+	/* At initialization the variables with initial="exact" are known too */
+	g = fmi2_import_dependency_graph_create(fmu, fmi2_import_initial_unknowns_dependencies);
+	check(g != 0 && fmi2_import_dependency_graph_get_size(g) == 5, "Could not create the dependency graph of the initial unknowns");
+	check(fmi2_import_dependency_graph_get_row(g, fmi2_import_get_variable_by_name(fmu, "der(x)")) == 0, "Unexpected row of der(x)");
+	check(fmi2_import_dependency_graph_get_dependencies(g, 3, &dep, 0) == 3, "Unexpected knowns at initialization");
+	check(fmi2_import_dependency_graph_get_dependencies(g, 5, &dep, &kind) == 0 && dep == 0 && kind == 0, "A row out of range must have no dependencies");
+	fmi2_import_dependency_graph_free(g);
+
+	fmi2_import_free(fmu);
+	fmi_import_rmdir(callbacks, dir);
+	callbacks->free(dir);
+}
+
+/* The variable indices are positions in the variable list, also when bad aliases were removed */
+static void test_bad_alias(fmi_import_context_t* context, jm_callbacks* callbacks, const char* tmpPath)
+{
+	char* dir = write_model(callbacks, tmpPath, bad_alias_description);
+	fmi2_import_t* fmu;
+	fmi2_import_dependency_graph_t* g;
+	fmi2_import_variable_t* u;
+	fmi2_import_variable_t* y;
+	const size_t* dep;
+	size_t component, numLoops;
+
+	fmu = fmi2_import_parse_xml(context, dir, 0);
+	check(fmu != 0, "Error parsing XML");
+	check(fmi2_import_get_variable_by_name(fmu, "a1") == 0, "The bad aliases must be removed");
+	u = fmi2_import_get_variable_by_name(fmu, "u");
+	y = fmi2_import_get_variable_by_name(fmu, "y");
+	check(u != 0 && y != 0, "Missing variables of the bad alias model");
+
+	g = fmi2_import_dependency_graph_create(fmu, fmi2_import_outputs_dependencies);
+	check(g != 0 && fmi2_import_dependency_graph_get_size(g) == 1, "Could not create the dependency graph of the bad alias model");
+	check(fmi2_import_dependency_graph_get_number_of_variables(g) == 2, "Unexpected number of variables");
+	check(fmi2_import_dependency_graph_get_unknown(g, 0) == y, "Unexpected unknown");
+	check(fmi2_import_dependency_graph_get_row(g, y) == 0, "Unexpected row of y");
+	check(fmi2_import_dependency_graph_get_row(g, u) == (size_t)-1, "u is not an unknown");
+	check(fmi2_import_dependency_graph_get_dependencies(g, 0, &dep, 0) == 1 && dep[0] == 0, "Unexpected dependency of y");
+	check(fmi2_import_dependency_graph_connect(g, y, u) == jm_status_success, "Could not connect y to u");
+	check(fmi2_import_dependency_graph_components(g, &component, &numLoops) == 1 && numLoops == 1, "The feedback of y to u must be an algebraic loop");
+	fmi2_import_dependency_graph_free(g);
+
+	fmi2_import_free(fmu);
+	fmi_import_rmdir(callbacks, dir);
+	callbacks->free(dir);
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi2_import_t* fmu;
+	fmi2_import_dependency_graph_t* g;
+	const size_t* dep;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_warning;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	if(fmi_import_get_fmi_version(context, FMUPath, tmpPath) != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath, 0);
+	check(fmu != 0, "Error parsing XML");
+
+	/* The first derivative of the dummy model depends on all, the second on GRAVITY */
+	g = fmi2_import_dependency_graph_create(fmu, fmi2_import_derivatives_dependencies);
+	check(g != 0 && fmi2_import_dependency_graph_get_size(g) == 2, "Unexpected derivatives of the dummy model");
+	check(fmi2_import_dependency_graph_depends_on_all(g, 0), "The first derivative must depend on all");
+	check(fmi2_import_dependency_graph_get_dependencies(g, 1, &dep, 0) == 1 && dep[0] == 5, "Unexpected dependency of the second derivative");
+	fmi2_import_dependency_graph_free(g);
+	fmi2_import_free(fmu);
+
+	test_model(context, &callbacks, tmpPath);
+	test_bad_alias(context, &callbacks, tmpPath);
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
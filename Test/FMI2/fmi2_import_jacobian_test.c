@@ -0,0 +1,266 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config_test.h"
+#include <fmilib.h>
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* The dummy model is der(h) = v, der(v) = g. Derivatives lists no dependencies for der(h),
+   i.e., it depends on all states, and only the parameter g for der(v). */
+void test_jacobian(fmi2_import_t* fmu)
+{
+	fmi2_import_jacobian_t* jac;
+	const size_t *rowStart, *colIndex, *colStart, *rowIndex;
+	const fmi2_real_t *values, *cscValues;
+	fmi2_real_t x[2], dx[2];
+	jm_status_enu_t jmstatus;
+	size_t k;
+
+	jmstatus = fmi2_import_instantiate(fmu, "Test Jacobian instance", fmi2_model_exchange, 0, 0);
+	if (jmstatus == jm_status_error) {
+		printf("fmi2_import_instantiate failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0);
+	fmi2_import_enter_initialization_mode(fmu);
+	fmi2_import_exit_initialization_mode(fmu);
+	fmi2_import_enter_continuous_time_mode(fmu);
+
+	jac = fmi2_import_jacobian_create(fmu, fmi2_import_jacobian_method_auto);
+	if(!jac) {
+		printf("fmi2_import_jacobian_create failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(fmi2_import_jacobian_get_method(jac) != fmi2_import_jacobian_method_finite_differences) {
+		printf("Expected finite differences since the FMU does not provide directional derivatives\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(fmi2_import_jacobian_get_dimension(jac) != 2 || fmi2_import_jacobian_get_nnz(jac) != 2 ||
+	   fmi2_import_jacobian_get_number_of_colors(jac) != 2) {
+		printf("Unexpected Jacobian structure: dimension %u, nnz %u, colors %u\n",
+			(unsigned)fmi2_import_jacobian_get_dimension(jac), (unsigned)fmi2_import_jacobian_get_nnz(jac),
+			(unsigned)fmi2_import_jacobian_get_number_of_colors(jac));
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmi2_import_get_continuous_states(fmu, x, 2);
+	fmi2_import_get_derivatives(fmu, dx, 2);
+	if(fmi2_import_jacobian_evaluate(jac, x, dx) != jm_status_success ||
+	   fmi2_import_jacobian_evaluate(jac, 0, 0) != jm_status_success) {
+		printf("fmi2_import_jacobian_evaluate failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmi2_import_jacobian_get_csr(jac, &rowStart, &colIndex, &values);
+	fmi2_import_jacobian_get_csc(jac, &colStart, &rowIndex, &cscValues);
+	if(rowStart[0] != 0 || rowStart[1] != 2 || rowStart[2] != 2 || colIndex[0] != 0 || colIndex[1] != 1) {
+		printf("Unexpected CSR pattern\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(colStart[0] != 0 || colStart[1] != 1 || colStart[2] != 2 || rowIndex[0] != 0 || rowIndex[1] != 0) {
+		printf("Unexpected CSC pattern\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	for(k = 0; k < 2; k++) {
+		fmi2_real_t expected = (k == 0) ? 0.0 : 1.0;
+		fmi2_real_t err = values[k] - expected;
+		if(err < 0) err = -err;
+		if(err > 1e-6 || values[k] != cscValues[k]) {
+			printf("Wrong Jacobian value J(0,%u) = %g\n", (unsigned)k, values[k]);
+			do_exit(CTEST_RETURN_FAIL);
+		}
+	}
+
+	/* The states must be restored after the perturbations */
+	{
+		fmi2_real_t xafter[2];
+		fmi2_import_get_continuous_states(fmu, xafter, 2);
+		if(xafter[0] != x[0] || xafter[1] != x[1]) {
+			printf("States were not restored after Jacobian evaluation\n");
+			do_exit(CTEST_RETURN_FAIL);
+		}
+	}
+
+	fmi2_import_jacobian_free(jac);
+	fmi2_import_terminate(fmu);
+	fmi2_import_free_instance(fmu);
+}
+
+/* The bouncing ball of the dummy model after three aliases with start values. The aliases are removed
+   when the XML is parsed: the derivative attributes count them, the ModelStructure indices do not. */
+static const char* bad_alias_description[] = {
+	"<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n",
+	"<fmiModelDescription fmiVersion=\"2.0\" modelName=\"BouncingBall\" guid=\"123\">\n",
+	"  <ModelExchange modelIdentifier=\"BouncingBall2\"/>\n",
+	"  <ModelVariables>\n",
+	"    <ScalarVariable name=\"a1\" valueReference=\"10\" initial=\"exact\"><Real start=\"1\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"a2\" valueReference=\"10\" initial=\"exact\"><Real start=\"2\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"a3\" valueReference=\"10\" initial=\"exact\"><Real start=\"3\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"HIGHT\" valueReference=\"0\" causality=\"output\" initial=\"exact\"><Real start=\"1\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"HIGHT_SPEED\" valueReference=\"1\" initial=\"exact\"><Real start=\"4\" derivative=\"4\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"HIGHT_ACC\" valueReference=\"4\"><Real derivative=\"5\"/></ScalarVariable>\n",
+	"    <ScalarVariable name=\"GRAVITY\" valueReference=\"2\" initial=\"exact\"><Real start=\"-9.81\"/></ScalarVariable>\n",
+	"  </ModelVariables>\n",
+	"  <ModelStructure>\n",
+	"    <Outputs>\n",
+	"      <Unknown index=\"1\"/>\n",
+	"    </Outputs>\n",
+	"    <Derivatives>\n",
+	"      <Unknown index=\"2\" dependencies=\"2\"/>\n",
+	"      <Unknown index=\"3\" dependencies=\"4\"/>\n",
+	"    </Derivatives>\n",
+	"  </ModelStructure>\n",
+	"</fmiModelDescription>\n",
+	0
+};
+
+/* The states are found by their position in the variable list, also when bad aliases were removed */
+void test_bad_alias(fmi_import_context_t* context, jm_callbacks* callbacks, const char* FMUPath, const char* tmpPath)
+{
+	char* dir = fmi_import_mk_temp_dir(callbacks, tmpPath, "jacobian");
+	char path[1000];
+	FILE* f;
+	size_t k;
+	fmi2_callback_functions_t callBackFunctions;
+	fmi2_import_t* fmu;
+	fmi2_import_jacobian_t* jac;
+	const size_t *rowStart, *colIndex;
+	const fmi2_real_t* values;
+
+	/* The dummy model is unpacked for its shared library, the model description is replaced */
+	if(!dir || fmi_import_get_fmi_version(context, FMUPath, dir) != fmi_version_2_0_enu) {
+		printf("Could not unpack the dummy model\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	sprintf(path, "%s%s%s", dir, FMI_FILE_SEP, "modelDescription.xml");
+	f = fopen(path, "w");
+	if(!f) {
+		printf("Could not write the model description\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	for(k = 0; bad_alias_description[k]; k++) fputs(bad_alias_description[k], f);
+	fclose(f);
+
+	fmu = fmi2_import_parse_xml(context, dir, 0);
+	if(!fmu || fmi2_import_get_variable_by_name(fmu, "a1")) {
+		printf("Expected the bad aliases to be removed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	callBackFunctions.logger = fmi2_log_forwarding;
+	callBackFunctions.allocateMemory = calloc;
+	callBackFunctions.freeMemory = free;
+	callBackFunctions.componentEnvironment = fmu;
+	if(fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_me, &callBackFunctions) == jm_status_error) {
+		printf("Could not load the dummy model for the bad alias test\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	/* der(HIGHT) depends on HIGHT_SPEED only, der(HIGHT_SPEED) on no state */
+	jac = fmi2_import_jacobian_create(fmu, fmi2_import_jacobian_method_finite_differences);
+	if(!jac || fmi2_import_jacobian_get_dimension(jac) != 2 || fmi2_import_jacobian_get_nnz(jac) != 1) {
+		printf("Unexpected Jacobian structure with bad aliases\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	fmi2_import_jacobian_get_csr(jac, &rowStart, &colIndex, &values);
+	if(rowStart[1] != 1 || rowStart[2] != 1 || colIndex[0] != 1) {
+		printf("Unexpected CSR pattern with bad aliases\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	fmi2_import_jacobian_free(jac);
+
+	fmi2_import_destroy_dllfmu(fmu);
+	fmi2_import_free(fmu);
+	fmi_import_rmdir(callbacks, dir);
+	callbacks->free(dir);
+}
+
+int main(int argc, char *argv[])
+{
+	fmi2_callback_functions_t callBackFunctions;
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_version_enu_t version;
+	jm_status_enu_t status;
+
+	fmi2_import_t* fmu;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_verbose;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	version = fmi_import_get_fmi_version(context, FMUPath, tmpPath);
+
+	if(version != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath,0);
+
+	if(!fmu) {
+		printf("Error parsing XML, exiting\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	callBackFunctions.logger = fmi2_log_forwarding;
+	callBackFunctions.allocateMemory = calloc;
+	callBackFunctions.freeMemory = free;
+	callBackFunctions.componentEnvironment = fmu;
+
+	status = fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_me, &callBackFunctions);
+	if (status == jm_status_error) {
+		printf("Could not create the DLL loading mechanism(C-API test).\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	test_jacobian(fmu);
+
+	fmi2_import_destroy_dllfmu(fmu);
+
+	fmi2_import_free(fmu);
+	test_bad_alias(context, &callbacks, FMUPath, tmpPath);
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
@@ -0,0 +1,190 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+
+#define NUM_MESSAGES 100
+#define INSTANCE_NAME "Test CS model instance"
+
+/* The dummy FMU logs the value of this string variable with status fatal and category "INFO" */
+#define VAR_S_LOGGER_TEST 0
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+static int received = 0;
+
+static void importlogger(jm_callbacks* c, jm_string module, jm_log_level_enu_t log_level, jm_string message)
+{
+	if(strstr(message, "filtered message")) received++;
+}
+
+/* Log NUM_MESSAGES messages from the FMU and return how many reached the logger */
+static int log_messages(fmi2_import_t* fmu)
+{
+	fmi2_value_reference_t vr = VAR_S_LOGGER_TEST;
+	char value[40];
+	fmi2_string_t str = value;
+	int k;
+
+	received = 0;
+	for(k = 0; k < NUM_MESSAGES; k++) {
+		sprintf(value, "filtered message %d", k);
+		fmi2_import_set_string(fmu, &vr, 1, &str);
+	}
+	return received;
+}
+
+static void test_rule_precedence(void)
+{
+	fmi2_import_log_filter_t* filter = fmi2_import_log_filter_create(0);
+
+	check(filter != 0, "fmi2_import_log_filter_create failed");
+	check(fmi2_import_log_filter_accept(filter, "a", "cat", jm_log_level_info, jm_log_level_info), "Default level not applied");
+	check(!fmi2_import_log_filter_accept(filter, "a", "cat", jm_log_level_verbose, jm_log_level_info), "Default level not applied");
+
+	fmi2_import_log_filter_set_level(filter, 0, 0, jm_log_level_error);
+	fmi2_import_log_filter_set_level(filter, 0, "cat", jm_log_level_nothing);
+	fmi2_import_log_filter_set_level(filter, "a", 0, jm_log_level_warning);
+	fmi2_import_log_filter_set_level(filter, "b", "cat", jm_log_level_all);
+
+	check(!fmi2_import_log_filter_accept(filter, "c", "other", jm_log_level_warning, jm_log_level_all), "Rule for any pair not applied");
+	check(fmi2_import_log_filter_accept(filter, "c", "other", jm_log_level_error, jm_log_level_all), "Rule for any pair not applied");
+	check(!fmi2_import_log_filter_accept(filter, "c", "cat", jm_log_level_fatal, jm_log_level_all), "Category rule not applied");
+	check(fmi2_import_log_filter_accept(filter, "a", "cat", jm_log_level_warning, jm_log_level_all), "Instance rule must win over the category rule");
+	check(!fmi2_import_log_filter_accept(filter, "a", "cat", jm_log_level_info, jm_log_level_all), "Instance rule not applied");
+	check(fmi2_import_log_filter_accept(filter, "b", "cat", jm_log_level_verbose, jm_log_level_nothing), "Pair rule must win");
+	check(!fmi2_import_log_filter_accept(filter, 0, 0, jm_log_level_warning, jm_log_level_all), "NULL names must match the rule for any pair");
+
+	fmi2_import_log_filter_clear(filter);
+	check(fmi2_import_log_filter_accept(filter, "c", "cat", jm_log_level_fatal, jm_log_level_fatal), "Rules not cleared");
+	fmi2_import_log_filter_free(filter);
+}
+
+static void test_fmu_filter(fmi2_import_t* fmu)
+{
+	fmi2_import_log_filter_t* filter = fmi2_import_log_filter_create(0);
+	fmi2_import_log_filter_statistics_t stats;
+	int n;
+
+	check(filter != 0, "fmi2_import_log_filter_create failed");
+	check(fmi2_import_instantiate(fmu, INSTANCE_NAME, fmi2_cosimulation, 0, 0) != jm_status_error, "fmi2_import_instantiate failed");
+	check(log_messages(fmu) == NUM_MESSAGES, "Messages lost without a filter");
+
+	fmi2_import_set_log_filter(fmu, filter);
+	check(fmi2_import_get_log_filter(fmu) == filter, "The filter was not set");
+	check(fmi2_import_apply_log_filter_categories(fmu, INSTANCE_NAME) == fmi2_status_ok, "fmi2_import_apply_log_filter_categories failed");
+	check(log_messages(fmu) == NUM_MESSAGES, "Messages lost with an empty filter");
+
+	/* Category level */
+	fmi2_import_log_filter_set_level(filter, 0, "INFO", jm_log_level_nothing);
+	check(log_messages(fmu) == 0, "The category level was not applied");
+	fmi2_import_log_filter_set_level(filter, INSTANCE_NAME, 0, jm_log_level_fatal);
+	check(log_messages(fmu) == NUM_MESSAGES, "The instance level must win over the category level");
+	fmi2_import_log_filter_clear(filter);
+
+	/* First 3, then every 10th of the remaining 97 */
+	fmi2_import_log_filter_set_sampling(filter, INSTANCE_NAME, "INFO", 3, 10);
+	n = log_messages(fmu);
+	printf("Sampling passed %d of %d messages\n", n, NUM_MESSAGES);
+	check(n == 3 + (NUM_MESSAGES - 3) / 10, "Unexpected number of sampled messages");
+
+	/* A bucket that is practically not refilled */
+	fmi2_import_log_filter_clear(filter);
+	fmi2_import_log_filter_set_rate_limit(filter, 0, "INFO", 1e-9, 5);
+	n = log_messages(fmu);
+	printf("Rate limit passed %d of %d messages\n", n, NUM_MESSAGES);
+	check(n == 5, "Unexpected number of rate limited messages");
+
+	fmi2_import_log_filter_get_statistics(filter, &stats);
+	printf("Passed %u, rejected by level %u, by sampling %u, by rate %u\n", (unsigned)stats.passed,
+		(unsigned)stats.rejected_level, (unsigned)stats.rejected_sampling, (unsigned)stats.rejected_rate);
+	check(stats.rejected_level == NUM_MESSAGES, "Unexpected level statistics");
+	check(stats.rejected_sampling == NUM_MESSAGES - 12, "Unexpected sampling statistics");
+	check(stats.rejected_rate == NUM_MESSAGES - 5, "Unexpected rate statistics");
+
+	fmi2_import_set_log_filter(fmu, 0);
+	check(log_messages(fmu) == NUM_MESSAGES, "Messages lost after removing the filter");
+	fmi2_import_free_instance(fmu);
+	fmi2_import_log_filter_free(filter);
+}
+
+int main(int argc, char *argv[])
+{
+	fmi2_callback_functions_t callBackFunctions;
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi2_import_t* fmu;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = importlogger;
+	callbacks.log_level = jm_log_level_info;
+	callbacks.context = 0;
+
+	test_rule_precedence();
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	if(fmi_import_get_fmi_version(context, FMUPath, tmpPath) != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath, 0);
+	check(fmu != 0, "Error parsing XML");
+
+	callBackFunctions.logger = fmi2_log_forwarding;
+	callBackFunctions.allocateMemory = calloc;
+	callBackFunctions.freeMemory = free;
+	callBackFunctions.componentEnvironment = fmu;
+
+	check(fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, &callBackFunctions) != jm_status_error,
+		"Could not create the DLL loading mechanism");
+
+	test_fmu_filter(fmu);
+
+	fmi2_import_destroy_dllfmu(fmu);
+	fmi2_import_free(fmu);
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
@@ -0,0 +1,254 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+#include <JM/jm_thread.h>
+
+#define NUM_MESSAGES 1000
+#define SMALL_CAPACITY 4
+
+/* The dummy FMU logs the value of this string variable */
+#define VAR_S_LOGGER_TEST 0
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* Messages from the FMU come from the sink thread, the library logs on the main thread */
+static jm_mutex_t log_lock;
+static int fmu_messages = 0;
+static int out_of_order = 0;
+static int expanded_init = 0;
+static int unexpanded = 0;
+static int library_messages = 0;
+
+static void importlogger(jm_callbacks* c, jm_string module, jm_log_level_enu_t log_level, jm_string message)
+{
+	const char* p;
+
+	jm_mutex_lock(&log_lock);
+	if(strstr(message, "library message")) {
+		library_messages++;
+	}
+	else if((p = strstr(message, "message ")) != 0) {
+		if(atoi(p + 8) != fmu_messages) out_of_order++;
+		fmu_messages++;
+	}
+	else if(strstr(message, "Init ")) {
+		if(strstr(message, "#r")) unexpanded++;
+		else expanded_init++;
+	}
+	jm_mutex_unlock(&log_lock);
+}
+
+/* The FMU messages are formatted on the FMU thread and delivered by the sink */
+static void test_fmu_log_sink(fmi2_import_t* fmu)
+{
+	jm_log_sink_t* sink = jm_log_sink_create(0, 16, jm_log_sink_policy_block);
+	jm_log_sink_statistics_t stats;
+	fmi2_value_reference_t vr = VAR_S_LOGGER_TEST;
+	char value[40];
+	fmi2_string_t str = value;
+	int k;
+
+	check(sink != 0, "jm_log_sink_create failed");
+	fmi2_import_set_log_sink(fmu, sink);
+	check(fmi2_import_get_log_sink(fmu) == sink, "The log sink was not set");
+
+	check(fmi2_import_instantiate(fmu, "Test CS model instance", fmi2_cosimulation, 0, 0) != jm_status_error, "fmi2_import_instantiate failed");
+	check(fmi2_import_setup_experiment(fmu, fmi2_true, 1e-5, 0.0, fmi2_false, 0.0) == fmi2_status_ok, "fmi2_import_setup_experiment failed");
+	check(fmi2_import_enter_initialization_mode(fmu) == fmi2_status_ok, "fmi2_import_enter_initialization_mode failed");
+	check(fmi2_import_exit_initialization_mode(fmu) == fmi2_status_ok, "fmi2_import_exit_initialization_mode failed");
+	for(k = 0; k < NUM_MESSAGES; k++) {
+		sprintf(value, "message %d", k);
+		fmi2_import_set_string(fmu, &vr, 1, &str);
+	}
+	fmi2_import_terminate(fmu);
+	fmi2_import_free_instance(fmu);
+
+	/* Removing the sink waits for the delivery */
+	fmi2_import_set_log_sink(fmu, 0);
+	jm_log_sink_get_statistics(sink, &stats);
+	printf("Posted %u, delivered %u in %u batches, blocked %u times, at most %u queued\n",
+		(unsigned)stats.posted, (unsigned)stats.delivered, (unsigned)stats.batches, (unsigned)stats.blocked, (unsigned)stats.max_queued);
+	check(stats.dropped == 0 && stats.posted == stats.delivered, "Messages were lost with the blocking policy");
+	check(stats.max_queued <= 16, "The capacity of the sink was exceeded");
+	jm_log_sink_free(sink);
+
+	jm_mutex_lock(&log_lock);
+	check(fmu_messages == NUM_MESSAGES, "Not all the FMU messages were delivered");
+	check(out_of_order == 0, "The FMU messages were delivered out of order");
+	check(expanded_init > 0 && unexpanded == 0, "The variable references were not expanded");
+	jm_mutex_unlock(&log_lock);
+}
+
+/* Delivery that is held on the first message until the gate is opened */
+typedef struct {
+	jm_mutex_t lock;
+	jm_cond_t cond;
+	int entered;
+	int open;
+	int received[2 * SMALL_CAPACITY];
+	int count;
+} gate_t;
+
+static void gate_deliver(void* target, jm_string module, jm_log_level_enu_t log_level, jm_string message)
+{
+	gate_t* gate = (gate_t*)target;
+
+	jm_mutex_lock(&gate->lock);
+	gate->entered = 1;
+	jm_cond_broadcast(&gate->cond);
+	while(!gate->open) jm_cond_wait(&gate->cond, &gate->lock);
+	gate->received[gate->count++] = atoi(message);
+	jm_mutex_unlock(&gate->lock);
+}
+
+/* Post 0, wait until it is being delivered, then post 1 .. 2*SMALL_CAPACITY - 1 into the sink of SMALL_CAPACITY */
+static void test_drop_policy(jm_log_sink_policy_enu_t policy)
+{
+	jm_log_sink_t* sink = jm_log_sink_create(0, SMALL_CAPACITY, policy);
+	jm_log_sink_statistics_t stats;
+	gate_t gate;
+	char message[20];
+	int k, dropped = 0;
+
+	check(sink != 0, "jm_log_sink_create failed");
+	jm_mutex_init(&gate.lock);
+	jm_cond_init(&gate.cond);
+	gate.entered = gate.open = gate.count = 0;
+
+	jm_log_sink_post(sink, gate_deliver, &gate, 0, jm_log_level_info, "0");
+	jm_mutex_lock(&gate.lock);
+	while(!gate.entered) jm_cond_wait(&gate.cond, &gate.lock);
+	jm_mutex_unlock(&gate.lock);
+
+	for(k = 1; k < 2 * SMALL_CAPACITY; k++) {
+		sprintf(message, "%d", k);
+		if(jm_log_sink_post(sink, gate_deliver, &gate, "TEST", jm_log_level_info, message) == jm_status_warning) dropped++;
+	}
+
+	jm_mutex_lock(&gate.lock);
+	gate.open = 1;
+	jm_cond_broadcast(&gate.cond);
+	jm_mutex_unlock(&gate.lock);
+	jm_log_sink_flush(sink);
+	jm_log_sink_get_statistics(sink, &stats);
+	printf("Policy '%s': delivered %u, dropped %u\n", jm_log_sink_policy_to_string(policy), (unsigned)stats.delivered, (unsigned)stats.dropped);
+
+	check(stats.dropped == SMALL_CAPACITY - 1, "Unexpected number of dropped messages");
+	check(gate.count == SMALL_CAPACITY + 1 && gate.received[0] == 0, "Unexpected number of delivered messages");
+	for(k = 1; k <= SMALL_CAPACITY; k++) {
+		int expected = (policy == jm_log_sink_policy_drop_newest) ? k : k + SMALL_CAPACITY - 1;
+		check(gate.received[k] == expected, "The wrong messages were dropped");
+	}
+	if(policy == jm_log_sink_policy_drop_newest)
+		check(dropped == SMALL_CAPACITY - 1, "jm_log_sink_post did not report the dropped messages");
+
+	jm_log_sink_free(sink);
+	jm_cond_destroy(&gate.cond);
+	jm_mutex_destroy(&gate.lock);
+}
+
+/* Library messages through wrapped callbacks */
+static void test_wrapped_callbacks(jm_callbacks* parent)
+{
+	jm_log_sink_t* sink = jm_log_sink_create(parent, 0, jm_log_sink_policy_block);
+	jm_log_sink_callbacks_t wrapper;
+	jm_callbacks* cb;
+	int k;
+
+	check(sink != 0, "jm_log_sink_create failed");
+	cb = jm_log_sink_wrap_callbacks(sink, parent, &wrapper);
+	for(k = 0; k < 10; k++) {
+		jm_log_info(cb, "TEST", "library message %d", k);
+	}
+	jm_log_verbose(cb, "TEST", "library message above the log level");
+	jm_log_sink_free(sink);
+
+	jm_mutex_lock(&log_lock);
+	check(library_messages == 10, "The library messages were not delivered");
+	jm_mutex_unlock(&log_lock);
+}
+
+int main(int argc, char *argv[])
+{
+	fmi2_callback_functions_t callBackFunctions;
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi2_import_t* fmu;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	jm_mutex_init(&log_lock);
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = importlogger;
+	callbacks.log_level = jm_log_level_info;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	if(fmi_import_get_fmi_version(context, FMUPath, tmpPath) != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath, 0);
+	check(fmu != 0, "Error parsing XML");
+
+	callBackFunctions.logger = fmi2_log_forwarding;
+	callBackFunctions.allocateMemory = calloc;
+	callBackFunctions.freeMemory = free;
+	callBackFunctions.componentEnvironment = fmu;
+
+	check(fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, &callBackFunctions) != jm_status_error,
+		"Could not create the DLL loading mechanism");
+
+	test_fmu_log_sink(fmu);
+	test_drop_policy(jm_log_sink_policy_drop_newest);
+	test_drop_policy(jm_log_sink_policy_drop_oldest);
+	test_wrapped_callbacks(&callbacks);
+
+	fmi2_import_destroy_dllfmu(fmu);
+	fmi2_import_free(fmu);
+	fmi_import_free_context(context);
+	jm_mutex_destroy(&log_lock);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
@@ -0,0 +1,253 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+
+#define NUM_ROWS 50
+#define MAX_VARS 20
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* A matrix read from a MATLAB v4 file */
+typedef struct test_matrix_t {
+	int type;
+	int rows;
+	int cols;
+	char name[32];
+	char* data;
+} test_matrix_t;
+
+static void read_matrix(FILE* f, test_matrix_t* m, const char* expectedName)
+{
+	int header[5];
+	size_t elemSize;
+
+	check(fread(header, sizeof(int), 5, f) == 5 && header[3] == 0 && header[4] <= (int)sizeof(m->name), "Wrong matrix header");
+	check(fread(m->name, 1, header[4], f) == (size_t)header[4] && strcmp(m->name, expectedName) == 0, "Unexpected matrix");
+	m->type = header[0] % 1000;
+	m->rows = header[1];
+	m->cols = header[2];
+	elemSize = (m->type == 0) ? 8 : (m->type == 20) ? 4 : 1;
+	m->data = (char*)malloc(elemSize * m->rows * m->cols + 1);
+	check(m->data && fread(m->data, elemSize, m->rows * m->cols, f) == (size_t)(m->rows * m->cols), "Matrix is truncated");
+}
+
+static int find_name(test_matrix_t* names, const char* name)
+{
+	int k;
+	for(k = 0; k < names->cols; k++) {
+		if(strncmp(names->data + k * names->rows, name, names->rows) == 0) return k;
+	}
+	return -1;
+}
+
+static int is_recordable(fmi2_import_variable_t* v, void* context)
+{
+	/* The dummy FMU has no storage for the real "A variable" */
+	return fmi2_import_get_variable_vr(v) < 100;
+}
+
+void test_mat_writer(fmi2_import_t* fmu, const char* tmpPath)
+{
+	fmi2_import_mat_writer_t* writer;
+	fmi2_import_variable_list_t *all, *vl;
+	test_matrix_t aclass, name, desc, dataInfo, data1, data2;
+	char fileName[1000];
+	fmi2_real_t heights[NUM_ROWS], times[NUM_ROWS], t = 0.0, hstep = 0.01, *d;
+	int* info;
+	int k, hight, gravity, speed, alias;
+	FILE* f;
+
+	sprintf(fileName, "%s/result.mat", tmpPath);
+
+	check(fmi2_import_instantiate(fmu, "Test CS model instance", fmi2_cosimulation, "", fmi2_false) != jm_status_error,
+		"fmi2_import_instantiate failed");
+	check(fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0) == fmi2_status_ok &&
+		fmi2_import_enter_initialization_mode(fmu) == fmi2_status_ok &&
+		fmi2_import_exit_initialization_mode(fmu) == fmi2_status_ok, "Initialization of the FMU failed");
+
+	all = fmi2_import_get_variable_list(fmu, 0);
+	vl = fmi2_import_filter_variables(all, is_recordable, 0);
+	writer = fmi2_import_mat_writer_create(fmu, vl, fileName);
+	check(writer != 0, "Could not create the MAT writer");
+	for(k = 0; k < NUM_ROWS; k++) {
+		fmi2_value_reference_t vr = 0;
+		fmi2_import_get_real(fmu, &vr, 1, &heights[k]);
+		times[k] = t;
+		check(fmi2_import_mat_writer_record(writer, t) == jm_status_success, "fmi2_import_mat_writer_record failed");
+		check(fmi2_import_do_step(fmu, t, hstep, fmi2_true) == fmi2_status_ok, "fmi2_import_do_step failed");
+		t += hstep;
+	}
+	check(fmi2_import_mat_writer_record(writer, 0.0) == jm_status_error, "Time going backwards was accepted");
+	check(fmi2_import_mat_writer_get_number_of_rows(writer) == NUM_ROWS, "Wrong number of rows");
+	check(fmi2_import_mat_writer_close(writer) == jm_status_success, "fmi2_import_mat_writer_close failed");
+
+	/* Read the file back */
+	f = fopen(fileName, "rb");
+	check(f != 0, "Could not open the result file");
+	read_matrix(f, &aclass, "Aclass");
+	read_matrix(f, &name, "name");
+	read_matrix(f, &desc, "description");
+	read_matrix(f, &dataInfo, "dataInfo");
+	read_matrix(f, &data1, "data_1");
+	read_matrix(f, &data2, "data_2");
+	check(fgetc(f) == EOF, "Unexpected data at the end of the file");
+	fclose(f);
+
+	check(aclass.rows == 4 && aclass.cols == 11 && aclass.data[0] == 'A' && aclass.data[4] == 't' && aclass.data[3] == 'b',
+		"Wrong Aclass");
+	/* All variables but the string variable and time first */
+	check(name.cols == (int)fmi2_import_get_variable_list_size(vl) && desc.cols == name.cols &&
+		dataInfo.rows == 4 && dataInfo.cols == name.cols, "Wrong number of variables");
+	check(find_name(&name, "time") == 0 && find_name(&name, "LOGGER_TEST") == -1, "Wrong variable names");
+	hight = find_name(&name, "HIGHT");
+	gravity = find_name(&name, "GRAVITY");
+	speed = find_name(&name, "HIGHT_SPEED");
+	alias = find_name(&name, "HIGHT_SPEED alias");
+	check(hight > 0 && gravity > 0 && speed > 0 && alias > 0, "Variables are missing");
+	check(strcmp(desc.data + hight * desc.rows, "Hight of the ball") == 0, "Wrong description");
+
+	info = (int*)dataInfo.data;
+	check(info[4 * gravity] == 1 && info[4 * hight] == 2, "Parameters and variables are not in data_1 and data_2");
+	check(info[4 * speed] == info[4 * alias] && info[4 * speed + 1] == info[4 * alias + 1], "Aliases do not share a column");
+
+	/* data_1: values at start and end time */
+	d = (fmi2_real_t*)data1.data;
+	check(data1.cols == 2 && d[0] == 0.0 && d[data1.rows] == times[NUM_ROWS - 1], "Wrong times in data_1");
+	check(d[info[4 * gravity + 1] - 1] == -9.81 && d[data1.rows + info[4 * gravity + 1] - 1] == -9.81, "Wrong parameter value");
+
+	/* data_2: one column per time point */
+	d = (fmi2_real_t*)data2.data;
+	check(data2.cols == NUM_ROWS, "Wrong number of time points");
+	for(k = 0; k < NUM_ROWS; k++) {
+		check(d[k * data2.rows] == times[k], "Wrong time");
+		check(d[k * data2.rows + info[4 * hight + 1] - 1] == heights[k], "Recorded value differs");
+	}
+	printf("Wrote %d parameters and %d variables at %d time points\n", data1.rows - 1, data2.rows - 1, data2.cols);
+
+	free(aclass.data); free(name.data); free(desc.data); free(dataInfo.data); free(data1.data); free(data2.data);
+	fmi2_import_free_variable_list(vl);
+	fmi2_import_free_variable_list(all);
+	fmi2_import_terminate(fmu);
+	fmi2_import_free_instance(fmu);
+}
+
+/* Closing without recording must not access the FMU, which is not instantiated here */
+void test_empty(fmi2_import_t* fmu, const char* tmpPath)
+{
+	fmi2_import_mat_writer_t* writer;
+	fmi2_import_variable_list_t *all, *vl;
+	test_matrix_t aclass, name, desc, dataInfo, data1, data2;
+	char fileName[1000];
+	FILE* f;
+
+	sprintf(fileName, "%s/empty.mat", tmpPath);
+	all = fmi2_import_get_variable_list(fmu, 0);
+	vl = fmi2_import_filter_variables(all, is_recordable, 0);
+	writer = fmi2_import_mat_writer_create(fmu, vl, fileName);
+	check(writer != 0, "Could not create the MAT writer");
+	check(fmi2_import_mat_writer_close(writer) == jm_status_success, "fmi2_import_mat_writer_close failed");
+
+	f = fopen(fileName, "rb");
+	check(f != 0, "Could not open the result file");
+	read_matrix(f, &aclass, "Aclass");
+	read_matrix(f, &name, "name");
+	read_matrix(f, &desc, "description");
+	read_matrix(f, &dataInfo, "dataInfo");
+	read_matrix(f, &data1, "data_1");
+	read_matrix(f, &data2, "data_2");
+	check(fgetc(f) == EOF, "Unexpected data at the end of the file");
+	fclose(f);
+	check(data1.rows > 1 && data1.cols == 0 && data2.rows > 1 && data2.cols == 0, "Data matrices are not empty");
+
+	free(aclass.data); free(name.data); free(desc.data); free(dataInfo.data); free(data1.data); free(data2.data);
+	fmi2_import_free_variable_list(vl);
+	fmi2_import_free_variable_list(all);
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_version_enu_t version;
+	jm_status_enu_t status;
+
+	fmi2_import_t* fmu;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_verbose;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	version = fmi_import_get_fmi_version(context, FMUPath, tmpPath);
+
+	if(version != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath,0);
+
+	if(!fmu) {
+		printf("Error parsing XML, exiting\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	status = fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, 0);
+	if (status == jm_status_error) {
+		printf("Could not create the DLL loading mechanism(C-API test).\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	test_mat_writer(fmu, tmpPath);
+	test_empty(fmu, tmpPath);
+
+	fmi2_import_destroy_dllfmu(fmu);
+
+	fmi2_import_free(fmu);
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
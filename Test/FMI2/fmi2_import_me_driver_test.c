@@ -0,0 +1,411 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "config_test.h"
+#include <fmilib.h>
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* Analytic solution of the bouncing ball in the dummy FMU.
+   Returns the number of bounces before tend. */
+int bouncing_ball_solution(double tend, double* h, double* v)
+{
+	double g = -9.81, e = 0.5;
+	double t = 0, x = 1.0, u = 4.0;
+	int bounces = 0;
+
+	for(;;) {
+		/* time to impact: x + u*dt + g/2*dt^2 = 0 */
+		double dt = (-u - sqrt(u*u - 2*g*x)) / g;
+		if(t + dt > tend) break;
+		t += dt;
+		u = -e * (u + g*dt);
+		x = 0;
+		bounces++;
+	}
+	*h = x + u*(tend - t) + 0.5*g*(tend - t)*(tend - t);
+	*v = u + g*(tend - t);
+	return bounces;
+}
+
+typedef struct {
+	size_t num_calls;
+	size_t num_event_calls;
+} callback_counter_t;
+
+int step_callback(fmi2_import_me_driver_t* driver, int isEvent, void* userData)
+{
+	callback_counter_t* counter = (callback_counter_t*)userData;
+	counter->num_calls++;
+	if(isEvent) counter->num_event_calls++;
+	return 0;
+}
+
+typedef struct {
+	size_t num_steps;
+	size_t num_bad_derivatives;
+} stop_counter_t;
+
+/* Stops after every step. In the dummy FMU der(h) = v, so the reported derivatives can be checked. */
+int stop_callback(fmi2_import_me_driver_t* driver, int isEvent, void* userData)
+{
+	stop_counter_t* counter = (stop_counter_t*)userData;
+	const fmi2_real_t* x = fmi2_import_me_driver_get_states(driver);
+	const fmi2_real_t* dx = fmi2_import_me_driver_get_derivatives(driver);
+
+	if(fabs(dx[0] - x[1]) > 1e-10) counter->num_bad_derivatives++;
+	if(isEvent) return 0;
+	counter->num_steps++;
+	return 1;
+}
+
+/* Advance with a callback that stops on every step, including the steps that end at an event */
+void test_stop(fmi2_import_t* fmu, fmi2_import_me_solver_enu_t solver, double step)
+{
+	fmi2_real_t tend = 2.0;
+	fmi2_import_me_driver_options_t options;
+	fmi2_import_me_driver_t* driver;
+	const fmi2_real_t* x;
+	stop_counter_t counter = {0, 0};
+	double h_ref, v_ref;
+	int bounces = bouncing_ball_solution(tend, &h_ref, &v_ref);
+	size_t numAdvance = 0;
+
+	if(fmi2_import_instantiate(fmu, "Test ME driver stop", fmi2_model_exchange, 0, 0) == jm_status_error) {
+		printf("fmi2_import_instantiate failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	fmi2_import_setup_experiment(fmu, fmi2_true, 1e-6, 0.0, fmi2_false, 0.0);
+	fmi2_import_enter_initialization_mode(fmu);
+	fmi2_import_exit_initialization_mode(fmu);
+
+	fmi2_import_me_driver_default_options(&options);
+	options.solver = solver;
+	options.step_size = step;
+	options.relative_tolerance = 1e-8;
+	options.absolute_tolerance = 1e-8;
+	options.event_tolerance = 1e-12;
+	options.step_callback = stop_callback;
+	options.step_callback_data = &counter;
+
+	driver = fmi2_import_me_driver_create(fmu, &options);
+	if(!driver || fmi2_import_me_driver_initialize(driver, 0.0) != jm_status_success) {
+		printf("Could not initialize the ME driver\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	while(fmi2_import_me_driver_get_time(driver) < tend) {
+		jm_status_enu_t status = fmi2_import_me_driver_advance(driver, tend);
+		numAdvance++;
+		if(status == jm_status_error || (status == jm_status_success && fmi2_import_me_driver_get_time(driver) < tend) || numAdvance > 100000) {
+			printf("fmi2_import_me_driver_advance failed\n");
+			do_exit(CTEST_RETURN_FAIL);
+		}
+	}
+
+	x = fmi2_import_me_driver_get_states(driver);
+	printf("Solver %d stopped %u times: h = %.10f (%.10f), v = %.10f (%.10f)\n", (int)solver,
+		(unsigned)numAdvance, x[0], h_ref, x[1], v_ref);
+	if(fmi2_import_me_driver_get_statistics(driver)->num_state_events != (size_t)bounces) {
+		printf("Events were lost when the step callback stopped the integration\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(fabs(x[0] - h_ref) > 1e-5 || fabs(x[1] - v_ref) > 1e-5) {
+		printf("Simulation result is wrong\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(counter.num_bad_derivatives) {
+		printf("The derivatives of %u reported points do not match the states\n", (unsigned)counter.num_bad_derivatives);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmi2_import_me_driver_free(driver);
+	fmi2_import_terminate(fmu);
+	fmi2_import_free_instance(fmu);
+}
+
+void test_driver(fmi2_import_t* fmu, fmi2_import_me_solver_enu_t solver, double step, double tol)
+{
+	fmi2_real_t tstart = 0.0, tend = 2.0;
+	fmi2_import_me_driver_options_t options;
+	fmi2_import_me_driver_t* driver;
+	const fmi2_import_me_driver_statistics_t* stats;
+	const fmi2_real_t* x;
+	callback_counter_t counter = {0, 0};
+	double h_ref, v_ref;
+	int bounces;
+	jm_status_enu_t jmstatus;
+
+	bounces = bouncing_ball_solution(tend, &h_ref, &v_ref);
+
+	jmstatus = fmi2_import_instantiate(fmu, "Test ME driver instance", fmi2_model_exchange, 0, 0);
+	if (jmstatus == jm_status_error) {
+		printf("fmi2_import_instantiate failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	fmi2_import_setup_experiment(fmu, fmi2_true, 1e-6, tstart, fmi2_false, 0.0);
+	fmi2_import_enter_initialization_mode(fmu);
+	fmi2_import_exit_initialization_mode(fmu);
+
+	fmi2_import_me_driver_default_options(&options);
+	options.solver = solver;
+	options.step_size = step;
+	options.relative_tolerance = 1e-8;
+	options.absolute_tolerance = 1e-8;
+	options.event_tolerance = 1e-12;
+	options.step_callback = step_callback;
+	options.step_callback_data = &counter;
+
+	driver = fmi2_import_me_driver_create(fmu, &options);
+	if(!driver) {
+		printf("fmi2_import_me_driver_create failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(fmi2_import_me_driver_initialize(driver, tstart) != jm_status_success) {
+		printf("fmi2_import_me_driver_initialize failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	/* advance in two calls to check that integration continues seamlessly */
+	if((fmi2_import_me_driver_advance(driver, 1.0) != jm_status_success) ||
+	   (fmi2_import_me_driver_advance(driver, tend) != jm_status_success)) {
+		printf("fmi2_import_me_driver_advance failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	x = fmi2_import_me_driver_get_states(driver);
+	stats = fmi2_import_me_driver_get_statistics(driver);
+	printf("Solver %d: t = %g, h = %.10f (%.10f), v = %.10f (%.10f)\n", (int)solver,
+		fmi2_import_me_driver_get_time(driver), x[0], h_ref, x[1], v_ref);
+	printf("  steps %u, rejected %u, derivatives %u, indicators %u, state events %u\n",
+		(unsigned)stats->num_steps, (unsigned)stats->num_rejected_steps, (unsigned)stats->num_derivative_evaluations,
+		(unsigned)stats->num_event_indicator_evaluations, (unsigned)stats->num_state_events);
+
+	if(fmi2_import_me_driver_get_time(driver) != tend) {
+		printf("Integration did not reach the end time\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(stats->num_state_events != (size_t)bounces) {
+		printf("Expected %d state events, got %u\n", bounces, (unsigned)stats->num_state_events);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(fabs(x[0] - h_ref) > tol || fabs(x[1] - v_ref) > tol) {
+		printf("Simulation result is wrong\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(counter.num_calls != stats->num_steps + counter.num_event_calls || counter.num_event_calls != stats->num_state_events + 1) {
+		printf("Unexpected number of step callback calls %u (%u events)\n", (unsigned)counter.num_calls, (unsigned)counter.num_event_calls);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(solver == fmi2_import_me_solver_bdf) {
+		printf("  Jacobians %u, factorizations %u, Newton iterations %u, Newton failures %u\n",
+			(unsigned)stats->num_jacobian_evaluations, (unsigned)stats->num_factorizations,
+			(unsigned)stats->num_newton_iterations, (unsigned)stats->num_newton_failures);
+		if(stats->num_jacobian_evaluations == 0 || stats->num_factorizations == 0 || stats->num_newton_iterations == 0) {
+			printf("The BDF solver did not use the Newton iteration\n");
+			do_exit(CTEST_RETURN_FAIL);
+		}
+	}
+
+	fmi2_import_me_driver_free(driver);
+	fmi2_import_terminate(fmu);
+	fmi2_import_free_instance(fmu);
+}
+
+#define STIFF_MAX_STATES 100
+
+/* Solution of the stiff scalable FMU, all the states approach 2 + sin(t) */
+double stiff_solution(double t)
+{
+	return 2.0 + sin(t);
+}
+
+/* Stiff nonlinear model: compare the BDF solution and the reported derivatives with the known solution */
+void test_stiff(fmi2_import_t* fmu, fmi2_import_jacobian_method_enu_t method)
+{
+	fmi2_real_t tend = 10.0;
+	fmi2_import_me_driver_options_t options;
+	fmi2_import_me_driver_t* driver;
+	const fmi2_import_me_driver_statistics_t* stats;
+	const fmi2_real_t *x, *dx;
+	fmi2_real_t f[STIFF_MAX_STATES];
+	double err = 0, derr = 0;
+	size_t i, nx = fmi2_import_get_number_of_continuous_states(fmu);
+
+	if(nx > STIFF_MAX_STATES || fmi2_import_instantiate(fmu, "Test ME driver stiff", fmi2_model_exchange, 0, 0) == jm_status_error) {
+		printf("fmi2_import_instantiate failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	fmi2_import_setup_experiment(fmu, fmi2_true, 1e-6, 0.0, fmi2_false, 0.0);
+	fmi2_import_enter_initialization_mode(fmu);
+	fmi2_import_exit_initialization_mode(fmu);
+
+	fmi2_import_me_driver_default_options(&options);
+	options.solver = fmi2_import_me_solver_bdf;
+	options.jacobian_method = method;
+	driver = fmi2_import_me_driver_create(fmu, &options);
+	if(!driver || fmi2_import_me_driver_initialize(driver, 0.0) != jm_status_success ||
+		fmi2_import_me_driver_advance(driver, tend) != jm_status_success) {
+		printf("Integration of the stiff model failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	/* The reported derivatives must be those of the FMU at the reported states */
+	x = fmi2_import_me_driver_get_states(driver);
+	dx = fmi2_import_me_driver_get_derivatives(driver);
+	if(fmi2_import_get_derivatives(fmu, f, nx) != fmi2_status_ok) {
+		printf("fmi2_import_get_derivatives failed\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	for(i = 0; i < nx; i++) {
+		if(fabs(x[i] - stiff_solution(tend)) > err) err = fabs(x[i] - stiff_solution(tend));
+		if(fabs(dx[i] - f[i]) > derr) derr = fabs(dx[i] - f[i]);
+	}
+	stats = fmi2_import_me_driver_get_statistics(driver);
+	printf("Stiff model, Jacobian method %d: error %g, derivative error %g\n", (int)method, err, derr);
+	printf("  steps %u, rejected %u, derivatives %u, Jacobians %u, factorizations %u, Newton iterations %u, Newton failures %u\n",
+		(unsigned)stats->num_steps, (unsigned)stats->num_rejected_steps, (unsigned)stats->num_derivative_evaluations,
+		(unsigned)stats->num_jacobian_evaluations, (unsigned)stats->num_factorizations,
+		(unsigned)stats->num_newton_iterations, (unsigned)stats->num_newton_failures);
+	if(err > 1e-4 || derr > 1e-10) {
+		printf("The BDF solution of the stiff model is wrong\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	if(stats->num_newton_failures > stats->num_steps / 10) {
+		printf("Too many Newton failures, the iteration matrix is inaccurate\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmi2_import_me_driver_free(driver);
+	fmi2_import_terminate(fmu);
+	fmi2_import_free_instance(fmu);
+}
+
+void test_stiff_fmu(fmi_import_context_t* context, jm_callbacks* callbacks, const char* FMUPath, const char* tmpPath)
+{
+	fmi2_callback_functions_t callBackFunctions;
+	char* dir = fmi_import_mk_temp_dir(callbacks, tmpPath, "stiff");
+	fmi2_import_t* fmu;
+
+	if(!dir || fmi_import_get_fmi_version(context, FMUPath, dir) != fmi_version_2_0_enu) {
+		printf("Could not unpack the stiff FMU\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	fmu = fmi2_import_parse_xml(context, dir, 0);
+	if(!fmu) {
+		printf("Error parsing XML of the stiff FMU\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+	callBackFunctions.logger = fmi2_log_forwarding;
+	callBackFunctions.allocateMemory = calloc;
+	callBackFunctions.freeMemory = free;
+	callBackFunctions.componentEnvironment = fmu;
+	if(fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_me, &callBackFunctions) == jm_status_error) {
+		printf("Could not load the stiff FMU\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	test_stiff(fmu, fmi2_import_jacobian_method_finite_differences);
+	test_stiff(fmu, fmi2_import_jacobian_method_directional);
+
+	fmi2_import_destroy_dllfmu(fmu);
+	fmi2_import_free(fmu);
+	fmi_import_rmdir(callbacks, dir);
+	callbacks->free(dir);
+}
+
+int main(int argc, char *argv[])
+{
+	fmi2_callback_functions_t callBackFunctions;
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_version_enu_t version;
+	jm_status_enu_t status;
+
+	fmi2_import_t* fmu;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir> [<stiff_fmu_file>]\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_info;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	version = fmi_import_get_fmi_version(context, FMUPath, tmpPath);
+
+	if(version != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath,0);
+
+	if(!fmu) {
+		printf("Error parsing XML, exiting\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	callBackFunctions.logger = fmi2_log_forwarding;
+	callBackFunctions.allocateMemory = calloc;
+	callBackFunctions.freeMemory = free;
+	callBackFunctions.componentEnvironment = fmu;
+
+	status = fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_me, &callBackFunctions);
+	if (status == jm_status_error) {
+		printf("Could not create the DLL loading mechanism(C-API test).\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	/* The trajectory is piecewise quadratic so RK4 and dopri5 are exact up to the event location */
+	test_driver(fmu, fmi2_import_me_solver_rk4, 0.01, 1e-8);
+	test_driver(fmu, fmi2_import_me_solver_dopri5, 0.0, 1e-8);
+	test_driver(fmu, fmi2_import_me_solver_euler, 1e-4, 1e-2);
+	test_driver(fmu, fmi2_import_me_solver_bdf, 0.0, 1e-5);
+	test_stop(fmu, fmi2_import_me_solver_dopri5, 0.0);
+	test_stop(fmu, fmi2_import_me_solver_rk4, 0.01);
+
+	fmi2_import_destroy_dllfmu(fmu);
+
+	fmi2_import_free(fmu);
+
+	if(argc > 3) test_stiff_fmu(context, &callbacks, argv[3], tmpPath);
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
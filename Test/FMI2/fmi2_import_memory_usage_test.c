@@ -0,0 +1,212 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* Parent allocator that counts the outstanding blocks */
+static int outstanding = 0;
+
+static jm_voidp count_malloc(size_t size)
+{
+	jm_voidp p = malloc(size);
+	if(p) outstanding++;
+	return p;
+}
+
+static jm_voidp count_calloc(size_t numitems, size_t itemsize)
+{
+	jm_voidp p = calloc(numitems, itemsize);
+	if(p) outstanding++;
+	return p;
+}
+
+static jm_voidp count_realloc(void* ptr, size_t size)
+{
+	jm_voidp p = realloc(ptr, size);
+	if(p && !ptr) outstanding++;
+	return p;
+}
+
+static void count_free(jm_voidp p)
+{
+	if(p) outstanding--;
+	free(p);
+}
+
+static jm_memory_usage_t get_usage(fmi2_import_t* fmu, jm_memory_subsystem_enu_t subsystem)
+{
+	jm_memory_usage_t usage;
+	check(fmi2_import_get_memory_usage(fmu, subsystem, &usage) == jm_status_success, "fmi2_import_get_memory_usage failed");
+	check(usage.peak_bytes >= usage.live_bytes, "The peak is below the live memory");
+	check(usage.allocations >= usage.frees, "More frees than allocations");
+	return usage;
+}
+
+static void check_total(fmi2_import_t* fmu)
+{
+	jm_memory_usage_t total = get_usage(fmu, jm_memory_subsystem_total);
+	size_t live = 0, allocations = 0;
+	int k;
+
+	for(k = jm_memory_subsystem_other; k < jm_memory_subsystem_total; k++) {
+		jm_memory_usage_t usage = get_usage(fmu, (jm_memory_subsystem_enu_t)k);
+		live += usage.live_bytes;
+		allocations += usage.allocations;
+	}
+	check(total.live_bytes == live && total.allocations == allocations, "The total does not match the subsystems");
+}
+
+static void test_memory_usage(fmi2_import_t* fmu)
+{
+	jm_memory_usage_t before, usage;
+	fmi2_import_variable_list_t* vl;
+	fmi2_import_dependency_graph_t* g;
+	size_t nv;
+	int blocks;
+
+	check(get_usage(fmu, jm_memory_subsystem_xml_model).live_bytes > 0, "No memory attributed to the XML model");
+	check(get_usage(fmu, jm_memory_subsystem_log).live_bytes > 0, "No memory attributed to the log buffers");
+	check(get_usage(fmu, jm_memory_subsystem_capi).allocations == 0, "Memory attributed to the CAPI before loading");
+	check_total(fmu);
+
+	before = get_usage(fmu, jm_memory_subsystem_variable_list);
+	vl = fmi2_import_get_variable_list(fmu, 0);
+	nv = fmi2_import_get_variable_list_size(vl);
+	check(fmi2_import_get_value_referece_list(vl) != 0, "Could not get the value references");
+	usage = get_usage(fmu, jm_memory_subsystem_variable_list);
+	printf("Variable list with %u variables: %u bytes\n", (unsigned)nv, (unsigned)(usage.live_bytes - before.live_bytes));
+	check(usage.live_bytes >= before.live_bytes + nv * sizeof(fmi2_value_reference_t), "Variable list memory is not accounted");
+	check_total(fmu);
+	fmi2_import_free_variable_list(vl);
+	usage = get_usage(fmu, jm_memory_subsystem_variable_list);
+	check(usage.live_bytes == before.live_bytes && usage.frees > before.frees, "Variable list memory was not released");
+
+	/* Memory allocated outside of a scope is not counted but still taken from the parent callbacks */
+	before = get_usage(fmu, jm_memory_subsystem_total);
+	blocks = outstanding;
+	g = fmi2_import_dependency_graph_create(fmu, fmi2_import_outputs_dependencies);
+	check(g != 0, "Could not create the dependency graph");
+	usage = get_usage(fmu, jm_memory_subsystem_total);
+	check(outstanding - blocks > (int)((usage.allocations - usage.frees) - (before.allocations - before.frees)),
+		"Memory outside of a scope was not taken from the parent callbacks");
+	fmi2_import_dependency_graph_free(g);
+	check(outstanding == blocks, "Memory outside of a scope was not returned to the parent callbacks");
+
+	check(fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, 0) != jm_status_error, "Could not create the DLL loading mechanism");
+	check(get_usage(fmu, jm_memory_subsystem_capi).live_bytes > 0, "No memory attributed to the CAPI");
+	check_total(fmu);
+	check(fmi2_import_log_memory_usage(fmu) == jm_status_success, "fmi2_import_log_memory_usage failed");
+	fmi2_import_destroy_dllfmu(fmu);
+	check(get_usage(fmu, jm_memory_subsystem_capi).live_bytes == 0, "CAPI memory was not released");
+}
+
+/* More FMUs with different parent callbacks than the accounting supports. The FMUs beyond
+   the limit are parsed without accounting. */
+#define NUM_PARENTS 17
+
+static void test_many_parents(jm_callbacks* callbacks, const char* tmpPath)
+{
+	jm_callbacks parents[NUM_PARENTS];
+	fmi_import_context_t* contexts[NUM_PARENTS];
+	fmi2_import_t* fmus[NUM_PARENTS];
+	jm_memory_usage_t usage;
+	size_t k, accounted = 0;
+
+	for(k = 0; k < NUM_PARENTS; k++) {
+		parents[k] = *callbacks;
+		parents[k].log_level = jm_log_level_error;
+		contexts[k] = fmi_import_allocate_context(&parents[k]);
+		check(contexts[k] != 0, "Could not allocate a context");
+		fmi_import_set_memory_accounting(contexts[k], 1);
+		fmus[k] = fmi2_import_parse_xml(contexts[k], tmpPath, 0);
+		check(fmus[k] != 0, "Error parsing XML with many parent callbacks");
+		if(fmi2_import_get_memory_usage(fmus[k], jm_memory_subsystem_total, &usage) == jm_status_success) accounted++;
+	}
+	check(accounted == NUM_PARENTS - 1, "Unexpected number of FMUs with memory accounting");
+	for(k = 0; k < NUM_PARENTS; k++) {
+		fmi2_import_free(fmus[k]);
+		fmi_import_free_context(contexts[k]);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_version_enu_t version;
+	jm_memory_usage_t usage;
+	fmi2_import_t* fmu;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = count_malloc;
+	callbacks.calloc = count_calloc;
+	callbacks.realloc = count_realloc;
+	callbacks.free = count_free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_info;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	version = fmi_import_get_fmi_version(context, FMUPath, tmpPath);
+
+	if(version != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath, 0);
+	check(fmu != 0, "Error parsing XML");
+	check(fmi2_import_get_memory_usage(fmu, jm_memory_subsystem_total, &usage) == jm_status_error,
+		"Memory usage reported although the accounting is disabled");
+	fmi2_import_free(fmu);
+
+	fmi_import_set_memory_accounting(context, 1);
+	fmu = fmi2_import_parse_xml(context, tmpPath, 0);
+	check(fmu != 0, "Error parsing XML");
+	test_memory_usage(fmu);
+	fmi2_import_free(fmu);
+	test_many_parents(&callbacks, tmpPath);
+
+	fmi_import_free_context(context);
+	check(outstanding == 0, "Not all the memory was returned to the parent callbacks");
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
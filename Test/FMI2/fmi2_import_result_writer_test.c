@@ -0,0 +1,254 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+
+#define NUM_ROWS 100
+#define ROWS_PER_CHUNK 16
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* Sequential reader of the result file */
+typedef struct test_reader_t {
+	unsigned char* data;
+	size_t size;
+	size_t pos;
+} test_reader_t;
+
+static void read_file(test_reader_t* r, const char* fileName)
+{
+	FILE* f = fopen(fileName, "rb");
+	check(f != 0, "Could not open the result file");
+	fseek(f, 0, SEEK_END);
+	r->size = (size_t)ftell(f);
+	fseek(f, 0, SEEK_SET);
+	r->data = (unsigned char*)malloc(r->size);
+	check(r->data && fread(r->data, 1, r->size, f) == r->size, "Could not read the result file");
+	fclose(f);
+	r->pos = 0;
+}
+
+static const unsigned char* read_bytes(test_reader_t* r, size_t n)
+{
+	const unsigned char* p = r->data + r->pos;
+	check(r->pos + n <= r->size, "Result file is truncated");
+	r->pos += n;
+	return p;
+}
+
+static size_t read_u32(test_reader_t* r)
+{
+	const unsigned char* p = read_bytes(r, 4);
+	return (size_t)p[0] | ((size_t)p[1] << 8) | ((size_t)p[2] << 16) | ((size_t)p[3] << 24);
+}
+
+static void read_string(test_reader_t* r, char* buf)
+{
+	size_t len = read_u32(r);
+	memcpy(buf, read_bytes(r, len), len);
+	buf[len] = 0;
+}
+
+/* Decode a column block into 'out' */
+static size_t read_column(test_reader_t* r, void* out, size_t outSize)
+{
+	size_t size = read_u32(r), stored = read_u32(r);
+	const unsigned char* p = read_bytes(r, stored);
+	check(size <= outSize, "Column block too large");
+	if(stored == size) {
+		memcpy(out, p, size);
+	}
+	else {
+		uLongf len = (uLongf)size;
+		check(uncompress((Bytef*)out, &len, p, (uLong)stored) == Z_OK && len == size, "Could not decompress a column");
+	}
+	return size;
+}
+
+static int is_recordable(fmi2_import_variable_t* v, void* context)
+{
+	/* The dummy FMU has no storage for the real "A variable" */
+	return fmi2_import_get_variable_vr(v) < 100;
+}
+
+void test_result_writer(fmi2_import_t* fmu, const char* tmpPath, int level)
+{
+	fmi2_import_result_writer_options_t opts;
+	fmi2_import_result_writer_t* writer;
+	fmi2_import_variable_list_t *all, *vl;
+	test_reader_t r;
+	char fileName[1000], name[200], unit[200], desc[200];
+	fmi2_real_t heights[NUM_ROWS], times[NUM_ROWS], t = 0.0, hstep = 0.01;
+	fmi2_real_t timeCol[ROWS_PER_CHUNK], realCol[ROWS_PER_CHUNK];
+	size_t numColumns, numVars, c, k, rows, row = 0, numChunks = 0;
+	size_t heightColumn = (size_t)-1, speedColumn = (size_t)-1, aliasColumn = (size_t)-2;
+	size_t types[20];
+
+	sprintf(fileName, "%s/result_%d.bin", tmpPath, level);
+
+	check(fmi2_import_instantiate(fmu, "Test CS model instance", fmi2_cosimulation, "", fmi2_false) != jm_status_error,
+		"fmi2_import_instantiate failed");
+	check(fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0) == fmi2_status_ok &&
+		fmi2_import_enter_initialization_mode(fmu) == fmi2_status_ok &&
+		fmi2_import_exit_initialization_mode(fmu) == fmi2_status_ok, "Initialization of the FMU failed");
+
+	all = fmi2_import_get_variable_list(fmu, 0);
+	vl = fmi2_import_filter_variables(all, is_recordable, 0);
+
+	fmi2_import_result_writer_default_options(&opts);
+	opts.rows_per_chunk = ROWS_PER_CHUNK;
+	opts.num_buffers = 2;
+	opts.compression_level = level;
+	writer = fmi2_import_result_writer_create(fmu, vl, fileName, &opts);
+	check(writer != 0, "Could not create the result writer");
+	/* Aliases share a column and the string variable is dropped */
+	numColumns = fmi2_import_result_writer_get_number_of_columns(writer);
+	check(numColumns == fmi2_import_get_variable_list_size(vl) - 2, "Unexpected number of columns");
+
+	for(k = 0; k < NUM_ROWS; k++) {
+		fmi2_value_reference_t vr = 0;
+		fmi2_import_get_real(fmu, &vr, 1, &heights[k]);
+		times[k] = t;
+		check(fmi2_import_result_writer_record(writer, t) == jm_status_success, "fmi2_import_result_writer_record failed");
+		check(fmi2_import_do_step(fmu, t, hstep, fmi2_true) == fmi2_status_ok, "fmi2_import_do_step failed");
+		t += hstep;
+	}
+	check(fmi2_import_result_writer_get_number_of_rows(writer) == NUM_ROWS, "Wrong number of rows");
+	check(fmi2_import_result_writer_close(writer) == jm_status_success, "fmi2_import_result_writer_close failed");
+
+	/* Read the file back */
+	read_file(&r, fileName);
+	check(memcmp(read_bytes(&r, 8), "FMIRES01", 8) == 0 && read_u32(&r) == 1, "Wrong file header");
+	read_u32(&r);
+	check(read_u32(&r) == numColumns, "Wrong number of columns");
+	numVars = read_u32(&r);
+	check(numVars == fmi2_import_get_variable_list_size(vl) - 1, "Wrong number of variables");
+	check(read_u32(&r) == ROWS_PER_CHUNK, "Wrong chunk size");
+	for(c = 0; c < numColumns; c++) {
+		types[c] = read_u32(&r);
+		read_u32(&r);
+	}
+	for(k = 0; k < numVars; k++) {
+		c = read_u32(&r);
+		read_string(&r, name);
+		read_string(&r, unit);
+		read_string(&r, desc);
+		if(strcmp(name, "HIGHT") == 0) heightColumn = c;
+		if(strcmp(name, "HIGHT_SPEED") == 0) speedColumn = c;
+		if(strcmp(name, "HIGHT_SPEED alias") == 0) aliasColumn = c;
+	}
+	check(heightColumn < numColumns && types[heightColumn] == fmi2_base_type_real, "HIGHT is not recorded");
+	check(speedColumn == aliasColumn, "Aliases do not share a column");
+
+	while(r.pos < r.size) {
+		check(memcmp(read_bytes(&r, 4), "CHNK", 4) == 0, "Wrong chunk header");
+		rows = read_u32(&r);
+		check(read_column(&r, timeCol, sizeof(timeCol)) == rows * sizeof(fmi2_real_t), "Wrong time column size");
+		for(c = 0; c < numColumns; c++) {
+			fmi2_real_t buf[ROWS_PER_CHUNK];
+			read_column(&r, buf, sizeof(buf));
+			if(c == heightColumn) memcpy(realCol, buf, sizeof(buf));
+		}
+		for(k = 0; k < rows; k++, row++) {
+			check(timeCol[k] == times[row] && realCol[k] == heights[row], "Recorded value differs");
+		}
+		numChunks++;
+	}
+	check(row == NUM_ROWS && numChunks == (NUM_ROWS + ROWS_PER_CHUNK - 1) / ROWS_PER_CHUNK, "Wrong number of rows in the file");
+	printf("Compression level %d: %u rows in %u chunks, %u bytes\n", level, (unsigned)row, (unsigned)numChunks, (unsigned)r.size);
+	free(r.data);
+
+	fmi2_import_free_variable_list(vl);
+	fmi2_import_free_variable_list(all);
+	fmi2_import_terminate(fmu);
+	fmi2_import_free_instance(fmu);
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_version_enu_t version;
+	jm_status_enu_t status;
+
+	fmi2_import_t* fmu;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_verbose;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	version = fmi_import_get_fmi_version(context, FMUPath, tmpPath);
+
+	if(version != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath,0);
+
+	if(!fmu) {
+		printf("Error parsing XML, exiting\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	status = fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, 0);
+	if (status == jm_status_error) {
+		printf("Could not create the DLL loading mechanism(C-API test).\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	test_result_writer(fmu, tmpPath, 0);
+	test_result_writer(fmu, tmpPath, 6);
+
+	fmi2_import_destroy_dllfmu(fmu);
+
+	fmi2_import_free(fmu);
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
@@ -0,0 +1,391 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* Check that a selection holds exactly the variables of the model for which the predicate is true */
+typedef int (*predicate_ft)(fmi2_import_variable_t* v, int value);
+
+static void check_mask(fmi2_import_variable_list_t* all, const fmi2_import_selection_t* s, predicate_ft predicate, int value, const char* message)
+{
+	size_t k, n = fmi2_import_get_variable_list_size(all), count = 0;
+	fmi2_import_variable_list_t* vl;
+
+	check(s != 0, message);
+	for(k = 0; k < n; k++) {
+		fmi2_import_variable_t* v = fmi2_import_get_variable(all, k);
+		int expected = predicate(v, value);
+		check(fmi2_import_selection_contains(s, v) == (expected != 0), message);
+		if(expected) count++;
+	}
+	check(fmi2_import_selection_count(s) == count, message);
+
+	/* The original order is kept */
+	vl = fmi2_import_selection_to_variable_list(s, fmi2_import_selection_original_order);
+	check(vl && fmi2_import_get_variable_list_size(vl) == count, message);
+	for(k = 1; k < count; k++) {
+		check(fmi2_import_get_variable_original_order(fmi2_import_get_variable(vl, k - 1))
+			< fmi2_import_get_variable_original_order(fmi2_import_get_variable(vl, k)), message);
+	}
+	fmi2_import_free_variable_list(vl);
+}
+
+static int has_causality(fmi2_import_variable_t* v, int value) { return fmi2_import_get_causality(v) == (fmi2_causality_enu_t)value; }
+static int has_variability(fmi2_import_variable_t* v, int value) { return fmi2_import_get_variability(v) == (fmi2_variability_enu_t)value; }
+static int has_initial(fmi2_import_variable_t* v, int value) { return fmi2_import_get_initial(v) == (fmi2_initial_enu_t)value; }
+static int has_base_type(fmi2_import_variable_t* v, int value) { return fmi2_import_get_variable_base_type(v) == (fmi2_base_type_enu_t)value; }
+static int has_alias_kind(fmi2_import_variable_t* v, int value) { return fmi2_import_get_variable_alias_kind(v) == (fmi2_variable_alias_kind_enu_t)value; }
+static int has_start(fmi2_import_variable_t* v, int value) { return fmi2_import_get_variable_has_start(v); }
+
+/* Membership in a list from the model structure */
+static fmi2_import_variable_list_t* role_list;
+static int in_role_list(fmi2_import_variable_t* v, int value)
+{
+	size_t k, n = fmi2_import_get_variable_list_size(role_list);
+	for(k = 0; k < n; k++) {
+		fmi2_import_variable_t* r = fmi2_import_get_variable(role_list, k);
+		if(value) {
+			r = (fmi2_import_variable_t*)fmi2_import_get_real_variable_derivative_of(fmi2_import_get_variable_as_real(r));
+		}
+		if(r == v) return 1;
+	}
+	return 0;
+}
+
+static void check_role(fmi2_import_t* fmu, fmi2_import_variable_list_t* all, fmi2_import_variable_role_enu_t role,
+					   fmi2_import_variable_list_t* list, int states, const char* message)
+{
+	role_list = list;
+	check_mask(all, fmi2_import_get_role_mask(fmu, role), in_role_list, states, message);
+	fmi2_import_free_variable_list(list);
+}
+
+static void test_masks(fmi2_import_t* fmu, fmi2_import_variable_list_t* all)
+{
+	int k;
+
+	for(k = fmi2_causality_enu_parameter; k < fmi2_causality_enu_unknown; k++)
+		check_mask(all, fmi2_import_get_causality_mask(fmu, (fmi2_causality_enu_t)k), has_causality, k, "Unexpected causality mask");
+	for(k = fmi2_variability_enu_constant; k < fmi2_variability_enu_unknown; k++)
+		check_mask(all, fmi2_import_get_variability_mask(fmu, (fmi2_variability_enu_t)k), has_variability, k, "Unexpected variability mask");
+	for(k = fmi2_initial_enu_exact; k < fmi2_initial_enu_unknown; k++)
+		check_mask(all, fmi2_import_get_initial_mask(fmu, (fmi2_initial_enu_t)k), has_initial, k, "Unexpected initial mask");
+	for(k = fmi2_base_type_real; k <= fmi2_base_type_enum; k++)
+		check_mask(all, fmi2_import_get_base_type_mask(fmu, (fmi2_base_type_enu_t)k), has_base_type, k, "Unexpected base type mask");
+	for(k = fmi2_variable_is_not_alias; k <= fmi2_variable_is_alias; k++)
+		check_mask(all, fmi2_import_get_alias_kind_mask(fmu, (fmi2_variable_alias_kind_enu_t)k), has_alias_kind, k, "Unexpected alias kind mask");
+	check_mask(all, fmi2_import_get_has_start_mask(fmu), has_start, 0, "Unexpected start value mask");
+
+	check_role(fmu, all, fmi2_import_variable_role_derivative, fmi2_import_get_derivatives_list(fmu), 0, "Unexpected derivative mask");
+	check_role(fmu, all, fmi2_import_variable_role_state, fmi2_import_get_derivatives_list(fmu), 1, "Unexpected state mask");
+	check_role(fmu, all, fmi2_import_variable_role_discrete_state, fmi2_import_get_discrete_states_list(fmu), 0, "Unexpected discrete state mask");
+	check_role(fmu, all, fmi2_import_variable_role_output, fmi2_import_get_outputs_list(fmu), 0, "Unexpected output mask");
+	check_role(fmu, all, fmi2_import_variable_role_initial_unknown, fmi2_import_get_initial_unknowns_list(fmu), 0, "Unexpected initial unknown mask");
+	check(fmi2_import_selection_count(fmi2_import_get_role_mask(fmu, fmi2_import_variable_role_state)) == 2, "The dummy model has two states");
+
+	check(fmi2_import_get_causality_mask(fmu, fmi2_causality_enu_unknown) == 0, "Out of range masks must be NULL");
+}
+
+static int is_real_not_alias_local(fmi2_import_variable_t* v, int value)
+{
+	return fmi2_import_get_variable_base_type(v) == fmi2_base_type_real
+		&& fmi2_import_get_variable_alias_kind(v) == fmi2_variable_is_not_alias
+		&& fmi2_import_get_causality(v) != fmi2_causality_enu_local;
+}
+
+static void test_set_operations(fmi2_import_t* fmu, fmi2_import_variable_list_t* all)
+{
+	fmi2_import_selection_t* s = fmi2_import_clone_selection(fmi2_import_get_base_type_mask(fmu, fmi2_base_type_real));
+	fmi2_import_selection_t* t;
+	fmi2_import_variable_list_t* vl;
+	fmi2_value_reference_t* vrs;
+	size_t k, n, total = fmi2_import_get_variable_list_size(all);
+
+	check(s != 0, "fmi2_import_clone_selection failed");
+	check(fmi2_import_selection_and(s, fmi2_import_get_alias_kind_mask(fmu, fmi2_variable_is_not_alias)) == jm_status_success, "fmi2_import_selection_and failed");
+	check(fmi2_import_selection_andnot(s, fmi2_import_get_causality_mask(fmu, fmi2_causality_enu_local)) == jm_status_success, "fmi2_import_selection_andnot failed");
+	check_mask(all, s, is_real_not_alias_local, 0, "Unexpected result of the set operations");
+
+	/* The complement and the union give all the variables */
+	t = fmi2_import_clone_selection(s);
+	fmi2_import_selection_invert(t);
+	check(fmi2_import_selection_count(t) == total - fmi2_import_selection_count(s), "Unexpected complement");
+	check(fmi2_import_selection_or(t, s) == jm_status_success && fmi2_import_selection_count(t) == total, "Unexpected union");
+	fmi2_import_free_selection(t);
+	t = fmi2_import_create_selection(fmu, 1);
+	check(t && fmi2_import_selection_count(t) == total, "Unexpected full selection");
+	fmi2_import_free_selection(t);
+
+	/* Single variables and lists */
+	t = fmi2_import_create_selection(fmu, 0);
+	check(t && fmi2_import_selection_count(t) == 0, "Unexpected empty selection");
+	check(fmi2_import_selection_add(t, fmi2_import_get_variable(all, 1)) == jm_status_success
+		&& fmi2_import_selection_contains(t, fmi2_import_get_variable(all, 1)), "fmi2_import_selection_add failed");
+	check(fmi2_import_selection_remove(t, fmi2_import_get_variable(all, 1)) == jm_status_success
+		&& fmi2_import_selection_count(t) == 0, "fmi2_import_selection_remove failed");
+	check(fmi2_import_selection_add_list(t, all) == jm_status_success && fmi2_import_selection_count(t) == total, "fmi2_import_selection_add_list failed");
+	fmi2_import_free_selection(t);
+
+	/* Value reference order */
+	n = fmi2_import_selection_count(s);
+	vl = fmi2_import_selection_to_variable_list(s, fmi2_import_selection_vr_order);
+	vrs = (fmi2_value_reference_t*)malloc((n + 1) * sizeof(fmi2_value_reference_t));
+	check(vl && vrs && fmi2_import_get_variable_list_size(vl) == n, "Could not get the selection in value reference order");
+	check(fmi2_import_selection_get_value_references(s, fmi2_import_selection_vr_order, vrs) == jm_status_success, "Could not get the value references");
+	for(k = 0; k < n; k++) {
+		check(vrs[k] == fmi2_import_get_variable_vr(fmi2_import_get_variable(vl, k)), "Unexpected value reference");
+		check(k == 0 || vrs[k - 1] < vrs[k], "The value references are not sorted");
+	}
+	printf("%u real, non-alias, non-local variables\n", (unsigned)n);
+	fmi2_import_free_variable_list(vl);
+	free(vrs);
+	fmi2_import_free_selection(s);
+}
+
+static int is_real_output(fmi2_import_variable_t* v, int value)
+{
+	return fmi2_import_get_causality(v) == fmi2_causality_enu_output && fmi2_import_get_variable_base_type(v) == fmi2_base_type_real;
+}
+
+static int is_hight_not_alias(fmi2_import_variable_t* v, int value)
+{
+	return strncmp(fmi2_import_get_variable_name(v), "HIGHT", 5) == 0 && fmi2_import_get_variable_alias_kind(v) == fmi2_variable_is_not_alias;
+}
+
+static int is_speed(fmi2_import_variable_t* v, int value)
+{
+	return fmi2_import_get_variable_vr(v) == 1 && fmi2_import_get_variable_base_type(v) == fmi2_base_type_real;
+}
+
+static int no_start_or_not_continuous(fmi2_import_variable_t* v, int value)
+{
+	return !fmi2_import_get_variable_has_start(v) || fmi2_import_get_variability(v) != fmi2_variability_enu_continuous;
+}
+
+static int has_name(fmi2_import_variable_t* v, int value)
+{
+	return strcmp(fmi2_import_get_variable_name(v), "A variable") == 0;
+}
+
+static int always(fmi2_import_variable_t* v, int value)
+{
+	return 1;
+}
+
+/* The selection, the variable by variable evaluation and the convenience function must agree with the predicate */
+static void check_query(fmi2_import_t* fmu, fmi2_import_variable_list_t* all, const char* query, predicate_ft predicate)
+{
+	fmi2_import_query_t* q = fmi2_import_compile_query(fmu, query);
+	fmi2_import_selection_t* s = fmi2_import_create_selection(fmu, 1);
+	fmi2_import_variable_list_t* vl;
+	size_t k, n = fmi2_import_get_variable_list_size(all);
+
+	printf("Query \"%s\"\n", query);
+	check(q && s, "Could not compile the query");
+	check(fmi2_import_query_select(q, s) == jm_status_success, "fmi2_import_query_select failed");
+	for(k = 0; k < n; k++) {
+		fmi2_import_variable_t* v = fmi2_import_get_variable(all, k);
+		check(fmi2_import_query_match(q, v) == (predicate(v, 0) != 0), "Unexpected result of fmi2_import_query_match");
+	}
+	check_mask(all, s, predicate, 0, "Unexpected result of fmi2_import_query_select");
+
+	vl = fmi2_import_query_variables(fmu, query);
+	check(vl && fmi2_import_get_variable_list_size(vl) == fmi2_import_selection_count(s), "Unexpected result of fmi2_import_query_variables");
+	fmi2_import_free_variable_list(vl);
+	fmi2_import_free_selection(s);
+	fmi2_import_free_query(q);
+}
+
+static void test_queries(fmi2_import_t* fmu, fmi2_import_variable_list_t* all)
+{
+	check_query(fmu, all, "causality=output and basetype=real", is_real_output);
+	check_query(fmu, all, "name='HIGHT*' && !isAlias", is_hight_not_alias);
+	check_query(fmu, all, "alias=HIGHT_SPEED", is_speed);
+	check_query(fmu, all, "(hasStart=false) or not (variability = CONTINUOUS)", no_start_or_not_continuous);
+	check_query(fmu, all, "NAME = \"A variable\"", has_name);
+	check_query(fmu, all, "unit='' and quantity='' and type=''", always);
+	check_query(fmu, all, "  ", always);
+
+	check(fmi2_import_compile_query(fmu, "causality=") == 0, "Missing value not detected");
+	check(fmi2_import_compile_query(fmu, "causality=unknown") == 0, "Invalid value not detected");
+	check(fmi2_import_compile_query(fmu, "(name=a") == 0, "Missing parenthesis not detected");
+	check(fmi2_import_compile_query(fmu, "name='a") == 0, "Unterminated string not detected");
+	check(fmi2_import_compile_query(fmu, "size=1") == 0, "Unknown attribute not detected");
+	check(fmi2_import_compile_query(fmu, "isAlias isAlias") == 0, "Missing operator not detected");
+}
+
+/* Hierarchical names for the name index, written in an order that is not alphabetical */
+static const char* hierarchical_names[] = {
+	"plant.pump.T", "plant.pipe[10].T", "plant.grid[2,1].T", "plantX.T", "plant.pipe[2].T", "der(plant.pump.T)",
+	"plant.pipe[1].T", "plant.grid[1,1].T", "plant.pump.p", "plant.grid[2,2].T", "plant.pipe[3].T"
+};
+#define NUM_HIERARCHICAL_NAMES (sizeof(hierarchical_names) / sizeof(hierarchical_names[0]))
+
+static void check_sorted(fmi2_import_variable_list_t* vl, size_t expected, const char* what)
+{
+	size_t k, n = vl ? fmi2_import_get_variable_list_size(vl) : 0;
+	printf("%s: %u variables\n", what, (unsigned)n);
+	check(vl && n == expected, "Unexpected number of variables");
+	for(k = 1; k < n; k++) {
+		check(strcmp(fmi2_import_get_variable_name(fmi2_import_get_variable(vl, k - 1)),
+			fmi2_import_get_variable_name(fmi2_import_get_variable(vl, k))) < 0, "The variables are not sorted by name");
+	}
+	fmi2_import_free_variable_list(vl);
+}
+
+static void check_pattern(fmi2_import_t* fmu, const char* pattern, size_t expected)
+{
+	char query[100];
+	fmi2_import_query_t* q;
+	fmi2_import_variable_list_t* vl = fmi2_import_get_variables_by_name_pattern(fmu, pattern);
+	size_t k, count = 0;
+
+	/* The name query must agree with the index */
+	sprintf(query, "name='%s'", pattern);
+	q = fmi2_import_compile_query(fmu, query);
+	check(q != 0, "Could not compile the name query");
+	for(k = 0; k < NUM_HIERARCHICAL_NAMES; k++) {
+		if(fmi2_import_query_match(q, fmi2_import_get_variable_by_name(fmu, hierarchical_names[k]))) count++;
+	}
+	fmi2_import_free_query(q);
+	check(count == expected, "The name query does not agree with the pattern");
+	vl = fmi2_import_query_variables(fmu, query);
+	check(vl && fmi2_import_get_variable_list_size(vl) == expected, "Unexpected result of the name query");
+	fmi2_import_free_variable_list(vl);
+
+	check_sorted(fmi2_import_get_variables_by_name_pattern(fmu, pattern), expected, pattern);
+}
+
+static void test_name_patterns(fmi_import_context_t* context, jm_callbacks* callbacks, const char* tmpPath)
+{
+	char* dir = fmi_import_mk_temp_dir(callbacks, tmpPath, "names");
+	char fileName[1000];
+	FILE* f;
+	fmi2_import_t* fmu;
+	size_t k;
+
+	check(dir != 0, "Could not create a temporary directory");
+	sprintf(fileName, "%s/modelDescription.xml", dir);
+	f = fopen(fileName, "w");
+	check(f != 0, "Could not write the model description");
+	fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<fmiModelDescription fmiVersion=\"2.0\" modelName=\"Names\" guid=\"{names}\">\n"
+		"  <CoSimulation modelIdentifier=\"Names\"/>\n  <ModelVariables>\n");
+	for(k = 0; k < NUM_HIERARCHICAL_NAMES; k++) {
+		fprintf(f, "    <ScalarVariable name=\"%s\" valueReference=\"%u\"><Real/></ScalarVariable>\n", hierarchical_names[k], (unsigned)k);
+	}
+	fprintf(f, "  </ModelVariables>\n  <ModelStructure/>\n</fmiModelDescription>\n");
+	fclose(f);
+
+	fmu = fmi2_import_parse_xml(context, dir, 0);
+	check(fmu != 0, "Error parsing XML");
+
+	check_sorted(fmi2_import_get_variables_by_name_prefix(fmu, "plant.pipe["), 4, "plant.pipe[");
+	check_sorted(fmi2_import_get_variables_by_name_prefix(fmu, "plant."), 9, "plant.");
+	check_sorted(fmi2_import_get_variables_by_name_prefix(fmu, "plant"), 10, "plant");
+	check_sorted(fmi2_import_get_variables_by_name_prefix(fmu, ""), NUM_HIERARCHICAL_NAMES, "\"\"");
+	check_sorted(fmi2_import_get_variables_by_name_prefix(fmu, "pump"), 0, "pump");
+
+	check_pattern(fmu, "plant.*.T", 8);
+	check_pattern(fmu, "*.T", 1);
+	check_pattern(fmu, "**.T", 9);
+	check_pattern(fmu, "plant.pump.?", 2);
+	check_pattern(fmu, "plant.pipe[2:3].T", 2);
+	check_pattern(fmu, "plant.pipe[1:10].T", 4);
+	check_pattern(fmu, "plant.pipe[*].T", 4);
+	check_pattern(fmu, "plant.pipe[2].T", 1);
+	check_pattern(fmu, "plant.grid[2,*].T", 2);
+	check_pattern(fmu, "plant.grid[*].T", 0);
+	check_pattern(fmu, "der(plant.pump.T)", 1);
+	check_pattern(fmu, "***.T", 9);
+	check_pattern(fmu, "plant**T", 9);
+	check_pattern(fmu, "*.*.*", 10);
+	check_pattern(fmu, "p*a*n*t.p*.*", 6);
+	check_pattern(fmu, "**p**i**p**e**.T", 4);
+
+	fmi2_import_free(fmu);
+	fmi_import_rmdir(callbacks, dir);
+	callbacks->free(dir);
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi2_import_t* fmu;
+	fmi2_import_variable_list_t* all;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_warning;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	if(fmi_import_get_fmi_version(context, FMUPath, tmpPath) != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath, 0);
+	check(fmu != 0, "Error parsing XML");
+
+	all = fmi2_import_get_variable_list(fmu, 0);
+	check(all != 0, "Could not get the variable list");
+
+	test_masks(fmu, all);
+	test_set_operations(fmu, all);
+	test_queries(fmu, all);
+	check_sorted(fmi2_import_get_variables_by_name_prefix(fmu, "HIGHT"), 4, "HIGHT");
+	check_sorted(fmi2_import_get_variables_by_name_pattern(fmu, "HIGHT_*"), 3, "HIGHT_*");
+
+	fmi2_import_free_variable_list(all);
+	fmi2_import_free(fmu);
+
+	test_name_patterns(context, &callbacks, tmpPath);
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
@@ -0,0 +1,168 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+
+#define NUM_STEPS 10
+#define CAPACITY 4
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+static fmi2_real_t get_height(fmi2_import_t* fmu)
+{
+	fmi2_value_reference_t vr = 0;
+	fmi2_real_t h;
+	fmi2_import_get_real(fmu, &vr, 1, &h);
+	return h;
+}
+
+int test_state_ring(fmi2_import_t* fmu)
+{
+	fmi2_import_state_ring_t* ring;
+	fmi2_real_t times[NUM_STEPS + 1], heights[NUM_STEPS + 1];
+	fmi2_real_t hstep = 0.1, restored, h;
+	size_t k, rep;
+
+	check(fmi2_import_instantiate(fmu, "Test CS model instance", fmi2_cosimulation, "", fmi2_false) != jm_status_error,
+		"fmi2_import_instantiate failed");
+	check(fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0) == fmi2_status_ok &&
+		fmi2_import_enter_initialization_mode(fmu) == fmi2_status_ok &&
+		fmi2_import_exit_initialization_mode(fmu) == fmi2_status_ok, "Initialization of the FMU failed");
+
+	check(fmi2_import_state_ring_create(fmu, 0) == 0, "A ring without capacity was created");
+	ring = fmi2_import_state_ring_create(fmu, CAPACITY);
+	check(ring != 0, "Could not create the state ring");
+
+	/* Snapshot before every step; the ring keeps the last CAPACITY */
+	times[0] = 0.0;
+	for(k = 0; k < NUM_STEPS; k++) {
+		heights[k] = get_height(fmu);
+		check(fmi2_import_state_ring_push(ring, times[k]) == jm_status_success, "fmi2_import_state_ring_push failed");
+		check(fmi2_import_do_step(fmu, times[k], hstep, fmi2_true) == fmi2_status_ok, "fmi2_import_do_step failed");
+		times[k + 1] = times[k] + hstep;
+	}
+	heights[NUM_STEPS] = get_height(fmu);
+	check(fmi2_import_state_ring_get_size(ring) == CAPACITY &&
+		fmi2_import_state_ring_get_time(ring, 0) == times[NUM_STEPS - CAPACITY] &&
+		fmi2_import_state_ring_get_time(ring, CAPACITY - 1) == times[NUM_STEPS - 1], "Unexpected snapshots in the ring");
+	/* The oldest states were recycled */
+	check(fmi2_import_state_ring_get_number_of_allocated_states(ring) == CAPACITY, "FMU states were not reused");
+
+	check(fmi2_import_state_ring_push(ring, 0.0) == jm_status_error, "A snapshot out of order was accepted");
+	check(fmi2_import_state_ring_rollback(ring, times[NUM_STEPS - CAPACITY] - 0.5 * hstep, 0) == jm_status_error,
+		"Rollback before the oldest snapshot succeeded");
+
+	/* Roll back between two snapshots: the older one is restored and the newer dropped */
+	check(fmi2_import_state_ring_rollback(ring, 0.5 * (times[7] + times[8]), &restored) == jm_status_success,
+		"fmi2_import_state_ring_rollback failed");
+	printf("Rolled back to t=%g, height %g\n", restored, get_height(fmu));
+	check(restored == times[7] && get_height(fmu) == heights[7], "Wrong state restored");
+	check(fmi2_import_state_ring_get_size(ring) == 2, "Newer snapshots were not dropped");
+
+	/* An iterative master repeats every step; the result must reproduce the original trajectory */
+	for(k = 7; k < NUM_STEPS; k++) {
+		if(k > 7) check(fmi2_import_state_ring_push(ring, times[k]) == jm_status_success, "fmi2_import_state_ring_push failed");
+		for(rep = 0; rep < 3; rep++) {
+			check(fmi2_import_state_ring_rollback(ring, times[k], &restored) == jm_status_success && restored == times[k],
+				"fmi2_import_state_ring_rollback failed");
+			check(fmi2_import_do_step(fmu, times[k], hstep, fmi2_true) == fmi2_status_ok, "fmi2_import_do_step failed");
+		}
+		h = get_height(fmu);
+		check(h == heights[k + 1], "Repeated step differs from the original");
+	}
+	check(fmi2_import_state_ring_get_number_of_allocated_states(ring) == CAPACITY, "FMU states were allocated on rollback");
+
+	fmi2_import_state_ring_clear(ring);
+	check(fmi2_import_state_ring_get_size(ring) == 0 &&
+		fmi2_import_state_ring_rollback(ring, times[NUM_STEPS], 0) == jm_status_error, "fmi2_import_state_ring_clear failed");
+
+	fmi2_import_state_ring_free(ring);
+	fmi2_import_terminate(fmu);
+	fmi2_import_free_instance(fmu);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_version_enu_t version;
+	jm_status_enu_t status;
+
+	fmi2_import_t* fmu;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_verbose;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	version = fmi_import_get_fmi_version(context, FMUPath, tmpPath);
+
+	if(version != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath,0);
+
+	if(!fmu) {
+		printf("Error parsing XML, exiting\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	status = fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, 0);
+	if (status == jm_status_error) {
+		printf("Could not create the DLL loading mechanism(C-API test).\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	test_state_ring(fmu);
+
+	fmi2_import_destroy_dllfmu(fmu);
+
+	fmi2_import_free(fmu);
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
@@ -0,0 +1,218 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+
+#define NUM_STATES 40
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+static fmi2_real_t get_height(fmi2_import_t* fmu)
+{
+	fmi2_value_reference_t vr = 0;
+	fmi2_real_t h;
+	fmi2_import_get_real(fmu, &vr, 1, &h);
+	return h;
+}
+
+static void init_fmu(fmi2_import_t* fmu, const char* name)
+{
+	check(fmi2_import_instantiate(fmu, name, fmi2_cosimulation, "", fmi2_false) != jm_status_error,
+		"fmi2_import_instantiate failed");
+	check(fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0) == fmi2_status_ok &&
+		fmi2_import_enter_initialization_mode(fmu) == fmi2_status_ok &&
+		fmi2_import_exit_initialization_mode(fmu) == fmi2_status_ok, "Initialization of the FMU failed");
+}
+
+/* Save a state before every step and return the heights of the trajectory */
+static void save_trajectory(fmi2_import_state_store_t* store, fmi2_import_t* fmu, fmi2_real_t* heights)
+{
+	fmi2_real_t t = 0.0, hstep = 0.1;
+	size_t k, id;
+
+	for(k = 0; k < NUM_STATES; k++) {
+		heights[k] = get_height(fmu);
+		check(fmi2_import_state_store_save(store, 0, &id) == jm_status_success && id == k,
+			"fmi2_import_state_store_save failed");
+		check(fmi2_import_do_step(fmu, t, hstep, fmi2_true) == fmi2_status_ok, "fmi2_import_do_step failed");
+		t += hstep;
+	}
+	heights[NUM_STATES] = get_height(fmu);
+}
+
+int test_state_store(fmi2_import_t* fmu, fmi2_import_t* fmu2)
+{
+	static const size_t order[] = {39, 0, 17, 5, 22, 4, 3, 38, 12};
+	fmi2_import_state_store_options_t opts;
+	fmi2_import_state_store_t* store;
+	fmi2_real_t heights[NUM_STATES + 1], heights2[NUM_STATES + 1];
+	fmi2_FMU_state_t state = 0;
+	size_t k, id, budget = 256;
+
+	init_fmu(fmu, "Test CS model instance");
+	init_fmu(fmu2, "Second CS model instance");
+
+	/* Delta encoding with compression and a small memory budget */
+	fmi2_import_state_store_default_options(&opts);
+	opts.keyframe_interval = 4;
+	opts.ram_budget = budget;
+	store = fmi2_import_state_store_create(fmu, &opts);
+	check(store != 0, "Could not create the state store");
+	save_trajectory(store, fmu, heights);
+	check(fmi2_import_state_store_get_number_of_states(store) == NUM_STATES, "Wrong number of stored states");
+
+	printf("Serialized %u bytes, stored %u bytes in memory and %u bytes in the spill file\n",
+		(unsigned)fmi2_import_state_store_get_serialized_size(store),
+		(unsigned)fmi2_import_state_store_get_memory_size(store),
+		(unsigned)fmi2_import_state_store_get_spilled_size(store));
+	check(fmi2_import_state_store_get_memory_size(store) <= budget, "Memory budget exceeded");
+	check(fmi2_import_state_store_get_spilled_size(store) > 0, "Nothing was spilled");
+	check(fmi2_import_state_store_get_memory_size(store) + fmi2_import_state_store_get_spilled_size(store) <
+		fmi2_import_state_store_get_serialized_size(store) / 2, "States were not compressed");
+
+	/* Restoring in any order and stepping reproduces the trajectory */
+	for(k = 0; k < sizeof(order)/sizeof(order[0]); k++) {
+		id = order[k];
+		check(fmi2_import_state_store_restore(store, id, 0) == jm_status_success, "fmi2_import_state_store_restore failed");
+		check(get_height(fmu) == heights[id], "Wrong state restored");
+		check(fmi2_import_do_step(fmu, 0.1 * id, 0.1, fmi2_true) == fmi2_status_ok && get_height(fmu) == heights[id + 1],
+			"Step from a restored state differs from the original");
+	}
+
+	/* Fork the second instance from a state of the first */
+	check(fmi2_import_state_store_restore(store, 30, fmu2) == jm_status_success && get_height(fmu2) == heights[30],
+		"Could not restore into another instance");
+	check(fmi2_import_state_store_restore(store, NUM_STATES, 0) == jm_status_error, "Restored a state that does not exist");
+
+	/* An explicit FMU state; continues the delta chain */
+	check(fmi2_import_get_fmu_state(fmu2, &state) == fmi2_status_ok, "fmi2_import_get_fmu_state failed");
+	check(fmi2_import_state_store_restore(store, 10, 0) == jm_status_success, "fmi2_import_state_store_restore failed");
+	check(fmi2_import_set_fmu_state(fmu, state) == fmi2_status_ok, "fmi2_import_set_fmu_state failed");
+	fmi2_import_free_fmu_state(fmu2, &state);
+	check(fmi2_import_get_fmu_state(fmu, &state) == fmi2_status_ok &&
+		fmi2_import_state_store_save(store, state, &id) == jm_status_success && id == NUM_STATES,
+		"Saving an explicit FMU state failed");
+	fmi2_import_free_fmu_state(fmu, &state);
+	check(fmi2_import_state_store_restore(store, 2, 0) == jm_status_success &&
+		fmi2_import_state_store_restore(store, id, 0) == jm_status_success && get_height(fmu) == heights[30],
+		"Wrong explicit state restored");
+	check(fmi2_import_state_store_restore(store, 0, 0) == jm_status_success, "fmi2_import_state_store_restore failed");
+	fmi2_import_state_store_free(store);
+
+	/* Complete, uncompressed states that are all spilled are deserialized from the mapping */
+	fmi2_import_state_store_default_options(&opts);
+	opts.keyframe_interval = 1;
+	opts.compression_level = 0;
+	opts.ram_budget = 1;
+	store = fmi2_import_state_store_create(fmu, &opts);
+	check(store != 0, "Could not create the state store");
+	check(fmi2_import_state_store_restore(store, 0, 0) == jm_status_error, "Restored from an empty store");
+	save_trajectory(store, fmu, heights2);
+	check(fmi2_import_state_store_get_memory_size(store) == 0 &&
+		fmi2_import_state_store_get_spilled_size(store) == fmi2_import_state_store_get_serialized_size(store),
+		"States were not spilled as is");
+	for(k = 0; k < sizeof(order)/sizeof(order[0]); k++) {
+		id = order[k];
+		check(heights2[id] == heights[id], "Trajectory is not reproducible");
+		check(fmi2_import_state_store_restore(store, id, fmu2) == jm_status_success && get_height(fmu2) == heights[id],
+			"Wrong state restored from the spill file");
+	}
+	fmi2_import_state_store_free(store);
+
+	fmi2_import_terminate(fmu2);
+	fmi2_import_free_instance(fmu2);
+	fmi2_import_terminate(fmu);
+	fmi2_import_free_instance(fmu);
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_version_enu_t version;
+	jm_status_enu_t status;
+
+	fmi2_import_t* fmu;
+	fmi2_import_t* fmu2;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_verbose;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	version = fmi_import_get_fmi_version(context, FMUPath, tmpPath);
+
+	if(version != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath,0);
+	fmu2 = fmi2_import_parse_xml(context, tmpPath,0);
+
+	if(!fmu || !fmu2) {
+		printf("Error parsing XML, exiting\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	status = fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, 0);
+	if (status != jm_status_error)
+		status = fmi2_import_create_dllfmu(fmu2, fmi2_fmu_kind_cs, 0);
+	if (status == jm_status_error) {
+		printf("Could not create the DLL loading mechanism(C-API test).\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	test_state_store(fmu, fmu2);
+
+	fmi2_import_destroy_dllfmu(fmu2);
+	fmi2_import_destroy_dllfmu(fmu);
+
+	fmi2_import_free(fmu2);
+	fmi2_import_free(fmu);
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
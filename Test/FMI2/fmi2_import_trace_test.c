@@ -0,0 +1,214 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+#include <JM/jm_thread.h>
+
+#define NUM_STEPS 10
+#define NUM_WORKER_EVENTS 5000
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* Records more events than fit in one buffer chunk from a second thread */
+static void worker(void* arg)
+{
+	int k;
+	for(k = 0; k < NUM_WORKER_EVENTS; k++) {
+		jm_trace_begin("test", "worker");
+		jm_trace_end("test", "worker");
+	}
+}
+
+/* Records until the trace is stopped */
+static void busy_worker(void* arg)
+{
+	volatile int* started = (volatile int*)arg;
+	while(jm_trace_is_active()) {
+		jm_trace_begin("test", "busy");
+		jm_trace_end("test", "busy");
+		*started = 1;
+	}
+}
+
+static size_t count_occurrences(const char* text, const char* pattern)
+{
+	size_t n = 0;
+	const char* p = text;
+	while((p = strstr(p, pattern)) != 0) {
+		n++;
+		p += strlen(pattern);
+	}
+	return n;
+}
+
+static char* read_file(const char* fileName)
+{
+	FILE* f = fopen(fileName, "rb");
+	char* text;
+	long size;
+
+	check(f != 0, "Could not open the trace file");
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	text = (char*)malloc(size + 1);
+	check(text != 0 && fread(text, 1, size, f) == (size_t)size, "Could not read the trace file");
+	text[size] = 0;
+	fclose(f);
+	return text;
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	char traceFile[1024];
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_version_enu_t version;
+	jm_status_enu_t status;
+	jm_thread_t thread;
+	volatile int started = 0;
+	fmi2_import_t* fmu;
+	fmi2_real_t t = 0.0, hstep = 0.1;
+	char* text;
+	size_t k;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+	sprintf(traceFile, "%s/fmi2_import_trace_test.json", tmpPath);
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_info;
+	callbacks.context = 0;
+
+	check(jm_trace_stop(0) == jm_status_error, "Stopping an inactive trace succeeded");
+	jm_trace_begin("test", "not recorded");
+	check(jm_trace_start(&callbacks) == jm_status_success, "jm_trace_start failed");
+	check(jm_trace_start(&callbacks) == jm_status_error, "Tracing was started twice");
+	check(jm_trace_is_active(), "Tracing is not active");
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	version = fmi_import_get_fmi_version(context, FMUPath, tmpPath);
+
+	if(version != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath,0);
+
+	if(!fmu) {
+		printf("Error parsing XML, exiting\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	status = fmi2_import_create_dllfmu(fmu, fmi2_fmu_kind_cs, 0);
+	if (status == jm_status_error) {
+		printf("Could not create the DLL loading mechanism(C-API test).\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	check(jm_thread_create(&thread, worker, 0) == jm_status_success, "Could not start a thread");
+
+	check(fmi2_import_instantiate(fmu, "Test CS model instance", fmi2_cosimulation, "", fmi2_false) != jm_status_error,
+		"fmi2_import_instantiate failed");
+	check(fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0) == fmi2_status_ok &&
+		fmi2_import_enter_initialization_mode(fmu) == fmi2_status_ok &&
+		fmi2_import_exit_initialization_mode(fmu) == fmi2_status_ok, "Initialization of the FMU failed");
+	jm_trace_begin("test", "simulation");
+	for(k = 0; k < NUM_STEPS; k++) {
+		check(fmi2_import_do_step(fmu, t, hstep, fmi2_true) == fmi2_status_ok, "fmi2_import_do_step failed");
+		t += hstep;
+	}
+	jm_trace_end("test", "simulation");
+
+	check(jm_thread_join(&thread) == jm_status_success, "Could not join the thread");
+	check(jm_trace_stop(traceFile) == jm_status_success, "jm_trace_stop failed");
+	check(!jm_trace_is_active(), "Tracing is still active");
+
+	/* Not recorded after the trace was stopped */
+	fmi2_import_terminate(fmu);
+	fmi2_import_free_instance(fmu);
+
+	text = read_file(traceFile);
+	check(strncmp(text, "{\"traceEvents\":[", 16) == 0, "Unexpected start of the trace file");
+	check(count_occurrences(text, "\"name\":\"Unzip\"") == 2 &&
+		count_occurrences(text, "\"name\":\"Parse XML\"") == 2 &&
+		count_occurrences(text, "\"name\":\"Resolve aliases\"") == 2 &&
+		count_occurrences(text, "\"name\":\"Load shared library\"") == 2 &&
+		count_occurrences(text, "\"name\":\"Load FMI functions\"") == 2, "Library phases are missing in the trace");
+	check(count_occurrences(text, "\"ph\":\"B\"") == count_occurrences(text, "\"ph\":\"E\""), "Unbalanced begin and end events");
+	check(count_occurrences(text, "\"name\":\"worker\"") == 2 * NUM_WORKER_EVENTS, "Events of the worker thread are missing");
+	check(count_occurrences(text, "\"name\":\"thread_name\"") == 2, "Expected events from two threads");
+	check(count_occurrences(text, "not recorded") == 0, "An event outside of the trace was recorded");
+#ifdef FMILIB_ENABLE_CALL_STATISTICS
+	check(count_occurrences(text, "\"name\":\"fmi2DoStep\"") == NUM_STEPS, "FMI calls are missing in the trace");
+	check(count_occurrences(text, "\"name\":\"fmi2Terminate\"") == 0, "An FMI call after the trace was recorded");
+#endif
+	free(text);
+
+	/* A second trace starts empty */
+	check(jm_trace_start(&callbacks) == jm_status_success, "jm_trace_start failed");
+	jm_trace_begin("test", "second");
+	jm_trace_end("test", "second");
+	check(jm_trace_stop(traceFile) == jm_status_success, "jm_trace_stop failed");
+	text = read_file(traceFile);
+	check(count_occurrences(text, "\"name\":\"second\"") == 2 && count_occurrences(text, "\"name\":\"worker\"") == 0,
+		"Unexpected events in the second trace");
+	free(text);
+
+	/* Stopping while another thread records */
+	check(jm_trace_start(&callbacks) == jm_status_success, "jm_trace_start failed");
+	check(jm_thread_create(&thread, busy_worker, (void*)&started) == jm_status_success, "Could not start a thread");
+	while(!started) ;
+	check(jm_trace_stop(traceFile) == jm_status_success, "jm_trace_stop failed");
+	check(jm_thread_join(&thread) == jm_status_success, "Could not join the thread");
+	text = read_file(traceFile);
+	check(count_occurrences(text, "\"name\":\"busy\"") > 0, "Events of the recording thread are missing");
+	free(text);
+
+	fmi2_import_destroy_dllfmu(fmu);
+
+	fmi2_import_free(fmu);
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
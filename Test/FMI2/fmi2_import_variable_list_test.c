@@ -0,0 +1,190 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+static int is_real(fmi2_import_variable_t* v, void* data)
+{
+	return fmi2_import_get_variable_base_type(v) == fmi2_base_type_real;
+}
+
+/* Non-zero if the two lists hold the same variables in the same order */
+static int same_variables(fmi2_import_variable_list_t* a, fmi2_import_variable_list_t* b)
+{
+	size_t k, n = fmi2_import_get_variable_list_size(a);
+	if(n != fmi2_import_get_variable_list_size(b)) return 0;
+	for(k = 0; k < n; k++) {
+		if(fmi2_import_get_variable(a, k) != fmi2_import_get_variable(b, k)) return 0;
+	}
+	return 1;
+}
+
+static void test_views(fmi2_import_variable_list_t* all)
+{
+	size_t n = fmi2_import_get_variable_list_size(all);
+	fmi2_import_variable_list_view_t view, sub;
+	fmi2_import_variable_list_t *copy, *sublist;
+
+	fmi2_import_init_variable_list_view(&view, all);
+	check(view.size == n, "The view must cover the whole list");
+	check(fmi2_import_init_variable_list_subview(&sub, &view, 2, n - 3) == jm_status_success, "Could not create a subview");
+	check(sub.size == n - 4 && fmi2_import_get_view_variable(&sub, 0) == fmi2_import_get_variable(all, 2), "Unexpected subview");
+	check(fmi2_import_get_view_variable(&sub, sub.size) == 0, "Access past the end of a view");
+	check(fmi2_import_init_variable_list_subview(&sub, &sub, 1, 1) == jm_status_success, "Could not create a subview of a subview");
+	check(sub.size == 1 && fmi2_import_get_view_variable(&sub, 0) == fmi2_import_get_variable(all, 3), "Unexpected subview of a subview");
+	check(fmi2_import_init_variable_list_subview(&sub, &view, 1, n) == jm_status_error && sub.size == 0, "An invalid range must give an empty view");
+
+	fmi2_import_init_variable_list_subview(&sub, &view, 2, n - 3);
+	copy = fmi2_import_view_to_variable_list(&sub);
+	sublist = fmi2_import_get_sublist(all, 2, n - 3);
+	check(copy && sublist && same_variables(copy, sublist), "The copy of a view differs from the sublist");
+	check(fmi2_import_get_sublist(all, 3, 2) == 0, "An invalid sublist must be NULL");
+	fmi2_import_free_variable_list(copy);
+	fmi2_import_free_variable_list(sublist);
+}
+
+static void test_in_place(fmi2_import_t* fmu, fmi2_import_variable_list_t* all)
+{
+	size_t k, n = fmi2_import_get_variable_list_size(all);
+	fmi2_import_variable_list_view_t view;
+	fmi2_import_variable_list_t *list, *joined, *filtered;
+	const fmi2_value_reference_t* vrs;
+
+	/* Incremental building with the in-place append versus the copying wrappers */
+	list = fmi2_import_create_var_list(fmu, fmi2_import_get_variable(all, 0));
+	check(list != 0, "Could not create a list");
+	for(k = 1; k < n; k++) {
+		check(fmi2_import_var_list_push_back(list, fmi2_import_get_variable(all, k)) == jm_status_success, "fmi2_import_var_list_push_back failed");
+	}
+	check(same_variables(list, all), "Unexpected list after push back");
+
+	/* Appending a view of the list itself doubles it */
+	fmi2_import_init_variable_list_view(&view, list);
+	check(fmi2_import_var_list_append_view(list, &view) == jm_status_success, "fmi2_import_var_list_append_view failed");
+	joined = fmi2_import_join_var_list(all, all);
+	check(joined && same_variables(list, joined), "Appending a view of the list differs from joining");
+	fmi2_import_free_variable_list(joined);
+
+	/* The cached value references follow the changes */
+	vrs = fmi2_import_get_value_referece_list(list);
+	check(vrs != 0, "Could not get the value references");
+	filtered = fmi2_import_filter_variables(list, is_real, 0);
+	check(fmi2_import_var_list_filter(list, is_real, 0) == fmi2_import_get_variable_list_size(filtered), "Unexpected size after filtering");
+	check(filtered && same_variables(list, filtered), "Filtering in place differs from fmi2_import_filter_variables");
+	vrs = fmi2_import_get_value_referece_list(list);
+	for(k = 0; k < fmi2_import_get_variable_list_size(list); k++) {
+		check(vrs[k] == fmi2_import_get_variable_vr(fmi2_import_get_variable(list, k)), "Stale value references after filtering");
+	}
+	fmi2_import_free_variable_list(filtered);
+
+	/* Sorting and removing the repetitions */
+	check(fmi2_import_var_list_sort(list, fmi2_import_compare_variables_by_name, 0) == jm_status_success, "fmi2_import_var_list_sort failed");
+	for(k = 1; k < fmi2_import_get_variable_list_size(list); k++) {
+		check(fmi2_import_compare_variables_by_name(fmi2_import_get_variable(list, k - 1), fmi2_import_get_variable(list, k), 0) <= 0, "The list is not sorted by name");
+	}
+	/* Every variable is in the list twice */
+	n = fmi2_import_get_variable_list_size(list);
+	check(fmi2_import_var_list_unique(list) == n / 2 && fmi2_import_get_variable_list_size(list) == n / 2, "Unexpected size after removing repetitions");
+	n /= 2;
+	for(k = 1; k < n; k++) {
+		check(fmi2_import_get_variable(list, k - 1) != fmi2_import_get_variable(list, k), "Repetitions remain in the list");
+	}
+
+	/* A stable sort by value reference keeps the aliases ordered by name */
+	check(fmi2_import_var_list_sort(list, fmi2_import_compare_variables_by_vr, 0) == jm_status_success, "fmi2_import_var_list_sort failed");
+	for(k = 1; k < n; k++) {
+		fmi2_import_variable_t* a = fmi2_import_get_variable(list, k - 1);
+		fmi2_import_variable_t* b = fmi2_import_get_variable(list, k);
+		int c = fmi2_import_compare_variables_by_vr(a, b, 0);
+		check(c < 0 || (c == 0 && fmi2_import_compare_variables_by_name(a, b, 0) < 0), "The sort by value reference is not stable");
+	}
+	printf("%u real variables, sorted and unique\n", (unsigned)n);
+	fmi2_import_free_variable_list(list);
+
+	/* The copying wrappers */
+	list = fmi2_import_prepend_to_var_list(all, fmi2_import_get_variable(all, 1));
+	check(list && fmi2_import_get_variable_list_size(list) == fmi2_import_get_variable_list_size(all) + 1
+		&& fmi2_import_get_variable(list, 0) == fmi2_import_get_variable(all, 1)
+		&& fmi2_import_get_variable(list, 1) == fmi2_import_get_variable(all, 0), "Unexpected prepended list");
+	joined = fmi2_import_append_to_var_list(list, fmi2_import_get_variable(all, 0));
+	check(joined && fmi2_import_get_variable(joined, fmi2_import_get_variable_list_size(list)) == fmi2_import_get_variable(all, 0), "Unexpected appended list");
+	fmi2_import_free_variable_list(joined);
+	fmi2_import_free_variable_list(list);
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi2_import_t* fmu;
+	fmi2_import_variable_list_t* all;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_warning;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	if(fmi_import_get_fmi_version(context, FMUPath, tmpPath) != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	fmu = fmi2_import_parse_xml(context, tmpPath, 0);
+	check(fmu != 0, "Error parsing XML");
+
+	all = fmi2_import_get_variable_list(fmu, 0);
+	check(all && fmi2_import_get_variable_list_size(all) > 4, "Too few variables in the model description");
+
+	test_views(all);
+	test_in_place(fmu, all);
+
+	fmi2_import_free_variable_list(all);
+	fmi2_import_free(fmu);
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
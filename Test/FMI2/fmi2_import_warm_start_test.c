@@ -0,0 +1,223 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "config_test.h"
+#include "fmi_test_check.h"
+#include <fmilib.h>
+
+#define NUM_TARGETS 8
+#define NUM_STEPS 10
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* Every FMU gets its own callbacks and context since the targets are set up from several threads */
+typedef struct test_fmu_t {
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi2_callback_functions_t callBackFunctions;
+	fmi2_import_t* fmu;
+} test_fmu_t;
+
+static fmi2_real_t hstep = 0.1;
+static const fmi2_value_reference_t vrGravity = 2;
+
+static void load_fmu(test_fmu_t* t, const char* tmpPath)
+{
+	t->callbacks.malloc = malloc;
+	t->callbacks.calloc = calloc;
+	t->callbacks.realloc = realloc;
+	t->callbacks.free = free;
+	t->callbacks.logger = jm_default_logger;
+	t->callbacks.log_level = jm_log_level_warning;
+	t->callbacks.context = 0;
+
+	t->context = fmi_import_allocate_context(&t->callbacks);
+	t->fmu = fmi2_import_parse_xml(t->context, tmpPath, 0);
+	if(!t->fmu) {
+		printf("Error parsing XML, exiting\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	t->callBackFunctions.logger = fmi2_log_forwarding;
+	t->callBackFunctions.allocateMemory = calloc;
+	t->callBackFunctions.freeMemory = free;
+	t->callBackFunctions.componentEnvironment = t->fmu;
+
+	if(fmi2_import_create_dllfmu(t->fmu, fmi2_fmu_kind_cs, &t->callBackFunctions) == jm_status_error) {
+		printf("Could not create the DLL loading mechanism(C-API test).\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+}
+
+static void unload_fmu(test_fmu_t* t)
+{
+	fmi2_import_destroy_dllfmu(t->fmu);
+	fmi2_import_free(t->fmu);
+	fmi_import_free_context(t->context);
+}
+
+static fmi2_real_t get_real(fmi2_import_t* fmu, fmi2_value_reference_t vr)
+{
+	fmi2_real_t value;
+	fmi2_import_get_real(fmu, &vr, 1, &value);
+	return value;
+}
+
+static fmi2_real_t variant_gravity(size_t index)
+{
+	return -9.81 * (1.0 + 0.1 * index);
+}
+
+/* Every variant gets its own gravity */
+static jm_status_enu_t set_variant(fmi2_import_t* fmu, size_t index, void* userData)
+{
+	fmi2_real_t g = variant_gravity(index);
+	int* calls = (int*)userData;
+	calls[index]++;
+	return (fmi2_import_set_real(fmu, &vrGravity, 1, &g) == fmi2_status_ok) ? jm_status_success : jm_status_error;
+}
+
+static jm_status_enu_t fail_variant(fmi2_import_t* fmu, size_t index, void* userData)
+{
+	return (index == 1) ? jm_status_error : jm_status_success;
+}
+
+/* Simulate a variant from the current state of the FMU */
+static fmi2_real_t simulate(fmi2_import_t* fmu, fmi2_real_t tstart)
+{
+	fmi2_real_t t = tstart;
+	size_t k;
+
+	for(k = 0; k < NUM_STEPS; k++) {
+		check(fmi2_import_do_step(fmu, t, hstep, fmi2_true) == fmi2_status_ok, "fmi2_import_do_step failed");
+		t += hstep;
+	}
+	return get_real(fmu, 0);
+}
+
+void test_warm_start(const char* tmpPath)
+{
+	test_fmu_t source, targets[NUM_TARGETS];
+	fmi2_import_t* fmus[NUM_TARGETS];
+	const char* names[NUM_TARGETS];
+	int calls[NUM_TARGETS];
+	fmi2_real_t reference[NUM_TARGETS], tstart, g;
+	fmi2_FMU_state_t initial = 0;
+	size_t k;
+
+	/* Initialize the source once and advance it a bit so that its state is not the start state */
+	load_fmu(&source, tmpPath);
+	check(fmi2_import_instantiate(source.fmu, "Source instance", fmi2_cosimulation, "", fmi2_false) != jm_status_error,
+		"fmi2_import_instantiate failed");
+	check(fmi2_import_setup_experiment(source.fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0) == fmi2_status_ok &&
+		fmi2_import_enter_initialization_mode(source.fmu) == fmi2_status_ok &&
+		fmi2_import_exit_initialization_mode(source.fmu) == fmi2_status_ok, "Initialization of the FMU failed");
+	simulate(source.fmu, 0.0);
+	tstart = NUM_STEPS * hstep;
+
+	/* Serial reference: every variant simulated by the source from the same state */
+	check(fmi2_import_get_fmu_state(source.fmu, &initial) == fmi2_status_ok, "fmi2_import_get_fmu_state failed");
+	for(k = 0; k < NUM_TARGETS; k++) {
+		g = variant_gravity(k);
+		check(fmi2_import_set_fmu_state(source.fmu, initial) == fmi2_status_ok, "fmi2_import_set_fmu_state failed");
+		fmi2_import_set_real(source.fmu, &vrGravity, 1, &g);
+		reference[k] = simulate(source.fmu, tstart);
+	}
+	check(fmi2_import_set_fmu_state(source.fmu, initial) == fmi2_status_ok, "fmi2_import_set_fmu_state failed");
+
+	for(k = 0; k < NUM_TARGETS; k++) {
+		load_fmu(&targets[k], tmpPath);
+		fmus[k] = targets[k].fmu;
+		names[k] = (k % 2) ? "Odd variant" : 0;
+		calls[k] = 0;
+	}
+	check(fmi2_import_warm_start(source.fmu, fmus, NUM_TARGETS, names, 3, set_variant, calls) == jm_status_success,
+		"fmi2_import_warm_start failed");
+	for(k = 0; k < NUM_TARGETS; k++) {
+		check(calls[k] == 1, "Override function not called once per instance");
+		check(get_real(fmus[k], 0) == get_real(source.fmu, 0) && get_real(fmus[k], vrGravity) == variant_gravity(k),
+			"Warm started instance has a wrong state");
+		check(simulate(fmus[k], tstart) == reference[k], "Warm started instance differs from the reference");
+		fmi2_import_terminate(fmus[k]);
+		fmi2_import_free_instance(fmus[k]);
+	}
+
+	/* A failing override leaves only that instance uninstantiated */
+	check(fmi2_import_warm_start(source.fmu, fmus, NUM_TARGETS, 0, 0, fail_variant, 0) == jm_status_error,
+		"A failing override was not reported");
+	for(k = 0; k < NUM_TARGETS; k++) {
+		if(k == 1) continue;
+		check(get_real(fmus[k], 0) == get_real(source.fmu, 0), "Warm started instance has a wrong state");
+		fmi2_import_terminate(fmus[k]);
+		fmi2_import_free_instance(fmus[k]);
+	}
+
+	for(k = 0; k < NUM_TARGETS; k++) unload_fmu(&targets[k]);
+	fmi2_import_free_fmu_state(source.fmu, &initial);
+	fmi2_import_terminate(source.fmu);
+	fmi2_import_free_instance(source.fmu);
+	unload_fmu(&source);
+}
+
+int main(int argc, char *argv[])
+{
+	const char* FMUPath;
+	const char* tmpPath;
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_version_enu_t version;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	FMUPath = argv[1];
+	tmpPath = argv[2];
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_verbose;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+
+	version = fmi_import_get_fmi_version(context, FMUPath, tmpPath);
+	fmi_import_free_context(context);
+
+	if(version != fmi_version_2_0_enu) {
+		printf("Only version 2.0 is supported by this code\n");
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	test_warm_start(tmpPath);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+
+	do_exit(CTEST_RETURN_SUCCESS);
+
+	return 0;
+}
@@ -247,6 +247,99 @@ fmi2Status fmi_set_string(fmi2Component c, const fmi2ValueReference vr[], size_t
 	}
 }
 
+/* The FMU state holds the values that change during simulation. String variables are not included. */
+typedef struct {
+	fmi2Real					states			[N_STATES];
+	fmi2Real					states_der		[N_STATES];
+	fmi2Real					event_indicators[N_EVENT_INDICATORS];
+	fmi2Real					reals			[N_REAL];
+	fmi2Integer				integers		[N_INTEGER];
+	fmi2Boolean				booleans		[N_BOOLEAN];
+	fmi2Real					fmitime;
+	fmi2EventInfo			eventInfo;
+	fmi2Real					states_prev		[N_STATES];
+} fmu_state_t;
+
+#define FMU_STATE_COPY(dst, src) \
+	memcpy((dst)->states, (src)->states, sizeof((dst)->states)); \
+	memcpy((dst)->states_der, (src)->states_der, sizeof((dst)->states_der)); \
+	memcpy((dst)->event_indicators, (src)->event_indicators, sizeof((dst)->event_indicators)); \
+	memcpy((dst)->reals, (src)->reals, sizeof((dst)->reals)); \
+	memcpy((dst)->integers, (src)->integers, sizeof((dst)->integers)); \
+	memcpy((dst)->booleans, (src)->booleans, sizeof((dst)->booleans)); \
+	(dst)->fmitime = (src)->fmitime; \
+	(dst)->eventInfo = (src)->eventInfo; \
+	memcpy((dst)->states_prev, (src)->states_prev, sizeof((dst)->states_prev))
+
+fmi2Status fmi_get_fmu_state(fmi2Component c, fmi2FMUstate* s)
+{
+	component_ptr_t comp = (fmi2Component)c;
+	fmu_state_t* state;
+	if (comp == NULL) {
+		return fmi2Fatal;
+	}
+	/* An existing state is overwritten */
+	state = (fmu_state_t*)*s;
+	if (state == NULL) {
+		state = (fmu_state_t*)comp->functions->allocateMemory(1, sizeof(fmu_state_t));
+		if (state == NULL) return fmi2Error;
+	}
+	FMU_STATE_COPY(state, comp);
+	*s = state;
+	return fmi2OK;
+}
+
+fmi2Status fmi_set_fmu_state(fmi2Component c, fmi2FMUstate s)
+{
+	component_ptr_t comp = (fmi2Component)c;
+	fmu_state_t* state = (fmu_state_t*)s;
+	if (comp == NULL) {
+		return fmi2Fatal;
+	}
+	if (state == NULL) return fmi2Error;
+	FMU_STATE_COPY(comp, state);
+	return fmi2OK;
+}
+
+fmi2Status fmi_free_fmu_state(fmi2Component c, fmi2FMUstate* s)
+{
+	component_ptr_t comp = (fmi2Component)c;
+	if (comp == NULL) {
+		return fmi2Fatal;
+	}
+	comp->functions->freeMemory(*s);
+	*s = NULL;
+	return fmi2OK;
+}
+
+fmi2Status fmi_serialized_fmu_state_size(fmi2Component c, fmi2FMUstate s, size_t* size)
+{
+	*size = sizeof(fmu_state_t);
+	return fmi2OK;
+}
+
+fmi2Status fmi_serialize_fmu_state(fmi2Component c, fmi2FMUstate s, fmi2Byte data[], size_t size)
+{
+	if (s == NULL || size < sizeof(fmu_state_t)) return fmi2Error;
+	memcpy(data, s, sizeof(fmu_state_t));
+	return fmi2OK;
+}
+
+fmi2Status fmi_de_serialize_fmu_state(fmi2Component c, const fmi2Byte data[], size_t size, fmi2FMUstate* s)
+{
+	component_ptr_t comp = (fmi2Component)c;
+	if (comp == NULL) {
+		return fmi2Fatal;
+	}
+	if (size != sizeof(fmu_state_t)) return fmi2Error;
+	if (*s == NULL) {
+		*s = comp->functions->allocateMemory(1, sizeof(fmu_state_t));
+		if (*s == NULL) return fmi2Error;
+	}
+	memcpy(*s, data, sizeof(fmu_state_t));
+	return fmi2OK;
+}
+
 /* FMI 2.0 ME Functions */
 const char* fmi_get_model_types_platform()
 {
@@ -147,6 +147,13 @@ fmi2Status		fmi_set_string(
 													size_t nvr,
 													const fmi2String  value[]);
 
+fmi2Status		fmi_get_fmu_state(fmi2Component c, fmi2FMUstate* s);
+fmi2Status		fmi_set_fmu_state(fmi2Component c, fmi2FMUstate s);
+fmi2Status		fmi_free_fmu_state(fmi2Component c, fmi2FMUstate* s);
+fmi2Status		fmi_serialized_fmu_state_size(fmi2Component c, fmi2FMUstate s, size_t* size);
+fmi2Status		fmi_serialize_fmu_state(fmi2Component c, fmi2FMUstate s, fmi2Byte data[], size_t size);
+fmi2Status		fmi_de_serialize_fmu_state(fmi2Component c, const fmi2Byte data[], size_t size, fmi2FMUstate* s);
+
 /* FMI 2.0 ME Functions */
 const char*		fmi_get_model_types_platform();
 
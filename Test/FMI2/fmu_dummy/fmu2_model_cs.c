@@ -118,6 +118,36 @@ FMI2_Export fmi2Status fmi2SetString(fmi2Component c, const fmi2ValueReference v
 	return fmi_set_string(c, vr, nvr, value);
 }
 
+FMI2_Export fmi2Status fmi2GetFMUstate(fmi2Component c, fmi2FMUstate* s)
+{
+	return fmi_get_fmu_state(c, s);
+}
+
+FMI2_Export fmi2Status fmi2SetFMUstate(fmi2Component c, fmi2FMUstate s)
+{
+	return fmi_set_fmu_state(c, s);
+}
+
+FMI2_Export fmi2Status fmi2FreeFMUstate(fmi2Component c, fmi2FMUstate* s)
+{
+	return fmi_free_fmu_state(c, s);
+}
+
+FMI2_Export fmi2Status fmi2SerializedFMUstateSize(fmi2Component c, fmi2FMUstate s, size_t* size)
+{
+	return fmi_serialized_fmu_state_size(c, s, size);
+}
+
+FMI2_Export fmi2Status fmi2SerializeFMUstate(fmi2Component c, fmi2FMUstate s, fmi2Byte data[], size_t size)
+{
+	return fmi_serialize_fmu_state(c, s, data, size);
+}
+
+FMI2_Export fmi2Status fmi2DeSerializeFMUstate(fmi2Component c, const fmi2Byte data[], size_t size, fmi2FMUstate* s)
+{
+	return fmi_de_serialize_fmu_state(c, data, size, s);
+}
+
 /* FMI 2.0 CS Functions */
 FMI2_Export const char* fmi2GetTypesPlatform()
 {
@@ -0,0 +1,231 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <config_test.h>
+#include "fmi_test_check.h"
+#include <fmilib.h>
+#include <fmu_scalable/fmu_scalable_model.h>
+
+#define NUM_STEPS 10
+#define STEP_SIZE 0.01
+
+void do_exit(int code)
+{
+	printf("Press 'Enter' to exit\n");
+	/* getchar(); */
+	exit(code);
+}
+
+/* All states stay equal since they start at 1 and the inputs are 0 */
+static double expected_state(const fmu_scalable_sizes_t* s)
+{
+	return pow(1.0 + STEP_SIZE * (-1.0 + 0.01 * s->bw), NUM_STEPS);
+}
+
+static size_t expected_variables(const fmu_scalable_sizes_t* s)
+{
+	return 2 * s->nx + s->nu + s->ny + 2 * s->na;
+}
+
+static void simulate_fmi1(fmi1_import_t* fmu, const fmu_scalable_sizes_t* s)
+{
+	fmi1_value_reference_t vr = (fmi1_value_reference_t)FMU_SCALABLE_VR_Y(s, 0);
+	fmi1_real_t y, t = 0;
+	size_t k, i;
+
+	if(fmi1_import_get_fmu_kind(fmu) == fmi1_fmu_kind_enu_me) {
+		fmi1_event_info_t eventInfo;
+		fmi1_real_t* x = (fmi1_real_t*)calloc(2 * s->nx, sizeof(fmi1_real_t));
+		fmi1_real_t* der = x + s->nx;
+
+		check(x != 0, "Out of memory");
+		check(fmi1_import_instantiate_model(fmu, "scalable") != jm_status_error, "fmi1_import_instantiate_model failed");
+		check(fmi1_import_initialize(fmu, fmi1_false, 0, &eventInfo) == fmi1_status_ok, "fmi1_import_initialize failed");
+		for(k = 0; k < NUM_STEPS; k++) {
+			check(fmi1_import_get_continuous_states(fmu, x, s->nx) == fmi1_status_ok &&
+				fmi1_import_get_derivatives(fmu, der, s->nx) == fmi1_status_ok, "Could not get the states");
+			for(i = 0; i < s->nx; i++) x[i] += STEP_SIZE * der[i];
+			t += STEP_SIZE;
+			check(fmi1_import_set_time(fmu, t) == fmi1_status_ok &&
+				fmi1_import_set_continuous_states(fmu, x, s->nx) == fmi1_status_ok, "Could not set the states");
+		}
+		check(fmi1_import_get_real(fmu, &vr, 1, &y) == fmi1_status_ok, "fmi1_import_get_real failed");
+		fmi1_import_terminate(fmu);
+		fmi1_import_free_model_instance(fmu);
+		free(x);
+	}
+	else {
+		check(fmi1_import_instantiate_slave(fmu, "scalable", 0, 0, 0, fmi1_false, fmi1_false) != jm_status_error,
+			"fmi1_import_instantiate_slave failed");
+		check(fmi1_import_initialize_slave(fmu, 0, fmi1_false, 0) == fmi1_status_ok, "fmi1_import_initialize_slave failed");
+		for(k = 0; k < NUM_STEPS; k++) {
+			check(fmi1_import_do_step(fmu, t, STEP_SIZE, fmi1_true) == fmi1_status_ok, "fmi1_import_do_step failed");
+			t += STEP_SIZE;
+		}
+		check(fmi1_import_get_real(fmu, &vr, 1, &y) == fmi1_status_ok, "fmi1_import_get_real failed");
+		fmi1_import_terminate_slave(fmu);
+		fmi1_import_free_slave_instance(fmu);
+	}
+	check(fabs(y - expected_state(s)) < 1e-12, "Unexpected output value");
+}
+
+static void test_fmi1(fmi_import_context_t* context, const char* dirPath)
+{
+	fmi1_callback_functions_t callBackFunctions;
+	fmu_scalable_sizes_t s;
+	fmi1_import_t* fmu;
+	fmi1_import_variable_list_t* vl;
+
+	callBackFunctions.logger = fmi1_log_forwarding;
+	callBackFunctions.allocateMemory = calloc;
+	callBackFunctions.freeMemory = free;
+
+	fmu = fmi1_import_parse_xml(context, dirPath);
+	check(fmu != 0, "Error parsing XML");
+	check(fmu_scalable_parse_guid(fmi1_import_get_GUID(fmu), &s) == 0, "Unexpected GUID");
+
+	vl = fmi1_import_get_variable_list(fmu);
+	check(fmi1_import_get_variable_list_size(vl) == expected_variables(&s), "Unexpected number of variables");
+	fmi1_import_free_variable_list(vl);
+	check(fmi1_import_get_number_of_continuous_states(fmu) == s.nx, "Unexpected number of states");
+	check(fmi1_import_get_number_of_event_indicators(fmu) == s.nz, "Unexpected number of event indicators");
+	if(s.na) {
+		fmi1_import_variable_t* v = fmi1_import_get_variable_by_name(fmu, "alias[1].b");
+		check(v && fmi1_import_get_variable_alias_kind(v) == fmi1_variable_is_negated_alias, "Negated alias is missing");
+	}
+
+	check(fmi1_import_create_dllfmu(fmu, callBackFunctions, 0) != jm_status_error, "Could not create the DLL loading mechanism");
+	simulate_fmi1(fmu, &s);
+	fmi1_import_destroy_dllfmu(fmu);
+	fmi1_import_free(fmu);
+}
+
+static void simulate_fmi2(fmi2_import_t* fmu, const fmu_scalable_sizes_t* s)
+{
+	fmi2_value_reference_t vr = (fmi2_value_reference_t)FMU_SCALABLE_VR_Y(s, 0);
+	fmi2_value_reference_t unknown = (fmi2_value_reference_t)FMU_SCALABLE_VR_DER(s, 0);
+	fmi2_value_reference_t known = (fmi2_value_reference_t)FMU_SCALABLE_VR_X(s, 0);
+	fmi2_real_t y, t = 0, seed = 1.0, d;
+	fmi2_boolean_t me = (fmi2_import_get_fmu_kind(fmu) == fmi2_fmu_kind_me);
+	size_t k, i;
+
+	check(fmi2_import_instantiate(fmu, "scalable", me ? fmi2_model_exchange : fmi2_cosimulation, 0, fmi2_false) != jm_status_error,
+		"fmi2_import_instantiate failed");
+	check(fmi2_import_setup_experiment(fmu, fmi2_false, 0.0, 0.0, fmi2_false, 0.0) == fmi2_status_ok &&
+		fmi2_import_enter_initialization_mode(fmu) == fmi2_status_ok &&
+		fmi2_import_exit_initialization_mode(fmu) == fmi2_status_ok, "Initialization of the FMU failed");
+
+	if(me) {
+		fmi2_real_t* x = (fmi2_real_t*)calloc(2 * s->nx, sizeof(fmi2_real_t));
+		fmi2_real_t* der = x + s->nx;
+		fmi2_event_info_t eventInfo;
+		fmi2_boolean_t enterEventMode, terminate;
+
+		check(x != 0, "Out of memory");
+		/* The directional derivative is only loaded for model exchange */
+		check(fmi2_import_get_directional_derivative(fmu, &unknown, 1, &known, 1, &seed, &d) == fmi2_status_ok &&
+			fabs(d + 1.0) < 1e-15, "Unexpected directional derivative");
+		check(fmi2_import_new_discrete_states(fmu, &eventInfo) == fmi2_status_ok &&
+			fmi2_import_enter_continuous_time_mode(fmu) == fmi2_status_ok, "Could not enter continuous time mode");
+		for(k = 0; k < NUM_STEPS; k++) {
+			check(fmi2_import_get_continuous_states(fmu, x, s->nx) == fmi2_status_ok &&
+				fmi2_import_get_derivatives(fmu, der, s->nx) == fmi2_status_ok, "Could not get the states");
+			for(i = 0; i < s->nx; i++) x[i] += STEP_SIZE * der[i];
+			t += STEP_SIZE;
+			check(fmi2_import_set_time(fmu, t) == fmi2_status_ok &&
+				fmi2_import_set_continuous_states(fmu, x, s->nx) == fmi2_status_ok &&
+				fmi2_import_completed_integrator_step(fmu, fmi2_true, &enterEventMode, &terminate) == fmi2_status_ok,
+				"Could not set the states");
+		}
+		free(x);
+	}
+	else {
+		for(k = 0; k < NUM_STEPS; k++) {
+			check(fmi2_import_do_step(fmu, t, STEP_SIZE, fmi2_true) == fmi2_status_ok, "fmi2_import_do_step failed");
+			t += STEP_SIZE;
+		}
+	}
+	check(fmi2_import_get_real(fmu, &vr, 1, &y) == fmi2_status_ok, "fmi2_import_get_real failed");
+	check(fabs(y - expected_state(s)) < 1e-12, "Unexpected output value");
+	fmi2_import_terminate(fmu);
+	fmi2_import_free_instance(fmu);
+}
+
+static void test_fmi2(fmi_import_context_t* context, const char* dirPath)
+{
+	fmu_scalable_sizes_t s;
+	fmi2_import_t* fmu;
+	fmi2_import_variable_list_t* vl;
+	size_t *startIndex, *dependency;
+	char* factorKind;
+
+	fmu = fmi2_import_parse_xml(context, dirPath, 0);
+	check(fmu != 0, "Error parsing XML");
+	check(fmu_scalable_parse_guid(fmi2_import_get_GUID(fmu), &s) == 0, "Unexpected GUID");
+
+	vl = fmi2_import_get_variable_list(fmu, 0);
+	check(fmi2_import_get_variable_list_size(vl) == expected_variables(&s), "Unexpected number of variables");
+	fmi2_import_free_variable_list(vl);
+	check(fmi2_import_get_number_of_event_indicators(fmu) == s.nz, "Unexpected number of event indicators");
+
+	/* Every derivative depends on bw + 1 states and one input */
+	fmi2_import_get_derivatives_dependencies(fmu, &startIndex, &dependency, &factorKind);
+	check(startIndex != 0 && startIndex[s.nx] == s.nx * (s.bw + 1 + (s.nu ? 1 : 0)), "Unexpected derivative dependencies");
+	if(s.ny) {
+		fmi2_import_get_outputs_dependencies(fmu, &startIndex, &dependency, &factorKind);
+		check(startIndex != 0 && startIndex[s.ny] == s.ny, "Unexpected output dependencies");
+	}
+
+	check(fmi2_import_create_dllfmu(fmu, fmi2_import_get_fmu_kind(fmu), 0) != jm_status_error,
+		"Could not create the DLL loading mechanism");
+	simulate_fmi2(fmu, &s);
+	fmi2_import_destroy_dllfmu(fmu);
+	fmi2_import_free(fmu);
+}
+
+int main(int argc, char *argv[])
+{
+	jm_callbacks callbacks;
+	fmi_import_context_t* context;
+	fmi_version_enu_t version;
+
+	if(argc < 3) {
+		printf("Usage: %s <fmu_file> <temporary_dir>\n", argv[0]);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+
+	callbacks.malloc = malloc;
+	callbacks.calloc = calloc;
+	callbacks.realloc = realloc;
+	callbacks.free = free;
+	callbacks.logger = jm_default_logger;
+	callbacks.log_level = jm_log_level_warning;
+	callbacks.context = 0;
+
+	context = fmi_import_allocate_context(&callbacks);
+	version = fmi_import_get_fmi_version(context, argv[1], argv[2]);
+	if(version == fmi_version_1_enu) test_fmi1(context, argv[2]);
+	else if(version == fmi_version_2_0_enu) test_fmi2(context, argv[2]);
+	else check(0, "Unsupported FMI version");
+	fmi_import_free_context(context);
+
+	printf("Everything seems to be OK since you got this far=)!\n");
+	do_exit(CTEST_RETURN_SUCCESS);
+	return 0;
+}
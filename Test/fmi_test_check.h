@@ -0,0 +1,34 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef FMI_TEST_CHECK_H
+#define FMI_TEST_CHECK_H
+
+#include <stdio.h>
+#include "config_test.h"
+
+/* Defined by each test: report and exit with the given code */
+void do_exit(int code);
+
+/* Fail the test with the message unless the condition holds */
+static void check(int condition, const char* message)
+{
+	if(!condition) {
+		printf("%s\n", message);
+		do_exit(CTEST_RETURN_FAIL);
+	}
+}
+
+#endif
@@ -0,0 +1,209 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/* FMI 1.0 co-simulation interface of the scalable test model. MODEL_IDENTIFIER is set by the build. */
+
+#include <string.h>
+
+#if __GNUC__ >= 4
+    #pragma GCC visibility push(default)
+#endif
+
+#include <FMI1/fmiPlatformTypes.h>
+#include <FMI1/fmiFunctions.h>
+
+#include "fmu_scalable_model.h"
+
+typedef struct {
+	fmu_scalable_model_t* model;
+	fmiCallbackFunctions functions;
+	char* instanceName;
+} component_t;
+
+static fmiStatus error(fmiComponent c, const char* message)
+{
+	component_t* comp = (component_t*)c;
+	comp->functions.logger(c, comp->instanceName, fmiError, "error", message);
+	return fmiError;
+}
+
+static fmiStatus no_variables(fmiComponent c, size_t nvr)
+{
+	return nvr ? error(c, "The model has only Real variables") : fmiOK;
+}
+
+DllExport const char* fmiGetTypesPlatform()
+{
+	return fmiPlatform;
+}
+
+DllExport const char* fmiGetVersion()
+{
+	return fmiVersion;
+}
+
+DllExport fmiStatus fmiSetDebugLogging(fmiComponent c, fmiBoolean loggingOn)
+{
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiGetReal(fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiReal value[])
+{
+	if(fmu_scalable_get_real(((component_t*)c)->model, vr, nvr, value)) return error(c, "Invalid value reference");
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiGetInteger(fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiInteger value[])
+{
+	return no_variables(c, nvr);
+}
+
+DllExport fmiStatus fmiGetBoolean(fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiBoolean value[])
+{
+	return no_variables(c, nvr);
+}
+
+DllExport fmiStatus fmiGetString(fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiString value[])
+{
+	return no_variables(c, nvr);
+}
+
+DllExport fmiStatus fmiSetReal(fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiReal value[])
+{
+	if(fmu_scalable_set_real(((component_t*)c)->model, vr, nvr, value)) return error(c, "Invalid value reference");
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiSetInteger(fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiInteger value[])
+{
+	return no_variables(c, nvr);
+}
+
+DllExport fmiStatus fmiSetBoolean(fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiBoolean value[])
+{
+	return no_variables(c, nvr);
+}
+
+DllExport fmiStatus fmiSetString(fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiString value[])
+{
+	return no_variables(c, nvr);
+}
+
+DllExport fmiComponent fmiInstantiateSlave(fmiString instanceName, fmiString fmuGUID, fmiString fmuLocation,
+	fmiString mimeType, fmiReal timeout, fmiBoolean visible, fmiBoolean interactive,
+	fmiCallbackFunctions functions, fmiBoolean loggingOn)
+{
+	fmu_scalable_sizes_t sizes;
+	component_t* comp;
+
+	if(!functions.allocateMemory || !functions.freeMemory || !functions.logger) return 0;
+	if(fmu_scalable_parse_guid(fmuGUID, &sizes)) {
+		functions.logger(0, instanceName, fmiError, "error", "Unexpected GUID %s", fmuGUID);
+		return 0;
+	}
+	comp = (component_t*)functions.allocateMemory(1, sizeof(component_t));
+	if(!comp) return 0;
+	comp->functions = functions;
+	comp->model = fmu_scalable_create(&sizes, functions.allocateMemory, functions.freeMemory);
+	comp->instanceName = (char*)functions.allocateMemory(strlen(instanceName) + 1, sizeof(char));
+	if(!comp->model || !comp->instanceName) {
+		functions.logger(0, instanceName, fmiError, "error", "Out of memory");
+		fmu_scalable_free(comp->model);
+		functions.freeMemory(comp->instanceName);
+		functions.freeMemory(comp);
+		return 0;
+	}
+	strcpy(comp->instanceName, instanceName);
+	return comp;
+}
+
+DllExport fmiStatus fmiInitializeSlave(fmiComponent c, fmiReal tStart, fmiBoolean StopTimeDefined, fmiReal tStop)
+{
+	((component_t*)c)->model->time = tStart;
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiTerminateSlave(fmiComponent c)
+{
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiResetSlave(fmiComponent c)
+{
+	fmu_scalable_reset(((component_t*)c)->model);
+	return fmiOK;
+}
+
+DllExport void fmiFreeSlaveInstance(fmiComponent c)
+{
+	component_t* comp = (component_t*)c;
+	fmiCallbackFreeMemory release;
+
+	if(!comp) return;
+	release = comp->functions.freeMemory;
+	fmu_scalable_free(comp->model);
+	release(comp->instanceName);
+	release(comp);
+}
+
+DllExport fmiStatus fmiSetRealInputDerivatives(fmiComponent c, const fmiValueReference vr[], size_t nvr,
+	const fmiInteger order[], const fmiReal value[])
+{
+	return error(c, "Input derivatives are not supported");
+}
+
+DllExport fmiStatus fmiGetRealOutputDerivatives(fmiComponent c, const fmiValueReference vr[], size_t nvr,
+	const fmiInteger order[], fmiReal value[])
+{
+	return error(c, "Output derivatives are not supported");
+}
+
+DllExport fmiStatus fmiCancelStep(fmiComponent c)
+{
+	return error(c, "Asynchronous steps are not supported");
+}
+
+DllExport fmiStatus fmiDoStep(fmiComponent c, fmiReal currentCommunicationPoint, fmiReal communicationStepSize, fmiBoolean newStep)
+{
+	fmu_scalable_do_step(((component_t*)c)->model, communicationStepSize);
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiGetStatus(fmiComponent c, const fmiStatusKind s, fmiStatus* value)
+{
+	return error(c, "Asynchronous steps are not supported");
+}
+
+DllExport fmiStatus fmiGetRealStatus(fmiComponent c, const fmiStatusKind s, fmiReal* value)
+{
+	if(s != fmiLastSuccessfulTime) return error(c, "Asynchronous steps are not supported");
+	*value = ((component_t*)c)->model->time;
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiGetIntegerStatus(fmiComponent c, const fmiStatusKind s, fmiInteger* value)
+{
+	return error(c, "Asynchronous steps are not supported");
+}
+
+DllExport fmiStatus fmiGetBooleanStatus(fmiComponent c, const fmiStatusKind s, fmiBoolean* value)
+{
+	return error(c, "Asynchronous steps are not supported");
+}
+
+DllExport fmiStatus fmiGetStringStatus(fmiComponent c, const fmiStatusKind s, fmiString* value)
+{
+	return error(c, "Asynchronous steps are not supported");
+}
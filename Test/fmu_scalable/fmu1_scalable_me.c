@@ -0,0 +1,221 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/* FMI 1.0 model exchange interface of the scalable test model. MODEL_IDENTIFIER is set by the build. */
+
+#include <string.h>
+
+#if __GNUC__ >= 4
+    #pragma GCC visibility push(default)
+#endif
+
+#include <FMI1/fmiModelTypes.h>
+#include <FMI1/fmiModelFunctions.h>
+
+#include "fmu_scalable_model.h"
+
+typedef struct {
+	fmu_scalable_model_t* model;
+	fmiCallbackFunctions functions;
+	char* instanceName;
+} component_t;
+
+static fmiStatus error(fmiComponent c, const char* message)
+{
+	component_t* comp = (component_t*)c;
+	comp->functions.logger(c, comp->instanceName, fmiError, "error", message);
+	return fmiError;
+}
+
+static fmiStatus no_variables(fmiComponent c, size_t nvr)
+{
+	return nvr ? error(c, "The model has only Real variables") : fmiOK;
+}
+
+DllExport const char* fmiGetModelTypesPlatform()
+{
+	return fmiModelTypesPlatform;
+}
+
+DllExport const char* fmiGetVersion()
+{
+	return fmiVersion;
+}
+
+DllExport fmiComponent fmiInstantiateModel(fmiString instanceName, fmiString GUID, fmiCallbackFunctions functions, fmiBoolean loggingOn)
+{
+	fmu_scalable_sizes_t sizes;
+	component_t* comp;
+
+	if(!functions.allocateMemory || !functions.freeMemory || !functions.logger) return 0;
+	if(fmu_scalable_parse_guid(GUID, &sizes)) {
+		functions.logger(0, instanceName, fmiError, "error", "Unexpected GUID %s", GUID);
+		return 0;
+	}
+	comp = (component_t*)functions.allocateMemory(1, sizeof(component_t));
+	if(!comp) return 0;
+	comp->functions = functions;
+	comp->model = fmu_scalable_create(&sizes, functions.allocateMemory, functions.freeMemory);
+	comp->instanceName = (char*)functions.allocateMemory(strlen(instanceName) + 1, sizeof(char));
+	if(!comp->model || !comp->instanceName) {
+		functions.logger(0, instanceName, fmiError, "error", "Out of memory");
+		fmu_scalable_free(comp->model);
+		functions.freeMemory(comp->instanceName);
+		functions.freeMemory(comp);
+		return 0;
+	}
+	strcpy(comp->instanceName, instanceName);
+	return comp;
+}
+
+DllExport void fmiFreeModelInstance(fmiComponent c)
+{
+	component_t* comp = (component_t*)c;
+	fmiCallbackFreeMemory release;
+
+	if(!comp) return;
+	release = comp->functions.freeMemory;
+	fmu_scalable_free(comp->model);
+	release(comp->instanceName);
+	release(comp);
+}
+
+DllExport fmiStatus fmiSetDebugLogging(fmiComponent c, fmiBoolean loggingOn)
+{
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiSetTime(fmiComponent c, fmiReal time)
+{
+	fmu_scalable_set_time(((component_t*)c)->model, time);
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiSetContinuousStates(fmiComponent c, const fmiReal x[], size_t nx)
+{
+	component_t* comp = (component_t*)c;
+	if(nx != comp->model->sizes.nx) return error(c, "Wrong number of states");
+	fmu_scalable_set_states(comp->model, x);
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiCompletedIntegratorStep(fmiComponent c, fmiBoolean* callEventUpdate)
+{
+	*callEventUpdate = fmiFalse;
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiSetReal(fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiReal value[])
+{
+	if(fmu_scalable_set_real(((component_t*)c)->model, vr, nvr, value)) return error(c, "Invalid value reference");
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiSetInteger(fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiInteger value[])
+{
+	return no_variables(c, nvr);
+}
+
+DllExport fmiStatus fmiSetBoolean(fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiBoolean value[])
+{
+	return no_variables(c, nvr);
+}
+
+DllExport fmiStatus fmiSetString(fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiString value[])
+{
+	return no_variables(c, nvr);
+}
+
+DllExport fmiStatus fmiInitialize(fmiComponent c, fmiBoolean toleranceControlled, fmiReal relativeTolerance, fmiEventInfo* eventInfo)
+{
+	eventInfo->iterationConverged = fmiTrue;
+	eventInfo->stateValueReferencesChanged = fmiFalse;
+	eventInfo->stateValuesChanged = fmiFalse;
+	eventInfo->terminateSimulation = fmiFalse;
+	eventInfo->upcomingTimeEvent = fmiFalse;
+	eventInfo->nextEventTime = 0;
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiGetDerivatives(fmiComponent c, fmiReal derivatives[], size_t nx)
+{
+	component_t* comp = (component_t*)c;
+	if(nx != comp->model->sizes.nx) return error(c, "Wrong number of states");
+	fmu_scalable_get_derivatives(comp->model, derivatives);
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiGetEventIndicators(fmiComponent c, fmiReal eventIndicators[], size_t ni)
+{
+	component_t* comp = (component_t*)c;
+	if(ni != comp->model->sizes.nz) return error(c, "Wrong number of event indicators");
+	fmu_scalable_get_event_indicators(comp->model, eventIndicators);
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiGetReal(fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiReal value[])
+{
+	if(fmu_scalable_get_real(((component_t*)c)->model, vr, nvr, value)) return error(c, "Invalid value reference");
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiGetInteger(fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiInteger value[])
+{
+	return no_variables(c, nvr);
+}
+
+DllExport fmiStatus fmiGetBoolean(fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiBoolean value[])
+{
+	return no_variables(c, nvr);
+}
+
+DllExport fmiStatus fmiGetString(fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiString value[])
+{
+	return no_variables(c, nvr);
+}
+
+DllExport fmiStatus fmiEventUpdate(fmiComponent c, fmiBoolean intermediateResults, fmiEventInfo* eventInfo)
+{
+	return fmiInitialize(c, fmiFalse, 0, eventInfo);
+}
+
+DllExport fmiStatus fmiGetContinuousStates(fmiComponent c, fmiReal states[], size_t nx)
+{
+	component_t* comp = (component_t*)c;
+	if(nx != comp->model->sizes.nx) return error(c, "Wrong number of states");
+	fmu_scalable_get_states(comp->model, states);
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiGetNominalContinuousStates(fmiComponent c, fmiReal x_nominal[], size_t nx)
+{
+	size_t i;
+	for(i = 0; i < nx; i++) x_nominal[i] = 1.0;
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiGetStateValueReferences(fmiComponent c, fmiValueReference vrx[], size_t nx)
+{
+	component_t* comp = (component_t*)c;
+	size_t i;
+	if(nx != comp->model->sizes.nx) return error(c, "Wrong number of states");
+	for(i = 0; i < nx; i++) vrx[i] = (fmiValueReference)FMU_SCALABLE_VR_X(&comp->model->sizes, i);
+	return fmiOK;
+}
+
+DllExport fmiStatus fmiTerminate(fmiComponent c)
+{
+	return fmiOK;
+}
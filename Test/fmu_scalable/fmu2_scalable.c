@@ -0,0 +1,348 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/* FMI 2.0 model exchange and co-simulation interface of the scalable test model */
+
+#include <string.h>
+
+#if __GNUC__ >= 4
+    #pragma GCC visibility push(default)
+#endif
+
+#include <FMI2/fmi2Functions.h>
+
+#include "fmu_scalable_model.h"
+
+typedef struct {
+	fmu_scalable_model_t* model;
+	fmi2CallbackFunctions functions;
+	fmi2String instanceName;
+} component_t;
+
+static fmi2Status error(fmi2Component c, const char* message)
+{
+	component_t* comp = (component_t*)c;
+	comp->functions.logger(comp->functions.componentEnvironment, comp->instanceName, fmi2Error, "error", message);
+	return fmi2Error;
+}
+
+static fmi2Status no_variables(fmi2Component c, size_t nvr)
+{
+	return nvr ? error(c, "The model has only Real variables") : fmi2OK;
+}
+
+FMI2_Export const char* fmi2GetTypesPlatform()
+{
+	return fmi2TypesPlatform;
+}
+
+FMI2_Export const char* fmi2GetVersion()
+{
+	return fmi2Version;
+}
+
+FMI2_Export fmi2Status fmi2SetDebugLogging(fmi2Component c, fmi2Boolean loggingOn, size_t n, const fmi2String cat[])
+{
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Component fmi2Instantiate(fmi2String instanceName, fmi2Type fmuType, fmi2String GUID,
+	fmi2String location, const fmi2CallbackFunctions* functions, fmi2Boolean visible, fmi2Boolean loggingOn)
+{
+	fmu_scalable_sizes_t sizes;
+	component_t* comp;
+	char* name;
+
+	if(!functions || !functions->allocateMemory || !functions->freeMemory || !functions->logger) return 0;
+	if(fmu_scalable_parse_guid(GUID, &sizes)) {
+		functions->logger(functions->componentEnvironment, instanceName, fmi2Error, "error", "Unexpected GUID %s", GUID);
+		return 0;
+	}
+	comp = (component_t*)functions->allocateMemory(1, sizeof(component_t));
+	name = (char*)functions->allocateMemory(strlen(instanceName) + 1, sizeof(char));
+	if(comp) comp->model = fmu_scalable_create(&sizes, functions->allocateMemory, functions->freeMemory);
+	if(!comp || !name || !comp->model) {
+		functions->logger(functions->componentEnvironment, instanceName, fmi2Error, "error", "Out of memory");
+		if(comp) {
+			fmu_scalable_free(comp->model);
+			functions->freeMemory(comp);
+		}
+		functions->freeMemory(name);
+		return 0;
+	}
+	memcpy((void*)&comp->functions, functions, sizeof(fmi2CallbackFunctions));
+	strcpy(name, instanceName);
+	comp->instanceName = name;
+	return comp;
+}
+
+FMI2_Export void fmi2FreeInstance(fmi2Component c)
+{
+	component_t* comp = (component_t*)c;
+	fmi2CallbackFreeMemory release;
+
+	if(!comp) return;
+	release = comp->functions.freeMemory;
+	fmu_scalable_free(comp->model);
+	release((void*)comp->instanceName);
+	release(comp);
+}
+
+FMI2_Export fmi2Status fmi2SetupExperiment(fmi2Component c, fmi2Boolean toleranceDefined, fmi2Real tolerance,
+	fmi2Real startTime, fmi2Boolean stopTimeDefined, fmi2Real stopTime)
+{
+	((component_t*)c)->model->time = startTime;
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2EnterInitializationMode(fmi2Component c)
+{
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2ExitInitializationMode(fmi2Component c)
+{
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2Terminate(fmi2Component c)
+{
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2Reset(fmi2Component c)
+{
+	fmu_scalable_reset(((component_t*)c)->model);
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2GetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Real value[])
+{
+	if(fmu_scalable_get_real(((component_t*)c)->model, vr, nvr, value)) return error(c, "Invalid value reference");
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2GetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[])
+{
+	return no_variables(c, nvr);
+}
+
+FMI2_Export fmi2Status fmi2GetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[])
+{
+	return no_variables(c, nvr);
+}
+
+FMI2_Export fmi2Status fmi2GetString(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2String value[])
+{
+	return no_variables(c, nvr);
+}
+
+FMI2_Export fmi2Status fmi2SetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[])
+{
+	if(fmu_scalable_set_real(((component_t*)c)->model, vr, nvr, value)) return error(c, "Invalid value reference");
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2SetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[])
+{
+	return no_variables(c, nvr);
+}
+
+FMI2_Export fmi2Status fmi2SetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[])
+{
+	return no_variables(c, nvr);
+}
+
+FMI2_Export fmi2Status fmi2SetString(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2String value[])
+{
+	return no_variables(c, nvr);
+}
+
+FMI2_Export fmi2Status fmi2GetFMUstate(fmi2Component c, fmi2FMUstate* FMUstate)
+{
+	component_t* comp = (component_t*)c;
+	fmu_scalable_model_t* state = (fmu_scalable_model_t*)*FMUstate;
+
+	if(!state) {
+		state = fmu_scalable_create(&comp->model->sizes, comp->functions.allocateMemory, comp->functions.freeMemory);
+		if(!state) return error(c, "Out of memory");
+		*FMUstate = state;
+	}
+	fmu_scalable_assign(state, comp->model);
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2SetFMUstate(fmi2Component c, fmi2FMUstate FMUstate)
+{
+	fmu_scalable_assign(((component_t*)c)->model, (fmu_scalable_model_t*)FMUstate);
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2FreeFMUstate(fmi2Component c, fmi2FMUstate* FMUstate)
+{
+	fmu_scalable_free((fmu_scalable_model_t*)*FMUstate);
+	*FMUstate = 0;
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2SerializedFMUstateSize(fmi2Component c, fmi2FMUstate FMUstate, size_t *size)
+{
+	return error(c, "Serialization is not supported");
+}
+
+FMI2_Export fmi2Status fmi2SerializeFMUstate(fmi2Component c, fmi2FMUstate FMUstate, fmi2Byte serializedState[], size_t size)
+{
+	return error(c, "Serialization is not supported");
+}
+
+FMI2_Export fmi2Status fmi2DeSerializeFMUstate(fmi2Component c, const fmi2Byte serializedState[], size_t size, fmi2FMUstate* FMUstate)
+{
+	return error(c, "Serialization is not supported");
+}
+
+FMI2_Export fmi2Status fmi2GetDirectionalDerivative(fmi2Component c, const fmi2ValueReference vUnknown_ref[], size_t nUnknown,
+	const fmi2ValueReference vKnown_ref[], size_t nKnown, const fmi2Real dvKnown[], fmi2Real dvUnknown[])
+{
+	if(fmu_scalable_directional_derivative(((component_t*)c)->model, vUnknown_ref, nUnknown, vKnown_ref, nKnown, dvKnown, dvUnknown))
+		return error(c, "Invalid value reference");
+	return fmi2OK;
+}
+
+/* Model exchange */
+FMI2_Export fmi2Status fmi2EnterEventMode(fmi2Component c)
+{
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2NewDiscreteStates(fmi2Component c, fmi2EventInfo* eventInfo)
+{
+	eventInfo->newDiscreteStatesNeeded = fmi2False;
+	eventInfo->terminateSimulation = fmi2False;
+	eventInfo->nominalsOfContinuousStatesChanged = fmi2False;
+	eventInfo->valuesOfContinuousStatesChanged = fmi2False;
+	eventInfo->nextEventTimeDefined = fmi2False;
+	eventInfo->nextEventTime = 0;
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2EnterContinuousTimeMode(fmi2Component c)
+{
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2CompletedIntegratorStep(fmi2Component c, fmi2Boolean noSetFMUStatePriorToCurrentPoint,
+	fmi2Boolean* enterEventMode, fmi2Boolean* terminateSimulation)
+{
+	*enterEventMode = fmi2False;
+	*terminateSimulation = fmi2False;
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2SetTime(fmi2Component c, fmi2Real time)
+{
+	fmu_scalable_set_time(((component_t*)c)->model, time);
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2SetContinuousStates(fmi2Component c, const fmi2Real x[], size_t nx)
+{
+	component_t* comp = (component_t*)c;
+	if(nx != comp->model->sizes.nx) return error(c, "Wrong number of states");
+	fmu_scalable_set_states(comp->model, x);
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2GetDerivatives(fmi2Component c, fmi2Real derivatives[], size_t nx)
+{
+	component_t* comp = (component_t*)c;
+	if(nx != comp->model->sizes.nx) return error(c, "Wrong number of states");
+	fmu_scalable_get_derivatives(comp->model, derivatives);
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2GetEventIndicators(fmi2Component c, fmi2Real eventIndicators[], size_t ni)
+{
+	component_t* comp = (component_t*)c;
+	if(ni != comp->model->sizes.nz) return error(c, "Wrong number of event indicators");
+	fmu_scalable_get_event_indicators(comp->model, eventIndicators);
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2GetContinuousStates(fmi2Component c, fmi2Real states[], size_t nx)
+{
+	component_t* comp = (component_t*)c;
+	if(nx != comp->model->sizes.nx) return error(c, "Wrong number of states");
+	fmu_scalable_get_states(comp->model, states);
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2GetNominalsOfContinuousStates(fmi2Component c, fmi2Real x_nominal[], size_t nx)
+{
+	size_t i;
+	for(i = 0; i < nx; i++) x_nominal[i] = 1.0;
+	return fmi2OK;
+}
+
+/* Co-simulation */
+FMI2_Export fmi2Status fmi2SetRealInputDerivatives(fmi2Component c, const fmi2ValueReference vr[], size_t nvr,
+	const fmi2Integer order[], const fmi2Real value[])
+{
+	return error(c, "Input derivatives are not supported");
+}
+
+FMI2_Export fmi2Status fmi2GetRealOutputDerivatives(fmi2Component c, const fmi2ValueReference vr[], size_t nvr,
+	const fmi2Integer order[], fmi2Real value[])
+{
+	return error(c, "Output derivatives are not supported");
+}
+
+FMI2_Export fmi2Status fmi2DoStep(fmi2Component c, fmi2Real currentCommunicationPoint,
+	fmi2Real communicationStepSize, fmi2Boolean noSetFMUStatePriorToCurrentPoint)
+{
+	fmu_scalable_do_step(((component_t*)c)->model, communicationStepSize);
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2CancelStep(fmi2Component c)
+{
+	return error(c, "Asynchronous steps are not supported");
+}
+
+FMI2_Export fmi2Status fmi2GetStatus(fmi2Component c, const fmi2StatusKind s, fmi2Status* value)
+{
+	return error(c, "Asynchronous steps are not supported");
+}
+
+FMI2_Export fmi2Status fmi2GetRealStatus(fmi2Component c, const fmi2StatusKind s, fmi2Real* value)
+{
+	if(s != fmi2LastSuccessfulTime) return error(c, "Asynchronous steps are not supported");
+	*value = ((component_t*)c)->model->time;
+	return fmi2OK;
+}
+
+FMI2_Export fmi2Status fmi2GetIntegerStatus(fmi2Component c, const fmi2StatusKind s, fmi2Integer* value)
+{
+	return error(c, "Asynchronous steps are not supported");
+}
+
+FMI2_Export fmi2Status fmi2GetBooleanStatus(fmi2Component c, const fmi2StatusKind s, fmi2Boolean* value)
+{
+	return error(c, "Asynchronous steps are not supported");
+}
+
+FMI2_Export fmi2Status fmi2GetStringStatus(fmi2Component c, const fmi2StatusKind s, fmi2String* value)
+{
+	return error(c, "Asynchronous steps are not supported");
+}
@@ -0,0 +1,287 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/*
+	Generator of scalable test FMUs.
+
+	Usage: fmu_scalable_generator <output.fmu> <fmi1_me|fmi1_cs|fmi2_me|fmi2_cs> <model_identifier> <shared_library> [options]
+		-x N  number of states (10)
+		-z N  number of event indicators (1)
+		-u N  number of inputs (1)
+		-y N  number of outputs (1)
+		-a N  number of alias groups, each with two aliases of a state (1)
+		-b N  number of neighbour states every state derivative depends on (1)
+
+	The shared library must be built from fmu1_scalable_me.c, fmu1_scalable_cs.c or fmu2_scalable.c
+	with the given model identifier. The model description is generated for the sizes and packed
+	together with the library into the FMU.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <JM/jm_callbacks.h>
+#include <JM/jm_portability.h>
+#include <FMI/fmi_zip_zip.h>
+
+#include "fmu_scalable_model.h"
+
+#define KIND_ME 1
+#define KIND_CS 2
+
+static const char* module = "SCALABLE";
+
+static void fail(jm_callbacks* cb, const char* message)
+{
+	jm_log_fatal(cb, module, "%s", message);
+	exit(1);
+}
+
+/* Write the dependencies of der(x[i]) as 1-based indices into the model variables */
+static void write_derivative_dependencies(FILE* f, const fmu_scalable_sizes_t* s, size_t i, size_t* deps)
+{
+	size_t k, n = fmu_scalable_derivative_dependencies(s, i, deps);
+
+	for(k = 0; k < n; k++) fprintf(f, "%s%u", k ? " " : "", (unsigned)(deps[k] + 1));
+	if(s->nu) fprintf(f, " %u", (unsigned)(2 * s->nx + i % s->nu + 1));
+}
+
+static void write_fmi2_derivatives(FILE* f, const fmu_scalable_sizes_t* s, size_t* deps)
+{
+	size_t i;
+
+	for(i = 0; i < s->nx; i++) {
+		fprintf(f, "      <Unknown index=\"%u\" dependencies=\"", (unsigned)(s->nx + i + 1));
+		write_derivative_dependencies(f, s, i, deps);
+		fprintf(f, "\"/>\n");
+	}
+}
+
+static void write_fmi2_outputs(FILE* f, const fmu_scalable_sizes_t* s)
+{
+	size_t i;
+
+	for(i = 0; i < s->ny; i++) {
+		fprintf(f, "      <Unknown index=\"%u\" dependencies=\"%u\"/>\n", (unsigned)(2 * s->nx + s->nu + i + 1), (unsigned)(i % s->nx + 1));
+	}
+}
+
+static int write_xml(const char* fileName, int fmi1, int kind, const char* modelIdentifier, const fmu_scalable_sizes_t* s)
+{
+	FILE* f = fopen(fileName, "w");
+	char guid[128];
+	size_t i, *deps;
+
+	if(!f) return -1;
+	deps = (size_t*)malloc((s->bw + 1) * sizeof(size_t));
+	if(!deps) {
+		fclose(f);
+		return -1;
+	}
+	fmu_scalable_format_guid(s, guid);
+
+	fprintf(f, "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+	if(fmi1) {
+		fprintf(f, "<fmiModelDescription fmiVersion=\"1.0\" modelName=\"Scalable\" modelIdentifier=\"%s\" guid=\"%s\"\n"
+			"  generationTool=\"fmu_scalable_generator\" numberOfContinuousStates=\"%u\" numberOfEventIndicators=\"%u\">\n",
+			modelIdentifier, guid, (unsigned)s->nx, (unsigned)s->nz);
+	}
+	else {
+		fprintf(f, "<fmiModelDescription fmiVersion=\"2.0\" modelName=\"Scalable\" guid=\"%s\"\n"
+			"  generationTool=\"fmu_scalable_generator\" numberOfEventIndicators=\"%u\">\n", guid, (unsigned)s->nz);
+		if(kind == KIND_ME)
+			fprintf(f, "  <ModelExchange modelIdentifier=\"%s\" canGetAndSetFMUstate=\"true\" providesDirectionalDerivative=\"true\"/>\n",
+				modelIdentifier);
+		else
+			fprintf(f, "  <CoSimulation modelIdentifier=\"%s\" canHandleVariableCommunicationStepSize=\"true\"\n"
+				"    canGetAndSetFMUstate=\"true\" providesDirectionalDerivative=\"true\"/>\n", modelIdentifier);
+	}
+
+	fprintf(f, "  <ModelVariables>\n");
+	for(i = 0; i < s->nx; i++) {
+		fprintf(f, "    <ScalarVariable name=\"x[%u]\" valueReference=\"%u\" description=\"State %u\"%s>\n"
+			"      <Real start=\"1.0\"%s/>\n    </ScalarVariable>\n",
+			(unsigned)(i + 1), (unsigned)FMU_SCALABLE_VR_X(s, i), (unsigned)(i + 1),
+			fmi1 ? "" : " initial=\"exact\"", fmi1 ? " fixed=\"true\"" : "");
+	}
+	for(i = 0; i < s->nx; i++) {
+		fprintf(f, "    <ScalarVariable name=\"der(x[%u])\" valueReference=\"%u\">\n", (unsigned)(i + 1), (unsigned)FMU_SCALABLE_VR_DER(s, i));
+		if(fmi1) fprintf(f, "      <Real/>\n");
+		else fprintf(f, "      <Real derivative=\"%u\"/>\n", (unsigned)(i + 1));
+		fprintf(f, "    </ScalarVariable>\n");
+	}
+	for(i = 0; i < s->nu; i++) {
+		fprintf(f, "    <ScalarVariable name=\"u[%u]\" valueReference=\"%u\" causality=\"input\">\n"
+			"      <Real start=\"0.0\"/>\n    </ScalarVariable>\n", (unsigned)(i + 1), (unsigned)FMU_SCALABLE_VR_U(s, i));
+	}
+	for(i = 0; i < s->ny; i++) {
+		fprintf(f, "    <ScalarVariable name=\"y[%u]\" valueReference=\"%u\" causality=\"output\">\n"
+			"      <Real/>\n%s    </ScalarVariable>\n", (unsigned)(i + 1), (unsigned)FMU_SCALABLE_VR_Y(s, i),
+			fmi1 ? "      <DirectDependency/>\n" : "");
+	}
+	for(i = 0; i < s->na; i++) {
+		unsigned vr = (unsigned)FMU_SCALABLE_VR_X(s, i % s->nx);
+		fprintf(f, "    <ScalarVariable name=\"alias[%u].a\" valueReference=\"%u\"%s>\n"
+			"      <Real/>\n    </ScalarVariable>\n", (unsigned)(i + 1), vr, fmi1 ? " alias=\"alias\"" : "");
+		fprintf(f, "    <ScalarVariable name=\"alias[%u].b\" valueReference=\"%u\"%s>\n"
+			"      <Real/>\n    </ScalarVariable>\n", (unsigned)(i + 1), vr, fmi1 ? " alias=\"negatedAlias\"" : "");
+	}
+	fprintf(f, "  </ModelVariables>\n");
+
+	if(fmi1) {
+		if(kind == KIND_CS) {
+			fprintf(f, "  <Implementation>\n    <CoSimulation_StandAlone>\n"
+				"      <Capabilities canHandleVariableCommunicationStepSize=\"true\"/>\n"
+				"    </CoSimulation_StandAlone>\n  </Implementation>\n");
+		}
+	}
+	else {
+		fprintf(f, "  <ModelStructure>\n");
+		if(s->ny) {
+			fprintf(f, "    <Outputs>\n");
+			write_fmi2_outputs(f, s);
+			fprintf(f, "    </Outputs>\n");
+		}
+		fprintf(f, "    <Derivatives>\n");
+		write_fmi2_derivatives(f, s, deps);
+		fprintf(f, "    </Derivatives>\n    <InitialUnknowns>\n");
+		write_fmi2_derivatives(f, s, deps);
+		write_fmi2_outputs(f, s);
+		fprintf(f, "    </InitialUnknowns>\n  </ModelStructure>\n");
+	}
+	fprintf(f, "</fmiModelDescription>\n");
+	free(deps);
+
+	if(ferror(f)) {
+		fclose(f);
+		return -1;
+	}
+	return fclose(f) == 0 ? 0 : -1;
+}
+
+static int copy_file(const char* from, const char* to)
+{
+	char buf[65536];
+	FILE* in = fopen(from, "rb");
+	FILE* out = in ? fopen(to, "wb") : 0;
+	size_t n;
+	int ret = 0;
+
+	if(!out) {
+		if(in) fclose(in);
+		return -1;
+	}
+	while((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+		if(fwrite(buf, 1, n, out) != n) ret = -1;
+	}
+	if(ferror(in)) ret = -1;
+	fclose(in);
+	if(fclose(out) != 0) ret = -1;
+	return ret;
+}
+
+static int is_absolute_path(const char* path)
+{
+#ifdef WIN32
+	return path[0] == '\\' || path[0] == '/' || (path[0] && path[1] == ':');
+#else
+	return path[0] == '/';
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+	jm_callbacks* cb = jm_get_default_callbacks();
+	fmu_scalable_sizes_t sizes;
+	const char *output, *version, *modelIdentifier, *library;
+	char cwd[FILENAME_MAX], fmuPath[FILENAME_MAX], path[FILENAME_MAX], binary[FILENAME_MAX];
+	const char* files[2];
+	char* stage;
+	int fmi1, kind, i;
+	jm_status_enu_t status;
+
+	if(argc < 5) {
+		printf("Usage: %s <output.fmu> <fmi1_me|fmi1_cs|fmi2_me|fmi2_cs> <model_identifier> <shared_library>"
+			" [-x states] [-z event_indicators] [-u inputs] [-y outputs] [-a alias_groups] [-b bandwidth] [-s stiffness]\n", argv[0]);
+		return 1;
+	}
+	output = argv[1];
+	version = argv[2];
+	modelIdentifier = argv[3];
+	library = argv[4];
+
+	if(strcmp(version, "fmi1_me") && strcmp(version, "fmi1_cs") && strcmp(version, "fmi2_me") && strcmp(version, "fmi2_cs"))
+		fail(cb, "The FMU type must be one of fmi1_me, fmi1_cs, fmi2_me and fmi2_cs");
+	fmi1 = (version[3] == '1');
+	kind = strcmp(version + 5, "me") ? KIND_CS : KIND_ME;
+
+	sizes.nx = 10;
+	sizes.nz = 1;
+	sizes.nu = 1;
+	sizes.ny = 1;
+	sizes.na = 1;
+	sizes.bw = 1;
+	sizes.st = 0;
+	for(i = 5; i + 1 < argc; i += 2) {
+		size_t value = (size_t)atol(argv[i + 1]);
+		if(!strcmp(argv[i], "-x")) sizes.nx = value;
+		else if(!strcmp(argv[i], "-z")) sizes.nz = value;
+		else if(!strcmp(argv[i], "-u")) sizes.nu = value;
+		else if(!strcmp(argv[i], "-y")) sizes.ny = value;
+		else if(!strcmp(argv[i], "-a")) sizes.na = value;
+		else if(!strcmp(argv[i], "-b")) sizes.bw = value;
+		else if(!strcmp(argv[i], "-s")) sizes.st = value;
+		else fail(cb, "Unknown option");
+	}
+	if(i < argc) fail(cb, "Missing option value");
+	if(sizes.nx < 1) fail(cb, "The model must have at least one state");
+	if(sizes.bw >= sizes.nx) sizes.bw = sizes.nx - 1;
+
+	if(jm_portability_get_current_working_directory(cwd, sizeof(cwd)) != jm_status_success)
+		fail(cb, "Could not get the current directory");
+	if(is_absolute_path(output)) jm_snprintf(fmuPath, sizeof(fmuPath), "%s", output);
+	else jm_snprintf(fmuPath, sizeof(fmuPath), "%s%s%s", cwd, FMI_FILE_SEP, output);
+
+	stage = jm_mk_temp_dir(cb, 0, "fmu_scalable");
+	if(!stage) fail(cb, "Could not create a temporary directory");
+
+	jm_snprintf(path, sizeof(path), "%s%s%s", stage, FMI_FILE_SEP, "modelDescription.xml");
+	if(write_xml(path, fmi1, kind, modelIdentifier, &sizes)) fail(cb, "Could not write the model description");
+
+	jm_snprintf(path, sizeof(path), "%s%s%s", stage, FMI_FILE_SEP, FMI_BINARIES);
+	if(jm_mkdir(cb, path) != jm_status_success) fail(cb, "Could not create the binaries directory");
+	jm_snprintf(path, sizeof(path), "%s%s%s%s%s", stage, FMI_FILE_SEP, FMI_BINARIES, FMI_FILE_SEP, FMI_PLATFORM);
+	if(jm_mkdir(cb, path) != jm_status_success) fail(cb, "Could not create the binaries directory");
+	jm_snprintf(binary, sizeof(binary), "%s%s%s%s%s%s", FMI_BINARIES, FMI_FILE_SEP, FMI_PLATFORM, FMI_FILE_SEP, modelIdentifier, FMI_DLL_EXT);
+	jm_snprintf(path, sizeof(path), "%s%s%s", stage, FMI_FILE_SEP, binary);
+	if(copy_file(library, path)) fail(cb, "Could not copy the shared library");
+
+	/* The files are stored with the path relative to the working directory */
+	if(jm_portability_set_current_working_directory(stage) != jm_status_success)
+		fail(cb, "Could not change to the temporary directory");
+	files[0] = "modelDescription.xml";
+	files[1] = binary;
+	remove(fmuPath);
+	status = fmi_zip_zip(fmuPath, 2, files, cb);
+	jm_portability_set_current_working_directory(cwd);
+	jm_rmdir(cb, stage);
+	cb->free(stage);
+	if(status != jm_status_success) fail(cb, "Could not compress the FMU");
+
+	printf("Generated %s with %u states, %u event indicators, %u inputs, %u outputs and %u alias groups\n",
+		output, (unsigned)sizes.nx, (unsigned)sizes.nz, (unsigned)sizes.nu, (unsigned)sizes.ny, (unsigned)sizes.na);
+	return 0;
+}
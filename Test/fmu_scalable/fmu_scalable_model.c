@@ -0,0 +1,227 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "fmu_scalable_model.h"
+
+#define COUPLING 0.01
+#define THRESHOLD 0.5
+
+void fmu_scalable_format_guid(const fmu_scalable_sizes_t* s, char* buf) {
+	sprintf(buf, FMU_SCALABLE_GUID_FORMAT, (unsigned)s->nx, (unsigned)s->nz, (unsigned)s->nu,
+		(unsigned)s->ny, (unsigned)s->na, (unsigned)s->bw, (unsigned)s->st);
+}
+
+int fmu_scalable_parse_guid(const char* guid, fmu_scalable_sizes_t* s) {
+	unsigned nx, nz, nu, ny, na, bw, st;
+
+	if(!guid || sscanf(guid, FMU_SCALABLE_GUID_FORMAT, &nx, &nz, &nu, &ny, &na, &bw, &st) != 7 || nx == 0) return -1;
+	s->nx = nx;
+	s->nz = nz;
+	s->nu = nu;
+	s->ny = ny;
+	s->na = na;
+	s->bw = bw;
+	s->st = st;
+	return 0;
+}
+
+size_t fmu_scalable_derivative_dependencies(const fmu_scalable_sizes_t* s, size_t i, size_t* deps) {
+	size_t j, k, n = 0, pos;
+	size_t bw = (s->bw < s->nx) ? s->bw : s->nx - 1;
+
+	/* The states i ... i + bw wrapped around, in increasing order */
+	for(j = 0; j <= bw; j++) {
+		size_t x = (i + j) % s->nx;
+		for(pos = n; pos > 0 && deps[pos - 1] > x; pos--);
+		for(k = n; k > pos; k--) deps[k] = deps[k - 1];
+		deps[pos] = x;
+		n++;
+	}
+	return n;
+}
+
+fmu_scalable_model_t* fmu_scalable_create(const fmu_scalable_sizes_t* sizes, fmu_scalable_calloc_ft allocate, fmu_scalable_free_ft release) {
+	fmu_scalable_model_t* m = (fmu_scalable_model_t*)allocate(1, sizeof(fmu_scalable_model_t));
+
+	if(!m) return 0;
+	m->sizes = *sizes;
+	m->calloc = allocate;
+	m->free = release;
+	m->r = (double*)allocate(FMU_SCALABLE_NUM_VR(sizes), sizeof(double));
+	if(!m->r) {
+		release(m);
+		return 0;
+	}
+	fmu_scalable_reset(m);
+	return m;
+}
+
+void fmu_scalable_free(fmu_scalable_model_t* m) {
+	if(!m) return;
+	m->free(m->r);
+	m->free(m);
+}
+
+void fmu_scalable_reset(fmu_scalable_model_t* m) {
+	size_t i;
+
+	m->time = 0;
+	memset(m->r, 0, FMU_SCALABLE_NUM_VR(&m->sizes) * sizeof(double));
+	for(i = 0; i < m->sizes.nx; i++) m->r[FMU_SCALABLE_VR_X(&m->sizes, i)] = 1.0;
+	m->dirty = 1;
+}
+
+void fmu_scalable_assign(fmu_scalable_model_t* dst, const fmu_scalable_model_t* src) {
+	dst->time = src->time;
+	memcpy(dst->r, src->r, FMU_SCALABLE_NUM_VR(&src->sizes) * sizeof(double));
+	dst->dirty = 1;
+}
+
+double fmu_scalable_stiff_solution(double t) {
+	return 2.0 + sin(t);
+}
+
+static void fmu_scalable_update(fmu_scalable_model_t* m) {
+	const fmu_scalable_sizes_t* s = &m->sizes;
+	const double* x = m->r;
+	double p, dp;
+	size_t i, j;
+
+	if(!m->dirty) return;
+	p = fmu_scalable_stiff_solution(m->time);
+	dp = cos(m->time);
+	for(i = 0; i < s->nx; i++) {
+		double der;
+		if(s->st) {
+			der = dp - (double)s->st * (x[i] * x[i] * x[i] - p * p * p);
+			for(j = 1; j <= s->bw; j++) der += COUPLING * (x[(i + j) % s->nx] - x[i]);
+		}
+		else {
+			der = -x[i];
+			for(j = 1; j <= s->bw; j++) der += COUPLING * x[(i + j) % s->nx];
+		}
+		if(s->nu) der += m->r[FMU_SCALABLE_VR_U(s, i % s->nu)];
+		m->r[FMU_SCALABLE_VR_DER(s, i)] = der;
+	}
+	for(i = 0; i < s->ny; i++) m->r[FMU_SCALABLE_VR_Y(s, i)] = x[i % s->nx];
+	m->dirty = 0;
+}
+
+int fmu_scalable_get_real(fmu_scalable_model_t* m, const unsigned int vr[], size_t nvr, double value[]) {
+	size_t k, n = FMU_SCALABLE_NUM_VR(&m->sizes);
+
+	fmu_scalable_update(m);
+	for(k = 0; k < nvr; k++) {
+		if(vr[k] >= n) return -1;
+		value[k] = m->r[vr[k]];
+	}
+	return 0;
+}
+
+int fmu_scalable_set_real(fmu_scalable_model_t* m, const unsigned int vr[], size_t nvr, const double value[]) {
+	const fmu_scalable_sizes_t* s = &m->sizes;
+	size_t k;
+
+	for(k = 0; k < nvr; k++) {
+		int isState = vr[k] < s->nx;
+		int isInput = vr[k] >= FMU_SCALABLE_VR_U(s, 0) && vr[k] < FMU_SCALABLE_VR_Y(s, 0);
+		if(!isState && !isInput) return -1;
+		m->r[vr[k]] = value[k];
+	}
+	m->dirty = 1;
+	return 0;
+}
+
+void fmu_scalable_set_time(fmu_scalable_model_t* m, double t) {
+	m->time = t;
+	m->dirty = 1;
+}
+
+void fmu_scalable_get_states(fmu_scalable_model_t* m, double x[]) {
+	memcpy(x, m->r, m->sizes.nx * sizeof(double));
+}
+
+void fmu_scalable_set_states(fmu_scalable_model_t* m, const double x[]) {
+	memcpy(m->r, x, m->sizes.nx * sizeof(double));
+	m->dirty = 1;
+}
+
+void fmu_scalable_get_derivatives(fmu_scalable_model_t* m, double der[]) {
+	fmu_scalable_update(m);
+	memcpy(der, m->r + FMU_SCALABLE_VR_DER(&m->sizes, 0), m->sizes.nx * sizeof(double));
+}
+
+void fmu_scalable_get_event_indicators(fmu_scalable_model_t* m, double z[]) {
+	size_t k;
+	for(k = 0; k < m->sizes.nz; k++) z[k] = m->r[k % m->sizes.nx] - THRESHOLD;
+}
+
+void fmu_scalable_do_step(fmu_scalable_model_t* m, double h) {
+	size_t i;
+
+	fmu_scalable_update(m);
+	for(i = 0; i < m->sizes.nx; i++) m->r[i] += h * m->r[FMU_SCALABLE_VR_DER(&m->sizes, i)];
+	m->time += h;
+	m->dirty = 1;
+}
+
+/* Partial derivative of the unknown with respect to the known, or -1 if the known is not a state or input */
+static int fmu_scalable_partial(fmu_scalable_model_t* m, size_t unknown, size_t known, double* d) {
+	const fmu_scalable_sizes_t* s = &m->sizes;
+	size_t i, j;
+
+	*d = 0;
+	if(unknown >= FMU_SCALABLE_VR_DER(s, 0) && unknown < FMU_SCALABLE_VR_U(s, 0)) {
+		i = unknown - FMU_SCALABLE_VR_DER(s, 0);
+		if(known < s->nx) {
+			if(known == i) *d -= s->st ? 3.0 * (double)s->st * m->r[i] * m->r[i] + COUPLING * (double)s->bw : 1.0;
+			for(j = 1; j <= s->bw; j++) {
+				if((i + j) % s->nx == known) *d += COUPLING;
+			}
+		}
+		else if(known >= FMU_SCALABLE_VR_U(s, 0) && known < FMU_SCALABLE_VR_Y(s, 0)) {
+			if(i % s->nu == known - FMU_SCALABLE_VR_U(s, 0)) *d = 1.0;
+		}
+		else return -1;
+	}
+	else if(unknown >= FMU_SCALABLE_VR_Y(s, 0) && unknown < FMU_SCALABLE_NUM_VR(s)) {
+		i = unknown - FMU_SCALABLE_VR_Y(s, 0);
+		if(known < s->nx) {
+			if(i % s->nx == known) *d = 1.0;
+		}
+		else if(known < FMU_SCALABLE_VR_U(s, 0) || known >= FMU_SCALABLE_VR_Y(s, 0)) return -1;
+	}
+	else return -1;
+	return 0;
+}
+
+int fmu_scalable_directional_derivative(fmu_scalable_model_t* m, const unsigned int unknown[], size_t nUnknown,
+										const unsigned int known[], size_t nKnown, const double dvKnown[], double dvUnknown[]) {
+	size_t k, j;
+	double d;
+
+	for(k = 0; k < nUnknown; k++) {
+		dvUnknown[k] = 0;
+		for(j = 0; j < nKnown; j++) {
+			if(fmu_scalable_partial(m, unknown[k], known[j], &d)) return -1;
+			dvUnknown[k] += d * dvKnown[j];
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,115 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef FMU_SCALABLE_MODEL_H_
+#define FMU_SCALABLE_MODEL_H_
+
+#include <stddef.h>
+
+/*
+	Scalable test model shared by the FMI 1.0 and FMI 2.0 test FMUs.
+
+	The model has nx states, nu inputs, ny outputs and nz event indicators:
+		der(x[i]) = -x[i] + 0.01 * (x[i+1] + ... + x[i+b]) + u[i mod nu]
+		y[k]      = x[k mod nx]
+		z[k]      = x[k mod nx] - 0.5
+	where the state indices wrap around. The start values are x = 1 and u = 0.
+	The bandwidth b gives the sparsity of the state derivative dependencies.
+
+	With a stiffness s > 0 the derivatives are instead
+		der(x[i]) = p'(t) - s * (x[i]^3 - p(t)^3) + 0.01 * ((x[i+1] - x[i]) + ... + (x[i+b] - x[i])) + u[i mod nu]
+	with p(t) = 2 + sin(t). With u = 0 all states approach x = p(t) quickly and then follow it exactly,
+	which gives a stiff nonlinear test problem with a known solution.
+
+	The sizes are encoded in the GUID so that one binary serves model descriptions of any size.
+	All variables are Real and the value references are
+		x: 0 ... nx-1, der(x): nx ... 2nx-1, u: 2nx ... 2nx+nu-1, y: 2nx+nu ... 2nx+nu+ny-1.
+	Alias variables refer to the states and do not change the model.
+*/
+
+#define FMU_SCALABLE_GUID_FORMAT "{scalable-x%u-z%u-u%u-y%u-a%u-b%u-s%u}"
+
+#define FMU_SCALABLE_VR_X(s, i)   (i)
+#define FMU_SCALABLE_VR_DER(s, i) ((s)->nx + (i))
+#define FMU_SCALABLE_VR_U(s, k)   (2 * (s)->nx + (k))
+#define FMU_SCALABLE_VR_Y(s, k)   (2 * (s)->nx + (s)->nu + (k))
+#define FMU_SCALABLE_NUM_VR(s)    (2 * (s)->nx + (s)->nu + (s)->ny)
+
+typedef struct fmu_scalable_sizes_t {
+	size_t nx; /* states */
+	size_t nz; /* event indicators */
+	size_t nu; /* inputs */
+	size_t ny; /* outputs */
+	size_t na; /* alias groups */
+	size_t bw; /* bandwidth of the derivative dependencies */
+	size_t st; /* stiffness, 0 for the linear model */
+} fmu_scalable_sizes_t;
+
+typedef void* (*fmu_scalable_calloc_ft)(size_t nobj, size_t size);
+typedef void (*fmu_scalable_free_ft)(void* obj);
+
+typedef struct fmu_scalable_model_t {
+	fmu_scalable_sizes_t sizes;
+	fmu_scalable_calloc_ft calloc;
+	fmu_scalable_free_ft free;
+	double time;
+	int dirty;	/* derivatives and outputs must be recomputed */
+	double* r;	/* all Real variables indexed by value reference */
+} fmu_scalable_model_t;
+
+/* Write the GUID of a model into buf (at least 128 bytes) */
+void fmu_scalable_format_guid(const fmu_scalable_sizes_t* sizes, char* buf);
+
+/* Parse a GUID written by fmu_scalable_format_guid(). Returns 0 on success. */
+int fmu_scalable_parse_guid(const char* guid, fmu_scalable_sizes_t* sizes);
+
+/* Dependencies of der(x[i]) as sorted, unique state indices. Returns the number written into deps (at most bw + 1). */
+size_t fmu_scalable_derivative_dependencies(const fmu_scalable_sizes_t* sizes, size_t i, size_t* deps);
+
+/* Allocate a model with start values. Returns NULL on failure. */
+fmu_scalable_model_t* fmu_scalable_create(const fmu_scalable_sizes_t* sizes, fmu_scalable_calloc_ft allocate, fmu_scalable_free_ft release);
+
+void fmu_scalable_free(fmu_scalable_model_t* m);
+
+/* Restore the start values */
+void fmu_scalable_reset(fmu_scalable_model_t* m);
+
+/* Solution of the stiff model, p(t) above */
+double fmu_scalable_stiff_solution(double t);
+
+/* Copy time and variables of src into dst of the same size */
+void fmu_scalable_assign(fmu_scalable_model_t* dst, const fmu_scalable_model_t* src);
+
+/* Access by value reference. Return 0 on success and -1 for unknown or (on set) calculated variables. */
+int fmu_scalable_get_real(fmu_scalable_model_t* m, const unsigned int vr[], size_t nvr, double value[]);
+int fmu_scalable_set_real(fmu_scalable_model_t* m, const unsigned int vr[], size_t nvr, const double value[]);
+
+void fmu_scalable_set_time(fmu_scalable_model_t* m, double t);
+void fmu_scalable_get_states(fmu_scalable_model_t* m, double x[]);
+void fmu_scalable_set_states(fmu_scalable_model_t* m, const double x[]);
+void fmu_scalable_get_derivatives(fmu_scalable_model_t* m, double der[]);
+void fmu_scalable_get_event_indicators(fmu_scalable_model_t* m, double z[]);
+
+/* Explicit Euler step of size h */
+void fmu_scalable_do_step(fmu_scalable_model_t* m, double h);
+
+/*
+	Directional derivative of the derivatives and outputs (unknowns) with respect to
+	states and inputs (knowns). Returns -1 for value references of other variables.
+*/
+int fmu_scalable_directional_derivative(fmu_scalable_model_t* m, const unsigned int unknown[], size_t nUnknown,
+										const unsigned int known[], size_t nKnown, const double dvKnown[], double dvUnknown[]);
+
+#endif /* FMU_SCALABLE_MODEL_H_ */
@@ -22,6 +22,7 @@
 #include <FMI1/fmi1_enums.h>
 #include <JM/jm_portability.h>
 #include <JM/jm_callbacks.h>
+#include <JM/jm_call_statistics.h>
 
 typedef struct fmi1_capi_t fmi1_capi_t;
 
@@ -111,6 +112,20 @@ void fmi1_capi_set_debug_mode(fmi1_capi_t* fmu, int mode);
  * @param fmu C-API struct that has succesfully loaded the FMI function. */
 int fmi1_capi_get_debug_mode(fmi1_capi_t* fmu);
 
+/**
+ * \brief Get the timing statistics of the calls of an FMI function
+ * 
+ * @param fmu C-API struct that has succesfully loaded the FMI function.
+ * @param f The FMI function.
+ * @return The statistics or NULL if the library is compiled without FMILIB_ENABLE_CALL_STATISTICS. */
+const jm_call_statistics_t* fmi1_capi_get_call_statistics(fmi1_capi_t* fmu, fmi1_function_enu_t f);
+
+/**
+ * \brief Clear the timing statistics of the calls of all the FMI functions
+ * 
+ * @param fmu C-API struct that has succesfully loaded the FMI function. */
+void fmi1_capi_reset_call_statistics(fmi1_capi_t* fmu);
+
 
 /**@} */
 
@@ -22,6 +22,7 @@
 #include <FMI2/fmi2_enums.h>
 #include <JM/jm_portability.h>
 #include <JM/jm_callbacks.h>
+#include <JM/jm_call_statistics.h>
 
 typedef struct fmi2_capi_t fmi2_capi_t;
 
@@ -112,6 +113,20 @@ void fmi2_capi_set_debug_mode(fmi2_capi_t* fmu, int mode);
  * @param fmu C-API struct that has succesfully loaded the FMI function. */
 int fmi2_capi_get_debug_mode(fmi2_capi_t* fmu);
 
+/**
+ * \brief Get the timing statistics of the calls of an FMI function
+ * 
+ * @param fmu C-API struct that has succesfully loaded the FMI function.
+ * @param f The FMI function.
+ * @return The statistics or NULL if the library is compiled without FMILIB_ENABLE_CALL_STATISTICS. */
+const jm_call_statistics_t* fmi2_capi_get_call_statistics(fmi2_capi_t* fmu, fmi2_function_enu_t f);
+
+/**
+ * \brief Clear the timing statistics of the calls of all the FMI functions
+ * 
+ * @param fmu C-API struct that has succesfully loaded the FMI function. */
+void fmi2_capi_reset_call_statistics(fmi2_capi_t* fmu);
+
 /**
  * \brief Get the FMU kind loaded by the CAPI
  * 
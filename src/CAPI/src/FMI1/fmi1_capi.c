@@ -205,22 +205,28 @@ fmi1_capi_t* fmi1_capi_create_dllfmu(jm_callbacks* cb, const char* dllPath, cons
 
 jm_status_enu_t fmi1_capi_load_fcn(fmi1_capi_t* fmu)
 {
+	jm_status_enu_t status;
 	assert(fmu);
+	jm_trace_begin("fmilib", "Load FMI functions");
 	/* Load ME functions */
 	if (fmu->standard == fmi1_fmu_kind_enu_me) {
-		return fmi1_capi_load_me_fcn(fmu);
+		status = fmi1_capi_load_me_fcn(fmu);
 	/* Load CS functions */
 	} else if (fmu->standard == fmi1_fmu_kind_enu_cs_standalone || fmu->standard == fmi1_fmu_kind_enu_cs_tool) {
-		return fmi1_capi_load_cs_fcn(fmu);
+		status = fmi1_capi_load_cs_fcn(fmu);
 	} else {
-		return jm_status_error;
+		status = jm_status_error;
 	}
+	jm_trace_end("fmilib", "Load FMI functions");
+	return status;
 }
 
 jm_status_enu_t fmi1_capi_load_dll(fmi1_capi_t* fmu)
 {
 	assert(fmu && fmu->dllPath);
+	jm_trace_begin("fmilib", "Load shared library");
 	fmu->dllHandle = jm_portability_load_dll_handle(fmu->dllPath); /* Load the shared library */
+	jm_trace_end("fmilib", "Load shared library");
 	if (fmu->dllHandle == NULL) {
 		jm_log_fatal(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Could not load the DLL: %s", jm_portability_get_last_dll_error());
 		return jm_status_error;
@@ -240,6 +246,19 @@ int fmi1_capi_get_debug_mode(fmi1_capi_t* fmu) {
 	return 0;
 }
 
+const jm_call_statistics_t* fmi1_capi_get_call_statistics(fmi1_capi_t* fmu, fmi1_function_enu_t f) {
+#ifdef FMILIB_ENABLE_CALL_STATISTICS
+	if(fmu && (int)f >= 0 && f < fmi1_functions_Num) return &fmu->callStatistics[f];
+#endif
+	return 0;
+}
+
+void fmi1_capi_reset_call_statistics(fmi1_capi_t* fmu) {
+#ifdef FMILIB_ENABLE_CALL_STATISTICS
+	if(fmu) memset(fmu->callStatistics, 0, sizeof(fmu->callStatistics));
+#endif
+}
+
 jm_status_enu_t fmi1_capi_free_dll(fmi1_capi_t* fmu)
 {
 	if (fmu == NULL) {		
@@ -274,32 +293,38 @@ const char* fmi1_capi_get_version(fmi1_capi_t* fmu)
 
 fmi1_status_t fmi1_capi_set_debug_logging(fmi1_capi_t* fmu, fmi1_boolean_t loggingOn)
 {
-	return fmu->fmiSetDebugLogging(fmu->c, loggingOn);
+	fmi1_status_t status;
+	FMI1_CAPI_TIMED_CALL(fmu, SetDebugLogging, status = fmu->fmiSetDebugLogging(fmu->c, loggingOn));
+	return status;
 }
 
 /* fmiSet* functions */
 #define FMISETX(FNAME1, FNAME2, FTYPE) \
 fmi1_status_t FNAME1(fmi1_capi_t* fmu, const fmi1_value_reference_t vr[], size_t nvr, const FTYPE value[])	\
 { \
-	return fmu->FNAME2(fmu->c, vr, nvr, value); \
+	fmi1_status_t status; \
+	FMI1_CAPI_TIMED_CALL(fmu, FNAME2, status = fmu->fmi ## FNAME2(fmu->c, vr, nvr, value)); \
+	return status; \
 }
 
 /* fmiGet* functions */
 #define FMIGETX(FNAME1, FNAME2, FTYPE) \
 fmi1_status_t FNAME1(fmi1_capi_t* fmu, const fmi1_value_reference_t vr[], size_t nvr, FTYPE value[]) \
 { \
-	return fmu->FNAME2(fmu->c, vr, nvr, value); \
+	fmi1_status_t status; \
+	FMI1_CAPI_TIMED_CALL(fmu, FNAME2, status = fmu->fmi ## FNAME2(fmu->c, vr, nvr, value)); \
+	return status; \
 }
 
-FMISETX(fmi1_capi_set_real,		fmiSetReal,		fmi1_real_t)
-FMISETX(fmi1_capi_set_integer,	fmiSetInteger,	fmi1_integer_t)
-FMISETX(fmi1_capi_set_boolean,	fmiSetBoolean,	fmi1_boolean_t)
-FMISETX(fmi1_capi_set_string,	fmiSetString,	fmi1_string_t)
+FMISETX(fmi1_capi_set_real,		SetReal,		fmi1_real_t)
+FMISETX(fmi1_capi_set_integer,	SetInteger,	fmi1_integer_t)
+FMISETX(fmi1_capi_set_boolean,	SetBoolean,	fmi1_boolean_t)
+FMISETX(fmi1_capi_set_string,	SetString,	fmi1_string_t)
 
-FMIGETX(fmi1_capi_get_real,	fmiGetReal,		fmi1_real_t)
-FMIGETX(fmi1_capi_get_integer,	fmiGetInteger,	fmi1_integer_t)
-FMIGETX(fmi1_capi_get_boolean,	fmiGetBoolean,	fmi1_boolean_t)
-FMIGETX(fmi1_capi_get_string,	fmiGetString,	fmi1_string_t)
+FMIGETX(fmi1_capi_get_real,	GetReal,		fmi1_real_t)
+FMIGETX(fmi1_capi_get_integer,	GetInteger,	fmi1_integer_t)
+FMIGETX(fmi1_capi_get_boolean,	GetBoolean,	fmi1_boolean_t)
+FMIGETX(fmi1_capi_get_string,	GetString,	fmi1_string_t)
 
 #ifdef __cplusplus
 }
@@ -22,20 +22,23 @@ extern "C" {
 
 fmi1_component_t fmi1_capi_instantiate_slave(fmi1_capi_t* fmu, fmi1_string_t instanceName, fmi1_string_t fmuGUID, fmi1_string_t fmuLocation, fmi1_string_t mimeType, fmi1_real_t timeout, fmi1_boolean_t visible, fmi1_boolean_t interactive, fmi1_boolean_t loggingOn)
 {
-	return fmu->c = fmu->fmiInstantiateSlave(instanceName, fmuGUID, fmuLocation, mimeType, timeout, visible, interactive, fmu->callBackFunctions, loggingOn);
+	FMI1_CAPI_TIMED_CALL(fmu, InstantiateSlave, fmu->c = fmu->fmiInstantiateSlave(instanceName, fmuGUID, fmuLocation, mimeType, timeout, visible, interactive, fmu->callBackFunctions, loggingOn));
+	return fmu->c;
 }
 
 void fmi1_capi_free_slave_instance(fmi1_capi_t* fmu)
 {
 	if(fmu->c) {
-		fmu->fmiFreeSlaveInstance(fmu->c);
+		FMI1_CAPI_TIMED_CALL(fmu, FreeSlaveInstance, fmu->fmiFreeSlaveInstance(fmu->c));
 		fmu->c = 0;
 	}
 }
 
 fmi1_status_t fmi1_capi_initialize_slave(fmi1_capi_t* fmu, fmi1_real_t tStart, fmi1_boolean_t StopTimeDefined, fmi1_real_t tStop)
 {
-	return fmu->fmiInitializeSlave(fmu->c, tStart, StopTimeDefined, tStop);
+	fmi1_status_t status;
+	FMI1_CAPI_TIMED_CALL(fmu, InitializeSlave, status = fmu->fmiInitializeSlave(fmu->c, tStart, StopTimeDefined, tStop));
+	return status;
 }
 
 
@@ -46,46 +49,60 @@ const char* fmi1_capi_get_types_platform(fmi1_capi_t* fmu)
 
 fmi1_status_t fmi1_capi_terminate_slave(fmi1_capi_t* fmu)
 {
-	return fmu->fmiTerminateSlave(fmu->c);
+	fmi1_status_t status;
+	FMI1_CAPI_TIMED_CALL(fmu, TerminateSlave, status = fmu->fmiTerminateSlave(fmu->c));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_reset_slave(fmi1_capi_t* fmu)
 {
-	return fmu->fmiResetSlave(fmu->c);
+	fmi1_status_t status;
+	FMI1_CAPI_TIMED_CALL(fmu, ResetSlave, status = fmu->fmiResetSlave(fmu->c));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_set_real_input_derivatives(fmi1_capi_t* fmu, const  fmi1_value_reference_t vr[], size_t nvr, const fmi1_integer_t order[], const  fmi1_real_t value[])  
 {
-	return fmu->fmiSetRealInputDerivatives(fmu->c, vr, nvr, order, value);
+	fmi1_status_t status;
+	FMI1_CAPI_TIMED_CALL(fmu, SetRealInputDerivatives, status = fmu->fmiSetRealInputDerivatives(fmu->c, vr, nvr, order, value));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_get_real_output_derivatives(fmi1_capi_t* fmu, const  fmi1_value_reference_t vr[], size_t nvr, const fmi1_integer_t order[], fmi1_real_t value[])   
 {
-	return fmu->fmiGetRealOutputDerivatives(fmu->c, vr, nvr, order, value);
+	fmi1_status_t status;
+	FMI1_CAPI_TIMED_CALL(fmu, GetRealOutputDerivatives, status = fmu->fmiGetRealOutputDerivatives(fmu->c, vr, nvr, order, value));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_cancel_step(fmi1_capi_t* fmu)   
 {
-	return fmu->fmiCancelStep(fmu->c);
+	fmi1_status_t status;
+	FMI1_CAPI_TIMED_CALL(fmu, CancelStep, status = fmu->fmiCancelStep(fmu->c));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_do_step(fmi1_capi_t* fmu, fmi1_real_t currentCommunicationPoint, fmi1_real_t communicationStepSize, fmi1_boolean_t newStep)
 {
-	return fmu->fmiDoStep(fmu->c, currentCommunicationPoint, communicationStepSize, newStep);
+	fmi1_status_t status;
+	FMI1_CAPI_TIMED_CALL(fmu, DoStep, status = fmu->fmiDoStep(fmu->c, currentCommunicationPoint, communicationStepSize, newStep));
+	return status;
 }
 
 /* fmiGetStatus* */
 #define FMIGETSTATUSX(FNAME1, FNAME2,FSTATUSTYPE) \
 fmi1_status_t FNAME1(fmi1_capi_t* fmu, const fmi1_status_kind_t s, FSTATUSTYPE*  value) \
 { \
-	return fmu->FNAME2(fmu->c, s, value); \
+	fmi1_status_t status; \
+	FMI1_CAPI_TIMED_CALL(fmu, FNAME2, status = fmu->fmi ## FNAME2(fmu->c, s, value)); \
+	return status; \
 }
 
-FMIGETSTATUSX(fmi1_capi_get_status,		fmiGetStatus,		fmi1_status_t)
-FMIGETSTATUSX(fmi1_capi_get_real_status,		fmiGetRealStatus,	fmi1_real_t)
-FMIGETSTATUSX(fmi1_capi_get_integer_status,	fmiGetIntegerStatus,	fmi1_integer_t)
-FMIGETSTATUSX(fmi1_capi_get_boolean_status,	fmiGetBooleanStatus,	fmi1_boolean_t)
-FMIGETSTATUSX(fmi1_capi_get_string_status,		fmiGetStringStatus,	fmi1_string_t)
+FMIGETSTATUSX(fmi1_capi_get_status,		GetStatus,		fmi1_status_t)
+FMIGETSTATUSX(fmi1_capi_get_real_status,		GetRealStatus,	fmi1_real_t)
+FMIGETSTATUSX(fmi1_capi_get_integer_status,	GetIntegerStatus,	fmi1_integer_t)
+FMIGETSTATUSX(fmi1_capi_get_boolean_status,	GetBooleanStatus,	fmi1_boolean_t)
+FMIGETSTATUSX(fmi1_capi_get_string_status,		GetStringStatus,	fmi1_string_t)
 
 #ifdef __cplusplus
 }
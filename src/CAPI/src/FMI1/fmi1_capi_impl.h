@@ -27,9 +27,24 @@ extern "C" {
 #include <FMI1/fmi1_capi.h>
 #include <JM/jm_portability.h>
 #include <JM/jm_callbacks.h>
+#include <JM/jm_call_statistics.h>
+#include <JM/jm_trace.h>
 
 #define FMI_CAPI_MODULE_NAME "FMICAPI"
 
+#ifdef FMILIB_ENABLE_CALL_STATISTICS
+/** \brief Execute 'call' (a call of fmi<f>), add its duration to the statistics of the function and to the trace */
+#define FMI1_CAPI_TIMED_CALL(fmu, f, call) { \
+	double fmi1_capi_call_start = jm_get_monotonic_time(), fmi1_capi_call_end; \
+	call; \
+	fmi1_capi_call_end = jm_get_monotonic_time(); \
+	jm_call_statistics_add(&(fmu)->callStatistics[fmi1_function_ ## f], fmi1_capi_call_end - fmi1_capi_call_start); \
+	jm_trace_complete("fmi", "fmi" #f, fmi1_capi_call_start, fmi1_capi_call_end); \
+}
+#else
+#define FMI1_CAPI_TIMED_CALL(fmu, f, call) { call; }
+#endif
+
 /** 
  * \brief C-API struct used as a placeholder for the FMI funktions and shared library handler. 
  */
@@ -93,6 +108,10 @@ struct fmi1_capi_t {
     fmi1_get_boolean_status_ft			fmiGetBooleanStatus;
     fmi1_get_string_status_ft			fmiGetStringStatus;
 
+#ifdef FMILIB_ENABLE_CALL_STATISTICS
+	jm_call_statistics_t callStatistics[fmi1_functions_Num];
+#endif
+
 };
 
 #ifdef __cplusplus 
@@ -29,20 +29,23 @@ fmi1_component_t fmi1_capi_instantiate_model(fmi1_capi_t* fmu, fmi1_string_t ins
     cb.allocateMemory = fmu->callBackFunctions.allocateMemory;
     cb.freeMemory = fmu->callBackFunctions.freeMemory;
 	jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiInstantiateModel");
-	return fmu->c = fmu->fmiInstantiateModel(instanceName, GUID, cb, loggingOn);
+	FMI1_CAPI_TIMED_CALL(fmu, InstantiateModel, fmu->c = fmu->fmiInstantiateModel(instanceName, GUID, cb, loggingOn));
+	return fmu->c;
 }
 
 void fmi1_capi_free_model_instance(fmi1_capi_t* fmu)
 {
 	jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiFreeModelInstance");
-	fmu->fmiFreeModelInstance(fmu->c);
+	FMI1_CAPI_TIMED_CALL(fmu, FreeModelInstance, fmu->fmiFreeModelInstance(fmu->c));
 }
 
 fmi1_status_t fmi1_capi_initialize(fmi1_capi_t* fmu, fmi1_boolean_t toleranceControlled, fmi1_real_t relativeTolerance, fmi1_event_info_t* eventInfo)
 {
+	fmi1_status_t status;
 	assert(fmu);
 	jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiInitialize");
-	return fmu->fmiInitialize(fmu->c, toleranceControlled, relativeTolerance, eventInfo);	
+	FMI1_CAPI_TIMED_CALL(fmu, Initialize, status = fmu->fmiInitialize(fmu->c, toleranceControlled, relativeTolerance, eventInfo));
+	return status;	
 }
 
 const char* fmi1_capi_get_model_types_platform(fmi1_capi_t* fmu)
@@ -54,72 +57,92 @@ const char* fmi1_capi_get_model_types_platform(fmi1_capi_t* fmu)
 
 fmi1_status_t fmi1_capi_set_time(fmi1_capi_t* fmu, fmi1_real_t time)
 {
+	fmi1_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiGetModelTypesPlatform");
-	return fmu->fmiSetTime(fmu->c, time);
+	FMI1_CAPI_TIMED_CALL(fmu, SetTime, status = fmu->fmiSetTime(fmu->c, time));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_set_continuous_states(fmi1_capi_t* fmu, const fmi1_real_t x[], size_t nx)
 {
+	fmi1_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiSetContinuousStates");
-	return fmu->fmiSetContinuousStates(fmu->c, x, nx);
+	FMI1_CAPI_TIMED_CALL(fmu, SetContinuousStates, status = fmu->fmiSetContinuousStates(fmu->c, x, nx));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_completed_integrator_step(fmi1_capi_t* fmu, fmi1_boolean_t* callEventUpdate)
 {
+	fmi1_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiCompletedIntegratorStep");
-	return fmu->fmiCompletedIntegratorStep(fmu->c, callEventUpdate);
+	FMI1_CAPI_TIMED_CALL(fmu, CompletedIntegratorStep, status = fmu->fmiCompletedIntegratorStep(fmu->c, callEventUpdate));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_get_derivatives(fmi1_capi_t* fmu, fmi1_real_t derivatives[], size_t nx)
 {
+	fmi1_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiGetDerivatives");
-	return fmu->fmiGetDerivatives(fmu->c, derivatives, nx);
+	FMI1_CAPI_TIMED_CALL(fmu, GetDerivatives, status = fmu->fmiGetDerivatives(fmu->c, derivatives, nx));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_get_event_indicators(fmi1_capi_t* fmu, fmi1_real_t eventIndicators[], size_t ni)
 {
+	fmi1_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiGetEventIndicators");
-	return fmu->fmiGetEventIndicators(fmu->c, eventIndicators, ni);
+	FMI1_CAPI_TIMED_CALL(fmu, GetEventIndicators, status = fmu->fmiGetEventIndicators(fmu->c, eventIndicators, ni));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_eventUpdate(fmi1_capi_t* fmu, fmi1_boolean_t intermediateResults, fmi1_event_info_t* eventInfo)
 {
+	fmi1_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiEventUpdate");
-	return fmu->fmiEventUpdate(fmu->c, intermediateResults, eventInfo);
+	FMI1_CAPI_TIMED_CALL(fmu, EventUpdate, status = fmu->fmiEventUpdate(fmu->c, intermediateResults, eventInfo));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_get_continuous_states(fmi1_capi_t* fmu, fmi1_real_t states[], size_t nx)
 {
+	fmi1_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiGetContinuousStates");
-	return fmu->fmiGetContinuousStates(fmu->c, states, nx);
+	FMI1_CAPI_TIMED_CALL(fmu, GetContinuousStates, status = fmu->fmiGetContinuousStates(fmu->c, states, nx));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_get_nominal_continuous_states(fmi1_capi_t* fmu, fmi1_real_t x_nominal[], size_t nx)
 {
+	fmi1_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiGetNominalContinuousStates");
-	return fmu->fmiGetNominalContinuousStates(fmu->c, x_nominal, nx);
+	FMI1_CAPI_TIMED_CALL(fmu, GetNominalContinuousStates, status = fmu->fmiGetNominalContinuousStates(fmu->c, x_nominal, nx));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_get_state_value_references(fmi1_capi_t* fmu, fmi1_value_reference_t vrx[], size_t nx)
 {
+	fmi1_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiGetStateValueReferences");
-	return fmu->fmiGetStateValueReferences(fmu->c, vrx, nx);
+	FMI1_CAPI_TIMED_CALL(fmu, GetStateValueReferences, status = fmu->fmiGetStateValueReferences(fmu->c, vrx, nx));
+	return status;
 }
 
 fmi1_status_t fmi1_capi_terminate(fmi1_capi_t* fmu)
 {
+	fmi1_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmiTerminate");
-	return fmu->fmiTerminate(fmu->c);
+	FMI1_CAPI_TIMED_CALL(fmu, Terminate, status = fmu->fmiTerminate(fmu->c));
+	return status;
 }
 
 #ifdef __cplusplus
@@ -302,23 +302,29 @@ fmi2_capi_t* fmi2_capi_create_dllfmu(jm_callbacks* cb, const char* dllPath, cons
 
 jm_status_enu_t fmi2_capi_load_fcn(fmi2_capi_t* fmu, unsigned int capabilities[])
 {
+	jm_status_enu_t status;
 	assert(fmu);
+	jm_trace_begin("fmilib", "Load FMI functions");
 	/* Load ME functions */
 	if (fmu->standard == fmi2_fmu_kind_me) {
-		return fmi2_capi_load_me_fcn(fmu, capabilities);
+		status = fmi2_capi_load_me_fcn(fmu, capabilities);
 	/* Load CS functions */
 	} else if (fmu->standard == fmi2_fmu_kind_cs) {
-		return fmi2_capi_load_cs_fcn(fmu, capabilities);
+		status = fmi2_capi_load_cs_fcn(fmu, capabilities);
 	} else {
 		jm_log_error(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Unexpected FMU kind in FMICAPI.");
-		return jm_status_error;
+		status = jm_status_error;
 	}
+	jm_trace_end("fmilib", "Load FMI functions");
+	return status;
 }
 
 jm_status_enu_t fmi2_capi_load_dll(fmi2_capi_t* fmu)
 {
 	assert(fmu && fmu->dllPath);
+	jm_trace_begin("fmilib", "Load shared library");
 	fmu->dllHandle = jm_portability_load_dll_handle(fmu->dllPath); /* Load the shared library */
+	jm_trace_end("fmilib", "Load shared library");
 	if (fmu->dllHandle == NULL) {
 		jm_log_fatal(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Could not load the DLL: %s", jm_portability_get_last_dll_error());
 		return jm_status_error;
@@ -338,6 +344,19 @@ int fmi2_capi_get_debug_mode(fmi2_capi_t* fmu) {
 	return 0;
 }
 
+const jm_call_statistics_t* fmi2_capi_get_call_statistics(fmi2_capi_t* fmu, fmi2_function_enu_t f) {
+#ifdef FMILIB_ENABLE_CALL_STATISTICS
+	if(fmu && (int)f >= 0 && f < fmi2_functions_Num) return &fmu->callStatistics[f];
+#endif
+	return 0;
+}
+
+void fmi2_capi_reset_call_statistics(fmi2_capi_t* fmu) {
+#ifdef FMILIB_ENABLE_CALL_STATISTICS
+	if(fmu) memset(fmu->callStatistics, 0, sizeof(fmu->callStatistics));
+#endif
+}
+
 fmi2_fmu_kind_enu_t fmi2_capi_get_fmu_kind(fmi2_capi_t* fmu) {
 	if(fmu) return fmu->standard;
 	return fmi2_fmu_kind_unknown;
@@ -384,7 +403,9 @@ const char* fmi2_capi_get_types_platform(fmi2_capi_t* fmu)
 
 fmi2_status_t fmi2_capi_set_debug_logging(fmi2_capi_t* fmu, fmi2_boolean_t loggingOn, size_t nCategories, fmi2_string_t categories[])
 {
-	return fmu->fmi2SetDebugLogging(fmu->c, loggingOn, nCategories, categories);
+	fmi2_status_t status;
+	FMI2_CAPI_TIMED_CALL(fmu, SetDebugLogging, status = fmu->fmi2SetDebugLogging(fmu->c, loggingOn, nCategories, categories));
+	return status;
 }
 
 fmi2_component_t fmi2_capi_instantiate(fmi2_capi_t* fmu,
@@ -392,14 +413,15 @@ fmi2_component_t fmi2_capi_instantiate(fmi2_capi_t* fmu,
   fmi2_string_t fmuResourceLocation, fmi2_boolean_t visible,
   fmi2_boolean_t loggingOn)
 {
-    return fmu->c = fmu->fmi2Instantiate(instanceName, fmuType, fmuGUID,
-        fmuResourceLocation, &fmu->callBackFunctions, visible, loggingOn);
+    FMI2_CAPI_TIMED_CALL(fmu, Instantiate, fmu->c = fmu->fmi2Instantiate(instanceName, fmuType, fmuGUID,
+        fmuResourceLocation, &fmu->callBackFunctions, visible, loggingOn));
+    return fmu->c;
 }
 
 void fmi2_capi_free_instance(fmi2_capi_t* fmu)
 {
     if(fmu->c) {
-        fmu->fmi2FreeInstance(fmu->c);
+        FMI2_CAPI_TIMED_CALL(fmu, FreeInstance, fmu->fmi2FreeInstance(fmu->c));
         fmu->c = 0;
     }
 }
@@ -410,62 +432,86 @@ fmi2_status_t fmi2_capi_setup_experiment(fmi2_capi_t* fmu,
     fmi2_real_t start_time, fmi2_boolean_t stop_time_defined,
     fmi2_real_t stop_time)
 {
+    fmi2_status_t status;
     assert(fmu); assert(fmu->c);
     jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2SetupExperiment");
-    return fmu->fmi2SetupExperiment(fmu->c, tolerance_defined, tolerance,
-                                   start_time, stop_time_defined, stop_time);
+    FMI2_CAPI_TIMED_CALL(fmu, SetupExperiment, status = fmu->fmi2SetupExperiment(fmu->c, tolerance_defined, tolerance,
+                                   start_time, stop_time_defined, stop_time));
+    return status;
 }
 
 fmi2_status_t fmi2_capi_enter_initialization_mode(fmi2_capi_t* fmu)
 {
+    fmi2_status_t status;
     assert(fmu); assert(fmu->c);
     jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2EnterInitializationMode");
-    return fmu->fmi2EnterInitializationMode(fmu->c);
+    FMI2_CAPI_TIMED_CALL(fmu, EnterInitializationMode, status = fmu->fmi2EnterInitializationMode(fmu->c));
+    return status;
 }
 
 fmi2_status_t fmi2_capi_exit_initialization_mode(fmi2_capi_t* fmu)
 {
+    fmi2_status_t status;
     assert(fmu); assert(fmu->c);
     jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2ExitInitializationMode");
-    return fmu->fmi2ExitInitializationMode(fmu->c);
+    FMI2_CAPI_TIMED_CALL(fmu, ExitInitializationMode, status = fmu->fmi2ExitInitializationMode(fmu->c));
+    return status;
 }
 
 
 fmi2_status_t fmi2_capi_terminate(fmi2_capi_t* fmu)
 {
+	fmi2_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2Terminate");
-	return fmu->fmi2Terminate(fmu->c);
+	FMI2_CAPI_TIMED_CALL(fmu, Terminate, status = fmu->fmi2Terminate(fmu->c));
+	return status;
 }
 
 fmi2_status_t fmi2_capi_reset(fmi2_capi_t* fmu)
 {
-	return fmu->fmi2Reset(fmu->c);
+	fmi2_status_t status;
+	FMI2_CAPI_TIMED_CALL(fmu, Reset, status = fmu->fmi2Reset(fmu->c));
+	return status;
 }
 
 fmi2_status_t fmi2_capi_get_fmu_state           (fmi2_capi_t* fmu, fmi2_FMU_state_t* s) {
-	return fmu->fmi2GetFMUstate(fmu -> c,s);
+	fmi2_status_t status;
+	FMI2_CAPI_TIMED_CALL(fmu, GetFMUstate, status = fmu->fmi2GetFMUstate(fmu -> c,s));
+	return status;
 }
 fmi2_status_t fmi2_capi_set_fmu_state           (fmi2_capi_t* fmu, fmi2_FMU_state_t s){
-	return fmu->fmi2SetFMUstate(fmu -> c,s);
+	fmi2_status_t status;
+	FMI2_CAPI_TIMED_CALL(fmu, SetFMUstate, status = fmu->fmi2SetFMUstate(fmu -> c,s));
+	return status;
 }
 fmi2_status_t fmi2_capi_free_fmu_state          (fmi2_capi_t* fmu, fmi2_FMU_state_t* s){
-	return fmu->fmi2FreeFMUstate (fmu -> c,s);
+	fmi2_status_t status;
+	FMI2_CAPI_TIMED_CALL(fmu, FreeFMUstate, status = fmu->fmi2FreeFMUstate (fmu -> c,s));
+	return status;
 }
 fmi2_status_t fmi2_capi_serialized_fmu_state_size(fmi2_capi_t* fmu, fmi2_FMU_state_t s, size_t* sz){
-	return fmu->fmi2SerializedFMUstateSize(fmu -> c,s,sz);
+	fmi2_status_t status;
+	FMI2_CAPI_TIMED_CALL(fmu, SerializedFMUstateSize, status = fmu->fmi2SerializedFMUstateSize(fmu -> c,s,sz));
+	return status;
 }
 fmi2_status_t fmi2_capi_serialize_fmu_state     (fmi2_capi_t* fmu, fmi2_FMU_state_t s , fmi2_byte_t data[], size_t sz){
-	return fmu->fmi2SerializeFMUstate(fmu -> c,s,data,sz);
+	fmi2_status_t status;
+	FMI2_CAPI_TIMED_CALL(fmu, SerializeFMUstate, status = fmu->fmi2SerializeFMUstate(fmu -> c,s,data,sz));
+	return status;
 }
 fmi2_status_t fmi2_capi_de_serialize_fmu_state  (fmi2_capi_t* fmu, const fmi2_byte_t data[], size_t sz, fmi2_FMU_state_t* s){
-	return fmu->fmi2DeSerializeFMUstate (fmu -> c,data,sz,s);
+	fmi2_status_t status;
+	FMI2_CAPI_TIMED_CALL(fmu, DeSerializeFMUstate, status = fmu->fmi2DeSerializeFMUstate (fmu -> c,data,sz,s));
+	return status;
 }
 
 fmi2_status_t fmi2_capi_get_directional_derivative(fmi2_capi_t* fmu, const fmi2_value_reference_t v_ref[], size_t nv,
                                                                    const fmi2_value_reference_t z_ref[], size_t nz,
                                                                    const fmi2_real_t dv[], fmi2_real_t dz[]){
-	return fmu->fmi2GetDirectionalDerivative(fmu -> c,v_ref, nv, z_ref, nz, dv, dz);
+	fmi2_status_t status;
+	FMI2_CAPI_TIMED_CALL(fmu, GetDirectionalDerivative, status = fmu->fmi2GetDirectionalDerivative(fmu -> c,v_ref, nv, z_ref, nz, dv, dz));
+	return status;
 }
 
 
@@ -473,22 +519,26 @@ fmi2_status_t fmi2_capi_get_directional_derivative(fmi2_capi_t* fmu, const fmi2_
 #define FMISETX(FNAME1, FNAME2, FTYPE) \
 fmi2_status_t FNAME1(fmi2_capi_t* fmu, const fmi2_value_reference_t vr[], size_t nvr, const FTYPE value[])	\
 { \
-	return fmu->FNAME2(fmu->c, vr, nvr, value); \
+	fmi2_status_t status; \
+	FMI2_CAPI_TIMED_CALL(fmu, FNAME2, status = fmu->fmi2 ## FNAME2(fmu->c, vr, nvr, value)); \
+	return status; \
 }
 
 /* fmiGet* functions */
 #define FMIGETX(FNAME1, FNAME2, FTYPE) \
 fmi2_status_t FNAME1(fmi2_capi_t* fmu, const fmi2_value_reference_t vr[], size_t nvr, FTYPE value[]) \
 { \
-	return fmu->FNAME2(fmu->c, vr, nvr, value); \
+	fmi2_status_t status; \
+	FMI2_CAPI_TIMED_CALL(fmu, FNAME2, status = fmu->fmi2 ## FNAME2(fmu->c, vr, nvr, value)); \
+	return status; \
 }
 
-FMISETX(fmi2_capi_set_real,		fmi2SetReal,		fmi2_real_t)
-FMISETX(fmi2_capi_set_integer,	fmi2SetInteger,	fmi2_integer_t)
-FMISETX(fmi2_capi_set_boolean,	fmi2SetBoolean,	fmi2_boolean_t)
-FMISETX(fmi2_capi_set_string,	fmi2SetString,	fmi2_string_t)
+FMISETX(fmi2_capi_set_real,		SetReal,		fmi2_real_t)
+FMISETX(fmi2_capi_set_integer,	SetInteger,	fmi2_integer_t)
+FMISETX(fmi2_capi_set_boolean,	SetBoolean,	fmi2_boolean_t)
+FMISETX(fmi2_capi_set_string,	SetString,	fmi2_string_t)
 
-FMIGETX(fmi2_capi_get_real,	fmi2GetReal,		fmi2_real_t)
-FMIGETX(fmi2_capi_get_integer,	fmi2GetInteger,	fmi2_integer_t)
-FMIGETX(fmi2_capi_get_boolean,	fmi2GetBoolean,	fmi2_boolean_t)
-FMIGETX(fmi2_capi_get_string,	fmi2GetString,	fmi2_string_t)
+FMIGETX(fmi2_capi_get_real,	GetReal,		fmi2_real_t)
+FMIGETX(fmi2_capi_get_integer,	GetInteger,	fmi2_integer_t)
+FMIGETX(fmi2_capi_get_boolean,	GetBoolean,	fmi2_boolean_t)
+FMIGETX(fmi2_capi_get_string,	GetString,	fmi2_string_t)
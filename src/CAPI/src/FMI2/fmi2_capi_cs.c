@@ -23,36 +23,46 @@ extern "C" {
 
 fmi2_status_t fmi2_capi_set_real_input_derivatives(fmi2_capi_t* fmu, const  fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t order[], const  fmi2_real_t value[])  
 {
-	return fmu->fmi2SetRealInputDerivatives(fmu->c, vr, nvr, order, value);
+	fmi2_status_t status;
+	FMI2_CAPI_TIMED_CALL(fmu, SetRealInputDerivatives, status = fmu->fmi2SetRealInputDerivatives(fmu->c, vr, nvr, order, value));
+	return status;
 }
 
 fmi2_status_t fmi2_capi_get_real_output_derivatives(fmi2_capi_t* fmu, const  fmi2_value_reference_t vr[], size_t nvr, const fmi2_integer_t order[], fmi2_real_t value[])   
 {
-	return fmu->fmi2GetRealOutputDerivatives(fmu->c, vr, nvr, order, value);
+	fmi2_status_t status;
+	FMI2_CAPI_TIMED_CALL(fmu, GetRealOutputDerivatives, status = fmu->fmi2GetRealOutputDerivatives(fmu->c, vr, nvr, order, value));
+	return status;
 }
 
 fmi2_status_t fmi2_capi_cancel_step(fmi2_capi_t* fmu)   
 {
-	return fmu->fmi2CancelStep(fmu->c);
+	fmi2_status_t status;
+	FMI2_CAPI_TIMED_CALL(fmu, CancelStep, status = fmu->fmi2CancelStep(fmu->c));
+	return status;
 }
 
 fmi2_status_t fmi2_capi_do_step(fmi2_capi_t* fmu, fmi2_real_t currentCommunicationPoint, fmi2_real_t communicationStepSize, fmi2_boolean_t newStep)
 {
-	return fmu->fmi2DoStep(fmu->c, currentCommunicationPoint, communicationStepSize, newStep);
+	fmi2_status_t status;
+	FMI2_CAPI_TIMED_CALL(fmu, DoStep, status = fmu->fmi2DoStep(fmu->c, currentCommunicationPoint, communicationStepSize, newStep));
+	return status;
 }
 
 /* fmiGetStatus* */
 #define FMIGETSTATUSX(FNAME1, FNAME2,FSTATUSTYPE) \
 fmi2_status_t FNAME1(fmi2_capi_t* fmu, const fmi2_status_kind_t s, FSTATUSTYPE*  value) \
 { \
-	return fmu->FNAME2(fmu->c, s, value); \
+	fmi2_status_t status; \
+	FMI2_CAPI_TIMED_CALL(fmu, FNAME2, status = fmu->fmi2 ## FNAME2(fmu->c, s, value)); \
+	return status; \
 }
 
-FMIGETSTATUSX(fmi2_capi_get_status,		fmi2GetStatus,		fmi2_status_t)
-FMIGETSTATUSX(fmi2_capi_get_real_status,		fmi2GetRealStatus,	fmi2_real_t)
-FMIGETSTATUSX(fmi2_capi_get_integer_status,	fmi2GetIntegerStatus,	fmi2_integer_t)
-FMIGETSTATUSX(fmi2_capi_get_boolean_status,	fmi2GetBooleanStatus,	fmi2_boolean_t)
-FMIGETSTATUSX(fmi2_capi_get_string_status,		fmi2GetStringStatus,	fmi2_string_t)
+FMIGETSTATUSX(fmi2_capi_get_status,		GetStatus,		fmi2_status_t)
+FMIGETSTATUSX(fmi2_capi_get_real_status,		GetRealStatus,	fmi2_real_t)
+FMIGETSTATUSX(fmi2_capi_get_integer_status,	GetIntegerStatus,	fmi2_integer_t)
+FMIGETSTATUSX(fmi2_capi_get_boolean_status,	GetBooleanStatus,	fmi2_boolean_t)
+FMIGETSTATUSX(fmi2_capi_get_string_status,		GetStringStatus,	fmi2_string_t)
 
 #ifdef __cplusplus
 }
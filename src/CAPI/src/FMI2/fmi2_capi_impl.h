@@ -27,9 +27,24 @@ extern "C" {
 #include <FMI2/fmi2_capi.h>
 #include <JM/jm_portability.h>
 #include <JM/jm_callbacks.h>
+#include <JM/jm_call_statistics.h>
+#include <JM/jm_trace.h>
 
 #define FMI_CAPI_MODULE_NAME "FMICAPI"
 
+#ifdef FMILIB_ENABLE_CALL_STATISTICS
+/** \brief Execute 'call' (a call of fmi2<f>), add its duration to the statistics of the function and to the trace */
+#define FMI2_CAPI_TIMED_CALL(fmu, f, call) { \
+	double fmi2_capi_call_start = jm_get_monotonic_time(), fmi2_capi_call_end; \
+	call; \
+	fmi2_capi_call_end = jm_get_monotonic_time(); \
+	jm_call_statistics_add(&(fmu)->callStatistics[fmi2_function_ ## f], fmi2_capi_call_end - fmi2_capi_call_start); \
+	jm_trace_complete("fmi", "fmi2" #f, fmi2_capi_call_start, fmi2_capi_call_end); \
+}
+#else
+#define FMI2_CAPI_TIMED_CALL(fmu, f, call) { call; }
+#endif
+
 /** 
  * \brief C-API struct used as a placeholder for the FMI functions and shared library handler. 
  */
@@ -107,6 +122,10 @@ struct fmi2_capi_t {
     fmi2_get_boolean_status_ft			fmi2GetBooleanStatus;
     fmi2_get_string_status_ft			fmi2GetStringStatus;
 
+#ifdef FMILIB_ENABLE_CALL_STATISTICS
+	jm_call_statistics_t callStatistics[fmi2_functions_Num];
+#endif
+
 };
 
 #ifdef __cplusplus 
@@ -20,73 +20,93 @@
 
 fmi2_status_t fmi2_capi_enter_event_mode(fmi2_capi_t* fmu)
 {
+    fmi2_status_t status;
     assert(fmu); assert(fmu->c);
     jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2EnterEventMode");
-    return fmu->fmi2EnterEventMode(fmu->c);
+    FMI2_CAPI_TIMED_CALL(fmu, EnterEventMode, status = fmu->fmi2EnterEventMode(fmu->c));
+    return status;
 }
 
 fmi2_status_t fmi2_capi_new_discrete_states(fmi2_capi_t* fmu, fmi2_event_info_t* eventInfo)
 {
+    fmi2_status_t status;
     assert(fmu); assert(fmu->c);
     jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2NewDiscreteStates");
-    return fmu->fmi2NewDiscreteStates(fmu->c, eventInfo);
+    FMI2_CAPI_TIMED_CALL(fmu, NewDiscreteStates, status = fmu->fmi2NewDiscreteStates(fmu->c, eventInfo));
+    return status;
 }
 
 fmi2_status_t fmi2_capi_enter_continuous_time_mode(fmi2_capi_t* fmu)
 {
+    fmi2_status_t status;
     assert(fmu); assert(fmu->c);
     jm_log_verbose(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2EnterContinuousTimeMode");
-    return fmu->fmi2EnterContinuousTimeMode(fmu->c);
+    FMI2_CAPI_TIMED_CALL(fmu, EnterContinuousTimeMode, status = fmu->fmi2EnterContinuousTimeMode(fmu->c));
+    return status;
 }
 
 fmi2_status_t fmi2_capi_set_time(fmi2_capi_t* fmu, fmi2_real_t time)
 {
+	fmi2_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2SetTime");
-	return fmu->fmi2SetTime(fmu->c, time);
+	FMI2_CAPI_TIMED_CALL(fmu, SetTime, status = fmu->fmi2SetTime(fmu->c, time));
+	return status;
 }
 
 fmi2_status_t fmi2_capi_set_continuous_states(fmi2_capi_t* fmu, const fmi2_real_t x[], size_t nx)
 {
+	fmi2_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2SetContinuousStates");
-	return fmu->fmi2SetContinuousStates(fmu->c, x, nx);
+	FMI2_CAPI_TIMED_CALL(fmu, SetContinuousStates, status = fmu->fmi2SetContinuousStates(fmu->c, x, nx));
+	return status;
 }
 
 fmi2_status_t fmi2_capi_completed_integrator_step(fmi2_capi_t* fmu,
   fmi2_boolean_t noSetFMUStatePriorToCurrentPoint,
   fmi2_boolean_t* enterEventMode, fmi2_boolean_t* terminateSimulation)
 {
+    fmi2_status_t status;
     assert(fmu);
     jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2CompletedIntegratorStep");
-    return fmu->fmi2CompletedIntegratorStep(fmu->c, noSetFMUStatePriorToCurrentPoint,
-                                           enterEventMode, terminateSimulation);
+    FMI2_CAPI_TIMED_CALL(fmu, CompletedIntegratorStep, status = fmu->fmi2CompletedIntegratorStep(fmu->c, noSetFMUStatePriorToCurrentPoint,
+                                           enterEventMode, terminateSimulation));
+    return status;
 }
 
 fmi2_status_t fmi2_capi_get_derivatives(fmi2_capi_t* fmu, fmi2_real_t derivatives[], size_t nx)
 {
+	fmi2_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2GetDerivatives");
-	return fmu->fmi2GetDerivatives(fmu->c, derivatives, nx);
+	FMI2_CAPI_TIMED_CALL(fmu, GetDerivatives, status = fmu->fmi2GetDerivatives(fmu->c, derivatives, nx));
+	return status;
 }
 
 fmi2_status_t fmi2_capi_get_event_indicators(fmi2_capi_t* fmu, fmi2_real_t eventIndicators[], size_t ni)
 {
+	fmi2_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2GetEventIndicators");
-	return fmu->fmi2GetEventIndicators(fmu->c, eventIndicators, ni);
+	FMI2_CAPI_TIMED_CALL(fmu, GetEventIndicators, status = fmu->fmi2GetEventIndicators(fmu->c, eventIndicators, ni));
+	return status;
 }
 
 fmi2_status_t fmi2_capi_get_continuous_states(fmi2_capi_t* fmu, fmi2_real_t states[], size_t nx)
 {
+	fmi2_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2GetContinuousStates");
-	return fmu->fmi2GetContinuousStates(fmu->c, states, nx);
+	FMI2_CAPI_TIMED_CALL(fmu, GetContinuousStates, status = fmu->fmi2GetContinuousStates(fmu->c, states, nx));
+	return status;
 }
 
 fmi2_status_t fmi2_capi_get_nominals_of_continuous_states(fmi2_capi_t* fmu, fmi2_real_t x_nominal[], size_t nx)
 {
+	fmi2_status_t status;
 	assert(fmu);
 	jm_log_debug(fmu->callbacks, FMI_CAPI_MODULE_NAME, "Calling fmi2GetNominalsOfContinuousStates");
-	return fmu->fmi2GetNominalsOfContinuousStates(fmu->c, x_nominal, nx);
+	FMI2_CAPI_TIMED_CALL(fmu, GetNominalsOfContinuousStates, status = fmu->fmi2GetNominalsOfContinuousStates(fmu->c, x_nominal, nx));
+	return status;
 }
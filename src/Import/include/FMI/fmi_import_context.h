@@ -84,6 +84,19 @@ FMILIB_EXPORT void fmi_import_free_context( fmi_import_context_t* c);
 */
 FMILIB_EXPORT fmi_version_enu_t fmi_import_get_fmi_version( fmi_import_context_t* c, const char* fileName, const char* dirName);
 
+/**
+	\brief Enable or disable memory accounting for the FMUs parsed afterwards with the context.
+
+	When enabled, every FMI 2.0 FMU gets its own ::jm_memory_accounting_t record and
+	fmi2_import_get_memory_usage() reports how much memory the library holds for it.
+	The accounting adds a small header to every block. It is disabled by default.
+	If the accounting cannot be set up for an FMU, e.g., because too many different callbacks
+	are in use, a warning is logged and the FMU is parsed without it.
+	@param c - library context.
+	@param enable - non-zero to enable the accounting.
+*/
+FMILIB_EXPORT void fmi_import_set_memory_accounting( fmi_import_context_t* c, int enable);
+
 /**
 	\brief FMU version 1.0 object
 */
@@ -21,6 +21,7 @@ extern "C" {
 #endif
 
 #include <JM/jm_callbacks.h>
+#include <JM/jm_call_statistics.h>
 #include <FMI/fmi_import_util.h>
 #include <FMI/fmi_import_context.h>
 /* #include <FMI1/fmi1_xml_model_description.h>*/
@@ -88,6 +89,34 @@ FMILIB_EXPORT void fmi1_import_destroy_dllfmu(fmi1_import_t* fmu);
  */
 FMILIB_EXPORT void fmi1_import_set_debug_mode(fmi1_import_t* fmu, int mode);
 
+/**
+ * \brief Get the timing statistics of the calls of an FMI function.
+ *
+ * The statistics are collected for every call through the C-API since the C-API struct was created
+ * or since the last fmi1_import_reset_call_statistics(). They are only available if the library
+ * is compiled with FMILIB_ENABLE_CALL_STATISTICS.
+ * 
+ * @param fmu A model description object returned by fmi1_import_parse_xml() that has loaded the FMI functions.
+ * @param f The FMI function, e.g., fmi1_function_DoStep for fmiDoStep.
+ * @param stats (Output) A copy of the statistics.
+ * @return Error status. jm_status_error is returned if the statistics are not available.
+ */
+FMILIB_EXPORT jm_status_enu_t fmi1_import_get_call_statistics(fmi1_import_t* fmu, fmi1_function_enu_t f, jm_call_statistics_t* stats);
+
+/**
+ * \brief Clear the timing statistics of the calls of all the FMI functions.
+ * 
+ * @param fmu A model description object returned by fmi1_import_parse_xml() that has loaded the FMI functions.
+ */
+FMILIB_EXPORT void fmi1_import_reset_call_statistics(fmi1_import_t* fmu);
+
+/**
+ * \brief Log the timing statistics of the FMI functions that were called, one info message per function.
+ * 
+ * @param fmu A model description object returned by fmi1_import_parse_xml() that has loaded the FMI functions.
+ */
+FMILIB_EXPORT void fmi1_import_log_call_statistics(fmi1_import_t* fmu);
+
 /**@} */
 
 /**
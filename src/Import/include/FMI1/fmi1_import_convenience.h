@@ -87,7 +87,8 @@ void fmi1_import_collect_model_counts(fmi1_import_t* fmu, fmi1_import_model_coun
 
 /**
   \brief Print msgIn into msgOut by expanding variable references of the form #\<Type\>\<VR\># into variable names
-  and replacing '##' with a single #.
+  and replacing '##' with a single #. The message is written directly into msgOut and truncated
+  to maxMsgSize. If a reference is malformed, a warning is logged and msgOut receives msgIn unchanged.
    \param fmu - An fmu object as returned by fmi1_import_parse_xml().
    \param msgIn - Log message as produced by an FMU.
    \param msgOut - Output message buffer. 
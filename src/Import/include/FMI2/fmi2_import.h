@@ -23,6 +23,7 @@
 #include <stddef.h>
 #include <fmilib_config.h>
 #include <JM/jm_callbacks.h>
+#include <JM/jm_memory_accounting.h>
 #include <FMI/fmi_import_util.h>
 #include <FMI/fmi_import_context.h>
 /* #include <FMI2/fmi2_xml_model_description.h> */
@@ -38,6 +39,19 @@
 
 #include "fmi2_import_capi.h"
 #include "fmi2_import_convenience.h"
+#include "fmi2_import_me_driver.h"
+#include "fmi2_import_jacobian.h"
+#include "fmi2_import_dependency_graph.h"
+#include "fmi2_import_cosim_master.h"
+#include "fmi2_import_async.h"
+#include "fmi2_import_log_filter.h"
+#include "fmi2_import_selection.h"
+#include "fmi2_import_component.h"
+#include "fmi2_import_state_ring.h"
+#include "fmi2_import_state_store.h"
+#include "fmi2_import_warm_start.h"
+#include "fmi2_import_result_writer.h"
+#include "fmi2_import_mat_writer.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -90,6 +104,26 @@ FMILIB_EXPORT int fmi2_import_clear_last_error(fmi2_import_t* fmu);
 @param fmu An fmu object as returned by fmi2_import_parse_xml().
 */
 FMILIB_EXPORT void fmi2_import_free(fmi2_import_t* fmu);
+
+/**
+\brief Get the memory the library currently holds for an FMU.
+
+The memory is only tracked if the accounting was enabled with fmi_import_set_memory_accounting()
+before the FMU was parsed. The FMU object itself and memory allocated in threads started by
+the library are not included.
+@param fmu An FMU object as returned by fmi2_import_parse_xml().
+@param subsystem The part of the library to report or ::jm_memory_subsystem_total for the sum.
+@param usage Output: the usage of the subsystem.
+@return Error if the memory accounting is not enabled for the FMU.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_get_memory_usage(fmi2_import_t* fmu, jm_memory_subsystem_enu_t subsystem, jm_memory_usage_t* usage);
+
+/**
+\brief Log the memory usage of every subsystem of an FMU as info messages.
+@param fmu An FMU object as returned by fmi2_import_parse_xml().
+@return Error if the memory accounting is not enabled for the FMU.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_log_memory_usage(fmi2_import_t* fmu);
 /** @}
 \addtogroup fmi2_import_gen
  * \brief Functions for retrieving general model information. Memory for the strings is allocated and deallocated in the module.
@@ -221,6 +255,27 @@ FMILIB_EXPORT fmi2_import_variable_list_t* fmi2_import_get_variable_aliases(fmi2
 */
 FMILIB_EXPORT fmi2_import_variable_list_t* fmi2_import_get_variable_list(fmi2_import_t* fmu, int sortOrder);
 
+/** \brief Get the variables whose names start with a prefix, e.g., all the variables of a component "plant.pump.".
+* @param fmu An FMU object as returned by fmi2_import_parse_xml().
+* @param prefix The name prefix.
+* @return a variable list sorted alphabetically by variable name. The variables are found with a binary search.
+*/
+FMILIB_EXPORT fmi2_import_variable_list_t* fmi2_import_get_variables_by_name_prefix(fmi2_import_t* fmu, const char* prefix);
+
+/** \brief Get the variables whose names match a pattern.
+*
+* Variable names are hierarchical, e.g., "plant.pipe[3].T". In the pattern, '*' matches any characters
+* within one component of the name, '**' (or more stars) matches any characters including '.', and '?' matches one
+* character that is not '.'. Subscripts may contain ranges and '*': "plant.pipe[2:4].T" and
+* "plant.grid[*,1].T" match the subscripts with indices in the ranges. Other characters match themselves.
+* Only the variables that have the literal prefix of the pattern, i.e., the characters before the first
+* wildcard, are visited.
+* @param fmu An FMU object as returned by fmi2_import_parse_xml().
+* @param pattern The name pattern, e.g., "plant.*.T".
+* @return a variable list sorted alphabetically by variable name.
+*/
+FMILIB_EXPORT fmi2_import_variable_list_t* fmi2_import_get_variables_by_name_pattern(fmi2_import_t* fmu, const char* pattern);
+
 /** \brief Create a variable list with a single variable.
   
 \param fmu An FMU object that this variable list will reference.
@@ -0,0 +1,131 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_async.h
+*  \brief Public interface to the FMI import C-library. Asynchronous fmi2DoStep.
+*/
+
+#ifndef FMI2_IMPORT_ASYNC_H_
+#define FMI2_IMPORT_ASYNC_H_
+
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_functions.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_async Asynchronous stepping of Co-Simulation FMUs.
+	@}
+	\addtogroup fmi2_import_async Asynchronous stepping of Co-Simulation FMUs.
+	\brief Run fmi2DoStep in the background and get notified when it finishes.
+
+	fmi2_import_do_step_async() starts a communication step and returns a future
+	right away. The step is run in one of two ways:
+	- FMUs with the canRunAsynchronuously capability are called directly. If the FMU
+	  returns ::fmi2_status_pending, the step finishes when the FMU calls the stepFinished
+	  callback. This is only done if the caller opted in by loading the FMU with
+	  fmi2_import_step_finished_forwarding() as stepFinished and the ::fmi2_import_t as
+	  componentEnvironment. The default callbacks of fmi2_import_create_dllfmu() leave
+	  stepFinished NULL, so that the FMU may not return ::fmi2_status_pending from
+	  fmi2_import_do_step().
+	- All other FMUs are stepped by a worker thread of an executor.
+
+	A master can thereby set the inputs of one FMU while others compute, or react to the
+	completion of a step in the completion callback. Only one step per FMU can be
+	outstanding, and the FMU must not be called until the future has been waited for.
+	@{
+	*/
+
+/** \brief Opaque executor: the thread pool running synchronous FMUs */
+typedef struct fmi2_import_async_executor_t fmi2_import_async_executor_t;
+
+/** \brief Opaque handle to a started communication step */
+typedef struct fmi2_import_step_future_t fmi2_import_step_future_t;
+
+/**
+	\brief Completion callback.
+
+	Called once per step, from the thread that completed the step (a worker thread
+	or the thread of the FMU calling stepFinished), before the future is marked done.
+	\param fmu The FMU that finished the step.
+	\param status Status of the step.
+	\param userData The pointer given to fmi2_import_do_step_async().
+*/
+typedef void (*fmi2_import_step_finished_ft)(fmi2_import_t* fmu, fmi2_status_t status, void* userData);
+
+/**
+	\brief Create an executor.
+	\param cb Callbacks for memory allocation and logging. Default callbacks are used if NULL.
+	\param numThreads Number of worker threads. 0 means one per processor.
+	\return An executor or NULL on error. Must be freed with fmi2_import_async_executor_free().
+*/
+FMILIB_EXPORT
+fmi2_import_async_executor_t* fmi2_import_async_executor_create(jm_callbacks* cb, size_t numThreads);
+
+/** \brief Wait for the running steps, stop the worker threads and free the executor */
+FMILIB_EXPORT
+void fmi2_import_async_executor_free(fmi2_import_async_executor_t* executor);
+
+/**
+	\brief Start a communication step.
+	\param executor Executor used for FMUs that cannot run asynchronously.
+	\param fmu An instantiated Co-Simulation FMU without an outstanding step.
+	\param currentCommunicationPoint Current communication point of the master.
+	\param communicationStepSize Communication step size.
+	\param newStep Indicates whether or not the last communication step was accepted by the master.
+	\param callback Completion callback or NULL.
+	\param userData Passed to the callback.
+	\return A future or NULL on error. Must be freed with fmi2_import_step_future_free().
+*/
+FMILIB_EXPORT
+fmi2_import_step_future_t* fmi2_import_do_step_async(fmi2_import_async_executor_t* executor, fmi2_import_t* fmu,
+	fmi2_real_t currentCommunicationPoint, fmi2_real_t communicationStepSize, fmi2_boolean_t newStep,
+	fmi2_import_step_finished_ft callback, void* userData);
+
+/** \brief Check if the step has finished, without blocking */
+FMILIB_EXPORT
+int fmi2_import_step_future_is_done(fmi2_import_step_future_t* future);
+
+/**
+	\brief Block until the step has finished. The FMU can be called again afterwards.
+	\return The status returned by fmi2DoStep or passed to stepFinished.
+*/
+FMILIB_EXPORT
+fmi2_status_t fmi2_import_step_future_wait(fmi2_import_step_future_t* future);
+
+/** \brief Wait for the step if needed and free the future */
+FMILIB_EXPORT
+void fmi2_import_step_future_free(fmi2_import_step_future_t* future);
+
+/**
+	\brief An implementation of the FMI 2.0 stepFinished callback that completes the future
+	of an asynchronous step started with fmi2_import_do_step_async().
+
+	The componentEnvironment of the callback functions must be the ::fmi2_import_t.
+*/
+FMILIB_EXPORT
+void fmi2_import_step_finished_forwarding(fmi2_component_environment_t env, fmi2_status_t status);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_ASYNC_H_ */
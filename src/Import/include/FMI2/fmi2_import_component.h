@@ -0,0 +1,151 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_component.h
+*  \brief Public interface to the FMI import C-library. Component tree of structured variable names.
+*/
+
+#ifndef FMI2_IMPORT_COMPONENT_H_
+#define FMI2_IMPORT_COMPONENT_H_
+
+#include <stddef.h>
+#include <FMI/fmi_import_context.h>
+#include "fmi2_import_variable.h"
+#include "fmi2_import_variable_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_component Component tree
+	@}
+	\addtogroup fmi2_import_component Component tree
+	\brief Navigation of the component hierarchy encoded in structured variable names.
+
+	When fmi2_import_get_naming_convention() returns ::fmi2_naming_enu_structured, the names
+	are split into components at the dots that are not inside brackets, parentheses or quoted
+	identifiers, e.g., "plant.pipe[2].T" is the variable "T" of the component "pipe[2]" of the
+	component "plant". Derivatives like "der(plant.pump.T)" are variables of the root component.
+	With the flat naming convention all the variables belong to the root component.
+
+	The tree is built on the first call to fmi2_import_get_root_component() or
+	fmi2_import_find_component() from the alphabetically sorted variables and is freed together
+	with the FMU. The components are stored in one array and their names are slices of the
+	variable names, so they are not zero terminated. The variables are stored in one list in which
+	the variables of a component and of its whole subtree are contiguous ranges that are returned
+	as views without copying:
+	\code
+	fmi2_import_component_t* c = fmi2_import_find_component(fmu, "plant.pipe[2]");
+	fmi2_import_variable_list_view_t view;
+	fmi2_import_get_component_subtree_variables(c, &view);
+	\endcode
+	The first call is not thread safe.
+	@{
+	*/
+
+/** \brief Opaque component of the tree */
+typedef struct fmi2_import_component_t fmi2_import_component_t;
+
+/**
+	\brief Get the root component, building the tree on the first call.
+	\param fmu An fmu object as returned by fmi2_import_parse_xml().
+	\return The root component or NULL if memory allocation failed.
+*/
+FMILIB_EXPORT
+fmi2_import_component_t* fmi2_import_get_root_component(fmi2_import_t* fmu);
+
+/**
+	\brief Find a component by its path, e.g., "plant.pipe[2]". The empty path gives the root component.
+	\param fmu An fmu object as returned by fmi2_import_parse_xml().
+	\param path The path of the component.
+	\return The component or NULL if there is no such component.
+*/
+FMILIB_EXPORT
+fmi2_import_component_t* fmi2_import_find_component(fmi2_import_t* fmu, const char* path);
+
+/**
+	\brief Get the name of a component within its parent.
+	\param c A component.
+	\param len Output: the length of the name. The name is not zero terminated.
+	\return A pointer into the name of a variable of the component. The root component has an empty name.
+*/
+FMILIB_EXPORT
+const char* fmi2_import_get_component_name(fmi2_import_component_t* c, size_t* len);
+
+/**
+	\brief Get the path of a component from the root.
+	\param c A component.
+	\param len Output: the length of the path. The path is not zero terminated.
+	\return A pointer into the name of a variable of the component.
+*/
+FMILIB_EXPORT
+const char* fmi2_import_get_component_path(fmi2_import_component_t* c, size_t* len);
+
+/** \brief Get the parent of a component or NULL for the root component */
+FMILIB_EXPORT
+fmi2_import_component_t* fmi2_import_get_parent_component(fmi2_import_component_t* c);
+
+/** \brief Get the number of child components */
+FMILIB_EXPORT
+size_t fmi2_import_get_number_of_child_components(fmi2_import_component_t* c);
+
+/** \brief Get a child component by index or NULL if the index is out of range. The children are ordered by name. */
+FMILIB_EXPORT
+fmi2_import_component_t* fmi2_import_get_child_component(fmi2_import_component_t* c, size_t index);
+
+/**
+	\brief Get a child component by name with a binary search.
+	\param c A component.
+	\param name The name of the child, e.g., "pipe[2]".
+	\param len The length of the name.
+	\return The child or NULL if there is no such child.
+*/
+FMILIB_EXPORT
+fmi2_import_component_t* fmi2_import_get_child_component_by_name(fmi2_import_component_t* c, const char* name, size_t len);
+
+/**
+	\brief Get the variables that belong directly to a component, in alphabetical order.
+	\param c A component.
+	\param view Output: a view of a list that belongs to the FMU and must not be modified or freed.
+*/
+FMILIB_EXPORT
+void fmi2_import_get_component_variables(fmi2_import_component_t* c, fmi2_import_variable_list_view_t* view);
+
+/**
+	\brief Get the variables of a component and of all its descendants.
+
+	The variables of the component come first, followed by the subtrees of the children in order.
+	\param c A component.
+	\param view Output: a view of a list that belongs to the FMU and must not be modified or freed.
+*/
+FMILIB_EXPORT
+void fmi2_import_get_component_subtree_variables(fmi2_import_component_t* c, fmi2_import_variable_list_view_t* view);
+
+/**
+	\brief Get the name of a variable relative to a component, e.g., "pipe[2].T" for "plant.pipe[2].T" in "plant".
+	\param c A component.
+	\param v A variable of the subtree of the component.
+	\return A pointer into the variable name or NULL if the variable is not in the subtree.
+*/
+FMILIB_EXPORT
+const char* fmi2_import_get_variable_local_name(fmi2_import_component_t* c, fmi2_import_variable_t* v);
+
+/** @} */
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_COMPONENT_H_ */
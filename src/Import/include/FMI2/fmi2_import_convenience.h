@@ -27,6 +27,7 @@
 
 #include <FMI/fmi_import_context.h>
 #include <FMI2/fmi2_functions.h>
+#include <JM/jm_log_sink.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -92,7 +93,8 @@ void fmi2_import_collect_model_counts(fmi2_import_t* fmu, fmi2_import_model_coun
 
 /**
   \brief Print msgIn into msgOut by expanding variable references of the form #\<Type\>\<VR\># into variable names
-  and replacing '##' with a single #.
+  and replacing '##' with a single #. The message is written directly into msgOut and truncated
+  to maxMsgSize. If a reference is malformed, a warning is logged and msgOut receives msgIn unchanged.
    \param fmu - An fmu object as returned by fmi2_import_parse_xml().
    \param msgIn - Log message as produced by an FMU.
    \param msgOut - Output message buffer. 
@@ -122,6 +124,31 @@ void  fmi2_log_forwarding(fmi2_component_t c, fmi2_string_t instanceName, fmi2_s
 FMILIB_EXPORT 
 void  fmi2_log_forwarding_v(fmi2_component_t c, fmi2_string_t instanceName, fmi2_status_t status, fmi2_string_t category, fmi2_string_t message, va_list args);
 
+/**
+	\brief Deliver the log messages of an FMU asynchronously.
+
+	With a sink set, fmi2_log_forwarding() only formats the message on the calling thread and posts it
+	to the sink. The expansion of the variable references and the call of the logger in the ::jm_callbacks
+	of the FMU are done by the background thread of the sink. Messages rejected by the log level or by the
+	log filter of the FMU (see fmi2_import_set_log_filter()) are discarded before formatting, as before.
+
+	The messages of the library itself are still logged on the calling thread. The logger is therefore
+	called from the sink thread and the calling threads concurrently and must be thread safe, as must the
+	memory allocation functions of the callbacks. The sink thread expands the messages into a buffer of
+	its own and does not write the errMessageBuffer of the callbacks.
+
+	Replacing or removing the sink waits until the messages already posted have been delivered; so does
+	fmi2_import_free(). One sink may be shared by several FMUs.
+	\param fmu - An fmu object as returned by fmi2_import_parse_xml().
+	\param sink - A sink created with jm_log_sink_create() or NULL to go back to synchronous logging.
+*/
+FMILIB_EXPORT
+void fmi2_import_set_log_sink(fmi2_import_t* fmu, jm_log_sink_t* sink);
+
+/** \brief Get the log sink of an FMU or NULL if the messages are delivered synchronously */
+FMILIB_EXPORT
+jm_log_sink_t* fmi2_import_get_log_sink(fmi2_import_t* fmu);
+
 
 /** \brief  Default FMI 2.0 logger may be used when instantiating FMUs */
 FMILIB_EXPORT
@@ -0,0 +1,171 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_cosim_master.h
+*  \brief Public interface to the FMI import C-library. Parallel co-simulation master.
+*/
+
+#ifndef FMI2_IMPORT_COSIM_MASTER_H_
+#define FMI2_IMPORT_COSIM_MASTER_H_
+
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_enums.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_cosim_master Co-simulation master.
+	@}
+	\addtogroup fmi2_import_cosim_master Co-simulation master.
+	\brief Stepping of a set of coupled Co-Simulation FMUs on a thread pool.
+
+	The master owns no FMU. The user loads, instantiates and initializes the FMUs
+	(up to and including fmi2_import_exit_initialization_mode()), adds them to the
+	master and connects outputs to inputs by value reference. Inputs may also be
+	tunable parameters.
+
+	fmi2_import_cosim_master_initialize() builds a dependency graph over the FMUs from
+	the connections. Cycles are broken by delaying one connection of the cycle by one
+	communication step. The values are exchanged through buffers that are allocated
+	once, and every FMU gets and sets all its connected variables of a type with one call.
+
+	Two stepping schemes are available:
+	- ::fmi2_import_cosim_master_jacobi: all FMUs step concurrently with the inputs at
+	  the start of the step. Afterwards the outputs are propagated along the connections
+	  with direct feedthrough, in dependency order.
+	- ::fmi2_import_cosim_master_gauss_seidel: an FMU steps as soon as all FMUs it
+	  depends on have stepped, using their outputs at the end of the step. Independent
+	  FMUs step concurrently.
+
+	Scheduling is dataflow driven: a task is submitted to a work-stealing thread pool
+	(see jm_thread_pool.h) as soon as its inputs are available. The FMUs must support
+	being called from any thread, one call at a time. Note that messages logged through
+	the same jm_callbacks from several threads share its message buffer; FMUs that log
+	during fmi2DoStep should be loaded with separate callbacks.
+	@{
+	*/
+
+/** \brief Opaque master object */
+typedef struct fmi2_import_cosim_master_t fmi2_import_cosim_master_t;
+
+/** \brief Stepping scheme */
+typedef enum fmi2_import_cosim_master_scheme_enu_t {
+	fmi2_import_cosim_master_jacobi = 0,    /**< \brief All FMUs step concurrently, outputs are propagated afterwards */
+	fmi2_import_cosim_master_gauss_seidel   /**< \brief FMUs step in dependency order */
+} fmi2_import_cosim_master_scheme_enu_t;
+
+/** \brief Master settings. Use fmi2_import_cosim_master_default_options() to initialize. */
+typedef struct fmi2_import_cosim_master_options_t {
+	/** \brief Stepping scheme */
+	fmi2_import_cosim_master_scheme_enu_t scheme;
+	/** \brief Number of worker threads. 0 means one per processor. */
+	size_t num_threads;
+	/** \brief Use the output dependencies in the ModelStructure to find the connections
+		with direct feedthrough (Jacobi scheme). If zero, all connections are assumed to
+		have direct feedthrough. */
+	int use_output_dependencies;
+} fmi2_import_cosim_master_options_t;
+
+/** \brief Fill in the default settings: Jacobi scheme, one thread per processor, use output dependencies */
+FMILIB_EXPORT
+void fmi2_import_cosim_master_default_options(fmi2_import_cosim_master_options_t* options);
+
+/**
+	\brief Create a master and start its thread pool.
+	\param cb Callbacks for memory allocation and logging. Default callbacks are used if NULL.
+	\param options Settings or NULL for the defaults. The settings are copied.
+	\return A master or NULL on error. Must be freed with fmi2_import_cosim_master_free().
+*/
+FMILIB_EXPORT
+fmi2_import_cosim_master_t* fmi2_import_cosim_master_create(jm_callbacks* cb, const fmi2_import_cosim_master_options_t* options);
+
+/** \brief Stop the thread pool and free the master. The FMUs are not affected. */
+FMILIB_EXPORT
+void fmi2_import_cosim_master_free(fmi2_import_cosim_master_t* master);
+
+/**
+	\brief Add an instantiated Co-Simulation FMU.
+	\param master A master object.
+	\param fmu The FMU.
+	\param index Outputs the index of the FMU in the master, used in fmi2_import_cosim_master_connect(). May be NULL.
+	\return ::jm_status_success or ::jm_status_error.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_cosim_master_add_fmu(fmi2_import_cosim_master_t* master, fmi2_import_t* fmu, size_t* index);
+
+/**
+	\brief Connect an output of one FMU to an input of another (or the same) FMU.
+
+	Real, integer, enumeration and boolean variables can be connected.
+	An input can be connected to one output only.
+	\param master A master object.
+	\param baseType Base type of both variables.
+	\param srcFmu Index of the FMU with the output.
+	\param srcVr Value reference of the output.
+	\param dstFmu Index of the FMU with the input.
+	\param dstVr Value reference of the input or tunable parameter.
+	\return ::jm_status_success or ::jm_status_error.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_cosim_master_connect(fmi2_import_cosim_master_t* master, fmi2_base_type_enu_t baseType,
+	size_t srcFmu, fmi2_value_reference_t srcVr, size_t dstFmu, fmi2_value_reference_t dstVr);
+
+/**
+	\brief Build the schedule, allocate the buffers and propagate the initial outputs to the inputs.
+
+	Must be called after all FMUs are added and connected, and after the FMUs have left
+	initialization mode. No FMUs or connections can be added afterwards.
+	\return ::jm_status_success or ::jm_status_error.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_cosim_master_initialize(fmi2_import_cosim_master_t* master);
+
+/**
+	\brief Advance all FMUs one communication step.
+	\param master A master object.
+	\param t Current communication point.
+	\param h Communication step size.
+	\return ::jm_status_success, or ::jm_status_error if an FMU call failed.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_cosim_master_do_step(fmi2_import_cosim_master_t* master, fmi2_real_t t, fmi2_real_t h);
+
+/** \brief Get the number of FMUs */
+FMILIB_EXPORT
+size_t fmi2_import_cosim_master_get_number_of_fmus(fmi2_import_cosim_master_t* master);
+
+/** \brief Get the number of connections */
+FMILIB_EXPORT
+size_t fmi2_import_cosim_master_get_number_of_connections(fmi2_import_cosim_master_t* master);
+
+/** \brief Get the number of connections delayed by one step to break dependency cycles (after initialization) */
+FMILIB_EXPORT
+size_t fmi2_import_cosim_master_get_number_of_delayed_connections(fmi2_import_cosim_master_t* master);
+
+/** \brief Get the number of worker threads */
+FMILIB_EXPORT
+size_t fmi2_import_cosim_master_get_number_of_threads(fmi2_import_cosim_master_t* master);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_COSIM_MASTER_H_ */
@@ -0,0 +1,194 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_dependency_graph.h
+*  \brief Public interface to the FMI import C-library. Analysis of the ModelStructure dependencies.
+*/
+
+#ifndef FMI2_IMPORT_DEPENDENCY_GRAPH_H_
+#define FMI2_IMPORT_DEPENDENCY_GRAPH_H_
+
+#include <stddef.h>
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include "fmi2_import_variable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_dependency_graph Dependency graph.
+	@}
+	\addtogroup fmi2_import_dependency_graph Dependency graph.
+	\brief Graph algorithms on the dependencies of the ModelStructure.
+
+	A dependency graph has one row for every unknown of the Outputs, Derivatives, DiscreteStates
+	or InitialUnknowns element, in the order of fmi2_import_get_outputs_list() etc. The entries of a
+	row are the variables that the unknown depends on, numbered by the 0-based position of the
+	variable in the list returned by fmi2_import_get_variable_list() with sortOrder 0, not by the
+	1-based index of the XML. The position equals fmi2_import_get_variable_original_order() unless
+	variables were removed as bad aliases when the XML was parsed.
+
+	An unknown without a dependencies attribute depends on all the knowns. Such rows are not
+	expanded: they share one array of the knowns, computed when the graph is created. The knowns are
+	the inputs, the independent variable and the continuous states, and for the initial unknowns
+	also the variables with initial="exact".
+
+	An unknown depends on another unknown of the same graph when its row contains the variable of
+	the other row, or an input that is connected to it with fmi2_import_dependency_graph_connect(),
+	e.g., an output that is fed back to an input of the FMU. These edges are used by
+	fmi2_import_dependency_graph_closure(), fmi2_import_dependency_graph_components() and
+	fmi2_import_dependency_graph_order(). A cycle of such edges is an algebraic loop.
+	@{
+	*/
+
+/** \brief Opaque dependency graph */
+typedef struct fmi2_import_dependency_graph_t fmi2_import_dependency_graph_t;
+
+/** \brief The unknowns of the ModelStructure */
+typedef enum fmi2_import_dependencies_enu_t {
+	fmi2_import_outputs_dependencies,         /**< \brief ModelStructure/Outputs */
+	fmi2_import_derivatives_dependencies,     /**< \brief ModelStructure/Derivatives */
+	fmi2_import_discrete_states_dependencies, /**< \brief ModelStructure/DiscreteStates */
+	fmi2_import_initial_unknowns_dependencies /**< \brief ModelStructure/InitialUnknowns */
+} fmi2_import_dependencies_enu_t;
+
+/** \brief A sparsity pattern in row-compressed format with 0-based indices.
+
+	The entries of row r are index[start[r]] to index[start[r + 1] - 1] in increasing order.
+	The arrays are allocated with the callbacks of the FMU and must be released with
+	fmi2_import_dependency_graph_free_pattern().
+*/
+typedef struct fmi2_import_sparsity_pattern_t {
+	size_t numRows;    /**< \brief Number of rows */
+	size_t numColumns; /**< \brief Number of columns */
+	size_t* start;     /**< \brief numRows + 1 start positions, start[numRows] is the number of entries */
+	size_t* index;     /**< \brief Column index of each entry */
+} fmi2_import_sparsity_pattern_t;
+
+/**
+	\brief Create a dependency graph.
+	\param fmu An fmu object as returned by fmi2_import_parse_xml().
+	\param which The unknowns of the graph.
+	\return A graph that must be freed with fmi2_import_dependency_graph_free() or NULL if memory allocation failed.
+*/
+FMILIB_EXPORT
+fmi2_import_dependency_graph_t* fmi2_import_dependency_graph_create(fmi2_import_t* fmu, fmi2_import_dependencies_enu_t which);
+
+/** \brief Free a dependency graph */
+FMILIB_EXPORT
+void fmi2_import_dependency_graph_free(fmi2_import_dependency_graph_t* g);
+
+/** \brief Get the number of rows, i.e., unknowns */
+FMILIB_EXPORT
+size_t fmi2_import_dependency_graph_get_size(fmi2_import_dependency_graph_t* g);
+
+/** \brief Get the number of variables of the model, i.e., the number of columns */
+FMILIB_EXPORT
+size_t fmi2_import_dependency_graph_get_number_of_variables(fmi2_import_dependency_graph_t* g);
+
+/** \brief Get the unknown of a row or NULL if the row is out of range */
+FMILIB_EXPORT
+fmi2_import_variable_t* fmi2_import_dependency_graph_get_unknown(fmi2_import_dependency_graph_t* g, size_t row);
+
+/** \brief Get the row of an unknown or (size_t)-1 if the variable is not an unknown of the graph */
+FMILIB_EXPORT
+size_t fmi2_import_dependency_graph_get_row(fmi2_import_dependency_graph_t* g, fmi2_import_variable_t* v);
+
+/**
+	\brief Connect an unknown to an input, so that the unknowns that depend on the input also depend on the unknown.
+	\param g A dependency graph.
+	\param source An unknown of the graph, e.g., an output.
+	\param input The variable that receives the value of the source. It must not be an unknown of the graph.
+	\return ::jm_status_error if the variables cannot be connected.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_dependency_graph_connect(fmi2_import_dependency_graph_t* g, fmi2_import_variable_t* source, fmi2_import_variable_t* input);
+
+/** \brief Check if an unknown depends on all the knowns, i.e., has no dependencies attribute */
+FMILIB_EXPORT
+int fmi2_import_dependency_graph_depends_on_all(fmi2_import_dependency_graph_t* g, size_t row);
+
+/**
+	\brief Get the dependencies of an unknown.
+	\param g A dependency graph.
+	\param row The row of the unknown.
+	\param index Output: the 0-based variable indices. For unknowns that depend on all the knowns this is the shared array of the knowns.
+	\param factorKind Output (may be NULL): the ::fmi2_dependency_factor_kind_enu_t of each dependency.
+	\return The number of dependencies, 0 if the row is out of range.
+*/
+FMILIB_EXPORT
+size_t fmi2_import_dependency_graph_get_dependencies(fmi2_import_dependency_graph_t* g, size_t row, const size_t** index, const char** factorKind);
+
+/**
+	\brief Transpose the graph: for every variable, the rows that depend on it.
+	\param g A dependency graph.
+	\param csc Output: a pattern with one row per variable and one column per unknown.
+	\return ::jm_status_error if memory allocation failed.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_dependency_graph_transpose(fmi2_import_dependency_graph_t* g, fmi2_import_sparsity_pattern_t* csc);
+
+/**
+	\brief Compute the transitive closure: for every unknown, the variables that it depends on directly
+	or through other unknowns of the graph.
+	\param g A dependency graph.
+	\param closure Output: a pattern with one row per unknown and one column per variable.
+	\return ::jm_status_error if memory allocation failed.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_dependency_graph_closure(fmi2_import_dependency_graph_t* g, fmi2_import_sparsity_pattern_t* closure);
+
+/**
+	\brief Find the strongly connected components of the unknowns.
+
+	The components are numbered so that an unknown only depends on unknowns of the same or of lower
+	numbered components. A component with more than one unknown, or an unknown that depends on its own
+	variable, is an algebraic loop.
+	\param g A dependency graph.
+	\param component Output: array with fmi2_import_dependency_graph_get_size() elements, the component of each row.
+	\param numLoops Output (may be NULL): the number of components that are algebraic loops.
+	\return The number of components or (size_t)-1 if memory allocation failed.
+*/
+FMILIB_EXPORT
+size_t fmi2_import_dependency_graph_components(fmi2_import_dependency_graph_t* g, size_t* component, size_t* numLoops);
+
+/**
+	\brief Order the unknowns that are affected by a set of variables, e.g., the outputs to evaluate after setting some inputs.
+
+	An unknown is affected if it depends on one of the variables, directly or through other unknowns.
+	Every unknown comes after the unknowns it depends on. The unknowns of an algebraic loop are adjacent.
+	\param g A dependency graph.
+	\param variables The 0-based indices of the variables, or NULL for all the unknowns.
+	\param numVariables The number of variables.
+	\param order Output: array with fmi2_import_dependency_graph_get_size() elements, the rows of the affected unknowns.
+	\param numOrdered Output: the number of rows written to order.
+	\return ::jm_status_warning if the ordered unknowns contain an algebraic loop, ::jm_status_error if memory allocation failed.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_dependency_graph_order(fmi2_import_dependency_graph_t* g, const size_t* variables, size_t numVariables, size_t* order, size_t* numOrdered);
+
+/** \brief Release the arrays of a pattern created by fmi2_import_dependency_graph_transpose() or fmi2_import_dependency_graph_closure() */
+FMILIB_EXPORT
+void fmi2_import_dependency_graph_free_pattern(fmi2_import_dependency_graph_t* g, fmi2_import_sparsity_pattern_t* pattern);
+
+/** @} */
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_DEPENDENCY_GRAPH_H_ */
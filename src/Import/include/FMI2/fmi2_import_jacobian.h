@@ -0,0 +1,132 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_jacobian.h
+*  \brief Public interface to the FMI import C-library. Sparse state Jacobian.
+*/
+
+#ifndef FMI2_IMPORT_JACOBIAN_H_
+#define FMI2_IMPORT_JACOBIAN_H_
+
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_jacobian Sparse state Jacobian.
+	@}
+	\addtogroup fmi2_import_jacobian Sparse state Jacobian.
+	\brief Evaluation of the Jacobian of the state derivatives with respect to the states.
+
+	The sparsity pattern is taken from the Derivatives element of the ModelStructure.
+	Unknowns without dependency information are treated as dense rows. The columns
+	are partitioned into groups (colors) of structurally orthogonal columns, so that
+	one directional derivative or one finite difference evaluation gives all columns
+	of a group.
+
+	Rows and columns are numbered by the position of the derivative in
+	fmi2_import_get_derivatives_list(), i.e., in the order of the continuous states.
+	@{
+	*/
+
+/** \brief Opaque Jacobian object */
+typedef struct fmi2_import_jacobian_t fmi2_import_jacobian_t;
+
+/** \brief Evaluation method of the Jacobian */
+typedef enum fmi2_import_jacobian_method_enu_t {
+	fmi2_import_jacobian_method_auto = 0,          /**< \brief Directional derivatives if provided by the FMU, otherwise finite differences */
+	fmi2_import_jacobian_method_directional,       /**< \brief fmi2GetDirectionalDerivative, one call per color */
+	fmi2_import_jacobian_method_finite_differences /**< \brief Forward differences, one fmi2GetDerivatives call per color */
+} fmi2_import_jacobian_method_enu_t;
+
+/**
+	\brief Create a Jacobian object: build the sparsity pattern and compute the column coloring.
+	\param fmu An fmu object as returned by fmi2_import_parse_xml() with a loaded Model Exchange DLL.
+	\param method Evaluation method.
+	\return A Jacobian object or NULL on error. Must be freed with fmi2_import_jacobian_free().
+*/
+FMILIB_EXPORT
+fmi2_import_jacobian_t* fmi2_import_jacobian_create(fmi2_import_t* fmu, fmi2_import_jacobian_method_enu_t method);
+
+/** \brief Free a Jacobian object */
+FMILIB_EXPORT
+void fmi2_import_jacobian_free(fmi2_import_jacobian_t* jac);
+
+/**
+	\brief Evaluate the Jacobian at the current point of the FMU.
+
+	The FMU must be in continuous time mode. With finite differences the states are
+	perturbed and restored before the function returns.
+	\param jac A Jacobian object.
+	\param x The current states or NULL to retrieve them from the FMU (finite differences only).
+	\param dx The derivatives at x or NULL to evaluate them (finite differences only).
+	\return ::jm_status_success or ::jm_status_error.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_jacobian_evaluate(fmi2_import_jacobian_t* jac, const fmi2_real_t* x, const fmi2_real_t* dx);
+
+/** \brief Get the number of rows and columns (number of continuous states) */
+FMILIB_EXPORT
+size_t fmi2_import_jacobian_get_dimension(fmi2_import_jacobian_t* jac);
+
+/** \brief Get the number of structural non-zeros */
+FMILIB_EXPORT
+size_t fmi2_import_jacobian_get_nnz(fmi2_import_jacobian_t* jac);
+
+/** \brief Get the number of column groups, i.e., the number of FMU calls per evaluation */
+FMILIB_EXPORT
+size_t fmi2_import_jacobian_get_number_of_colors(fmi2_import_jacobian_t* jac);
+
+/** \brief Get the color of every column. The array has fmi2_import_jacobian_get_dimension() elements. */
+FMILIB_EXPORT
+const size_t* fmi2_import_jacobian_get_colors(fmi2_import_jacobian_t* jac);
+
+/** \brief Get the method actually used for evaluation */
+FMILIB_EXPORT
+fmi2_import_jacobian_method_enu_t fmi2_import_jacobian_get_method(fmi2_import_jacobian_t* jac);
+
+/**
+	\brief Get the Jacobian in compressed sparse row format.
+
+	The arrays are owned by the Jacobian object. The pattern does not change between
+	evaluations; the values are updated in place by fmi2_import_jacobian_evaluate().
+	Column indices are 0-based and sorted within each row.
+	\param jac A Jacobian object.
+	\param rowStart Outputs a pointer to an array of dimension+1 row start offsets.
+	\param colIndex Outputs a pointer to the column indices.
+	\param values Outputs a pointer to the values.
+*/
+FMILIB_EXPORT
+void fmi2_import_jacobian_get_csr(fmi2_import_jacobian_t* jac, const size_t** rowStart, const size_t** colIndex, const fmi2_real_t** values);
+
+/**
+	\brief Get the Jacobian in compressed sparse column format.
+
+	Same as fmi2_import_jacobian_get_csr() but column-wise. Row indices are sorted within each column.
+*/
+FMILIB_EXPORT
+void fmi2_import_jacobian_get_csc(fmi2_import_jacobian_t* jac, const size_t** colStart, const size_t** rowIndex, const fmi2_real_t** values);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_JACOBIAN_H_ */
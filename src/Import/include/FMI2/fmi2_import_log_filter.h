@@ -0,0 +1,171 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_log_filter.h
+*  \brief Public interface to the FMI import C-library. Filtering of FMU log messages.
+*/
+
+#ifndef FMI2_IMPORT_LOG_FILTER_H_
+#define FMI2_IMPORT_LOG_FILTER_H_
+
+#include <stddef.h>
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_functions.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_log_filter Filtering of FMU log messages.
+	@}
+	\addtogroup fmi2_import_log_filter Filtering of FMU log messages.
+	\brief Drop FMU log messages before they are formatted.
+
+	A filter attached to an FMU with fmi2_import_set_log_filter() is evaluated by
+	fmi2_log_forwarding() before the message is formatted and the variable references
+	are expanded. A rejected message thereby costs a hash lookup of its
+	(instance name, category) pair.
+
+	The filter is configured with rules. A rule applies to an instance name and a
+	category, either of which may be NULL to match any value. A rule may set
+	- a log level that replaces the log level of the ::jm_callbacks of the FMU,
+	- a token bucket rate limit, and
+	- sampling: the first N messages pass, then every Nth.
+
+	Each of the three settings is taken from the most specific rule that sets it: a rule
+	for both the instance and the category, then a rule for the instance, then a rule
+	for the category, then a rule for any instance and category. The sampling counters
+	and the token buckets are kept per (instance name, category) pair and are reset
+	when the rules are changed. A filter may be shared by several FMUs and threads.
+	@{
+	*/
+
+/** \brief Opaque log filter */
+typedef struct fmi2_import_log_filter_t fmi2_import_log_filter_t;
+
+/** \brief Counters of a log filter */
+typedef struct fmi2_import_log_filter_statistics_t {
+	/** \brief Messages that passed the filter */
+	size_t passed;
+	/** \brief Messages rejected because of their log level */
+	size_t rejected_level;
+	/** \brief Messages rejected by the sampling */
+	size_t rejected_sampling;
+	/** \brief Messages rejected by the rate limit */
+	size_t rejected_rate;
+} fmi2_import_log_filter_statistics_t;
+
+/**
+	\brief Create an empty log filter. Without rules, the filter only applies the log level of the callbacks.
+	\param cb Callbacks for memory allocation and logging. Default callbacks are used if NULL.
+	\return A filter or NULL on error. Must be freed with fmi2_import_log_filter_free().
+*/
+FMILIB_EXPORT
+fmi2_import_log_filter_t* fmi2_import_log_filter_create(jm_callbacks* cb);
+
+/** \brief Free a log filter. It must not be attached to any FMU. */
+FMILIB_EXPORT
+void fmi2_import_log_filter_free(fmi2_import_log_filter_t* filter);
+
+/**
+	\brief Set the log level of the messages of an instance and category.
+	\param filter The filter.
+	\param instanceName Instance name or NULL for any instance.
+	\param category Log category or NULL for any category.
+	\param level Most verbose level that passes. ::jm_log_level_nothing rejects all the messages.
+	\return ::jm_status_error if the memory could not be allocated.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_log_filter_set_level(fmi2_import_log_filter_t* filter, const char* instanceName, const char* category, jm_log_level_enu_t level);
+
+/**
+	\brief Limit the rate of the messages of an instance and category with a token bucket.
+	\param filter The filter.
+	\param instanceName Instance name or NULL for any instance.
+	\param category Log category or NULL for any category.
+	\param messagesPerSecond Rate at which the bucket is refilled.
+	\param burst Capacity of the bucket, i.e., the number of messages that may pass at once. The bucket starts full.
+	\return ::jm_status_error if the memory could not be allocated.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_log_filter_set_rate_limit(fmi2_import_log_filter_t* filter, const char* instanceName, const char* category, double messagesPerSecond, double burst);
+
+/**
+	\brief Sample the messages of an instance and category.
+	\param filter The filter.
+	\param instanceName Instance name or NULL for any instance.
+	\param category Log category or NULL for any category.
+	\param firstN Number of messages that pass before the sampling starts.
+	\param everyNth After the first messages, every Nth message passes. 0 rejects all further messages.
+	\return ::jm_status_error if the memory could not be allocated.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_log_filter_set_sampling(fmi2_import_log_filter_t* filter, const char* instanceName, const char* category, size_t firstN, size_t everyNth);
+
+/** \brief Remove all the rules */
+FMILIB_EXPORT
+void fmi2_import_log_filter_clear(fmi2_import_log_filter_t* filter);
+
+/**
+	\brief Decide if a message passes the filter and update the counters.
+	\param filter The filter.
+	\param instanceName Instance name of the message, may be NULL.
+	\param category Category of the message, may be NULL.
+	\param level Log level of the message.
+	\param defaultLevel Level used when no rule sets one, normally the log level of the callbacks.
+	\return Non-zero if the message should be logged.
+*/
+FMILIB_EXPORT
+int fmi2_import_log_filter_accept(fmi2_import_log_filter_t* filter, const char* instanceName, const char* category,
+								  jm_log_level_enu_t level, jm_log_level_enu_t defaultLevel);
+
+/** \brief Get a copy of the counters of a filter */
+FMILIB_EXPORT
+void fmi2_import_log_filter_get_statistics(fmi2_import_log_filter_t* filter, fmi2_import_log_filter_statistics_t* stats);
+
+/**
+	\brief Attach a filter to an FMU. The filter is then used by fmi2_log_forwarding().
+	\param fmu An fmu object as returned by fmi2_import_parse_xml().
+	\param filter The filter or NULL to only apply the log level of the callbacks.
+*/
+FMILIB_EXPORT
+void fmi2_import_set_log_filter(fmi2_import_t* fmu, fmi2_import_log_filter_t* filter);
+
+/** \brief Get the filter attached to an FMU or NULL */
+FMILIB_EXPORT
+fmi2_import_log_filter_t* fmi2_import_get_log_filter(fmi2_import_t* fmu);
+
+/**
+	\brief Turn off the log categories of the model description whose messages the filter would reject anyway.
+
+	Calls fmi2SetDebugLogging with the log categories that have a level above ::jm_log_level_nothing
+	for the given instance, so that the FMU does not produce messages that are dropped by the importer.
+	If no category is rejected, debug logging is switched on for all the categories.
+	\param fmu An instantiated FMU with a filter attached.
+	\param instanceName Instance name to resolve the rules for, may be NULL.
+	\return The status of fmi2SetDebugLogging, or ::fmi2_status_ok if the FMU has no filter or declares no categories.
+*/
+FMILIB_EXPORT
+fmi2_status_t fmi2_import_apply_log_filter_categories(fmi2_import_t* fmu, const char* instanceName);
+
+/** @} */
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_LOG_FILTER_H_ */
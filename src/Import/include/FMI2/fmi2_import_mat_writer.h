@@ -0,0 +1,96 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_mat_writer.h
+*  \brief Public interface to the FMI import C-library. Result files in MATLAB v4 format.
+*/
+
+#ifndef FMI2_IMPORT_MAT_WRITER_H_
+#define FMI2_IMPORT_MAT_WRITER_H_
+
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include "fmi2_import_variable_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_mat_writer Result files for Modelica tools.
+	@}
+	\addtogroup fmi2_import_mat_writer Result files for Modelica tools.
+	\brief Stream simulation results into a MATLAB v4 file with the trajectory layout
+	used by Modelica tools.
+
+	The file contains the matrices Aclass ("Atrajectory", "1.1", "", "binTrans"), name,
+	description, dataInfo, data_1 and data_2. The first variable is "time". Constants and
+	parameters (variability constant, fixed or tunable) are stored in data_1 with their values
+	at the first and the last recorded time; changes of tunable parameters during the run are
+	not recorded. All other variables are stored in data_2, one column per recorded time.
+
+	Rows of data_2 are written as they are recorded; only the sizes in the matrix header and
+	the end time in data_1 are updated when the writer is closed. Memory use therefore does not
+	depend on the length of the run.
+
+	Aliases (variables with the same base type and value reference) share a data column.
+	Integer, enumeration and boolean values are stored as doubles; string variables are not
+	recorded. The unit of a real variable is appended to its description as " [unit]".
+	@{
+	*/
+
+/** \brief Opaque MAT file writer */
+typedef struct fmi2_import_mat_writer_t fmi2_import_mat_writer_t;
+
+/**
+	\brief Create a result file and write the variable information.
+	\param fmu The FMU to record. Its callbacks are used.
+	\param vl The variables to record. The list is not used after the call.
+	\param fileName Name of the result file. An existing file is overwritten.
+	\return A writer or NULL on error. Must be closed with fmi2_import_mat_writer_close().
+*/
+FMILIB_EXPORT
+fmi2_import_mat_writer_t* fmi2_import_mat_writer_create(fmi2_import_t* fmu, fmi2_import_variable_list_t* vl, const char* fileName);
+
+/**
+	\brief Read the current values of the variables from the FMU and append them.
+	The first call also stores the values of the parameters.
+	\param writer A MAT file writer.
+	\param time The time of the values. Must not decrease.
+	\return ::jm_status_success or ::jm_status_error.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_mat_writer_record(fmi2_import_mat_writer_t* writer, fmi2_real_t time);
+
+/**
+	\brief Complete the matrix headers, close the file and free the writer.
+	If nothing was recorded, data_1 and data_2 are written without columns. The FMU is not accessed.
+	\return ::jm_status_success or ::jm_status_error if writing the file failed at any point.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_mat_writer_close(fmi2_import_mat_writer_t* writer);
+
+/** \brief Get the number of recorded time points */
+FMILIB_EXPORT
+size_t fmi2_import_mat_writer_get_number_of_rows(fmi2_import_mat_writer_t* writer);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_MAT_WRITER_H_ */
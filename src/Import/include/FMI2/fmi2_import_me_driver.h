@@ -0,0 +1,218 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_me_driver.h
+*  \brief Public interface to the FMI import C-library. Model Exchange integration driver.
+*
+*  The driver implements the Model Exchange event loop on top of the wrapper
+*  functions in fmi2_import_capi.h: continuous integration with a selectable
+*  explicit or implicit solver, state event localization on the event indicators, time events,
+*  step events and event iteration.
+*/
+
+#ifndef FMI2_IMPORT_ME_DRIVER_H_
+#define FMI2_IMPORT_ME_DRIVER_H_
+
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_functions.h>
+#include "fmi2_import_jacobian.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_me_driver Model Exchange integration driver.
+	@}
+	\addtogroup fmi2_import_me_driver Model Exchange integration driver.
+	\brief Integration of Model Exchange FMUs with explicit and implicit solvers and event handling.
+
+	The implicit BDF solver builds the iteration matrix from the sparse state Jacobian
+	(see \ref fmi2_import_jacobian) and factors it with a sparse LU decomposition, so
+	the cost per step grows with the number of structural non-zeros rather than with
+	the square of the number of states.
+
+	Typical usage:
+	- instantiate the FMU, set parameters, call fmi2_import_setup_experiment(),
+	  fmi2_import_enter_initialization_mode() and fmi2_import_exit_initialization_mode();
+	- create the driver with fmi2_import_me_driver_create();
+	- call fmi2_import_me_driver_initialize() once (performs the initial event iteration);
+	- call fmi2_import_me_driver_advance() any number of times;
+	- free the driver and terminate the FMU.
+
+	All work arrays are allocated by fmi2_import_me_driver_create(). The integration
+	loop itself does not allocate memory.
+	@{
+	*/
+
+/** \brief Opaque driver object */
+typedef struct fmi2_import_me_driver_t fmi2_import_me_driver_t;
+
+/** \brief Integration methods supported by the driver */
+typedef enum fmi2_import_me_solver_enu_t {
+	fmi2_import_me_solver_euler = 0,  /**< \brief Explicit Euler, fixed step */
+	fmi2_import_me_solver_rk4,        /**< \brief Classical 4th order Runge-Kutta, fixed step */
+	fmi2_import_me_solver_dopri5,     /**< \brief Dormand-Prince 5(4) with adaptive step size control */
+	fmi2_import_me_solver_bdf         /**< \brief Variable order (1-5) BDF with adaptive step size control, for stiff models */
+} fmi2_import_me_solver_enu_t;
+
+/**
+	\brief Callback invoked after every accepted integrator step and after every event.
+
+	The current time and states are available via fmi2_import_me_driver_get_time() and
+	fmi2_import_me_driver_get_states(). The FMU is in continuous time mode at the
+	reported point, so outputs may be retrieved with the fmi2_import_get_xxx functions.
+	\param driver The driver that invokes the callback.
+	\param isEvent Non-zero if the call is made right after event handling.
+	\param userData The pointer given in ::fmi2_import_me_driver_options_t.
+	\return Non-zero to stop the integration. fmi2_import_me_driver_advance() then returns ::jm_status_warning.
+		If the step ends at an event, the event is handled and reported before the driver returns.
+*/
+typedef int (*fmi2_import_me_step_callback_ft)(fmi2_import_me_driver_t* driver, int isEvent, void* userData);
+
+/** \brief Driver settings. Use fmi2_import_me_driver_default_options() to initialize. */
+typedef struct fmi2_import_me_driver_options_t {
+	/** \brief Integration method */
+	fmi2_import_me_solver_enu_t solver;
+	/** \brief Step size for the fixed step solvers. Initial step size for dopri5 and bdf (0 means automatic). */
+	fmi2_real_t step_size;
+	/** \brief Relative tolerance (dopri5, bdf) */
+	fmi2_real_t relative_tolerance;
+	/** \brief Absolute tolerance (dopri5, bdf). Scaled by the nominal values of the states. */
+	fmi2_real_t absolute_tolerance;
+	/** \brief Minimum step size (dopri5, bdf). The integration fails if the step size drops below. */
+	fmi2_real_t min_step_size;
+	/** \brief Maximum step size (dopri5, bdf). 0 means no limit. */
+	fmi2_real_t max_step_size;
+	/** \brief Width of the time interval that brackets a located state event */
+	fmi2_real_t event_tolerance;
+	/** \brief Maximum number of fmi2NewDiscreteStates calls in one event iteration */
+	unsigned int max_event_iterations;
+	/** \brief Evaluation of the state Jacobian for the Newton iteration (bdf) */
+	fmi2_import_jacobian_method_enu_t jacobian_method;
+	/** \brief Optional step callback */
+	fmi2_import_me_step_callback_ft step_callback;
+	/** \brief User data passed to the step callback */
+	void* step_callback_data;
+} fmi2_import_me_driver_options_t;
+
+/** \brief Integration statistics */
+typedef struct fmi2_import_me_driver_statistics_t {
+	/** \brief Number of accepted steps */
+	size_t num_steps;
+	/** \brief Number of rejected steps (dopri5, bdf) */
+	size_t num_rejected_steps;
+	/** \brief Number of fmi2GetDerivatives calls */
+	size_t num_derivative_evaluations;
+	/** \brief Number of fmi2GetEventIndicators calls */
+	size_t num_event_indicator_evaluations;
+	/** \brief Number of located state events */
+	size_t num_state_events;
+	/** \brief Number of time events */
+	size_t num_time_events;
+	/** \brief Number of step events requested by fmi2CompletedIntegratorStep */
+	size_t num_step_events;
+	/** \brief Total number of fmi2NewDiscreteStates calls */
+	size_t num_event_iterations;
+	/** \brief Number of Jacobian evaluations (bdf) */
+	size_t num_jacobian_evaluations;
+	/** \brief Number of LU factorizations of the iteration matrix (bdf) */
+	size_t num_factorizations;
+	/** \brief Number of Newton iterations (bdf) */
+	size_t num_newton_iterations;
+	/** \brief Number of Newton iterations that failed to converge (bdf) */
+	size_t num_newton_failures;
+} fmi2_import_me_driver_statistics_t;
+
+/**
+	\brief Fill in the default driver settings: dopri5, relative and absolute tolerance 1e-6,
+	event tolerance 1e-10 and at most 100 event iterations.
+	\param options Settings struct to initialize.
+*/
+FMILIB_EXPORT
+void fmi2_import_me_driver_default_options(fmi2_import_me_driver_options_t* options);
+
+/**
+	\brief Create an integration driver for an instantiated Model Exchange FMU.
+
+	The work arrays are sized from the number of continuous states and event indicators
+	in the model description.
+	\param fmu An fmu object as returned by fmi2_import_parse_xml() with a loaded and instantiated DLL.
+	\param options Driver settings. If NULL the defaults are used. The settings are copied.
+	\return A driver object or NULL on error. The object must be freed with fmi2_import_me_driver_free().
+*/
+FMILIB_EXPORT
+fmi2_import_me_driver_t* fmi2_import_me_driver_create(fmi2_import_t* fmu, const fmi2_import_me_driver_options_t* options);
+
+/**
+	\brief Free a driver object. The FMU instance is not affected.
+	\param driver A driver object or NULL.
+*/
+FMILIB_EXPORT
+void fmi2_import_me_driver_free(fmi2_import_me_driver_t* driver);
+
+/**
+	\brief Perform the initial event iteration and enter continuous time mode.
+
+	Must be called once, after fmi2_import_exit_initialization_mode().
+	\param driver A driver object.
+	\param tstart Start time of the simulation.
+	\return ::jm_status_success or ::jm_status_error.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_me_driver_initialize(fmi2_import_me_driver_t* driver, fmi2_real_t tstart);
+
+/**
+	\brief Integrate the FMU up to the given time.
+
+	The function returns when tend is reached, the FMU requests termination
+	(see fmi2_import_me_driver_is_terminated()) or the step callback stops the integration.
+	\param driver A driver object.
+	\param tend Time to integrate to.
+	\return ::jm_status_success, ::jm_status_warning if stopped by the step callback,
+	or ::jm_status_error on failure.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_me_driver_advance(fmi2_import_me_driver_t* driver, fmi2_real_t tend);
+
+/** \brief Get the current simulation time */
+FMILIB_EXPORT
+fmi2_real_t fmi2_import_me_driver_get_time(fmi2_import_me_driver_t* driver);
+
+/** \brief Get the current continuous states. The array is owned by the driver. */
+FMILIB_EXPORT
+const fmi2_real_t* fmi2_import_me_driver_get_states(fmi2_import_me_driver_t* driver);
+
+/** \brief Get the state derivatives at the current time. The array is owned by the driver. */
+FMILIB_EXPORT
+const fmi2_real_t* fmi2_import_me_driver_get_derivatives(fmi2_import_me_driver_t* driver);
+
+/** \brief Check if the FMU has requested termination of the simulation */
+FMILIB_EXPORT
+int fmi2_import_me_driver_is_terminated(fmi2_import_me_driver_t* driver);
+
+/** \brief Get the integration statistics collected since fmi2_import_me_driver_initialize() */
+FMILIB_EXPORT
+const fmi2_import_me_driver_statistics_t* fmi2_import_me_driver_get_statistics(fmi2_import_me_driver_t* driver);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_ME_DRIVER_H_ */
@@ -0,0 +1,122 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_result_writer.h
+*  \brief Public interface to the FMI import C-library. Binary columnar result files.
+*/
+
+#ifndef FMI2_IMPORT_RESULT_WRITER_H_
+#define FMI2_IMPORT_RESULT_WRITER_H_
+
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include "fmi2_import_variable_list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_result_writer Recording of simulation results.
+	@}
+	\addtogroup fmi2_import_result_writer Recording of simulation results.
+	\brief Append the values of a list of variables to a binary columnar file.
+
+	The writer reads the values of the variables from the FMU with one fmi2GetXXX call
+	per base type and stores them row by row into a chunk buffer. Full chunks are handed
+	to a background thread that optionally compresses every column with zlib and writes
+	the chunk with a few large writes. Recording only blocks if all chunk buffers wait
+	for the disk.
+
+	Variables with the same base type and value reference (aliases) share one column.
+	String variables are not recorded.
+
+	File format. Integers in the headers are unsigned 32-bit little endian. Values are
+	stored in the byte order of the writing machine, given in the file header.
+	- File header: the 8 characters "FMIRES01", format version (1), little endian flag
+	  (1 if the values are little endian), number of columns C, number of variables V and
+	  the maximum number of rows per chunk.
+	- C column descriptions: base type (::fmi2_base_type_enu_t) and value reference.
+	  Real columns hold 8-byte doubles, integer and boolean columns 4-byte integers.
+	  Enumerations are recorded in integer columns.
+	- V variable descriptions: column index, then the name, the unit (empty if none) and the
+	  description, each as a length followed by the characters without terminating zero.
+	- Chunks until the end of the file: the 4 characters "CHNK", number of rows N and
+	  C + 1 column blocks, time (8-byte doubles) first. A column block is its decoded size,
+	  its stored size and the stored data. If the sizes differ the data is zlib compressed.
+	@{
+	*/
+
+/** \brief Opaque result writer */
+typedef struct fmi2_import_result_writer_t fmi2_import_result_writer_t;
+
+/** \brief Result writer settings. Use fmi2_import_result_writer_default_options() to initialize. */
+typedef struct fmi2_import_result_writer_options_t {
+	/** \brief Number of rows per chunk */
+	size_t rows_per_chunk;
+	/** \brief Number of chunk buffers, at least 2 */
+	size_t num_buffers;
+	/** \brief zlib compression level of the columns, 0 (no compression) to 9 */
+	int compression_level;
+} fmi2_import_result_writer_options_t;
+
+/** \brief Fill in the default settings: 4096 rows per chunk, 4 buffers, no compression */
+FMILIB_EXPORT
+void fmi2_import_result_writer_default_options(fmi2_import_result_writer_options_t* options);
+
+/**
+	\brief Create a result file and write its header.
+	\param fmu The FMU to record. Its callbacks are used.
+	\param vl The variables to record. The list is not used after the call.
+	\param fileName Name of the result file. An existing file is overwritten.
+	\param options Settings or NULL for the defaults.
+	\return A writer or NULL on error. Must be closed with fmi2_import_result_writer_close().
+*/
+FMILIB_EXPORT
+fmi2_import_result_writer_t* fmi2_import_result_writer_create(fmi2_import_t* fmu, fmi2_import_variable_list_t* vl,
+	const char* fileName, const fmi2_import_result_writer_options_t* options);
+
+/**
+	\brief Read the current values of the variables from the FMU and append them as a row.
+	\param writer A result writer.
+	\param time The time of the row.
+	\return ::jm_status_success or ::jm_status_error if getting the values or writing failed.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_result_writer_record(fmi2_import_result_writer_t* writer, fmi2_real_t time);
+
+/**
+	\brief Write the buffered rows, close the file and free the writer.
+	\return ::jm_status_success or ::jm_status_error if writing the file failed at any point.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_result_writer_close(fmi2_import_result_writer_t* writer);
+
+/** \brief Get the number of columns, excluding time */
+FMILIB_EXPORT
+size_t fmi2_import_result_writer_get_number_of_columns(fmi2_import_result_writer_t* writer);
+
+/** \brief Get the number of recorded rows */
+FMILIB_EXPORT
+size_t fmi2_import_result_writer_get_number_of_rows(fmi2_import_result_writer_t* writer);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_RESULT_WRITER_H_ */
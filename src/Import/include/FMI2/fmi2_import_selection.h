@@ -0,0 +1,257 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_selection.h
+*  \brief Public interface to the FMI import C-library. Bitset based variable selections.
+*/
+
+#ifndef FMI2_IMPORT_SELECTION_H_
+#define FMI2_IMPORT_SELECTION_H_
+
+#include <stddef.h>
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+#include <FMI2/fmi2_enums.h>
+#include "fmi2_import_variable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_selection Bitset based variable selections
+	@}
+	\addtogroup fmi2_import_selection Bitset based variable selections
+	\brief Sets of model variables with one bit per variable.
+
+	A selection has one bit for every variable of the model description, indexed by the
+	position of the variable in the original order (see fmi2_import_get_variable_list() with sortOrder 0).
+	Selections are combined word by word with AND, OR and AND NOT, so a query with several
+	criteria costs a few passes over n/8 bytes instead of one filtered variable list per criterion.
+
+	Masks for the causality, variability, initial, base type, alias kind, start value and
+	model structure role of the variables are computed when the model description is parsed.
+	The masks belong to the FMU and are read-only; clone one with fmi2_import_clone_selection()
+	to start a query, e.g., outputs that are continuous and not aliases:
+	\code
+	fmi2_import_selection_t* s = fmi2_import_clone_selection(fmi2_import_get_causality_mask(fmu, fmi2_causality_enu_output));
+	fmi2_import_selection_and(s, fmi2_import_get_variability_mask(fmu, fmi2_variability_enu_continuous));
+	fmi2_import_selection_and(s, fmi2_import_get_alias_kind_mask(fmu, fmi2_variable_is_not_alias));
+	\endcode
+	@{
+	*/
+
+/** \brief Opaque variable selection */
+typedef struct fmi2_import_selection_t fmi2_import_selection_t;
+
+/** \brief Roles of variables in the model structure */
+typedef enum fmi2_import_variable_role_enu_t {
+	fmi2_import_variable_role_state,           /**< \brief A continuous state, i.e., referenced by the derivativeOf attribute of a derivative */
+	fmi2_import_variable_role_derivative,      /**< \brief Listed in ModelStructure/Derivatives */
+	fmi2_import_variable_role_discrete_state,  /**< \brief Listed in ModelStructure/DiscreteStates */
+	fmi2_import_variable_role_output,          /**< \brief Listed in ModelStructure/Outputs */
+	fmi2_import_variable_role_initial_unknown  /**< \brief Listed in ModelStructure/InitialUnknowns */
+} fmi2_import_variable_role_enu_t;
+
+/** \brief Orders of the variables produced from a selection */
+typedef enum fmi2_import_selection_order_enu_t {
+	fmi2_import_selection_original_order, /**< \brief Order of the model description */
+	fmi2_import_selection_vr_order        /**< \brief By base type and value reference, aliases in the original order */
+} fmi2_import_selection_order_enu_t;
+
+/**
+	\brief Create a selection.
+	\param fmu An fmu object as returned by fmi2_import_parse_xml().
+	\param all Non-zero to select all the variables, zero for an empty selection.
+	\return A selection that must be freed with fmi2_import_free_selection() or NULL on error.
+*/
+FMILIB_EXPORT
+fmi2_import_selection_t* fmi2_import_create_selection(fmi2_import_t* fmu, int all);
+
+/** \brief Make a modifiable copy of a selection or a mask. NULL is returned if s is NULL or memory allocation failed. */
+FMILIB_EXPORT
+fmi2_import_selection_t* fmi2_import_clone_selection(const fmi2_import_selection_t* s);
+
+/** \brief Free a selection created by fmi2_import_create_selection() or fmi2_import_clone_selection() */
+FMILIB_EXPORT
+void fmi2_import_free_selection(fmi2_import_selection_t* s);
+
+/** \name Predefined masks. NULL is returned for values that are out of range.
+@{
+*/
+/** \brief Variables with the given causality */
+FMILIB_EXPORT
+const fmi2_import_selection_t* fmi2_import_get_causality_mask(fmi2_import_t* fmu, fmi2_causality_enu_t causality);
+
+/** \brief Variables with the given variability */
+FMILIB_EXPORT
+const fmi2_import_selection_t* fmi2_import_get_variability_mask(fmi2_import_t* fmu, fmi2_variability_enu_t variability);
+
+/** \brief Variables with the given initial attribute, as returned by fmi2_import_get_initial() */
+FMILIB_EXPORT
+const fmi2_import_selection_t* fmi2_import_get_initial_mask(fmi2_import_t* fmu, fmi2_initial_enu_t initial);
+
+/** \brief Variables of the given base type */
+FMILIB_EXPORT
+const fmi2_import_selection_t* fmi2_import_get_base_type_mask(fmi2_import_t* fmu, fmi2_base_type_enu_t baseType);
+
+/** \brief Variables of the given alias kind */
+FMILIB_EXPORT
+const fmi2_import_selection_t* fmi2_import_get_alias_kind_mask(fmi2_import_t* fmu, fmi2_variable_alias_kind_enu_t aliasKind);
+
+/** \brief Variables with a start value */
+FMILIB_EXPORT
+const fmi2_import_selection_t* fmi2_import_get_has_start_mask(fmi2_import_t* fmu);
+
+/** \brief Variables with the given role in the model structure */
+FMILIB_EXPORT
+const fmi2_import_selection_t* fmi2_import_get_role_mask(fmi2_import_t* fmu, fmi2_import_variable_role_enu_t role);
+/** @} */
+
+/** \name Set operations. Both selections must belong to the same FMU, ::jm_status_error is returned otherwise.
+@{
+*/
+/** \brief Keep the variables of s that are also in other */
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_selection_and(fmi2_import_selection_t* s, const fmi2_import_selection_t* other);
+
+/** \brief Add the variables of other to s */
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_selection_or(fmi2_import_selection_t* s, const fmi2_import_selection_t* other);
+
+/** \brief Remove the variables of other from s */
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_selection_andnot(fmi2_import_selection_t* s, const fmi2_import_selection_t* other);
+/** @} */
+
+/** \brief Select the variables that are not selected and deselect the others */
+FMILIB_EXPORT
+void fmi2_import_selection_invert(fmi2_import_selection_t* s);
+
+/** \brief Get the number of selected variables */
+FMILIB_EXPORT
+size_t fmi2_import_selection_count(const fmi2_import_selection_t* s);
+
+/** \brief Check if a variable is selected */
+FMILIB_EXPORT
+int fmi2_import_selection_contains(const fmi2_import_selection_t* s, fmi2_import_variable_t* v);
+
+/** \brief Select a variable. ::jm_status_error is returned if the variable is not in the model description of the selection. */
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_selection_add(fmi2_import_selection_t* s, fmi2_import_variable_t* v);
+
+/** \brief Deselect a variable. ::jm_status_error is returned if the variable is not in the model description of the selection. */
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_selection_remove(fmi2_import_selection_t* s, fmi2_import_variable_t* v);
+
+/** \brief Select all the variables of a list */
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_selection_add_list(fmi2_import_selection_t* s, fmi2_import_variable_list_t* vl);
+
+/**
+	\brief Create a variable list with the selected variables.
+	\param s A selection.
+	\param order Order of the variables in the list.
+	\return A variable list that must be freed with fmi2_import_free_variable_list() or NULL if memory allocation failed.
+*/
+FMILIB_EXPORT
+fmi2_import_variable_list_t* fmi2_import_selection_to_variable_list(const fmi2_import_selection_t* s, fmi2_import_selection_order_enu_t order);
+
+/**
+	\brief Get the value references of the selected variables.
+
+	Aliases of a selected variable give repeated value references unless they are
+	removed with the ::fmi2_variable_is_not_alias mask.
+	\param s A selection.
+	\param order Order of the value references.
+	\param vrs Output array with at least fmi2_import_selection_count() elements.
+	\return ::jm_status_error if memory allocation failed.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_selection_get_value_references(const fmi2_import_selection_t* s, fmi2_import_selection_order_enu_t order, fmi2_value_reference_t* vrs);
+
+/** \name Variable queries
+	A query is a boolean expression of attribute tests:
+\verbatim
+	query = test | '(' query ')' | query 'and' query | query 'or' query | 'not' query | <empty>
+	test  = attribute ('=' | '!=') value | 'hasStart' | 'isAlias'
+\endverbatim
+	The attributes are name, quantity, type (declared type), unit, displayUnit, basetype,
+	causality, variability, initial, hasStart, isAlias and alias (a variable name, selects the
+	variable and its aliases). Attribute names, enumeration values and the operators 'and', 'or'
+	and 'not' are case insensitive; '&&', '||' and '!' may be used instead of the operators.
+	String values are quoted with ' or " or written without quotes if they contain no spaces,
+	parentheses or operator characters. They are compared exactly unless they contain the wildcards
+	'*' or '?'. Names are matched as in fmi2_import_get_variables_by_name_pattern().
+	An empty query selects all the variables. Example:
+\code
+	fmi2_import_variable_list_t* vl = fmi2_import_query_variables(fmu, "causality=output and basetype=real and not isAlias");
+\endcode
+	A query is compiled into a postfix program once. The tests on causality, variability, initial,
+	base type, alias kind and start value use the predefined masks, the others are evaluated
+	variable by variable, and the results are combined word by word. Compile a query once with
+	fmi2_import_compile_query() when it is evaluated repeatedly.
+@{
+*/
+/** \brief Compiled variable query */
+typedef struct fmi2_xml_query_t fmi2_import_query_t;
+
+/**
+	\brief Compile a variable query.
+	\param fmu An fmu object as returned by fmi2_import_parse_xml().
+	\param query The query string.
+	\return A compiled query that must be freed with fmi2_import_free_query() or NULL if the query has a syntax error (logged).
+*/
+FMILIB_EXPORT
+fmi2_import_query_t* fmi2_import_compile_query(fmi2_import_t* fmu, const char* query);
+
+/** \brief Free a compiled query */
+FMILIB_EXPORT
+void fmi2_import_free_query(fmi2_import_query_t* q);
+
+/** \brief Check if a variable matches a compiled query */
+FMILIB_EXPORT
+int fmi2_import_query_match(fmi2_import_query_t* q, fmi2_import_variable_t* v);
+
+/**
+	\brief Select the variables that match a compiled query.
+
+	The previous content of the selection is replaced. A compiled query must not be evaluated
+	by several threads at the same time.
+	\param q A query compiled for the FMU of the selection.
+	\param s The selection.
+	\return ::jm_status_error if the query was compiled for another FMU or memory allocation failed.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_query_select(fmi2_import_query_t* q, fmi2_import_selection_t* s);
+
+/**
+	\brief Get the variables that match a query.
+	\param fmu An fmu object as returned by fmi2_import_parse_xml().
+	\param query The query string.
+	\return A variable list in the original order that must be freed with fmi2_import_free_variable_list(),
+		or NULL if the query has a syntax error or memory allocation failed.
+*/
+FMILIB_EXPORT
+fmi2_import_variable_list_t* fmi2_import_query_variables(fmi2_import_t* fmu, const char* query);
+/** @} */
+
+/** @} */
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_SELECTION_H_ */
@@ -0,0 +1,118 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_state_ring.h
+*  \brief Public interface to the FMI import C-library. Bounded ring of FMU state snapshots.
+*/
+
+#ifndef FMI2_IMPORT_STATE_RING_H_
+#define FMI2_IMPORT_STATE_RING_H_
+
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_state_ring FMU state snapshots.
+	@}
+	\addtogroup fmi2_import_state_ring FMU state snapshots.
+	\brief Bounded ring of FMU states for rollback.
+
+	The ring keeps the most recent snapshots of an FMU, each taken with fmi2GetFMUstate
+	and tagged with a time. When the ring is full the oldest snapshot is overwritten.
+	The fmi2FMUstate handles are never freed while the ring exists: a new snapshot passes
+	the handle of the slot it overwrites back to fmi2GetFMUstate, which the FMU updates in
+	place. After a warm-up, taking snapshots and rolling back does not allocate memory.
+
+	The FMU must have the canGetAndSetFMUstate capability and be instantiated before
+	the first snapshot is taken. The ring must be freed before the FMU instance.
+	@{
+	*/
+
+/** \brief Opaque state ring */
+typedef struct fmi2_import_state_ring_t fmi2_import_state_ring_t;
+
+/**
+	\brief Create a state ring.
+	\param fmu An FMU with the canGetAndSetFMUstate capability. Its callbacks are used.
+	\param capacity Maximum number of retained snapshots (at least 1).
+	\return A ring or NULL on error. Must be freed with fmi2_import_state_ring_free().
+*/
+FMILIB_EXPORT
+fmi2_import_state_ring_t* fmi2_import_state_ring_create(fmi2_import_t* fmu, size_t capacity);
+
+/** \brief Free the FMU states and the ring */
+FMILIB_EXPORT
+void fmi2_import_state_ring_free(fmi2_import_state_ring_t* ring);
+
+/**
+	\brief Take a snapshot of the current FMU state.
+
+	The snapshot becomes the newest one. If the ring is full the oldest snapshot is dropped.
+	\param ring A state ring.
+	\param time Time point of the snapshot, must not be smaller than the time of the newest snapshot.
+	\return ::jm_status_success or ::jm_status_error.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_state_ring_push(fmi2_import_state_ring_t* ring, fmi2_real_t time);
+
+/**
+	\brief Restore the FMU to the newest snapshot with a time not larger than the given time.
+
+	Newer snapshots are dropped; the restored snapshot is kept, so that a master can
+	repeat a step from the same time point several times.
+	\param ring A state ring.
+	\param time Time point to roll back to.
+	\param restoredTime Outputs the time of the restored snapshot. May be NULL.
+	\return ::jm_status_success, or ::jm_status_error if no snapshot is old enough or the FMU call failed.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_state_ring_rollback(fmi2_import_state_ring_t* ring, fmi2_real_t time, fmi2_real_t* restoredTime);
+
+/** \brief Drop all snapshots. The FMU states are kept for reuse. */
+FMILIB_EXPORT
+void fmi2_import_state_ring_clear(fmi2_import_state_ring_t* ring);
+
+/** \brief Get the number of retained snapshots */
+FMILIB_EXPORT
+size_t fmi2_import_state_ring_get_size(fmi2_import_state_ring_t* ring);
+
+/** \brief Get the maximum number of retained snapshots */
+FMILIB_EXPORT
+size_t fmi2_import_state_ring_get_capacity(fmi2_import_state_ring_t* ring);
+
+/**
+	\brief Get the time of a retained snapshot.
+	\param ring A state ring.
+	\param index Snapshot index, 0 for the oldest up to fmi2_import_state_ring_get_size() - 1.
+*/
+FMILIB_EXPORT
+fmi2_real_t fmi2_import_state_ring_get_time(fmi2_import_state_ring_t* ring, size_t index);
+
+/** \brief Get the number of FMU states allocated by the FMU on behalf of the ring (at most the capacity) */
+FMILIB_EXPORT
+size_t fmi2_import_state_ring_get_number_of_allocated_states(fmi2_import_state_ring_t* ring);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_STATE_RING_H_ */
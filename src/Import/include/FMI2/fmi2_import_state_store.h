@@ -0,0 +1,129 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_state_store.h
+*  \brief Public interface to the FMI import C-library. Store for serialized FMU states.
+*/
+
+#ifndef FMI2_IMPORT_STATE_STORE_H_
+#define FMI2_IMPORT_STATE_STORE_H_
+
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_state_store Serialized FMU state store.
+	@}
+	\addtogroup fmi2_import_state_store Serialized FMU state store.
+	\brief Compact storage of many serialized FMU states, e.g., for checkpoints and for
+	forking simulations from a common state.
+
+	Every saved state is serialized with fmi2SerializeFMUstate. A state is stored as the
+	difference (bytewise exclusive or) to the previously saved state of the store, except
+	for every keyframe_interval-th state which is stored complete. The result is compressed
+	with zlib; data that does not compress is stored as is.
+
+	The stored data is kept in memory, in large blocks that are freed together with the store.
+	When the memory budget is exhausted new states are appended to a temporary file instead,
+	which is read back through a memory mapping. Complete states that were not compressed are
+	passed to fmi2DeSerializeFMUstate directly from the mapping.
+
+	The FMU must have the canSerializeFMUstate capability. A state can be restored into
+	the FMU of the store or into another instance of the same FMU.
+	@{
+	*/
+
+/** \brief Opaque state store */
+typedef struct fmi2_import_state_store_t fmi2_import_state_store_t;
+
+/** \brief State store settings. Use fmi2_import_state_store_default_options() to initialize. */
+typedef struct fmi2_import_state_store_options_t {
+	/** \brief Maximum number of bytes of stored data kept in memory. 0 means no limit. */
+	size_t ram_budget;
+	/** \brief Every keyframe_interval-th state is stored complete. 1 disables the delta encoding. */
+	size_t keyframe_interval;
+	/** \brief zlib compression level, 0 (no compression) to 9 */
+	int compression_level;
+	/** \brief Directory for the spill file. The system temporary directory is used if NULL. */
+	const char* spill_dir;
+} fmi2_import_state_store_options_t;
+
+/** \brief Fill in the default settings: no memory limit, keyframe every 16 states, fastest compression */
+FMILIB_EXPORT
+void fmi2_import_state_store_default_options(fmi2_import_state_store_options_t* options);
+
+/**
+	\brief Create a state store.
+	\param fmu An FMU with the canSerializeFMUstate capability. Its callbacks are used.
+	\param options Settings or NULL for the defaults. The settings are copied.
+	\return A store or NULL on error. Must be freed with fmi2_import_state_store_free().
+*/
+FMILIB_EXPORT
+fmi2_import_state_store_t* fmi2_import_state_store_create(fmi2_import_t* fmu, const fmi2_import_state_store_options_t* options);
+
+/** \brief Free the store, its memory and spill file. Must be called before the FMU instance is freed. */
+FMILIB_EXPORT
+void fmi2_import_state_store_free(fmi2_import_state_store_t* store);
+
+/**
+	\brief Serialize and store an FMU state.
+	\param store A state store.
+	\param state An FMU state of the FMU of the store, or NULL to store the current state of the FMU.
+	\param id Outputs the identifier of the stored state, used in fmi2_import_state_store_restore().
+		The identifiers are consecutive numbers starting from 0.
+	\return ::jm_status_success or ::jm_status_error.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_state_store_save(fmi2_import_state_store_t* store, fmi2_FMU_state_t state, size_t* id);
+
+/**
+	\brief Restore a stored state.
+	\param store A state store.
+	\param id Identifier returned by fmi2_import_state_store_save().
+	\param fmu The FMU to restore the state into: the FMU of the store, another instance of the same
+		FMU, or NULL for the FMU of the store.
+	\return ::jm_status_success or ::jm_status_error.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_state_store_restore(fmi2_import_state_store_t* store, size_t id, fmi2_import_t* fmu);
+
+/** \brief Get the number of stored states */
+FMILIB_EXPORT
+size_t fmi2_import_state_store_get_number_of_states(fmi2_import_state_store_t* store);
+
+/** \brief Get the total size of the serialized states before encoding */
+FMILIB_EXPORT
+size_t fmi2_import_state_store_get_serialized_size(fmi2_import_state_store_t* store);
+
+/** \brief Get the number of bytes of stored data in memory */
+FMILIB_EXPORT
+size_t fmi2_import_state_store_get_memory_size(fmi2_import_state_store_t* store);
+
+/** \brief Get the number of bytes of stored data in the spill file */
+FMILIB_EXPORT
+size_t fmi2_import_state_store_get_spilled_size(fmi2_import_state_store_t* store);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_STATE_STORE_H_ */
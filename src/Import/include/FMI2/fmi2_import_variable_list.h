@@ -58,7 +58,13 @@ FMILIB_EXPORT fmi2_import_variable_list_t* fmi2_import_clone_variable_list(fmi2_
 /** \brief  Get number of variables in a list */
 FMILIB_EXPORT size_t  fmi2_import_get_variable_list_size(fmi2_import_variable_list_t* vl);
 
-/** \brief  Get a pointer to the list of the value references for all the variables */
+/** \brief  Get a pointer to the list of the value references for all the variables
+
+The array is owned by the list and is created on the first call. It is released when the list is
+freed or changed by fmi2_import_var_list_push_back() or one of the in-place operations, so a
+pointer returned before such a change must not be used after it. Call the function again to get
+the value references of the changed list.
+*/
 FMILIB_EXPORT const fmi2_value_reference_t* fmi2_import_get_value_referece_list(fmi2_import_variable_list_t* vl);
 
 /** \brief Get a single variable from the list*/
@@ -120,6 +126,91 @@ FMILIB_EXPORT jm_status_enu_t fmi2_import_var_list_push_back(fmi2_import_variabl
   @}
  */
 
+/** \name Views and in-place operations on variable lists.
+
+A view is a range of a list that is used without copying it. The view refers to the list by
+index, so it stays valid when variables are added to the list but not when the list is
+freed or variables are removed from it. The in-place operations modify their list and
+do not allocate a new one. They invalidate the array returned by fmi2_import_get_value_referece_list().
+@{
+*/
+/** \brief A range of a variable list that does not own the variables. The members should not be modified directly. */
+typedef struct fmi2_import_variable_list_view_t {
+	/** \brief The list that is viewed */
+	fmi2_import_variable_list_t* list;
+	/** \brief Index of the first variable of the view in the list */
+	size_t first;
+	/** \brief Number of variables in the view */
+	size_t size;
+} fmi2_import_variable_list_view_t;
+
+/** \brief Initialize a view of a whole list.
+\param view The view to initialize.
+\param vl A variable list.
+*/
+FMILIB_EXPORT void fmi2_import_init_variable_list_view(fmi2_import_variable_list_view_t* view, fmi2_import_variable_list_t* vl);
+
+/** \brief Initialize a view of a range of another view.
+\param view The view to initialize, may be the same as parent.
+\param parent A view.
+\param fromIndex Zero based start index in the parent view, inclusive.
+\param toIndex Zero based end index in the parent view, inclusive.
+\return ::jm_status_error and an empty view if toIndex is less than fromIndex or is not less than the size of the parent.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_init_variable_list_subview(fmi2_import_variable_list_view_t* view, const fmi2_import_variable_list_view_t* parent, size_t fromIndex, size_t toIndex);
+
+/** \brief Get a single variable from a view or NULL if the index is out of range */
+FMILIB_EXPORT fmi2_import_variable_t* fmi2_import_get_view_variable(const fmi2_import_variable_list_view_t* view, size_t index);
+
+/** \brief Create a new list with the variables of a view.
+\return A new list that must be freed with fmi2_import_free_variable_list() or NULL if memory allocation failed.
+*/
+FMILIB_EXPORT fmi2_import_variable_list_t* fmi2_import_view_to_variable_list(const fmi2_import_variable_list_view_t* view);
+
+/** \brief Append the variables of a view to a list in place.
+\param vl A variable list.
+\param view A view. It may be a view of vl.
+\return ::jm_status_error if memory allocation failed, the list is then unchanged.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_var_list_append_view(fmi2_import_variable_list_t* vl, const fmi2_import_variable_list_view_t* view);
+
+/** \brief Remove the variables for which the filter function returns 0 from a list in place. The order of the remaining variables is kept.
+\param vl A variable list.
+\param filter A filter function according to ::fmi2_import_variable_filter_function_ft.
+\param context A parameter to be forwarded to the filter function.
+\return The new size of the list.
+*/
+FMILIB_EXPORT size_t fmi2_import_var_list_filter(fmi2_import_variable_list_t* vl, fmi2_import_variable_filter_function_ft filter, void* context);
+
+/** \brief Callback function typedef for fmi2_import_var_list_sort().
+
+The function should return a negative value, zero or a positive value if a is ordered before, together with or after b. */
+typedef int (*fmi2_import_variable_compare_ft)(fmi2_import_variable_t* a, fmi2_import_variable_t* b, void* context);
+
+/** \brief Order variables by base type and value reference (enumerations are ordered as integers). Aliases compare equal. */
+FMILIB_EXPORT int fmi2_import_compare_variables_by_vr(fmi2_import_variable_t* a, fmi2_import_variable_t* b, void* context);
+
+/** \brief Order variables by name */
+FMILIB_EXPORT int fmi2_import_compare_variables_by_name(fmi2_import_variable_t* a, fmi2_import_variable_t* b, void* context);
+
+/** \brief Sort a list in place. The sort is stable.
+\param vl A variable list.
+\param compare A compare function according to ::fmi2_import_variable_compare_ft.
+\param context A parameter to be forwarded to the compare function.
+\return ::jm_status_error if memory allocation failed, the list is then unchanged.
+*/
+FMILIB_EXPORT jm_status_enu_t fmi2_import_var_list_sort(fmi2_import_variable_list_t* vl, fmi2_import_variable_compare_ft compare, void* context);
+
+/** \brief Remove consecutive repetitions of the same variable from a list in place.
+Sort the list first to remove all the repetitions.
+\param vl A variable list.
+\return The new size of the list.
+*/
+FMILIB_EXPORT size_t fmi2_import_var_list_unique(fmi2_import_variable_list_t* vl);
+/**
+  @}
+ */
+
 /**
   @}
  */
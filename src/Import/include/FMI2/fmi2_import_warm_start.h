@@ -0,0 +1,82 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_warm_start.h
+*  \brief Public interface to the FMI import C-library. Cloning of an initialized FMU instance.
+*/
+
+#ifndef FMI2_IMPORT_WARM_START_H_
+#define FMI2_IMPORT_WARM_START_H_
+
+#include <JM/jm_callbacks.h>
+#include <FMI/fmi_import_context.h>
+#include <FMI2/fmi2_types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/**
+	\addtogroup fmi2_import
+	@{
+	\addtogroup fmi2_import_warm_start Warm start of many instances from one initialized instance.
+	@}
+	\addtogroup fmi2_import_warm_start Warm start of many instances from one initialized instance.
+	\brief Skip the initialization of the variants of a parameter sweep.
+
+	The source FMU is initialized once by the caller. fmi2_import_warm_start() serializes
+	its state and then, on a thread pool, instantiates every target FMU, deserializes the
+	state into it and calls an override function that sets the parameters of the variant.
+	The targets are separate ::fmi2_import_t objects of the same FMU with a loaded DLL,
+	e.g., from repeated fmi2_import_parse_xml() and fmi2_import_create_dllfmu() calls.
+
+	The FMU must have the canSerializeFMUstate capability. Messages logged through the same
+	jm_callbacks from several threads share its message buffer; targets should be loaded
+	with separate callbacks.
+	@{
+	*/
+
+/**
+	\brief Function that applies the overrides of one instance.
+
+	Called from a worker thread after the state was restored into the instance.
+	\param fmu The target FMU.
+	\param index Index of the target in the array given to fmi2_import_warm_start().
+	\param userData The pointer given to fmi2_import_warm_start().
+	\return ::jm_status_success, or ::jm_status_error to fail the instance.
+*/
+typedef jm_status_enu_t (*fmi2_import_warm_start_override_ft)(fmi2_import_t* fmu, size_t index, void* userData);
+
+/**
+	\brief Clone the state of an initialized FMU instance into new instances.
+	\param source An instantiated and initialized FMU.
+	\param targets Array of FMUs with a loaded DLL that are not instantiated.
+	\param numTargets Number of targets.
+	\param instanceNames Instance names of the targets, or NULL to name them after the index.
+	\param numThreads Number of worker threads. 0 means one per processor.
+	\param override Function applying the parameter overrides of each target, or NULL.
+	\param userData Passed to the override function.
+	\return ::jm_status_success if all targets were cloned, ::jm_status_error otherwise.
+		A target that failed is not instantiated on return, the others are.
+*/
+FMILIB_EXPORT
+jm_status_enu_t fmi2_import_warm_start(fmi2_import_t* source, fmi2_import_t** targets, size_t numTargets,
+	const char* const* instanceNames, size_t numThreads, fmi2_import_warm_start_override_ft override, void* userData);
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_WARM_START_H_ */
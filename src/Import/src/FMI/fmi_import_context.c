@@ -17,6 +17,7 @@
 #include <stdarg.h>
 
 #include <JM/jm_named_ptr.h>
+#include <JM/jm_trace.h>
 #include <FMI/fmi_import_context.h>
 #include <FMI/fmi_zip_unzip.h>
 #include <FMI/fmi_import_util.h>
@@ -35,6 +36,10 @@ void fmi_import_free_context( fmi_import_context_t* c) {
 }
 
 
+void fmi_import_set_memory_accounting( fmi_import_context_t* c, int enable) {
+	c->memoryAccounting = enable;
+}
+
 fmi_version_enu_t fmi_import_get_fmi_version( fmi_import_context_t* c, const char* fileName, const char* dirName) {
 	fmi_version_enu_t ret = fmi_version_unknown_enu;
 	jm_status_enu_t status;
@@ -48,7 +53,9 @@ fmi_version_enu_t fmi_import_get_fmi_version( fmi_import_context_t* c, const cha
 		jm_log_fatal(c->callbacks, MODULE, "No temporary directory name specified");
 		return fmi_version_unknown_enu;
 	}
+	jm_trace_begin("fmilib", "Unzip");
 	status = fmi_zip_unzip(fileName, dirName, c->callbacks);
+	jm_trace_end("fmilib", "Unzip");
 	if(status == jm_status_error) return fmi_version_unknown_enu;
 	mdpath = fmi_import_get_model_description_path(dirName, c->callbacks);
 	ret = fmi_xml_get_fmi_version(c, mdpath);
@@ -35,6 +35,8 @@ struct fmi_xml_context_t {
     XML_Parser parser;
 
 	fmi_version_enu_t fmi_version;
+
+	int memoryAccounting; /* see fmi_import_set_memory_accounting() */
 };
 
 #ifdef __cplusplus
@@ -17,6 +17,7 @@
 #include <stdarg.h>
 
 #include <JM/jm_named_ptr.h>
+#include <JM/jm_trace.h>
 #include "fmi1_import_impl.h"
 #include "fmi1_import_variable_list_impl.h"
 
@@ -81,11 +82,14 @@ fmi1_import_t* fmi1_import_parse_xml( fmi_import_context_t* context, const char*
 	
 	jm_log_verbose( cb, "FMILIB", "Parsing model description XML");
 
+	jm_trace_begin("fmilib", "Parse XML");
 	if(fmi1_xml_parse_model_description( fmu->md, xmlPath)) {
+		jm_trace_end("fmilib", "Parse XML");
 		fmi1_import_free(fmu);
 		cb->free(xmlPath);
 		return 0;
 	}
+	jm_trace_end("fmilib", "Parse XML");
 	cb->free(xmlPath);
 	
 	fmu->dirPath =  (char*)cb->calloc(strlen(dirPath) + 1, sizeof(char));
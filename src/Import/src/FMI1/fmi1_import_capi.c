@@ -24,10 +24,47 @@ extern "C" {
 #include <FMI1/fmi1_enums.h>
 #include <FMI1/fmi1_capi.h>
 #include <FMI/fmi_util.h>
+#include <JM/jm_pointer_map.h>
 #include "fmi1_import_impl.h"
 
 static const char * module = "FMILIB";
 
+static jm_pointer_map_t fmi1_import_active_components;
+
+static jm_once_t fmi1_import_active_components_once = JM_ONCE_INIT;
+
+static jm_status_enu_t fmi1_import_active_components_status = jm_status_error;
+
+static void fmi1_import_init_active_components(void) {
+	fmi1_import_active_components_status = jm_pointer_map_init(&fmi1_import_active_components, 0);
+}
+
+static jm_pointer_map_t* fmi1_import_get_active_components(void) {
+	jm_once(&fmi1_import_active_components_once, fmi1_import_init_active_components);
+	return (fmi1_import_active_components_status == jm_status_success) ? &fmi1_import_active_components : 0;
+}
+
+jm_status_enu_t fmi1_import_register_component(fmi1_import_t* fmu, fmi1_component_t c) {
+	jm_pointer_map_t* active = fmi1_import_get_active_components();
+	if(!active || (jm_pointer_map_insert(active, c, fmu) != jm_status_success)) {
+		jm_log_warning(fmu->callbacks, module, "Could not register the instance, its log messages will use the default callbacks");
+		return jm_status_error;
+	}
+	jm_log_debug(fmu->callbacks, module, "Registered instance %p of fmu(%p)", c, fmu);
+	return jm_status_success;
+}
+
+void fmi1_import_unregister_component(fmi1_import_t* fmu, fmi1_component_t c) {
+	jm_pointer_map_t* active = fmi1_import_get_active_components();
+	if(active && jm_pointer_map_remove(active, c, fmu))
+		jm_log_debug(fmu->callbacks, module, "Unregistered instance %p of fmu(%p)", c, fmu);
+}
+
+fmi1_import_t* fmi1_import_find_component(fmi1_component_t c) {
+	jm_pointer_map_t* active = fmi1_import_get_active_components();
+	return (active && c) ? (fmi1_import_t*)jm_pointer_map_find(active, c) : 0;
+}
+
 /* Load and destroy functions */
 jm_status_enu_t fmi1_import_create_dllfmu(fmi1_import_t* fmu, fmi1_callback_functions_t callBackFunctions, int registerGlobally) {
 
@@ -112,18 +149,8 @@ jm_status_enu_t fmi1_import_create_dllfmu(fmi1_import_t* fmu, fmi1_callback_func
 	}
 	jm_log_verbose(fmu->callbacks, module, "Successfully loaded all the interface functions"); 
 
-	if (registerGlobally) {
-		fmu->registerGlobally = 1;
-		if(!fmi1_import_active_fmu) {
-			fmi1_import_active_fmu_store_callbacks = *fmu->callbacks;
-			fmi1_import_active_fmu_store_callbacks.context = 0;
-			jm_vector_init(jm_voidp)(&fmi1_import_active_fmu_store,0, &fmi1_import_active_fmu_store_callbacks);
-			fmi1_import_active_fmu = &fmi1_import_active_fmu_store;
-			jm_log_debug(fmu->callbacks, module, "Created an empty active fmu list");
-		}
-		jm_vector_push_back(jm_voidp)(fmi1_import_active_fmu, fmu);
-		jm_log_debug(fmu->callbacks, module, "Registrered active fmu(%p)", fmu);
-	}
+	/* The instances are registered when they are created */
+	fmu->registerGlobally = registerGlobally;
 
 	return jm_status_success;
 }
@@ -135,6 +162,44 @@ void fmi1_import_set_debug_mode(fmi1_import_t* fmu, int mode) {
 	fmi1_capi_set_debug_mode(fmu->capi, mode);
 }
 
+jm_status_enu_t fmi1_import_get_call_statistics(fmi1_import_t* fmu, fmi1_function_enu_t f, jm_call_statistics_t* stats) {
+	const jm_call_statistics_t* s;
+	if(!fmu->capi) {
+		jm_log_error(fmu->callbacks, module,"FMU CAPI is not loaded");
+		return jm_status_error;
+	}
+	s = fmi1_capi_get_call_statistics(fmu->capi, f);
+	if(!s) {
+		jm_log_error(fmu->callbacks, module,"Call statistics are not available for function %d", (int)f);
+		return jm_status_error;
+	}
+	*stats = *s;
+	return jm_status_success;
+}
+
+void fmi1_import_reset_call_statistics(fmi1_import_t* fmu) {
+	if(!fmu->capi) return;
+	fmi1_capi_reset_call_statistics(fmu->capi);
+}
+
+void fmi1_import_log_call_statistics(fmi1_import_t* fmu) {
+	const jm_call_statistics_t* s;
+	int f;
+	if(!fmu->capi) {
+		jm_log_error(fmu->callbacks, module,"FMU CAPI is not loaded");
+		return;
+	}
+	for(f = 0; f < fmi1_functions_Num; f++) {
+		s = fmi1_capi_get_call_statistics(fmu->capi, (fmi1_function_enu_t)f);
+		if(!s) {
+			jm_log_warning(fmu->callbacks, module, "Call statistics are not available (the library is compiled without FMILIB_ENABLE_CALL_STATISTICS)");
+			return;
+		}
+		if(s->count > 0)
+			jm_call_statistics_log(fmu->callbacks, module, fmi1_function_to_string((fmi1_function_enu_t)f), s);
+	}
+}
+
 void fmi1_import_destroy_dllfmu(fmi1_import_t* fmu) {
 	
 	if (fmu == NULL) {
@@ -145,30 +210,18 @@ void fmi1_import_destroy_dllfmu(fmi1_import_t* fmu) {
 	if(fmu -> capi) {
 		jm_log_verbose(fmu->callbacks, module, "Releasing FMU CAPI interface"); 
 
+		/* An instance that was not freed is unregistered with the FMU */
+		if(fmu->registerGlobally && fmu->capi->c) {
+			fmi1_import_unregister_component(fmu, fmu->capi->c);
+		}
+		fmu->registerGlobally = 0;
+
 		/* Free DLL handle */
 		fmi1_capi_free_dll(fmu -> capi);
 
 		/* Destroy the C-API struct */
 		fmi1_capi_destroy_dllfmu(fmu -> capi);
 
-		if(fmu->registerGlobally && fmi1_import_active_fmu) {
-			size_t index;
-			size_t nFmu;
-
-			index = jm_vector_find_index(jm_voidp)(fmi1_import_active_fmu, (void**)&fmu, jm_compare_voidp);
-			nFmu = jm_vector_get_size(jm_voidp)(fmi1_import_active_fmu);
-			if(index < nFmu) {
-				jm_vector_remove_item(jm_voidp)(fmi1_import_active_fmu,index);
-				jm_log_debug(fmu->callbacks, module, "Unregistrered active fmu(%p)", fmu);
-				if(nFmu == 1) {
-					jm_vector_free_data(jm_voidp)(fmi1_import_active_fmu);
-					fmi1_import_active_fmu = 0;
-					jm_log_debug(fmu->callbacks, module, "Freed active fmu list");
-				}
-			}
-			fmu->registerGlobally = 0;
-		}
-
 		fmu -> capi = NULL;
 	}
 	else {
@@ -238,12 +291,16 @@ jm_status_enu_t fmi1_import_instantiate_model(fmi1_import_t* fmu, fmi1_string_t
 	if (c == NULL) {
 		return jm_status_error;
 	} else {
+		if(fmu->registerGlobally) fmi1_import_register_component(fmu, c);
 		return jm_status_success;
 	}
 }
 
 void fmi1_import_free_model_instance(fmi1_import_t* fmu) {
+	fmi1_component_t c = fmu->capi->c;
 	fmi1_capi_free_model_instance(fmu -> capi);
+	fmu->capi->c = 0;
+	if(fmu->registerGlobally && c) fmi1_import_unregister_component(fmu, c);
 }
 
 fmi1_status_t fmi1_import_set_time(fmi1_import_t* fmu, fmi1_real_t time) {
@@ -310,6 +367,7 @@ jm_status_enu_t fmi1_import_instantiate_slave(fmi1_import_t* fmu, fmi1_string_t
 	if (c == NULL) {
 		return jm_status_error;
 	} else {
+		if(fmu->registerGlobally) fmi1_import_register_component(fmu, c);
 		return jm_status_success;
 	}
 }
@@ -327,7 +385,10 @@ fmi1_status_t fmi1_import_reset_slave(fmi1_import_t* fmu) {
 }
 
 void fmi1_import_free_slave_instance(fmi1_import_t* fmu) {
+	fmi1_component_t c = fmu->capi->c;
 	fmi1_capi_free_slave_instance(fmu -> capi);
+	fmu->capi->c = 0;
+	if(fmu->registerGlobally && c) fmi1_import_unregister_component(fmu, c);
 }
 
 fmi1_status_t fmi1_import_set_real_input_derivatives(fmi1_import_t* fmu, const fmi1_value_reference_t vr[], size_t nvr, const fmi1_integer_t order[], const  fmi1_real_t value[]) {
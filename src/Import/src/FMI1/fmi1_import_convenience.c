@@ -89,144 +89,147 @@ void fmi1_import_collect_model_counts(fmi1_import_t* fmu, fmi1_import_model_coun
     return;
 }
 
-void fmi1_import_expand_variable_references_impl(fmi1_import_t* fmu, const char* msgIn);
-
-void fmi1_import_expand_variable_references(fmi1_import_t* fmu, const char* msgIn, char* msgOut, size_t maxMsgSize) {
-	fmi1_import_expand_variable_references_impl(fmu, msgIn);
-	strncpy(msgOut, jm_vector_get_itemp(char)(&fmu->logMessageBufferExpanded,0),maxMsgSize);
-	msgOut[maxMsgSize - 1] = '\0';
+/* Append n characters to the output, storing only what fits before the terminating 0 */
+static void fmi1_import_expand_append(char* out, size_t outSize, size_t len, const char* s, size_t n) {
+	if(len + 1 < outSize) {
+		size_t room = outSize - 1 - len;
+		memcpy(out + len, s, (n < room) ? n : room);
+	}
 }
 
-/* Print msgIn into msgOut by expanding variable references of the form #<Type><VR># into variable names
-  and replacing '##' with a single # */
-void fmi1_import_expand_variable_references_impl(fmi1_import_t* fmu, const char* msgIn){
-	jm_vector(char)* msgOut = &fmu->logMessageBufferExpanded;
-	fmi1_xml_model_description_t* md = fmu->md;
-	jm_callbacks* callbacks = fmu->callbacks;
-    char curCh;
-	const char* firstRef;
-    size_t i; /* next char index after curCh in msgIn*/ 
-	size_t msgLen = strlen(msgIn)+1; /* original message length including terminating 0 */
+/* Report a malformed reference and replace the output with the original message */
+static size_t fmi1_import_expand_error(fmi1_import_t* fmu, const char* msgIn, char* out, size_t outSize, size_t len, const char* what) {
+	char here[JM_MAX_ERROR_MESSAGE_SIZE];
+	size_t msgLen = strlen(msgIn);
 
-	if(jm_vector_reserve(char)(msgOut, msgLen + 100) < msgLen + 100) {
-		jm_log(fmu->callbacks,"LOGGER", jm_log_level_warning, "Could not allocate memory for the log message");
-		jm_vector_resize(char)(msgOut, 6);
-		memcpy(jm_vector_get_itemp(char)(msgOut,0),"ERROR",6); /* at least 16 chars are always there */
-		return;
+	/* The output may be the message buffer of the callbacks that jm_log() formats into */
+	here[0] = 0;
+	if(outSize) {
+		out[(len < outSize) ? len : outSize - 1] = 0;
+		strncpy(here, out, JM_MAX_ERROR_MESSAGE_SIZE);
+		here[JM_MAX_ERROR_MESSAGE_SIZE - 1] = 0;
 	}
+	jm_log(fmu->callbacks,"LOGGER", jm_log_level_warning, "%s in log message here: '%s'", what, here);
+	if(outSize) {
+		fmi1_import_expand_append(out, outSize, 0, msgIn, msgLen);
+		out[(msgLen < outSize) ? msgLen : outSize - 1] = 0;
+	}
+	return msgLen;
+}
+
+/* Print msgIn into out by expanding variable references of the form #<Type><VR># into variable names
+  and replacing '##' with a single #. The message is scanned once and the output is truncated to outSize.
+  Returns the length of the complete output, i.e., a value >= outSize if the output was truncated.
+  On a malformed reference a warning is logged, *malformed is set and the output is msgIn. */
+static size_t fmi1_import_expand_refs(fmi1_import_t* fmu, const char* msgIn, char* out, size_t outSize, int* malformed) {
+	const char* p = msgIn;
+	const char* hash;
+	size_t len = 0, tailLen;
+
+	*malformed = 1;
+	while((hash = strchr(p, '#')) != 0) {
+		fmi1_value_reference_t vr = 0;
+		fmi1_base_type_enu_t baseType;
+		fmi1_xml_variable_t* var;
+		const char* digits;
+		const char* name;
+		size_t num_digits, nameLen;
+		int overflow = 0;
 
-	/* check if there are any refs at all and copy the head of the string without references */
-	firstRef = strchr(msgIn, '#');
-	if(firstRef) {
-		i = firstRef - msgIn;
-		jm_vector_resize(char)(msgOut, i);
-		if(i) {
-			memcpy(jm_vector_get_itemp(char)(msgOut, 0), msgIn, i);
+		fmi1_import_expand_append(out, outSize, len, p, hash - p);
+		len += hash - p;
+		p = hash + 1;
+		if(*p == '#') {
+			fmi1_import_expand_append(out, outSize, len, "#", 1);
+			len++;
+			p++;
+			continue;
+		}
+		switch(*p) {
+			case 'r':
+				baseType = fmi1_base_type_real;
+				break;
+			case 'i':
+				baseType = fmi1_base_type_int;
+				break;
+			case 'b':
+				baseType = fmi1_base_type_bool;
+				break;
+			case 's':
+				baseType = fmi1_base_type_str;
+				break;
+			default:
+				return fmi1_import_expand_error(fmu, msgIn, out, outSize, len,
+					"Expected type specification character 'r', 'i', 'b' or 's'");
+		}
+		digits = ++p;
+		while(isdigit((unsigned char)*p)) {
+			fmi1_value_reference_t d = (fmi1_value_reference_t)(*p - '0');
+			if(vr > ((fmi1_value_reference_t)-1 - d) / 10) overflow = 1;
+			vr = vr * 10 + d;
+			p++;
+		}
+		/* The digits are shown in the warnings */
+		num_digits = p - digits;
+		fmi1_import_expand_append(out, outSize, len, digits, num_digits);
+		if(num_digits == 0) {
+			return fmi1_import_expand_error(fmu, msgIn, out, outSize, len, "Expected value reference");
+		}
+		else if(*p != '#') {
+			return fmi1_import_expand_error(fmu, msgIn, out, outSize, len + num_digits, "Expected terminating '#'");
+		}
+		if(overflow) {
+			return fmi1_import_expand_error(fmu, msgIn, out, outSize, len + num_digits, "Could not decode value reference");
 		}
-		curCh = msgIn[i++];
+		var = fmi1_xml_get_variable_by_vr(fmu->md, baseType, vr);
+		if(!var) {
+			return fmi1_import_expand_error(fmu, msgIn, out, outSize, len + num_digits, "Could not find variable referenced");
+		}
+		name = fmi1_xml_get_variable_name(var);
+		nameLen = strlen(name);
+		fmi1_import_expand_append(out, outSize, len, name, nameLen);
+		len += nameLen;
+		p++; /* skip the terminating # */
 	}
-	else {
-		jm_vector_resize(char)(msgOut, msgLen);
-		memcpy(jm_vector_get_itemp(char)(msgOut, 0), msgIn, msgLen);
-		return;
+	tailLen = strlen(p);
+	*malformed = 0;
+	fmi1_import_expand_append(out, outSize, len, p, tailLen);
+	len += tailLen;
+	if(outSize) {
+		out[(len < outSize) ? len : outSize - 1] = 0;
 	}
-    do {
-        if (curCh!='#') {
-            jm_vector_push_back(char)(msgOut, curCh); /* copy in to out */
-        }
-		else if(msgIn[i] == '#') {
-			jm_vector_push_back(char)(msgOut, '#');
-			i++; /* skip the second # */
-		}
-		else {
-			fmi1_value_reference_t vr = fmi1_undefined_value_reference;
-			char typeChar = msgIn[i++];
-			size_t pastePos = jm_vector_get_size(char)(msgOut);
-			fmi1_base_type_enu_t baseType;
-			size_t num_digits;
-			fmi1_xml_variable_t* var;
-			const char* name;
-			size_t nameLen;
-			switch(typeChar) {
-				case 'r': 
-					baseType = fmi1_base_type_real;
-					break;
-				case 'i': 
-					baseType = fmi1_base_type_int;
-					break;
-				case 'b': 
-					baseType = fmi1_base_type_bool;
-					break;
-				case 's': 
-					baseType = fmi1_base_type_str;
-					break;
-				default:
-					jm_vector_push_back(char)(msgOut, 0);
-					jm_log(callbacks,"LOGGER", jm_log_level_warning, 
-						"Expected type specification character 'r', 'i', 'b' or 's' in log message here: '%s'", 
-					jm_vector_get_itemp(char)(msgOut,0));
-                    jm_vector_resize(char)(msgOut, msgLen);
-					memcpy(jm_vector_get_itemp(char)(msgOut,0),msgIn,msgLen);
-					return;
-			}
-            curCh = msgIn[i++];
-			while( isdigit(curCh) ) {
-				jm_vector_push_back(char)(msgOut, curCh);
-	            curCh = msgIn[i++];
-			}
-			num_digits = jm_vector_get_size(char)(msgOut) - pastePos;
-			jm_vector_push_back(char)(msgOut, 0);
-			if(num_digits == 0) {
-				jm_log(callbacks,"LOGGER", jm_log_level_warning, "Expected value reference in log message here: '%s'", jm_vector_get_itemp(char)(msgOut,0));
-                                jm_vector_resize(char)(msgOut, msgLen);
-                jm_vector_resize(char)(msgOut, msgLen);
-				memcpy(jm_vector_get_itemp(char)(msgOut,0),msgIn,msgLen);
-				return;
-			}
-			else if(curCh != '#') {
-				jm_log(callbacks,"LOGGER", jm_log_level_warning, "Expected terminating '#' in log message here: '%s'", jm_vector_get_itemp(char)(msgOut,0));
-                                jm_vector_resize(char)(msgOut, msgLen);
-                jm_vector_resize(char)(msgOut, msgLen);
-				memcpy(jm_vector_get_itemp(char)(msgOut,0),msgIn,msgLen);
-				return;
-			}
-			
-			if(sscanf(jm_vector_get_itemp(char)(msgOut, pastePos), "%u",&vr) != 1) {
-				jm_log(callbacks,"LOGGER", jm_log_level_warning, "Could not decode value reference in log message here: '%s'", jm_vector_get_itemp(char)(msgOut,0));
-                                jm_vector_resize(char)(msgOut, msgLen);
-                jm_vector_resize(char)(msgOut, msgLen);
-				memcpy(jm_vector_get_itemp(char)(msgOut,0),msgIn,msgLen);
-				return;
-			}
-			var = fmi1_xml_get_variable_by_vr(md,baseType,vr);
-			if(!var) {
-				jm_log(callbacks,"LOGGER", jm_log_level_warning, "Could not find variable referenced in log message here: '%s'", jm_vector_get_itemp(char)(msgOut,0));
-                                jm_vector_resize(char)(msgOut, msgLen);
-                jm_vector_resize(char)(msgOut, msgLen);
-				memcpy(jm_vector_get_itemp(char)(msgOut,0),msgIn,msgLen);
-				return;
-			}
-			name = fmi1_xml_get_variable_name(var);
-			nameLen = strlen(name);
-			if(jm_vector_resize(char)(msgOut, pastePos + nameLen) != pastePos + nameLen) {
-				jm_log(callbacks,"LOGGER", jm_log_level_warning, "Could not allocate memory for the log message");
-                                jm_vector_resize(char)(msgOut, msgLen);
-                jm_vector_resize(char)(msgOut, msgLen);
-				memcpy(jm_vector_get_itemp(char)(msgOut,0),msgIn,msgLen);
-				return;
-			};
-			memcpy(jm_vector_get_itemp(char)(msgOut, pastePos), name, nameLen);
-        }
-        curCh = msgIn[i++];
-    } while (curCh);
-    jm_vector_push_back(char)(msgOut, 0);
+	return len;
 }
 
-jm_callbacks fmi1_import_active_fmu_store_callbacks;
+void fmi1_import_expand_variable_references(fmi1_import_t* fmu, const char* msgIn, char* msgOut, size_t maxMsgSize) {
+	int malformed;
+	fmi1_import_expand_refs(fmu, msgIn, msgOut, maxMsgSize, &malformed);
+}
 
-jm_vector(jm_voidp) fmi1_import_active_fmu_store;
+/* Expand msgIn into the log message buffer of the FMU, which is grown as needed and keeps its size
+  between the messages. Returns the expanded message, or msgIn if it could not be expanded. */
+static const char* fmi1_import_expand_variable_references_impl(fmi1_import_t* fmu, const char* msgIn) {
+	jm_vector(char)* msgOut = &fmu->logMessageBufferExpanded;
+	size_t size = jm_vector_get_size(char)(msgOut), len;
+	int malformed;
 
-jm_vector(jm_voidp)* fmi1_import_active_fmu = 0;
+	if(size < JM_MAX_ERROR_MESSAGE_SIZE) {
+		size = jm_vector_resize(char)(msgOut, JM_MAX_ERROR_MESSAGE_SIZE);
+	}
+	len = fmi1_import_expand_refs(fmu, msgIn, jm_vector_get_itemp(char)(msgOut, 0), size, &malformed);
+	if(len < size) {
+		return jm_vector_get_itemp(char)(msgOut, 0);
+	}
+	if(malformed) {
+		return msgIn;
+	}
+	if(jm_vector_resize(char)(msgOut, len + 1) < len + 1) {
+		jm_log(fmu->callbacks,"LOGGER", jm_log_level_warning, "Could not allocate memory for the log message");
+		return msgIn;
+	}
+	fmi1_import_expand_refs(fmu, msgIn, jm_vector_get_itemp(char)(msgOut, 0), len + 1, &malformed);
+	return jm_vector_get_itemp(char)(msgOut, 0);
+}
 
 void  fmi1_log_forwarding(fmi1_component_t c, fmi1_string_t instanceName, fmi1_status_t status, fmi1_string_t category, fmi1_string_t message, ...) {
     va_list args;
@@ -237,26 +240,11 @@ void  fmi1_log_forwarding(fmi1_component_t c, fmi1_string_t instanceName, fmi1_s
 
 void  fmi1_log_forwarding_v(fmi1_component_t c, fmi1_string_t instanceName, fmi1_status_t status, fmi1_string_t category, fmi1_string_t message, va_list args) {
 #define BUFSIZE JM_MAX_ERROR_MESSAGE_SIZE
-    char buffer[BUFSIZE], *buf, *curp, *msg;
-	const char* statusStr;
-	fmi1_import_t* fmu = 0;
-	jm_callbacks* cb = jm_get_default_callbacks();
+    char buffer[BUFSIZE], *buf, *curp;
+	const char* statusStr, *msg;
+	fmi1_import_t* fmu = fmi1_import_find_component(c);
+	jm_callbacks* cb = fmu ? fmu->callbacks : jm_get_default_callbacks(); /* default callbacks for unknown instances */
 	jm_log_level_enu_t logLevel = jm_log_level_error;
-	if(fmi1_import_active_fmu) {
-		size_t n = jm_vector_get_size(jm_voidp)(fmi1_import_active_fmu);
-		size_t i;
-		for(i= 0; i < n; i++) {
-			fmu = (fmi1_import_t*)jm_vector_get_item(jm_voidp)(fmi1_import_active_fmu, i);
-			if(fmu->capi->c == c) {
-				cb = fmu->callbacks;
-				break;
-			}
-		}
-		if(i >= n) { /* Could not find matching FMU -> use default callbacks */
-			fmu = 0;
-			cb = jm_get_default_callbacks();
-		}
-	}
     if(fmu) {
          buf = jm_vector_get_itemp(char)(&fmu->logMessageBufferCoded,0);
 	}
@@ -311,8 +299,7 @@ void  fmi1_log_forwarding_v(fmi1_component_t c, fmi1_string_t instanceName, fmi1
 #ifdef JM_VA_COPY
         va_end(argscp);
 #endif
-	    fmi1_import_expand_variable_references(fmu, buf, cb->errMessageBuffer,JM_MAX_ERROR_MESSAGE_SIZE);
-		msg = jm_vector_get_itemp(char)(&fmu->logMessageBufferExpanded,0);
+		msg = fmi1_import_expand_variable_references_impl(fmu, buf);
 	}
 	else {
 		jm_vsnprintf(curp, BUFSIZE -(curp-buf), message, args);
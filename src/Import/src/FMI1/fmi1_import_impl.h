@@ -44,11 +44,13 @@ struct fmi1_import_t {
 	jm_vector(char) logMessageBufferExpanded;
 };
 
-extern jm_callbacks fmi1_import_active_fmu_store_callbacks;
+/* Registry of the instances of the FMUs loaded with registerGlobally set. It maps
+   the component pointers to the FMUs for fmi1_log_forwarding(). */
+jm_status_enu_t fmi1_import_register_component(fmi1_import_t* fmu, fmi1_component_t c);
 
-extern jm_vector(jm_voidp) fmi1_import_active_fmu_store;
+void fmi1_import_unregister_component(fmi1_import_t* fmu, fmi1_component_t c);
 
-extern jm_vector(jm_voidp)* fmi1_import_active_fmu;
+fmi1_import_t* fmi1_import_find_component(fmi1_component_t c);
 
 #ifdef __cplusplus
 }
@@ -17,6 +17,7 @@
 #include <stdarg.h>
 
 #include <JM/jm_named_ptr.h>
+#include <JM/jm_trace.h>
 #include <FMI2/fmi2_types.h>
 #include <FMI2/fmi2_functions.h>
 #include <FMI2/fmi2_enums.h>
@@ -31,23 +32,68 @@ static const char* module = "FMILIB";
 /*#include "fmi2_import_vendor_annotations_impl.h"
 #include "fmi2_import_parser.h"
 */
-fmi2_import_t* fmi2_import_allocate(jm_callbacks* cb) {
+/* The FMU object and the accounting record are allocated with the parent callbacks 'cb'.
+   Everything else uses fmu->callbacks. */
+fmi2_import_t* fmi2_import_allocate(jm_callbacks* cb, int memoryAccounting) {
 	fmi2_import_t* fmu = (fmi2_import_t*)cb->calloc(1, sizeof(fmi2_import_t));
+	jm_memory_scope_t scope;
 
-	if(!fmu || (jm_vector_init(char)(&fmu->logMessageBufferCoded,JM_MAX_ERROR_MESSAGE_SIZE,cb) < JM_MAX_ERROR_MESSAGE_SIZE)) {
+	if(!fmu) {
 		jm_log_fatal(cb, module, "Could not allocate memory");
-        if(fmu) cb->free(fmu);
 		return 0;
 	}
+	fmu->callbacks = cb;
+	fmu->memory = 0;
+	if(memoryAccounting) {
+		fmu->memory = (jm_memory_accounting_t*)cb->malloc(sizeof(jm_memory_accounting_t));
+		if(!fmu->memory) {
+			jm_log_fatal(cb, module, "Could not allocate memory");
+			cb->free(fmu);
+			return 0;
+		}
+		/* The number of parent callbacks is limited, the FMU is still usable without accounting */
+		if(!(fmu->callbacks = jm_memory_accounting_init(fmu->memory, cb))) {
+			jm_log_warning(cb, module, "Could not initialize the memory accounting, continuing without it");
+			cb->free(fmu->memory);
+			fmu->memory = 0;
+			fmu->callbacks = cb;
+		}
+	}
+	if(jm_mutex_init(&fmu->asyncLock) != jm_status_success) {
+		jm_log_fatal(cb, module, "Could not initialize the synchronization primitives");
+		if(fmu->memory) {
+			jm_memory_accounting_destroy(fmu->memory);
+			cb->free(fmu->memory);
+		}
+		cb->free(fmu);
+		return 0;
+	}
+
+	jm_memory_scope_enter(&scope, fmu->memory, jm_memory_subsystem_log);
+	/* Both buffers are initialized before fmi2_import_free() may release them */
+	jm_vector_init(char)(&fmu->logMessageBufferExpanded,0,fmu->callbacks);
+	jm_vector_init(char)(&fmu->logMessageBufferSink,0,fmu->callbacks);
+	if(jm_vector_init(char)(&fmu->logMessageBufferCoded,JM_MAX_ERROR_MESSAGE_SIZE,fmu->callbacks) < JM_MAX_ERROR_MESSAGE_SIZE) {
+		jm_memory_scope_leave(&scope);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		fmi2_import_free(fmu);
+		return 0;
+	}
+	jm_memory_scope_leave(&scope);
 	fmu->dirPath = 0;
 	fmu->resourceLocation = 0;
-	fmu->callbacks = cb;
 	fmu->capi = 0;
-	fmu->md = fmi2_xml_allocate_model_description(cb);
-	jm_vector_init(char)(&fmu->logMessageBufferExpanded,0,cb);
+	fmu->asyncStep = 0;
+	fmu->logSink = 0;
+	fmu->logFilter = 0;
+	fmu->selectionMasks = 0;
+	fmu->componentTree = 0;
+	jm_memory_scope_enter(&scope, fmu->memory, jm_memory_subsystem_xml_model);
+	fmu->md = fmi2_xml_allocate_model_description(fmu->callbacks);
+	jm_memory_scope_leave(&scope);
 
 	if(!fmu->md) {
-		cb->free(fmu);
+		fmi2_import_free(fmu);
 		return 0;
 	}
 
@@ -62,6 +108,7 @@ fmi2_import_t* fmi2_import_parse_xml( fmi_import_context_t* context, const char*
 	char* xmlPath;
 	char absPath[FILENAME_MAX + 2];
 	fmi2_import_t* fmu = 0;
+	jm_memory_scope_t scope;
 
 	if(strlen(dirPath) + 20 > FILENAME_MAX) {
 		jm_log_fatal(context->callbacks, module, "Directory path for FMU is too long");
@@ -69,19 +116,21 @@ fmi2_import_t* fmi2_import_parse_xml( fmi_import_context_t* context, const char*
 	}
 
 	xmlPath =  fmi_import_get_model_description_path(dirPath, context->callbacks);
-	fmu = fmi2_import_allocate(context->callbacks);
+	fmu = fmi2_import_allocate(context->callbacks, context->memoryAccounting);
 
 	if(!fmu) {
 		context->callbacks->free(xmlPath);
 		return 0;
 	}
 
-	if(jm_get_dir_abspath(context->callbacks, dirPath, absPath, FILENAME_MAX + 2)) {
-		size_t len = strlen(absPath);
-		strcpy(absPath + len, FMI_FILE_SEP "resources");
-		fmu->resourceLocation = fmi_import_create_URL_from_abs_path(context->callbacks, absPath);
+	jm_memory_scope_enter(&scope, fmu->memory, jm_memory_subsystem_other);
+	if(jm_get_dir_abspath(context->callbacks, dirPath, absPath, FILENAME_MAX + 2)) {
+		size_t len = strlen(absPath);
+		strcpy(absPath + len, FMI_FILE_SEP "resources");
+		fmu->resourceLocation = fmi_import_create_URL_from_abs_path(fmu->callbacks, absPath);
 	}
-	fmu->dirPath =  context->callbacks->malloc(strlen(dirPath) + 1);
+	fmu->dirPath =  fmu->callbacks->malloc(strlen(dirPath) + 1);
+	jm_memory_scope_leave(&scope);
 	if (!fmu->dirPath ||  !fmu->resourceLocation) {
 		jm_log_fatal( context->callbacks, "FMILIB", "Could not allocated memory");
 		fmi2_import_free(fmu);
@@ -92,12 +141,22 @@ fmi2_import_t* fmi2_import_parse_xml( fmi_import_context_t* context, const char*
 
 	jm_log_verbose( context->callbacks, "FMILIB", "Parsing model description XML");
 
+	jm_trace_begin("fmilib", "Parse XML");
+	jm_memory_scope_enter(&scope, fmu->memory, jm_memory_subsystem_xml_model);
 	if(fmi2_xml_parse_model_description( fmu->md, xmlPath, xml_callbacks)) {
+		jm_memory_scope_leave(&scope);
 		fmi2_import_free(fmu);
 		fmu = 0;
 	}
+	else
+		jm_memory_scope_leave(&scope);
+	jm_trace_end("fmilib", "Parse XML");
 	context->callbacks->free(xmlPath);
 
+	if(fmu && (fmi2_import_build_selection_masks(fmu) != jm_status_success)) {
+		fmi2_import_free(fmu);
+		fmu = 0;
+	}
 	if(fmu)
 		jm_log_verbose( context->callbacks, "FMILIB", "Parsing finished successfully");
 
@@ -111,15 +170,47 @@ void fmi2_import_free(fmi2_import_t* fmu) {
 	jm_log_verbose( fmu->callbacks, "FMILIB", "Releasing allocated library resources");	
 
 	fmi2_import_destroy_dllfmu(fmu);
+	fmi2_import_set_log_sink(fmu, 0);
+	fmi2_import_free_selection_masks(fmu);
+	fmi2_import_free_component_tree(fmu);
 	fmi2_xml_free_model_description(fmu->md);
 	jm_vector_free_data(char)(&fmu->logMessageBufferCoded);
 	jm_vector_free_data(char)(&fmu->logMessageBufferExpanded);
+	jm_vector_free_data(char)(&fmu->logMessageBufferSink);
+	jm_mutex_destroy(&fmu->asyncLock);
 
 	cb->free(fmu->resourceLocation);
 	cb->free(fmu->dirPath);
+	if(fmu->memory) {
+		cb = fmu->memory->parent;
+		jm_memory_accounting_destroy(fmu->memory);
+		cb->free(fmu->memory);
+	}
     cb->free(fmu);
 }
 
+jm_status_enu_t fmi2_import_get_memory_usage(fmi2_import_t* fmu, jm_memory_subsystem_enu_t subsystem, jm_memory_usage_t* usage) {
+	if(!fmu->memory) {
+		jm_log_error(fmu->callbacks, module, "Memory accounting is not enabled for the FMU");
+		return jm_status_error;
+	}
+	if(subsystem < jm_memory_subsystem_other || subsystem > jm_memory_subsystem_total) {
+		jm_log_error(fmu->callbacks, module, "Unknown memory subsystem %d", (int)subsystem);
+		return jm_status_error;
+	}
+	jm_memory_accounting_get_usage(fmu->memory, subsystem, usage);
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_log_memory_usage(fmi2_import_t* fmu) {
+	if(!fmu->memory) {
+		jm_log_error(fmu->callbacks, module, "Memory accounting is not enabled for the FMU");
+		return jm_status_error;
+	}
+	jm_memory_accounting_log(fmu->memory, fmu->callbacks, module);
+	return jm_status_success;
+}
+
 int fmi2_import_check_has_FMU(fmi2_import_t* fmu) {
 	if(!fmu->md) {
 		jm_log_error(fmu->callbacks, module,"No FMU is loaded");
@@ -309,6 +400,33 @@ fmi2_import_variable_list_t* fmi2_import_get_variable_list(fmi2_import_t* fmu, i
 	return 0;
 }
 
+fmi2_import_variable_list_t* fmi2_import_get_variables_by_name_prefix(fmi2_import_t* fmu, const char* prefix) {
+	fmi2_import_variable_list_t* vl;
+	jm_vector(jm_named_ptr)* vars;
+	size_t first, n, i;
+	if(!fmi2_import_check_has_FMU(fmu)) return 0;
+	vars = fmi2_xml_get_variables_alphabetical_order(fmu->md);
+	n = fmi2_xml_get_variable_name_prefix_range(fmu->md, prefix, strlen(prefix), &first);
+	vl = fmi2_import_alloc_variable_list(fmu, n);
+	if(!vl) return 0;
+	for(i = 0; i < n; i++) {
+		jm_vector_set_item(jm_voidp)(&vl->variables, i, jm_vector_get_item(jm_named_ptr)(vars, first + i).ptr);
+	}
+	return vl;
+}
+
+fmi2_import_variable_list_t* fmi2_import_get_variables_by_name_pattern(fmi2_import_t* fmu, const char* pattern) {
+	fmi2_import_variable_list_t* vl;
+	if(!fmi2_import_check_has_FMU(fmu)) return 0;
+	vl = fmi2_import_alloc_variable_list(fmu, 0);
+	if(!vl) return 0;
+	if(fmi2_xml_get_variables_by_name_pattern(fmu->md, pattern, &vl->variables) != jm_status_success) {
+		fmi2_import_free_variable_list(vl);
+		return 0;
+	}
+	return vl;
+}
+
 fmi2_fmu_kind_enu_t fmi2_import_get_fmu_kind(fmi2_import_t* fmu) {
     return fmi2_xml_get_fmu_kind(fmu->md);
 }
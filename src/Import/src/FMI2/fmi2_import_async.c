@@ -0,0 +1,213 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <JM/jm_thread.h>
+#include <JM/jm_thread_pool.h>
+#include <FMI2/fmi2_import_async.h>
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+struct fmi2_import_async_executor_t {
+	jm_callbacks* callbacks;
+	jm_thread_pool_t* pool;
+};
+
+struct fmi2_import_step_future_t {
+	fmi2_import_async_executor_t* executor;
+	fmi2_import_t* fmu;
+	fmi2_real_t currentCommunicationPoint;
+	fmi2_real_t communicationStepSize;
+	fmi2_boolean_t newStep;
+	fmi2_import_step_finished_ft callback;
+	void* userData;
+
+	/* 'lock' protects the fields below */
+	jm_mutex_t lock;
+	jm_cond_t finished;
+	int completing; /* set by the first completion, the FMU may report both with a return value and stepFinished */
+	int done;
+	fmi2_status_t status;
+};
+
+fmi2_import_async_executor_t* fmi2_import_async_executor_create(jm_callbacks* cb, size_t numThreads) {
+	fmi2_import_async_executor_t* executor;
+
+	if(!cb) cb = jm_get_default_callbacks();
+	executor = (fmi2_import_async_executor_t*)cb->calloc(1, sizeof(fmi2_import_async_executor_t));
+	if(!executor) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	executor->callbacks = cb;
+	executor->pool = jm_thread_pool_create(cb, numThreads);
+	if(!executor->pool) {
+		cb->free(executor);
+		return 0;
+	}
+	return executor;
+}
+
+void fmi2_import_async_executor_free(fmi2_import_async_executor_t* executor) {
+	if(!executor) return;
+	jm_thread_pool_free(executor->pool);
+	executor->callbacks->free(executor);
+}
+
+static void fmi2_import_step_complete(fmi2_import_step_future_t* future, fmi2_status_t status) {
+	jm_mutex_lock(&future->lock);
+	if(future->completing) {
+		jm_mutex_unlock(&future->lock);
+		return;
+	}
+	future->completing = 1;
+	jm_mutex_unlock(&future->lock);
+
+	if(future->callback) future->callback(future->fmu, status, future->userData);
+
+	/* The future may be freed by a waiting thread as soon as the lock is released */
+	jm_mutex_lock(&future->lock);
+	future->status = status;
+	future->done = 1;
+	jm_cond_broadcast(&future->finished);
+	jm_mutex_unlock(&future->lock);
+}
+
+static void fmi2_import_step_task(jm_thread_pool_t* pool, size_t worker, void* data) {
+	fmi2_import_step_future_t* future = (fmi2_import_step_future_t*)data;
+	fmi2_status_t status = fmi2_import_do_step(future->fmu, future->currentCommunicationPoint,
+		future->communicationStepSize, future->newStep);
+	fmi2_import_step_complete(future, status);
+}
+
+/* The FMU reports asynchronous completion through stepFinished and the FMIL forwarding function */
+static int fmi2_import_step_is_native(fmi2_import_t* fmu) {
+	return fmi2_import_get_capability(fmu, fmi2_cs_canRunAsynchronuously) &&
+		(fmu->capi->callBackFunctions.stepFinished == fmi2_import_step_finished_forwarding) &&
+		(fmu->capi->callBackFunctions.componentEnvironment == (fmi2_component_environment_t)fmu);
+}
+
+/* Forget the outstanding step of the FMU if it is the given one */
+static void fmi2_import_step_clear(fmi2_import_t* fmu, fmi2_import_step_future_t* future) {
+	jm_mutex_lock(&fmu->asyncLock);
+	if(fmu->asyncStep == future) fmu->asyncStep = 0;
+	jm_mutex_unlock(&fmu->asyncLock);
+}
+
+static void fmi2_import_step_future_destroy(fmi2_import_step_future_t* future) {
+	jm_callbacks* cb = future->executor->callbacks;
+	jm_cond_destroy(&future->finished);
+	jm_mutex_destroy(&future->lock);
+	cb->free(future);
+}
+
+fmi2_import_step_future_t* fmi2_import_do_step_async(fmi2_import_async_executor_t* executor, fmi2_import_t* fmu,
+	fmi2_real_t currentCommunicationPoint, fmi2_real_t communicationStepSize, fmi2_boolean_t newStep,
+	fmi2_import_step_finished_ft callback, void* userData) {
+	jm_callbacks* cb = executor->callbacks;
+	fmi2_import_step_future_t* future;
+
+	if(!fmu->capi) {
+		jm_log_error(fmu->callbacks, module, "FMU binary is not loaded");
+		return 0;
+	}
+	future = (fmi2_import_step_future_t*)cb->calloc(1, sizeof(fmi2_import_step_future_t));
+	if(!future) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	if(jm_mutex_init(&future->lock) != jm_status_success) {
+		cb->free(future);
+		jm_log_fatal(cb, module, "Could not initialize the synchronization primitives");
+		return 0;
+	}
+	if(jm_cond_init(&future->finished) != jm_status_success) {
+		jm_mutex_destroy(&future->lock);
+		cb->free(future);
+		jm_log_fatal(cb, module, "Could not initialize the synchronization primitives");
+		return 0;
+	}
+	future->executor = executor;
+	future->fmu = fmu;
+	future->currentCommunicationPoint = currentCommunicationPoint;
+	future->communicationStepSize = communicationStepSize;
+	future->newStep = newStep;
+	future->callback = callback;
+	future->userData = userData;
+
+	jm_mutex_lock(&fmu->asyncLock);
+	if(fmu->asyncStep) {
+		jm_mutex_unlock(&fmu->asyncLock);
+		fmi2_import_step_future_destroy(future);
+		jm_log_error(fmu->callbacks, module, "An asynchronous step of the FMU is outstanding");
+		return 0;
+	}
+	fmu->asyncStep = future;
+	jm_mutex_unlock(&fmu->asyncLock);
+
+	if(fmi2_import_step_is_native(fmu)) {
+		fmi2_status_t status = fmi2_import_do_step(fmu, currentCommunicationPoint, communicationStepSize, newStep);
+		if(status != fmi2_status_pending) fmi2_import_step_complete(future, status);
+	}
+	else if(jm_thread_pool_submit(executor->pool, fmi2_import_step_task, future) != jm_status_success) {
+		fmi2_import_step_clear(fmu, future);
+		fmi2_import_step_future_destroy(future);
+		return 0;
+	}
+	return future;
+}
+
+int fmi2_import_step_future_is_done(fmi2_import_step_future_t* future) {
+	int done;
+	jm_mutex_lock(&future->lock);
+	done = future->done;
+	jm_mutex_unlock(&future->lock);
+	return done;
+}
+
+fmi2_status_t fmi2_import_step_future_wait(fmi2_import_step_future_t* future) {
+	fmi2_status_t status;
+
+	jm_mutex_lock(&future->lock);
+	while(!future->done)
+		jm_cond_wait(&future->finished, &future->lock);
+	status = future->status;
+	jm_mutex_unlock(&future->lock);
+	fmi2_import_step_clear(future->fmu, future);
+	return status;
+}
+
+void fmi2_import_step_future_free(fmi2_import_step_future_t* future) {
+	if(!future) return;
+	fmi2_import_step_future_wait(future);
+	fmi2_import_step_future_destroy(future);
+}
+
+void fmi2_import_step_finished_forwarding(fmi2_component_environment_t env, fmi2_status_t status) {
+	fmi2_import_t* fmu = (fmi2_import_t*)env;
+	fmi2_import_step_future_t* future;
+
+	if(!fmu) return;
+	/* asyncStep is set before the FMU is called and is only cleared once the step is done,
+	   so the future stays valid until it is completed here */
+	jm_mutex_lock(&fmu->asyncLock);
+	future = fmu->asyncStep;
+	jm_mutex_unlock(&fmu->asyncLock);
+	if(!future) {
+		jm_log_warning(fmu->callbacks, module, "stepFinished called without an outstanding asynchronous step");
+		return;
+	}
+	fmi2_import_step_complete(future, status);
+}
@@ -36,6 +36,7 @@ jm_status_enu_t fmi2_import_create_dllfmu(fmi2_import_t* fmu, fmi2_fmu_kind_enu_
 	char* dllFileName = 0;
 	const char* modelIdentifier;
 	fmi2_callback_functions_t defaultCallbacks;
+	jm_memory_scope_t scope;
 
 	if (fmu == NULL) {
 		assert(0);
@@ -70,8 +71,10 @@ jm_status_enu_t fmi2_import_create_dllfmu(fmi2_import_t* fmu, fmi2_fmu_kind_enu_
 		curDir[0] = 0;
 	};
 
+	jm_memory_scope_enter(&scope, fmu->memory, jm_memory_subsystem_capi);
 	dllDirPath = fmi_construct_dll_dir_name(fmu->callbacks, fmu->dirPath);
 	dllFileName = fmi_construct_dll_file_name(fmu->callbacks, dllDirPath, modelIdentifier);
+	jm_memory_scope_leave(&scope);
 
 	if (!dllDirPath ||!dllFileName) {
 		fmu->callbacks->free(dllDirPath);
@@ -97,7 +100,9 @@ jm_status_enu_t fmi2_import_create_dllfmu(fmi2_import_t* fmu, fmi2_fmu_kind_enu_
 	}
 	else {
 		/* Allocate memory for the C-API struct */
+		jm_memory_scope_enter(&scope, fmu->memory, jm_memory_subsystem_capi);
 		fmu -> capi = fmi2_capi_create_dllfmu(fmu->callbacks, dllFileName, modelIdentifier, callBackFunctions, fmuKind);
+		jm_memory_scope_leave(&scope);
 	}
 
 
@@ -143,6 +148,44 @@ void fmi2_import_set_debug_mode(fmi2_import_t* fmu, int mode) {
 	fmi2_capi_set_debug_mode(fmu->capi, mode);
 }
 
+jm_status_enu_t fmi2_import_get_call_statistics(fmi2_import_t* fmu, fmi2_function_enu_t f, jm_call_statistics_t* stats) {
+	const jm_call_statistics_t* s;
+	if(!fmu->capi) {
+		jm_log_error(fmu->callbacks, module,"FMU CAPI is not loaded");
+		return jm_status_error;
+	}
+	s = fmi2_capi_get_call_statistics(fmu->capi, f);
+	if(!s) {
+		jm_log_error(fmu->callbacks, module,"Call statistics are not available for function %d", (int)f);
+		return jm_status_error;
+	}
+	*stats = *s;
+	return jm_status_success;
+}
+
+void fmi2_import_reset_call_statistics(fmi2_import_t* fmu) {
+	if(!fmu->capi) return;
+	fmi2_capi_reset_call_statistics(fmu->capi);
+}
+
+void fmi2_import_log_call_statistics(fmi2_import_t* fmu) {
+	const jm_call_statistics_t* s;
+	int f;
+	if(!fmu->capi) {
+		jm_log_error(fmu->callbacks, module,"FMU CAPI is not loaded");
+		return;
+	}
+	for(f = 0; f < fmi2_functions_Num; f++) {
+		s = fmi2_capi_get_call_statistics(fmu->capi, (fmi2_function_enu_t)f);
+		if(!s) {
+			jm_log_warning(fmu->callbacks, module, "Call statistics are not available (the library is compiled without FMILIB_ENABLE_CALL_STATISTICS)");
+			return;
+		}
+		if(s->count > 0)
+			jm_call_statistics_log(fmu->callbacks, module, fmi2_function_to_string((fmi2_function_enu_t)f), s);
+	}
+}
+
 void fmi2_import_destroy_dllfmu(fmi2_import_t* fmu) {
 	
 	if (fmu == NULL) {
@@ -0,0 +1,271 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+
+#include <FMI2/fmi2_import_component.h>
+#include "fmi2_import_impl.h"
+#include "fmi2_import_variable_list_impl.h"
+
+static const char* module = "FMILIB";
+
+#define FMI2_COMPONENT_NO_PARENT ((size_t)-1)
+
+/* Components refer to each other by index into the node array of the tree */
+struct fmi2_import_component_t {
+	fmi2_import_component_tree_t* tree;
+	const char* path;   /* slice of the name of the first variable of the subtree */
+	size_t pathLen;
+	size_t nameLen;     /* the name is the last nameLen characters of the path */
+	size_t parent;
+	size_t firstChild;
+	size_t numChildren;
+	size_t firstVariable; /* index into the variable list, an index into the alphabetical order while building */
+	size_t numVariables;
+	size_t numSubtreeVariables;
+};
+
+struct fmi2_import_component_tree_t {
+	fmi2_import_component_t* nodes;
+	size_t numNodes;
+	size_t capacity;
+	int structured;
+	/* The variables of the tree in depth first order */
+	fmi2_import_variable_list_t* variables;
+};
+
+/* Length of the first component of a structured name, or 0 if the name has no top level dot.
+   Dots inside brackets, parentheses and quoted identifiers do not separate components. */
+static size_t fmi2_import_component_name_len(const char* name) {
+	size_t i, depth = 0;
+	int quoted = 0;
+
+	for(i = 0; name[i]; i++) {
+		char ch = name[i];
+		if(quoted) {
+			if(ch == '\\' && name[i + 1]) i++;
+			else if(ch == '\'') quoted = 0;
+		}
+		else if(ch == '\'') quoted = 1;
+		else if((ch == '[') || (ch == '(')) depth++;
+		else if(((ch == ']') || (ch == ')')) && depth) depth--;
+		else if((ch == '.') && !depth) return i;
+	}
+	return 0;
+}
+
+/* Compare component names as they are ordered in the alphabetical order of the variables,
+   i.e., as if each was followed by the separating dot */
+static int fmi2_import_compare_component_names(const char* a, size_t alen, const char* b, size_t blen) {
+	size_t len = (alen < blen) ? alen : blen;
+	int c = memcmp(a, b, len);
+
+	if(c || (alen == blen)) return c;
+	if(alen < blen) {
+		c = (unsigned char)b[alen];
+		return (c == '.') ? -1 : ('.' - c);
+	}
+	c = (unsigned char)a[blen];
+	return (c == '.') ? 1 : (c - '.');
+}
+
+static size_t fmi2_import_new_component(fmi2_import_component_tree_t* tree, jm_callbacks* cb) {
+	fmi2_import_component_t* c;
+
+	if(tree->numNodes == tree->capacity) {
+		size_t capacity = tree->capacity ? 2 * tree->capacity : 16;
+		fmi2_import_component_t* nodes = (fmi2_import_component_t*)cb->realloc(tree->nodes, capacity * sizeof(fmi2_import_component_t));
+		if(!nodes) return FMI2_COMPONENT_NO_PARENT;
+		tree->nodes = nodes;
+		tree->capacity = capacity;
+	}
+	c = &tree->nodes[tree->numNodes];
+	memset(c, 0, sizeof(fmi2_import_component_t));
+	c->tree = tree;
+	return tree->numNodes++;
+}
+
+/*
+	Build the subtree of a component from the range of the alphabetical order that shares its path.
+	All the names with the prefix "path." are contiguous in the alphabetical order, so the children
+	are found in one pass over the range. The children are allocated next to each other before
+	the recursion, and the variables of the component are added before the subtrees of the children.
+*/
+static jm_status_enu_t fmi2_import_build_component(fmi2_import_component_tree_t* tree, size_t index, jm_vector(jm_named_ptr)* names, jm_callbacks* cb) {
+	fmi2_import_component_t* c = &tree->nodes[index];
+	size_t prefixLen = c->pathLen ? c->pathLen + 1 : 0;
+	size_t first = c->firstVariable;
+	size_t last = first + c->numSubtreeVariables;
+	size_t i;
+
+	c->firstVariable = jm_vector_get_size(jm_voidp)(&tree->variables->variables);
+	c->firstChild = tree->numNodes;
+	for(i = first; i < last; i++) {
+		jm_named_ptr np = jm_vector_get_item(jm_named_ptr)(names, i);
+		const char* local = np.name + prefixLen;
+		size_t len = tree->structured ? fmi2_import_component_name_len(local) : 0;
+		fmi2_import_component_t* child;
+
+		if(!len) {
+			jm_vector_push_back(jm_voidp)(&tree->variables->variables, np.ptr);
+			tree->nodes[index].numVariables++;
+			continue;
+		}
+		c = &tree->nodes[index];
+		if(c->numChildren) {
+			child = &tree->nodes[tree->numNodes - 1];
+			if((child->nameLen == len) && !memcmp(child->path + prefixLen, local, len)) {
+				child->numSubtreeVariables++;
+				continue;
+			}
+		}
+		if(fmi2_import_new_component(tree, cb) == FMI2_COMPONENT_NO_PARENT) return jm_status_error;
+		c = &tree->nodes[index];
+		c->numChildren++;
+		child = &tree->nodes[tree->numNodes - 1];
+		child->path = np.name;
+		child->pathLen = prefixLen + len;
+		child->nameLen = len;
+		child->parent = index;
+		child->firstVariable = i;
+		child->numSubtreeVariables = 1;
+	}
+	c = &tree->nodes[index];
+	for(i = c->firstChild; i < c->firstChild + c->numChildren; i++) {
+		if(fmi2_import_build_component(tree, i, names, cb) != jm_status_success) return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+static jm_status_enu_t fmi2_import_build_component_tree(fmi2_import_t* fmu) {
+	jm_callbacks* cb = fmu->callbacks;
+	jm_vector(jm_named_ptr)* names = fmi2_xml_get_variables_alphabetical_order(fmu->md);
+	size_t n = names ? jm_vector_get_size(jm_named_ptr)(names) : 0;
+	fmi2_import_component_tree_t* tree;
+	fmi2_import_component_t* root;
+
+	tree = (fmi2_import_component_tree_t*)cb->calloc(1, sizeof(fmi2_import_component_tree_t));
+	if(tree) tree->variables = fmi2_import_alloc_variable_list(fmu, 0);
+	if(!tree || !tree->variables || (jm_vector_reserve(jm_voidp)(&tree->variables->variables, n) < n)
+		|| (fmi2_import_new_component(tree, cb) == FMI2_COMPONENT_NO_PARENT)) {
+		fmu->componentTree = tree;
+		fmi2_import_free_component_tree(fmu);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	tree->structured = (fmi2_xml_get_naming_convention(fmu->md) == fmi2_naming_enu_structured);
+	root = &tree->nodes[0];
+	root->path = "";
+	root->parent = FMI2_COMPONENT_NO_PARENT;
+	root->numSubtreeVariables = n;
+	fmu->componentTree = tree;
+	if(fmi2_import_build_component(tree, 0, names, cb) != jm_status_success) {
+		fmi2_import_free_component_tree(fmu);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	jm_log_verbose(cb, module, "Built a component tree with %u components", (unsigned)tree->numNodes);
+	return jm_status_success;
+}
+
+void fmi2_import_free_component_tree(fmi2_import_t* fmu) {
+	fmi2_import_component_tree_t* tree = fmu->componentTree;
+
+	if(!tree) return;
+	fmi2_import_free_variable_list(tree->variables);
+	fmu->callbacks->free(tree->nodes);
+	fmu->callbacks->free(tree);
+	fmu->componentTree = 0;
+}
+
+fmi2_import_component_t* fmi2_import_get_root_component(fmi2_import_t* fmu) {
+	if(!fmu->componentTree && (fmi2_import_build_component_tree(fmu) != jm_status_success)) return 0;
+	return &fmu->componentTree->nodes[0];
+}
+
+fmi2_import_component_t* fmi2_import_find_component(fmi2_import_t* fmu, const char* path) {
+	fmi2_import_component_t* c = fmi2_import_get_root_component(fmu);
+	size_t len;
+
+	if(!c || !path || !*path) return c;
+	if(!c->tree->structured) return 0;
+	while(c) {
+		len = fmi2_import_component_name_len(path);
+		if(!len) return fmi2_import_get_child_component_by_name(c, path, strlen(path));
+		c = fmi2_import_get_child_component_by_name(c, path, len);
+		path += len + 1;
+	}
+	return 0;
+}
+
+const char* fmi2_import_get_component_name(fmi2_import_component_t* c, size_t* len) {
+	*len = c->nameLen;
+	return c->path + c->pathLen - c->nameLen;
+}
+
+const char* fmi2_import_get_component_path(fmi2_import_component_t* c, size_t* len) {
+	*len = c->pathLen;
+	return c->path;
+}
+
+fmi2_import_component_t* fmi2_import_get_parent_component(fmi2_import_component_t* c) {
+	if(c->parent == FMI2_COMPONENT_NO_PARENT) return 0;
+	return &c->tree->nodes[c->parent];
+}
+
+size_t fmi2_import_get_number_of_child_components(fmi2_import_component_t* c) {
+	return c->numChildren;
+}
+
+fmi2_import_component_t* fmi2_import_get_child_component(fmi2_import_component_t* c, size_t index) {
+	if(index >= c->numChildren) return 0;
+	return &c->tree->nodes[c->firstChild + index];
+}
+
+fmi2_import_component_t* fmi2_import_get_child_component_by_name(fmi2_import_component_t* c, const char* name, size_t len) {
+	fmi2_import_component_t* children = &c->tree->nodes[c->firstChild];
+	size_t lo = 0, hi = c->numChildren;
+
+	while(lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		size_t midLen;
+		const char* midName = fmi2_import_get_component_name(&children[mid], &midLen);
+		int cmp = fmi2_import_compare_component_names(name, len, midName, midLen);
+		if(!cmp) return &children[mid];
+		if(cmp < 0) hi = mid;
+		else lo = mid + 1;
+	}
+	return 0;
+}
+
+void fmi2_import_get_component_variables(fmi2_import_component_t* c, fmi2_import_variable_list_view_t* view) {
+	view->list = c->tree->variables;
+	view->first = c->firstVariable;
+	view->size = c->numVariables;
+}
+
+void fmi2_import_get_component_subtree_variables(fmi2_import_component_t* c, fmi2_import_variable_list_view_t* view) {
+	view->list = c->tree->variables;
+	view->first = c->firstVariable;
+	view->size = c->numSubtreeVariables;
+}
+
+const char* fmi2_import_get_variable_local_name(fmi2_import_component_t* c, fmi2_import_variable_t* v) {
+	const char* name = fmi2_import_get_variable_name(v);
+
+	if(!c->pathLen) return name;
+	if(strncmp(name, c->path, c->pathLen) || (name[c->pathLen] != '.')) return 0;
+	return name + c->pathLen + 1;
+}
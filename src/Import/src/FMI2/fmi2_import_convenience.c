@@ -98,139 +98,178 @@ void fmi2_import_collect_model_counts(fmi2_import_t* fmu, fmi2_import_model_coun
     return;
 }
 
-void fmi2_import_expand_variable_references_impl(fmi2_import_t* fmu, const char* msgIn);
+/* Append n characters to the output, storing only what fits before the terminating 0 */
+static void fmi2_import_expand_append(char* out, size_t outSize, size_t len, const char* s, size_t n) {
+	if(len + 1 < outSize) {
+		size_t room = outSize - 1 - len;
+		memcpy(out + len, s, (n < room) ? n : room);
+	}
+}
+
+/* Report a malformed reference and replace the output with the original message */
+static size_t fmi2_import_expand_error(fmi2_import_t* fmu, const char* msgIn, char* out, size_t outSize, size_t len, const char* what) {
+	char here[JM_MAX_ERROR_MESSAGE_SIZE];
+	size_t msgLen = strlen(msgIn);
+
+	/* The output may be the message buffer of the callbacks that jm_log() formats into */
+	here[0] = 0;
+	if(outSize) {
+		out[(len < outSize) ? len : outSize - 1] = 0;
+		strncpy(here, out, JM_MAX_ERROR_MESSAGE_SIZE);
+		here[JM_MAX_ERROR_MESSAGE_SIZE - 1] = 0;
+	}
+	jm_log(fmu->callbacks,"LOGGER", jm_log_level_warning, "%s in log message here: '%s'", what, here);
+	if(outSize) {
+		fmi2_import_expand_append(out, outSize, 0, msgIn, msgLen);
+		out[(msgLen < outSize) ? msgLen : outSize - 1] = 0;
+	}
+	return msgLen;
+}
+
+/* Print msgIn into out by expanding variable references of the form #<Type><VR># into variable names
+  and replacing '##' with a single #. The message is scanned once and the output is truncated to outSize.
+  Returns the length of the complete output, i.e., a value >= outSize if the output was truncated.
+  On a malformed reference a warning is logged, *malformed is set and the output is msgIn. */
+static size_t fmi2_import_expand_refs(fmi2_import_t* fmu, const char* msgIn, char* out, size_t outSize, int* malformed) {
+	const char* p = msgIn;
+	const char* hash;
+	size_t len = 0, tailLen;
+
+	*malformed = 1;
+	while((hash = strchr(p, '#')) != 0) {
+		fmi2_value_reference_t vr = 0;
+		fmi2_base_type_enu_t baseType;
+		fmi2_xml_variable_t* var;
+		const char* digits;
+		const char* name;
+		size_t num_digits, nameLen;
+		int overflow = 0;
+
+		fmi2_import_expand_append(out, outSize, len, p, hash - p);
+		len += hash - p;
+		p = hash + 1;
+		if(*p == '#') {
+			fmi2_import_expand_append(out, outSize, len, "#", 1);
+			len++;
+			p++;
+			continue;
+		}
+		switch(*p) {
+			case 'r':
+				baseType = fmi2_base_type_real;
+				break;
+			case 'i':
+				baseType = fmi2_base_type_int;
+				break;
+			case 'b':
+				baseType = fmi2_base_type_bool;
+				break;
+			case 's':
+				baseType = fmi2_base_type_str;
+				break;
+			default:
+				return fmi2_import_expand_error(fmu, msgIn, out, outSize, len,
+					"Expected type specification character 'r', 'i', 'b' or 's'");
+		}
+		digits = ++p;
+		while(isdigit((unsigned char)*p)) {
+			fmi2_value_reference_t d = (fmi2_value_reference_t)(*p - '0');
+			if(vr > ((fmi2_value_reference_t)-1 - d) / 10) overflow = 1;
+			vr = vr * 10 + d;
+			p++;
+		}
+		/* The digits are shown in the warnings */
+		num_digits = p - digits;
+		fmi2_import_expand_append(out, outSize, len, digits, num_digits);
+		if(num_digits == 0) {
+			return fmi2_import_expand_error(fmu, msgIn, out, outSize, len, "Expected value reference");
+		}
+		else if(*p != '#') {
+			return fmi2_import_expand_error(fmu, msgIn, out, outSize, len + num_digits, "Expected terminating '#'");
+		}
+		if(overflow) {
+			return fmi2_import_expand_error(fmu, msgIn, out, outSize, len + num_digits, "Could not decode value reference");
+		}
+		var = fmi2_xml_get_variable_by_vr(fmu->md, baseType, vr);
+		if(!var) {
+			return fmi2_import_expand_error(fmu, msgIn, out, outSize, len + num_digits, "Could not find variable referenced");
+		}
+		name = fmi2_xml_get_variable_name(var);
+		nameLen = strlen(name);
+		fmi2_import_expand_append(out, outSize, len, name, nameLen);
+		len += nameLen;
+		p++; /* skip the terminating # */
+	}
+	tailLen = strlen(p);
+	*malformed = 0;
+	fmi2_import_expand_append(out, outSize, len, p, tailLen);
+	len += tailLen;
+	if(outSize) {
+		out[(len < outSize) ? len : outSize - 1] = 0;
+	}
+	return len;
+}
 
 void fmi2_import_expand_variable_references(fmi2_import_t* fmu, const char* msgIn, char* msgOut, size_t maxMsgSize) {
-	fmi2_import_expand_variable_references_impl(fmu, msgIn);
-	strncpy(msgOut, jm_vector_get_itemp(char)(&fmu->logMessageBufferExpanded,0),maxMsgSize);
-	msgOut[maxMsgSize - 1] = '\0';
+	int malformed;
+	fmi2_import_expand_refs(fmu, msgIn, msgOut, maxMsgSize, &malformed);
 }
 
-/* Print msgIn into msgOut by expanding variable references of the form #<Type><VR># into variable names
-  and replacing '##' with a single # */
-void fmi2_import_expand_variable_references_impl(fmi2_import_t* fmu, const char* msgIn){
-	jm_vector(char)* msgOut = &fmu->logMessageBufferExpanded;
-	fmi2_xml_model_description_t* md = fmu->md;
-	jm_callbacks* callbacks = fmu->callbacks;
-    char curCh;
-	const char* firstRef;
-    size_t i; /* next char index after curCh in msgIn*/ 
-	size_t msgLen = strlen(msgIn)+1; /* original message length including terminating 0 */
-
-	if(jm_vector_reserve(char)(msgOut, msgLen + 100) < msgLen + 100) {
-		jm_log(fmu->callbacks,"LOGGER", jm_log_level_warning, "Could not allocate memory for the log message");
-		jm_vector_resize(char)(msgOut, 6);
-		memcpy(jm_vector_get_itemp(char)(msgOut,0),"ERROR",6); /* at least 16 chars are always there */
-		return;
+/* Expand msgIn into a log message buffer of the FMU, which is grown as needed and keeps its size
+  between the messages. Returns the expanded message, msgIn if it is malformed or NULL if the buffer
+  could not be grown. */
+static const char* fmi2_import_expand_variable_references_impl(fmi2_import_t* fmu, jm_vector(char)* msgOut, const char* msgIn) {
+	size_t size = jm_vector_get_size(char)(msgOut), len;
+	int malformed;
+
+	if(size < JM_MAX_ERROR_MESSAGE_SIZE) {
+		size = jm_vector_resize(char)(msgOut, JM_MAX_ERROR_MESSAGE_SIZE);
+	}
+	len = fmi2_import_expand_refs(fmu, msgIn, jm_vector_get_itemp(char)(msgOut, 0), size, &malformed);
+	if(len < size) {
+		return jm_vector_get_itemp(char)(msgOut, 0);
+	}
+	if(malformed) {
+		return msgIn;
+	}
+	if(jm_vector_resize(char)(msgOut, len + 1) < len + 1) {
+		return 0;
 	}
+	fmi2_import_expand_refs(fmu, msgIn, jm_vector_get_itemp(char)(msgOut, 0), len + 1, &malformed);
+	return jm_vector_get_itemp(char)(msgOut, 0);
+}
 
-	/* check if there are any refs at all and copy the head of the string without references */
-	firstRef = strchr(msgIn, '#');
-	if(firstRef) {
-		i = firstRef - msgIn;
-		jm_vector_resize(char)(msgOut, i);
-		if(i) {
-			memcpy(jm_vector_get_itemp(char)(msgOut, 0), msgIn, i);
-		}
-		curCh = msgIn[i++];
+/* Delivery of a message posted by fmi2_log_forwarding_v(), called on the thread of the log sink.
+   The message is expanded into a buffer of its own and the logger is called directly, so that the
+   buffers used by the threads that call the FMU, including errMessageBuffer, are not touched. */
+static void fmi2_import_deliver_log(void* target, jm_string module, jm_log_level_enu_t log_level, jm_string message) {
+	fmi2_import_t* fmu = (fmi2_import_t*)target;
+	/* The accounting logger would copy the message into errMessageBuffer of the parent */
+	jm_callbacks* cb = fmu->memory ? fmu->memory->parent : fmu->callbacks;
+	jm_memory_scope_t scope;
+	const char* msg;
+
+	if(!cb->logger) return;
+	jm_memory_scope_enter(&scope, fmu->memory, jm_memory_subsystem_log);
+	msg = fmi2_import_expand_variable_references_impl(fmu, &fmu->logMessageBufferSink, message);
+	jm_memory_scope_leave(&scope);
+	if(!msg) {
+		if(jm_log_level_warning <= cb->log_level)
+			cb->logger(cb, "LOGGER", jm_log_level_warning, "Could not allocate memory for the log message");
+		msg = message;
 	}
-	else {
-		jm_vector_resize(char)(msgOut, msgLen);
-		memcpy(jm_vector_get_itemp(char)(msgOut, 0), msgIn, msgLen);
-		return;
+	cb->logger(cb, module, log_level, msg);
+}
+
+void fmi2_import_set_log_sink(fmi2_import_t* fmu, jm_log_sink_t* sink) {
+	if(fmu->logSink) {
+		jm_log_sink_flush(fmu->logSink);
 	}
-    do {
-        if (curCh!='#') {
-            jm_vector_push_back(char)(msgOut, curCh); /* copy in to out */
-        }
-		else if(msgIn[i] == '#') {
-			jm_vector_push_back(char)(msgOut, '#');
-			i++; /* skip the second # */
-		}
-		else {
-            unsigned int bufVR;
-			fmi2_value_reference_t vr;
-			char typeChar = msgIn[i++];
-			size_t pastePos = jm_vector_get_size(char)(msgOut);
-			fmi2_base_type_enu_t baseType;
-			size_t num_digits;
-			fmi2_xml_variable_t* var;
-			const char* name;
-			size_t nameLen;
-			switch(typeChar) {
-				case 'r': 
-					baseType = fmi2_base_type_real;
-					break;
-				case 'i': 
-					baseType = fmi2_base_type_int;
-					break;
-				case 'b': 
-					baseType = fmi2_base_type_bool;
-					break;
-				case 's': 
-					baseType = fmi2_base_type_str;
-					break;
-				default:
-					jm_vector_push_back(char)(msgOut, 0);
-					jm_log(callbacks,"LOGGER", jm_log_level_warning, 
-						"Expected type specification character 'r', 'i', 'b' or 's' in log message here: '%s'", 
-					jm_vector_get_itemp(char)(msgOut,0));
-                    jm_vector_resize(char)(msgOut, msgLen);
-					memcpy(jm_vector_get_itemp(char)(msgOut,0),msgIn,msgLen);
-					return;
-			}
-            curCh = msgIn[i++];
-			while( isdigit(curCh) ) {
-				jm_vector_push_back(char)(msgOut, curCh);
-	            curCh = msgIn[i++];
-			}
-			num_digits = jm_vector_get_size(char)(msgOut) - pastePos;
-			jm_vector_push_back(char)(msgOut, 0);
-			if(num_digits == 0) {
-				jm_log(callbacks,"LOGGER", jm_log_level_warning, "Expected value reference in log message here: '%s'", jm_vector_get_itemp(char)(msgOut,0));
-                                jm_vector_resize(char)(msgOut, msgLen);
-                jm_vector_resize(char)(msgOut, msgLen);
-				memcpy(jm_vector_get_itemp(char)(msgOut,0),msgIn,msgLen);
-				return;
-			}
-			else if(curCh != '#') {
-				jm_log(callbacks,"LOGGER", jm_log_level_warning, "Expected terminating '#' in log message here: '%s'", jm_vector_get_itemp(char)(msgOut,0));
-                                jm_vector_resize(char)(msgOut, msgLen);
-                jm_vector_resize(char)(msgOut, msgLen);
-				memcpy(jm_vector_get_itemp(char)(msgOut,0),msgIn,msgLen);
-				return;
-			}
-			
-			if(sscanf(jm_vector_get_itemp(char)(msgOut, pastePos), "%u",&bufVR) != 1) {
-				jm_log(callbacks,"LOGGER", jm_log_level_warning, "Could not decode value reference in log message here: '%s'", jm_vector_get_itemp(char)(msgOut,0));
-                                jm_vector_resize(char)(msgOut, msgLen);
-                jm_vector_resize(char)(msgOut, msgLen);
-				memcpy(jm_vector_get_itemp(char)(msgOut,0),msgIn,msgLen);
-				return;
-			}
-            vr = bufVR;
-			var = fmi2_xml_get_variable_by_vr(md,baseType,vr);
-			if(!var) {
-				jm_log(callbacks,"LOGGER", jm_log_level_warning, "Could not find variable referenced in log message here: '%s'", jm_vector_get_itemp(char)(msgOut,0));
-                                jm_vector_resize(char)(msgOut, msgLen);
-                jm_vector_resize(char)(msgOut, msgLen);
-				memcpy(jm_vector_get_itemp(char)(msgOut,0),msgIn,msgLen);
-				return;
-			}
-			name = fmi2_xml_get_variable_name(var);
-			nameLen = strlen(name);
-			if(jm_vector_resize(char)(msgOut, pastePos + nameLen) != pastePos + nameLen) {
-				jm_log(callbacks,"LOGGER", jm_log_level_warning, "Could not allocate memory for the log message");
-                                jm_vector_resize(char)(msgOut, msgLen);
-                jm_vector_resize(char)(msgOut, msgLen);
-				memcpy(jm_vector_get_itemp(char)(msgOut,0),msgIn,msgLen);
-				return;
-			};
-			memcpy(jm_vector_get_itemp(char)(msgOut, pastePos), name, nameLen);
-        }
-        curCh = msgIn[i++];
-    } while (curCh);
-    jm_vector_push_back(char)(msgOut, 0);
+	fmu->logSink = sink;
+}
+
+jm_log_sink_t* fmi2_import_get_log_sink(fmi2_import_t* fmu) {
+	return fmu->logSink;
 }
 
 void  fmi2_log_forwarding(fmi2_component_environment_t c, fmi2_string_t instanceName, fmi2_status_t status, fmi2_string_t category, fmi2_string_t message, ...) {
@@ -242,8 +281,8 @@ void  fmi2_log_forwarding(fmi2_component_environment_t c, fmi2_string_t instance
 
 void  fmi2_log_forwarding_v(fmi2_component_environment_t c, fmi2_string_t instanceName, fmi2_status_t status, fmi2_string_t category, fmi2_string_t message, va_list args) {
 #define BUFSIZE JM_MAX_ERROR_MESSAGE_SIZE
-    char buffer[BUFSIZE], *buf, *curp, *msg;
-	const char* statusStr;
+    char buffer[BUFSIZE], *buf, *curp;
+	const char* statusStr, *msg;
 	fmi2_import_t* fmu = (fmi2_import_t*)c;
 	jm_callbacks* cb;
 	jm_log_level_enu_t logLevel;
@@ -274,7 +313,11 @@ void  fmi2_log_forwarding_v(fmi2_component_environment_t c, fmi2_string_t instan
 			logLevel = jm_log_level_fatal;
 	}
 
-    if(logLevel > cb->log_level) return;
+	/* Filter before the message is formatted */
+	if(fmu && fmu->logFilter) {
+		if(!fmi2_import_log_filter_accept(fmu->logFilter, instanceName, category, logLevel, cb->log_level)) return;
+	}
+	else if(logLevel > cb->log_level) return;
 
 	curp = buf;
     *curp = 0;
@@ -288,6 +331,7 @@ void  fmi2_log_forwarding_v(fmi2_component_environment_t c, fmi2_string_t instan
 	if(fmu) {
 	    int bufsize = jm_vector_get_size(char)(&fmu->logMessageBufferCoded);
         int len;
+        jm_memory_scope_t scope;
 #ifdef JM_VA_COPY
         va_list argscp;
         JM_VA_COPY(argscp, args);
@@ -295,7 +339,9 @@ void  fmi2_log_forwarding_v(fmi2_component_environment_t c, fmi2_string_t instan
         len = jm_vsnprintf(curp, bufsize -(curp-buf), message, args);
         if(len > (bufsize -(curp-buf+1))) {
             int offset = (curp-buf);
+            jm_memory_scope_enter(&scope, fmu->memory, jm_memory_subsystem_log);
             len = jm_vector_resize(char)(&fmu->logMessageBufferCoded, len + offset + 1) - offset;
+            jm_memory_scope_leave(&scope);
             buf = jm_vector_get_itemp(char)(&fmu->logMessageBufferCoded,0);
             curp = buf + offset;
 #ifdef JM_VA_COPY
@@ -305,8 +351,18 @@ void  fmi2_log_forwarding_v(fmi2_component_environment_t c, fmi2_string_t instan
 #ifdef JM_VA_COPY
         va_end(argscp);
 #endif
-		fmi2_import_expand_variable_references(fmu, buf, cb->errMessageBuffer,JM_MAX_ERROR_MESSAGE_SIZE);
-		msg = jm_vector_get_itemp(char)(&fmu->logMessageBufferExpanded,0);
+		if(fmu->logSink) {
+			/* The expansion and the delivery are done by the sink thread */
+			jm_log_sink_post(fmu->logSink, fmi2_import_deliver_log, fmu, instanceName, logLevel, buf);
+			return;
+		}
+		jm_memory_scope_enter(&scope, fmu->memory, jm_memory_subsystem_log);
+		msg = fmi2_import_expand_variable_references_impl(fmu, &fmu->logMessageBufferExpanded, buf);
+		jm_memory_scope_leave(&scope);
+		if(!msg) {
+			jm_log(fmu->callbacks,"LOGGER", jm_log_level_warning, "Could not allocate memory for the log message");
+			msg = buf;
+		}
 	}
 	else {
         jm_vsnprintf(curp, BUFSIZE -(curp-buf), message, args);
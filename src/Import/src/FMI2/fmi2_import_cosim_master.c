@@ -0,0 +1,665 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+
+#include <JM/jm_thread.h>
+#include <JM/jm_thread_pool.h>
+#include <FMI2/fmi2_import_cosim_master.h>
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+/* Connected variables are grouped by type: real, integer (and enumeration), boolean */
+#define FMI2_COSIM_NUM_TYPES 3
+#define FMI2_COSIM_REAL 0
+#define FMI2_COSIM_INTEGER 1
+#define FMI2_COSIM_BOOLEAN 2
+
+typedef enum fmi2_cosim_phase_enu_t {
+	fmi2_cosim_phase_gauss_seidel_step,
+	fmi2_cosim_phase_jacobi_step,
+	fmi2_cosim_phase_jacobi_exchange
+} fmi2_cosim_phase_enu_t;
+
+typedef struct fmi2_cosim_connection_t {
+	size_t src;
+	size_t dst;
+	int type;
+	fmi2_value_reference_t srcVr;
+	fmi2_value_reference_t dstVr;
+	size_t srcSlot;
+	size_t dstSlot;
+	int feedthrough; /* some output of dst depends directly on the input */
+	int ordered;     /* dst waits for src within a step; otherwise the value is copied before the step */
+} fmi2_cosim_connection_t;
+
+typedef struct fmi2_cosim_node_t {
+	fmi2_import_cosim_master_t* master;
+	fmi2_import_t* fmu;
+	size_t index;
+
+	/* Connected outputs and inputs per type. Inputs [0, npre) are set at the start
+	   of the step, [npre, nin) when the FMUs they depend on are done. */
+	size_t nout[FMI2_COSIM_NUM_TYPES];
+	size_t nin[FMI2_COSIM_NUM_TYPES];
+	size_t npre[FMI2_COSIM_NUM_TYPES];
+	fmi2_value_reference_t* outVr[FMI2_COSIM_NUM_TYPES];
+	fmi2_value_reference_t* inVr[FMI2_COSIM_NUM_TYPES];
+	fmi2_real_t* outReal;
+	fmi2_real_t* inReal;
+	fmi2_integer_t* outInteger;
+	fmi2_integer_t* inInteger;
+	fmi2_boolean_t* outBoolean;
+	fmi2_boolean_t* inBoolean;
+
+	/* Incoming connections, the ones copied before the step first */
+	size_t* inConn;
+	size_t numInConn;
+	size_t numPreConn;
+
+	/* Outgoing ordered connections */
+	size_t* outConn;
+	size_t numOutConn;
+
+	size_t remaining; /* ordered inputs not yet available in the current phase */
+} fmi2_cosim_node_t;
+
+struct fmi2_import_cosim_master_t {
+	jm_callbacks* callbacks;
+	fmi2_import_cosim_master_options_t options;
+	jm_thread_pool_t* pool;
+	jm_mutex_t lock;
+
+	fmi2_cosim_node_t** nodes;
+	size_t numNodes;
+	size_t capNodes;
+
+	fmi2_cosim_connection_t* conns;
+	size_t numConns;
+	size_t capConns;
+	size_t numDelayed;
+
+	size_t* topoOrder;
+	int initialized;
+
+	/* State of the current phase, read by the tasks */
+	fmi2_cosim_phase_enu_t phase;
+	fmi2_real_t t;
+	fmi2_real_t h;
+	int failed;
+};
+
+void fmi2_import_cosim_master_default_options(fmi2_import_cosim_master_options_t* options) {
+	memset(options, 0, sizeof(fmi2_import_cosim_master_options_t));
+	options->scheme = fmi2_import_cosim_master_jacobi;
+	options->num_threads = 0;
+	options->use_output_dependencies = 1;
+}
+
+fmi2_import_cosim_master_t* fmi2_import_cosim_master_create(jm_callbacks* cb, const fmi2_import_cosim_master_options_t* options) {
+	fmi2_import_cosim_master_t* master;
+
+	if(!cb) cb = jm_get_default_callbacks();
+	master = (fmi2_import_cosim_master_t*)cb->calloc(1, sizeof(fmi2_import_cosim_master_t));
+	if(!master) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	master->callbacks = cb;
+	if(options)
+		master->options = *options;
+	else
+		fmi2_import_cosim_master_default_options(&master->options);
+
+	if(jm_mutex_init(&master->lock) != jm_status_success) {
+		jm_log_fatal(cb, module, "Could not initialize a mutex");
+		cb->free(master);
+		return 0;
+	}
+	master->pool = jm_thread_pool_create(cb, master->options.num_threads);
+	if(!master->pool) {
+		jm_mutex_destroy(&master->lock);
+		cb->free(master);
+		return 0;
+	}
+	return master;
+}
+
+static void fmi2_cosim_free_node(jm_callbacks* cb, fmi2_cosim_node_t* node) {
+	int k;
+	for(k = 0; k < FMI2_COSIM_NUM_TYPES; k++) {
+		cb->free(node->outVr[k]);
+		cb->free(node->inVr[k]);
+	}
+	cb->free(node->outReal);
+	cb->free(node->inReal);
+	cb->free(node->outInteger);
+	cb->free(node->inInteger);
+	cb->free(node->outBoolean);
+	cb->free(node->inBoolean);
+	cb->free(node->inConn);
+	cb->free(node->outConn);
+	cb->free(node);
+}
+
+void fmi2_import_cosim_master_free(fmi2_import_cosim_master_t* master) {
+	jm_callbacks* cb;
+	size_t i;
+
+	if(!master) return;
+	cb = master->callbacks;
+	jm_thread_pool_free(master->pool);
+	jm_mutex_destroy(&master->lock);
+	for(i = 0; i < master->numNodes; i++) fmi2_cosim_free_node(cb, master->nodes[i]);
+	cb->free(master->nodes);
+	cb->free(master->conns);
+	cb->free(master->topoOrder);
+	cb->free(master);
+}
+
+jm_status_enu_t fmi2_import_cosim_master_add_fmu(fmi2_import_cosim_master_t* master, fmi2_import_t* fmu, size_t* index) {
+	jm_callbacks* cb = master->callbacks;
+	fmi2_cosim_node_t* node;
+
+	if(master->initialized) {
+		jm_log_error(cb, module, "FMUs cannot be added after the co-simulation master is initialized");
+		return jm_status_error;
+	}
+	if(!fmu || !fmu->capi) {
+		jm_log_error(cb, module, "The FMU must be loaded before it is added to the co-simulation master");
+		return jm_status_error;
+	}
+	if(master->numNodes == master->capNodes) {
+		size_t cap = master->capNodes ? 2 * master->capNodes : 16;
+		fmi2_cosim_node_t** nodes = (fmi2_cosim_node_t**)cb->realloc(master->nodes, cap * sizeof(fmi2_cosim_node_t*));
+		if(!nodes) {
+			jm_log_fatal(cb, module, "Could not allocate memory");
+			return jm_status_error;
+		}
+		master->nodes = nodes;
+		master->capNodes = cap;
+	}
+	node = (fmi2_cosim_node_t*)cb->calloc(1, sizeof(fmi2_cosim_node_t));
+	if(!node) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	node->master = master;
+	node->fmu = fmu;
+	node->index = master->numNodes;
+	master->nodes[master->numNodes++] = node;
+	if(index) *index = node->index;
+	return jm_status_success;
+}
+
+/* Check if any output of the FMU depends directly on the given input */
+static int fmi2_cosim_has_feedthrough(fmi2_import_cosim_master_t* master, fmi2_import_t* fmu, fmi2_import_variable_t* input) {
+	size_t *startIndex, *dependency, nout, nvars, k, idx;
+	char* factorKind;
+	fmi2_import_variable_list_t* outputs;
+	jm_vector(jm_voidp)* vars;
+
+	if(!master->options.use_output_dependencies) return 1;
+	/* tunable parameters are not listed in the dependencies */
+	if(fmi2_import_get_causality(input) != fmi2_causality_enu_input) return 1;
+
+	fmi2_import_get_outputs_dependencies(fmu, &startIndex, &dependency, &factorKind);
+	if(!startIndex) return 1;
+	outputs = fmi2_import_get_outputs_list(fmu);
+	nout = outputs ? fmi2_import_get_variable_list_size(outputs) : 0;
+	fmi2_import_free_variable_list(outputs);
+
+	/* The dependencies are 1-based positions in the original order, see fmi2_xml_get_variable_position() */
+	vars = fmi2_xml_get_variables_original_order(fmu->md);
+	nvars = vars ? jm_vector_get_size(jm_voidp)(vars) : 0;
+	idx = fmi2_xml_get_variable_position(fmu->md, (fmi2_xml_variable_t*)input);
+	if(idx == nvars) return 1;
+	idx++;
+	for(k = 0; k < startIndex[nout]; k++) {
+		if(dependency[k] == 0 || dependency[k] == idx) return 1;
+	}
+	return 0;
+}
+
+jm_status_enu_t fmi2_import_cosim_master_connect(fmi2_import_cosim_master_t* master, fmi2_base_type_enu_t baseType,
+	size_t srcFmu, fmi2_value_reference_t srcVr, size_t dstFmu, fmi2_value_reference_t dstVr)
+{
+	jm_callbacks* cb = master->callbacks;
+	fmi2_import_variable_t *srcVar, *dstVar;
+	fmi2_cosim_connection_t* c;
+	int type;
+	size_t i;
+
+	if(master->initialized) {
+		jm_log_error(cb, module, "Connections cannot be added after the co-simulation master is initialized");
+		return jm_status_error;
+	}
+	if(srcFmu >= master->numNodes || dstFmu >= master->numNodes) {
+		jm_log_error(cb, module, "Invalid FMU index in connection");
+		return jm_status_error;
+	}
+	switch(baseType) {
+	case fmi2_base_type_real: type = FMI2_COSIM_REAL; break;
+	case fmi2_base_type_int:
+	case fmi2_base_type_enum: type = FMI2_COSIM_INTEGER; break;
+	case fmi2_base_type_bool: type = FMI2_COSIM_BOOLEAN; break;
+	default:
+		jm_log_error(cb, module, "Connections of type %s are not supported", fmi2_base_type_to_string(baseType));
+		return jm_status_error;
+	}
+
+	srcVar = fmi2_import_get_variable_by_vr(master->nodes[srcFmu]->fmu, baseType, srcVr);
+	dstVar = fmi2_import_get_variable_by_vr(master->nodes[dstFmu]->fmu, baseType, dstVr);
+	if(!srcVar || !dstVar) {
+		jm_log_error(cb, module, "No %s variable with value reference %u in FMU %u",
+			fmi2_base_type_to_string(baseType), srcVar ? dstVr : srcVr, (unsigned)(srcVar ? dstFmu : srcFmu));
+		return jm_status_error;
+	}
+	if(fmi2_import_get_causality(srcVar) != fmi2_causality_enu_output) {
+		jm_log_error(cb, module, "Variable %s is not an output", fmi2_import_get_variable_name(srcVar));
+		return jm_status_error;
+	}
+	if(fmi2_import_get_causality(dstVar) != fmi2_causality_enu_input &&
+		!(fmi2_import_get_causality(dstVar) == fmi2_causality_enu_parameter && fmi2_import_get_variability(dstVar) == fmi2_variability_enu_tunable)) {
+		jm_log_error(cb, module, "Variable %s is neither an input nor a tunable parameter", fmi2_import_get_variable_name(dstVar));
+		return jm_status_error;
+	}
+	for(i = 0; i < master->numConns; i++) {
+		c = &master->conns[i];
+		if(c->dst == dstFmu && c->type == type && c->dstVr == dstVr) {
+			jm_log_error(cb, module, "Input %s of FMU %u is already connected", fmi2_import_get_variable_name(dstVar), (unsigned)dstFmu);
+			return jm_status_error;
+		}
+	}
+
+	if(master->numConns == master->capConns) {
+		size_t cap = master->capConns ? 2 * master->capConns : 16;
+		fmi2_cosim_connection_t* conns = (fmi2_cosim_connection_t*)cb->realloc(master->conns, cap * sizeof(fmi2_cosim_connection_t));
+		if(!conns) {
+			jm_log_fatal(cb, module, "Could not allocate memory");
+			return jm_status_error;
+		}
+		master->conns = conns;
+		master->capConns = cap;
+	}
+	c = &master->conns[master->numConns++];
+	memset(c, 0, sizeof(fmi2_cosim_connection_t));
+	c->src = srcFmu;
+	c->dst = dstFmu;
+	c->type = type;
+	c->srcVr = srcVr;
+	c->dstVr = dstVr;
+	c->feedthrough = fmi2_cosim_has_feedthrough(master, master->nodes[dstFmu]->fmu, dstVar);
+	return jm_status_success;
+}
+
+/* Classify the connections as ordered or copied before the step. The candidates for ordering
+   are all connections (Gauss-Seidel) or the ones with direct feedthrough (Jacobi). Cycles
+   are broken with a depth first search: connections closing a cycle are delayed. */
+static int fmi2_cosim_schedule(fmi2_import_cosim_master_t* master) {
+	jm_callbacks* cb = master->callbacks;
+	size_t n = master->numNodes, m = master->numConns, i, k, sp, post = 0;
+	size_t *adjStart, *adj, *pos, *stack;
+	char* color;
+	int gs = (master->options.scheme == fmi2_import_cosim_master_gauss_seidel);
+
+	adjStart = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	adj = (size_t*)cb->calloc(m + 1, sizeof(size_t));
+	pos = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	stack = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	color = (char*)cb->calloc(n + 1, 1);
+	master->topoOrder = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	if(!adjStart || !adj || !pos || !stack || !color || !master->topoOrder) {
+		cb->free(adjStart); cb->free(adj); cb->free(pos); cb->free(stack); cb->free(color);
+		return 0;
+	}
+
+	for(k = 0; k < m; k++) {
+		if(gs || master->conns[k].feedthrough) adjStart[master->conns[k].src + 1]++;
+	}
+	for(i = 0; i < n; i++) adjStart[i + 1] += adjStart[i];
+	for(k = 0; k < m; k++) {
+		if(gs || master->conns[k].feedthrough) adj[adjStart[master->conns[k].src]++] = k;
+	}
+	for(i = n; i > 0; i--) adjStart[i] = adjStart[i - 1];
+	adjStart[0] = 0;
+
+	/* 0 - not visited, 1 - on the stack, 2 - done */
+	master->numDelayed = 0;
+	for(i = 0; i < n; i++) {
+		if(color[i]) continue;
+		sp = 0;
+		stack[sp++] = i;
+		color[i] = 1;
+		pos[i] = adjStart[i];
+		while(sp > 0) {
+			size_t v = stack[sp - 1];
+			if(pos[v] < adjStart[v + 1]) {
+				fmi2_cosim_connection_t* c = &master->conns[adj[pos[v]++]];
+				size_t w = c->dst;
+				if(color[w] == 1) {
+					c->ordered = 0;
+					master->numDelayed++;
+				}
+				else {
+					c->ordered = 1;
+					if(color[w] == 0) {
+						color[w] = 1;
+						pos[w] = adjStart[w];
+						stack[sp++] = w;
+					}
+				}
+			}
+			else {
+				color[v] = 2;
+				master->topoOrder[n - 1 - post++] = v;
+				sp--;
+			}
+		}
+	}
+
+	cb->free(adjStart);
+	cb->free(adj);
+	cb->free(pos);
+	cb->free(stack);
+	cb->free(color);
+	if(master->numDelayed > 0) {
+		jm_log_warning(cb, module, "The FMU connections contain cycles. %u connection(s) are delayed by one communication step.",
+			(unsigned)master->numDelayed);
+	}
+	return 1;
+}
+
+static void* fmi2_cosim_alloc(jm_callbacks* cb, size_t n, size_t size, int* ok) {
+	void* p;
+	if(!*ok) return 0;
+	p = cb->calloc(n + 1, size);
+	if(!p) *ok = 0;
+	return p;
+}
+
+/* Assign buffer slots to the connections and allocate the buffers */
+static int fmi2_cosim_build_buffers(fmi2_import_cosim_master_t* master) {
+	jm_callbacks* cb = master->callbacks;
+	size_t n = master->numNodes, m = master->numConns, i, k;
+	int ok = 1, t, pass;
+
+	/* Count the incoming and outgoing connections per node and type */
+	for(k = 0; k < m; k++) {
+		fmi2_cosim_connection_t* c = &master->conns[k];
+		master->nodes[c->dst]->numInConn++;
+		master->nodes[c->dst]->nin[c->type]++;
+		master->nodes[c->src]->nout[c->type]++; /* upper bound, outputs may fan out */
+		if(c->ordered) master->nodes[c->src]->numOutConn++;
+	}
+	for(i = 0; ok && i < n; i++) {
+		fmi2_cosim_node_t* node = master->nodes[i];
+		for(t = 0; t < FMI2_COSIM_NUM_TYPES; t++) {
+			node->outVr[t] = (fmi2_value_reference_t*)fmi2_cosim_alloc(cb, node->nout[t], sizeof(fmi2_value_reference_t), &ok);
+			node->inVr[t] = (fmi2_value_reference_t*)fmi2_cosim_alloc(cb, node->nin[t], sizeof(fmi2_value_reference_t), &ok);
+		}
+		node->outReal = (fmi2_real_t*)fmi2_cosim_alloc(cb, node->nout[FMI2_COSIM_REAL], sizeof(fmi2_real_t), &ok);
+		node->inReal = (fmi2_real_t*)fmi2_cosim_alloc(cb, node->nin[FMI2_COSIM_REAL], sizeof(fmi2_real_t), &ok);
+		node->outInteger = (fmi2_integer_t*)fmi2_cosim_alloc(cb, node->nout[FMI2_COSIM_INTEGER], sizeof(fmi2_integer_t), &ok);
+		node->inInteger = (fmi2_integer_t*)fmi2_cosim_alloc(cb, node->nin[FMI2_COSIM_INTEGER], sizeof(fmi2_integer_t), &ok);
+		node->outBoolean = (fmi2_boolean_t*)fmi2_cosim_alloc(cb, node->nout[FMI2_COSIM_BOOLEAN], sizeof(fmi2_boolean_t), &ok);
+		node->inBoolean = (fmi2_boolean_t*)fmi2_cosim_alloc(cb, node->nin[FMI2_COSIM_BOOLEAN], sizeof(fmi2_boolean_t), &ok);
+		node->inConn = (size_t*)fmi2_cosim_alloc(cb, node->numInConn, sizeof(size_t), &ok);
+		node->outConn = (size_t*)fmi2_cosim_alloc(cb, node->numOutConn, sizeof(size_t), &ok);
+		for(t = 0; t < FMI2_COSIM_NUM_TYPES; t++) node->nout[t] = node->nin[t] = 0;
+		node->numInConn = node->numOutConn = 0;
+	}
+	if(!ok) return 0;
+
+	/* The inputs copied before the step get the first slots */
+	for(pass = 0; pass < 2; pass++) {
+		for(k = 0; k < m; k++) {
+			fmi2_cosim_connection_t* c = &master->conns[k];
+			fmi2_cosim_node_t* dst = master->nodes[c->dst];
+			if(c->ordered != pass) continue;
+			c->dstSlot = dst->nin[c->type]++;
+			dst->inVr[c->type][c->dstSlot] = c->dstVr;
+			dst->inConn[dst->numInConn++] = k;
+			if(!pass) {
+				dst->npre[c->type]++;
+				dst->numPreConn++;
+			}
+		}
+	}
+	for(k = 0; k < m; k++) {
+		fmi2_cosim_connection_t* c = &master->conns[k];
+		fmi2_cosim_node_t* src = master->nodes[c->src];
+		for(i = 0; i < src->nout[c->type]; i++) {
+			if(src->outVr[c->type][i] == c->srcVr) break;
+		}
+		if(i == src->nout[c->type]) src->outVr[c->type][src->nout[c->type]++] = c->srcVr;
+		c->srcSlot = i;
+		if(c->ordered) src->outConn[src->numOutConn++] = k;
+	}
+	return 1;
+}
+
+static jm_status_enu_t fmi2_cosim_check(fmi2_cosim_node_t* node, fmi2_status_t status, const char* fname) {
+	if(status == fmi2_status_ok || status == fmi2_status_warning) return jm_status_success;
+	jm_log_error(node->master->callbacks, module, "%s returned status %s for FMU %u (%s)", fname,
+		fmi2_status_to_string(status), (unsigned)node->index, fmi2_import_get_model_name(node->fmu));
+	return jm_status_error;
+}
+
+static jm_status_enu_t fmi2_cosim_get_outputs(fmi2_cosim_node_t* node) {
+	fmi2_import_t* fmu = node->fmu;
+
+	if(node->nout[FMI2_COSIM_REAL] &&
+		fmi2_cosim_check(node, fmi2_import_get_real(fmu, node->outVr[FMI2_COSIM_REAL], node->nout[FMI2_COSIM_REAL], node->outReal), "fmi2GetReal") != jm_status_success)
+		return jm_status_error;
+	if(node->nout[FMI2_COSIM_INTEGER] &&
+		fmi2_cosim_check(node, fmi2_import_get_integer(fmu, node->outVr[FMI2_COSIM_INTEGER], node->nout[FMI2_COSIM_INTEGER], node->outInteger), "fmi2GetInteger") != jm_status_success)
+		return jm_status_error;
+	if(node->nout[FMI2_COSIM_BOOLEAN] &&
+		fmi2_cosim_check(node, fmi2_import_get_boolean(fmu, node->outVr[FMI2_COSIM_BOOLEAN], node->nout[FMI2_COSIM_BOOLEAN], node->outBoolean), "fmi2GetBoolean") != jm_status_success)
+		return jm_status_error;
+	return jm_status_success;
+}
+
+/* Set the inputs in the slot range [pre ? 0 : npre, ordered ? nin : npre) */
+static jm_status_enu_t fmi2_cosim_set_inputs(fmi2_cosim_node_t* node, int pre, int ordered) {
+	fmi2_import_t* fmu = node->fmu;
+	size_t from[FMI2_COSIM_NUM_TYPES], cnt[FMI2_COSIM_NUM_TYPES];
+	int t;
+
+	for(t = 0; t < FMI2_COSIM_NUM_TYPES; t++) {
+		from[t] = pre ? 0 : node->npre[t];
+		cnt[t] = (ordered ? node->nin[t] : node->npre[t]) - from[t];
+	}
+	if(cnt[FMI2_COSIM_REAL] && fmi2_cosim_check(node, fmi2_import_set_real(fmu, node->inVr[FMI2_COSIM_REAL] + from[FMI2_COSIM_REAL],
+		cnt[FMI2_COSIM_REAL], node->inReal + from[FMI2_COSIM_REAL]), "fmi2SetReal") != jm_status_success)
+		return jm_status_error;
+	if(cnt[FMI2_COSIM_INTEGER] && fmi2_cosim_check(node, fmi2_import_set_integer(fmu, node->inVr[FMI2_COSIM_INTEGER] + from[FMI2_COSIM_INTEGER],
+		cnt[FMI2_COSIM_INTEGER], node->inInteger + from[FMI2_COSIM_INTEGER]), "fmi2SetInteger") != jm_status_success)
+		return jm_status_error;
+	if(cnt[FMI2_COSIM_BOOLEAN] && fmi2_cosim_check(node, fmi2_import_set_boolean(fmu, node->inVr[FMI2_COSIM_BOOLEAN] + from[FMI2_COSIM_BOOLEAN],
+		cnt[FMI2_COSIM_BOOLEAN], node->inBoolean + from[FMI2_COSIM_BOOLEAN]), "fmi2SetBoolean") != jm_status_success)
+		return jm_status_error;
+	return jm_status_success;
+}
+
+/* Copy the values of the incoming connections [from, to) from the source output buffers */
+static void fmi2_cosim_copy_inputs(fmi2_cosim_node_t* node, size_t from, size_t to) {
+	fmi2_import_cosim_master_t* master = node->master;
+	size_t k;
+
+	for(k = from; k < to; k++) {
+		fmi2_cosim_connection_t* c = &master->conns[node->inConn[k]];
+		fmi2_cosim_node_t* src = master->nodes[c->src];
+		switch(c->type) {
+		case FMI2_COSIM_REAL: node->inReal[c->dstSlot] = src->outReal[c->srcSlot]; break;
+		case FMI2_COSIM_INTEGER: node->inInteger[c->dstSlot] = src->outInteger[c->srcSlot]; break;
+		default: node->inBoolean[c->dstSlot] = src->outBoolean[c->srcSlot]; break;
+		}
+	}
+}
+
+static void fmi2_cosim_task(jm_thread_pool_t* pool, size_t worker, void* data);
+
+/* Release the FMUs waiting for the outputs of this one */
+static void fmi2_cosim_notify(fmi2_cosim_node_t* node, jm_thread_pool_t* pool, size_t worker) {
+	fmi2_import_cosim_master_t* master = node->master;
+	size_t k;
+
+	for(k = 0; k < node->numOutConn; k++) {
+		fmi2_cosim_node_t* dst = master->nodes[master->conns[node->outConn[k]].dst];
+		int ready;
+		jm_mutex_lock(&master->lock);
+		ready = (--dst->remaining == 0);
+		jm_mutex_unlock(&master->lock);
+		if(ready && jm_thread_pool_submit_local(pool, worker, fmi2_cosim_task, dst) != jm_status_success) {
+			jm_mutex_lock(&master->lock);
+			master->failed = 1;
+			jm_mutex_unlock(&master->lock);
+		}
+	}
+}
+
+static void fmi2_cosim_task(jm_thread_pool_t* pool, size_t worker, void* data) {
+	fmi2_cosim_node_t* node = (fmi2_cosim_node_t*)data;
+	fmi2_import_cosim_master_t* master = node->master;
+	jm_status_enu_t st = jm_status_success;
+
+	switch(master->phase) {
+	case fmi2_cosim_phase_gauss_seidel_step:
+		fmi2_cosim_copy_inputs(node, node->numPreConn, node->numInConn);
+		st = fmi2_cosim_set_inputs(node, 1, 1);
+		if(st == jm_status_success) st = fmi2_cosim_check(node, fmi2_import_do_step(node->fmu, master->t, master->h, fmi2_true), "fmi2DoStep");
+		if(st == jm_status_success) st = fmi2_cosim_get_outputs(node);
+		break;
+	case fmi2_cosim_phase_jacobi_step:
+		st = fmi2_cosim_set_inputs(node, 1, 0);
+		if(st == jm_status_success) st = fmi2_cosim_check(node, fmi2_import_do_step(node->fmu, master->t, master->h, fmi2_true), "fmi2DoStep");
+		if(st == jm_status_success) st = fmi2_cosim_get_outputs(node);
+		break;
+	case fmi2_cosim_phase_jacobi_exchange:
+		if(node->numInConn > node->numPreConn) {
+			fmi2_cosim_copy_inputs(node, node->numPreConn, node->numInConn);
+			st = fmi2_cosim_set_inputs(node, 0, 1);
+			if(st == jm_status_success) st = fmi2_cosim_get_outputs(node);
+		}
+		break;
+	}
+	if(st != jm_status_success) {
+		/* the FMUs that depend on this one are not run */
+		jm_mutex_lock(&master->lock);
+		master->failed = 1;
+		jm_mutex_unlock(&master->lock);
+		return;
+	}
+	if(master->phase != fmi2_cosim_phase_jacobi_step) fmi2_cosim_notify(node, pool, worker);
+}
+
+static jm_status_enu_t fmi2_cosim_run_phase(fmi2_import_cosim_master_t* master, fmi2_cosim_phase_enu_t phase) {
+	size_t i;
+
+	master->phase = phase;
+	master->failed = 0;
+	for(i = 0; i < master->numNodes; i++) {
+		fmi2_cosim_node_t* node = master->nodes[i];
+		node->remaining = (phase == fmi2_cosim_phase_jacobi_step) ? 0 : node->numInConn - node->numPreConn;
+	}
+	/* The start nodes are selected on the static counts since 'remaining' is
+	   modified by the workers as soon as the first task is submitted */
+	for(i = 0; i < master->numNodes; i++) {
+		fmi2_cosim_node_t* node = master->nodes[i];
+		if(phase != fmi2_cosim_phase_jacobi_step && node->numInConn > node->numPreConn) continue;
+		/* nothing to exchange for FMUs without ordered connections */
+		if(phase == fmi2_cosim_phase_jacobi_exchange && node->numOutConn == 0) continue;
+		if(jm_thread_pool_submit(master->pool, fmi2_cosim_task, node) != jm_status_success) {
+			master->failed = 1;
+			break;
+		}
+	}
+	jm_thread_pool_wait(master->pool);
+	return master->failed ? jm_status_error : jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_cosim_master_initialize(fmi2_import_cosim_master_t* master) {
+	jm_callbacks* cb = master->callbacks;
+	size_t i;
+
+	if(master->initialized) {
+		jm_log_error(cb, module, "The co-simulation master is already initialized");
+		return jm_status_error;
+	}
+	if(!fmi2_cosim_schedule(master) || !fmi2_cosim_build_buffers(master)) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+
+	/* Initial values: all outputs, then the inputs in dependency order */
+	for(i = 0; i < master->numNodes; i++) {
+		if(fmi2_cosim_get_outputs(master->nodes[i]) != jm_status_success) return jm_status_error;
+	}
+	for(i = 0; i < master->numNodes; i++) {
+		fmi2_cosim_node_t* node = master->nodes[master->topoOrder[i]];
+		if(node->numInConn == 0) continue;
+		fmi2_cosim_copy_inputs(node, 0, node->numInConn);
+		if(fmi2_cosim_set_inputs(node, 1, 1) != jm_status_success ||
+			fmi2_cosim_get_outputs(node) != jm_status_success)
+			return jm_status_error;
+	}
+
+	master->initialized = 1;
+	jm_log_verbose(cb, module, "Co-simulation master initialized: %u FMUs, %u connections, %u threads",
+		(unsigned)master->numNodes, (unsigned)master->numConns, (unsigned)jm_thread_pool_get_number_of_threads(master->pool));
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_cosim_master_do_step(fmi2_import_cosim_master_t* master, fmi2_real_t t, fmi2_real_t h) {
+	size_t i;
+
+	if(!master->initialized) {
+		jm_log_error(master->callbacks, module, "fmi2_import_cosim_master_initialize must be called before stepping");
+		return jm_status_error;
+	}
+	master->t = t;
+	master->h = h;
+
+	/* Values that are not waited for are taken from the end of the previous step */
+	for(i = 0; i < master->numNodes; i++) {
+		fmi2_cosim_node_t* node = master->nodes[i];
+		fmi2_cosim_copy_inputs(node, 0, node->numPreConn);
+	}
+
+	if(master->options.scheme == fmi2_import_cosim_master_gauss_seidel)
+		return fmi2_cosim_run_phase(master, fmi2_cosim_phase_gauss_seidel_step);
+
+	if(fmi2_cosim_run_phase(master, fmi2_cosim_phase_jacobi_step) != jm_status_success) return jm_status_error;
+	return fmi2_cosim_run_phase(master, fmi2_cosim_phase_jacobi_exchange);
+}
+
+size_t fmi2_import_cosim_master_get_number_of_fmus(fmi2_import_cosim_master_t* master) {
+	return master->numNodes;
+}
+
+size_t fmi2_import_cosim_master_get_number_of_connections(fmi2_import_cosim_master_t* master) {
+	return master->numConns;
+}
+
+size_t fmi2_import_cosim_master_get_number_of_delayed_connections(fmi2_import_cosim_master_t* master) {
+	return master->numDelayed;
+}
+
+size_t fmi2_import_cosim_master_get_number_of_threads(fmi2_import_cosim_master_t* master) {
+	return jm_thread_pool_get_number_of_threads(master->pool);
+}
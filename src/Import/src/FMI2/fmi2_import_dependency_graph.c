@@ -0,0 +1,521 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <FMI2/fmi2_import_dependency_graph.h>
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+#define FMI2_DEPENDENCY_NO_ROW ((size_t)-1)
+
+struct fmi2_import_dependency_graph_t {
+	fmi2_import_t* fmu;
+	jm_callbacks* callbacks;
+	fmi2_import_variable_list_t* unknowns;
+	size_t numRows;
+	size_t numVariables;
+
+	size_t* rowVariable;   /* 0-based variable index of each row, numVariables if the variable was not found */
+	size_t* rowOfVariable; /* row + 1 of each variable, 0 if the variable is not an unknown */
+	size_t* sourceRow;     /* row + 1 that a dependency on the variable leads to: its own row or the row connected to it */
+
+	/* Explicit dependencies in CSR format with 0-based variable indices.
+	   The rows that depend on all have no entries here. */
+	size_t* start;
+	size_t* index;
+	char* factorKind;
+	char* dependsOnAll;
+
+	/* Shared row of the knowns for the rows that depend on all */
+	size_t* knowns;
+	char* knownKinds;
+	size_t numKnowns;
+};
+
+static void* fmi2_dependency_graph_alloc(jm_callbacks* cb, size_t n, size_t size, int* ok) {
+	void* p;
+	if(!*ok) return 0;
+	p = cb->calloc(n + 1, size);
+	if(!p) *ok = 0;
+	return p;
+}
+
+static int fmi2_dependency_graph_compare_size_t(const void* a, const void* b) {
+	size_t x = *(const size_t*)a, y = *(const size_t*)b;
+	return (x < y) ? -1 : (x > y);
+}
+
+static int fmi2_dependency_graph_is_known(fmi2_import_t* fmu, fmi2_import_variable_t* v, fmi2_import_dependencies_enu_t which) {
+	fmi2_causality_enu_t causality = fmi2_import_get_causality(v);
+
+	if((causality == fmi2_causality_enu_input) || (causality == fmi2_causality_enu_independent)) return 1;
+	if(fmi2_import_selection_contains(fmi2_import_get_role_mask(fmu, fmi2_import_variable_role_state), v)) return 1;
+	return (which == fmi2_import_initial_unknowns_dependencies) && (fmi2_import_get_initial(v) == fmi2_initial_enu_exact);
+}
+
+static jm_status_enu_t fmi2_dependency_graph_build_knowns(fmi2_import_dependency_graph_t* g, jm_vector(jm_voidp)* vars, fmi2_import_dependencies_enu_t which) {
+	size_t k;
+	int ok = 1;
+
+	g->knowns = (size_t*)fmi2_dependency_graph_alloc(g->callbacks, g->numVariables, sizeof(size_t), &ok);
+	g->knownKinds = (char*)fmi2_dependency_graph_alloc(g->callbacks, g->numVariables, sizeof(char), &ok);
+	if(!ok) return jm_status_error;
+	for(k = 0; k < g->numVariables; k++) {
+		if(fmi2_dependency_graph_is_known(g->fmu, (fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(vars, k), which))
+			g->knowns[g->numKnowns++] = k;
+	}
+	/* knownKinds is zero filled, i.e., fmi2_dependency_factor_kind_dependent */
+	return jm_status_success;
+}
+
+fmi2_import_dependency_graph_t* fmi2_import_dependency_graph_create(fmi2_import_t* fmu, fmi2_import_dependencies_enu_t which) {
+	jm_callbacks* cb = fmu->callbacks;
+	jm_vector(jm_voidp)* vars = fmi2_xml_get_variables_original_order(fmu->md);
+	fmi2_import_dependency_graph_t* g;
+	size_t *startIndex, *dependency, r, e, nnz = 0, numDense = 0;
+	char* factorKind;
+	int ok = 1;
+
+	g = (fmi2_import_dependency_graph_t*)cb->calloc(1, sizeof(fmi2_import_dependency_graph_t));
+	if(!g) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	g->fmu = fmu;
+	g->callbacks = cb;
+	switch(which) {
+	case fmi2_import_outputs_dependencies:
+		g->unknowns = fmi2_import_get_outputs_list(fmu);
+		fmi2_import_get_outputs_dependencies(fmu, &startIndex, &dependency, &factorKind);
+		break;
+	case fmi2_import_derivatives_dependencies:
+		g->unknowns = fmi2_import_get_derivatives_list(fmu);
+		fmi2_import_get_derivatives_dependencies(fmu, &startIndex, &dependency, &factorKind);
+		break;
+	case fmi2_import_discrete_states_dependencies:
+		g->unknowns = fmi2_import_get_discrete_states_list(fmu);
+		fmi2_import_get_discrete_states_dependencies(fmu, &startIndex, &dependency, &factorKind);
+		break;
+	default:
+		g->unknowns = fmi2_import_get_initial_unknowns_list(fmu);
+		fmi2_import_get_initial_unknowns_dependencies(fmu, &startIndex, &dependency, &factorKind);
+		break;
+	}
+	if(!g->unknowns || !vars) {
+		fmi2_import_dependency_graph_free(g);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	g->numRows = fmi2_import_get_variable_list_size(g->unknowns);
+	g->numVariables = jm_vector_get_size(jm_voidp)(vars);
+	if(startIndex) nnz = startIndex[g->numRows];
+
+	g->rowVariable = (size_t*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(size_t), &ok);
+	g->rowOfVariable = (size_t*)fmi2_dependency_graph_alloc(cb, g->numVariables, sizeof(size_t), &ok);
+	g->sourceRow = (size_t*)fmi2_dependency_graph_alloc(cb, g->numVariables, sizeof(size_t), &ok);
+	g->start = (size_t*)fmi2_dependency_graph_alloc(cb, g->numRows + 1, sizeof(size_t), &ok);
+	g->index = (size_t*)fmi2_dependency_graph_alloc(cb, nnz, sizeof(size_t), &ok);
+	g->factorKind = (char*)fmi2_dependency_graph_alloc(cb, nnz, sizeof(char), &ok);
+	g->dependsOnAll = (char*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(char), &ok);
+	if(!ok) {
+		fmi2_import_dependency_graph_free(g);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+
+	/* Convert to 0-based indices. A zero index marks a row that depends on all, so the row is left empty.
+	   All indices are positions in the original order vector, like the 1-based indices of the XML. */
+	nnz = 0;
+	for(r = 0; r < g->numRows; r++) {
+		size_t rowBegin = nnz;
+		g->rowVariable[r] = fmi2_xml_get_variable_position(fmu->md, (fmi2_xml_variable_t*)fmi2_import_get_variable(g->unknowns, r));
+		if(g->rowVariable[r] < g->numVariables) g->rowOfVariable[g->rowVariable[r]] = r + 1;
+		if(!startIndex) {
+			g->dependsOnAll[r] = 1;
+		}
+		else {
+			for(e = startIndex[r]; e < startIndex[r + 1]; e++) {
+				size_t d = dependency[e];
+				if(d == 0) {
+					g->dependsOnAll[r] = 1;
+					nnz = rowBegin;
+					break;
+				}
+				if(d > g->numVariables) continue;
+				g->index[nnz] = d - 1;
+				g->factorKind[nnz] = factorKind[e];
+				nnz++;
+			}
+		}
+		if(g->dependsOnAll[r]) numDense++;
+		g->start[r + 1] = nnz;
+	}
+	memcpy(g->sourceRow, g->rowOfVariable, g->numVariables * sizeof(size_t));
+	if(numDense && (fmi2_dependency_graph_build_knowns(g, vars, which) != jm_status_success)) {
+		fmi2_import_dependency_graph_free(g);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	jm_log_verbose(cb, module, "Dependency graph with %u unknowns, %u dependencies and %u unknowns that depend on all %u knowns",
+		(unsigned)g->numRows, (unsigned)nnz, (unsigned)numDense, (unsigned)g->numKnowns);
+	return g;
+}
+
+void fmi2_import_dependency_graph_free(fmi2_import_dependency_graph_t* g) {
+	jm_callbacks* cb;
+
+	if(!g) return;
+	cb = g->callbacks;
+	fmi2_import_free_variable_list(g->unknowns);
+	cb->free(g->rowVariable);
+	cb->free(g->rowOfVariable);
+	cb->free(g->sourceRow);
+	cb->free(g->start);
+	cb->free(g->index);
+	cb->free(g->factorKind);
+	cb->free(g->dependsOnAll);
+	cb->free(g->knowns);
+	cb->free(g->knownKinds);
+	cb->free(g);
+}
+
+size_t fmi2_import_dependency_graph_get_size(fmi2_import_dependency_graph_t* g) {
+	return g->numRows;
+}
+
+size_t fmi2_import_dependency_graph_get_number_of_variables(fmi2_import_dependency_graph_t* g) {
+	return g->numVariables;
+}
+
+fmi2_import_variable_t* fmi2_import_dependency_graph_get_unknown(fmi2_import_dependency_graph_t* g, size_t row) {
+	if(row >= g->numRows) return 0;
+	return fmi2_import_get_variable(g->unknowns, row);
+}
+
+size_t fmi2_import_dependency_graph_get_row(fmi2_import_dependency_graph_t* g, fmi2_import_variable_t* v) {
+	size_t k = fmi2_xml_get_variable_position(g->fmu->md, (fmi2_xml_variable_t*)v);
+
+	if((k >= g->numVariables) || !g->rowOfVariable[k]) return FMI2_DEPENDENCY_NO_ROW;
+	return g->rowOfVariable[k] - 1;
+}
+
+jm_status_enu_t fmi2_import_dependency_graph_connect(fmi2_import_dependency_graph_t* g, fmi2_import_variable_t* source, fmi2_import_variable_t* input) {
+	size_t row = fmi2_import_dependency_graph_get_row(g, source);
+	size_t k = fmi2_xml_get_variable_position(g->fmu->md, (fmi2_xml_variable_t*)input);
+
+	if((row == FMI2_DEPENDENCY_NO_ROW) || (k >= g->numVariables) || g->rowOfVariable[k]) {
+		jm_log_error(g->callbacks, module, "Cannot connect %s to %s: the source must be an unknown of the dependency graph and the input must not",
+			fmi2_import_get_variable_name(source), fmi2_import_get_variable_name(input));
+		return jm_status_error;
+	}
+	g->sourceRow[k] = row + 1;
+	return jm_status_success;
+}
+
+int fmi2_import_dependency_graph_depends_on_all(fmi2_import_dependency_graph_t* g, size_t row) {
+	return (row < g->numRows) && g->dependsOnAll[row];
+}
+
+size_t fmi2_import_dependency_graph_get_dependencies(fmi2_import_dependency_graph_t* g, size_t row, const size_t** index, const char** factorKind) {
+	if(row >= g->numRows) {
+		*index = 0;
+		if(factorKind) *factorKind = 0;
+		return 0;
+	}
+	if(g->dependsOnAll[row]) {
+		*index = g->knowns;
+		if(factorKind) *factorKind = g->knownKinds;
+		return g->numKnowns;
+	}
+	*index = g->index + g->start[row];
+	if(factorKind) *factorKind = g->factorKind + g->start[row];
+	return g->start[row + 1] - g->start[row];
+}
+
+static jm_status_enu_t fmi2_dependency_graph_alloc_pattern(fmi2_import_dependency_graph_t* g, fmi2_import_sparsity_pattern_t* p,
+	size_t numRows, size_t numColumns, size_t nnz)
+{
+	int ok = 1;
+
+	p->numRows = numRows;
+	p->numColumns = numColumns;
+	p->start = (size_t*)fmi2_dependency_graph_alloc(g->callbacks, numRows + 1, sizeof(size_t), &ok);
+	p->index = (size_t*)fmi2_dependency_graph_alloc(g->callbacks, nnz, sizeof(size_t), &ok);
+	if(!ok) {
+		fmi2_import_dependency_graph_free_pattern(g, p);
+		jm_log_fatal(g->callbacks, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+void fmi2_import_dependency_graph_free_pattern(fmi2_import_dependency_graph_t* g, fmi2_import_sparsity_pattern_t* pattern) {
+	g->callbacks->free(pattern->start);
+	g->callbacks->free(pattern->index);
+	pattern->start = pattern->index = 0;
+	pattern->numRows = pattern->numColumns = 0;
+}
+
+jm_status_enu_t fmi2_import_dependency_graph_transpose(fmi2_import_dependency_graph_t* g, fmi2_import_sparsity_pattern_t* csc) {
+	const size_t* dep;
+	size_t r, k, n, nnz = 0;
+
+	for(r = 0; r < g->numRows; r++) {
+		nnz += fmi2_import_dependency_graph_get_dependencies(g, r, &dep, 0);
+	}
+	if(fmi2_dependency_graph_alloc_pattern(g, csc, g->numVariables, g->numRows, nnz) != jm_status_success) return jm_status_error;
+
+	/* Count the entries of each column, shifted by one so that the fill below can use start[v + 1] as the position */
+	for(r = 0; r < g->numRows; r++) {
+		n = fmi2_import_dependency_graph_get_dependencies(g, r, &dep, 0);
+		for(k = 0; k < n; k++) csc->start[dep[k] + 1]++;
+	}
+	for(k = 0; k < g->numVariables; k++) csc->start[k + 1] += csc->start[k];
+	for(r = 0; r < g->numRows; r++) {
+		n = fmi2_import_dependency_graph_get_dependencies(g, r, &dep, 0);
+		for(k = 0; k < n; k++) csc->index[csc->start[dep[k]]++] = r;
+	}
+	for(k = g->numVariables; k > 0; k--) csc->start[k] = csc->start[k - 1];
+	csc->start[0] = 0;
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_dependency_graph_closure(fmi2_import_dependency_graph_t* g, fmi2_import_sparsity_pattern_t* closure) {
+	jm_callbacks* cb = g->callbacks;
+	jm_vector(size_t) entries;
+	size_t *mark, *rowMark, *stack, *start;
+	size_t r, k, n, sp, nnz;
+	const size_t* dep;
+	int ok = 1;
+
+	mark = (size_t*)fmi2_dependency_graph_alloc(cb, g->numVariables, sizeof(size_t), &ok);
+	rowMark = (size_t*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(size_t), &ok);
+	stack = (size_t*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(size_t), &ok);
+	start = (size_t*)fmi2_dependency_graph_alloc(cb, g->numRows + 1, sizeof(size_t), &ok);
+	jm_vector_init(size_t)(&entries, 0, cb);
+
+	/* Depth first search from every row. The marks are stamped with the row + 1 so that they are not cleared between the rows.
+	   The start row is not marked, so that it is visited again and its variable is included if it is on a loop. */
+	for(r = 0; ok && (r < g->numRows); r++) {
+		size_t rowBegin = jm_vector_get_size(size_t)(&entries);
+		sp = 0;
+		stack[sp++] = r;
+		while(ok && sp) {
+			size_t s = stack[--sp];
+			n = fmi2_import_dependency_graph_get_dependencies(g, s, &dep, 0);
+			for(k = 0; k < n; k++) {
+				size_t v = dep[k], t = g->sourceRow[dep[k]];
+				if(mark[v] == r + 1) continue;
+				mark[v] = r + 1;
+				if(!jm_vector_push_back(size_t)(&entries, v)) {
+					ok = 0;
+					break;
+				}
+				if(t && (rowMark[t - 1] != r + 1)) {
+					/* A connected input also depends on the unknown that feeds it */
+					v = g->rowVariable[t - 1];
+					if(mark[v] != r + 1) {
+						mark[v] = r + 1;
+						if(!jm_vector_push_back(size_t)(&entries, v)) {
+							ok = 0;
+							break;
+						}
+					}
+					rowMark[t - 1] = r + 1;
+					stack[sp++] = t - 1;
+				}
+			}
+		}
+		if(!ok) break;
+		nnz = jm_vector_get_size(size_t)(&entries);
+		start[r + 1] = nnz;
+		if(nnz > rowBegin) {
+			qsort(jm_vector_get_itemp(size_t)(&entries, rowBegin), nnz - rowBegin, sizeof(size_t), fmi2_dependency_graph_compare_size_t);
+		}
+	}
+	cb->free(mark);
+	cb->free(rowMark);
+	cb->free(stack);
+
+	nnz = jm_vector_get_size(size_t)(&entries);
+	if(!ok || (fmi2_dependency_graph_alloc_pattern(g, closure, g->numRows, g->numVariables, nnz) != jm_status_success)) {
+		if(!ok) jm_log_fatal(cb, module, "Could not allocate memory");
+		jm_vector_free_data(size_t)(&entries);
+		cb->free(start);
+		return jm_status_error;
+	}
+	memcpy(closure->start, start, (g->numRows + 1) * sizeof(size_t));
+	if(nnz) memcpy(closure->index, jm_vector_get_itemp(size_t)(&entries, 0), nnz * sizeof(size_t));
+	jm_vector_free_data(size_t)(&entries);
+	cb->free(start);
+	return jm_status_success;
+}
+
+/* Iterative Tarjan algorithm over the edges between the rows. A component is completed only after
+   all the components it depends on, so the components are numbered in dependency order.
+   isLoop gets one flag per component. Returns the number of components or FMI2_DEPENDENCY_NO_ROW. */
+static size_t fmi2_dependency_graph_scc(fmi2_import_dependency_graph_t* g, size_t* component, char* isLoop) {
+	jm_callbacks* cb = g->callbacks;
+	size_t *order, *low, *stack, *call, *pos;
+	size_t r, sp = 0, csp, counter = 0, numComponents = 0;
+	char *onStack, *selfLoop;
+	int ok = 1;
+
+	order = (size_t*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(size_t), &ok);
+	low = (size_t*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(size_t), &ok);
+	stack = (size_t*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(size_t), &ok);
+	call = (size_t*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(size_t), &ok);
+	pos = (size_t*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(size_t), &ok);
+	onStack = (char*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(char), &ok);
+	selfLoop = (char*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(char), &ok);
+
+	for(r = 0; ok && (r < g->numRows); r++) {
+		if(order[r]) continue;
+		csp = 0;
+		call[csp++] = r;
+		order[r] = low[r] = ++counter;
+		stack[sp++] = r;
+		onStack[r] = 1;
+		while(csp) {
+			size_t v = call[csp - 1];
+			const size_t* dep;
+			size_t n = fmi2_import_dependency_graph_get_dependencies(g, v, &dep, 0);
+
+			if(pos[v] < n) {
+				size_t t = g->sourceRow[dep[pos[v]++]];
+				if(!t) continue;
+				t--;
+				if(t == v) selfLoop[v] = 1;
+				if(!order[t]) {
+					order[t] = low[t] = ++counter;
+					stack[sp++] = t;
+					onStack[t] = 1;
+					call[csp++] = t;
+				}
+				else if(onStack[t] && (order[t] < low[v])) {
+					low[v] = order[t];
+				}
+				continue;
+			}
+			csp--;
+			if(csp && (low[v] < low[call[csp - 1]])) low[call[csp - 1]] = low[v];
+			if(low[v] == order[v]) {
+				size_t w, size = 0;
+				do {
+					w = stack[--sp];
+					onStack[w] = 0;
+					component[w] = numComponents;
+					size++;
+				} while(w != v);
+				isLoop[numComponents] = (size > 1) || selfLoop[v];
+				numComponents++;
+			}
+		}
+	}
+	cb->free(order);
+	cb->free(low);
+	cb->free(stack);
+	cb->free(call);
+	cb->free(pos);
+	cb->free(onStack);
+	cb->free(selfLoop);
+	if(!ok) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return FMI2_DEPENDENCY_NO_ROW;
+	}
+	return numComponents;
+}
+
+size_t fmi2_import_dependency_graph_components(fmi2_import_dependency_graph_t* g, size_t* component, size_t* numLoops) {
+	char* isLoop = (char*)g->callbacks->calloc(g->numRows + 1, sizeof(char));
+	size_t k, n;
+
+	if(!isLoop) {
+		jm_log_fatal(g->callbacks, module, "Could not allocate memory");
+		return FMI2_DEPENDENCY_NO_ROW;
+	}
+	n = fmi2_dependency_graph_scc(g, component, isLoop);
+	if(numLoops && (n != FMI2_DEPENDENCY_NO_ROW)) {
+		*numLoops = 0;
+		for(k = 0; k < n; k++) *numLoops += isLoop[k];
+	}
+	g->callbacks->free(isLoop);
+	return n;
+}
+
+jm_status_enu_t fmi2_import_dependency_graph_order(fmi2_import_dependency_graph_t* g, const size_t* variables, size_t numVariables, size_t* order, size_t* numOrdered) {
+	jm_callbacks* cb = g->callbacks;
+	size_t *component, *first, *rows;
+	size_t r, c, k, n, numComponents;
+	char *isLoop, *affected, *rowAffected;
+	int ok = 1, hasLoop = 0;
+
+	*numOrdered = 0;
+	component = (size_t*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(size_t), &ok);
+	first = (size_t*)fmi2_dependency_graph_alloc(cb, g->numRows + 1, sizeof(size_t), &ok);
+	rows = (size_t*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(size_t), &ok);
+	isLoop = (char*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(char), &ok);
+	affected = (char*)fmi2_dependency_graph_alloc(cb, g->numVariables, sizeof(char), &ok);
+	rowAffected = (char*)fmi2_dependency_graph_alloc(cb, g->numRows, sizeof(char), &ok);
+	numComponents = ok ? fmi2_dependency_graph_scc(g, component, isLoop) : FMI2_DEPENDENCY_NO_ROW;
+	if(!ok || (numComponents == FMI2_DEPENDENCY_NO_ROW)) {
+		if(!ok) jm_log_fatal(cb, module, "Could not allocate memory");
+		cb->free(component); cb->free(first); cb->free(rows); cb->free(isLoop); cb->free(affected); cb->free(rowAffected);
+		return jm_status_error;
+	}
+
+	/* Group the rows by component with a counting sort */
+	for(r = 0; r < g->numRows; r++) first[component[r] + 1]++;
+	for(c = 0; c < numComponents; c++) first[c + 1] += first[c];
+	for(r = 0; r < g->numRows; r++) rows[first[component[r]]++] = r;
+	for(c = numComponents; c > 0; c--) first[c] = first[c - 1];
+	first[0] = 0;
+
+	for(k = 0; variables && (k < numVariables); k++) {
+		if(variables[k] < g->numVariables) affected[variables[k]] = 1;
+	}
+	/* The components that a component depends on come before it, so one pass finds all the affected
+	   unknowns. If one unknown of a loop is affected, all of them are. */
+	for(c = 0; c < numComponents; c++) {
+		int isAffected = (variables == 0);
+		for(k = first[c]; !isAffected && (k < first[c + 1]); k++) {
+			const size_t* dep;
+			size_t j;
+			n = fmi2_import_dependency_graph_get_dependencies(g, rows[k], &dep, 0);
+			for(j = 0; j < n; j++) {
+				size_t t = g->sourceRow[dep[j]];
+				if(affected[dep[j]] || (t && rowAffected[t - 1])) {
+					isAffected = 1;
+					break;
+				}
+			}
+		}
+		if(!isAffected) continue;
+		if(isLoop[c]) hasLoop = 1;
+		for(k = first[c]; k < first[c + 1]; k++) {
+			rowAffected[rows[k]] = 1;
+			order[(*numOrdered)++] = rows[k];
+		}
+	}
+	cb->free(component); cb->free(first); cb->free(rows); cb->free(isLoop); cb->free(affected); cb->free(rowAffected);
+	if(hasLoop) {
+		jm_log_verbose(cb, module, "The ordered unknowns contain an algebraic loop");
+		return jm_status_warning;
+	}
+	return jm_status_success;
+}
@@ -22,6 +22,8 @@
 #define FMI2_IMPORT_IMPL_H_
 
 
+#include <JM/jm_memory_accounting.h>
+#include <JM/jm_thread.h>
 #include <FMI2/fmi2_import.h>
 #include <FMI2/fmi2_xml_model_description.h>
 
@@ -33,16 +35,33 @@
 extern "C" {
 #endif
 
+typedef struct fmi2_import_selection_masks_t fmi2_import_selection_masks_t;
+typedef struct fmi2_import_component_tree_t fmi2_import_component_tree_t;
+
 struct fmi2_import_t {	
 	char* dirPath;
 	char* resourceLocation;
 	jm_callbacks* callbacks;
+	jm_memory_accounting_t* memory; /* NULL unless the memory accounting is enabled; callbacks point into it then */
 	fmi2_xml_model_description_t* md;
 	fmi2_capi_t* capi;
 	jm_vector(char) logMessageBufferCoded;
 	jm_vector(char) logMessageBufferExpanded;
+	jm_vector(char) logMessageBufferSink; /* expansion buffer of the thread of logSink */
+	fmi2_import_step_future_t* asyncStep; /* outstanding step of fmi2_import_do_step_async(), protected by asyncLock */
+	jm_mutex_t asyncLock;
+	jm_log_sink_t* logSink; /* NULL unless the FMU messages are delivered asynchronously */
+	fmi2_import_log_filter_t* logFilter; /* evaluated by fmi2_log_forwarding before formatting, may be NULL */
+	fmi2_import_selection_masks_t* selectionMasks; /* predefined variable selections, built after parsing */
+	fmi2_import_component_tree_t* componentTree; /* built on the first use, see fmi2_import_component.h */
 };
 
+/* Compute the predefined selections of fmi2_import_selection.h from the parsed model description */
+jm_status_enu_t fmi2_import_build_selection_masks(fmi2_import_t* fmu);
+void fmi2_import_free_selection_masks(fmi2_import_t* fmu);
+
+void fmi2_import_free_component_tree(fmi2_import_t* fmu);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,487 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <float.h>
+#include <math.h>
+
+#include <FMI2/fmi2_import_jacobian.h>
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+struct fmi2_import_jacobian_t {
+	fmi2_import_t* fmu;
+	jm_callbacks* callbacks;
+	fmi2_import_jacobian_method_enu_t method;
+
+	size_t n;
+	size_t nnz;
+
+	/* Pattern and values, row-wise and column-wise */
+	size_t* csrStart;
+	size_t* csrCol;
+	fmi2_real_t* csrVal;
+	size_t* cscStart;
+	size_t* cscRow;
+	fmi2_real_t* cscVal;
+	size_t* cscToCsr;
+
+	/* Coloring. The columns of color c are colorCols[colorStart[c] .. colorStart[c+1]-1].
+	   The columns of one color share no rows, so every row appears at most once in
+	   colorEntry[colorEntryStart[c] .. colorEntryStart[c+1]-1]. */
+	size_t numColors;
+	size_t* color;
+	size_t* colorStart;
+	size_t* colorCols;
+	size_t* colorEntryStart;        /* numColors + 1 offsets into colorEntry */
+	size_t* colorEntry;             /* CSC positions in the order of the rows in colorUnknownVr */
+	fmi2_value_reference_t* colorKnownVr;   /* state VRs, grouped by color */
+	fmi2_value_reference_t* colorUnknownVr; /* derivative VRs, grouped by color */
+
+	/* Work arrays */
+	fmi2_real_t* x0;
+	fmi2_real_t* f0;
+	fmi2_real_t* xw;
+	fmi2_real_t* fw;
+	fmi2_real_t* delta;
+	fmi2_real_t* nominal;
+};
+
+static int fmi2_jacobian_compare_size_t(const void* a, const void* b) {
+	size_t x = *(const size_t*)a, y = *(const size_t*)b;
+	return (x < y) ? -1 : (x > y);
+}
+
+static void* fmi2_jacobian_alloc(fmi2_import_jacobian_t* jac, size_t n, size_t size, int* ok) {
+	void* p;
+	if(!*ok) return 0;
+	p = jac->callbacks->calloc(n ? n : 1, size);
+	if(!p) {
+		jm_log_fatal(jac->callbacks, module, "Could not allocate memory");
+		*ok = 0;
+	}
+	return p;
+}
+
+void fmi2_import_jacobian_free(fmi2_import_jacobian_t* jac) {
+	jm_callbacks* cb;
+	if(!jac) return;
+	cb = jac->callbacks;
+	cb->free(jac->csrStart);
+	cb->free(jac->csrCol);
+	cb->free(jac->csrVal);
+	cb->free(jac->cscStart);
+	cb->free(jac->cscRow);
+	cb->free(jac->cscVal);
+	cb->free(jac->cscToCsr);
+	cb->free(jac->color);
+	cb->free(jac->colorStart);
+	cb->free(jac->colorCols);
+	cb->free(jac->colorEntryStart);
+	cb->free(jac->colorEntry);
+	cb->free(jac->colorKnownVr);
+	cb->free(jac->colorUnknownVr);
+	cb->free(jac->x0);
+	cb->free(jac->f0);
+	cb->free(jac->xw);
+	cb->free(jac->fw);
+	cb->free(jac->delta);
+	cb->free(jac->nominal);
+	cb->free(jac);
+}
+
+/* Fill in the CSR pattern from the ModelStructure. stateOf maps 0-based variable
+   original order index to 1-based state index (0 if the variable is not a state). */
+static int fmi2_jacobian_build_pattern(fmi2_import_jacobian_t* jac, const size_t* stateOf, size_t nvars, size_t* mark) {
+	size_t *startIndex, *dependency;
+	char* factorKind;
+	size_t n = jac->n, r, pass;
+	int ok = 1;
+
+	fmi2_import_get_derivatives_dependencies(jac->fmu, &startIndex, &dependency, &factorKind);
+	if(!startIndex) {
+		jm_log_verbose(jac->callbacks, module, "No dependency information for the derivatives. Jacobian is treated as dense.");
+	}
+
+	jac->csrStart = (size_t*)fmi2_jacobian_alloc(jac, n + 1, sizeof(size_t), &ok);
+	if(!ok) return 0;
+
+	/* First pass counts the entries, second pass fills them in */
+	for(pass = 0; pass < 2; pass++) {
+		size_t nnz = 0;
+		for(r = 0; r < n; r++) mark[r] = (size_t)-1;
+		for(r = 0; r < n; r++) {
+			int dense = (startIndex == 0);
+			size_t e, c, rowBegin = nnz;
+
+			if(!dense) {
+				for(e = startIndex[r]; e < startIndex[r+1]; e++) {
+					size_t d = dependency[e];
+					if(d == 0) {
+						dense = 1;
+						break;
+					}
+					if(d > nvars || stateOf[d - 1] == 0) continue; /* not a state, e.g., an input */
+					c = stateOf[d - 1] - 1;
+					if(mark[c] == r) continue;
+					mark[c] = r;
+					if(pass) jac->csrCol[nnz] = c;
+					nnz++;
+				}
+			}
+			if(dense) {
+				nnz = rowBegin;
+				for(c = 0; c < n; c++) {
+					mark[c] = r;
+					if(pass) jac->csrCol[nnz] = c;
+					nnz++;
+				}
+			}
+			if(pass) {
+				jac->csrStart[r + 1] = nnz;
+				qsort(jac->csrCol + rowBegin, nnz - rowBegin, sizeof(size_t), fmi2_jacobian_compare_size_t);
+			}
+		}
+		if(!pass) {
+			jac->nnz = nnz;
+			jac->csrCol = (size_t*)fmi2_jacobian_alloc(jac, nnz, sizeof(size_t), &ok);
+			if(!ok) return 0;
+		}
+	}
+	return 1;
+}
+
+/* Transpose the CSR pattern into CSC */
+static void fmi2_jacobian_build_csc(fmi2_import_jacobian_t* jac) {
+	size_t n = jac->n, r, c, k;
+
+	for(k = 0; k < jac->nnz; k++) jac->cscStart[jac->csrCol[k] + 1]++;
+	for(c = 0; c < n; c++) jac->cscStart[c + 1] += jac->cscStart[c];
+	for(r = 0; r < n; r++) {
+		for(k = jac->csrStart[r]; k < jac->csrStart[r + 1]; k++) {
+			size_t pos = jac->cscStart[jac->csrCol[k]]++;
+			jac->cscRow[pos] = r;
+			jac->cscToCsr[pos] = k;
+		}
+	}
+	for(c = n; c > 0; c--) jac->cscStart[c] = jac->cscStart[c - 1];
+	jac->cscStart[0] = 0;
+}
+
+/* Greedy distance-2 coloring of the columns in largest-degree-first order.
+   Two columns get different colors if they have a non-zero in a common row. */
+static void fmi2_jacobian_color(fmi2_import_jacobian_t* jac, size_t* order, size_t* forbidden) {
+	size_t n = jac->n, i, c, d;
+
+	/* counting sort of the columns by decreasing number of non-zeros */
+	memset(forbidden, 0, (n + 2) * sizeof(size_t));
+	for(c = 0; c < n; c++) forbidden[n - (jac->cscStart[c + 1] - jac->cscStart[c]) + 1]++;
+	for(d = 1; d <= n + 1; d++) forbidden[d] += forbidden[d - 1];
+	for(c = 0; c < n; c++) order[forbidden[n - (jac->cscStart[c + 1] - jac->cscStart[c])]++] = c;
+
+	for(c = 0; c < n; c++) {
+		jac->color[c] = (size_t)-1;
+		forbidden[c] = (size_t)-1;
+	}
+	jac->numColors = 0;
+	for(i = 0; i < n; i++) {
+		size_t col = order[i], k, kk, cl;
+		for(k = jac->cscStart[col]; k < jac->cscStart[col + 1]; k++) {
+			size_t row = jac->cscRow[k];
+			for(kk = jac->csrStart[row]; kk < jac->csrStart[row + 1]; kk++) {
+				size_t other = jac->csrCol[kk];
+				if(jac->color[other] != (size_t)-1) forbidden[jac->color[other]] = col;
+			}
+		}
+		for(cl = 0; forbidden[cl] == col; cl++);
+		jac->color[col] = cl;
+		if(cl + 1 > jac->numColors) jac->numColors = cl + 1;
+	}
+}
+
+/* Group the columns by color and precompute the value reference lists of every group */
+static void fmi2_jacobian_build_groups(fmi2_import_jacobian_t* jac, const fmi2_value_reference_t* stateVr, const fmi2_value_reference_t* derVr) {
+	size_t n = jac->n, c, k, cl, pos = 0;
+
+	for(c = 0; c < n; c++) jac->colorStart[jac->color[c] + 1]++;
+	for(cl = 0; cl < jac->numColors; cl++) jac->colorStart[cl + 1] += jac->colorStart[cl];
+	for(c = 0; c < n; c++) {
+		size_t p = jac->colorStart[jac->color[c]]++;
+		jac->colorCols[p] = c;
+	}
+	for(cl = jac->numColors; cl > 0; cl--) jac->colorStart[cl] = jac->colorStart[cl - 1];
+	jac->colorStart[0] = 0;
+
+	for(cl = 0; cl < jac->numColors; cl++) {
+		jac->colorEntryStart[cl] = pos;
+		for(k = jac->colorStart[cl]; k < jac->colorStart[cl + 1]; k++) {
+			size_t col = jac->colorCols[k], e;
+			jac->colorKnownVr[k] = stateVr[col];
+			for(e = jac->cscStart[col]; e < jac->cscStart[col + 1]; e++) {
+				jac->colorUnknownVr[pos] = derVr[jac->cscRow[e]];
+				jac->colorEntry[pos] = e;
+				pos++;
+			}
+		}
+	}
+	jac->colorEntryStart[jac->numColors] = pos;
+}
+
+fmi2_import_jacobian_t* fmi2_import_jacobian_create(fmi2_import_t* fmu, fmi2_import_jacobian_method_enu_t method) {
+	jm_callbacks* cb;
+	fmi2_import_jacobian_t* jac;
+	fmi2_import_variable_list_t* ders;
+	jm_vector(jm_voidp)* vars;
+	size_t n, nvars, i;
+	size_t *stateOf = 0, *scratch1 = 0, *scratch2 = 0;
+	fmi2_value_reference_t *stateVr = 0, *derVr = 0;
+	int ok = 1;
+
+	if(!fmu) return 0;
+	cb = fmu->callbacks;
+	if(!fmu->capi) {
+		jm_log_error(cb, module, "No FMU is loaded");
+		return 0;
+	}
+	if(method == fmi2_import_jacobian_method_auto) {
+		method = (fmu->capi->fmi2GetDirectionalDerivative && fmi2_import_get_capability(fmu, fmi2_me_providesDirectionalDerivatives)) ?
+			fmi2_import_jacobian_method_directional : fmi2_import_jacobian_method_finite_differences;
+	}
+	else if(method == fmi2_import_jacobian_method_directional && !fmu->capi->fmi2GetDirectionalDerivative) {
+		jm_log_error(cb, module, "The FMU does not provide directional derivatives");
+		return 0;
+	}
+
+	jac = (fmi2_import_jacobian_t*)cb->calloc(1, sizeof(fmi2_import_jacobian_t));
+	if(!jac) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	jac->fmu = fmu;
+	jac->callbacks = cb;
+	jac->method = method;
+
+	ders = fmi2_import_get_derivatives_list(fmu);
+	vars = fmi2_xml_get_variables_original_order(fmu->md);
+	if(!ders || !vars) {
+		fmi2_import_free_variable_list(ders);
+		fmi2_import_jacobian_free(jac);
+		return 0;
+	}
+	n = jac->n = fmi2_import_get_variable_list_size(ders);
+	nvars = jm_vector_get_size(jm_voidp)(vars);
+
+	stateOf = (size_t*)fmi2_jacobian_alloc(jac, nvars, sizeof(size_t), &ok);
+	scratch1 = (size_t*)fmi2_jacobian_alloc(jac, n + 2, sizeof(size_t), &ok);
+	scratch2 = (size_t*)fmi2_jacobian_alloc(jac, n + 2, sizeof(size_t), &ok);
+	stateVr = (fmi2_value_reference_t*)fmi2_jacobian_alloc(jac, n, sizeof(fmi2_value_reference_t), &ok);
+	derVr = (fmi2_value_reference_t*)fmi2_jacobian_alloc(jac, n, sizeof(fmi2_value_reference_t), &ok);
+
+	for(i = 0; ok && i < n; i++) {
+		fmi2_import_variable_t* der = fmi2_import_get_variable(ders, i);
+		fmi2_import_real_variable_t* state = fmi2_import_get_real_variable_derivative_of(fmi2_import_get_variable_as_real(der));
+		size_t idx;
+		if(!state) {
+			jm_log_error(cb, module, "Derivative %s does not specify the corresponding state", fmi2_import_get_variable_name(der));
+			ok = 0;
+			break;
+		}
+		/* The ModelStructure indices are positions in the original order, which differ from
+		   the original index if bad aliases were removed */
+		idx = fmi2_xml_get_variable_position(fmu->md, (fmi2_xml_variable_t*)state);
+		if(idx == nvars) {
+			jm_log_error(cb, module, "State %s of derivative %s is not in the model description",
+				fmi2_import_get_variable_name((fmi2_import_variable_t*)state), fmi2_import_get_variable_name(der));
+			ok = 0;
+			break;
+		}
+		stateOf[idx] = i + 1;
+		stateVr[i] = fmi2_import_get_variable_vr((fmi2_import_variable_t*)state);
+		derVr[i] = fmi2_import_get_variable_vr(der);
+	}
+	fmi2_import_free_variable_list(ders);
+
+	if(ok) ok = fmi2_jacobian_build_pattern(jac, stateOf, nvars, scratch1);
+	if(ok) {
+		size_t nnz = jac->nnz;
+		jac->csrVal = (fmi2_real_t*)fmi2_jacobian_alloc(jac, nnz, sizeof(fmi2_real_t), &ok);
+		jac->cscStart = (size_t*)fmi2_jacobian_alloc(jac, n + 1, sizeof(size_t), &ok);
+		jac->cscRow = (size_t*)fmi2_jacobian_alloc(jac, nnz, sizeof(size_t), &ok);
+		jac->cscVal = (fmi2_real_t*)fmi2_jacobian_alloc(jac, nnz, sizeof(fmi2_real_t), &ok);
+		jac->cscToCsr = (size_t*)fmi2_jacobian_alloc(jac, nnz, sizeof(size_t), &ok);
+		jac->color = (size_t*)fmi2_jacobian_alloc(jac, n, sizeof(size_t), &ok);
+		jac->colorCols = (size_t*)fmi2_jacobian_alloc(jac, n, sizeof(size_t), &ok);
+		jac->colorEntry = (size_t*)fmi2_jacobian_alloc(jac, nnz, sizeof(size_t), &ok);
+		jac->colorKnownVr = (fmi2_value_reference_t*)fmi2_jacobian_alloc(jac, n, sizeof(fmi2_value_reference_t), &ok);
+		jac->colorUnknownVr = (fmi2_value_reference_t*)fmi2_jacobian_alloc(jac, nnz, sizeof(fmi2_value_reference_t), &ok);
+		jac->x0 = (fmi2_real_t*)fmi2_jacobian_alloc(jac, n, sizeof(fmi2_real_t), &ok);
+		jac->f0 = (fmi2_real_t*)fmi2_jacobian_alloc(jac, n, sizeof(fmi2_real_t), &ok);
+		jac->xw = (fmi2_real_t*)fmi2_jacobian_alloc(jac, n, sizeof(fmi2_real_t), &ok);
+		jac->fw = (fmi2_real_t*)fmi2_jacobian_alloc(jac, n, sizeof(fmi2_real_t), &ok);
+		jac->delta = (fmi2_real_t*)fmi2_jacobian_alloc(jac, n, sizeof(fmi2_real_t), &ok);
+		jac->nominal = (fmi2_real_t*)fmi2_jacobian_alloc(jac, n, sizeof(fmi2_real_t), &ok);
+	}
+	if(ok) {
+		fmi2_jacobian_build_csc(jac);
+		fmi2_jacobian_color(jac, scratch1, scratch2);
+		jac->colorStart = (size_t*)fmi2_jacobian_alloc(jac, jac->numColors + 1, sizeof(size_t), &ok);
+		jac->colorEntryStart = (size_t*)fmi2_jacobian_alloc(jac, jac->numColors + 1, sizeof(size_t), &ok);
+	}
+	if(ok) {
+		fmi2_jacobian_build_groups(jac, stateVr, derVr);
+		if(method == fmi2_import_jacobian_method_directional) {
+			/* xw is the constant seed vector for directional derivatives */
+			for(i = 0; i < n; i++) jac->xw[i] = 1.0;
+		}
+		jm_log_verbose(cb, module, "Jacobian with %u states, %u non-zeros and %u colors",
+			(unsigned)n, (unsigned)jac->nnz, (unsigned)jac->numColors);
+	}
+
+	cb->free(stateOf);
+	cb->free(scratch1);
+	cb->free(scratch2);
+	cb->free(stateVr);
+	cb->free(derVr);
+	if(!ok) {
+		fmi2_import_jacobian_free(jac);
+		return 0;
+	}
+	return jac;
+}
+
+static jm_status_enu_t fmi2_jacobian_check(fmi2_import_jacobian_t* jac, fmi2_status_t status, const char* fname) {
+	if(status == fmi2_status_ok || status == fmi2_status_warning) return jm_status_success;
+	jm_log_error(jac->callbacks, module, "%s returned status %s during Jacobian evaluation", fname, fmi2_status_to_string(status));
+	return jm_status_error;
+}
+
+static jm_status_enu_t fmi2_jacobian_evaluate_directional(fmi2_import_jacobian_t* jac) {
+	size_t cl, k;
+
+	for(cl = 0; cl < jac->numColors; cl++) {
+		size_t e0 = jac->colorEntryStart[cl], ne = jac->colorEntryStart[cl + 1] - e0;
+		size_t c0 = jac->colorStart[cl], nc = jac->colorStart[cl + 1] - c0;
+		fmi2_status_t status;
+
+		if(ne == 0) continue;
+		/* unknowns: derivatives touched by the group, knowns: states of the group, seed: all ones */
+		status = fmi2_import_get_directional_derivative(jac->fmu, jac->colorUnknownVr + e0, ne,
+			jac->colorKnownVr + c0, nc, jac->xw, jac->fw);
+		if(fmi2_jacobian_check(jac, status, "fmi2GetDirectionalDerivative") != jm_status_success) return jm_status_error;
+		for(k = 0; k < ne; k++) jac->cscVal[jac->colorEntry[e0 + k]] = jac->fw[k];
+	}
+	return jm_status_success;
+}
+
+static jm_status_enu_t fmi2_jacobian_evaluate_fd(fmi2_import_jacobian_t* jac, const fmi2_real_t* x, const fmi2_real_t* dx) {
+	fmi2_import_t* fmu = jac->fmu;
+	size_t n = jac->n, cl, k, e;
+	const fmi2_real_t* f0;
+	fmi2_real_t sqrteps = sqrt(DBL_EPSILON);
+
+	if(!x) {
+		if(fmi2_jacobian_check(jac, fmi2_import_get_continuous_states(fmu, jac->x0, n), "fmi2GetContinuousStates") != jm_status_success)
+			return jm_status_error;
+		x = jac->x0;
+	}
+	if(!dx) {
+		if(fmi2_jacobian_check(jac, fmi2_import_get_derivatives(fmu, jac->f0, n), "fmi2GetDerivatives") != jm_status_success)
+			return jm_status_error;
+		dx = jac->f0;
+	}
+	f0 = dx;
+	if(fmi2_jacobian_check(jac, fmi2_import_get_nominals_of_continuous_states(fmu, jac->nominal, n), "fmi2GetNominalsOfContinuousStates") != jm_status_success)
+		return jm_status_error;
+
+	memcpy(jac->xw, x, n * sizeof(fmi2_real_t));
+	for(k = 0; k < n; k++) {
+		fmi2_real_t scale = fabs(x[k]), nom = fabs(jac->nominal[k]);
+		if(nom == 0) nom = 1.0;
+		if(scale < nom) scale = nom;
+		/* make the perturbation exactly representable */
+		jac->delta[k] = (x[k] + sqrteps * scale) - x[k];
+	}
+
+	for(cl = 0; cl < jac->numColors; cl++) {
+		for(k = jac->colorStart[cl]; k < jac->colorStart[cl + 1]; k++) {
+			size_t c = jac->colorCols[k];
+			jac->xw[c] = x[c] + jac->delta[c];
+		}
+		if(fmi2_jacobian_check(jac, fmi2_import_set_continuous_states(fmu, jac->xw, n), "fmi2SetContinuousStates") != jm_status_success ||
+		   fmi2_jacobian_check(jac, fmi2_import_get_derivatives(fmu, jac->fw, n), "fmi2GetDerivatives") != jm_status_success)
+			break;
+		for(k = jac->colorStart[cl]; k < jac->colorStart[cl + 1]; k++) {
+			size_t c = jac->colorCols[k];
+			for(e = jac->cscStart[c]; e < jac->cscStart[c + 1]; e++) {
+				size_t r = jac->cscRow[e];
+				jac->cscVal[e] = (jac->fw[r] - f0[r]) / jac->delta[c];
+			}
+			jac->xw[c] = x[c];
+		}
+	}
+	/* restore the unperturbed states */
+	if(fmi2_jacobian_check(jac, fmi2_import_set_continuous_states(fmu, x, n), "fmi2SetContinuousStates") != jm_status_success)
+		return jm_status_error;
+	return (cl == jac->numColors) ? jm_status_success : jm_status_error;
+}
+
+jm_status_enu_t fmi2_import_jacobian_evaluate(fmi2_import_jacobian_t* jac, const fmi2_real_t* x, const fmi2_real_t* dx) {
+	jm_status_enu_t status;
+	size_t k;
+
+	if(jac->n == 0) return jm_status_success;
+	if(jac->method == fmi2_import_jacobian_method_directional)
+		status = fmi2_jacobian_evaluate_directional(jac);
+	else
+		status = fmi2_jacobian_evaluate_fd(jac, x, dx);
+	if(status != jm_status_success) return status;
+
+	for(k = 0; k < jac->nnz; k++) jac->csrVal[jac->cscToCsr[k]] = jac->cscVal[k];
+	return jm_status_success;
+}
+
+size_t fmi2_import_jacobian_get_dimension(fmi2_import_jacobian_t* jac) {
+	return jac->n;
+}
+
+size_t fmi2_import_jacobian_get_nnz(fmi2_import_jacobian_t* jac) {
+	return jac->nnz;
+}
+
+size_t fmi2_import_jacobian_get_number_of_colors(fmi2_import_jacobian_t* jac) {
+	return jac->numColors;
+}
+
+const size_t* fmi2_import_jacobian_get_colors(fmi2_import_jacobian_t* jac) {
+	return jac->color;
+}
+
+fmi2_import_jacobian_method_enu_t fmi2_import_jacobian_get_method(fmi2_import_jacobian_t* jac) {
+	return jac->method;
+}
+
+void fmi2_import_jacobian_get_csr(fmi2_import_jacobian_t* jac, const size_t** rowStart, const size_t** colIndex, const fmi2_real_t** values) {
+	*rowStart = jac->csrStart;
+	*colIndex = jac->csrCol;
+	*values = jac->csrVal;
+}
+
+void fmi2_import_jacobian_get_csc(fmi2_import_jacobian_t* jac, const size_t** colStart, const size_t** rowIndex, const fmi2_real_t** values) {
+	*colStart = jac->cscStart;
+	*rowIndex = jac->cscRow;
+	*values = jac->cscVal;
+}
@@ -0,0 +1,415 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+
+#include <JM/jm_thread.h>
+#include <JM/jm_call_statistics.h>
+#include <FMI2/fmi2_import_log_filter.h>
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+#define FMI2_LOG_FILTER_INITIAL_BUCKETS 64
+
+/* A rule; NULL names match anything */
+typedef struct fmi2_import_log_rule_t {
+	char* instanceName;
+	char* category;
+	int hasLevel;
+	jm_log_level_enu_t level;
+	int hasRate;
+	double rate;
+	double burst;
+	int hasSampling;
+	size_t firstN;
+	size_t everyNth;
+} fmi2_import_log_rule_t;
+
+/* Resolved settings and state of one (instance name, category) pair. The names follow the struct. */
+typedef struct fmi2_import_log_filter_entry_t {
+	struct fmi2_import_log_filter_entry_t* next;
+	size_t hash;
+	size_t instanceLen;
+	size_t categoryLen;
+
+	int hasLevel;
+	jm_log_level_enu_t level;
+	int hasRate;
+	double rate;
+	double burst;
+	double tokens;
+	double lastTime;
+	int hasSampling;
+	size_t firstN;
+	size_t everyNth;
+	size_t count;
+} fmi2_import_log_filter_entry_t;
+
+struct fmi2_import_log_filter_t {
+	jm_callbacks* callbacks;
+
+	/* 'lock' protects everything below */
+	jm_mutex_t lock;
+	fmi2_import_log_rule_t* rules;
+	size_t numRules;
+	size_t capacityRules;
+
+	/* Chained hash table of the entries */
+	fmi2_import_log_filter_entry_t** buckets;
+	size_t numBuckets;
+	size_t numEntries;
+
+	fmi2_import_log_filter_statistics_t stats;
+};
+
+/* FNV-1a over the instance name, a separator and the category */
+static size_t fmi2_log_filter_hash(const char* instanceName, size_t instanceLen, const char* category, size_t categoryLen) {
+	size_t h = (size_t)2166136261U, k;
+	for(k = 0; k < instanceLen; k++) h = (h ^ (unsigned char)instanceName[k]) * 16777619U;
+	h = (h ^ 0xff) * 16777619U;
+	for(k = 0; k < categoryLen; k++) h = (h ^ (unsigned char)category[k]) * 16777619U;
+	return h;
+}
+
+static const char* fmi2_log_filter_entry_instance(fmi2_import_log_filter_entry_t* e) {
+	return (const char*)(e + 1);
+}
+
+static const char* fmi2_log_filter_entry_category(fmi2_import_log_filter_entry_t* e) {
+	return (const char*)(e + 1) + e->instanceLen + 1;
+}
+
+static void fmi2_log_filter_clear_entries(fmi2_import_log_filter_t* filter) {
+	size_t k;
+	for(k = 0; k < filter->numBuckets; k++) {
+		fmi2_import_log_filter_entry_t* e = filter->buckets[k];
+		while(e) {
+			fmi2_import_log_filter_entry_t* next = e->next;
+			filter->callbacks->free(e);
+			e = next;
+		}
+		filter->buckets[k] = 0;
+	}
+	filter->numEntries = 0;
+}
+
+/* 0 - no match, otherwise the higher the more specific */
+static int fmi2_log_rule_match(fmi2_import_log_rule_t* r, const char* instanceName, const char* category) {
+	if(r->instanceName && strcmp(r->instanceName, instanceName)) return 0;
+	if(r->category && strcmp(r->category, category)) return 0;
+	return 1 + (r->category != 0) + 2 * (r->instanceName != 0);
+}
+
+static void fmi2_log_filter_resolve(fmi2_import_log_filter_t* filter, fmi2_import_log_filter_entry_t* e,
+									const char* instanceName, const char* category) {
+	int levelMatch = 0, rateMatch = 0, samplingMatch = 0, m;
+	size_t k;
+
+	e->hasLevel = e->hasRate = e->hasSampling = 0;
+	for(k = 0; k < filter->numRules; k++) {
+		fmi2_import_log_rule_t* r = &filter->rules[k];
+		m = fmi2_log_rule_match(r, instanceName, category);
+		if(!m) continue;
+		if(r->hasLevel && m > levelMatch) {
+			levelMatch = m;
+			e->hasLevel = 1;
+			e->level = r->level;
+		}
+		if(r->hasRate && m > rateMatch) {
+			rateMatch = m;
+			e->hasRate = 1;
+			e->rate = r->rate;
+			e->burst = r->burst;
+		}
+		if(r->hasSampling && m > samplingMatch) {
+			samplingMatch = m;
+			e->hasSampling = 1;
+			e->firstN = r->firstN;
+			e->everyNth = r->everyNth;
+		}
+	}
+	e->tokens = e->burst;
+	e->lastTime = e->hasRate ? jm_get_monotonic_time() : 0;
+	e->count = 0;
+}
+
+static int fmi2_log_filter_grow(fmi2_import_log_filter_t* filter) {
+	size_t numBuckets = filter->numBuckets ? 2 * filter->numBuckets : FMI2_LOG_FILTER_INITIAL_BUCKETS, k;
+	fmi2_import_log_filter_entry_t** buckets =
+		(fmi2_import_log_filter_entry_t**)filter->callbacks->calloc(numBuckets, sizeof(fmi2_import_log_filter_entry_t*));
+
+	if(!buckets) return 0;
+	for(k = 0; k < filter->numBuckets; k++) {
+		fmi2_import_log_filter_entry_t* e = filter->buckets[k];
+		while(e) {
+			fmi2_import_log_filter_entry_t* next = e->next;
+			e->next = buckets[e->hash & (numBuckets - 1)];
+			buckets[e->hash & (numBuckets - 1)] = e;
+			e = next;
+		}
+	}
+	filter->callbacks->free(filter->buckets);
+	filter->buckets = buckets;
+	filter->numBuckets = numBuckets;
+	return 1;
+}
+
+/* Find or add the entry of a pair. Returns NULL if out of memory. */
+static fmi2_import_log_filter_entry_t* fmi2_log_filter_lookup(fmi2_import_log_filter_t* filter, const char* instanceName, const char* category) {
+	size_t instanceLen = strlen(instanceName), categoryLen = strlen(category);
+	size_t h = fmi2_log_filter_hash(instanceName, instanceLen, category, categoryLen);
+	fmi2_import_log_filter_entry_t* e;
+
+	if(filter->numBuckets) {
+		for(e = filter->buckets[h & (filter->numBuckets - 1)]; e; e = e->next) {
+			if(e->hash == h && e->instanceLen == instanceLen && e->categoryLen == categoryLen
+				&& !memcmp(fmi2_log_filter_entry_instance(e), instanceName, instanceLen)
+				&& !memcmp(fmi2_log_filter_entry_category(e), category, categoryLen))
+				return e;
+		}
+	}
+	if(filter->numEntries >= filter->numBuckets && !fmi2_log_filter_grow(filter)) return 0;
+
+	e = (fmi2_import_log_filter_entry_t*)filter->callbacks->malloc(sizeof(fmi2_import_log_filter_entry_t) + instanceLen + categoryLen + 2);
+	if(!e) return 0;
+	e->hash = h;
+	e->instanceLen = instanceLen;
+	e->categoryLen = categoryLen;
+	memcpy((char*)fmi2_log_filter_entry_instance(e), instanceName, instanceLen + 1);
+	memcpy((char*)fmi2_log_filter_entry_category(e), category, categoryLen + 1);
+	fmi2_log_filter_resolve(filter, e, instanceName, category);
+	e->next = filter->buckets[h & (filter->numBuckets - 1)];
+	filter->buckets[h & (filter->numBuckets - 1)] = e;
+	filter->numEntries++;
+	return e;
+}
+
+static char* fmi2_log_filter_strdup(jm_callbacks* cb, const char* s) {
+	char* copy;
+	if(!s) return 0;
+	copy = (char*)cb->malloc(strlen(s) + 1);
+	if(copy) strcpy(copy, s);
+	return copy;
+}
+
+static int fmi2_log_filter_same_name(const char* a, const char* b) {
+	if(!a || !b) return a == b;
+	return !strcmp(a, b);
+}
+
+/* Find or add the rule for the pattern; called with the lock held. The cached entries are dropped. */
+static fmi2_import_log_rule_t* fmi2_log_filter_get_rule(fmi2_import_log_filter_t* filter, const char* instanceName, const char* category) {
+	fmi2_import_log_rule_t* r;
+	size_t k;
+
+	fmi2_log_filter_clear_entries(filter);
+	for(k = 0; k < filter->numRules; k++) {
+		r = &filter->rules[k];
+		if(fmi2_log_filter_same_name(r->instanceName, instanceName) && fmi2_log_filter_same_name(r->category, category))
+			return r;
+	}
+	if(filter->numRules == filter->capacityRules) {
+		size_t capacity = filter->capacityRules ? 2 * filter->capacityRules : 8;
+		r = (fmi2_import_log_rule_t*)filter->callbacks->realloc(filter->rules, capacity * sizeof(fmi2_import_log_rule_t));
+		if(!r) {
+			jm_log_fatal(filter->callbacks, module, "Could not allocate memory");
+			return 0;
+		}
+		filter->rules = r;
+		filter->capacityRules = capacity;
+	}
+	r = &filter->rules[filter->numRules];
+	memset(r, 0, sizeof(fmi2_import_log_rule_t));
+	r->instanceName = fmi2_log_filter_strdup(filter->callbacks, instanceName);
+	r->category = fmi2_log_filter_strdup(filter->callbacks, category);
+	if((instanceName && !r->instanceName) || (category && !r->category)) {
+		filter->callbacks->free(r->instanceName);
+		filter->callbacks->free(r->category);
+		jm_log_fatal(filter->callbacks, module, "Could not allocate memory");
+		return 0;
+	}
+	filter->numRules++;
+	return r;
+}
+
+fmi2_import_log_filter_t* fmi2_import_log_filter_create(jm_callbacks* cb) {
+	fmi2_import_log_filter_t* filter;
+
+	if(!cb) cb = jm_get_default_callbacks();
+	filter = (fmi2_import_log_filter_t*)cb->calloc(1, sizeof(fmi2_import_log_filter_t));
+	if(!filter) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	filter->callbacks = cb;
+	if(jm_mutex_init(&filter->lock) != jm_status_success) {
+		cb->free(filter);
+		return 0;
+	}
+	return filter;
+}
+
+void fmi2_import_log_filter_clear(fmi2_import_log_filter_t* filter) {
+	size_t k;
+
+	jm_mutex_lock(&filter->lock);
+	fmi2_log_filter_clear_entries(filter);
+	for(k = 0; k < filter->numRules; k++) {
+		filter->callbacks->free(filter->rules[k].instanceName);
+		filter->callbacks->free(filter->rules[k].category);
+	}
+	filter->numRules = 0;
+	jm_mutex_unlock(&filter->lock);
+}
+
+void fmi2_import_log_filter_free(fmi2_import_log_filter_t* filter) {
+	if(!filter) return;
+	fmi2_import_log_filter_clear(filter);
+	jm_mutex_destroy(&filter->lock);
+	filter->callbacks->free(filter->buckets);
+	filter->callbacks->free(filter->rules);
+	filter->callbacks->free(filter);
+}
+
+jm_status_enu_t fmi2_import_log_filter_set_level(fmi2_import_log_filter_t* filter, const char* instanceName, const char* category, jm_log_level_enu_t level) {
+	fmi2_import_log_rule_t* r;
+
+	jm_mutex_lock(&filter->lock);
+	r = fmi2_log_filter_get_rule(filter, instanceName, category);
+	if(r) {
+		r->hasLevel = 1;
+		r->level = level;
+	}
+	jm_mutex_unlock(&filter->lock);
+	return r ? jm_status_success : jm_status_error;
+}
+
+jm_status_enu_t fmi2_import_log_filter_set_rate_limit(fmi2_import_log_filter_t* filter, const char* instanceName, const char* category, double messagesPerSecond, double burst) {
+	fmi2_import_log_rule_t* r;
+
+	jm_mutex_lock(&filter->lock);
+	r = fmi2_log_filter_get_rule(filter, instanceName, category);
+	if(r) {
+		r->hasRate = 1;
+		r->rate = messagesPerSecond;
+		r->burst = burst;
+	}
+	jm_mutex_unlock(&filter->lock);
+	return r ? jm_status_success : jm_status_error;
+}
+
+jm_status_enu_t fmi2_import_log_filter_set_sampling(fmi2_import_log_filter_t* filter, const char* instanceName, const char* category, size_t firstN, size_t everyNth) {
+	fmi2_import_log_rule_t* r;
+
+	jm_mutex_lock(&filter->lock);
+	r = fmi2_log_filter_get_rule(filter, instanceName, category);
+	if(r) {
+		r->hasSampling = 1;
+		r->firstN = firstN;
+		r->everyNth = everyNth;
+	}
+	jm_mutex_unlock(&filter->lock);
+	return r ? jm_status_success : jm_status_error;
+}
+
+int fmi2_import_log_filter_accept(fmi2_import_log_filter_t* filter, const char* instanceName, const char* category,
+								  jm_log_level_enu_t level, jm_log_level_enu_t defaultLevel) {
+	fmi2_import_log_filter_entry_t* e;
+	int pass = 1;
+
+	jm_mutex_lock(&filter->lock);
+	e = fmi2_log_filter_lookup(filter, instanceName ? instanceName : "", category ? category : "");
+	if(!e) {
+		/* Out of memory: fall back to the default level */
+		pass = (level <= defaultLevel);
+		if(pass) filter->stats.passed++; else filter->stats.rejected_level++;
+		jm_mutex_unlock(&filter->lock);
+		return pass;
+	}
+	if(level > (e->hasLevel ? e->level : defaultLevel)) {
+		filter->stats.rejected_level++;
+		pass = 0;
+	}
+	else if(e->hasSampling) {
+		e->count++;
+		if(e->count > e->firstN && !(e->everyNth && (e->count - e->firstN) % e->everyNth == 0)) {
+			filter->stats.rejected_sampling++;
+			pass = 0;
+		}
+	}
+	if(pass && e->hasRate) {
+		double now = jm_get_monotonic_time();
+		e->tokens += (now - e->lastTime) * e->rate;
+		if(e->tokens > e->burst) e->tokens = e->burst;
+		e->lastTime = now;
+		if(e->tokens >= 1.0) {
+			e->tokens -= 1.0;
+		}
+		else {
+			filter->stats.rejected_rate++;
+			pass = 0;
+		}
+	}
+	if(pass) filter->stats.passed++;
+	jm_mutex_unlock(&filter->lock);
+	return pass;
+}
+
+void fmi2_import_log_filter_get_statistics(fmi2_import_log_filter_t* filter, fmi2_import_log_filter_statistics_t* stats) {
+	jm_mutex_lock(&filter->lock);
+	*stats = filter->stats;
+	jm_mutex_unlock(&filter->lock);
+}
+
+void fmi2_import_set_log_filter(fmi2_import_t* fmu, fmi2_import_log_filter_t* filter) {
+	fmu->logFilter = filter;
+}
+
+fmi2_import_log_filter_t* fmi2_import_get_log_filter(fmi2_import_t* fmu) {
+	return fmu->logFilter;
+}
+
+fmi2_status_t fmi2_import_apply_log_filter_categories(fmi2_import_t* fmu, const char* instanceName) {
+	fmi2_import_log_filter_t* filter = fmu->logFilter;
+	size_t n = fmi2_import_get_log_categories_num(fmu), k, enabled = 0;
+	fmi2_string_t* categories;
+	fmi2_status_t status;
+
+	if(!filter || n == 0) return fmi2_status_ok;
+	categories = (fmi2_string_t*)fmu->callbacks->malloc(n * sizeof(fmi2_string_t));
+	if(!categories) {
+		jm_log_fatal(fmu->callbacks, module, "Could not allocate memory");
+		return fmi2_status_error;
+	}
+	jm_mutex_lock(&filter->lock);
+	for(k = 0; k < n; k++) {
+		const char* category = fmi2_import_get_log_category(fmu, k);
+		fmi2_import_log_filter_entry_t* e = fmi2_log_filter_lookup(filter, instanceName ? instanceName : "", category);
+		jm_log_level_enu_t level = (e && e->hasLevel) ? e->level : fmu->callbacks->log_level;
+		if(level > jm_log_level_nothing) categories[enabled++] = category;
+	}
+	jm_mutex_unlock(&filter->lock);
+
+	jm_log_verbose(fmu->callbacks, module, "Enabling %u of %u log categories", (unsigned)enabled, (unsigned)n);
+	if(enabled == n)
+		status = fmi2_import_set_debug_logging(fmu, fmi2_true, 0, 0);
+	else if(enabled == 0)
+		status = fmi2_import_set_debug_logging(fmu, fmi2_false, 0, 0);
+	else
+		status = fmi2_import_set_debug_logging(fmu, fmi2_true, enabled, categories);
+	fmu->callbacks->free(categories);
+	return status;
+}
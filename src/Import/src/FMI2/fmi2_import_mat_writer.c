@@ -0,0 +1,406 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <FMI2/fmi2_import_mat_writer.h>
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+/* Buffer size of the result file stream */
+#define FMI2_MAT_FILE_BUFFER_SIZE (1024*1024)
+
+/* MATLAB v4 matrix types: 1000*M + 10*P + T with M the byte order, P the element type and T the class */
+#define FMI2_MAT_TYPE_DOUBLE 0
+#define FMI2_MAT_TYPE_INT32 20
+#define FMI2_MAT_TYPE_TEXT 51
+
+/* A variable to be sorted into the data columns */
+typedef struct fmi2_mat_entry_t {
+	fmi2_base_type_enu_t type;
+	fmi2_value_reference_t vr;
+	size_t index;
+} fmi2_mat_entry_t;
+
+struct fmi2_import_mat_writer_t {
+	fmi2_import_t* fmu;
+	jm_callbacks* callbacks;
+	FILE* file;
+	char* fileBuffer;
+	int error;
+
+	/* Unique values ordered real, integer, boolean so that they are read with one call per type */
+	size_t numValues, numReal, numInteger, numBoolean;
+	fmi2_value_reference_t* vrs;
+	fmi2_real_t* realRow;
+	fmi2_integer_t* integerRow;
+	fmi2_boolean_t* booleanRow;
+	int* valueMatrix;     /* 1 for data_1, 2 for data_2 */
+	size_t* valueRow;     /* row in data_1 or data_2, 0 is time */
+
+	size_t numRows1, numRows2;  /* rows of data_1 and data_2 including time */
+	fmi2_real_t* data1;
+	fmi2_real_t* data2;
+
+	long data1Pos;        /* position of the data_1 matrix */
+	long data2Pos;        /* position of the data_2 matrix */
+	size_t numRows;
+	fmi2_real_t lastTime;
+};
+
+static int fmi2_mat_compare_entries(const void* a, const void* b) {
+	const fmi2_mat_entry_t* ea = (const fmi2_mat_entry_t*)a;
+	const fmi2_mat_entry_t* eb = (const fmi2_mat_entry_t*)b;
+	if(ea->type != eb->type) return (ea->type < eb->type) ? -1 : 1;
+	if(ea->vr != eb->vr) return (ea->vr < eb->vr) ? -1 : 1;
+	return (ea->index < eb->index) ? -1 : (ea->index > eb->index);
+}
+
+static int fmi2_mat_is_big_endian(void) {
+	unsigned int one = 1;
+	return *(unsigned char*)&one != 1;
+}
+
+static void fmi2_mat_write(fmi2_import_mat_writer_t* writer, const void* data, size_t size) {
+	if(size && fwrite(data, 1, size, writer->file) != size) writer->error = 1;
+}
+
+static void fmi2_mat_write_header(fmi2_import_mat_writer_t* writer, const char* name, int type, size_t rows, size_t cols) {
+	fmi2_integer_t header[5];
+	header[0] = type + (fmi2_mat_is_big_endian() ? 1000 : 0);
+	header[1] = (fmi2_integer_t)rows;
+	header[2] = (fmi2_integer_t)cols;
+	header[3] = 0;
+	header[4] = (fmi2_integer_t)strlen(name) + 1;
+	fmi2_mat_write(writer, header, sizeof(header));
+	fmi2_mat_write(writer, name, strlen(name) + 1);
+}
+
+/* Text matrix with one string per column, padded with zeros */
+static void fmi2_mat_write_strings(fmi2_import_mat_writer_t* writer, const char* name, const char** strings, size_t n) {
+	static const char zeros[64] = {0};
+	size_t i, len, pad, maxLen = 1;
+
+	for(i = 0; i < n; i++) {
+		len = strlen(strings[i]) + 1;
+		if(len > maxLen) maxLen = len;
+	}
+	fmi2_mat_write_header(writer, name, FMI2_MAT_TYPE_TEXT, maxLen, n);
+	for(i = 0; i < n; i++) {
+		len = strlen(strings[i]);
+		fmi2_mat_write(writer, strings[i], len);
+		for(pad = maxLen - len; pad > 0; pad -= len) {
+			len = (pad < sizeof(zeros)) ? pad : sizeof(zeros);
+			fmi2_mat_write(writer, zeros, len);
+		}
+	}
+}
+
+/* The Aclass matrix is not transposed: 4 rows of 11 characters padded with spaces, stored column by column */
+static void fmi2_mat_write_aclass(fmi2_import_mat_writer_t* writer) {
+	static const char* rows[4] = {"Atrajectory", "1.1", "", "binTrans"};
+	char data[44];
+	size_t r, c;
+
+	for(r = 0; r < 4; r++) {
+		for(c = 0; c < 11; c++)
+			data[c * 4 + r] = (c < strlen(rows[r])) ? rows[r][c] : ' ';
+	}
+	fmi2_mat_write_header(writer, "Aclass", FMI2_MAT_TYPE_TEXT, 4, 11);
+	fmi2_mat_write(writer, data, sizeof(data));
+}
+
+static void fmi2_mat_writer_destroy(fmi2_import_mat_writer_t* writer) {
+	jm_callbacks* cb = writer->callbacks;
+
+	cb->free(writer->vrs);
+	cb->free(writer->realRow);
+	cb->free(writer->integerRow);
+	cb->free(writer->booleanRow);
+	cb->free(writer->valueMatrix);
+	cb->free(writer->valueRow);
+	cb->free(writer->data1);
+	cb->free(writer->data2);
+	cb->free(writer->fileBuffer);
+	cb->free(writer);
+}
+
+/* Name, description and dataInfo of the recorded variables in list order */
+static int fmi2_mat_write_variables(fmi2_import_mat_writer_t* writer, fmi2_import_variable_list_t* vl, size_t* varValue) {
+	jm_callbacks* cb = writer->callbacks;
+	size_t i, k, n = fmi2_import_get_variable_list_size(vl), numVars = 1;
+	const char** names;
+	const char** descriptions;
+	char** owned;
+	fmi2_integer_t* dataInfo;
+	int ok = 1;
+
+	for(i = 0; i < n; i++) {
+		if(varValue[i] != (size_t)-1) numVars++;
+	}
+	names = (const char**)cb->calloc(numVars, sizeof(char*));
+	descriptions = (const char**)cb->calloc(numVars, sizeof(char*));
+	owned = (char**)cb->calloc(numVars, sizeof(char*));
+	dataInfo = (fmi2_integer_t*)cb->calloc(4 * numVars, sizeof(fmi2_integer_t));
+	if(!names || !descriptions || !owned || !dataInfo) {
+		cb->free((void*)names); cb->free((void*)descriptions); cb->free(owned); cb->free(dataInfo);
+		return 0;
+	}
+
+	names[0] = "time";
+	descriptions[0] = "Time [s]";
+	dataInfo[0] = 0;
+	dataInfo[1] = 1;
+	dataInfo[2] = 0;
+	dataInfo[3] = -1;
+	for(i = 0, k = 1; i < n; i++) {
+		fmi2_import_variable_t* v = fmi2_import_get_variable(vl, i);
+		const char* desc = fmi2_import_get_variable_description(v);
+		size_t val = varValue[i];
+		if(val == (size_t)-1) continue;
+
+		names[k] = fmi2_import_get_variable_name(v);
+		descriptions[k] = desc ? desc : "";
+		if(fmi2_import_get_variable_base_type(v) == fmi2_base_type_real) {
+			fmi2_import_unit_t* unit = fmi2_import_get_real_variable_unit(fmi2_import_get_variable_as_real(v));
+			const char* unitName = unit ? fmi2_import_get_unit_name(unit) : 0;
+			if(unitName && unitName[0]) {
+				owned[k] = (char*)cb->malloc(strlen(descriptions[k]) + strlen(unitName) + 4);
+				if(!owned[k]) {
+					ok = 0;
+					break;
+				}
+				sprintf(owned[k], "%s%s[%s]", descriptions[k], descriptions[k][0] ? " " : "", unitName); /*safe*/
+				descriptions[k] = owned[k];
+			}
+		}
+		dataInfo[4 * k] = writer->valueMatrix[val];
+		dataInfo[4 * k + 1] = (fmi2_integer_t)writer->valueRow[val] + 1;
+		dataInfo[4 * k + 2] = 0;
+		dataInfo[4 * k + 3] = (writer->valueMatrix[val] == 1) ? 0 : -1;
+		k++;
+	}
+
+	if(ok) {
+		fmi2_mat_write_strings(writer, "name", names, numVars);
+		fmi2_mat_write_strings(writer, "description", descriptions, numVars);
+		fmi2_mat_write_header(writer, "dataInfo", FMI2_MAT_TYPE_INT32, 4, numVars);
+		fmi2_mat_write(writer, dataInfo, 4 * numVars * sizeof(fmi2_integer_t));
+	}
+	for(k = 0; k < numVars; k++) cb->free(owned[k]);
+	cb->free((void*)names);
+	cb->free((void*)descriptions);
+	cb->free(owned);
+	cb->free(dataInfo);
+	return ok;
+}
+
+fmi2_import_mat_writer_t* fmi2_import_mat_writer_create(fmi2_import_t* fmu, fmi2_import_variable_list_t* vl, const char* fileName) {
+	jm_callbacks* cb = fmu->callbacks;
+	fmi2_import_mat_writer_t* writer;
+	fmi2_mat_entry_t* entries;
+	size_t* varValue;
+	size_t n = fmi2_import_get_variable_list_size(vl);
+	size_t i, numEntries = 0, numAlloc;
+	int ok;
+
+	writer = (fmi2_import_mat_writer_t*)cb->calloc(1, sizeof(fmi2_import_mat_writer_t));
+	entries = (fmi2_mat_entry_t*)cb->malloc((n ? n : 1) * sizeof(fmi2_mat_entry_t));
+	varValue = (size_t*)cb->malloc((n ? n : 1) * sizeof(size_t));
+	if(!writer || !entries || !varValue) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		cb->free(writer); cb->free(entries); cb->free(varValue);
+		return 0;
+	}
+	writer->fmu = fmu;
+	writer->callbacks = cb;
+
+	/* Sort the variables by type and value reference; aliases end up next to each other */
+	for(i = 0; i < n; i++) {
+		fmi2_import_variable_t* v = fmi2_import_get_variable(vl, i);
+		fmi2_base_type_enu_t type = fmi2_import_get_variable_base_type(v);
+		varValue[i] = (size_t)-1;
+		if(type == fmi2_base_type_str) {
+			jm_log_warning(cb, module, "String variable %s is not recorded", fmi2_import_get_variable_name(v));
+			continue;
+		}
+		entries[numEntries].type = (type == fmi2_base_type_enum) ? fmi2_base_type_int : type;
+		entries[numEntries].vr = fmi2_import_get_variable_vr(v);
+		entries[numEntries].index = i;
+		numEntries++;
+	}
+	qsort(entries, numEntries, sizeof(fmi2_mat_entry_t), fmi2_mat_compare_entries);
+
+	numAlloc = numEntries ? numEntries : 1;
+	writer->vrs = (fmi2_value_reference_t*)cb->malloc(numAlloc * sizeof(fmi2_value_reference_t));
+	writer->valueMatrix = (int*)cb->malloc(numAlloc * sizeof(int));
+	writer->valueRow = (size_t*)cb->malloc(numAlloc * sizeof(size_t));
+	ok = writer->vrs && writer->valueMatrix && writer->valueRow;
+	writer->numRows1 = writer->numRows2 = 1;
+	for(i = 0; ok && i < numEntries; i++) {
+		if(i == 0 || entries[i].type != entries[i-1].type || entries[i].vr != entries[i-1].vr) {
+			size_t val = writer->numValues++;
+			fmi2_variability_enu_t variability = fmi2_import_get_variability(fmi2_import_get_variable(vl, entries[i].index));
+			writer->vrs[val] = entries[i].vr;
+			if(entries[i].type == fmi2_base_type_real) writer->numReal++;
+			else if(entries[i].type == fmi2_base_type_int) writer->numInteger++;
+			else writer->numBoolean++;
+			if(variability == fmi2_variability_enu_constant || variability == fmi2_variability_enu_fixed || variability == fmi2_variability_enu_tunable) {
+				writer->valueMatrix[val] = 1;
+				writer->valueRow[val] = writer->numRows1++;
+			}
+			else {
+				writer->valueMatrix[val] = 2;
+				writer->valueRow[val] = writer->numRows2++;
+			}
+		}
+		varValue[entries[i].index] = writer->numValues - 1;
+	}
+	cb->free(entries);
+
+	if(ok) {
+		writer->realRow = (fmi2_real_t*)cb->malloc((writer->numReal + 1) * sizeof(fmi2_real_t));
+		writer->integerRow = (fmi2_integer_t*)cb->malloc((writer->numInteger + 1) * sizeof(fmi2_integer_t));
+		writer->booleanRow = (fmi2_boolean_t*)cb->malloc((writer->numBoolean + 1) * sizeof(fmi2_boolean_t));
+		writer->data1 = (fmi2_real_t*)cb->malloc(writer->numRows1 * sizeof(fmi2_real_t));
+		writer->data2 = (fmi2_real_t*)cb->malloc(writer->numRows2 * sizeof(fmi2_real_t));
+		writer->fileBuffer = (char*)cb->malloc(FMI2_MAT_FILE_BUFFER_SIZE);
+		ok = writer->realRow && writer->integerRow && writer->booleanRow && writer->data1 && writer->data2 && writer->fileBuffer;
+	}
+	if(!ok) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		cb->free(varValue);
+		fmi2_mat_writer_destroy(writer);
+		return 0;
+	}
+
+	writer->file = fopen(fileName, "wb");
+	if(!writer->file) {
+		jm_log_error(cb, module, "Could not open result file %s for writing", fileName);
+		cb->free(varValue);
+		fmi2_mat_writer_destroy(writer);
+		return 0;
+	}
+	setvbuf(writer->file, writer->fileBuffer, _IOFBF, FMI2_MAT_FILE_BUFFER_SIZE);
+	fmi2_mat_write_aclass(writer);
+	ok = fmi2_mat_write_variables(writer, vl, varValue);
+	cb->free(varValue);
+	if(!ok || writer->error) {
+		jm_log_error(cb, module, "Could not write to result file %s", fileName);
+		fclose(writer->file);
+		fmi2_mat_writer_destroy(writer);
+		return 0;
+	}
+	jm_log_verbose(cb, module, "Recording %u parameters and %u variables to %s",
+		(unsigned)(writer->numRows1 - 1), (unsigned)(writer->numRows2 - 1), fileName);
+	return writer;
+}
+
+jm_status_enu_t fmi2_import_mat_writer_record(fmi2_import_mat_writer_t* writer, fmi2_real_t time) {
+	const fmi2_value_reference_t* vrs = writer->vrs;
+	fmi2_status_t status = fmi2_status_ok;
+	size_t val;
+
+	if(writer->numRows > 0 && time < writer->lastTime) {
+		jm_log_error(writer->callbacks, module, "Result time %g is before the previous time %g", time, writer->lastTime);
+		return jm_status_error;
+	}
+	if(writer->numReal)
+		status = fmi2_import_get_real(writer->fmu, vrs, writer->numReal, writer->realRow);
+	if(writer->numInteger && (status == fmi2_status_ok || status == fmi2_status_warning))
+		status = fmi2_import_get_integer(writer->fmu, vrs + writer->numReal, writer->numInteger, writer->integerRow);
+	if(writer->numBoolean && (status == fmi2_status_ok || status == fmi2_status_warning))
+		status = fmi2_import_get_boolean(writer->fmu, vrs + writer->numReal + writer->numInteger, writer->numBoolean, writer->booleanRow);
+	if(status != fmi2_status_ok && status != fmi2_status_warning) {
+		jm_log_error(writer->callbacks, module, "Could not get the values to record at time %g", time);
+		return jm_status_error;
+	}
+
+	writer->data1[0] = writer->data2[0] = time;
+	for(val = 0; val < writer->numValues; val++) {
+		fmi2_real_t value;
+		if(val < writer->numReal)
+			value = writer->realRow[val];
+		else if(val < writer->numReal + writer->numInteger)
+			value = (fmi2_real_t)writer->integerRow[val - writer->numReal];
+		else
+			value = writer->booleanRow[val - writer->numReal - writer->numInteger] ? 1.0 : 0.0;
+		if(writer->valueMatrix[val] == 1) {
+			if(writer->numRows == 0) writer->data1[writer->valueRow[val]] = value;
+		}
+		else {
+			writer->data2[writer->valueRow[val]] = value;
+		}
+	}
+
+	if(writer->numRows == 0) {
+		/* data_1 holds the start and end values; the end time is updated on close */
+		writer->data1Pos = ftell(writer->file);
+		fmi2_mat_write_header(writer, "data_1", FMI2_MAT_TYPE_DOUBLE, writer->numRows1, 2);
+		fmi2_mat_write(writer, writer->data1, writer->numRows1 * sizeof(fmi2_real_t));
+		fmi2_mat_write(writer, writer->data1, writer->numRows1 * sizeof(fmi2_real_t));
+		writer->data2Pos = ftell(writer->file);
+		fmi2_mat_write_header(writer, "data_2", FMI2_MAT_TYPE_DOUBLE, writer->numRows2, 0);
+	}
+	fmi2_mat_write(writer, writer->data2, writer->numRows2 * sizeof(fmi2_real_t));
+	writer->numRows++;
+	writer->lastTime = time;
+	if(writer->error) {
+		jm_log_error(writer->callbacks, module, "Could not write to the result file");
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_mat_writer_close(fmi2_import_mat_writer_t* writer) {
+	jm_callbacks* cb;
+	fmi2_integer_t numCols;
+	long headerSize;
+	int error;
+
+	if(!writer) return jm_status_success;
+	cb = writer->callbacks;
+	if(writer->numRows == 0) {
+		/* Nothing was recorded: the data matrices have no columns */
+		fmi2_mat_write_header(writer, "data_1", FMI2_MAT_TYPE_DOUBLE, writer->numRows1, 0);
+		fmi2_mat_write_header(writer, "data_2", FMI2_MAT_TYPE_DOUBLE, writer->numRows2, 0);
+	}
+	else {
+		/* End time in the second column of data_1 and the number of columns of data_2 */
+		headerSize = (long)(5 * sizeof(fmi2_integer_t) + strlen("data_1") + 1);
+		if(fseek(writer->file, writer->data1Pos + headerSize + (long)(writer->numRows1 * sizeof(fmi2_real_t)), SEEK_SET) != 0)
+			writer->error = 1;
+		fmi2_mat_write(writer, &writer->lastTime, sizeof(fmi2_real_t));
+		numCols = (fmi2_integer_t)writer->numRows;
+		if(fseek(writer->file, writer->data2Pos + 2 * (long)sizeof(fmi2_integer_t), SEEK_SET) != 0)
+			writer->error = 1;
+		fmi2_mat_write(writer, &numCols, sizeof(fmi2_integer_t));
+	}
+	error = writer->error;
+	if(fclose(writer->file) != 0) error = 1;
+	fmi2_mat_writer_destroy(writer);
+	if(error) {
+		jm_log_error(cb, module, "Writing the result file failed");
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+size_t fmi2_import_mat_writer_get_number_of_rows(fmi2_import_mat_writer_t* writer) {
+	return writer->numRows;
+}
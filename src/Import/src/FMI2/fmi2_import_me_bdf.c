@@ -0,0 +1,418 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/* Variable step, variable order BDF solver for the ME driver.
+
+   The BDF formula of order q is derived from the interpolation polynomial through
+   the new point and the q last accepted points, so no interpolation of the history
+   is needed when the step size changes. The corrector equation
+       y - gamma*f(tnew, y) + psi = 0
+   is solved with a modified Newton method with the iteration matrix M = I - gamma*J.
+   J is the sparse state Jacobian and M is factored with the sparse LU solver. Both
+   are reused over many steps: the Jacobian is re-evaluated when the Newton iteration
+   fails or after a fixed number of steps, M is re-factored when gamma changed too much.
+   The local error is estimated from divided differences over the new point and the history. */
+
+#include <string.h>
+#include <math.h>
+
+#include "fmi2_import_impl.h"
+#include "fmi2_import_me_driver_impl.h"
+
+static const char* module = "FMILIB";
+
+/* Maximum number of Newton iterations per step */
+#define FMI2_ME_BDF_MAX_NEWTON 4
+
+/* The Newton iteration is converged when the estimated remaining error is below this fraction of the tolerance */
+#define FMI2_ME_BDF_NEWTON_TOL 0.33
+
+/* The iteration is considered diverging if the convergence rate exceeds this value */
+#define FMI2_ME_BDF_MAX_RATE 0.9
+
+/* Re-factor the iteration matrix when gamma changed by more than this fraction */
+#define FMI2_ME_BDF_GAMMA_CHANGE 0.3
+
+/* Re-evaluate the Jacobian after this many accepted steps */
+#define FMI2_ME_BDF_JACOBIAN_AGE 20
+
+static void fmi2_me_bdf_free_arrays(jm_callbacks* cb, fmi2_me_bdf_t* bdf) {
+	size_t i;
+	cb->free(bdf->mStart);
+	cb->free(bdf->mCol);
+	cb->free(bdf->mDiag);
+	cb->free(bdf->jacToM);
+	cb->free(bdf->mValues);
+	for(i = 0; i <= FMI2_ME_BDF_MAX_ORDER; i++) cb->free(bdf->hist[i]);
+	for(i = 0; i < FMI2_ME_BDF_MAX_ORDER + 2; i++) cb->free(bdf->dd[i]);
+	cb->free(bdf->psi);
+	cb->free(bdf->delta);
+	cb->free(bdf->f);
+}
+
+void fmi2_me_bdf_free(fmi2_import_me_driver_t* drv) {
+	jm_callbacks* cb = drv->callbacks;
+	fmi2_me_bdf_t* bdf = drv->bdf;
+
+	if(!bdf) return;
+	fmi2_import_jacobian_free(bdf->jac);
+	fmi2_import_sparse_lu_free(bdf->lu);
+	fmi2_me_bdf_free_arrays(cb, bdf);
+	cb->free(bdf);
+	drv->bdf = 0;
+}
+
+/* Build the pattern of M = I - gamma*J from the Jacobian pattern */
+static int fmi2_me_bdf_build_matrix(fmi2_import_me_driver_t* drv) {
+	jm_callbacks* cb = drv->callbacks;
+	fmi2_me_bdf_t* bdf = drv->bdf;
+	const size_t *rowStart, *colIndex;
+	const fmi2_real_t* values;
+	size_t n = drv->nx, i, p, m = 0;
+
+	fmi2_import_jacobian_get_csr(bdf->jac, &rowStart, &colIndex, &values);
+	bdf->mStart = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	bdf->mCol = (size_t*)cb->calloc(rowStart[n] + n + 1, sizeof(size_t));
+	bdf->mDiag = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	bdf->jacToM = (size_t*)cb->calloc(rowStart[n] + 1, sizeof(size_t));
+	bdf->mValues = (double*)cb->calloc(rowStart[n] + n + 1, sizeof(double));
+	if(!bdf->mStart || !bdf->mCol || !bdf->mDiag || !bdf->jacToM || !bdf->mValues) return 0;
+
+	for(i = 0; i < n; i++) {
+		int diagDone = 0;
+		bdf->mStart[i] = m;
+		for(p = rowStart[i]; p < rowStart[i + 1]; p++) {
+			size_t j = colIndex[p];
+			if(!diagDone && j >= i) {
+				bdf->mDiag[i] = m;
+				bdf->mCol[m++] = i;
+				diagDone = 1;
+				if(j == i) {
+					bdf->jacToM[p] = m - 1;
+					continue;
+				}
+			}
+			bdf->jacToM[p] = m;
+			bdf->mCol[m++] = j;
+		}
+		if(!diagDone) {
+			bdf->mDiag[i] = m;
+			bdf->mCol[m++] = i;
+		}
+	}
+	bdf->mStart[n] = m;
+
+	bdf->lu = fmi2_import_sparse_lu_create(cb, n, bdf->mStart, bdf->mCol);
+	return bdf->lu != 0;
+}
+
+jm_status_enu_t fmi2_me_bdf_create(fmi2_import_me_driver_t* drv) {
+	jm_callbacks* cb = drv->callbacks;
+	fmi2_me_bdf_t* bdf;
+	size_t nx = drv->nx, i;
+	int ok = 1;
+
+	bdf = drv->bdf = (fmi2_me_bdf_t*)cb->calloc(1, sizeof(fmi2_me_bdf_t));
+	if(!bdf) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	for(i = 0; i <= FMI2_ME_BDF_MAX_ORDER; i++)
+		ok = ok && (bdf->hist[i] = (fmi2_real_t*)cb->calloc(nx + 1, sizeof(fmi2_real_t))) != 0;
+	for(i = 0; i < FMI2_ME_BDF_MAX_ORDER + 2; i++)
+		ok = ok && (bdf->dd[i] = (fmi2_real_t*)cb->calloc(nx + 1, sizeof(fmi2_real_t))) != 0;
+	ok = ok && (bdf->psi = (fmi2_real_t*)cb->calloc(nx + 1, sizeof(fmi2_real_t))) != 0;
+	ok = ok && (bdf->delta = (fmi2_real_t*)cb->calloc(nx + 1, sizeof(fmi2_real_t))) != 0;
+	ok = ok && (bdf->f = (fmi2_real_t*)cb->calloc(nx + 1, sizeof(fmi2_real_t))) != 0;
+	if(!ok) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		fmi2_me_bdf_free(drv);
+		return jm_status_error;
+	}
+
+	if(nx > 0) {
+		bdf->jac = fmi2_import_jacobian_create(drv->fmu, drv->options.jacobian_method);
+		if(!bdf->jac || !fmi2_me_bdf_build_matrix(drv)) {
+			jm_log_error(cb, module, "Could not set up the iteration matrix for the BDF solver");
+			fmi2_me_bdf_free(drv);
+			return jm_status_error;
+		}
+		jm_log_verbose(cb, module, "BDF solver: %u non-zeros in the iteration matrix, %u in its LU factors, %u Jacobian colors",
+			(unsigned)bdf->mStart[nx], (unsigned)fmi2_import_sparse_lu_get_nnz(bdf->lu),
+			(unsigned)fmi2_import_jacobian_get_number_of_colors(bdf->jac));
+	}
+	fmi2_me_bdf_reset(drv);
+	return jm_status_success;
+}
+
+void fmi2_me_bdf_reset(fmi2_import_me_driver_t* drv) {
+	fmi2_me_bdf_t* bdf = drv->bdf;
+
+	memcpy(bdf->hist[0], drv->x, drv->nx * sizeof(fmi2_real_t));
+	bdf->thist[0] = drv->time;
+	bdf->nhist = 1;
+	bdf->order = 1;
+	bdf->stepsAtOrder = 0;
+	bdf->rejections = 0;
+	bdf->errLower = bdf->errHigher = -1;
+	bdf->haveFactorization = 0;
+	bdf->needJacobian = 1;
+	bdf->newtonRate = 1.0;
+}
+
+/* Evaluate the Jacobian at the start of the step (t, x) */
+static jm_status_enu_t fmi2_me_bdf_jacobian(fmi2_import_me_driver_t* drv, fmi2_real_t t) {
+	fmi2_me_bdf_t* bdf = drv->bdf;
+	fmi2_import_t* fmu = drv->fmu;
+
+	if(fmi2_me_driver_check(drv, fmi2_import_set_time(fmu, t), "fmi2SetTime") != jm_status_success ||
+		fmi2_me_driver_check(drv, fmi2_import_set_continuous_states(fmu, drv->x, drv->nx), "fmi2SetContinuousStates") != jm_status_success)
+		return jm_status_error;
+	if(fmi2_import_jacobian_evaluate(bdf->jac, drv->x, drv->dx) != jm_status_success) {
+		jm_log_error(drv->callbacks, module, "Jacobian evaluation failed at time %g", t);
+		return jm_status_error;
+	}
+	drv->stats.num_jacobian_evaluations++;
+	bdf->needJacobian = 0;
+	bdf->jacobianAge = 0;
+	bdf->haveFactorization = 0;
+	return jm_status_success;
+}
+
+/* Form and factor M = I - gamma*J. Returns jm_status_warning if M is singular. */
+static jm_status_enu_t fmi2_me_bdf_factor(fmi2_import_me_driver_t* drv, fmi2_real_t gamma) {
+	fmi2_me_bdf_t* bdf = drv->bdf;
+	const size_t *rowStart, *colIndex;
+	const fmi2_real_t* values;
+	size_t n = drv->nx, i, p;
+
+	fmi2_import_jacobian_get_csr(bdf->jac, &rowStart, &colIndex, &values);
+	memset(bdf->mValues, 0, bdf->mStart[n] * sizeof(double));
+	for(p = 0; p < rowStart[n]; p++) bdf->mValues[bdf->jacToM[p]] = -gamma * values[p];
+	for(i = 0; i < n; i++) bdf->mValues[bdf->mDiag[i]] += 1.0;
+
+	drv->stats.num_factorizations++;
+	bdf->haveFactorization = 0;
+	if(fmi2_import_sparse_lu_factor(bdf->lu, bdf->mValues) != jm_status_success) return jm_status_warning;
+	bdf->haveFactorization = 1;
+	bdf->gammaFactored = gamma;
+	return jm_status_success;
+}
+
+/* Modified Newton iteration for y - gamma*f(tnew, y) + psi = 0 with the predictor in xnew.
+   Returns jm_status_warning if the iteration does not converge. */
+static jm_status_enu_t fmi2_me_bdf_newton(fmi2_import_me_driver_t* drv, fmi2_real_t tnew, fmi2_real_t gamma) {
+	fmi2_me_bdf_t* bdf = drv->bdf;
+	fmi2_real_t *y = drv->xnew, *f = bdf->f, *delta = bdf->delta;
+	fmi2_real_t dnormPrev = 0, rate = bdf->newtonRate;
+	size_t nx = drv->nx, i;
+	int it;
+
+	for(it = 0; it < FMI2_ME_BDF_MAX_NEWTON; it++) {
+		fmi2_real_t dnorm, eta;
+		jm_status_enu_t st = fmi2_me_driver_eval(drv, tnew, y, f);
+
+		if(st != jm_status_success) return st;
+		for(i = 0; i < nx; i++) delta[i] = gamma * f[i] - bdf->psi[i] - y[i];
+		fmi2_import_sparse_lu_solve(bdf->lu, delta);
+		for(i = 0; i < nx; i++) y[i] += delta[i];
+		drv->stats.num_newton_iterations++;
+
+		dnorm = fmi2_me_driver_norm(drv, delta, drv->x, y);
+		if(it > 0) {
+			rate = dnorm / dnormPrev;
+			if(rate >= FMI2_ME_BDF_MAX_RATE) return jm_status_warning;
+		}
+		dnormPrev = dnorm;
+
+		eta = (rate < 1e-3 ? 1e-3 : rate);
+		eta = eta / (1.0 - (eta < FMI2_ME_BDF_MAX_RATE ? eta : FMI2_ME_BDF_MAX_RATE));
+		if(dnorm == 0 || eta * dnorm <= FMI2_ME_BDF_NEWTON_TOL) {
+			bdf->newtonRate = rate;
+			return jm_status_success;
+		}
+	}
+	return jm_status_warning;
+}
+
+/* Scaled norm of k! * h^(k+1) times the divided difference of order k+1 in dd[k+1] */
+static fmi2_real_t fmi2_me_bdf_error(fmi2_import_me_driver_t* drv, int k, fmi2_real_t h) {
+	fmi2_me_bdf_t* bdf = drv->bdf;
+	fmi2_real_t c = pow(h, k + 1);
+	size_t i;
+	int j;
+
+	for(j = 2; j <= k; j++) c *= j;
+	for(i = 0; i < drv->nx; i++) drv->xtmp[i] = c * bdf->dd[k + 1][i];
+	return fmi2_me_driver_norm(drv, drv->xtmp, drv->x, drv->xnew);
+}
+
+jm_status_enu_t fmi2_me_bdf_step(fmi2_import_me_driver_t* drv, fmi2_real_t t, fmi2_real_t tnew, fmi2_real_t* err) {
+	fmi2_me_bdf_t* bdf = drv->bdf;
+	fmi2_real_t h = tnew - t, gamma, a[FMI2_ME_BDF_MAX_ORDER + 1], s[FMI2_ME_BDF_MAX_ORDER + 2];
+	size_t nx = drv->nx, i, l;
+	int q = bdf->order, m, j, attempt;
+	jm_status_enu_t st = jm_status_success;
+
+	if(nx == 0) {
+		*err = 0;
+		return fmi2_me_driver_eval(drv, tnew, drv->xnew, drv->dxnew);
+	}
+	if((size_t)q > bdf->nhist) q = bdf->order = (int)bdf->nhist;
+
+	/* Nodes s[0] = tnew, s[j] = thist[j-1]. Coefficients of the derivative of the
+	   interpolation polynomial at tnew: p'(tnew) = a[0]*y + sum a[j]*hist[j-1]. */
+	s[0] = tnew;
+	for(j = 1; j <= q; j++) s[j] = bdf->thist[j - 1];
+	a[0] = 0;
+	for(m = 1; m <= q; m++) a[0] += 1.0 / (s[0] - s[m]);
+	for(j = 1; j <= q; j++) {
+		fmi2_real_t num = 1.0, den = s[j] - s[0];
+		for(m = 1; m <= q; m++) {
+			if(m == j) continue;
+			num *= s[0] - s[m];
+			den *= s[j] - s[m];
+		}
+		a[j] = num / den;
+	}
+	gamma = 1.0 / a[0];
+	for(i = 0; i < nx; i++) {
+		fmi2_real_t sum = 0;
+		for(j = 1; j <= q; j++) sum += a[j] * bdf->hist[j - 1][i];
+		bdf->psi[i] = gamma * sum;
+	}
+
+	/* Predictor: extrapolate the history, or an Euler step if the history is too short */
+	if(bdf->nhist > (size_t)q) {
+		memset(drv->xnew, 0, nx * sizeof(fmi2_real_t));
+		for(j = 0; j <= q; j++) {
+			fmi2_real_t w = 1.0;
+			for(m = 0; m <= q; m++) {
+				if(m != j) w *= (tnew - bdf->thist[m]) / (bdf->thist[j] - bdf->thist[m]);
+			}
+			for(i = 0; i < nx; i++) drv->xnew[i] += w * bdf->hist[j][i];
+		}
+	}
+	else {
+		for(i = 0; i < nx; i++) drv->xnew[i] = drv->x[i] + h * drv->dx[i];
+	}
+	memcpy(drv->k[0], drv->xnew, nx * sizeof(fmi2_real_t));
+
+	/* First try with the current Jacobian, then with a fresh one */
+	for(attempt = 0; attempt < 2; attempt++) {
+		if(bdf->needJacobian && fmi2_me_bdf_jacobian(drv, t) != jm_status_success) return jm_status_error;
+		st = jm_status_success;
+		if(!bdf->haveFactorization || fabs(gamma / bdf->gammaFactored - 1.0) > FMI2_ME_BDF_GAMMA_CHANGE)
+			st = fmi2_me_bdf_factor(drv, gamma);
+		if(st == jm_status_success) {
+			memcpy(drv->xnew, drv->k[0], nx * sizeof(fmi2_real_t));
+			st = fmi2_me_bdf_newton(drv, tnew, gamma);
+			if(st != jm_status_warning) break;
+		}
+		drv->stats.num_newton_failures++;
+		bdf->newtonRate = 1.0;
+		/* With a Jacobian evaluated at this point only a smaller step can help */
+		if(bdf->jacobianAge == 0) return jm_status_warning;
+		bdf->needJacobian = 1;
+	}
+	if(st != jm_status_success) return st;
+
+	/* Derivative at the new point; leaves the FMU at (tnew, y). The derivative implied by the
+	   BDF formula differs from it by the Newton error, which would spoil the finite difference
+	   Jacobian evaluated from dx and the derivatives reported by the driver. */
+	if((st = fmi2_me_driver_eval(drv, tnew, drv->xnew, drv->dxnew)) != jm_status_success) return st;
+
+	/* Divided differences over tnew and the history: dd[l] = y[s0, ..., sl] */
+	l = bdf->nhist;
+	if(l > (size_t)q + 2) l = (size_t)q + 2;
+	for(j = 1; (size_t)j <= l; j++) s[j] = bdf->thist[j - 1];
+	memcpy(bdf->dd[0], drv->xnew, nx * sizeof(fmi2_real_t));
+	for(j = 1; (size_t)j <= l; j++) memcpy(bdf->dd[j], bdf->hist[j - 1], nx * sizeof(fmi2_real_t));
+	for(m = 1; (size_t)m <= l; m++) {
+		for(j = (int)l; j >= m; j--) {
+			fmi2_real_t ds = s[j - m] - s[j];
+			for(i = 0; i < nx; i++) bdf->dd[j][i] = (bdf->dd[j - 1][i] - bdf->dd[j][i]) / ds;
+		}
+	}
+
+	if(l > (size_t)q) {
+		*err = fmi2_me_bdf_error(drv, q, h);
+	}
+	else {
+		/* q = 1 with a single history point: compare with the Euler step, the
+		   difference is h^2 times the second divided difference with a double node at t */
+		for(i = 0; i < nx; i++) drv->xtmp[i] = drv->xnew[i] - drv->x[i] - h * drv->dx[i];
+		*err = fmi2_me_driver_norm(drv, drv->xtmp, drv->x, drv->xnew);
+	}
+	bdf->errLower = (q > 1) ? fmi2_me_bdf_error(drv, q - 1, h) : -1;
+	bdf->errHigher = (q < FMI2_ME_BDF_MAX_ORDER && l >= (size_t)q + 2) ? fmi2_me_bdf_error(drv, q + 1, h) : -1;
+	return jm_status_success;
+}
+
+fmi2_real_t fmi2_me_bdf_accept(fmi2_import_me_driver_t* drv, fmi2_real_t tnew, fmi2_real_t h, fmi2_real_t err) {
+	fmi2_me_bdf_t* bdf = drv->bdf;
+	fmi2_real_t* last = bdf->hist[FMI2_ME_BDF_MAX_ORDER];
+	fmi2_real_t fac;
+	int q = bdf->order, i;
+
+	for(i = FMI2_ME_BDF_MAX_ORDER; i > 0; i--) {
+		bdf->hist[i] = bdf->hist[i - 1];
+		bdf->thist[i] = bdf->thist[i - 1];
+	}
+	bdf->hist[0] = last;
+	bdf->thist[0] = tnew;
+	memcpy(last, drv->xnew, drv->nx * sizeof(fmi2_real_t));
+	if(bdf->nhist <= FMI2_ME_BDF_MAX_ORDER) bdf->nhist++;
+
+	bdf->rejections = 0;
+	bdf->stepsAtOrder++;
+	if(++bdf->jacobianAge >= FMI2_ME_BDF_JACOBIAN_AGE) bdf->needJacobian = 1;
+
+	fac = (err > 0) ? 1.0 / (1.2 * pow(err, 1.0 / (q + 1))) : 10.0;
+	if(bdf->stepsAtOrder > (size_t)q) {
+		/* Consider the neighbouring orders, preferring the current one */
+		fmi2_real_t facLower = (bdf->errLower >= 0) ? 1.0 / (1.3 * pow(bdf->errLower + 1e-10, 1.0 / q)) : 0;
+		fmi2_real_t facHigher = (bdf->errHigher >= 0) ? 1.0 / (1.4 * pow(bdf->errHigher + 1e-10, 1.0 / (q + 2))) : 0;
+		int qnew = q;
+		if(facLower > fac) {
+			fac = facLower;
+			qnew = q - 1;
+		}
+		if(facHigher > fac) {
+			fac = facHigher;
+			qnew = q + 1;
+		}
+		if(qnew != q) {
+			bdf->order = qnew;
+			bdf->stepsAtOrder = 0;
+		}
+	}
+
+	/* Keep the step size unless the change is worth a new factorization */
+	if(fac > 2.0) fac = 2.0;
+	else if(fac >= 1.0 && fac < 1.2) fac = 1.0;
+	else if(fac < 0.5) fac = 0.5;
+	return h * fac;
+}
+
+void fmi2_me_bdf_reject(fmi2_import_me_driver_t* drv) {
+	fmi2_me_bdf_t* bdf = drv->bdf;
+
+	/* Repeated failures usually mean that the higher order history is not smooth */
+	if(++bdf->rejections >= 2 && bdf->order > 1) {
+		bdf->order--;
+		bdf->stepsAtOrder = 0;
+	}
+}
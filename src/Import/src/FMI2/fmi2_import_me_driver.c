@@ -0,0 +1,613 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+#include <math.h>
+
+#include "fmi2_import_impl.h"
+#include "fmi2_import_me_driver_impl.h"
+
+static const char* module = "FMILIB";
+
+/* Upper bound on the number of iterations when locating a state event */
+#define FMI2_ME_DRIVER_MAX_LOCATE_ITERATIONS 200
+
+static void fmi2_me_driver_swap(fmi2_real_t** a, fmi2_real_t** b) {
+	fmi2_real_t* tmp = *a;
+	*a = *b;
+	*b = tmp;
+}
+
+jm_status_enu_t fmi2_me_driver_check(fmi2_import_me_driver_t* drv, fmi2_status_t status, const char* fname) {
+	if(status == fmi2_status_ok || status == fmi2_status_warning) return jm_status_success;
+	jm_log_error(drv->callbacks, module, "%s returned status %s at time %g", fname, fmi2_status_to_string(status), drv->time);
+	return jm_status_error;
+}
+
+/* Evaluate derivatives at (t, x). Leaves the FMU at (t, x).
+   Returns jm_status_warning if the FMU discarded the evaluation. */
+jm_status_enu_t fmi2_me_driver_eval(fmi2_import_me_driver_t* drv, fmi2_real_t t, const fmi2_real_t* x, fmi2_real_t* dx) {
+	fmi2_import_t* fmu = drv->fmu;
+	fmi2_status_t status;
+
+	status = fmi2_import_set_time(fmu, t);
+	if(fmi2_me_driver_check(drv, status, "fmi2SetTime") != jm_status_success) return jm_status_error;
+	if(drv->nx == 0) return jm_status_success;
+
+	status = fmi2_import_set_continuous_states(fmu, x, drv->nx);
+	if(status == fmi2_status_discard) return jm_status_warning;
+	if(fmi2_me_driver_check(drv, status, "fmi2SetContinuousStates") != jm_status_success) return jm_status_error;
+
+	drv->stats.num_derivative_evaluations++;
+	status = fmi2_import_get_derivatives(fmu, dx, drv->nx);
+	if(status == fmi2_status_discard) return jm_status_warning;
+	return fmi2_me_driver_check(drv, status, "fmi2GetDerivatives");
+}
+
+static jm_status_enu_t fmi2_me_driver_indicators(fmi2_import_me_driver_t* drv, fmi2_real_t* z) {
+	if(drv->nz == 0) return jm_status_success;
+	drv->stats.num_event_indicator_evaluations++;
+	return fmi2_me_driver_check(drv, fmi2_import_get_event_indicators(drv->fmu, z, drv->nz), "fmi2GetEventIndicators");
+}
+
+/* Weighted RMS norm of v with the error weights built from x and xnew */
+fmi2_real_t fmi2_me_driver_norm(fmi2_import_me_driver_t* drv, const fmi2_real_t* v, const fmi2_real_t* x, const fmi2_real_t* xnew) {
+	fmi2_real_t rtol = drv->options.relative_tolerance;
+	fmi2_real_t atol = drv->options.absolute_tolerance;
+	fmi2_real_t sum = 0;
+	size_t i, nx = drv->nx;
+
+	if(nx == 0) return 0;
+	for(i = 0; i < nx; i++) {
+		fmi2_real_t ax = fabs(x[i]), sc, r;
+		if(xnew && fabs(xnew[i]) > ax) ax = fabs(xnew[i]);
+		sc = atol * fabs(drv->nominal[i]) + rtol * ax;
+		r = v[i] / sc;
+		sum += r * r;
+	}
+	return sqrt(sum / (fmi2_real_t)nx);
+}
+
+/* Explicit Euler step from (t, x) to tnew */
+static jm_status_enu_t fmi2_me_driver_euler_step(fmi2_import_me_driver_t* drv, fmi2_real_t t, fmi2_real_t tnew) {
+	fmi2_real_t h = tnew - t;
+	size_t i, nx = drv->nx;
+
+	for(i = 0; i < nx; i++) drv->xnew[i] = drv->x[i] + h * drv->dx[i];
+	return fmi2_me_driver_eval(drv, tnew, drv->xnew, drv->dxnew);
+}
+
+/* Classical Runge-Kutta step from (t, x) to tnew. k1 is the derivative at the start of the step. */
+static jm_status_enu_t fmi2_me_driver_rk4_step(fmi2_import_me_driver_t* drv, fmi2_real_t t, fmi2_real_t tnew) {
+	fmi2_real_t h = tnew - t;
+	fmi2_real_t *x = drv->x, *k1 = drv->dx, *k2 = drv->k[0], *k3 = drv->k[1], *k4 = drv->k[2], *xt = drv->xtmp;
+	size_t i, nx = drv->nx;
+	jm_status_enu_t st;
+
+	for(i = 0; i < nx; i++) xt[i] = x[i] + 0.5 * h * k1[i];
+	if((st = fmi2_me_driver_eval(drv, t + 0.5 * h, xt, k2)) != jm_status_success) return st;
+	for(i = 0; i < nx; i++) xt[i] = x[i] + 0.5 * h * k2[i];
+	if((st = fmi2_me_driver_eval(drv, t + 0.5 * h, xt, k3)) != jm_status_success) return st;
+	for(i = 0; i < nx; i++) xt[i] = x[i] + h * k3[i];
+	if((st = fmi2_me_driver_eval(drv, tnew, xt, k4)) != jm_status_success) return st;
+	for(i = 0; i < nx; i++) drv->xnew[i] = x[i] + h / 6.0 * (k1[i] + 2.0 * (k2[i] + k3[i]) + k4[i]);
+	return fmi2_me_driver_eval(drv, tnew, drv->xnew, drv->dxnew);
+}
+
+/* Dormand-Prince 5(4) step from (t, x) to tnew. Uses the FSAL property:
+   the last stage is the derivative at the end of the step and becomes k1 of the next step.
+   On success *err holds the scaled error estimate (accept if <= 1). */
+static jm_status_enu_t fmi2_me_driver_dopri5_step(fmi2_import_me_driver_t* drv, fmi2_real_t t, fmi2_real_t tnew, fmi2_real_t* err) {
+	static const fmi2_real_t
+		c2 = 1.0/5, c3 = 3.0/10, c4 = 4.0/5, c5 = 8.0/9,
+		a21 = 1.0/5,
+		a31 = 3.0/40, a32 = 9.0/40,
+		a41 = 44.0/45, a42 = -56.0/15, a43 = 32.0/9,
+		a51 = 19372.0/6561, a52 = -25360.0/2187, a53 = 64448.0/6561, a54 = -212.0/729,
+		a61 = 9017.0/3168, a62 = -355.0/33, a63 = 46732.0/5247, a64 = 49.0/176, a65 = -5103.0/18656,
+		a71 = 35.0/384, a73 = 500.0/1113, a74 = 125.0/192, a75 = -2187.0/6784, a76 = 11.0/84,
+		e1 = 71.0/57600, e3 = -71.0/16695, e4 = 71.0/1920, e5 = -17253.0/339200, e6 = 22.0/525, e7 = -1.0/40;
+	fmi2_real_t h = tnew - t;
+	fmi2_real_t *x = drv->x, *k1 = drv->dx, *k2 = drv->k[0], *k3 = drv->k[1], *k4 = drv->k[2],
+		*k5 = drv->k[3], *k6 = drv->k[4], *k7 = drv->dxnew, *xt = drv->xtmp, *xn = drv->xnew;
+	size_t i, nx = drv->nx;
+	jm_status_enu_t st;
+
+	for(i = 0; i < nx; i++) xt[i] = x[i] + h * a21 * k1[i];
+	if((st = fmi2_me_driver_eval(drv, t + c2 * h, xt, k2)) != jm_status_success) return st;
+	for(i = 0; i < nx; i++) xt[i] = x[i] + h * (a31 * k1[i] + a32 * k2[i]);
+	if((st = fmi2_me_driver_eval(drv, t + c3 * h, xt, k3)) != jm_status_success) return st;
+	for(i = 0; i < nx; i++) xt[i] = x[i] + h * (a41 * k1[i] + a42 * k2[i] + a43 * k3[i]);
+	if((st = fmi2_me_driver_eval(drv, t + c4 * h, xt, k4)) != jm_status_success) return st;
+	for(i = 0; i < nx; i++) xt[i] = x[i] + h * (a51 * k1[i] + a52 * k2[i] + a53 * k3[i] + a54 * k4[i]);
+	if((st = fmi2_me_driver_eval(drv, t + c5 * h, xt, k5)) != jm_status_success) return st;
+	for(i = 0; i < nx; i++) xt[i] = x[i] + h * (a61 * k1[i] + a62 * k2[i] + a63 * k3[i] + a64 * k4[i] + a65 * k5[i]);
+	if((st = fmi2_me_driver_eval(drv, tnew, xt, k6)) != jm_status_success) return st;
+	for(i = 0; i < nx; i++) xn[i] = x[i] + h * (a71 * k1[i] + a73 * k3[i] + a74 * k4[i] + a75 * k5[i] + a76 * k6[i]);
+	if((st = fmi2_me_driver_eval(drv, tnew, xn, k7)) != jm_status_success) return st;
+
+	for(i = 0; i < nx; i++) xt[i] = h * (e1 * k1[i] + e3 * k3[i] + e4 * k4[i] + e5 * k5[i] + e6 * k6[i] + e7 * k7[i]);
+	*err = fmi2_me_driver_norm(drv, xt, x, xn);
+	return jm_status_success;
+}
+
+/* Cubic Hermite interpolation of the states over the step [t, t+h] into xtmp */
+static void fmi2_me_driver_interpolate(fmi2_import_me_driver_t* drv, fmi2_real_t t, fmi2_real_t h, fmi2_real_t tau) {
+	fmi2_real_t th = (tau - t) / h;
+	fmi2_real_t h00 = (1 + 2 * th) * (1 - th) * (1 - th);
+	fmi2_real_t h10 = th * (1 - th) * (1 - th) * h;
+	fmi2_real_t h01 = th * th * (3 - 2 * th);
+	fmi2_real_t h11 = th * th * (th - 1) * h;
+	size_t i, nx = drv->nx;
+
+	for(i = 0; i < nx; i++)
+		drv->xtmp[i] = h00 * drv->x[i] + h10 * drv->dx[i] + h01 * drv->xnew[i] + h11 * drv->dxnew[i];
+}
+
+/* Move the FMU to the interpolated point tau of the step [t, t+h] */
+static jm_status_enu_t fmi2_me_driver_set_interpolated(fmi2_import_me_driver_t* drv, fmi2_real_t t, fmi2_real_t h, fmi2_real_t tau) {
+	fmi2_import_t* fmu = drv->fmu;
+
+	fmi2_me_driver_interpolate(drv, t, h, tau);
+	if(fmi2_me_driver_check(drv, fmi2_import_set_time(fmu, tau), "fmi2SetTime") != jm_status_success)
+		return jm_status_error;
+	if(drv->nx == 0) return jm_status_success;
+	return fmi2_me_driver_check(drv, fmi2_import_set_continuous_states(fmu, drv->xtmp, drv->nx), "fmi2SetContinuousStates");
+}
+
+#define FMI2_ME_DRIVER_CROSSED(za, zb, k) (((za)[k] > 0) != ((zb)[k] > 0))
+
+/* Among the indicators that change sign between za and zb return the one
+   with the earliest zero crossing according to linear interpolation, or nz if none. */
+static size_t fmi2_me_driver_first_crossing(fmi2_import_me_driver_t* drv, const fmi2_real_t* za, const fmi2_real_t* zb) {
+	size_t k, kmin = drv->nz;
+	fmi2_real_t fmin = 2.0;
+
+	for(k = 0; k < drv->nz; k++) {
+		if(FMI2_ME_DRIVER_CROSSED(za, zb, k)) {
+			fmi2_real_t d = za[k] - zb[k];
+			fmi2_real_t f = (d != 0) ? za[k] / d : 0;
+			if(f < fmin) {
+				fmin = f;
+				kmin = k;
+			}
+		}
+	}
+	return kmin;
+}
+
+/* Locate the earliest state event in the step [t, t+h] with the Illinois method.
+   On entry z and znew hold the indicators at the ends of the step.
+   On return the FMU, 'time', x and z are at the right end of the final bracket,
+   i.e., just after the zero crossing. */
+static jm_status_enu_t fmi2_me_driver_locate_event(fmi2_import_me_driver_t* drv, fmi2_real_t t, fmi2_real_t h) {
+	fmi2_real_t tol = drv->options.event_tolerance;
+	fmi2_real_t tl = t, tr = t + h, gl, gr;
+	fmi2_real_t *zl = drv->z, *zr = drv->znew, *zm = drv->ztmp;
+	size_t k = fmi2_me_driver_first_crossing(drv, zl, zr);
+	int side = 0, it;
+
+	gl = zl[k];
+	gr = zr[k];
+	for(it = 0; (it < FMI2_ME_DRIVER_MAX_LOCATE_ITERATIONS) && (tr - tl > tol); it++) {
+		fmi2_real_t tm;
+		size_t knew;
+
+		tm = (gr != gl) ? tr - gr * (tr - tl) / (gr - gl) : 0.5 * (tl + tr);
+		if(!(tm > tl && tm < tr)) tm = 0.5 * (tl + tr);
+		/* keep a minimum distance to the bracket ends so that it always shrinks */
+		if(tm - tl < 0.5 * tol) tm = tl + 0.5 * tol;
+		if(tr - tm < 0.5 * tol) tm = tr - 0.5 * tol;
+
+		if(fmi2_me_driver_set_interpolated(drv, t, h, tm) != jm_status_success) return jm_status_error;
+		if(fmi2_me_driver_indicators(drv, zm) != jm_status_success) return jm_status_error;
+
+		knew = fmi2_me_driver_first_crossing(drv, zl, zm);
+		if(knew < drv->nz) {
+			/* crossing in [tl, tm] */
+			tr = tm;
+			fmi2_me_driver_swap(&zr, &zm);
+			if(knew != k) {
+				k = knew;
+				gl = zl[k];
+				side = 0;
+			}
+			else if(side == -1) {
+				gl *= 0.5;
+			}
+			gr = zr[k];
+			side = -1;
+		}
+		else {
+			/* crossing in [tm, tr] */
+			tl = tm;
+			fmi2_me_driver_swap(&zl, &zm);
+			knew = fmi2_me_driver_first_crossing(drv, zl, zr);
+			if(knew != k) {
+				k = knew;
+				gr = zr[k];
+				side = 0;
+			}
+			else if(side == 1) {
+				gr *= 0.5;
+			}
+			gl = zl[k];
+			side = 1;
+		}
+	}
+
+	if(fmi2_me_driver_set_interpolated(drv, t, h, tr) != jm_status_success) return jm_status_error;
+	fmi2_me_driver_swap(&drv->x, &drv->xtmp);
+	drv->time = tr;
+
+	/* dx still holds the derivatives at the start of the step */
+	if(drv->nx > 0) {
+		drv->stats.num_derivative_evaluations++;
+		if(fmi2_me_driver_check(drv, fmi2_import_get_derivatives(drv->fmu, drv->dx, drv->nx), "fmi2GetDerivatives") != jm_status_success)
+			return jm_status_error;
+	}
+
+	/* Keep the indicators at tr in drv->z; the other two buffers are scratch */
+	drv->z = zr;
+	drv->znew = zl;
+	drv->ztmp = zm;
+	return jm_status_success;
+}
+
+/* Enter event mode, iterate fmi2NewDiscreteStates and return to continuous time mode */
+static jm_status_enu_t fmi2_me_driver_handle_event(fmi2_import_me_driver_t* drv, int enterEventMode) {
+	fmi2_import_t* fmu = drv->fmu;
+	fmi2_event_info_t* info = &drv->eventInfo;
+	fmi2_boolean_t valuesChanged = fmi2_false, nominalsChanged = fmi2_false;
+	unsigned int n = 0;
+
+	if(enterEventMode) {
+		if(fmi2_me_driver_check(drv, fmi2_import_enter_event_mode(fmu), "fmi2EnterEventMode") != jm_status_success)
+			return jm_status_error;
+	}
+
+	info->newDiscreteStatesNeeded = fmi2_true;
+	info->terminateSimulation = fmi2_false;
+	while(info->newDiscreteStatesNeeded && !info->terminateSimulation) {
+		if(n >= drv->options.max_event_iterations) {
+			jm_log_error(drv->callbacks, module, "Event iteration did not converge in %u iterations at time %g", n, drv->time);
+			return jm_status_error;
+		}
+		if(fmi2_me_driver_check(drv, fmi2_import_new_discrete_states(fmu, info), "fmi2NewDiscreteStates") != jm_status_success)
+			return jm_status_error;
+		valuesChanged |= info->valuesOfContinuousStatesChanged;
+		nominalsChanged |= info->nominalsOfContinuousStatesChanged;
+		n++;
+	}
+	drv->stats.num_event_iterations += n;
+
+	if(info->terminateSimulation) {
+		jm_log_verbose(drv->callbacks, module, "FMU requested termination at time %g", drv->time);
+		drv->terminated = 1;
+		return jm_status_success;
+	}
+	if(fmi2_me_driver_check(drv, fmi2_import_enter_continuous_time_mode(fmu), "fmi2EnterContinuousTimeMode") != jm_status_success)
+		return jm_status_error;
+
+	if(info->nextEventTimeDefined && info->nextEventTime <= drv->time) {
+		jm_log_warning(drv->callbacks, module, "Ignoring next event time %g that is not after the current time %g", info->nextEventTime, drv->time);
+		info->nextEventTimeDefined = fmi2_false;
+	}
+
+	if(drv->nx > 0) {
+		if(valuesChanged &&
+			fmi2_me_driver_check(drv, fmi2_import_get_continuous_states(fmu, drv->x, drv->nx), "fmi2GetContinuousStates") != jm_status_success)
+			return jm_status_error;
+		if(nominalsChanged &&
+			fmi2_me_driver_check(drv, fmi2_import_get_nominals_of_continuous_states(fmu, drv->nominal, drv->nx), "fmi2GetNominalsOfContinuousStates") != jm_status_success)
+			return jm_status_error;
+		drv->stats.num_derivative_evaluations++;
+		if(fmi2_me_driver_check(drv, fmi2_import_get_derivatives(fmu, drv->dx, drv->nx), "fmi2GetDerivatives") != jm_status_success)
+			return jm_status_error;
+	}
+	/* The BDF history is not valid across an event */
+	if(drv->bdf) fmi2_me_bdf_reset(drv);
+	return fmi2_me_driver_indicators(drv, drv->z);
+}
+
+static int fmi2_me_driver_report(fmi2_import_me_driver_t* drv, int isEvent) {
+	if(!drv->options.step_callback) return 0;
+	return drv->options.step_callback(drv, isEvent, drv->options.step_callback_data);
+}
+
+void fmi2_import_me_driver_default_options(fmi2_import_me_driver_options_t* options) {
+	memset(options, 0, sizeof(fmi2_import_me_driver_options_t));
+	options->solver = fmi2_import_me_solver_dopri5;
+	options->step_size = 0;
+	options->relative_tolerance = 1e-6;
+	options->absolute_tolerance = 1e-6;
+	options->min_step_size = 1e-14;
+	options->max_step_size = 0;
+	options->event_tolerance = 1e-10;
+	options->max_event_iterations = 100;
+}
+
+fmi2_import_me_driver_t* fmi2_import_me_driver_create(fmi2_import_t* fmu, const fmi2_import_me_driver_options_t* options) {
+	jm_callbacks* cb;
+	fmi2_import_me_driver_t* drv;
+	size_t nx, nz, i;
+	fmi2_real_t* p;
+
+	if(!fmu) return 0;
+	cb = fmu->callbacks;
+	if(!fmu->capi) {
+		jm_log_error(cb, module, "No FMU is loaded");
+		return 0;
+	}
+
+	drv = (fmi2_import_me_driver_t*)cb->calloc(1, sizeof(fmi2_import_me_driver_t));
+	if(!drv) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	drv->fmu = fmu;
+	drv->callbacks = cb;
+	if(options)
+		drv->options = *options;
+	else
+		fmi2_import_me_driver_default_options(&drv->options);
+
+	if(drv->options.solver != fmi2_import_me_solver_dopri5 && drv->options.solver != fmi2_import_me_solver_bdf &&
+		!(drv->options.step_size > 0)) {
+		jm_log_error(cb, module, "A positive step size is required for the fixed step solvers");
+		cb->free(drv);
+		return 0;
+	}
+	if(!(drv->options.event_tolerance > 0)) drv->options.event_tolerance = 1e-10;
+	if(drv->options.max_event_iterations == 0) drv->options.max_event_iterations = 100;
+
+	nx = drv->nx = fmi2_import_get_number_of_continuous_states(fmu);
+	nz = drv->nz = fmi2_import_get_number_of_event_indicators(fmu);
+
+	/* x, dx, xnew, dxnew, xtmp, nominal, stages + z, znew, ztmp. Allocate at least one item. */
+	drv->work = (fmi2_real_t*)cb->calloc((6 + FMI2_ME_DRIVER_NUM_STAGES) * nx + 3 * nz + 1, sizeof(fmi2_real_t));
+	if(!drv->work) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		cb->free(drv);
+		return 0;
+	}
+	p = drv->work;
+	drv->x = p; p += nx;
+	drv->dx = p; p += nx;
+	drv->xnew = p; p += nx;
+	drv->dxnew = p; p += nx;
+	drv->xtmp = p; p += nx;
+	drv->nominal = p; p += nx;
+	for(i = 0; i < FMI2_ME_DRIVER_NUM_STAGES; i++) {
+		drv->k[i] = p; p += nx;
+	}
+	drv->z = p; p += nz;
+	drv->znew = p; p += nz;
+	drv->ztmp = p;
+
+	if(drv->options.solver == fmi2_import_me_solver_bdf && fmi2_me_bdf_create(drv) != jm_status_success) {
+		fmi2_import_me_driver_free(drv);
+		return 0;
+	}
+
+	jm_log_verbose(cb, module, "Created ME driver with %u states and %u event indicators", (unsigned)nx, (unsigned)nz);
+	return drv;
+}
+
+void fmi2_import_me_driver_free(fmi2_import_me_driver_t* driver) {
+	jm_callbacks* cb;
+	if(!driver) return;
+	cb = driver->callbacks;
+	fmi2_me_bdf_free(driver);
+	cb->free(driver->work);
+	cb->free(driver);
+}
+
+jm_status_enu_t fmi2_import_me_driver_initialize(fmi2_import_me_driver_t* drv, fmi2_real_t tstart) {
+	fmi2_import_t* fmu = drv->fmu;
+	size_t i;
+
+	memset(&drv->stats, 0, sizeof(drv->stats));
+	memset(&drv->eventInfo, 0, sizeof(drv->eventInfo));
+	drv->time = tstart;
+	drv->terminated = 0;
+	drv->initialized = 0;
+
+	if(drv->nx > 0) {
+		if(fmi2_me_driver_check(drv, fmi2_import_get_nominals_of_continuous_states(fmu, drv->nominal, drv->nx), "fmi2GetNominalsOfContinuousStates") != jm_status_success)
+			return jm_status_error;
+		if(fmi2_me_driver_check(drv, fmi2_import_get_continuous_states(fmu, drv->x, drv->nx), "fmi2GetContinuousStates") != jm_status_success)
+			return jm_status_error;
+	}
+
+	/* fmi2ExitInitializationMode leaves the FMU in event mode */
+	if(fmi2_me_driver_handle_event(drv, 0) != jm_status_success) return jm_status_error;
+	for(i = 0; i < drv->nx; i++) {
+		if(drv->nominal[i] == 0) drv->nominal[i] = 1.0;
+	}
+
+	drv->h = drv->options.step_size;
+	if(drv->options.solver != fmi2_import_me_solver_euler && drv->options.solver != fmi2_import_me_solver_rk4 && !(drv->h > 0)) {
+		/* Initial step size guess from the ratio of the norms of the states and derivatives */
+		fmi2_real_t d0 = fmi2_me_driver_norm(drv, drv->x, drv->x, 0);
+		fmi2_real_t d1 = fmi2_me_driver_norm(drv, drv->dx, drv->x, 0);
+		drv->h = (d0 < 1e-5 || d1 < 1e-5) ? 1e-6 : 0.01 * d0 / d1;
+	}
+	if(drv->options.max_step_size > 0 && drv->h > drv->options.max_step_size)
+		drv->h = drv->options.max_step_size;
+
+	drv->initialized = 1;
+	if(!drv->terminated && fmi2_me_driver_report(drv, 1)) return jm_status_warning;
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_me_driver_advance(fmi2_import_me_driver_t* drv, fmi2_real_t tend) {
+	fmi2_import_t* fmu = drv->fmu;
+	fmi2_import_me_driver_options_t* opt = &drv->options;
+	int adaptive = (opt->solver == fmi2_import_me_solver_dopri5 || opt->solver == fmi2_import_me_solver_bdf);
+
+	if(!drv->initialized) {
+		jm_log_error(drv->callbacks, module, "fmi2_import_me_driver_initialize must be called before advancing the driver");
+		return jm_status_error;
+	}
+
+	while(drv->time < tend && !drv->terminated) {
+		fmi2_real_t t = drv->time, tlimit = tend, tnew, h, hproposed;
+		fmi2_boolean_t enterEventMode = fmi2_false, terminate = fmi2_false;
+		int timeEvent = 0, reached = 0, rejected = 0, stop;
+		size_t k;
+
+		if(drv->eventInfo.nextEventTimeDefined && drv->eventInfo.nextEventTime <= tend) {
+			tlimit = drv->eventInfo.nextEventTime;
+			timeEvent = 1;
+		}
+		if(timeEvent && tlimit <= t) {
+			/* A time event at the current time: handle it without taking an empty step */
+			drv->stats.num_time_events++;
+			if(fmi2_me_driver_handle_event(drv, 1) != jm_status_success) return jm_status_error;
+			if(!drv->terminated && fmi2_me_driver_report(drv, 1)) return jm_status_warning;
+			continue;
+		}
+
+		h = hproposed = drv->h;
+		if(adaptive && opt->max_step_size > 0 && h > opt->max_step_size) h = opt->max_step_size;
+
+		/* Take a step, shrinking it on rejection */
+		for(;;) {
+			jm_status_enu_t st;
+			fmi2_real_t err = 0;
+
+			reached = (tlimit - t <= h * (1 + 1e-10));
+			tnew = reached ? tlimit : t + h;
+
+			switch(opt->solver) {
+			case fmi2_import_me_solver_euler:
+				st = fmi2_me_driver_euler_step(drv, t, tnew);
+				break;
+			case fmi2_import_me_solver_rk4:
+				st = fmi2_me_driver_rk4_step(drv, t, tnew);
+				break;
+			case fmi2_import_me_solver_bdf:
+				st = fmi2_me_bdf_step(drv, t, tnew, &err);
+				break;
+			default:
+				st = fmi2_me_driver_dopri5_step(drv, t, tnew, &err);
+				break;
+			}
+			if(st == jm_status_error) return jm_status_error;
+			if(st == jm_status_warning) {
+				if(!adaptive) {
+					jm_log_error(drv->callbacks, module, "The FMU discarded the derivative evaluation at time %g", drv->time);
+					return jm_status_error;
+				}
+				err = 1e10;
+			}
+			if(!adaptive) break;
+
+			if(err <= 1.0) {
+				h = tnew - t;
+				if(drv->bdf) {
+					drv->h = fmi2_me_bdf_accept(drv, tnew, h, err);
+				}
+				else {
+					fmi2_real_t fac = (err > 0) ? 0.9 * pow(err, -0.2) : 5.0;
+					if(fac > 5.0) fac = 5.0;
+					drv->h = h * fac;
+				}
+				if(rejected && drv->h > h) drv->h = h;
+				/* do not let a step shortened to hit tlimit reduce the next step */
+				if(reached && !rejected && drv->h < hproposed) drv->h = hproposed;
+				if(!(drv->h > 0)) drv->h = hproposed;
+				if(opt->max_step_size > 0 && drv->h > opt->max_step_size) drv->h = opt->max_step_size;
+				break;
+			}
+			else {
+				/* the error of a BDF step of order q behaves like h^(q+1) */
+				fmi2_real_t expo = drv->bdf ? -1.0 / (drv->bdf->order + 1) : -0.2;
+				fmi2_real_t fac = 0.9 * pow(err, expo);
+				if(fac < 0.2) fac = 0.2;
+				if(drv->bdf) fmi2_me_bdf_reject(drv);
+				drv->stats.num_rejected_steps++;
+				rejected = 1;
+				h = (tnew - t) * fac;
+				if(h < opt->min_step_size) {
+					jm_log_error(drv->callbacks, module, "Step size %g is below the minimum step size at time %g", h, t);
+					return jm_status_error;
+				}
+			}
+		}
+		drv->stats.num_steps++;
+		h = tnew - t;
+
+		if(fmi2_me_driver_indicators(drv, drv->znew) != jm_status_success) return jm_status_error;
+
+		k = fmi2_me_driver_first_crossing(drv, drv->z, drv->znew);
+		if(k < drv->nz) {
+			if(fmi2_me_driver_locate_event(drv, t, h) != jm_status_success) return jm_status_error;
+			drv->stats.num_state_events++;
+			timeEvent = 0;
+		}
+		else {
+			drv->time = tnew;
+			fmi2_me_driver_swap(&drv->x, &drv->xnew);
+			fmi2_me_driver_swap(&drv->dx, &drv->dxnew);
+			fmi2_me_driver_swap(&drv->z, &drv->znew);
+			timeEvent = timeEvent && reached;
+		}
+
+		if(fmi2_me_driver_check(drv, fmi2_import_completed_integrator_step(fmu, fmi2_true, &enterEventMode, &terminate),
+			"fmi2CompletedIntegratorStep") != jm_status_success)
+			return jm_status_error;
+		if(terminate) {
+			jm_log_verbose(drv->callbacks, module, "FMU requested termination at time %g", drv->time);
+			drv->terminated = 1;
+			if(fmi2_me_driver_report(drv, 0)) return jm_status_warning;
+			break;
+		}
+		stop = fmi2_me_driver_report(drv, 0);
+
+		/* Handle the event even if the callback stops, so that the next advance starts after it */
+		if(k < drv->nz || timeEvent || enterEventMode) {
+			if(timeEvent)
+				drv->stats.num_time_events++;
+			else if(k >= drv->nz)
+				drv->stats.num_step_events++;
+			if(fmi2_me_driver_handle_event(drv, 1) != jm_status_success) return jm_status_error;
+			if(!drv->terminated && fmi2_me_driver_report(drv, 1)) stop = 1;
+		}
+		if(stop) return jm_status_warning;
+	}
+	return jm_status_success;
+}
+
+fmi2_real_t fmi2_import_me_driver_get_time(fmi2_import_me_driver_t* driver) {
+	return driver->time;
+}
+
+const fmi2_real_t* fmi2_import_me_driver_get_states(fmi2_import_me_driver_t* driver) {
+	return driver->x;
+}
+
+const fmi2_real_t* fmi2_import_me_driver_get_derivatives(fmi2_import_me_driver_t* driver) {
+	return driver->dx;
+}
+
+int fmi2_import_me_driver_is_terminated(fmi2_import_me_driver_t* driver) {
+	return driver->terminated;
+}
+
+const fmi2_import_me_driver_statistics_t* fmi2_import_me_driver_get_statistics(fmi2_import_me_driver_t* driver) {
+	return &driver->stats;
+}
@@ -0,0 +1,133 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_me_driver_impl.h
+*  \brief Internal data structures of the ME integration driver shared with the solver implementations.
+*/
+
+#ifndef FMI2_IMPORT_ME_DRIVER_IMPL_H_
+#define FMI2_IMPORT_ME_DRIVER_IMPL_H_
+
+#include <FMI2/fmi2_import_me_driver.h>
+#include <FMI2/fmi2_import_jacobian.h>
+#include "fmi2_import_sparse_lu.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Number of intermediate stage arrays needed by the largest method (dopri5: k2..k6) */
+#define FMI2_ME_DRIVER_NUM_STAGES 5
+
+/* Maximum order of the BDF solver */
+#define FMI2_ME_BDF_MAX_ORDER 5
+
+/* State of the BDF solver */
+typedef struct fmi2_me_bdf_t {
+	fmi2_import_jacobian_t* jac;
+	fmi2_import_sparse_lu_t* lu;
+
+	/* Iteration matrix M = I - gamma*J in CSR format: the pattern of J plus the diagonal.
+	   jacToM maps the entries of the Jacobian CSR arrays into mValues. */
+	size_t* mStart;
+	size_t* mCol;
+	size_t* mDiag;
+	size_t* jacToM;
+	double* mValues;
+
+	/* Past solution points, hist[0] is the current point (time, x) */
+	fmi2_real_t* hist[FMI2_ME_BDF_MAX_ORDER + 1];
+	fmi2_real_t thist[FMI2_ME_BDF_MAX_ORDER + 1];
+	size_t nhist;
+
+	/* Divided difference table used for the error estimates */
+	fmi2_real_t* dd[FMI2_ME_BDF_MAX_ORDER + 2];
+
+	fmi2_real_t* psi;   /* history part of the BDF formula scaled by gamma */
+	fmi2_real_t* delta; /* Newton correction */
+	fmi2_real_t* f;     /* derivatives at the Newton iterate */
+
+	int order;
+	size_t stepsAtOrder;
+	int rejections;     /* consecutive rejected steps */
+
+	/* Error estimates of the last step at order-1 and order+1 (negative if not available) */
+	fmi2_real_t errLower;
+	fmi2_real_t errHigher;
+
+	fmi2_real_t gammaFactored; /* gamma of the current factorization */
+	int haveFactorization;
+	int needJacobian;
+	size_t jacobianAge;        /* accepted steps since the last Jacobian evaluation */
+	fmi2_real_t newtonRate;    /* convergence rate estimate carried over between steps */
+} fmi2_me_bdf_t;
+
+struct fmi2_import_me_driver_t {
+	fmi2_import_t* fmu;
+	jm_callbacks* callbacks;
+	fmi2_import_me_driver_options_t options;
+	fmi2_import_me_driver_statistics_t stats;
+
+	size_t nx;
+	size_t nz;
+
+	fmi2_real_t time;
+	fmi2_real_t h;  /* next step size proposed by the step size controller */
+	int initialized;
+	int terminated;
+	fmi2_event_info_t eventInfo;
+
+	/* Work arrays. All of them point into 'work'. */
+	fmi2_real_t* x;       /* states at 'time' */
+	fmi2_real_t* dx;      /* derivatives at 'time' */
+	fmi2_real_t* xnew;    /* states at the end of the current step */
+	fmi2_real_t* dxnew;   /* derivatives at the end of the current step */
+	fmi2_real_t* xtmp;    /* stage arguments, interpolated states, error estimate */
+	fmi2_real_t* nominal; /* state nominals used to scale the absolute tolerance */
+	fmi2_real_t* k[FMI2_ME_DRIVER_NUM_STAGES];
+	fmi2_real_t* z;       /* event indicators at 'time' */
+	fmi2_real_t* znew;    /* event indicators at the end of the current step */
+	fmi2_real_t* ztmp;    /* event indicators at trial points during event location */
+	fmi2_real_t* work;
+
+	fmi2_me_bdf_t* bdf;   /* only allocated for the BDF solver */
+};
+
+/* Helpers implemented in fmi2_import_me_driver.c */
+jm_status_enu_t fmi2_me_driver_check(fmi2_import_me_driver_t* drv, fmi2_status_t status, const char* fname);
+jm_status_enu_t fmi2_me_driver_eval(fmi2_import_me_driver_t* drv, fmi2_real_t t, const fmi2_real_t* x, fmi2_real_t* dx);
+fmi2_real_t fmi2_me_driver_norm(fmi2_import_me_driver_t* drv, const fmi2_real_t* v, const fmi2_real_t* x, const fmi2_real_t* xnew);
+
+/* BDF solver, implemented in fmi2_import_me_bdf.c */
+jm_status_enu_t fmi2_me_bdf_create(fmi2_import_me_driver_t* drv);
+void fmi2_me_bdf_free(fmi2_import_me_driver_t* drv);
+
+/* Restart from the current point (time, x, dx) at order 1, e.g., after an event */
+void fmi2_me_bdf_reset(fmi2_import_me_driver_t* drv);
+
+/* Step from (t, x) to tnew. On success xnew, dxnew and *err are set and the FMU is at (tnew, xnew).
+   Returns jm_status_warning if the Newton iteration failed; the step must then be retried with a smaller step. */
+jm_status_enu_t fmi2_me_bdf_step(fmi2_import_me_driver_t* drv, fmi2_real_t t, fmi2_real_t tnew, fmi2_real_t* err);
+
+/* Record an accepted step to tnew (solution in xnew) and return the proposed next step size */
+fmi2_real_t fmi2_me_bdf_accept(fmi2_import_me_driver_t* drv, fmi2_real_t tnew, fmi2_real_t h, fmi2_real_t err);
+
+/* Record a rejected step */
+void fmi2_me_bdf_reject(fmi2_import_me_driver_t* drv);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_ME_DRIVER_IMPL_H_ */
@@ -0,0 +1,452 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <zlib.h>
+
+#include <JM/jm_thread.h>
+#include <FMI2/fmi2_import_result_writer.h>
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+/* Buffer size of the result file stream */
+#define FMI2_RESULT_FILE_BUFFER_SIZE (1024*1024)
+
+/* Keeps the column blocks within the 32-bit sizes of the file format */
+#define FMI2_RESULT_MAX_ROWS_PER_CHUNK (1024*1024)
+
+typedef struct fmi2_result_chunk_t {
+	char* data;   /* time column followed by the value columns */
+	size_t rows;
+} fmi2_result_chunk_t;
+
+/* A variable to be sorted into the columns */
+typedef struct fmi2_result_entry_t {
+	fmi2_base_type_enu_t type;
+	fmi2_value_reference_t vr;
+	size_t index;
+} fmi2_result_entry_t;
+
+struct fmi2_import_result_writer_t {
+	fmi2_import_t* fmu;
+	jm_callbacks* callbacks;
+	fmi2_import_result_writer_options_t options;
+	FILE* file;
+	char* fileBuffer;
+
+	/* Columns are ordered real, integer, boolean so that a row is read with one call per type */
+	size_t numColumns, numReal, numInteger, numBoolean;
+	fmi2_value_reference_t* vrs;
+	fmi2_real_t* realRow;
+	fmi2_integer_t* integerRow;
+	fmi2_boolean_t* booleanRow;
+	size_t* columnOffset;    /* offsets of the time column (0) and the value columns in a chunk */
+	size_t* columnElemSize;
+	size_t numRows;
+
+	fmi2_result_chunk_t* chunks;
+	fmi2_result_chunk_t* current;
+	Bytef* zbuf;
+	uLongf zbufSize;
+
+	/* The I/O thread writes the chunks 'written' to 'submitted'-1 (modulo num_buffers) */
+	jm_thread_t thread;
+	jm_mutex_t lock;
+	jm_cond_t changed;
+	size_t submitted;
+	size_t written;
+	int stop;
+	int error;
+};
+
+void fmi2_import_result_writer_default_options(fmi2_import_result_writer_options_t* options) {
+	options->rows_per_chunk = 4096;
+	options->num_buffers = 4;
+	options->compression_level = 0;
+}
+
+static int fmi2_result_compare_entries(const void* a, const void* b) {
+	const fmi2_result_entry_t* ea = (const fmi2_result_entry_t*)a;
+	const fmi2_result_entry_t* eb = (const fmi2_result_entry_t*)b;
+	if(ea->type != eb->type) return (ea->type < eb->type) ? -1 : 1;
+	if(ea->vr != eb->vr) return (ea->vr < eb->vr) ? -1 : 1;
+	return (ea->index < eb->index) ? -1 : (ea->index > eb->index);
+}
+
+static void fmi2_result_put_u32(unsigned char* buf, size_t value) {
+	buf[0] = (unsigned char)(value & 0xFF);
+	buf[1] = (unsigned char)((value >> 8) & 0xFF);
+	buf[2] = (unsigned char)((value >> 16) & 0xFF);
+	buf[3] = (unsigned char)((value >> 24) & 0xFF);
+}
+
+static int fmi2_result_write_u32(FILE* file, size_t value) {
+	unsigned char buf[4];
+	fmi2_result_put_u32(buf, value);
+	return fwrite(buf, 1, 4, file) == 4;
+}
+
+static int fmi2_result_write_string(FILE* file, const char* str) {
+	size_t len = str ? strlen(str) : 0;
+	return fmi2_result_write_u32(file, len) && (len == 0 || fwrite(str, 1, len, file) == len);
+}
+
+static int fmi2_result_is_little_endian(void) {
+	unsigned int one = 1;
+	return *(unsigned char*)&one == 1;
+}
+
+static int fmi2_result_write_chunk(fmi2_import_result_writer_t* writer, fmi2_result_chunk_t* chunk) {
+	FILE* file = writer->file;
+	size_t c;
+
+	if(fwrite("CHNK", 1, 4, file) != 4 || !fmi2_result_write_u32(file, chunk->rows))
+		return 0;
+	for(c = 0; c <= writer->numColumns; c++) {
+		const char* data = chunk->data + writer->columnOffset[c];
+		size_t size = chunk->rows * writer->columnElemSize[c];
+		size_t stored = size;
+
+		if(writer->options.compression_level > 0) {
+			uLongf zlen = writer->zbufSize;
+			if(compress2(writer->zbuf, &zlen, (const Bytef*)data, (uLong)size, writer->options.compression_level) == Z_OK && zlen < size) {
+				data = (const char*)writer->zbuf;
+				stored = (size_t)zlen;
+			}
+		}
+		if(!fmi2_result_write_u32(file, size) || !fmi2_result_write_u32(file, stored) || fwrite(data, 1, stored, file) != stored)
+			return 0;
+	}
+	return 1;
+}
+
+static void fmi2_result_io_thread(void* arg) {
+	fmi2_import_result_writer_t* writer = (fmi2_import_result_writer_t*)arg;
+	fmi2_result_chunk_t* chunk;
+	int ok;
+
+	jm_mutex_lock(&writer->lock);
+	for(;;) {
+		while(writer->written == writer->submitted && !writer->stop)
+			jm_cond_wait(&writer->changed, &writer->lock);
+		if(writer->written == writer->submitted) break;
+		chunk = &writer->chunks[writer->written % writer->options.num_buffers];
+		jm_mutex_unlock(&writer->lock);
+
+		ok = writer->error ? 0 : fmi2_result_write_chunk(writer, chunk);
+
+		jm_mutex_lock(&writer->lock);
+		if(!ok) writer->error = 1;
+		writer->written++;
+		jm_cond_broadcast(&writer->changed);
+	}
+	jm_mutex_unlock(&writer->lock);
+}
+
+static void fmi2_result_writer_destroy(fmi2_import_result_writer_t* writer) {
+	jm_callbacks* cb = writer->callbacks;
+	size_t i;
+
+	if(writer->chunks) {
+		for(i = 0; i < writer->options.num_buffers; i++) cb->free(writer->chunks[i].data);
+		cb->free(writer->chunks);
+	}
+	cb->free(writer->vrs);
+	cb->free(writer->realRow);
+	cb->free(writer->integerRow);
+	cb->free(writer->booleanRow);
+	cb->free(writer->columnOffset);
+	cb->free(writer->columnElemSize);
+	cb->free(writer->zbuf);
+	cb->free(writer->fileBuffer);
+	cb->free(writer);
+}
+
+static int fmi2_result_write_header(fmi2_import_result_writer_t* writer, fmi2_import_variable_list_t* vl, size_t* varColumn) {
+	FILE* file = writer->file;
+	size_t c, i, n = fmi2_import_get_variable_list_size(vl);
+	size_t numVars = 0;
+
+	for(i = 0; i < n; i++) {
+		if(varColumn[i] != (size_t)-1) numVars++;
+	}
+	if(fwrite("FMIRES01", 1, 8, file) != 8 ||
+		!fmi2_result_write_u32(file, 1) ||
+		!fmi2_result_write_u32(file, fmi2_result_is_little_endian()) ||
+		!fmi2_result_write_u32(file, writer->numColumns) ||
+		!fmi2_result_write_u32(file, numVars) ||
+		!fmi2_result_write_u32(file, writer->options.rows_per_chunk))
+		return 0;
+	for(c = 0; c < writer->numColumns; c++) {
+		fmi2_base_type_enu_t type = (c < writer->numReal) ? fmi2_base_type_real :
+			(c < writer->numReal + writer->numInteger) ? fmi2_base_type_int : fmi2_base_type_bool;
+		if(!fmi2_result_write_u32(file, type) || !fmi2_result_write_u32(file, writer->vrs[c]))
+			return 0;
+	}
+	for(i = 0; i < n; i++) {
+		fmi2_import_variable_t* v = fmi2_import_get_variable(vl, i);
+		const char* unitName = 0;
+		if(varColumn[i] == (size_t)-1) continue;
+		if(fmi2_import_get_variable_base_type(v) == fmi2_base_type_real) {
+			fmi2_import_unit_t* unit = fmi2_import_get_real_variable_unit(fmi2_import_get_variable_as_real(v));
+			if(unit) unitName = fmi2_import_get_unit_name(unit);
+		}
+		if(!fmi2_result_write_u32(file, varColumn[i]) ||
+			!fmi2_result_write_string(file, fmi2_import_get_variable_name(v)) ||
+			!fmi2_result_write_string(file, unitName) ||
+			!fmi2_result_write_string(file, fmi2_import_get_variable_description(v)))
+			return 0;
+	}
+	return 1;
+}
+
+fmi2_import_result_writer_t* fmi2_import_result_writer_create(fmi2_import_t* fmu, fmi2_import_variable_list_t* vl,
+	const char* fileName, const fmi2_import_result_writer_options_t* options) {
+	jm_callbacks* cb = fmu->callbacks;
+	fmi2_import_result_writer_t* writer;
+	fmi2_result_entry_t* entries;
+	size_t* varColumn;
+	size_t n = fmi2_import_get_variable_list_size(vl);
+	size_t i, c, numEntries = 0, chunkSize, maxColumnSize;
+	int ok;
+
+	writer = (fmi2_import_result_writer_t*)cb->calloc(1, sizeof(fmi2_import_result_writer_t));
+	entries = (fmi2_result_entry_t*)cb->malloc((n ? n : 1) * sizeof(fmi2_result_entry_t));
+	varColumn = (size_t*)cb->malloc((n ? n : 1) * sizeof(size_t));
+	if(!writer || !entries || !varColumn) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		cb->free(writer); cb->free(entries); cb->free(varColumn);
+		return 0;
+	}
+	writer->fmu = fmu;
+	writer->callbacks = cb;
+	if(options)
+		writer->options = *options;
+	else
+		fmi2_import_result_writer_default_options(&writer->options);
+	if(writer->options.num_buffers < 2) writer->options.num_buffers = 2;
+	if(writer->options.rows_per_chunk == 0) writer->options.rows_per_chunk = 1;
+	if(writer->options.rows_per_chunk > FMI2_RESULT_MAX_ROWS_PER_CHUNK) writer->options.rows_per_chunk = FMI2_RESULT_MAX_ROWS_PER_CHUNK;
+	if(writer->options.compression_level < 0) writer->options.compression_level = 0;
+	if(writer->options.compression_level > Z_BEST_COMPRESSION) writer->options.compression_level = Z_BEST_COMPRESSION;
+
+	/* Sort the variables by type and value reference; aliases end up next to each other */
+	for(i = 0; i < n; i++) {
+		fmi2_import_variable_t* v = fmi2_import_get_variable(vl, i);
+		fmi2_base_type_enu_t type = fmi2_import_get_variable_base_type(v);
+		varColumn[i] = (size_t)-1;
+		if(type == fmi2_base_type_str) {
+			jm_log_warning(cb, module, "String variable %s is not recorded", fmi2_import_get_variable_name(v));
+			continue;
+		}
+		entries[numEntries].type = (type == fmi2_base_type_enum) ? fmi2_base_type_int : type;
+		entries[numEntries].vr = fmi2_import_get_variable_vr(v);
+		entries[numEntries].index = i;
+		numEntries++;
+	}
+	qsort(entries, numEntries, sizeof(fmi2_result_entry_t), fmi2_result_compare_entries);
+
+	writer->vrs = (fmi2_value_reference_t*)cb->malloc((numEntries ? numEntries : 1) * sizeof(fmi2_value_reference_t));
+	ok = (writer->vrs != 0);
+	for(i = 0; ok && i < numEntries; i++) {
+		if(i == 0 || entries[i].type != entries[i-1].type || entries[i].vr != entries[i-1].vr) {
+			c = writer->numColumns++;
+			writer->vrs[c] = entries[i].vr;
+			if(entries[i].type == fmi2_base_type_real) writer->numReal++;
+			else if(entries[i].type == fmi2_base_type_int) writer->numInteger++;
+			else writer->numBoolean++;
+		}
+		varColumn[entries[i].index] = writer->numColumns - 1;
+	}
+	cb->free(entries);
+
+	/* Chunk layout */
+	if(ok) {
+		writer->columnOffset = (size_t*)cb->malloc((writer->numColumns + 1) * sizeof(size_t));
+		writer->columnElemSize = (size_t*)cb->malloc((writer->numColumns + 1) * sizeof(size_t));
+		writer->realRow = (fmi2_real_t*)cb->malloc((writer->numReal + 1) * sizeof(fmi2_real_t));
+		writer->integerRow = (fmi2_integer_t*)cb->malloc((writer->numInteger + 1) * sizeof(fmi2_integer_t));
+		writer->booleanRow = (fmi2_boolean_t*)cb->malloc((writer->numBoolean + 1) * sizeof(fmi2_boolean_t));
+		ok = writer->columnOffset && writer->columnElemSize && writer->realRow && writer->integerRow && writer->booleanRow;
+	}
+	if(ok) {
+		chunkSize = 0;
+		maxColumnSize = 0;
+		for(c = 0; c <= writer->numColumns; c++) {
+			if(c == 0 || c <= writer->numReal)
+				writer->columnElemSize[c] = sizeof(fmi2_real_t);
+			else if(c <= writer->numReal + writer->numInteger)
+				writer->columnElemSize[c] = sizeof(fmi2_integer_t);
+			else
+				writer->columnElemSize[c] = sizeof(fmi2_boolean_t);
+			writer->columnOffset[c] = chunkSize;
+			chunkSize += writer->options.rows_per_chunk * writer->columnElemSize[c];
+			if(writer->columnElemSize[c] > maxColumnSize) maxColumnSize = writer->columnElemSize[c];
+		}
+		writer->chunks = (fmi2_result_chunk_t*)cb->calloc(writer->options.num_buffers, sizeof(fmi2_result_chunk_t));
+		ok = (writer->chunks != 0);
+		for(i = 0; ok && i < writer->options.num_buffers; i++) {
+			writer->chunks[i].data = (char*)cb->malloc(chunkSize);
+			ok = (writer->chunks[i].data != 0);
+		}
+		if(ok && writer->options.compression_level > 0) {
+			writer->zbufSize = compressBound((uLong)(writer->options.rows_per_chunk * maxColumnSize));
+			writer->zbuf = (Bytef*)cb->malloc(writer->zbufSize);
+			ok = (writer->zbuf != 0);
+		}
+		if(ok) {
+			writer->fileBuffer = (char*)cb->malloc(FMI2_RESULT_FILE_BUFFER_SIZE);
+			ok = (writer->fileBuffer != 0);
+		}
+	}
+	if(!ok) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		cb->free(varColumn);
+		fmi2_result_writer_destroy(writer);
+		return 0;
+	}
+
+	writer->file = fopen(fileName, "wb");
+	if(!writer->file) {
+		jm_log_error(cb, module, "Could not open result file %s for writing", fileName);
+		cb->free(varColumn);
+		fmi2_result_writer_destroy(writer);
+		return 0;
+	}
+	setvbuf(writer->file, writer->fileBuffer, _IOFBF, FMI2_RESULT_FILE_BUFFER_SIZE);
+	ok = fmi2_result_write_header(writer, vl, varColumn);
+	cb->free(varColumn);
+	if(!ok) {
+		jm_log_error(cb, module, "Could not write to result file %s", fileName);
+		fclose(writer->file);
+		fmi2_result_writer_destroy(writer);
+		return 0;
+	}
+
+	writer->current = &writer->chunks[0];
+	if(jm_mutex_init(&writer->lock) != jm_status_success) {
+		fclose(writer->file);
+		fmi2_result_writer_destroy(writer);
+		return 0;
+	}
+	if(jm_cond_init(&writer->changed) != jm_status_success) {
+		jm_mutex_destroy(&writer->lock);
+		fclose(writer->file);
+		fmi2_result_writer_destroy(writer);
+		return 0;
+	}
+	if(jm_thread_create(&writer->thread, fmi2_result_io_thread, writer) != jm_status_success) {
+		jm_log_error(cb, module, "Could not start the result writer thread");
+		jm_cond_destroy(&writer->changed);
+		jm_mutex_destroy(&writer->lock);
+		fclose(writer->file);
+		fmi2_result_writer_destroy(writer);
+		return 0;
+	}
+	jm_log_verbose(cb, module, "Recording %u columns to %s", (unsigned)writer->numColumns, fileName);
+	return writer;
+}
+
+/* Hand the current chunk to the I/O thread and wait for a free buffer */
+static jm_status_enu_t fmi2_result_submit(fmi2_import_result_writer_t* writer) {
+	int error;
+
+	jm_mutex_lock(&writer->lock);
+	writer->submitted++;
+	jm_cond_broadcast(&writer->changed);
+	while(writer->submitted - writer->written >= writer->options.num_buffers)
+		jm_cond_wait(&writer->changed, &writer->lock);
+	error = writer->error;
+	jm_mutex_unlock(&writer->lock);
+
+	writer->current = &writer->chunks[writer->submitted % writer->options.num_buffers];
+	writer->current->rows = 0;
+	if(error) {
+		jm_log_error(writer->callbacks, module, "Could not write to the result file");
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_result_writer_record(fmi2_import_result_writer_t* writer, fmi2_real_t time) {
+	fmi2_result_chunk_t* chunk = writer->current;
+	const fmi2_value_reference_t* vrs = writer->vrs;
+	size_t row = chunk->rows, c, i;
+	fmi2_status_t status = fmi2_status_ok;
+
+	if(writer->numReal)
+		status = fmi2_import_get_real(writer->fmu, vrs, writer->numReal, writer->realRow);
+	if(writer->numInteger && (status == fmi2_status_ok || status == fmi2_status_warning))
+		status = fmi2_import_get_integer(writer->fmu, vrs + writer->numReal, writer->numInteger, writer->integerRow);
+	if(writer->numBoolean && (status == fmi2_status_ok || status == fmi2_status_warning))
+		status = fmi2_import_get_boolean(writer->fmu, vrs + writer->numReal + writer->numInteger, writer->numBoolean, writer->booleanRow);
+	if(status != fmi2_status_ok && status != fmi2_status_warning) {
+		jm_log_error(writer->callbacks, module, "Could not get the values to record at time %g", time);
+		return jm_status_error;
+	}
+
+	((fmi2_real_t*)chunk->data)[row] = time;
+	c = 1;
+	for(i = 0; i < writer->numReal; i++, c++)
+		((fmi2_real_t*)(chunk->data + writer->columnOffset[c]))[row] = writer->realRow[i];
+	for(i = 0; i < writer->numInteger; i++, c++)
+		((fmi2_integer_t*)(chunk->data + writer->columnOffset[c]))[row] = writer->integerRow[i];
+	for(i = 0; i < writer->numBoolean; i++, c++)
+		((fmi2_boolean_t*)(chunk->data + writer->columnOffset[c]))[row] = writer->booleanRow[i];
+	chunk->rows++;
+	writer->numRows++;
+
+	if(chunk->rows == writer->options.rows_per_chunk)
+		return fmi2_result_submit(writer);
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_result_writer_close(fmi2_import_result_writer_t* writer) {
+	jm_callbacks* cb;
+	int error = 0;
+
+	if(!writer) return jm_status_success;
+	cb = writer->callbacks;
+	if(writer->current->rows > 0 && fmi2_result_submit(writer) != jm_status_success) error = 1;
+
+	jm_mutex_lock(&writer->lock);
+	writer->stop = 1;
+	jm_cond_broadcast(&writer->changed);
+	jm_mutex_unlock(&writer->lock);
+	jm_thread_join(&writer->thread);
+
+	if(writer->error) error = 1;
+	if(fclose(writer->file) != 0) error = 1;
+	jm_cond_destroy(&writer->changed);
+	jm_mutex_destroy(&writer->lock);
+	fmi2_result_writer_destroy(writer);
+	if(error) {
+		jm_log_error(cb, module, "Writing the result file failed");
+		return jm_status_error;
+	}
+	return jm_status_success;
+}
+
+size_t fmi2_import_result_writer_get_number_of_columns(fmi2_import_result_writer_t* writer) {
+	return writer->numColumns;
+}
+
+size_t fmi2_import_result_writer_get_number_of_rows(fmi2_import_result_writer_t* writer) {
+	return writer->numRows;
+}
@@ -0,0 +1,475 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+
+#include <FMI2/fmi2_import_selection.h>
+#include "fmi2_import_impl.h"
+#include "fmi2_import_variable_list_impl.h"
+
+static const char* module = "FMILIB";
+
+/* The words are size_t so that the set operations are plain loops the compiler can vectorize */
+#define FMI2_SELECTION_WORD_BITS (sizeof(size_t) * 8)
+#define FMI2_SELECTION_NUM_WORDS(n) (((n) + FMI2_SELECTION_WORD_BITS - 1) / FMI2_SELECTION_WORD_BITS)
+
+#define FMI2_NUM_CAUSALITIES ((size_t)fmi2_causality_enu_unknown)
+#define FMI2_NUM_VARIABILITIES ((size_t)fmi2_variability_enu_unknown)
+#define FMI2_NUM_INITIALS ((size_t)fmi2_initial_enu_unknown)
+#define FMI2_NUM_BASE_TYPES ((size_t)fmi2_base_type_enum + 1)
+#define FMI2_NUM_ALIAS_KINDS ((size_t)fmi2_variable_is_alias + 1)
+#define FMI2_NUM_ROLES ((size_t)fmi2_import_variable_role_initial_unknown + 1)
+
+/* Offsets of the groups of masks */
+#define FMI2_MASK_CAUSALITY 0
+#define FMI2_MASK_VARIABILITY (FMI2_MASK_CAUSALITY + FMI2_NUM_CAUSALITIES)
+#define FMI2_MASK_INITIAL (FMI2_MASK_VARIABILITY + FMI2_NUM_VARIABILITIES)
+#define FMI2_MASK_BASE_TYPE (FMI2_MASK_INITIAL + FMI2_NUM_INITIALS)
+#define FMI2_MASK_ALIAS_KIND (FMI2_MASK_BASE_TYPE + FMI2_NUM_BASE_TYPES)
+#define FMI2_MASK_HAS_START (FMI2_MASK_ALIAS_KIND + FMI2_NUM_ALIAS_KINDS)
+#define FMI2_MASK_ROLE (FMI2_MASK_HAS_START + 1)
+#define FMI2_NUM_MASKS (FMI2_MASK_ROLE + FMI2_NUM_ROLES)
+
+struct fmi2_import_selection_t {
+	fmi2_import_t* fmu;
+	size_t numBits;
+	size_t numWords;
+	size_t* words;
+};
+
+/* The predefined masks of an FMU, all the words are in one block */
+struct fmi2_import_selection_masks_t {
+	fmi2_import_selection_t mask[FMI2_NUM_MASKS];
+	size_t* words;
+};
+
+static size_t fmi2_import_selection_popcount(size_t w) {
+#if defined(__GNUC__)
+	if(sizeof(size_t) > sizeof(unsigned long))
+		return (size_t)__builtin_popcountll(w);
+	return (size_t)__builtin_popcountl((unsigned long)w);
+#else
+	size_t c = 0;
+	while(w) {
+		w &= w - 1;
+		c++;
+	}
+	return c;
+#endif
+}
+
+/* Index of the lowest set bit of a non-zero word */
+static size_t fmi2_import_selection_lowest_bit(size_t w) {
+#if defined(__GNUC__)
+	if(sizeof(size_t) > sizeof(unsigned long))
+		return (size_t)__builtin_ctzll(w);
+	return (size_t)__builtin_ctzl((unsigned long)w);
+#else
+	size_t b = 0;
+	while(!(w & 1)) {
+		w >>= 1;
+		b++;
+	}
+	return b;
+#endif
+}
+
+static jm_vector(jm_voidp)* fmi2_import_selection_variables(fmi2_import_t* fmu) {
+	return fmi2_xml_get_variables_original_order(fmu->md);
+}
+
+/* Bit of a variable, i.e., its position in the original order, or the number of variables if it is not found */
+static size_t fmi2_import_selection_bit(fmi2_import_t* fmu, fmi2_import_variable_t* v) {
+	return fmi2_xml_get_variable_position(fmu->md, (fmi2_xml_variable_t*)v);
+}
+
+static void fmi2_import_selection_set_bit(fmi2_import_selection_t* s, size_t bit) {
+	s->words[bit / FMI2_SELECTION_WORD_BITS] |= (size_t)1 << (bit % FMI2_SELECTION_WORD_BITS);
+}
+
+static void fmi2_import_selection_set_list(fmi2_import_t* fmu, fmi2_import_selection_t* s, fmi2_import_variable_list_t* vl, int states) {
+	size_t k, n = fmi2_import_get_variable_list_size(vl);
+	for(k = 0; k < n; k++) {
+		fmi2_import_variable_t* v = fmi2_import_get_variable(vl, k);
+		size_t bit;
+		if(states) {
+			fmi2_import_real_variable_t* rv = fmi2_import_get_variable_as_real(v);
+			v = rv ? (fmi2_import_variable_t*)fmi2_import_get_real_variable_derivative_of(rv) : 0;
+			if(!v) continue;
+		}
+		bit = fmi2_import_selection_bit(fmu, v);
+		if(bit < s->numBits) fmi2_import_selection_set_bit(s, bit);
+	}
+}
+
+jm_status_enu_t fmi2_import_build_selection_masks(fmi2_import_t* fmu) {
+	jm_vector(jm_voidp)* vars = fmi2_import_selection_variables(fmu);
+	size_t n = vars ? jm_vector_get_size(jm_voidp)(vars) : 0;
+	size_t numWords = FMI2_SELECTION_NUM_WORDS(n), k;
+	fmi2_import_selection_masks_t* masks;
+	fmi2_import_selection_t* mask;
+	fmi2_import_variable_list_t* vl;
+	jm_memory_scope_t scope;
+
+	fmi2_import_free_selection_masks(fmu);
+	jm_memory_scope_enter(&scope, fmu->memory, jm_memory_subsystem_variable_list);
+	masks = (fmi2_import_selection_masks_t*)fmu->callbacks->calloc(1, sizeof(fmi2_import_selection_masks_t));
+	if(masks && numWords) {
+		masks->words = (size_t*)fmu->callbacks->calloc(FMI2_NUM_MASKS * numWords, sizeof(size_t));
+	}
+	jm_memory_scope_leave(&scope);
+	if(!masks || (numWords && !masks->words)) {
+		if(masks) fmu->callbacks->free(masks);
+		jm_log_fatal(fmu->callbacks, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+
+	mask = masks->mask;
+	for(k = 0; k < FMI2_NUM_MASKS; k++) {
+		mask[k].fmu = fmu;
+		mask[k].numBits = n;
+		mask[k].numWords = numWords;
+		mask[k].words = masks->words + k * numWords;
+	}
+
+	for(k = 0; k < n; k++) {
+		fmi2_import_variable_t* v = (fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(vars, k);
+		size_t c = (size_t)fmi2_import_get_causality(v);
+		size_t var = (size_t)fmi2_import_get_variability(v);
+		size_t init = (size_t)fmi2_import_get_initial(v);
+		size_t bt = (size_t)fmi2_import_get_variable_base_type(v);
+		size_t ak = (size_t)fmi2_import_get_variable_alias_kind(v);
+
+		if(c < FMI2_NUM_CAUSALITIES) fmi2_import_selection_set_bit(&mask[FMI2_MASK_CAUSALITY + c], k);
+		if(var < FMI2_NUM_VARIABILITIES) fmi2_import_selection_set_bit(&mask[FMI2_MASK_VARIABILITY + var], k);
+		if(init < FMI2_NUM_INITIALS) fmi2_import_selection_set_bit(&mask[FMI2_MASK_INITIAL + init], k);
+		if(bt < FMI2_NUM_BASE_TYPES) fmi2_import_selection_set_bit(&mask[FMI2_MASK_BASE_TYPE + bt], k);
+		if(ak < FMI2_NUM_ALIAS_KINDS) fmi2_import_selection_set_bit(&mask[FMI2_MASK_ALIAS_KIND + ak], k);
+		if(fmi2_import_get_variable_has_start(v)) fmi2_import_selection_set_bit(&mask[FMI2_MASK_HAS_START], k);
+	}
+	fmu->selectionMasks = masks;
+
+	/* Roles from the model structure */
+	mask += FMI2_MASK_ROLE;
+	vl = fmi2_import_get_derivatives_list(fmu);
+	fmi2_import_selection_set_list(fmu, &mask[fmi2_import_variable_role_derivative], vl, 0);
+	fmi2_import_selection_set_list(fmu, &mask[fmi2_import_variable_role_state], vl, 1);
+	fmi2_import_free_variable_list(vl);
+	vl = fmi2_import_get_discrete_states_list(fmu);
+	fmi2_import_selection_set_list(fmu, &mask[fmi2_import_variable_role_discrete_state], vl, 0);
+	fmi2_import_free_variable_list(vl);
+	vl = fmi2_import_get_outputs_list(fmu);
+	fmi2_import_selection_set_list(fmu, &mask[fmi2_import_variable_role_output], vl, 0);
+	fmi2_import_free_variable_list(vl);
+	vl = fmi2_import_get_initial_unknowns_list(fmu);
+	fmi2_import_selection_set_list(fmu, &mask[fmi2_import_variable_role_initial_unknown], vl, 0);
+	fmi2_import_free_variable_list(vl);
+	return jm_status_success;
+}
+
+void fmi2_import_free_selection_masks(fmi2_import_t* fmu) {
+	fmi2_import_selection_masks_t* masks = fmu->selectionMasks;
+	if(!masks) return;
+	fmu->callbacks->free(masks->words);
+	fmu->callbacks->free(masks);
+	fmu->selectionMasks = 0;
+}
+
+static fmi2_import_selection_t* fmi2_import_alloc_selection(fmi2_import_t* fmu, size_t numBits) {
+	size_t numWords = FMI2_SELECTION_NUM_WORDS(numBits);
+	jm_memory_scope_t scope;
+	fmi2_import_selection_t* s;
+
+	/* The words follow the struct, whose size is a multiple of the alignment of size_t */
+	jm_memory_scope_enter(&scope, fmu->memory, jm_memory_subsystem_variable_list);
+	s = (fmi2_import_selection_t*)fmu->callbacks->malloc(sizeof(fmi2_import_selection_t) + numWords * sizeof(size_t));
+	jm_memory_scope_leave(&scope);
+	if(!s) {
+		jm_log_fatal(fmu->callbacks, module, "Could not allocate memory");
+		return 0;
+	}
+	s->fmu = fmu;
+	s->numBits = numBits;
+	s->numWords = numWords;
+	s->words = (size_t*)(s + 1);
+	return s;
+}
+
+fmi2_import_selection_t* fmi2_import_create_selection(fmi2_import_t* fmu, int all) {
+	jm_vector(jm_voidp)* vars = fmi2_import_selection_variables(fmu);
+	fmi2_import_selection_t* s = fmi2_import_alloc_selection(fmu, vars ? jm_vector_get_size(jm_voidp)(vars) : 0);
+	if(!s) return 0;
+	if(s->numWords) {
+		memset(s->words, 0, s->numWords * sizeof(size_t));
+	}
+	if(all) fmi2_import_selection_invert(s);
+	return s;
+}
+
+fmi2_import_selection_t* fmi2_import_clone_selection(const fmi2_import_selection_t* s) {
+	fmi2_import_selection_t* copy;
+	if(!s) return 0;
+	copy = fmi2_import_alloc_selection(s->fmu, s->numBits);
+	if(!copy) return 0;
+	if(s->numWords) {
+		memcpy(copy->words, s->words, s->numWords * sizeof(size_t));
+	}
+	return copy;
+}
+
+void fmi2_import_free_selection(fmi2_import_selection_t* s) {
+	if(!s) return;
+	s->fmu->callbacks->free(s);
+}
+
+static const fmi2_import_selection_t* fmi2_import_get_mask(fmi2_import_t* fmu, size_t group, size_t num, size_t index) {
+	if(!fmu->selectionMasks) {
+		jm_log_error(fmu->callbacks, module, "The variable masks are not available");
+		return 0;
+	}
+	if(index >= num) return 0;
+	return &fmu->selectionMasks->mask[group + index];
+}
+
+const fmi2_import_selection_t* fmi2_import_get_causality_mask(fmi2_import_t* fmu, fmi2_causality_enu_t causality) {
+	return fmi2_import_get_mask(fmu, FMI2_MASK_CAUSALITY, FMI2_NUM_CAUSALITIES, (size_t)causality);
+}
+
+const fmi2_import_selection_t* fmi2_import_get_variability_mask(fmi2_import_t* fmu, fmi2_variability_enu_t variability) {
+	return fmi2_import_get_mask(fmu, FMI2_MASK_VARIABILITY, FMI2_NUM_VARIABILITIES, (size_t)variability);
+}
+
+const fmi2_import_selection_t* fmi2_import_get_initial_mask(fmi2_import_t* fmu, fmi2_initial_enu_t initial) {
+	return fmi2_import_get_mask(fmu, FMI2_MASK_INITIAL, FMI2_NUM_INITIALS, (size_t)initial);
+}
+
+const fmi2_import_selection_t* fmi2_import_get_base_type_mask(fmi2_import_t* fmu, fmi2_base_type_enu_t baseType) {
+	return fmi2_import_get_mask(fmu, FMI2_MASK_BASE_TYPE, FMI2_NUM_BASE_TYPES, (size_t)baseType);
+}
+
+const fmi2_import_selection_t* fmi2_import_get_alias_kind_mask(fmi2_import_t* fmu, fmi2_variable_alias_kind_enu_t aliasKind) {
+	return fmi2_import_get_mask(fmu, FMI2_MASK_ALIAS_KIND, FMI2_NUM_ALIAS_KINDS, (size_t)aliasKind);
+}
+
+const fmi2_import_selection_t* fmi2_import_get_has_start_mask(fmi2_import_t* fmu) {
+	return fmi2_import_get_mask(fmu, FMI2_MASK_HAS_START, 1, 0);
+}
+
+const fmi2_import_selection_t* fmi2_import_get_role_mask(fmi2_import_t* fmu, fmi2_import_variable_role_enu_t role) {
+	return fmi2_import_get_mask(fmu, FMI2_MASK_ROLE, FMI2_NUM_ROLES, (size_t)role);
+}
+
+static int fmi2_import_selection_check_pair(fmi2_import_selection_t* s, const fmi2_import_selection_t* other) {
+	if(!other || other->fmu != s->fmu || other->numBits != s->numBits) {
+		jm_log_error(s->fmu->callbacks, module, "The selections do not belong to the same FMU");
+		return 0;
+	}
+	return 1;
+}
+
+jm_status_enu_t fmi2_import_selection_and(fmi2_import_selection_t* s, const fmi2_import_selection_t* other) {
+	size_t k, n = s->numWords;
+	size_t* a = s->words;
+	const size_t* b;
+	if(!fmi2_import_selection_check_pair(s, other)) return jm_status_error;
+	b = other->words;
+	for(k = 0; k < n; k++) a[k] &= b[k];
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_selection_or(fmi2_import_selection_t* s, const fmi2_import_selection_t* other) {
+	size_t k, n = s->numWords;
+	size_t* a = s->words;
+	const size_t* b;
+	if(!fmi2_import_selection_check_pair(s, other)) return jm_status_error;
+	b = other->words;
+	for(k = 0; k < n; k++) a[k] |= b[k];
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_selection_andnot(fmi2_import_selection_t* s, const fmi2_import_selection_t* other) {
+	size_t k, n = s->numWords;
+	size_t* a = s->words;
+	const size_t* b;
+	if(!fmi2_import_selection_check_pair(s, other)) return jm_status_error;
+	b = other->words;
+	for(k = 0; k < n; k++) a[k] &= ~b[k];
+	return jm_status_success;
+}
+
+void fmi2_import_selection_invert(fmi2_import_selection_t* s) {
+	size_t k, n = s->numWords, tail = s->numBits % FMI2_SELECTION_WORD_BITS;
+	size_t* a = s->words;
+	for(k = 0; k < n; k++) a[k] = ~a[k];
+	/* The bits past the last variable stay zero */
+	if(tail) a[n - 1] &= ((size_t)1 << tail) - 1;
+}
+
+size_t fmi2_import_selection_count(const fmi2_import_selection_t* s) {
+	size_t k, n = s->numWords, count = 0;
+	const size_t* a = s->words;
+	for(k = 0; k < n; k++) count += fmi2_import_selection_popcount(a[k]);
+	return count;
+}
+
+int fmi2_import_selection_contains(const fmi2_import_selection_t* s, fmi2_import_variable_t* v) {
+	size_t bit = fmi2_import_selection_bit(s->fmu, v);
+	if(bit >= s->numBits) return 0;
+	return (s->words[bit / FMI2_SELECTION_WORD_BITS] >> (bit % FMI2_SELECTION_WORD_BITS)) & 1;
+}
+
+jm_status_enu_t fmi2_import_selection_add(fmi2_import_selection_t* s, fmi2_import_variable_t* v) {
+	size_t bit = fmi2_import_selection_bit(s->fmu, v);
+	if(bit >= s->numBits) {
+		jm_log_error(s->fmu->callbacks, module, "Variable '%s' is not in the model description of the selection", fmi2_import_get_variable_name(v));
+		return jm_status_error;
+	}
+	fmi2_import_selection_set_bit(s, bit);
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_selection_remove(fmi2_import_selection_t* s, fmi2_import_variable_t* v) {
+	size_t bit = fmi2_import_selection_bit(s->fmu, v);
+	if(bit >= s->numBits) {
+		jm_log_error(s->fmu->callbacks, module, "Variable '%s' is not in the model description of the selection", fmi2_import_get_variable_name(v));
+		return jm_status_error;
+	}
+	s->words[bit / FMI2_SELECTION_WORD_BITS] &= ~((size_t)1 << (bit % FMI2_SELECTION_WORD_BITS));
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_selection_add_list(fmi2_import_selection_t* s, fmi2_import_variable_list_t* vl) {
+	size_t k, n = fmi2_import_get_variable_list_size(vl);
+	jm_status_enu_t status = jm_status_success;
+	for(k = 0; k < n; k++) {
+		if(fmi2_import_selection_add(s, fmi2_import_get_variable(vl, k)) != jm_status_success)
+			status = jm_status_error;
+	}
+	return status;
+}
+
+fmi2_import_variable_list_t* fmi2_import_selection_to_variable_list(const fmi2_import_selection_t* s, fmi2_import_selection_order_enu_t order) {
+	jm_vector(jm_voidp)* vars = fmi2_import_selection_variables(s->fmu);
+	fmi2_import_variable_list_t* vl = fmi2_import_alloc_variable_list(s->fmu, fmi2_import_selection_count(s));
+	size_t k, n = s->numWords, i = 0;
+
+	if(!vl) return 0;
+	for(k = 0; k < n; k++) {
+		size_t w = s->words[k];
+		while(w) {
+			size_t bit = k * FMI2_SELECTION_WORD_BITS + fmi2_import_selection_lowest_bit(w);
+			jm_vector_set_item(jm_voidp)(&vl->variables, i++, jm_vector_get_item(jm_voidp)(vars, bit));
+			w &= w - 1;
+		}
+	}
+	if(order == fmi2_import_selection_vr_order) {
+		/* The sort is stable, so aliases stay in the original order */
+		if(fmi2_import_var_list_sort(vl, fmi2_import_compare_variables_by_vr, 0) != jm_status_success) {
+			fmi2_import_free_variable_list(vl);
+			return 0;
+		}
+	}
+	return vl;
+}
+
+jm_status_enu_t fmi2_import_selection_get_value_references(const fmi2_import_selection_t* s, fmi2_import_selection_order_enu_t order, fmi2_value_reference_t* vrs) {
+	jm_vector(jm_voidp)* vars = fmi2_import_selection_variables(s->fmu);
+	size_t k, n = s->numWords, i = 0;
+
+	if(order == fmi2_import_selection_vr_order) {
+		fmi2_import_variable_list_t* vl = fmi2_import_selection_to_variable_list(s, order);
+		const fmi2_value_reference_t* list;
+		if(!vl) return jm_status_error;
+		if(!fmi2_import_get_variable_list_size(vl)) {
+			fmi2_import_free_variable_list(vl);
+			return jm_status_success;
+		}
+		list = fmi2_import_get_value_referece_list(vl);
+		if(list) memcpy(vrs, list, fmi2_import_get_variable_list_size(vl) * sizeof(fmi2_value_reference_t));
+		fmi2_import_free_variable_list(vl);
+		return list ? jm_status_success : jm_status_error;
+	}
+	for(k = 0; k < n; k++) {
+		size_t w = s->words[k];
+		while(w) {
+			size_t bit = k * FMI2_SELECTION_WORD_BITS + fmi2_import_selection_lowest_bit(w);
+			vrs[i++] = fmi2_import_get_variable_vr((fmi2_import_variable_t*)jm_vector_get_item(jm_voidp)(vars, bit));
+			w &= w - 1;
+		}
+	}
+	return jm_status_success;
+}
+
+/* Provide the predefined masks to the query evaluation */
+static const size_t* fmi2_import_query_mask(void* context, fmi2_xml_query_mask_enu_t attribute, int value) {
+	fmi2_import_t* fmu = (fmi2_import_t*)context;
+	const fmi2_import_selection_t* mask = 0;
+	switch(attribute) {
+	case fmi2_xml_query_mask_causality:
+		mask = fmi2_import_get_causality_mask(fmu, (fmi2_causality_enu_t)value);
+		break;
+	case fmi2_xml_query_mask_variability:
+		mask = fmi2_import_get_variability_mask(fmu, (fmi2_variability_enu_t)value);
+		break;
+	case fmi2_xml_query_mask_initial:
+		mask = fmi2_import_get_initial_mask(fmu, (fmi2_initial_enu_t)value);
+		break;
+	case fmi2_xml_query_mask_base_type:
+		mask = fmi2_import_get_base_type_mask(fmu, (fmi2_base_type_enu_t)value);
+		break;
+	case fmi2_xml_query_mask_alias_kind:
+		mask = fmi2_import_get_alias_kind_mask(fmu, (fmi2_variable_alias_kind_enu_t)value);
+		break;
+	case fmi2_xml_query_mask_has_start:
+		mask = fmi2_import_get_has_start_mask(fmu);
+		break;
+	}
+	return mask ? mask->words : 0;
+}
+
+fmi2_import_query_t* fmi2_import_compile_query(fmi2_import_t* fmu, const char* query) {
+	if(!fmu->md) {
+		jm_log_error(fmu->callbacks, module, "No FMU is loaded");
+		return 0;
+	}
+	return fmi2_xml_compile_query(fmu->md, query);
+}
+
+void fmi2_import_free_query(fmi2_import_query_t* q) {
+	fmi2_xml_free_query(q);
+}
+
+int fmi2_import_query_match(fmi2_import_query_t* q, fmi2_import_variable_t* v) {
+	return fmi2_xml_query_variable(q, v);
+}
+
+jm_status_enu_t fmi2_import_query_select(fmi2_import_query_t* q, fmi2_import_selection_t* s) {
+	return fmi2_xml_query_evaluate(q, s->fmu->md, fmi2_import_query_mask, s->fmu, s->words);
+}
+
+fmi2_import_variable_list_t* fmi2_import_query_variables(fmi2_import_t* fmu, const char* query) {
+	fmi2_import_query_t* q = fmi2_import_compile_query(fmu, query);
+	fmi2_import_selection_t* s;
+	fmi2_import_variable_list_t* vl = 0;
+
+	if(!q) return 0;
+	s = fmi2_import_create_selection(fmu, 0);
+	if(s && (fmi2_import_query_select(q, s) == jm_status_success)) {
+		vl = fmi2_import_selection_to_variable_list(s, fmi2_import_selection_original_order);
+	}
+	fmi2_import_free_selection(s);
+	fmi2_import_free_query(q);
+	return vl;
+}
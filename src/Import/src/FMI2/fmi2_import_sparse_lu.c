@@ -0,0 +1,346 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <JM/jm_vector.h>
+#include "fmi2_import_sparse_lu.h"
+
+static const char* module = "FMILIB";
+
+/* Pivots smaller than this relative to the largest entry of the row are rejected */
+#define FMI2_SPARSE_LU_PIVOT_TOL 1e-14
+
+struct fmi2_import_sparse_lu_t {
+	jm_callbacks* callbacks;
+	size_t n;
+
+	/* Pattern of A as given by the user */
+	size_t* aStart;
+	size_t* aCol;
+
+	/* Permutation: row/column i of the factored matrix is perm[i] of A */
+	size_t* perm;
+	size_t* iperm;
+
+	/* L (unit diagonal, not stored) and U in one CSR structure in permuted numbering */
+	size_t* luStart;
+	size_t* luDiag;
+	jm_vector(size_t) luCol;
+	double* lu;
+
+	double* work;
+};
+
+typedef struct {
+	size_t degree;
+	size_t node;
+} fmi2_sparse_lu_node_t;
+
+static int fmi2_sparse_lu_compare_nodes(const void* a, const void* b) {
+	const fmi2_sparse_lu_node_t* x = (const fmi2_sparse_lu_node_t*)a;
+	const fmi2_sparse_lu_node_t* y = (const fmi2_sparse_lu_node_t*)b;
+	if(x->degree != y->degree) return (x->degree < y->degree) ? -1 : 1;
+	return (x->node < y->node) ? -1 : (x->node > y->node);
+}
+
+static int fmi2_sparse_lu_compare_size_t(const void* a, const void* b) {
+	size_t x = *(const size_t*)a, y = *(const size_t*)b;
+	return (x < y) ? -1 : (x > y);
+}
+
+void fmi2_import_sparse_lu_free(fmi2_import_sparse_lu_t* lu) {
+	jm_callbacks* cb;
+	if(!lu) return;
+	cb = lu->callbacks;
+	cb->free(lu->aStart);
+	cb->free(lu->aCol);
+	cb->free(lu->perm);
+	cb->free(lu->iperm);
+	cb->free(lu->luStart);
+	cb->free(lu->luDiag);
+	jm_vector_free_data(size_t)(&lu->luCol);
+	cb->free(lu->lu);
+	cb->free(lu->work);
+	cb->free(lu);
+}
+
+/* Reverse Cuthill-McKee ordering of the symmetrized pattern A + A^T */
+static int fmi2_sparse_lu_rcm(fmi2_import_sparse_lu_t* lu) {
+	jm_callbacks* cb = lu->callbacks;
+	size_t n = lu->n, i, k, pos = 0, s;
+	size_t *adjStart, *adj, *order;
+	char* visited;
+	fmi2_sparse_lu_node_t *nodes, *pairs;
+
+	adjStart = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	adj = (size_t*)cb->calloc(2 * lu->aStart[n] + 1, sizeof(size_t));
+	order = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	visited = (char*)cb->calloc(n + 1, 1);
+	nodes = (fmi2_sparse_lu_node_t*)cb->calloc(n + 1, sizeof(fmi2_sparse_lu_node_t));
+	pairs = (fmi2_sparse_lu_node_t*)cb->calloc(n + 1, sizeof(fmi2_sparse_lu_node_t));
+	if(!adjStart || !adj || !order || !visited || !nodes || !pairs) {
+		cb->free(adjStart); cb->free(adj); cb->free(order); cb->free(visited); cb->free(nodes); cb->free(pairs);
+		return 0;
+	}
+
+	for(i = 0; i < n; i++) {
+		for(k = lu->aStart[i]; k < lu->aStart[i + 1]; k++) {
+			size_t j = lu->aCol[k];
+			if(j == i) continue;
+			adjStart[i + 1]++;
+			adjStart[j + 1]++;
+		}
+	}
+	for(i = 0; i < n; i++) adjStart[i + 1] += adjStart[i];
+	for(i = 0; i < n; i++) {
+		for(k = lu->aStart[i]; k < lu->aStart[i + 1]; k++) {
+			size_t j = lu->aCol[k];
+			if(j == i) continue;
+			adj[adjStart[i]++] = j;
+			adj[adjStart[j]++] = i;
+		}
+	}
+	for(i = n; i > 0; i--) adjStart[i] = adjStart[i - 1];
+	adjStart[0] = 0;
+
+	/* candidate start nodes in order of increasing degree */
+	for(i = 0; i < n; i++) {
+		nodes[i].degree = adjStart[i + 1] - adjStart[i];
+		nodes[i].node = i;
+	}
+	qsort(nodes, n, sizeof(fmi2_sparse_lu_node_t), fmi2_sparse_lu_compare_nodes);
+
+	for(s = 0; s < n; s++) {
+		size_t head;
+		if(visited[nodes[s].node]) continue;
+		head = pos;
+		order[pos++] = nodes[s].node;
+		visited[nodes[s].node] = 1;
+		while(head < pos) {
+			size_t v = order[head++], seg = pos;
+			for(k = adjStart[v]; k < adjStart[v + 1]; k++) {
+				size_t u = adj[k];
+				if(visited[u]) continue;
+				visited[u] = 1;
+				order[pos++] = u;
+			}
+			if(pos - seg > 1) {
+				/* visit the neighbours in order of increasing degree */
+				size_t m = pos - seg, q;
+				for(q = 0; q < m; q++) {
+					size_t u = order[seg + q];
+					pairs[q].degree = adjStart[u + 1] - adjStart[u];
+					pairs[q].node = u;
+				}
+				qsort(pairs, m, sizeof(fmi2_sparse_lu_node_t), fmi2_sparse_lu_compare_nodes);
+				for(q = 0; q < m; q++) order[seg + q] = pairs[q].node;
+			}
+		}
+	}
+
+	for(i = 0; i < n; i++) {
+		lu->perm[i] = order[n - 1 - i];
+		lu->iperm[lu->perm[i]] = i;
+	}
+
+	cb->free(adjStart);
+	cb->free(adj);
+	cb->free(order);
+	cb->free(visited);
+	cb->free(nodes);
+	cb->free(pairs);
+	return 1;
+}
+
+/* Row-wise symbolic factorization. The pattern of row i of L+U is the pattern of
+   row i of the permuted A merged with the U parts of all rows k < i in its L part. */
+static int fmi2_sparse_lu_symbolic(fmi2_import_sparse_lu_t* lu) {
+	jm_callbacks* cb = lu->callbacks;
+	size_t n = lu->n, i, k;
+	size_t *next, *mark, *tmp;
+	const size_t head = n; /* list head; the value n also terminates the list */
+	int ok = 1;
+
+	next = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	mark = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	tmp = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	if(!next || !mark || !tmp) {
+		cb->free(next); cb->free(mark); cb->free(tmp);
+		return 0;
+	}
+	for(i = 0; i < n; i++) mark[i] = (size_t)-1;
+
+	lu->luStart[0] = 0;
+	for(i = 0; ok && i < n; i++) {
+		size_t src = lu->perm[i], m = 0, cur, prev;
+
+		for(k = lu->aStart[src]; k < lu->aStart[src + 1]; k++) {
+			size_t j = lu->iperm[lu->aCol[k]];
+			if(mark[j] == i) continue;
+			mark[j] = i;
+			tmp[m++] = j;
+		}
+		if(mark[i] != i) {
+			mark[i] = i;
+			tmp[m++] = i;
+		}
+		qsort(tmp, m, sizeof(size_t), fmi2_sparse_lu_compare_size_t);
+		prev = head;
+		for(k = 0; k < m; k++) {
+			next[prev] = tmp[k];
+			prev = tmp[k];
+		}
+		next[prev] = n;
+
+		for(cur = next[head]; cur < i; cur = next[cur]) {
+			size_t* ucol = jm_vector_get_itemp(size_t)(&lu->luCol, 0);
+			size_t q;
+			prev = cur;
+			for(q = lu->luDiag[cur] + 1; q < lu->luStart[cur + 1]; q++) {
+				size_t j = ucol[q];
+				while(next[prev] < j) prev = next[prev];
+				if(mark[j] != i) {
+					mark[j] = i;
+					next[j] = next[prev];
+					next[prev] = j;
+				}
+				prev = j;
+			}
+		}
+
+		for(cur = next[head]; cur < n; cur = next[cur]) {
+			if(cur == i) lu->luDiag[i] = jm_vector_get_size(size_t)(&lu->luCol);
+			if(!jm_vector_push_back(size_t)(&lu->luCol, cur)) {
+				ok = 0;
+				break;
+			}
+		}
+		lu->luStart[i + 1] = jm_vector_get_size(size_t)(&lu->luCol);
+	}
+
+	cb->free(next);
+	cb->free(mark);
+	cb->free(tmp);
+	return ok;
+}
+
+fmi2_import_sparse_lu_t* fmi2_import_sparse_lu_create(jm_callbacks* cb, size_t n, const size_t* rowStart, const size_t* colIndex) {
+	fmi2_import_sparse_lu_t* lu;
+	size_t nnz = rowStart[n];
+	int ok;
+
+	lu = (fmi2_import_sparse_lu_t*)cb->calloc(1, sizeof(fmi2_import_sparse_lu_t));
+	if(!lu) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	lu->callbacks = cb;
+	lu->n = n;
+	jm_vector_init(size_t)(&lu->luCol, 0, cb);
+
+	lu->aStart = (size_t*)cb->malloc((n + 1) * sizeof(size_t));
+	lu->aCol = (size_t*)cb->malloc((nnz + 1) * sizeof(size_t));
+	lu->perm = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	lu->iperm = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	lu->luStart = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	lu->luDiag = (size_t*)cb->calloc(n + 1, sizeof(size_t));
+	lu->work = (double*)cb->calloc(n + 1, sizeof(double));
+	ok = lu->aStart && lu->aCol && lu->perm && lu->iperm && lu->luStart && lu->luDiag && lu->work;
+	if(ok) {
+		memcpy(lu->aStart, rowStart, (n + 1) * sizeof(size_t));
+		memcpy(lu->aCol, colIndex, nnz * sizeof(size_t));
+		jm_vector_reserve(size_t)(&lu->luCol, nnz);
+		ok = fmi2_sparse_lu_rcm(lu) && fmi2_sparse_lu_symbolic(lu);
+	}
+	if(ok) {
+		lu->lu = (double*)cb->calloc(jm_vector_get_size(size_t)(&lu->luCol) + 1, sizeof(double));
+		ok = (lu->lu != 0);
+	}
+	if(!ok) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		fmi2_import_sparse_lu_free(lu);
+		return 0;
+	}
+	jm_log_verbose(cb, module, "Sparse LU: dimension %u, %u non-zeros in A, %u in L+U",
+		(unsigned)n, (unsigned)nnz, (unsigned)jm_vector_get_size(size_t)(&lu->luCol));
+	return lu;
+}
+
+jm_status_enu_t fmi2_import_sparse_lu_factor(fmi2_import_sparse_lu_t* lu, const double* values) {
+	size_t n = lu->n, i, p, q;
+	size_t* col;
+	double* w = lu->work;
+	double* f = lu->lu;
+
+	if(n == 0) return jm_status_success;
+	col = jm_vector_get_itemp(size_t)(&lu->luCol, 0);
+
+	for(i = 0; i < n; i++) {
+		size_t src = lu->perm[i];
+		double rowmax = 0, piv;
+
+		for(p = lu->luStart[i]; p < lu->luStart[i + 1]; p++) w[col[p]] = 0;
+		for(p = lu->aStart[src]; p < lu->aStart[src + 1]; p++) {
+			w[lu->iperm[lu->aCol[p]]] += values[p];
+			if(fabs(values[p]) > rowmax) rowmax = fabs(values[p]);
+		}
+		for(p = lu->luStart[i]; p < lu->luDiag[i]; p++) {
+			size_t k = col[p];
+			double lik = w[k] / f[lu->luDiag[k]];
+			w[k] = lik;
+			if(lik == 0) continue;
+			for(q = lu->luDiag[k] + 1; q < lu->luStart[k + 1]; q++)
+				w[col[q]] -= lik * f[q];
+		}
+		piv = w[i];
+		if(!(fabs(piv) > FMI2_SPARSE_LU_PIVOT_TOL * rowmax)) {
+			jm_log_verbose(lu->callbacks, module, "Sparse LU: small pivot %g in row %u", piv, (unsigned)lu->perm[i]);
+			return jm_status_warning;
+		}
+		for(p = lu->luStart[i]; p < lu->luStart[i + 1]; p++) f[p] = w[col[p]];
+	}
+	return jm_status_success;
+}
+
+void fmi2_import_sparse_lu_solve(fmi2_import_sparse_lu_t* lu, double* b) {
+	size_t n = lu->n, i, p;
+	size_t* col;
+	double* w = lu->work;
+	double* f = lu->lu;
+
+	if(n == 0) return;
+	col = jm_vector_get_itemp(size_t)(&lu->luCol, 0);
+
+	for(i = 0; i < n; i++) w[i] = b[lu->perm[i]];
+	for(i = 0; i < n; i++) {
+		double s = w[i];
+		for(p = lu->luStart[i]; p < lu->luDiag[i]; p++) s -= f[p] * w[col[p]];
+		w[i] = s;
+	}
+	for(i = n; i > 0; i--) {
+		size_t r = i - 1;
+		double s = w[r];
+		for(p = lu->luDiag[r] + 1; p < lu->luStart[r + 1]; p++) s -= f[p] * w[col[p]];
+		w[r] = s / f[lu->luDiag[r]];
+	}
+	for(i = 0; i < n; i++) b[lu->perm[i]] = w[i];
+}
+
+size_t fmi2_import_sparse_lu_get_nnz(fmi2_import_sparse_lu_t* lu) {
+	return jm_vector_get_size(size_t)(&lu->luCol);
+}
@@ -0,0 +1,59 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+/** \file fmi2_import_sparse_lu.h
+*  \brief Sparse direct solver used by the implicit ME solvers.
+*
+*  The matrix is reordered symmetrically with reverse Cuthill-McKee, the fill-in
+*  is computed once and the numeric factorization uses static diagonal pivoting.
+*  This is intended for iteration matrices of the form I - gamma*J.
+*/
+
+#ifndef FMI2_IMPORT_SPARSE_LU_H_
+#define FMI2_IMPORT_SPARSE_LU_H_
+
+#include <JM/jm_callbacks.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct fmi2_import_sparse_lu_t fmi2_import_sparse_lu_t;
+
+/**
+	\brief Compute the ordering and symbolic factorization of a square CSR pattern.
+	The pattern must contain all diagonal entries. The arrays are copied.
+*/
+fmi2_import_sparse_lu_t* fmi2_import_sparse_lu_create(jm_callbacks* cb, size_t n, const size_t* rowStart, const size_t* colIndex);
+
+void fmi2_import_sparse_lu_free(fmi2_import_sparse_lu_t* lu);
+
+/**
+	\brief Numeric factorization.
+	\param values Matrix values in the order of the CSR pattern given at creation.
+	\return ::jm_status_success, or ::jm_status_warning if a pivot is too small.
+*/
+jm_status_enu_t fmi2_import_sparse_lu_factor(fmi2_import_sparse_lu_t* lu, const double* values);
+
+/** \brief Solve A*x = b in place using the last factorization */
+void fmi2_import_sparse_lu_solve(fmi2_import_sparse_lu_t* lu, double* b);
+
+/** \brief Number of non-zeros in the L and U factors */
+size_t fmi2_import_sparse_lu_get_nnz(fmi2_import_sparse_lu_t* lu);
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* FMI2_IMPORT_SPARSE_LU_H_ */
@@ -0,0 +1,157 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <FMI2/fmi2_import_state_ring.h>
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+struct fmi2_import_state_ring_t {
+	fmi2_import_t* fmu;
+	size_t capacity;
+	/* Slots in physical order. A slot keeps its FMU state handle after the snapshot
+	   in it is dropped, so the handle is reused by the next snapshot in the slot. */
+	fmi2_FMU_state_t* states;
+	fmi2_real_t* times;
+	size_t first;     /* slot of the oldest snapshot */
+	size_t size;      /* number of retained snapshots */
+	size_t numAllocated;
+};
+
+static int fmi2_import_state_ring_supported(fmi2_import_t* fmu) {
+	fmi2_fmu_kind_enu_t kind = fmi2_import_get_fmu_kind(fmu);
+	if((kind == fmi2_fmu_kind_me || kind == fmi2_fmu_kind_me_and_cs) && fmi2_import_get_capability(fmu, fmi2_me_canGetAndSetFMUstate))
+		return 1;
+	if((kind == fmi2_fmu_kind_cs || kind == fmi2_fmu_kind_me_and_cs) && fmi2_import_get_capability(fmu, fmi2_cs_canGetAndSetFMUstate))
+		return 1;
+	return 0;
+}
+
+fmi2_import_state_ring_t* fmi2_import_state_ring_create(fmi2_import_t* fmu, size_t capacity) {
+	jm_callbacks* cb = fmu->callbacks;
+	fmi2_import_state_ring_t* ring;
+
+	if(!fmi2_import_state_ring_supported(fmu)) {
+		jm_log_error(cb, module, "The FMU does not support getting and setting the FMU state");
+		return 0;
+	}
+	if(capacity == 0) {
+		jm_log_error(cb, module, "State ring capacity must be positive");
+		return 0;
+	}
+	ring = (fmi2_import_state_ring_t*)cb->calloc(1, sizeof(fmi2_import_state_ring_t));
+	if(ring) {
+		ring->states = (fmi2_FMU_state_t*)cb->calloc(capacity, sizeof(fmi2_FMU_state_t));
+		ring->times = (fmi2_real_t*)cb->calloc(capacity, sizeof(fmi2_real_t));
+	}
+	if(!ring || !ring->states || !ring->times) {
+		if(ring) {
+			cb->free(ring->states);
+			cb->free(ring->times);
+			cb->free(ring);
+		}
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	ring->fmu = fmu;
+	ring->capacity = capacity;
+	return ring;
+}
+
+void fmi2_import_state_ring_free(fmi2_import_state_ring_t* ring) {
+	jm_callbacks* cb;
+	size_t i;
+
+	if(!ring) return;
+	cb = ring->fmu->callbacks;
+	for(i = 0; i < ring->capacity; i++) {
+		if(ring->states[i]) fmi2_import_free_fmu_state(ring->fmu, &ring->states[i]);
+	}
+	cb->free(ring->states);
+	cb->free(ring->times);
+	cb->free(ring);
+}
+
+jm_status_enu_t fmi2_import_state_ring_push(fmi2_import_state_ring_t* ring, fmi2_real_t time) {
+	size_t slot;
+	fmi2_status_t status;
+	int allocated;
+
+	if(ring->size > 0 && time < ring->times[(ring->first + ring->size - 1) % ring->capacity]) {
+		jm_log_error(ring->fmu->callbacks, module, "Snapshot time %g is before the newest snapshot", time);
+		return jm_status_error;
+	}
+	if(ring->size == ring->capacity) {
+		/* overwrite the oldest */
+		slot = ring->first;
+		ring->first = (ring->first + 1) % ring->capacity;
+		ring->size--;
+	}
+	else {
+		slot = (ring->first + ring->size) % ring->capacity;
+	}
+
+	allocated = (ring->states[slot] == 0);
+	status = fmi2_import_get_fmu_state(ring->fmu, &ring->states[slot]);
+	if(status != fmi2_status_ok && status != fmi2_status_warning) {
+		jm_log_error(ring->fmu->callbacks, module, "fmi2GetFMUstate returned status %s", fmi2_status_to_string(status));
+		return jm_status_error;
+	}
+	if(allocated && ring->states[slot]) ring->numAllocated++;
+	ring->times[slot] = time;
+	ring->size++;
+	return jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_state_ring_rollback(fmi2_import_state_ring_t* ring, fmi2_real_t time, fmi2_real_t* restoredTime) {
+	size_t n = ring->size, slot;
+	fmi2_status_t status;
+
+	/* newest snapshot not after 'time' */
+	while(n > 0 && ring->times[(ring->first + n - 1) % ring->capacity] > time) n--;
+	if(n == 0) {
+		jm_log_error(ring->fmu->callbacks, module, "No snapshot at or before time %g", time);
+		return jm_status_error;
+	}
+	slot = (ring->first + n - 1) % ring->capacity;
+	status = fmi2_import_set_fmu_state(ring->fmu, ring->states[slot]);
+	if(status != fmi2_status_ok && status != fmi2_status_warning) {
+		jm_log_error(ring->fmu->callbacks, module, "fmi2SetFMUstate returned status %s", fmi2_status_to_string(status));
+		return jm_status_error;
+	}
+	ring->size = n;
+	if(restoredTime) *restoredTime = ring->times[slot];
+	return jm_status_success;
+}
+
+void fmi2_import_state_ring_clear(fmi2_import_state_ring_t* ring) {
+	ring->size = 0;
+}
+
+size_t fmi2_import_state_ring_get_size(fmi2_import_state_ring_t* ring) {
+	return ring->size;
+}
+
+size_t fmi2_import_state_ring_get_capacity(fmi2_import_state_ring_t* ring) {
+	return ring->capacity;
+}
+
+fmi2_real_t fmi2_import_state_ring_get_time(fmi2_import_state_ring_t* ring, size_t index) {
+	return ring->times[(ring->first + index) % ring->capacity];
+}
+
+size_t fmi2_import_state_ring_get_number_of_allocated_states(fmi2_import_state_ring_t* ring) {
+	return ring->numAllocated;
+}
@@ -0,0 +1,348 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+
+#include <zlib.h>
+
+#include <JM/jm_spill_file.h>
+#include <FMI2/fmi2_import_state_store.h>
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+/* Minimum size of the memory blocks holding the stored data */
+#define FMI2_STATE_STORE_BLOCK_SIZE 65536
+
+/* A block of the memory arena; the data follows the header */
+typedef struct fmi2_state_store_block_t {
+	struct fmi2_state_store_block_t* next;
+	size_t capacity;
+	size_t used;
+} fmi2_state_store_block_t;
+
+typedef struct fmi2_state_store_record_t {
+	size_t rawSize;      /* size of the serialized state */
+	size_t storedSize;   /* size of the stored data */
+	const char* data;    /* stored data in memory, NULL if spilled */
+	size_t fileOffset;   /* position in the spill file */
+	size_t keyframe;     /* the complete state this one is a delta to (via the states in between) */
+	int compressed;
+} fmi2_state_store_record_t;
+
+struct fmi2_import_state_store_t {
+	fmi2_import_t* fmu;
+	jm_callbacks* callbacks;
+	fmi2_import_state_store_options_t options;
+
+	fmi2_state_store_record_t* records;
+	size_t numRecords;
+	size_t capRecords;
+
+	fmi2_state_store_block_t* blocks;  /* the current block first */
+	size_t memorySize;
+	size_t serializedSize;
+	jm_spill_file_t* spill;
+
+	/* Scratch buffers. 'prev' holds the previously saved serialized state.
+	   'raw' and 'work' are free between calls and are also used for decoding. */
+	fmi2_byte_t* raw;
+	fmi2_byte_t* prev;
+	fmi2_byte_t* work;
+	fmi2_byte_t* zbuf;
+	size_t bufSize;
+	size_t zbufSize;
+	size_t prevSize;
+
+	fmi2_FMU_state_t state;  /* used to save the current state of the FMU */
+};
+
+void fmi2_import_state_store_default_options(fmi2_import_state_store_options_t* options) {
+	options->ram_budget = 0;
+	options->keyframe_interval = 16;
+	options->compression_level = Z_BEST_SPEED;
+	options->spill_dir = 0;
+}
+
+static int fmi2_import_state_store_supported(fmi2_import_t* fmu) {
+	fmi2_fmu_kind_enu_t kind = fmi2_import_get_fmu_kind(fmu);
+	if((kind == fmi2_fmu_kind_me || kind == fmi2_fmu_kind_me_and_cs) && fmi2_import_get_capability(fmu, fmi2_me_canSerializeFMUstate))
+		return 1;
+	if((kind == fmi2_fmu_kind_cs || kind == fmi2_fmu_kind_me_and_cs) && fmi2_import_get_capability(fmu, fmi2_cs_canSerializeFMUstate))
+		return 1;
+	return 0;
+}
+
+fmi2_import_state_store_t* fmi2_import_state_store_create(fmi2_import_t* fmu, const fmi2_import_state_store_options_t* options) {
+	jm_callbacks* cb = fmu->callbacks;
+	fmi2_import_state_store_t* store;
+
+	if(!fmi2_import_state_store_supported(fmu)) {
+		jm_log_error(cb, module, "The FMU does not support serialization of the FMU state");
+		return 0;
+	}
+	store = (fmi2_import_state_store_t*)cb->calloc(1, sizeof(fmi2_import_state_store_t));
+	if(!store) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	store->fmu = fmu;
+	store->callbacks = cb;
+	if(options)
+		store->options = *options;
+	else
+		fmi2_import_state_store_default_options(&store->options);
+	if(store->options.keyframe_interval == 0) store->options.keyframe_interval = 1;
+	if(store->options.compression_level < 0) store->options.compression_level = 0;
+	if(store->options.compression_level > Z_BEST_COMPRESSION) store->options.compression_level = Z_BEST_COMPRESSION;
+	return store;
+}
+
+void fmi2_import_state_store_free(fmi2_import_state_store_t* store) {
+	jm_callbacks* cb;
+
+	if(!store) return;
+	cb = store->callbacks;
+	while(store->blocks) {
+		fmi2_state_store_block_t* next = store->blocks->next;
+		cb->free(store->blocks);
+		store->blocks = next;
+	}
+	jm_spill_file_free(store->spill);
+	if(store->state) fmi2_import_free_fmu_state(store->fmu, &store->state);
+	cb->free(store->records);
+	cb->free(store->raw);
+	cb->free(store->prev);
+	cb->free(store->work);
+	cb->free(store->zbuf);
+	cb->free(store);
+}
+
+static int fmi2_state_store_reserve(fmi2_import_state_store_t* store, size_t size) {
+	jm_callbacks* cb = store->callbacks;
+	size_t zsize = (size_t)compressBound((uLong)size);
+
+	if(size > store->bufSize) {
+		fmi2_byte_t* raw = (fmi2_byte_t*)cb->malloc(size);
+		fmi2_byte_t* prev = (fmi2_byte_t*)cb->malloc(size);
+		fmi2_byte_t* work = (fmi2_byte_t*)cb->malloc(size);
+		if(!raw || !prev || !work) {
+			cb->free(raw); cb->free(prev); cb->free(work);
+			return 0;
+		}
+		if(store->prevSize) memcpy(prev, store->prev, store->prevSize);
+		cb->free(store->raw); cb->free(store->prev); cb->free(store->work);
+		store->raw = raw;
+		store->prev = prev;
+		store->work = work;
+		store->bufSize = size;
+	}
+	if(zsize > store->zbufSize) {
+		fmi2_byte_t* zbuf = (fmi2_byte_t*)cb->malloc(zsize);
+		if(!zbuf) return 0;
+		cb->free(store->zbuf);
+		store->zbuf = zbuf;
+		store->zbufSize = zsize;
+	}
+	if(store->numRecords == store->capRecords) {
+		size_t cap = store->capRecords ? 2 * store->capRecords : 64;
+		fmi2_state_store_record_t* records = (fmi2_state_store_record_t*)cb->realloc(store->records, cap * sizeof(fmi2_state_store_record_t));
+		if(!records) return 0;
+		store->records = records;
+		store->capRecords = cap;
+	}
+	return 1;
+}
+
+/* Allocate from the arena */
+static char* fmi2_state_store_alloc(fmi2_import_state_store_t* store, size_t size) {
+	fmi2_state_store_block_t* b = store->blocks;
+	char* p;
+
+	if(!b || b->capacity - b->used < size) {
+		size_t capacity = (size > FMI2_STATE_STORE_BLOCK_SIZE) ? size : FMI2_STATE_STORE_BLOCK_SIZE;
+		b = (fmi2_state_store_block_t*)store->callbacks->malloc(sizeof(fmi2_state_store_block_t) + capacity);
+		if(!b) return 0;
+		b->next = store->blocks;
+		b->capacity = capacity;
+		b->used = 0;
+		store->blocks = b;
+	}
+	p = (char*)(b + 1) + b->used;
+	b->used += size;
+	return p;
+}
+
+static jm_status_enu_t fmi2_state_store_check(fmi2_import_state_store_t* store, fmi2_status_t status, const char* fname) {
+	if(status == fmi2_status_ok || status == fmi2_status_warning) return jm_status_success;
+	jm_log_error(store->callbacks, module, "%s returned status %s", fname, fmi2_status_to_string(status));
+	return jm_status_error;
+}
+
+jm_status_enu_t fmi2_import_state_store_save(fmi2_import_state_store_t* store, fmi2_FMU_state_t state, size_t* id) {
+	jm_callbacks* cb = store->callbacks;
+	fmi2_state_store_record_t* rec;
+	const fmi2_byte_t *src, *payload;
+	size_t size, plen, i, n = store->numRecords;
+	int keyframe, compressed = 0;
+	fmi2_byte_t* tmp;
+
+	if(!state) {
+		if(fmi2_state_store_check(store, fmi2_import_get_fmu_state(store->fmu, &store->state), "fmi2GetFMUstate") != jm_status_success)
+			return jm_status_error;
+		state = store->state;
+	}
+	if(fmi2_state_store_check(store, fmi2_import_serialized_fmu_state_size(store->fmu, state, &size), "fmi2SerializedFMUstateSize") != jm_status_success)
+		return jm_status_error;
+	if(!fmi2_state_store_reserve(store, size)) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return jm_status_error;
+	}
+	if(fmi2_state_store_check(store, fmi2_import_serialize_fmu_state(store->fmu, state, store->raw, size), "fmi2SerializeFMUstate") != jm_status_success)
+		return jm_status_error;
+
+	keyframe = (n % store->options.keyframe_interval == 0) || (size != store->prevSize);
+	if(keyframe) {
+		src = store->raw;
+	}
+	else {
+		for(i = 0; i < size; i++) store->work[i] = (fmi2_byte_t)(store->raw[i] ^ store->prev[i]);
+		src = store->work;
+	}
+
+	payload = src;
+	plen = size;
+	if(store->options.compression_level > 0) {
+		uLongf zlen = (uLongf)store->zbufSize;
+		if(compress2((Bytef*)store->zbuf, &zlen, (const Bytef*)src, (uLong)size, store->options.compression_level) == Z_OK && zlen < size) {
+			payload = store->zbuf;
+			plen = (size_t)zlen;
+			compressed = 1;
+		}
+	}
+
+	rec = &store->records[n];
+	rec->rawSize = size;
+	rec->storedSize = plen;
+	rec->compressed = compressed;
+	rec->keyframe = keyframe ? n : store->records[n - 1].keyframe;
+	rec->data = 0;
+	rec->fileOffset = 0;
+	if(!store->options.ram_budget || store->memorySize + plen <= store->options.ram_budget) {
+		char* p = fmi2_state_store_alloc(store, plen);
+		if(!p) {
+			jm_log_fatal(cb, module, "Could not allocate memory");
+			return jm_status_error;
+		}
+		memcpy(p, payload, plen);
+		rec->data = p;
+		store->memorySize += plen;
+	}
+	else {
+		if(!store->spill) {
+			store->spill = jm_spill_file_create(cb, store->options.spill_dir);
+			if(!store->spill) return jm_status_error;
+			jm_log_verbose(cb, module, "Memory budget of the state store exhausted, spilling to file");
+		}
+		if(jm_spill_file_append(store->spill, payload, plen, &rec->fileOffset) != jm_status_success)
+			return jm_status_error;
+	}
+
+	/* the serialized state is the base of the next delta */
+	tmp = store->prev;
+	store->prev = store->raw;
+	store->raw = tmp;
+	store->prevSize = size;
+
+	store->serializedSize += size;
+	store->numRecords++;
+	if(id) *id = n;
+	return jm_status_success;
+}
+
+/* Pointer to the stored data of a record; valid until the next call */
+static const fmi2_byte_t* fmi2_state_store_payload(fmi2_import_state_store_t* store, fmi2_state_store_record_t* rec) {
+	if(rec->data) return (const fmi2_byte_t*)rec->data;
+	return (const fmi2_byte_t*)jm_spill_file_map(store->spill, rec->fileOffset, rec->storedSize);
+}
+
+static int fmi2_state_store_decode(fmi2_import_state_store_t* store, fmi2_state_store_record_t* rec, fmi2_byte_t* dest) {
+	const fmi2_byte_t* payload = fmi2_state_store_payload(store, rec);
+	uLongf len = (uLongf)rec->rawSize;
+
+	if(!payload) return 0;
+	if(!rec->compressed) {
+		memcpy(dest, payload, rec->rawSize);
+		return 1;
+	}
+	if(uncompress((Bytef*)dest, &len, (const Bytef*)payload, (uLong)rec->storedSize) != Z_OK || len != rec->rawSize) {
+		jm_log_error(store->callbacks, module, "Stored FMU state is corrupt");
+		return 0;
+	}
+	return 1;
+}
+
+jm_status_enu_t fmi2_import_state_store_restore(fmi2_import_state_store_t* store, size_t id, fmi2_import_t* fmu) {
+	fmi2_state_store_record_t* rec;
+	const fmi2_byte_t* data;
+	fmi2_FMU_state_t state = 0;
+	jm_status_enu_t st;
+	size_t j, i;
+
+	if(id >= store->numRecords) {
+		jm_log_error(store->callbacks, module, "No stored FMU state with id %u", (unsigned)id);
+		return jm_status_error;
+	}
+	if(!fmu) fmu = store->fmu;
+	rec = &store->records[id];
+
+	if(rec->keyframe == id && !rec->compressed) {
+		/* complete and uncompressed: deserialize in place */
+		data = fmi2_state_store_payload(store, rec);
+		if(!data) return jm_status_error;
+	}
+	else {
+		/* decode the keyframe into 'work' and apply the deltas up to the requested state */
+		if(!fmi2_state_store_decode(store, &store->records[rec->keyframe], store->work)) return jm_status_error;
+		for(j = rec->keyframe + 1; j <= id; j++) {
+			if(!fmi2_state_store_decode(store, &store->records[j], store->raw)) return jm_status_error;
+			for(i = 0; i < rec->rawSize; i++) store->work[i] ^= store->raw[i];
+		}
+		data = store->work;
+	}
+
+	st = fmi2_state_store_check(store, fmi2_import_de_serialize_fmu_state(fmu, data, rec->rawSize, &state), "fmi2DeSerializeFMUstate");
+	if(st == jm_status_success) {
+		st = fmi2_state_store_check(store, fmi2_import_set_fmu_state(fmu, state), "fmi2SetFMUstate");
+		fmi2_import_free_fmu_state(fmu, &state);
+	}
+	return st;
+}
+
+size_t fmi2_import_state_store_get_number_of_states(fmi2_import_state_store_t* store) {
+	return store->numRecords;
+}
+
+size_t fmi2_import_state_store_get_serialized_size(fmi2_import_state_store_t* store) {
+	return store->serializedSize;
+}
+
+size_t fmi2_import_state_store_get_memory_size(fmi2_import_state_store_t* store) {
+	return store->memorySize;
+}
+
+size_t fmi2_import_state_store_get_spilled_size(fmi2_import_state_store_t* store) {
+	return store->spill ? jm_spill_file_get_size(store->spill) : 0;
+}
@@ -19,14 +19,20 @@
 
 fmi2_import_variable_list_t* fmi2_import_alloc_variable_list(fmi2_import_t* fmu, size_t size) {
 	jm_callbacks* cb = fmu->callbacks;
-	fmi2_import_variable_list_t* vl = (fmi2_import_variable_list_t*)cb->malloc(sizeof(fmi2_import_variable_list_t));
-    if(!vl) return 0;
-    vl->vr = 0;
-	vl->fmu = fmu;
-    if(jm_vector_init(jm_voidp)(&vl->variables,size,cb) < size) {
-        fmi2_import_free_variable_list(vl);
-        return 0;
+	jm_memory_scope_t scope;
+	fmi2_import_variable_list_t* vl;
+
+	jm_memory_scope_enter(&scope, fmu->memory, jm_memory_subsystem_variable_list);
+	vl = (fmi2_import_variable_list_t*)cb->malloc(sizeof(fmi2_import_variable_list_t));
+    if(vl) {
+        vl->vr = 0;
+        vl->fmu = fmu;
+        if(jm_vector_init(jm_voidp)(&vl->variables,size,cb) < size) {
+            fmi2_import_free_variable_list(vl);
+            vl = 0;
+        }
     }
+	jm_memory_scope_leave(&scope);
     return vl;
 }
 
@@ -49,23 +55,24 @@ size_t  fmi2_import_get_variable_list_size(fmi2_import_variable_list_t* vl) {
 
 /* Make a copy */
 fmi2_import_variable_list_t* fmi2_import_clone_variable_list(fmi2_import_variable_list_t* vl) {
-    fmi2_import_variable_list_t* copy = fmi2_import_alloc_variable_list(vl->fmu, fmi2_import_get_variable_list_size(vl));
-    if(!copy) return 0;
-    jm_vector_copy(jm_voidp)(&copy->variables, &vl->variables);
-    return copy;
+    fmi2_import_variable_list_view_t view;
+    fmi2_import_init_variable_list_view(&view, vl);
+    return fmi2_import_view_to_variable_list(&view);
 }
 
 fmi2_import_variable_list_t* fmi2_import_join_var_list(fmi2_import_variable_list_t* a, fmi2_import_variable_list_t* b) {
-    size_t asize = fmi2_import_get_variable_list_size(a);
-    size_t bsize = fmi2_import_get_variable_list_size(b);
-    size_t joinSize = asize + bsize;
-    fmi2_import_variable_list_t* list = fmi2_import_alloc_variable_list(a->fmu,joinSize);
+    fmi2_import_variable_list_view_t view;
+    fmi2_import_variable_list_t* list;
+    fmi2_import_init_variable_list_view(&view, a);
+    list = fmi2_import_view_to_variable_list(&view);
     if(!list) {
         return list;
     }
-    jm_vector_copy(jm_voidp)(&list->variables,&a->variables);
-    jm_vector_resize(jm_voidp)(&list->variables,joinSize);
-    memcpy((void*)jm_vector_get_itemp(jm_voidp)(&list->variables,asize), (void*)jm_vector_get_itemp(jm_voidp)(&b->variables,0), sizeof(jm_voidp)*bsize);
+    fmi2_import_init_variable_list_view(&view, b);
+    if(fmi2_import_var_list_append_view(list, &view) != jm_status_success) {
+        fmi2_import_free_variable_list(list);
+        return 0;
+    }
     return list;
 }
 
@@ -79,24 +86,44 @@ fmi2_import_variable_list_t* fmi2_import_create_var_list(fmi2_import_t* fmu,fmi2
 }
 
 fmi2_import_variable_list_t* fmi2_import_append_to_var_list(fmi2_import_variable_list_t* list, fmi2_import_variable_t* v) {
-    fmi2_import_variable_list_t* out = fmi2_import_alloc_variable_list(list->fmu, fmi2_import_get_variable_list_size(list)+1);
+    fmi2_import_variable_list_t* out = fmi2_import_clone_variable_list(list);
     if(!out) return 0;
-    jm_vector_copy(jm_voidp)(&out->variables,&list->variables);
-    jm_vector_push_back(jm_voidp)(&out->variables, v);
+    if(fmi2_import_var_list_push_back(out, v) != jm_status_success) {
+        fmi2_import_free_variable_list(out);
+        return 0;
+    }
     return out;
 }
 
 fmi2_import_variable_list_t* fmi2_import_prepend_to_var_list(fmi2_import_variable_list_t* list, fmi2_import_variable_t* v) {
-    size_t lsize = fmi2_import_get_variable_list_size(list);
-    fmi2_import_variable_list_t* out = fmi2_import_alloc_variable_list(list->fmu, lsize+1);
+    fmi2_import_variable_list_view_t view;
+    fmi2_import_variable_list_t* out = fmi2_import_create_var_list(list->fmu, v);
     if(!out) return 0;
-    jm_vector_set_item(jm_voidp)(&out->variables,0,v);
-    memcpy((void*)jm_vector_get_itemp(jm_voidp)(&out->variables,1), (void*)jm_vector_get_itemp(jm_voidp)(&list->variables,0), sizeof(jm_voidp)*lsize);
+    fmi2_import_init_variable_list_view(&view, list);
+    if(fmi2_import_var_list_append_view(out, &view) != jm_status_success) {
+        fmi2_import_free_variable_list(out);
+        return 0;
+    }
     return out;
 }
 
+/* The cached value references are dropped when a list is modified */
+static void fmi2_import_var_list_changed(fmi2_import_variable_list_t* vl) {
+    if(vl->vr) {
+        vl->variables.callbacks->free(vl->vr);
+        vl->vr = 0;
+    }
+}
+
 jm_status_enu_t fmi2_import_var_list_push_back(fmi2_import_variable_list_t* list, fmi2_import_variable_t* v) {
-    if(!jm_vector_push_back(jm_voidp)(&list->variables, v)) return jm_status_error;
+    jm_memory_scope_t scope;
+    jm_voidp* item;
+
+    jm_memory_scope_enter(&scope, list->fmu->memory, jm_memory_subsystem_variable_list);
+    item = jm_vector_push_back(jm_voidp)(&list->variables, v);
+    jm_memory_scope_leave(&scope);
+    if(!item) return jm_status_error;
+    fmi2_import_var_list_changed(list);
     return jm_status_success;
 }
 
@@ -105,7 +132,10 @@ const fmi2_value_reference_t* fmi2_import_get_value_referece_list(fmi2_import_va
     if(!vl->vr) {
 		jm_callbacks* cb = vl->fmu->callbacks;
         size_t i, nv = fmi2_import_get_variable_list_size(vl);
+		jm_memory_scope_t scope;
+		jm_memory_scope_enter(&scope, vl->fmu->memory, jm_memory_subsystem_variable_list);
 		vl->vr = (fmi2_value_reference_t*)cb->malloc(nv * sizeof(fmi2_value_reference_t));
+		jm_memory_scope_leave(&scope);
         if(vl->vr) {
             for(i = 0; i < nv; i++) {
 				vl->vr[i] = fmi2_xml_get_variable_vr(fmi2_import_get_variable(vl, i));
@@ -127,35 +157,174 @@ fmi2_import_variable_t* fmi2_import_get_variable(fmi2_import_variable_list_t* vl
 /* Operations on variable lists. Every operation creates a new list. */
 /* Select sub-lists */
 fmi2_import_variable_list_t* fmi2_import_get_sublist(fmi2_import_variable_list_t* vl, size_t  fromIndex, size_t  toIndex) {
-    fmi2_import_variable_list_t* out;
-    size_t size, i;
-    if(fromIndex > toIndex) return 0;
-    if(toIndex >=  fmi2_import_get_variable_list_size(vl)) return 0;
-    size = toIndex - fromIndex + 1;
-    out = fmi2_import_alloc_variable_list(vl->fmu, size);
-    if(!out ) return 0;
-    for(i=0; i < size; i++) {
-        jm_vector_set_item(jm_voidp)(&out->variables, i, jm_vector_get_item(jm_voidp)(&vl->variables, fromIndex+i));
-    }
-    return out;
+    fmi2_import_variable_list_view_t view;
+    fmi2_import_init_variable_list_view(&view, vl);
+    if(fmi2_import_init_variable_list_subview(&view, &view, fromIndex, toIndex) != jm_status_success) return 0;
+    return fmi2_import_view_to_variable_list(&view);
 }
 
 /* fmi2_import_filter_variables calls  the provided 'filter' function on every variable in the list.
   It returns a sub-list list with the variables for which filter returned non-zero value. */
 fmi2_import_variable_list_t* fmi2_import_filter_variables(fmi2_import_variable_list_t* vl, fmi2_import_variable_filter_function_ft filter, void* context) {
-    size_t nv, i;
-    fmi2_import_variable_list_t* out = fmi2_import_alloc_variable_list(vl->fmu, 0);
+    fmi2_import_variable_list_t* out = fmi2_import_clone_variable_list(vl);
 	if(!out) return 0; /* out of memory */
-    nv = fmi2_import_get_variable_list_size(vl);
-    for(i=0; i < nv;i++) {
-        fmi2_import_variable_t* variable = fmi2_import_get_variable(vl, i);
-        if(filter(variable, context))
-            if(!jm_vector_push_back(jm_voidp)(&out->variables, variable))
-                break;
-    }
-    if(i != nv) {
-        fmi2_import_free_variable_list(out);
-        out = 0;
+    fmi2_import_var_list_filter(out, filter, context);
+    return out;
+}
+
+/* Views and in-place operations */
+void fmi2_import_init_variable_list_view(fmi2_import_variable_list_view_t* view, fmi2_import_variable_list_t* vl) {
+    view->list = vl;
+    view->first = 0;
+    view->size = fmi2_import_get_variable_list_size(vl);
+}
+
+jm_status_enu_t fmi2_import_init_variable_list_subview(fmi2_import_variable_list_view_t* view, const fmi2_import_variable_list_view_t* parent, size_t fromIndex, size_t toIndex) {
+    view->list = parent->list;
+    if(fromIndex > toIndex || toIndex >= parent->size) {
+        view->first = 0;
+        view->size = 0;
+        return jm_status_error;
+    }
+    view->first = parent->first + fromIndex;
+    view->size = toIndex - fromIndex + 1;
+    return jm_status_success;
+}
+
+fmi2_import_variable_t* fmi2_import_get_view_variable(const fmi2_import_variable_list_view_t* view, size_t index) {
+    if(index >= view->size) return 0;
+    return fmi2_import_get_variable(view->list, view->first + index);
+}
+
+fmi2_import_variable_list_t* fmi2_import_view_to_variable_list(const fmi2_import_variable_list_view_t* view) {
+    fmi2_import_variable_list_t* out = fmi2_import_alloc_variable_list(view->list->fmu, view->size);
+    if(!out) return 0;
+    if(view->size) {
+        memcpy((void*)jm_vector_get_itemp(jm_voidp)(&out->variables, 0),
+            (void*)jm_vector_get_itemp(jm_voidp)(&view->list->variables, view->first), sizeof(jm_voidp)*view->size);
     }
     return out;
 }
+
+jm_status_enu_t fmi2_import_var_list_append_view(fmi2_import_variable_list_t* vl, const fmi2_import_variable_list_view_t* view) {
+    size_t oldSize = fmi2_import_get_variable_list_size(vl);
+    size_t newSize = oldSize + view->size;
+    jm_memory_scope_t scope;
+
+    if(!view->size) return jm_status_success;
+    jm_memory_scope_enter(&scope, vl->fmu->memory, jm_memory_subsystem_variable_list);
+    if(newSize > vl->variables.capacity) {
+        /* Grow geometrically so that repeated appends take linear time */
+        size_t reserve = 2 * vl->variables.capacity;
+        jm_vector_reserve(jm_voidp)(&vl->variables, (reserve < newSize) ? newSize : reserve);
+    }
+    if(jm_vector_resize(jm_voidp)(&vl->variables, newSize) != newSize) {
+        jm_vector_resize(jm_voidp)(&vl->variables, oldSize);
+        jm_memory_scope_leave(&scope);
+        return jm_status_error;
+    }
+    jm_memory_scope_leave(&scope);
+    /* The source is looked up after resizing since the view may be of the same list */
+    memcpy((void*)jm_vector_get_itemp(jm_voidp)(&vl->variables, oldSize),
+        (void*)jm_vector_get_itemp(jm_voidp)(&view->list->variables, view->first), sizeof(jm_voidp)*view->size);
+    fmi2_import_var_list_changed(vl);
+    return jm_status_success;
+}
+
+size_t fmi2_import_var_list_filter(fmi2_import_variable_list_t* vl, fmi2_import_variable_filter_function_ft filter, void* context) {
+    size_t nv = fmi2_import_get_variable_list_size(vl), i, n = 0;
+    jm_voidp* items;
+
+    if(!nv) return 0;
+    items = jm_vector_get_itemp(jm_voidp)(&vl->variables, 0);
+    for(i = 0; i < nv; i++) {
+        if(filter((fmi2_import_variable_t*)items[i], context))
+            items[n++] = items[i];
+    }
+    if(n != nv) {
+        jm_vector_resize(jm_voidp)(&vl->variables, n);
+        fmi2_import_var_list_changed(vl);
+    }
+    return n;
+}
+
+int fmi2_import_compare_variables_by_vr(fmi2_import_variable_t* a, fmi2_import_variable_t* b, void* context) {
+    fmi2_base_type_enu_t at = fmi2_import_get_variable_base_type(a);
+    fmi2_base_type_enu_t bt = fmi2_import_get_variable_base_type(b);
+    fmi2_value_reference_t avr, bvr;
+    if(at == fmi2_base_type_enum) at = fmi2_base_type_int;
+    if(bt == fmi2_base_type_enum) bt = fmi2_base_type_int;
+    if(at != bt) return (at < bt) ? -1 : 1;
+    avr = fmi2_import_get_variable_vr(a);
+    bvr = fmi2_import_get_variable_vr(b);
+    if(avr != bvr) return (avr < bvr) ? -1 : 1;
+    return 0;
+}
+
+int fmi2_import_compare_variables_by_name(fmi2_import_variable_t* a, fmi2_import_variable_t* b, void* context) {
+    return strcmp(fmi2_import_get_variable_name(a), fmi2_import_get_variable_name(b));
+}
+
+/* Merge the sorted runs src[lo, mid) and src[mid, hi) into dst[lo, hi) */
+static void fmi2_import_var_list_merge(jm_voidp* dst, jm_voidp* src, size_t lo, size_t mid, size_t hi,
+                                       fmi2_import_variable_compare_ft compare, void* context) {
+    size_t i = lo, j = mid, k = lo;
+    while(i < mid && j < hi) {
+        if(compare((fmi2_import_variable_t*)src[j], (fmi2_import_variable_t*)src[i], context) < 0)
+            dst[k++] = src[j++];
+        else
+            dst[k++] = src[i++];
+    }
+    while(i < mid) dst[k++] = src[i++];
+    while(j < hi) dst[k++] = src[j++];
+}
+
+jm_status_enu_t fmi2_import_var_list_sort(fmi2_import_variable_list_t* vl, fmi2_import_variable_compare_ft compare, void* context) {
+    size_t nv = fmi2_import_get_variable_list_size(vl), width, lo;
+    jm_callbacks* cb = vl->variables.callbacks;
+    jm_memory_scope_t scope;
+    jm_voidp *items, *tmp, *src, *dst, *swap;
+
+    if(nv < 2) return jm_status_success;
+    jm_memory_scope_enter(&scope, vl->fmu->memory, jm_memory_subsystem_variable_list);
+    tmp = (jm_voidp*)cb->malloc(nv * sizeof(jm_voidp));
+    jm_memory_scope_leave(&scope);
+    if(!tmp) return jm_status_error;
+    /* Bottom-up merge sort alternating between the list and the temporary array */
+    items = jm_vector_get_itemp(jm_voidp)(&vl->variables, 0);
+    src = items;
+    dst = tmp;
+    for(width = 1; width < nv; width *= 2) {
+        for(lo = 0; lo < nv; lo += 2 * width) {
+            size_t mid = (lo + width < nv) ? lo + width : nv;
+            size_t hi = (lo + 2 * width < nv) ? lo + 2 * width : nv;
+            fmi2_import_var_list_merge(dst, src, lo, mid, hi, compare, context);
+        }
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+    if(src != items) {
+        memcpy(items, src, nv * sizeof(jm_voidp));
+    }
+    cb->free(tmp);
+    fmi2_import_var_list_changed(vl);
+    return jm_status_success;
+}
+
+size_t fmi2_import_var_list_unique(fmi2_import_variable_list_t* vl) {
+    size_t nv = fmi2_import_get_variable_list_size(vl), i, n = 1;
+    jm_voidp* items;
+
+    if(nv < 2) return nv;
+    items = jm_vector_get_itemp(jm_voidp)(&vl->variables, 0);
+    for(i = 1; i < nv; i++) {
+        if(items[i] != items[n - 1])
+            items[n++] = items[i];
+    }
+    if(n != nv) {
+        jm_vector_resize(jm_voidp)(&vl->variables, n);
+        fmi2_import_var_list_changed(vl);
+    }
+    return n;
+}
@@ -0,0 +1,155 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+
+#include <JM/jm_thread_pool.h>
+#include <FMI2/fmi2_import_warm_start.h>
+#include "fmi2_import_impl.h"
+
+static const char* module = "FMILIB";
+
+typedef struct fmi2_warm_start_task_t {
+	fmi2_import_t* fmu;
+	size_t index;
+	const char* instanceName;
+	char defaultName[32];
+	fmi2_type_t fmuType;
+	const fmi2_byte_t* data;
+	size_t size;
+	fmi2_import_warm_start_override_ft override;
+	void* userData;
+	jm_status_enu_t status;
+} fmi2_warm_start_task_t;
+
+static int fmi2_import_warm_start_supported(fmi2_import_t* fmu) {
+	fmi2_fmu_kind_enu_t kind = fmi2_import_get_fmu_kind(fmu);
+	if((kind == fmi2_fmu_kind_me || kind == fmi2_fmu_kind_me_and_cs) && fmi2_import_get_capability(fmu, fmi2_me_canSerializeFMUstate))
+		return 1;
+	if((kind == fmi2_fmu_kind_cs || kind == fmi2_fmu_kind_me_and_cs) && fmi2_import_get_capability(fmu, fmi2_cs_canSerializeFMUstate))
+		return 1;
+	return 0;
+}
+
+static void fmi2_warm_start_run(jm_thread_pool_t* pool, size_t worker, void* data) {
+	fmi2_warm_start_task_t* task = (fmi2_warm_start_task_t*)data;
+	fmi2_import_t* fmu = task->fmu;
+	fmi2_FMU_state_t state = 0;
+	fmi2_status_t fmiStatus;
+
+	if(fmi2_import_instantiate(fmu, task->instanceName, task->fmuType, 0, fmi2_false) != jm_status_success) {
+		jm_log_error(fmu->callbacks, module, "Could not instantiate %s", task->instanceName);
+		return;
+	}
+	fmiStatus = fmi2_import_de_serialize_fmu_state(fmu, task->data, task->size, &state);
+	if(fmiStatus == fmi2_status_ok || fmiStatus == fmi2_status_warning) {
+		fmiStatus = fmi2_import_set_fmu_state(fmu, state);
+		fmi2_import_free_fmu_state(fmu, &state);
+	}
+	if(fmiStatus != fmi2_status_ok && fmiStatus != fmi2_status_warning) {
+		jm_log_error(fmu->callbacks, module, "Could not restore the initialized state into %s", task->instanceName);
+		fmi2_import_free_instance(fmu);
+		return;
+	}
+	if(task->override && task->override(fmu, task->index, task->userData) != jm_status_success) {
+		jm_log_error(fmu->callbacks, module, "Applying the overrides of %s failed", task->instanceName);
+		fmi2_import_free_instance(fmu);
+		return;
+	}
+	task->status = jm_status_success;
+}
+
+jm_status_enu_t fmi2_import_warm_start(fmi2_import_t* source, fmi2_import_t** targets, size_t numTargets,
+	const char* const* instanceNames, size_t numThreads, fmi2_import_warm_start_override_ft override, void* userData) {
+	jm_callbacks* cb = source->callbacks;
+	fmi2_warm_start_task_t* tasks;
+	jm_thread_pool_t* pool;
+	fmi2_FMU_state_t state = 0;
+	fmi2_byte_t* data = 0;
+	size_t size = 0, i, failed = 0;
+	fmi2_status_t fmiStatus;
+	fmi2_type_t fmuType;
+
+	if(!fmi2_import_warm_start_supported(source)) {
+		jm_log_error(cb, module, "The FMU does not support serialization of the FMU state");
+		return jm_status_error;
+	}
+	for(i = 0; i < numTargets; i++) {
+		if(!targets[i]->capi) {
+			jm_log_error(cb, module, "The DLL of target %u is not loaded", (unsigned)i);
+			return jm_status_error;
+		}
+	}
+	if(numTargets == 0) return jm_status_success;
+	fmuType = (fmi2_capi_get_fmu_kind(source->capi) == fmi2_fmu_kind_cs) ? fmi2_cosimulation : fmi2_model_exchange;
+
+	/* Serialize the initialized state once */
+	fmiStatus = fmi2_import_get_fmu_state(source, &state);
+	if(fmiStatus == fmi2_status_ok || fmiStatus == fmi2_status_warning)
+		fmiStatus = fmi2_import_serialized_fmu_state_size(source, state, &size);
+	if(fmiStatus == fmi2_status_ok || fmiStatus == fmi2_status_warning) {
+		data = (fmi2_byte_t*)cb->malloc(size ? size : 1);
+		fmiStatus = data ? fmi2_import_serialize_fmu_state(source, state, data, size) : fmi2_status_fatal;
+	}
+	if(state) fmi2_import_free_fmu_state(source, &state);
+	if(fmiStatus != fmi2_status_ok && fmiStatus != fmi2_status_warning) {
+		jm_log_error(cb, module, "Could not serialize the state of the source FMU");
+		cb->free(data);
+		return jm_status_error;
+	}
+
+	tasks = (fmi2_warm_start_task_t*)cb->calloc(numTargets, sizeof(fmi2_warm_start_task_t));
+	pool = tasks ? jm_thread_pool_create(cb, numThreads) : 0;
+	if(!pool) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		cb->free(tasks);
+		cb->free(data);
+		return jm_status_error;
+	}
+	/* The tasks that are not submitted count as failed */
+	for(i = 0; i < numTargets; i++) tasks[i].status = jm_status_error;
+	for(i = 0; i < numTargets; i++) {
+		fmi2_warm_start_task_t* task = &tasks[i];
+		task->fmu = targets[i];
+		task->index = i;
+		if(instanceNames && instanceNames[i]) {
+			task->instanceName = instanceNames[i];
+		}
+		else {
+			sprintf(task->defaultName, "instance_%u", (unsigned)i); /*safe*/
+			task->instanceName = task->defaultName;
+		}
+		task->fmuType = fmuType;
+		task->data = data;
+		task->size = size;
+		task->override = override;
+		task->userData = userData;
+		if(jm_thread_pool_submit(pool, fmi2_warm_start_run, task) != jm_status_success)
+			break;
+	}
+	jm_thread_pool_wait(pool);
+	jm_thread_pool_free(pool);
+
+	for(i = 0; i < numTargets; i++) {
+		if(tasks[i].status != jm_status_success) failed++;
+	}
+	if(failed)
+		jm_log_error(cb, module, "Warm start failed for %u of %u instances", (unsigned)failed, (unsigned)numTargets);
+	else
+		jm_log_verbose(cb, module, "Warm started %u instances from a state of %u bytes", (unsigned)numTargets, (unsigned)size);
+	cb->free(tasks);
+	cb->free(data);
+	return failed ? jm_status_error : jm_status_success;
+}
@@ -104,6 +104,57 @@ typedef enum fmi1_base_type_enu_t
 	*/
 FMILIB_EXPORT const char* fmi1_base_type_to_string(fmi1_base_type_enu_t bt);
 
+/** \brief List of the FMI functions of a model or slave instance */
+#define FMI1_FUNCTIONS(H) \
+	H(SetDebugLogging) \
+	H(GetReal) \
+	H(GetInteger) \
+	H(GetBoolean) \
+	H(GetString) \
+	H(SetReal) \
+	H(SetInteger) \
+	H(SetBoolean) \
+	H(SetString) \
+	H(InstantiateModel) \
+	H(FreeModelInstance) \
+	H(Initialize) \
+	H(SetTime) \
+	H(SetContinuousStates) \
+	H(CompletedIntegratorStep) \
+	H(GetDerivatives) \
+	H(GetEventIndicators) \
+	H(EventUpdate) \
+	H(GetContinuousStates) \
+	H(GetNominalContinuousStates) \
+	H(GetStateValueReferences) \
+	H(Terminate) \
+	H(InstantiateSlave) \
+	H(FreeSlaveInstance) \
+	H(InitializeSlave) \
+	H(TerminateSlave) \
+	H(ResetSlave) \
+	H(SetRealInputDerivatives) \
+	H(GetRealOutputDerivatives) \
+	H(DoStep) \
+	H(CancelStep) \
+	H(GetStatus) \
+	H(GetRealStatus) \
+	H(GetIntegerStatus) \
+	H(GetBooleanStatus) \
+	H(GetStringStatus)
+
+/** \brief FMI functions of an instance, e.g., fmi1_function_GetReal for fmiGetReal */
+typedef enum fmi1_function_enu_t {
+#define FMI1_EXPAND_FUNCTION_ENU(f) fmi1_function_ ## f,
+	FMI1_FUNCTIONS(FMI1_EXPAND_FUNCTION_ENU)
+	fmi1_functions_Num
+} fmi1_function_enu_t;
+
+/** \brief Convert an FMI function ID to the function name without model identifier prefix, e.g., "fmiGetReal"
+	\return Name of the function or Unknown if the id is out of range.
+*/
+FMILIB_EXPORT const char* fmi1_function_to_string(fmi1_function_enu_t id);
+
 /**	
  @}
 */
@@ -212,6 +212,63 @@ typedef enum fmi2_dependency_factor_kind_enu_t
 	\return Corresponding factor kind as string.
 	*/
 FMILIB_EXPORT const char* fmi2_dependency_factor_kind_to_string(fmi2_dependency_factor_kind_enu_t fc);
+
+/** \brief List of the FMI functions of a component, in the order of the standard */
+#define FMI2_FUNCTIONS(H) \
+	H(SetDebugLogging) \
+	H(Instantiate) \
+	H(FreeInstance) \
+	H(SetupExperiment) \
+	H(EnterInitializationMode) \
+	H(ExitInitializationMode) \
+	H(Terminate) \
+	H(Reset) \
+	H(GetReal) \
+	H(GetInteger) \
+	H(GetBoolean) \
+	H(GetString) \
+	H(SetReal) \
+	H(SetInteger) \
+	H(SetBoolean) \
+	H(SetString) \
+	H(GetFMUstate) \
+	H(SetFMUstate) \
+	H(FreeFMUstate) \
+	H(SerializedFMUstateSize) \
+	H(SerializeFMUstate) \
+	H(DeSerializeFMUstate) \
+	H(GetDirectionalDerivative) \
+	H(EnterEventMode) \
+	H(NewDiscreteStates) \
+	H(EnterContinuousTimeMode) \
+	H(CompletedIntegratorStep) \
+	H(SetTime) \
+	H(SetContinuousStates) \
+	H(GetDerivatives) \
+	H(GetEventIndicators) \
+	H(GetContinuousStates) \
+	H(GetNominalsOfContinuousStates) \
+	H(SetRealInputDerivatives) \
+	H(GetRealOutputDerivatives) \
+	H(DoStep) \
+	H(CancelStep) \
+	H(GetStatus) \
+	H(GetRealStatus) \
+	H(GetIntegerStatus) \
+	H(GetBooleanStatus) \
+	H(GetStringStatus)
+
+/** \brief FMI functions of a component, e.g., fmi2_function_GetReal for fmi2GetReal */
+typedef enum fmi2_function_enu_t {
+#define FMI2_EXPAND_FUNCTION_ENU(f) fmi2_function_ ## f,
+	FMI2_FUNCTIONS(FMI2_EXPAND_FUNCTION_ENU)
+	fmi2_functions_Num
+} fmi2_function_enu_t;
+
+/** \brief Convert an FMI function ID to the function name, e.g., "fmi2GetReal"
+	\return Name of the function or Unknown if the id is out of range.
+*/
+FMILIB_EXPORT const char* fmi2_function_to_string(fmi2_function_enu_t id);
 /**	
  @}
 */
@@ -0,0 +1,72 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef JM_CALL_STATISTICS_H_
+#define JM_CALL_STATISTICS_H_
+
+#include <stddef.h>
+#include "jm_callbacks.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/** \file jm_call_statistics.h
+	Monotonic clock and function call timing statistics.
+*/
+/**
+	\addtogroup jm_utils
+	@{
+		\addtogroup jm_call_statistics
+	@}
+*/
+/** \addtogroup jm_call_statistics Call timing statistics
+	Statistics on the duration of the calls of a function. They are collected for every
+	FMI function of an FMU instance if the library is configured with
+	FMILIB_ENABLE_CALL_STATISTICS.
+@{*/
+
+/** \brief Number of bins of the latency histogram */
+#define JM_CALL_STATISTICS_BINS 32
+
+/** \brief Statistics on the calls of one function */
+typedef struct jm_call_statistics_t {
+	/** \brief Number of calls */
+	size_t count;
+	/** \brief Total time spent in the calls in seconds */
+	double total_time;
+	/** \brief Duration of the longest call in seconds */
+	double max_time;
+	/** \brief Latency histogram. Bin k counts the calls that took from 2^k up to 2^(k+1)
+		nanoseconds. Bin 0 includes shorter calls and the last bin all longer calls. */
+	size_t histogram[JM_CALL_STATISTICS_BINS];
+} jm_call_statistics_t;
+
+/** \brief Get the time in seconds of a monotonic clock with an arbitrary origin */
+FMILIB_EXPORT
+double jm_get_monotonic_time(void);
+
+/** \brief Add a call with the given duration in seconds */
+FMILIB_EXPORT
+void jm_call_statistics_add(jm_call_statistics_t* stats, double duration);
+
+/** \brief Log the statistics of a function as one info message */
+FMILIB_EXPORT
+void jm_call_statistics_log(jm_callbacks* cb, const char* module, const char* function, const jm_call_statistics_t* stats);
+
+/*@}*/
+#ifdef __cplusplus
+}
+#endif
+#endif /* JM_CALL_STATISTICS_H_ */
@@ -0,0 +1,156 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef JM_LOG_SINK_H_
+#define JM_LOG_SINK_H_
+
+#include <stddef.h>
+#include "jm_callbacks.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/** \file jm_log_sink.h
+	Asynchronous delivery of log messages.
+*/
+/**
+	\addtogroup jm_utils
+	@{
+		\addtogroup jm_log_sink
+	@}
+*/
+/** \addtogroup jm_log_sink Asynchronous log sink
+	A log sink decouples the threads that produce log messages from the logger that
+	consumes them. A producer copies a formatted message into a bounded ring buffer and
+	returns; a background thread takes the queued messages in batches and hands them to
+	a delivery function, typically ending in the \c logger of a ::jm_callbacks struct.
+
+	The ring holds a fixed number of messages. What happens when it is full is decided
+	by the ::jm_log_sink_policy_enu_t of the sink. The text buffers of the ring entries
+	grow to the longest message seen and are reused, so that after a warm-up posting
+	does not allocate memory.
+
+	Messages of one producer thread are delivered in the order they were posted.
+	Messages posted from the delivery thread itself (e.g., by a logger that logs) are
+	delivered immediately.
+@{*/
+
+/** \brief Opaque log sink */
+typedef struct jm_log_sink_t jm_log_sink_t;
+
+/** \brief What to do when a message is posted to a full sink */
+typedef enum jm_log_sink_policy_enu_t {
+	/** \brief The producer waits until there is space (backpressure) */
+	jm_log_sink_policy_block = 0,
+	/** \brief The new message is dropped */
+	jm_log_sink_policy_drop_newest,
+	/** \brief The oldest queued message is dropped to make space for the new one */
+	jm_log_sink_policy_drop_oldest
+} jm_log_sink_policy_enu_t;
+
+/** \brief Convert a ::jm_log_sink_policy_enu_t to a string */
+FMILIB_EXPORT
+const char* jm_log_sink_policy_to_string(jm_log_sink_policy_enu_t policy);
+
+/**
+	\brief Delivery function called on the background thread.
+	\param target The pointer given to jm_log_sink_post().
+	\param module Module name given to jm_log_sink_post().
+	\param log_level Log level of the message.
+	\param message The message.
+*/
+typedef void (*jm_log_sink_deliver_ft)(void* target, jm_string module, jm_log_level_enu_t log_level, jm_string message);
+
+/** \brief Counters of a log sink */
+typedef struct jm_log_sink_statistics_t {
+	/** \brief Number of messages posted, including the dropped ones */
+	size_t posted;
+	/** \brief Number of messages handed to the delivery functions */
+	size_t delivered;
+	/** \brief Number of messages dropped because the sink was full or out of memory */
+	size_t dropped;
+	/** \brief Number of times a producer had to wait for space */
+	size_t blocked;
+	/** \brief Number of batches taken by the background thread */
+	size_t batches;
+	/** \brief Largest number of messages queued at the same time */
+	size_t max_queued;
+} jm_log_sink_statistics_t;
+
+/**
+	\brief Create a log sink and start its background thread.
+	\param cb Callbacks for memory allocation and for logging errors of the sink itself. Default callbacks are used if NULL.
+	\param capacity Maximum number of queued messages. 0 means a default of 1024.
+	\param policy Behavior when the sink is full.
+	\return A sink or NULL on error. Must be freed with jm_log_sink_free().
+*/
+FMILIB_EXPORT
+jm_log_sink_t* jm_log_sink_create(jm_callbacks* cb, size_t capacity, jm_log_sink_policy_enu_t policy);
+
+/** \brief Deliver all queued messages, stop the background thread and free the sink */
+FMILIB_EXPORT
+void jm_log_sink_free(jm_log_sink_t* sink);
+
+/**
+	\brief Queue a message for delivery. The strings are copied.
+	\param sink The sink.
+	\param deliver Function that delivers the message on the background thread.
+	\param target Pointer passed on to the delivery function. Must stay valid until the message is delivered, see jm_log_sink_flush().
+	\param module Module name, may be NULL.
+	\param log_level Log level of the message.
+	\param message The message.
+	\return ::jm_status_success if the message was queued or delivered, ::jm_status_warning if it was dropped.
+*/
+FMILIB_EXPORT
+jm_status_enu_t jm_log_sink_post(jm_log_sink_t* sink, jm_log_sink_deliver_ft deliver, void* target,
+								 jm_string module, jm_log_level_enu_t log_level, jm_string message);
+
+/** \brief Block until all the messages posted so far have been delivered. Returns immediately on the delivery thread. */
+FMILIB_EXPORT
+void jm_log_sink_flush(jm_log_sink_t* sink);
+
+/** \brief Get a copy of the counters of a sink */
+FMILIB_EXPORT
+void jm_log_sink_get_statistics(jm_log_sink_t* sink, jm_log_sink_statistics_t* stats);
+
+/** \brief Callbacks that send the log messages through a sink, see jm_log_sink_wrap_callbacks() */
+typedef struct jm_log_sink_callbacks_t {
+	/** \brief The callbacks to hand to the library. Must be the first member. */
+	jm_callbacks callbacks;
+	/** \brief Callbacks that receive the messages */
+	jm_callbacks* parent;
+	jm_log_sink_t* sink;
+} jm_log_sink_callbacks_t;
+
+/**
+	\brief Set up callbacks that allocate memory with the parent callbacks and pass
+	log messages to the parent logger through a sink.
+
+	The returned callbacks can be given to fmi_import_allocate_context(), so that the
+	messages of the library are delivered asynchronously. The log level and the context
+	are copied from the parent.
+	\param sink The sink. Must outlive the use of the callbacks.
+	\param parent Callbacks that receive the messages on the background thread.
+	\param wrapper Storage for the callbacks. Must stay valid while the callbacks are in use.
+	\return A pointer to wrapper->callbacks.
+*/
+FMILIB_EXPORT
+jm_callbacks* jm_log_sink_wrap_callbacks(jm_log_sink_t* sink, jm_callbacks* parent, jm_log_sink_callbacks_t* wrapper);
+
+/*@}*/
+#ifdef __cplusplus
+}
+#endif
+#endif /* JM_LOG_SINK_H_ */
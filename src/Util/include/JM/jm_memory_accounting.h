@@ -0,0 +1,138 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef JM_MEMORY_ACCOUNTING_H_
+#define JM_MEMORY_ACCOUNTING_H_
+
+#include <stddef.h>
+#include "jm_callbacks.h"
+#include "jm_thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/** \file jm_memory_accounting.h
+	Memory accounting wrapper around ::jm_callbacks.
+*/
+/**
+	\addtogroup jm_utils
+	@{
+		\addtogroup jm_memory_accounting
+	@}
+*/
+/** \addtogroup jm_memory_accounting Memory accounting
+	An accounting record provides a ::jm_callbacks struct that forwards to a parent
+	struct and keeps track of the allocated memory. Every block carries a small header
+	that records its size and owner.
+
+	Since the memory callbacks take no context argument, allocations are attributed
+	with scopes: between jm_memory_scope_enter() and jm_memory_scope_leave() the new
+	blocks allocated by the calling thread through any accounting callbacks are
+	charged to the subsystem of the record of the scope. Blocks allocated outside of a
+	scope are taken from the parent of the called callbacks and are not counted. A block
+	keeps its owner when it is reallocated or released, regardless of the active scope.
+@{*/
+
+/** \brief Library subsystems the memory is attributed to */
+typedef enum jm_memory_subsystem_enu_t {
+	jm_memory_subsystem_other = 0,
+	jm_memory_subsystem_xml_model,
+	jm_memory_subsystem_variable_list,
+	jm_memory_subsystem_capi,
+	jm_memory_subsystem_log,
+	/** \brief Sum over all the subsystems */
+	jm_memory_subsystem_total
+} jm_memory_subsystem_enu_t;
+
+/** \brief Number of entries in the usage table of an accounting record */
+#define JM_MEMORY_SUBSYSTEMS_NUM (jm_memory_subsystem_total + 1)
+
+/** \brief Memory usage of one subsystem */
+typedef struct jm_memory_usage_t {
+	/** \brief Bytes currently allocated (excluding the block headers) */
+	size_t live_bytes;
+	/** \brief Highest value of live_bytes */
+	size_t peak_bytes;
+	/** \brief Number of allocated blocks (reallocations are not counted) */
+	size_t allocations;
+	/** \brief Number of released blocks */
+	size_t frees;
+} jm_memory_usage_t;
+
+/** \brief Accounting record */
+typedef struct jm_memory_accounting_t {
+	/** \brief Callbacks to use instead of the parent ones */
+	jm_callbacks callbacks;
+	/** \brief Callbacks that provide the memory and receive the log messages */
+	jm_callbacks* parent;
+	/** \brief Usage per subsystem, indexed by ::jm_memory_subsystem_enu_t */
+	jm_memory_usage_t usage[JM_MEMORY_SUBSYSTEMS_NUM];
+	jm_mutex_t lock;
+} jm_memory_accounting_t;
+
+/** \brief Active attribution scope of a thread. Allocated by the caller, typically on the stack. */
+typedef struct jm_memory_scope_t {
+	jm_memory_accounting_t* accounting;
+	jm_memory_subsystem_enu_t subsystem;
+	struct jm_memory_scope_t* previous;
+} jm_memory_scope_t;
+
+/**
+	\brief Initialize an accounting record.
+
+	The logger and log level of the accounting callbacks are taken from the parent and
+	the log messages are forwarded to it.
+	\param accounting Record to initialize. Must not be moved while in use.
+	\param parent Callbacks to wrap. At most 16 different parents can be used by the live records.
+	\return The accounting callbacks or NULL if the record could not be initialized, e.g., because
+		16 other parents are in use. The caller may then use the parent callbacks directly.
+*/
+FMILIB_EXPORT
+jm_callbacks* jm_memory_accounting_init(jm_memory_accounting_t* accounting, jm_callbacks* parent);
+
+/** \brief Release the resources of an accounting record. All its blocks must be released before. */
+FMILIB_EXPORT
+void jm_memory_accounting_destroy(jm_memory_accounting_t* accounting);
+
+/** \brief Get a consistent copy of the usage of a subsystem */
+FMILIB_EXPORT
+void jm_memory_accounting_get_usage(jm_memory_accounting_t* accounting, jm_memory_subsystem_enu_t subsystem, jm_memory_usage_t* usage);
+
+/** \brief Log the usage of all the subsystems as info messages */
+FMILIB_EXPORT
+void jm_memory_accounting_log(jm_memory_accounting_t* accounting, jm_callbacks* cb, const char* module);
+
+/**
+	\brief Attribute the following allocations of the calling thread to a subsystem.
+
+	Scopes nest and must be left in the reverse order. Passing a NULL record is allowed
+	and makes the call a no-op, as does the matching jm_memory_scope_leave().
+*/
+FMILIB_EXPORT
+void jm_memory_scope_enter(jm_memory_scope_t* scope, jm_memory_accounting_t* accounting, jm_memory_subsystem_enu_t subsystem);
+
+/** \brief Leave a scope entered with jm_memory_scope_enter() */
+FMILIB_EXPORT
+void jm_memory_scope_leave(jm_memory_scope_t* scope);
+
+/** \brief Convert a subsystem into a string */
+FMILIB_EXPORT
+const char* jm_memory_subsystem_to_string(jm_memory_subsystem_enu_t subsystem);
+
+/*@}*/
+#ifdef __cplusplus
+}
+#endif
+#endif /* JM_MEMORY_ACCOUNTING_H_ */
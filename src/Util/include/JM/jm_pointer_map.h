@@ -0,0 +1,104 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef JM_POINTER_MAP_H_
+#define JM_POINTER_MAP_H_
+
+#include <stddef.h>
+#include "jm_callbacks.h"
+#include "jm_thread.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/** \file jm_pointer_map.h
+	Concurrent hash map with pointer keys.
+*/
+/**
+	\addtogroup jm_utils
+	@{
+		\addtogroup jm_pointer_map
+	@}
+*/
+/** \addtogroup jm_pointer_map Concurrent pointer map
+	Hash map from non-NULL pointers to pointers that may be used from several threads.
+	The keys are spread over ::JM_POINTER_MAP_STRIPES independent open addressing tables,
+	each protected by its own mutex, so that operations on different keys rarely contend.
+	Every operation takes expected constant time.
+@{*/
+
+/** \brief Number of independently locked tables */
+#define JM_POINTER_MAP_STRIPES 64
+
+/** \brief Map entry. An entry with a NULL key is empty. */
+typedef struct jm_pointer_map_entry_t {
+	const void* key;
+	void* value;
+} jm_pointer_map_entry_t;
+
+/** \brief Table of one stripe */
+typedef struct jm_pointer_map_stripe_t {
+	jm_mutex_t lock;
+	size_t size;
+	/** \brief Zero or a power of two */
+	size_t capacity;
+	jm_pointer_map_entry_t* entries;
+} jm_pointer_map_stripe_t;
+
+/** \brief Pointer map */
+typedef struct jm_pointer_map_t {
+	jm_callbacks* callbacks;
+	jm_pointer_map_stripe_t stripes[JM_POINTER_MAP_STRIPES];
+} jm_pointer_map_t;
+
+/**
+	\brief Initialize an empty map. No memory is allocated until the first insertion.
+	\param map Map to initialize. Must not be moved while in use.
+	\param cb Callbacks for the memory of the tables. NULL means jm_get_default_callbacks().
+*/
+FMILIB_EXPORT
+jm_status_enu_t jm_pointer_map_init(jm_pointer_map_t* map, jm_callbacks* cb);
+
+/** \brief Release the memory and the mutexes of a map */
+FMILIB_EXPORT
+void jm_pointer_map_destroy(jm_pointer_map_t* map);
+
+/** \brief Add a key or replace its value. Returns ::jm_status_error if the memory could not be allocated. */
+FMILIB_EXPORT
+jm_status_enu_t jm_pointer_map_insert(jm_pointer_map_t* map, const void* key, void* value);
+
+/** \brief Get the value of a key or NULL if the key is not in the map */
+FMILIB_EXPORT
+void* jm_pointer_map_find(jm_pointer_map_t* map, const void* key);
+
+/**
+	\brief Remove a key if it is mapped to the given value.
+
+	Checking the value lets the owner of an entry remove it without disturbing an entry
+	that another thread has added for the same key in the meantime.
+	\return Non-zero if the entry was removed.
+*/
+FMILIB_EXPORT
+int jm_pointer_map_remove(jm_pointer_map_t* map, const void* key, void* value);
+
+/** \brief Get the number of entries. The result may be outdated when other threads modify the map. */
+FMILIB_EXPORT
+size_t jm_pointer_map_get_size(jm_pointer_map_t* map);
+
+/*@}*/
+#ifdef __cplusplus
+}
+#endif
+#endif /* JM_POINTER_MAP_H_ */
@@ -0,0 +1,84 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef JM_SPILL_FILE_H_
+#define JM_SPILL_FILE_H_
+
+#include "jm_callbacks.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/** \file jm_spill_file.h
+	Append-only temporary file that is read through a memory mapping.
+*/
+/**
+	\addtogroup jm_utils
+	@{
+		\addtogroup jm_spill_file
+	@}
+*/
+/** \addtogroup jm_spill_file Memory mapped spill file
+	A temporary file for data that does not fit in memory. Data is appended with
+	jm_spill_file_append() and read back in place with jm_spill_file_map().
+	The file is removed when it is freed (or when the process exits).
+@{*/
+
+/** \brief Opaque spill file */
+typedef struct jm_spill_file_t jm_spill_file_t;
+
+/**
+	\brief Create an empty temporary file.
+	\param cb Callbacks for memory allocation and logging. Default callbacks are used if NULL.
+	\param dir Directory for the file. The system temporary directory is used if NULL.
+	\return A spill file or NULL on error. Must be freed with jm_spill_file_free().
+*/
+FMILIB_EXPORT
+jm_spill_file_t* jm_spill_file_create(jm_callbacks* cb, const char* dir);
+
+/** \brief Unmap, close and remove the file */
+FMILIB_EXPORT
+void jm_spill_file_free(jm_spill_file_t* file);
+
+/**
+	\brief Append data at the end of the file.
+	\param file A spill file.
+	\param data Data to write.
+	\param size Number of bytes.
+	\param offset Outputs the offset of the data in the file.
+	\return ::jm_status_success or ::jm_status_error.
+*/
+FMILIB_EXPORT
+jm_status_enu_t jm_spill_file_append(jm_spill_file_t* file, const void* data, size_t size, size_t* offset);
+
+/**
+	\brief Get a read-only pointer to data in the file.
+
+	The file is remapped if the range is not covered by the current mapping. The pointer
+	is valid until the next call to jm_spill_file_map() or jm_spill_file_free().
+	\return Pointer to the data or NULL on error.
+*/
+FMILIB_EXPORT
+const void* jm_spill_file_map(jm_spill_file_t* file, size_t offset, size_t size);
+
+/** \brief Get the number of bytes written to the file */
+FMILIB_EXPORT
+size_t jm_spill_file_get_size(jm_spill_file_t* file);
+
+/*@}*/
+#ifdef __cplusplus
+}
+#endif
+#endif /* JM_SPILL_FILE_H_ */
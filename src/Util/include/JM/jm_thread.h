@@ -0,0 +1,166 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef JM_THREAD_H_
+#define JM_THREAD_H_
+#include <fmilib_config.h>
+
+#if defined(_MSC_VER) || defined(WIN32) || defined(__MINGW32__)
+#include <windows.h>
+#define JM_THREAD_WIN32
+#else
+#include <pthread.h>
+#endif
+
+#include "jm_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/** \file jm_thread.h
+	Portable threads, mutexes and condition variables.
+*/
+/**
+	\addtogroup jm_utils
+	@{
+		\addtogroup jm_thread
+	@}
+*/
+/** \addtogroup jm_thread Threads and synchronization primitives
+	Thin wrappers around POSIX threads or the Win32 API. The objects are
+	allocated by the caller and must not be copied after initialization.
+@{*/
+
+/** \brief Storage class specifier of variables with one instance per thread */
+#ifdef _MSC_VER
+#define JM_THREAD_LOCAL __declspec(thread)
+#else
+#define JM_THREAD_LOCAL __thread
+#endif
+
+/** \brief Thread entry function */
+typedef void (*jm_thread_func_ft)(void* arg);
+
+/** \brief Thread handle */
+typedef struct jm_thread_t {
+#ifdef JM_THREAD_WIN32
+	HANDLE handle;
+#else
+	pthread_t handle;
+#endif
+	jm_thread_func_ft func;
+	void* arg;
+} jm_thread_t;
+
+/** \brief Mutex */
+typedef struct jm_mutex_t {
+#ifdef JM_THREAD_WIN32
+	CRITICAL_SECTION cs;
+#else
+	pthread_mutex_t mutex;
+#endif
+} jm_mutex_t;
+
+/** \brief Condition variable */
+typedef struct jm_cond_t {
+#ifdef JM_THREAD_WIN32
+	CONDITION_VARIABLE cond;
+#else
+	pthread_cond_t cond;
+#endif
+} jm_cond_t;
+
+/** \brief One-time initialization flag, to be initialized statically with ::JM_ONCE_INIT */
+typedef struct jm_once_t {
+#ifdef JM_THREAD_WIN32
+	INIT_ONCE once;
+#else
+	pthread_once_t once;
+#endif
+} jm_once_t;
+
+/** \brief Static initializer of ::jm_once_t */
+#ifdef JM_THREAD_WIN32
+#define JM_ONCE_INIT { INIT_ONCE_STATIC_INIT }
+#else
+#define JM_ONCE_INIT { PTHREAD_ONCE_INIT }
+#endif
+
+/** \brief Function called by jm_once() */
+typedef void (*jm_once_func_ft)(void);
+
+/**
+	\brief Start a new thread.
+	\param thread Handle to initialize. Must stay valid until jm_thread_join() returns.
+	\param func Function to run in the thread.
+	\param arg Argument passed to func.
+	\return ::jm_status_success or ::jm_status_error.
+*/
+FMILIB_EXPORT
+jm_status_enu_t jm_thread_create(jm_thread_t* thread, jm_thread_func_ft func, void* arg);
+
+/** \brief Wait for a thread to finish and release its resources */
+FMILIB_EXPORT
+jm_status_enu_t jm_thread_join(jm_thread_t* thread);
+
+/** \brief Get the number of processors available to the process (at least 1) */
+FMILIB_EXPORT
+size_t jm_thread_get_number_of_processors(void);
+
+/** \brief Call func exactly once per flag. Concurrent callers wait until the first call has returned. */
+FMILIB_EXPORT
+void jm_once(jm_once_t* once, jm_once_func_ft func);
+
+/** \brief Initialize a mutex */
+FMILIB_EXPORT
+jm_status_enu_t jm_mutex_init(jm_mutex_t* mutex);
+
+/** \brief Release the resources of a mutex */
+FMILIB_EXPORT
+void jm_mutex_destroy(jm_mutex_t* mutex);
+
+/** \brief Lock a mutex */
+FMILIB_EXPORT
+void jm_mutex_lock(jm_mutex_t* mutex);
+
+/** \brief Unlock a mutex */
+FMILIB_EXPORT
+void jm_mutex_unlock(jm_mutex_t* mutex);
+
+/** \brief Initialize a condition variable */
+FMILIB_EXPORT
+jm_status_enu_t jm_cond_init(jm_cond_t* cond);
+
+/** \brief Release the resources of a condition variable */
+FMILIB_EXPORT
+void jm_cond_destroy(jm_cond_t* cond);
+
+/** \brief Atomically unlock the mutex and wait for the condition. The mutex is locked again on return. */
+FMILIB_EXPORT
+void jm_cond_wait(jm_cond_t* cond, jm_mutex_t* mutex);
+
+/** \brief Wake up one thread waiting for the condition */
+FMILIB_EXPORT
+void jm_cond_signal(jm_cond_t* cond);
+
+/** \brief Wake up all threads waiting for the condition */
+FMILIB_EXPORT
+void jm_cond_broadcast(jm_cond_t* cond);
+
+/*@}*/
+#ifdef __cplusplus
+}
+#endif
+#endif /* JM_THREAD_H_ */
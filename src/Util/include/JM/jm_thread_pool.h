@@ -0,0 +1,98 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef JM_THREAD_POOL_H_
+#define JM_THREAD_POOL_H_
+
+#include "jm_callbacks.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/** \file jm_thread_pool.h
+	Work-stealing thread pool.
+*/
+/**
+	\addtogroup jm_utils
+	@{
+		\addtogroup jm_thread_pool
+	@}
+*/
+/** \addtogroup jm_thread_pool Work-stealing thread pool
+	Every worker thread owns a task queue. A worker takes tasks from the back
+	of its own queue and, when it runs out of work, steals from the front of
+	the queues of the other workers. Tasks may submit new tasks to the queue of
+	the worker that runs them, so that dependent work tends to stay on one
+	thread while idle threads pick up the rest.
+
+	The queues grow on demand and are never shrunk, i.e., after a warm-up
+	submitting tasks does not allocate memory.
+@{*/
+
+/** \brief Opaque thread pool */
+typedef struct jm_thread_pool_t jm_thread_pool_t;
+
+/**
+	\brief Task function.
+	\param pool The pool that runs the task.
+	\param worker Index of the worker thread running the task (0 to number of threads - 1).
+	\param data The pointer given at submission.
+*/
+typedef void (*jm_thread_pool_task_ft)(jm_thread_pool_t* pool, size_t worker, void* data);
+
+/**
+	\brief Create a thread pool and start the worker threads.
+	\param cb Callbacks for memory allocation and logging. Default callbacks are used if NULL.
+	\param numThreads Number of worker threads. 0 means one per processor.
+	\return A pool or NULL on error. Must be freed with jm_thread_pool_free().
+*/
+FMILIB_EXPORT
+jm_thread_pool_t* jm_thread_pool_create(jm_callbacks* cb, size_t numThreads);
+
+/** \brief Wait for all submitted tasks, stop the workers and free the pool */
+FMILIB_EXPORT
+void jm_thread_pool_free(jm_thread_pool_t* pool);
+
+/** \brief Get the number of worker threads */
+FMILIB_EXPORT
+size_t jm_thread_pool_get_number_of_threads(jm_thread_pool_t* pool);
+
+/**
+	\brief Submit a task. The queues are filled round-robin.
+	\return ::jm_status_success or ::jm_status_error if memory allocation failed.
+*/
+FMILIB_EXPORT
+jm_status_enu_t jm_thread_pool_submit(jm_thread_pool_t* pool, jm_thread_pool_task_ft task, void* data);
+
+/**
+	\brief Submit a task to the queue of the given worker.
+	Meant to be called from a running task with its own worker index.
+	\return ::jm_status_success or ::jm_status_error if memory allocation failed.
+*/
+FMILIB_EXPORT
+jm_status_enu_t jm_thread_pool_submit_local(jm_thread_pool_t* pool, size_t worker, jm_thread_pool_task_ft task, void* data);
+
+/**
+	\brief Block until all submitted tasks, including tasks submitted by tasks, are finished.
+	Must not be called from a task.
+*/
+FMILIB_EXPORT
+void jm_thread_pool_wait(jm_thread_pool_t* pool);
+
+/*@}*/
+#ifdef __cplusplus
+}
+#endif
+#endif /* JM_THREAD_POOL_H_ */
@@ -0,0 +1,92 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+     This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#ifndef JM_TRACE_H_
+#define JM_TRACE_H_
+
+#include "jm_callbacks.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+/** \file jm_trace.h
+	Recording of timeline events in the Chrome Trace Event format.
+*/
+/**
+	\addtogroup jm_utils
+	@{
+		\addtogroup jm_trace
+	@}
+*/
+/** \addtogroup jm_trace Event tracing
+	Process wide recording of timeline events for trace viewers (chrome://tracing, Perfetto UI).
+
+	While tracing is active the library records the phases of loading an FMU (unzip, XML parsing,
+	alias resolution, loading the shared library and the FMI function table) and, if compiled
+	with FMILIB_ENABLE_CALL_STATISTICS, every FMI call. Applications may add their own events.
+
+	Every thread records into a buffer of its own. The lock of the buffer is only contended while
+	tracing is started or stopped. The buffers are written to a JSON file in the Chrome Trace Event format by jm_trace_stop(), with one row per thread.
+	Event names and categories are stored as pointers and must stay valid until the trace is stopped,
+	string literals are recommended. Events are only recorded while tracing is active.
+@{*/
+
+/**
+	\brief Start recording events. Any events of a previous trace are discarded.
+	\param cb Callbacks for memory allocation and logging. The allocation functions must be thread safe.
+		Default callbacks are used if NULL. The callbacks must stay valid until jm_trace_stop() returns.
+	\return ::jm_status_success or ::jm_status_error if tracing is already active.
+*/
+FMILIB_EXPORT
+jm_status_enu_t jm_trace_start(jm_callbacks* cb);
+
+/**
+	\brief Stop recording and write the recorded events.
+
+	Other threads may still record events while this function runs. Such events are either written
+	or discarded, so slices that are in progress may be incomplete in the trace.
+	\param fileName Output file for the Chrome Trace Event JSON. The events are discarded if NULL.
+	\return ::jm_status_success or ::jm_status_error if tracing is not active or the file could not be written.
+*/
+FMILIB_EXPORT
+jm_status_enu_t jm_trace_stop(const char* fileName);
+
+/** \brief Check if events are recorded */
+FMILIB_EXPORT
+int jm_trace_is_active(void);
+
+/** \brief Record the beginning of a slice on the timeline of the calling thread */
+FMILIB_EXPORT
+void jm_trace_begin(const char* category, const char* name);
+
+/** \brief Record the end of the slice started with jm_trace_begin() with the same name */
+FMILIB_EXPORT
+void jm_trace_end(const char* category, const char* name);
+
+/**
+	\brief Record a completed slice on the timeline of the calling thread.
+	\param category Event category.
+	\param name Event name.
+	\param start Start time from jm_get_monotonic_time().
+	\param end End time from jm_get_monotonic_time().
+*/
+FMILIB_EXPORT
+void jm_trace_complete(const char* category, const char* name, double start, double end);
+
+/*@}*/
+#ifdef __cplusplus
+}
+#endif
+#endif /* JM_TRACE_H_ */
@@ -86,3 +86,12 @@ const char* fmi1_base_type_to_string(fmi1_base_type_enu_t bt) {
     }
     return "Error";
 }
+
+const char* fmi1_function_to_string(fmi1_function_enu_t id) {
+#define FMI1_FUNCTION_ENU_TO_STR(f) case fmi1_function_ ## f: return "fmi"#f;
+	switch (id) {
+	FMI1_FUNCTIONS(FMI1_FUNCTION_ENU_TO_STR)
+	default: break;
+	}
+	return "Unknown";
+}
@@ -264,3 +264,12 @@ size_t fmi2_SI_base_unit_exp_to_string(const int exp[fmi2_SI_base_units_Num], si
     if(len < bufSize) buf[len] = 0;
 	return len + 1;
 }
+
+const char* fmi2_function_to_string(fmi2_function_enu_t id) {
+#define FMI2_FUNCTION_ENU_TO_STR(f) case fmi2_function_ ## f: return "fmi2"#f;
+	switch (id) {
+	FMI2_FUNCTIONS(FMI2_FUNCTION_ENU_TO_STR)
+	default: break;
+	}
+	return "Unknown";
+}
@@ -0,0 +1,80 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#if !defined(WIN32) && !defined(_POSIX_C_SOURCE)
+/* clock_gettime is not declared in strict C89 mode */
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include <fmilib_config.h>
+#include <JM/jm_call_statistics.h>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+double jm_get_monotonic_time(void) {
+#ifdef WIN32
+	static double period = 0;
+	LARGE_INTEGER counter;
+	if(period == 0) {
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		period = 1.0 / (double)frequency.QuadPart;
+	}
+	QueryPerformanceCounter(&counter);
+	return (double)counter.QuadPart * period;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + 1e-9 * (double)ts.tv_nsec;
+#endif
+}
+
+void jm_call_statistics_add(jm_call_statistics_t* stats, double duration) {
+	int exponent;
+	size_t bin = 0;
+
+	stats->count++;
+	stats->total_time += duration;
+	if(duration > stats->max_time) stats->max_time = duration;
+	/* duration in ns = m * 2^exponent with 0.5 <= m < 1 */
+	if(duration * 1e9 >= 2.0) {
+		frexp(duration * 1e9, &exponent);
+		bin = (size_t)(exponent - 1);
+		if(bin >= JM_CALL_STATISTICS_BINS) bin = JM_CALL_STATISTICS_BINS - 1;
+	}
+	stats->histogram[bin]++;
+}
+
+void jm_call_statistics_log(jm_callbacks* cb, const char* module, const char* function, const jm_call_statistics_t* stats) {
+	char histogram[JM_CALL_STATISTICS_BINS * 24 + 1];
+	size_t k, len = 0;
+
+	histogram[0] = 0;
+	for(k = 0; k < JM_CALL_STATISTICS_BINS; k++) {
+		if(stats->histogram[k] == 0) continue;
+		len += sprintf(histogram + len, " %u:%u", (unsigned)k, (unsigned)stats->histogram[k]); /*safe*/
+	}
+	jm_log_info(cb, module, "%s: %u calls, total %g s, mean %g s, max %g s, log2(ns) histogram%s",
+		function, (unsigned)stats->count, stats->total_time,
+		stats->count ? stats->total_time / (double)stats->count : 0.0, stats->max_time, histogram);
+}
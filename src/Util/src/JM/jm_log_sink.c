@@ -0,0 +1,300 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+
+#include <JM/jm_thread.h>
+#include <JM/jm_log_sink.h>
+
+static const char* module = "JMLOG";
+
+#define JM_LOG_SINK_DEFAULT_CAPACITY 1024
+
+/* A queued message. The text holds the module name and the message, both zero terminated. */
+typedef struct jm_log_sink_entry_t {
+	jm_log_sink_deliver_ft deliver;
+	void* target;
+	jm_log_level_enu_t log_level;
+	int hasModule;
+	char* text;
+	size_t textSize;
+} jm_log_sink_entry_t;
+
+struct jm_log_sink_t {
+	jm_callbacks* callbacks;
+	jm_log_sink_policy_enu_t policy;
+	size_t capacity;
+
+	/* 'lock' protects the ring and the counters */
+	jm_mutex_t lock;
+	jm_cond_t available; /* signaled when the ring gets a message or the sink is stopped */
+	jm_cond_t space;     /* signaled when the background thread has emptied the ring */
+	jm_cond_t progress;  /* signaled after a batch has been delivered */
+	jm_log_sink_entry_t* ring;
+	size_t first;
+	size_t size;
+	int waiting;         /* the background thread waits for messages */
+	int stop;
+	jm_log_sink_statistics_t stats;
+
+	/* Entries are swapped from the ring into the batch, so that the ring is free while the batch is delivered */
+	jm_log_sink_entry_t* batch;
+	jm_thread_t thread;
+};
+
+/* The sink whose messages are being delivered by the current thread */
+static JM_THREAD_LOCAL jm_log_sink_t* jm_log_sink_delivering = 0;
+
+static const char* jm_log_sink_policy_str[] = {
+	"block",
+	"drop newest",
+	"drop oldest"
+};
+
+const char* jm_log_sink_policy_to_string(jm_log_sink_policy_enu_t policy) {
+	if(policy < jm_log_sink_policy_block || policy > jm_log_sink_policy_drop_oldest) return "unknown";
+	return jm_log_sink_policy_str[policy];
+}
+
+static void jm_log_sink_deliver_entry(jm_log_sink_entry_t* e) {
+	const char* mod = e->hasModule ? e->text : 0;
+	const char* msg = e->hasModule ? e->text + strlen(e->text) + 1 : e->text;
+	e->deliver(e->target, mod, e->log_level, msg);
+}
+
+static void jm_log_sink_thread(void* arg) {
+	jm_log_sink_t* sink = (jm_log_sink_t*)arg;
+	size_t n, k;
+
+	jm_log_sink_delivering = sink;
+	jm_mutex_lock(&sink->lock);
+	for(;;) {
+		while(sink->size == 0 && !sink->stop) {
+			sink->waiting = 1;
+			jm_cond_wait(&sink->available, &sink->lock);
+			sink->waiting = 0;
+		}
+		if(sink->size == 0) break;
+
+		/* Take everything that is queued */
+		n = sink->size;
+		for(k = 0; k < n; k++) {
+			jm_log_sink_entry_t* e = &sink->ring[(sink->first + k) % sink->capacity];
+			jm_log_sink_entry_t tmp = sink->batch[k];
+			sink->batch[k] = *e;
+			*e = tmp;
+		}
+		sink->first = (sink->first + n) % sink->capacity;
+		sink->size = 0;
+		sink->stats.batches++;
+		jm_cond_broadcast(&sink->space);
+		jm_mutex_unlock(&sink->lock);
+
+		for(k = 0; k < n; k++) {
+			jm_log_sink_deliver_entry(&sink->batch[k]);
+		}
+
+		jm_mutex_lock(&sink->lock);
+		sink->stats.delivered += n;
+		jm_cond_broadcast(&sink->progress);
+	}
+	jm_mutex_unlock(&sink->lock);
+	jm_log_sink_delivering = 0;
+}
+
+static void jm_log_sink_free_entries(jm_callbacks* cb, jm_log_sink_entry_t* entries, size_t n) {
+	size_t k;
+	if(!entries) return;
+	for(k = 0; k < n; k++) cb->free(entries[k].text);
+	cb->free(entries);
+}
+
+jm_log_sink_t* jm_log_sink_create(jm_callbacks* cb, size_t capacity, jm_log_sink_policy_enu_t policy) {
+	jm_log_sink_t* sink;
+
+	if(!cb) cb = jm_get_default_callbacks();
+	if(capacity == 0) capacity = JM_LOG_SINK_DEFAULT_CAPACITY;
+	sink = (jm_log_sink_t*)cb->calloc(1, sizeof(jm_log_sink_t));
+	if(!sink) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	sink->callbacks = cb;
+	sink->policy = policy;
+	sink->capacity = capacity;
+	sink->ring = (jm_log_sink_entry_t*)cb->calloc(capacity, sizeof(jm_log_sink_entry_t));
+	sink->batch = (jm_log_sink_entry_t*)cb->calloc(capacity, sizeof(jm_log_sink_entry_t));
+	if(!sink->ring || !sink->batch) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		cb->free(sink->ring);
+		cb->free(sink->batch);
+		cb->free(sink);
+		return 0;
+	}
+	if(jm_mutex_init(&sink->lock) != jm_status_success) {
+		cb->free(sink->ring);
+		cb->free(sink->batch);
+		cb->free(sink);
+		return 0;
+	}
+	jm_cond_init(&sink->available);
+	jm_cond_init(&sink->space);
+	jm_cond_init(&sink->progress);
+	if(jm_thread_create(&sink->thread, jm_log_sink_thread, sink) != jm_status_success) {
+		jm_log_fatal(cb, module, "Could not start the log delivery thread");
+		jm_cond_destroy(&sink->available);
+		jm_cond_destroy(&sink->space);
+		jm_cond_destroy(&sink->progress);
+		jm_mutex_destroy(&sink->lock);
+		cb->free(sink->ring);
+		cb->free(sink->batch);
+		cb->free(sink);
+		return 0;
+	}
+	return sink;
+}
+
+void jm_log_sink_free(jm_log_sink_t* sink) {
+	jm_callbacks* cb;
+
+	if(!sink) return;
+	cb = sink->callbacks;
+	jm_mutex_lock(&sink->lock);
+	sink->stop = 1;
+	jm_cond_signal(&sink->available);
+	jm_cond_broadcast(&sink->space);
+	jm_mutex_unlock(&sink->lock);
+	jm_thread_join(&sink->thread);
+
+	jm_cond_destroy(&sink->available);
+	jm_cond_destroy(&sink->space);
+	jm_cond_destroy(&sink->progress);
+	jm_mutex_destroy(&sink->lock);
+	jm_log_sink_free_entries(cb, sink->ring, sink->capacity);
+	jm_log_sink_free_entries(cb, sink->batch, sink->capacity);
+	cb->free(sink);
+}
+
+jm_status_enu_t jm_log_sink_post(jm_log_sink_t* sink, jm_log_sink_deliver_ft deliver, void* target,
+								 jm_string module, jm_log_level_enu_t log_level, jm_string message) {
+	size_t moduleLen = module ? strlen(module) + 1 : 0;
+	size_t len = moduleLen + strlen(message) + 1;
+	jm_log_sink_entry_t* e;
+
+	if(jm_log_sink_delivering == sink) {
+		/* Waiting for space on the delivery thread would never end */
+		deliver(target, module, log_level, message);
+		jm_mutex_lock(&sink->lock);
+		sink->stats.posted++;
+		sink->stats.delivered++;
+		jm_mutex_unlock(&sink->lock);
+		return jm_status_success;
+	}
+
+	jm_mutex_lock(&sink->lock);
+	sink->stats.posted++;
+	if(sink->size == sink->capacity) {
+		if(sink->policy == jm_log_sink_policy_drop_newest) {
+			sink->stats.dropped++;
+			jm_mutex_unlock(&sink->lock);
+			return jm_status_warning;
+		}
+		else if(sink->policy == jm_log_sink_policy_drop_oldest) {
+			sink->first = (sink->first + 1) % sink->capacity;
+			sink->size--;
+			sink->stats.dropped++;
+		}
+		else {
+			sink->stats.blocked++;
+			while(sink->size == sink->capacity && !sink->stop)
+				jm_cond_wait(&sink->space, &sink->lock);
+		}
+	}
+	if(sink->stop) {
+		/* The background thread is gone or about to finish */
+		jm_mutex_unlock(&sink->lock);
+		deliver(target, module, log_level, message);
+		jm_mutex_lock(&sink->lock);
+		sink->stats.delivered++;
+		jm_mutex_unlock(&sink->lock);
+		return jm_status_success;
+	}
+
+	e = &sink->ring[(sink->first + sink->size) % sink->capacity];
+	if(e->textSize < len) {
+		char* text = (char*)sink->callbacks->malloc(len);
+		if(!text) {
+			sink->stats.dropped++;
+			jm_mutex_unlock(&sink->lock);
+			return jm_status_warning;
+		}
+		sink->callbacks->free(e->text);
+		e->text = text;
+		e->textSize = len;
+	}
+	e->deliver = deliver;
+	e->target = target;
+	e->log_level = log_level;
+	e->hasModule = (module != 0);
+	if(module) memcpy(e->text, module, moduleLen);
+	strcpy(e->text + moduleLen, message);
+	sink->size++;
+	if(sink->size > sink->stats.max_queued) sink->stats.max_queued = sink->size;
+	if(sink->waiting) jm_cond_signal(&sink->available);
+	jm_mutex_unlock(&sink->lock);
+	return jm_status_success;
+}
+
+void jm_log_sink_flush(jm_log_sink_t* sink) {
+	size_t posted;
+
+	if(jm_log_sink_delivering == sink) return;
+	jm_mutex_lock(&sink->lock);
+	posted = sink->stats.posted;
+	while(sink->stats.delivered + sink->stats.dropped < posted)
+		jm_cond_wait(&sink->progress, &sink->lock);
+	jm_mutex_unlock(&sink->lock);
+}
+
+void jm_log_sink_get_statistics(jm_log_sink_t* sink, jm_log_sink_statistics_t* stats) {
+	jm_mutex_lock(&sink->lock);
+	*stats = sink->stats;
+	jm_mutex_unlock(&sink->lock);
+}
+
+static void jm_log_sink_deliver_to_parent(void* target, jm_string module, jm_log_level_enu_t log_level, jm_string message) {
+	jm_callbacks* parent = ((jm_log_sink_callbacks_t*)target)->parent;
+	if(parent->logger) parent->logger(parent, module, log_level, message);
+}
+
+static void jm_log_sink_logger(jm_callbacks* c, jm_string module, jm_log_level_enu_t log_level, jm_string message) {
+	/* The callbacks are the first member of the wrapper */
+	jm_log_sink_callbacks_t* wrapper = (jm_log_sink_callbacks_t*)c;
+	jm_log_sink_post(wrapper->sink, jm_log_sink_deliver_to_parent, wrapper, module, log_level, message);
+}
+
+jm_callbacks* jm_log_sink_wrap_callbacks(jm_log_sink_t* sink, jm_callbacks* parent, jm_log_sink_callbacks_t* wrapper) {
+	wrapper->sink = sink;
+	wrapper->parent = parent;
+	wrapper->callbacks.malloc = parent->malloc;
+	wrapper->callbacks.calloc = parent->calloc;
+	wrapper->callbacks.realloc = parent->realloc;
+	wrapper->callbacks.free = parent->free;
+	wrapper->callbacks.logger = jm_log_sink_logger;
+	wrapper->callbacks.log_level = parent->log_level;
+	wrapper->callbacks.context = parent->context;
+	wrapper->callbacks.errMessageBuffer[0] = 0;
+	return &wrapper->callbacks;
+}
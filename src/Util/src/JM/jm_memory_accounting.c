@@ -0,0 +1,286 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+
+#include <JM/jm_memory_accounting.h>
+
+/* Header in front of every block. The size is rounded up so that the user data keeps
+   the alignment of the parent allocator. */
+typedef struct jm_memory_block_t {
+	jm_memory_accounting_t* accounting;
+	jm_callbacks* parent;
+	size_t size;
+	jm_memory_subsystem_enu_t subsystem;
+} jm_memory_block_t;
+
+#define JM_MEMORY_HEADER_SIZE ((sizeof(jm_memory_block_t) + 15) & ~(size_t)15)
+
+/* Maximum number of different parent callbacks of the live accounting records */
+#define JM_MEMORY_PARENTS_NUM 16
+
+/* The memory callbacks take no context argument. Every parent therefore gets allocation
+   functions of its own, so that blocks allocated outside of a scope are taken from the
+   parent of the record whose callbacks are called. */
+typedef struct jm_memory_parent_t {
+	jm_callbacks* parent;
+	size_t records;
+} jm_memory_parent_t;
+
+static jm_memory_parent_t jm_memory_parents[JM_MEMORY_PARENTS_NUM];
+static jm_mutex_t jm_memory_parents_lock;
+static jm_status_enu_t jm_memory_parents_status = jm_status_error;
+static jm_once_t jm_memory_parents_once = JM_ONCE_INIT;
+
+static void jm_memory_init_parents(void) {
+	jm_memory_parents_status = jm_mutex_init(&jm_memory_parents_lock);
+}
+
+static JM_THREAD_LOCAL jm_memory_scope_t* jm_memory_current_scope = 0;
+
+static const char* jm_memory_subsystem_str[] = {
+	"other",
+	"XML model",
+	"variable lists",
+	"CAPI",
+	"log buffers",
+	"total"
+};
+
+const char* jm_memory_subsystem_to_string(jm_memory_subsystem_enu_t subsystem) {
+	if(subsystem < jm_memory_subsystem_other || subsystem > jm_memory_subsystem_total) return "unknown";
+	return jm_memory_subsystem_str[subsystem];
+}
+
+static void jm_memory_usage_add(jm_memory_usage_t* usage, size_t size) {
+	usage->live_bytes += size;
+	if(usage->live_bytes > usage->peak_bytes) usage->peak_bytes = usage->live_bytes;
+}
+
+/* Update the usage of a block: the size changes from 'removed' to 'added' bytes */
+static void jm_memory_charge(jm_memory_block_t* block, size_t removed, size_t added, int allocated, int released) {
+	jm_memory_accounting_t* accounting = block->accounting;
+	jm_memory_usage_t* usage[2];
+	size_t k;
+
+	usage[0] = &accounting->usage[block->subsystem];
+	usage[1] = &accounting->usage[jm_memory_subsystem_total];
+	jm_mutex_lock(&accounting->lock);
+	for(k = 0; k < 2; k++) {
+		usage[k]->live_bytes -= removed;
+		jm_memory_usage_add(usage[k], added);
+		usage[k]->allocations += allocated;
+		usage[k]->frees += released;
+	}
+	jm_mutex_unlock(&accounting->lock);
+}
+
+/* Allocate a block. 'slot' is the entry in jm_memory_parents of the called callbacks. */
+static jm_voidp jm_memory_allocate(size_t slot, size_t size, int zero) {
+	jm_memory_scope_t* scope = jm_memory_current_scope;
+	jm_callbacks* parent = scope ? scope->accounting->parent : jm_memory_parents[slot].parent;
+	jm_memory_block_t* block;
+
+	if(size > (size_t)-1 - JM_MEMORY_HEADER_SIZE) return 0;
+	if(zero)
+		block = (jm_memory_block_t*)parent->calloc(1, JM_MEMORY_HEADER_SIZE + size);
+	else
+		block = (jm_memory_block_t*)parent->malloc(JM_MEMORY_HEADER_SIZE + size);
+	if(!block) return 0;
+	block->parent = parent;
+	block->size = size;
+	if(scope) {
+		block->accounting = scope->accounting;
+		block->subsystem = scope->subsystem;
+		jm_memory_charge(block, 0, size, 1, 0);
+	}
+	else {
+		block->accounting = 0;
+		block->subsystem = jm_memory_subsystem_other;
+	}
+	return (char*)block + JM_MEMORY_HEADER_SIZE;
+}
+
+static jm_voidp jm_memory_calloc(size_t slot, size_t numitems, size_t itemsize) {
+	if(itemsize && numitems > (size_t)-1 / itemsize) return 0;
+	return jm_memory_allocate(slot, numitems * itemsize, 1);
+}
+
+static jm_voidp jm_memory_realloc(size_t slot, void* ptr, size_t size) {
+	jm_memory_block_t* block;
+	size_t oldSize;
+
+	if(!ptr) return jm_memory_allocate(slot, size, 0);
+	if(size > (size_t)-1 - JM_MEMORY_HEADER_SIZE) return 0;
+	block = (jm_memory_block_t*)((char*)ptr - JM_MEMORY_HEADER_SIZE);
+	oldSize = block->size;
+	block = (jm_memory_block_t*)block->parent->realloc(block, JM_MEMORY_HEADER_SIZE + size);
+	if(!block) return 0;
+	block->size = size;
+	if(block->accounting) jm_memory_charge(block, oldSize, size, 0, 0);
+	return (char*)block + JM_MEMORY_HEADER_SIZE;
+}
+
+static void jm_memory_free(jm_voidp ptr) {
+	jm_memory_block_t* block;
+
+	if(!ptr) return;
+	block = (jm_memory_block_t*)((char*)ptr - JM_MEMORY_HEADER_SIZE);
+	if(block->accounting) jm_memory_charge(block, block->size, 0, 0, 1);
+	block->parent->free(block);
+}
+
+/* Allocation functions of the parent in slot k */
+#define JM_MEMORY_PARENT_FUNCTIONS(k) \
+	static jm_voidp jm_memory_malloc_##k(size_t size) { return jm_memory_allocate(k, size, 0); } \
+	static jm_voidp jm_memory_calloc_##k(size_t numitems, size_t itemsize) { return jm_memory_calloc(k, numitems, itemsize); } \
+	static jm_voidp jm_memory_realloc_##k(void* ptr, size_t size) { return jm_memory_realloc(k, ptr, size); }
+
+JM_MEMORY_PARENT_FUNCTIONS(0)
+JM_MEMORY_PARENT_FUNCTIONS(1)
+JM_MEMORY_PARENT_FUNCTIONS(2)
+JM_MEMORY_PARENT_FUNCTIONS(3)
+JM_MEMORY_PARENT_FUNCTIONS(4)
+JM_MEMORY_PARENT_FUNCTIONS(5)
+JM_MEMORY_PARENT_FUNCTIONS(6)
+JM_MEMORY_PARENT_FUNCTIONS(7)
+JM_MEMORY_PARENT_FUNCTIONS(8)
+JM_MEMORY_PARENT_FUNCTIONS(9)
+JM_MEMORY_PARENT_FUNCTIONS(10)
+JM_MEMORY_PARENT_FUNCTIONS(11)
+JM_MEMORY_PARENT_FUNCTIONS(12)
+JM_MEMORY_PARENT_FUNCTIONS(13)
+JM_MEMORY_PARENT_FUNCTIONS(14)
+JM_MEMORY_PARENT_FUNCTIONS(15)
+
+typedef struct jm_memory_parent_functions_t {
+	jm_malloc_f malloc;
+	jm_calloc_f calloc;
+	jm_realloc_f realloc;
+} jm_memory_parent_functions_t;
+
+#define JM_MEMORY_PARENT_ENTRY(k) { jm_memory_malloc_##k, jm_memory_calloc_##k, jm_memory_realloc_##k }
+
+static const jm_memory_parent_functions_t jm_memory_parent_functions[JM_MEMORY_PARENTS_NUM] = {
+	JM_MEMORY_PARENT_ENTRY(0), JM_MEMORY_PARENT_ENTRY(1), JM_MEMORY_PARENT_ENTRY(2), JM_MEMORY_PARENT_ENTRY(3),
+	JM_MEMORY_PARENT_ENTRY(4), JM_MEMORY_PARENT_ENTRY(5), JM_MEMORY_PARENT_ENTRY(6), JM_MEMORY_PARENT_ENTRY(7),
+	JM_MEMORY_PARENT_ENTRY(8), JM_MEMORY_PARENT_ENTRY(9), JM_MEMORY_PARENT_ENTRY(10), JM_MEMORY_PARENT_ENTRY(11),
+	JM_MEMORY_PARENT_ENTRY(12), JM_MEMORY_PARENT_ENTRY(13), JM_MEMORY_PARENT_ENTRY(14), JM_MEMORY_PARENT_ENTRY(15)
+};
+
+/* Find or take the slot of a parent. Returns JM_MEMORY_PARENTS_NUM if all the slots are in use. */
+static size_t jm_memory_acquire_parent(jm_callbacks* parent) {
+	size_t k, slot = JM_MEMORY_PARENTS_NUM;
+
+	jm_once(&jm_memory_parents_once, jm_memory_init_parents);
+	if(jm_memory_parents_status != jm_status_success) return slot;
+	jm_mutex_lock(&jm_memory_parents_lock);
+	for(k = 0; k < JM_MEMORY_PARENTS_NUM; k++) {
+		if(jm_memory_parents[k].records && jm_memory_parents[k].parent == parent) {
+			slot = k;
+			break;
+		}
+		if(!jm_memory_parents[k].records && slot == JM_MEMORY_PARENTS_NUM) slot = k;
+	}
+	if(slot < JM_MEMORY_PARENTS_NUM) {
+		jm_memory_parents[slot].parent = parent;
+		jm_memory_parents[slot].records++;
+	}
+	jm_mutex_unlock(&jm_memory_parents_lock);
+	return slot;
+}
+
+static void jm_memory_release_parent(jm_callbacks* parent) {
+	size_t k;
+
+	jm_mutex_lock(&jm_memory_parents_lock);
+	for(k = 0; k < JM_MEMORY_PARENTS_NUM; k++) {
+		if(jm_memory_parents[k].records && jm_memory_parents[k].parent == parent) {
+			jm_memory_parents[k].records--;
+			break;
+		}
+	}
+	jm_mutex_unlock(&jm_memory_parents_lock);
+}
+
+static void jm_memory_logger(jm_callbacks* c, jm_string module, jm_log_level_enu_t log_level, jm_string message) {
+	/* The callbacks are the first member of the record */
+	jm_callbacks* parent = ((jm_memory_accounting_t*)c)->parent;
+
+	if(message != parent->errMessageBuffer) {
+		strncpy(parent->errMessageBuffer, message, JM_MAX_ERROR_MESSAGE_SIZE - 1);
+		parent->errMessageBuffer[JM_MAX_ERROR_MESSAGE_SIZE - 1] = 0;
+	}
+	if(parent->logger) parent->logger(parent, module, log_level, message);
+}
+
+jm_callbacks* jm_memory_accounting_init(jm_memory_accounting_t* accounting, jm_callbacks* parent) {
+	size_t slot;
+
+	memset(accounting->usage, 0, sizeof(accounting->usage));
+	slot = jm_memory_acquire_parent(parent);
+	if(slot == JM_MEMORY_PARENTS_NUM) return 0;
+	if(jm_mutex_init(&accounting->lock) != jm_status_success) {
+		jm_memory_release_parent(parent);
+		return 0;
+	}
+	accounting->parent = parent;
+	accounting->callbacks.malloc = jm_memory_parent_functions[slot].malloc;
+	accounting->callbacks.calloc = jm_memory_parent_functions[slot].calloc;
+	accounting->callbacks.realloc = jm_memory_parent_functions[slot].realloc;
+	accounting->callbacks.free = jm_memory_free;
+	accounting->callbacks.logger = jm_memory_logger;
+	accounting->callbacks.log_level = parent->log_level;
+	accounting->callbacks.context = parent->context;
+	accounting->callbacks.errMessageBuffer[0] = 0;
+	return &accounting->callbacks;
+}
+
+void jm_memory_accounting_destroy(jm_memory_accounting_t* accounting) {
+	jm_mutex_destroy(&accounting->lock);
+	jm_memory_release_parent(accounting->parent);
+}
+
+void jm_memory_accounting_get_usage(jm_memory_accounting_t* accounting, jm_memory_subsystem_enu_t subsystem, jm_memory_usage_t* usage) {
+	jm_mutex_lock(&accounting->lock);
+	*usage = accounting->usage[subsystem];
+	jm_mutex_unlock(&accounting->lock);
+}
+
+void jm_memory_accounting_log(jm_memory_accounting_t* accounting, jm_callbacks* cb, const char* module) {
+	jm_memory_usage_t usage;
+	int k;
+
+	for(k = jm_memory_subsystem_other; k <= jm_memory_subsystem_total; k++) {
+		jm_memory_accounting_get_usage(accounting, (jm_memory_subsystem_enu_t)k, &usage);
+		if(usage.allocations == 0) continue;
+		jm_log_info(cb, module, "Memory of %s: %u bytes live, %u bytes peak, %u allocations, %u frees",
+			jm_memory_subsystem_to_string((jm_memory_subsystem_enu_t)k), (unsigned)usage.live_bytes,
+			(unsigned)usage.peak_bytes, (unsigned)usage.allocations, (unsigned)usage.frees);
+	}
+}
+
+void jm_memory_scope_enter(jm_memory_scope_t* scope, jm_memory_accounting_t* accounting, jm_memory_subsystem_enu_t subsystem) {
+	scope->accounting = accounting;
+	if(!accounting) return;
+	scope->subsystem = subsystem;
+	scope->previous = jm_memory_current_scope;
+	jm_memory_current_scope = scope;
+}
+
+void jm_memory_scope_leave(jm_memory_scope_t* scope) {
+	if(!scope->accounting) return;
+	jm_memory_current_scope = scope->previous;
+}
@@ -0,0 +1,167 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <JM/jm_pointer_map.h>
+
+#define JM_POINTER_MAP_MIN_CAPACITY 8
+
+/* Mix the pointer bits; the low bits of pointers are mostly zero because of alignment */
+static size_t jm_pointer_map_hash(const void* key) {
+	size_t h = (size_t)key;
+	h ^= h >> 16;
+	h *= 0x45d9f3bU;
+	h ^= h >> 16;
+	h *= 0x45d9f3bU;
+	h ^= h >> 16;
+	return h;
+}
+
+/* The low bits select the stripe, the rest the slot in the stripe */
+#define JM_POINTER_MAP_STRIPE(h) ((h) % JM_POINTER_MAP_STRIPES)
+#define JM_POINTER_MAP_SLOT(h, capacity) (((h) / JM_POINTER_MAP_STRIPES) & ((capacity) - 1))
+
+/* Index of the key or of the empty slot where it would be inserted. The table must not be full. */
+static size_t jm_pointer_map_probe(jm_pointer_map_stripe_t* s, const void* key, size_t h) {
+	size_t i = JM_POINTER_MAP_SLOT(h, s->capacity);
+	while(s->entries[i].key && (s->entries[i].key != key)) {
+		i = (i + 1) & (s->capacity - 1);
+	}
+	return i;
+}
+
+static jm_status_enu_t jm_pointer_map_rehash(jm_callbacks* cb, jm_pointer_map_stripe_t* s, size_t capacity) {
+	jm_pointer_map_entry_t* old = s->entries;
+	size_t oldCapacity = s->capacity, k;
+
+	s->entries = (jm_pointer_map_entry_t*)cb->calloc(capacity, sizeof(jm_pointer_map_entry_t));
+	if(!s->entries) {
+		s->entries = old;
+		return jm_status_error;
+	}
+	s->capacity = capacity;
+	for(k = 0; k < oldCapacity; k++) {
+		if(old[k].key) {
+			s->entries[jm_pointer_map_probe(s, old[k].key, jm_pointer_map_hash(old[k].key))] = old[k];
+		}
+	}
+	cb->free(old);
+	return jm_status_success;
+}
+
+jm_status_enu_t jm_pointer_map_init(jm_pointer_map_t* map, jm_callbacks* cb) {
+	size_t k;
+
+	map->callbacks = cb ? cb : jm_get_default_callbacks();
+	for(k = 0; k < JM_POINTER_MAP_STRIPES; k++) {
+		jm_pointer_map_stripe_t* s = &map->stripes[k];
+		if(jm_mutex_init(&s->lock) != jm_status_success) {
+			while(k--) jm_mutex_destroy(&map->stripes[k].lock);
+			return jm_status_error;
+		}
+		s->size = 0;
+		s->capacity = 0;
+		s->entries = 0;
+	}
+	return jm_status_success;
+}
+
+void jm_pointer_map_destroy(jm_pointer_map_t* map) {
+	size_t k;
+
+	for(k = 0; k < JM_POINTER_MAP_STRIPES; k++) {
+		map->callbacks->free(map->stripes[k].entries);
+		jm_mutex_destroy(&map->stripes[k].lock);
+	}
+}
+
+jm_status_enu_t jm_pointer_map_insert(jm_pointer_map_t* map, const void* key, void* value) {
+	size_t h = jm_pointer_map_hash(key), i;
+	jm_pointer_map_stripe_t* s = &map->stripes[JM_POINTER_MAP_STRIPE(h)];
+	jm_status_enu_t status = jm_status_success;
+
+	jm_mutex_lock(&s->lock);
+	/* Keep the load factor below 3/4 */
+	if(4 * (s->size + 1) > 3 * s->capacity) {
+		status = jm_pointer_map_rehash(map->callbacks, s, s->capacity ? 2 * s->capacity : JM_POINTER_MAP_MIN_CAPACITY);
+	}
+	if(status == jm_status_success) {
+		i = jm_pointer_map_probe(s, key, h);
+		if(!s->entries[i].key) {
+			s->entries[i].key = key;
+			s->size++;
+		}
+		s->entries[i].value = value;
+	}
+	jm_mutex_unlock(&s->lock);
+	return status;
+}
+
+void* jm_pointer_map_find(jm_pointer_map_t* map, const void* key) {
+	size_t h = jm_pointer_map_hash(key);
+	jm_pointer_map_stripe_t* s = &map->stripes[JM_POINTER_MAP_STRIPE(h)];
+	void* value = 0;
+
+	jm_mutex_lock(&s->lock);
+	if(s->size) {
+		value = s->entries[jm_pointer_map_probe(s, key, h)].value;
+	}
+	jm_mutex_unlock(&s->lock);
+	return value;
+}
+
+int jm_pointer_map_remove(jm_pointer_map_t* map, const void* key, void* value) {
+	size_t h = jm_pointer_map_hash(key), i, j, home, mask;
+	jm_pointer_map_stripe_t* s = &map->stripes[JM_POINTER_MAP_STRIPE(h)];
+	int removed = 0;
+
+	jm_mutex_lock(&s->lock);
+	if(s->size) {
+		mask = s->capacity - 1;
+		i = jm_pointer_map_probe(s, key, h);
+		if(s->entries[i].key && (s->entries[i].value == value)) {
+			/* Backward shift deletion: move up the following entries of the cluster that
+			   would not be found any more once the slot is empty */
+			for(j = (i + 1) & mask; s->entries[j].key; j = (j + 1) & mask) {
+				home = JM_POINTER_MAP_SLOT(jm_pointer_map_hash(s->entries[j].key), s->capacity);
+				if(((j - home) & mask) >= ((j - i) & mask)) {
+					s->entries[i] = s->entries[j];
+					i = j;
+				}
+			}
+			s->entries[i].key = 0;
+			s->entries[i].value = 0;
+			s->size--;
+			removed = 1;
+			if(s->size == 0) {
+				map->callbacks->free(s->entries);
+				s->entries = 0;
+				s->capacity = 0;
+			}
+		}
+	}
+	jm_mutex_unlock(&s->lock);
+	return removed;
+}
+
+size_t jm_pointer_map_get_size(jm_pointer_map_t* map) {
+	size_t k, size = 0;
+
+	for(k = 0; k < JM_POINTER_MAP_STRIPES; k++) {
+		jm_mutex_lock(&map->stripes[k].lock);
+		size += map->stripes[k].size;
+		jm_mutex_unlock(&map->stripes[k].lock);
+	}
+	return size;
+}
@@ -0,0 +1,182 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+#include <string.h>
+
+#include <fmilib_config.h>
+#include <JM/jm_portability.h>
+#include <JM/jm_spill_file.h>
+
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#endif
+
+static const char* module = "JMSPILL";
+
+struct jm_spill_file_t {
+	jm_callbacks* callbacks;
+#ifdef WIN32
+	HANDLE handle;
+	HANDLE mapping;
+#else
+	int fd;
+#endif
+	size_t size;         /* bytes written */
+	const char* mapped;  /* mapping of the first 'mappedSize' bytes */
+	size_t mappedSize;
+};
+
+static void jm_spill_file_unmap(jm_spill_file_t* file) {
+	if(!file->mapped) return;
+#ifdef WIN32
+	UnmapViewOfFile((LPCVOID)file->mapped);
+	CloseHandle(file->mapping);
+#else
+	munmap((void*)file->mapped, file->mappedSize);
+#endif
+	file->mapped = 0;
+	file->mappedSize = 0;
+}
+
+jm_spill_file_t* jm_spill_file_create(jm_callbacks* cb, const char* dir) {
+	jm_spill_file_t* file;
+	char path[FILENAME_MAX + 2];
+	size_t len;
+
+	if(!cb) cb = jm_get_default_callbacks();
+	if(!dir) {
+		dir = jm_get_system_temp_dir();
+		if(!dir) dir = "./";
+	}
+	len = strlen(dir);
+	if(len + 20 > FILENAME_MAX) {
+		jm_log_fatal(cb, module, "Directory name for the spill file is too long");
+		return 0;
+	}
+	if(len > 0 && dir[len - 1] != FMI_FILE_SEP[0] && dir[len - 1] != '/')
+		sprintf(path, "%s%sjmspillXXXXXX", dir, FMI_FILE_SEP); /*safe*/
+	else
+		sprintf(path, "%sjmspillXXXXXX", dir); /*safe*/
+	if(!jm_mktemp(path)) {
+		jm_log_fatal(cb, module, "Could not create a unique spill file name");
+		return 0;
+	}
+
+	file = (jm_spill_file_t*)cb->calloc(1, sizeof(jm_spill_file_t));
+	if(!file) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	file->callbacks = cb;
+#ifdef WIN32
+	file->handle = CreateFileA(path, GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_NEW,
+		FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL);
+	if(file->handle == INVALID_HANDLE_VALUE) {
+		jm_log_fatal(cb, module, "Could not create spill file %s", path);
+		cb->free(file);
+		return 0;
+	}
+#else
+	file->fd = open(path, O_RDWR | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
+	if(file->fd < 0) {
+		jm_log_fatal(cb, module, "Could not create spill file %s (%s)", path, strerror(errno));
+		cb->free(file);
+		return 0;
+	}
+	/* The file is removed once it is closed */
+	unlink(path);
+#endif
+	jm_log_verbose(cb, module, "Created spill file %s", path);
+	return file;
+}
+
+void jm_spill_file_free(jm_spill_file_t* file) {
+	if(!file) return;
+	jm_spill_file_unmap(file);
+#ifdef WIN32
+	CloseHandle(file->handle);
+#else
+	close(file->fd);
+#endif
+	file->callbacks->free(file);
+}
+
+jm_status_enu_t jm_spill_file_append(jm_spill_file_t* file, const void* data, size_t size, size_t* offset) {
+	const char* p = (const char*)data;
+	size_t left = size;
+
+	while(left > 0) {
+#ifdef WIN32
+		DWORD written = 0;
+		DWORD chunk = (left > 0x40000000) ? 0x40000000 : (DWORD)left;
+		if(!WriteFile(file->handle, p, chunk, &written, NULL) || written == 0) {
+			jm_log_error(file->callbacks, module, "Could not write to the spill file");
+			return jm_status_error;
+		}
+#else
+		ssize_t written = write(file->fd, p, left);
+		if(written < 0 && errno == EINTR) continue;
+		if(written <= 0) {
+			jm_log_error(file->callbacks, module, "Could not write to the spill file (%s)", strerror(errno));
+			return jm_status_error;
+		}
+#endif
+		p += written;
+		left -= (size_t)written;
+	}
+	*offset = file->size;
+	file->size += size;
+	return jm_status_success;
+}
+
+const void* jm_spill_file_map(jm_spill_file_t* file, size_t offset, size_t size) {
+	if(offset + size > file->size) {
+		jm_log_error(file->callbacks, module, "Spill file range is out of bounds");
+		return 0;
+	}
+	if(offset + size > file->mappedSize) {
+		jm_spill_file_unmap(file);
+#ifdef WIN32
+		file->mapping = CreateFileMapping(file->handle, NULL, PAGE_READONLY, 0, 0, NULL);
+		if(file->mapping) {
+			file->mapped = (const char*)MapViewOfFile(file->mapping, FILE_MAP_READ, 0, 0, 0);
+			if(!file->mapped) CloseHandle(file->mapping);
+		}
+#else
+		{
+			void* p = mmap(0, file->size, PROT_READ, MAP_SHARED, file->fd, 0);
+			file->mapped = (p == MAP_FAILED) ? 0 : (const char*)p;
+		}
+#endif
+		if(!file->mapped) {
+			jm_log_error(file->callbacks, module, "Could not map the spill file");
+			return 0;
+		}
+		file->mappedSize = file->size;
+	}
+	return file->mapped + offset;
+}
+
+size_t jm_spill_file_get_size(jm_spill_file_t* file) {
+	return file->size;
+}
@@ -0,0 +1,167 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <JM/jm_thread.h>
+
+#ifndef JM_THREAD_WIN32
+#include <unistd.h>
+#endif
+
+#ifdef JM_THREAD_WIN32
+
+static DWORD WINAPI jm_thread_start(LPVOID arg) {
+	jm_thread_t* thread = (jm_thread_t*)arg;
+	thread->func(thread->arg);
+	return 0;
+}
+
+jm_status_enu_t jm_thread_create(jm_thread_t* thread, jm_thread_func_ft func, void* arg) {
+	thread->func = func;
+	thread->arg = arg;
+	thread->handle = CreateThread(NULL, 0, jm_thread_start, thread, 0, NULL);
+	return thread->handle ? jm_status_success : jm_status_error;
+}
+
+jm_status_enu_t jm_thread_join(jm_thread_t* thread) {
+	if(WaitForSingleObject(thread->handle, INFINITE) != WAIT_OBJECT_0) return jm_status_error;
+	CloseHandle(thread->handle);
+	return jm_status_success;
+}
+
+size_t jm_thread_get_number_of_processors(void) {
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (info.dwNumberOfProcessors > 0) ? (size_t)info.dwNumberOfProcessors : 1;
+}
+
+typedef struct jm_once_call_t {
+	jm_once_func_ft func;
+} jm_once_call_t;
+
+static BOOL CALLBACK jm_once_start(PINIT_ONCE once, PVOID param, PVOID* context) {
+	((jm_once_call_t*)param)->func();
+	return TRUE;
+}
+
+void jm_once(jm_once_t* once, jm_once_func_ft func) {
+	jm_once_call_t call;
+	call.func = func;
+	InitOnceExecuteOnce(&once->once, jm_once_start, &call, NULL);
+}
+
+jm_status_enu_t jm_mutex_init(jm_mutex_t* mutex) {
+	InitializeCriticalSection(&mutex->cs);
+	return jm_status_success;
+}
+
+void jm_mutex_destroy(jm_mutex_t* mutex) {
+	DeleteCriticalSection(&mutex->cs);
+}
+
+void jm_mutex_lock(jm_mutex_t* mutex) {
+	EnterCriticalSection(&mutex->cs);
+}
+
+void jm_mutex_unlock(jm_mutex_t* mutex) {
+	LeaveCriticalSection(&mutex->cs);
+}
+
+jm_status_enu_t jm_cond_init(jm_cond_t* cond) {
+	InitializeConditionVariable(&cond->cond);
+	return jm_status_success;
+}
+
+void jm_cond_destroy(jm_cond_t* cond) {
+}
+
+void jm_cond_wait(jm_cond_t* cond, jm_mutex_t* mutex) {
+	SleepConditionVariableCS(&cond->cond, &mutex->cs, INFINITE);
+}
+
+void jm_cond_signal(jm_cond_t* cond) {
+	WakeConditionVariable(&cond->cond);
+}
+
+void jm_cond_broadcast(jm_cond_t* cond) {
+	WakeAllConditionVariable(&cond->cond);
+}
+
+#else
+
+static void* jm_thread_start(void* arg) {
+	jm_thread_t* thread = (jm_thread_t*)arg;
+	thread->func(thread->arg);
+	return 0;
+}
+
+jm_status_enu_t jm_thread_create(jm_thread_t* thread, jm_thread_func_ft func, void* arg) {
+	thread->func = func;
+	thread->arg = arg;
+	return (pthread_create(&thread->handle, 0, jm_thread_start, thread) == 0) ? jm_status_success : jm_status_error;
+}
+
+jm_status_enu_t jm_thread_join(jm_thread_t* thread) {
+	return (pthread_join(thread->handle, 0) == 0) ? jm_status_success : jm_status_error;
+}
+
+size_t jm_thread_get_number_of_processors(void) {
+#ifdef _SC_NPROCESSORS_ONLN
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	if(n > 0) return (size_t)n;
+#endif
+	return 1;
+}
+
+void jm_once(jm_once_t* once, jm_once_func_ft func) {
+	pthread_once(&once->once, func);
+}
+
+jm_status_enu_t jm_mutex_init(jm_mutex_t* mutex) {
+	return (pthread_mutex_init(&mutex->mutex, 0) == 0) ? jm_status_success : jm_status_error;
+}
+
+void jm_mutex_destroy(jm_mutex_t* mutex) {
+	pthread_mutex_destroy(&mutex->mutex);
+}
+
+void jm_mutex_lock(jm_mutex_t* mutex) {
+	pthread_mutex_lock(&mutex->mutex);
+}
+
+void jm_mutex_unlock(jm_mutex_t* mutex) {
+	pthread_mutex_unlock(&mutex->mutex);
+}
+
+jm_status_enu_t jm_cond_init(jm_cond_t* cond) {
+	return (pthread_cond_init(&cond->cond, 0) == 0) ? jm_status_success : jm_status_error;
+}
+
+void jm_cond_destroy(jm_cond_t* cond) {
+	pthread_cond_destroy(&cond->cond);
+}
+
+void jm_cond_wait(jm_cond_t* cond, jm_mutex_t* mutex) {
+	pthread_cond_wait(&cond->cond, &mutex->mutex);
+}
+
+void jm_cond_signal(jm_cond_t* cond) {
+	pthread_cond_signal(&cond->cond);
+}
+
+void jm_cond_broadcast(jm_cond_t* cond) {
+	pthread_cond_broadcast(&cond->cond);
+}
+
+#endif
@@ -0,0 +1,267 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <string.h>
+
+#include <JM/jm_thread.h>
+#include <JM/jm_thread_pool.h>
+
+static const char* module = "JMPOOL";
+
+#define JM_THREAD_POOL_INITIAL_CAPACITY 16
+
+typedef struct jm_thread_pool_task_t {
+	jm_thread_pool_task_ft func;
+	void* data;
+} jm_thread_pool_task_t;
+
+/* Task queue of one worker: a ring buffer, the owner works at the back, thieves at the front */
+typedef struct jm_thread_pool_queue_t {
+	jm_mutex_t lock;
+	jm_thread_pool_task_t* tasks;
+	size_t capacity;
+	size_t first;
+	size_t size;
+} jm_thread_pool_queue_t;
+
+typedef struct jm_thread_pool_worker_t {
+	jm_thread_pool_t* pool;
+	size_t index;
+	jm_thread_t thread;
+	jm_thread_pool_queue_t queue;
+} jm_thread_pool_worker_t;
+
+struct jm_thread_pool_t {
+	jm_callbacks* callbacks;
+	size_t numThreads;
+	jm_thread_pool_worker_t* workers;
+
+	/* 'lock' protects the counters below */
+	jm_mutex_t lock;
+	jm_cond_t workAvailable;
+	jm_cond_t allDone;
+	size_t queued;     /* tasks in the queues not yet claimed by a worker */
+	size_t pending;    /* tasks submitted and not yet finished */
+	size_t next;       /* round-robin queue for jm_thread_pool_submit */
+	int stop;
+};
+
+static int jm_thread_pool_push(jm_thread_pool_t* pool, jm_thread_pool_queue_t* q, jm_thread_pool_task_ft func, void* data) {
+	size_t pos;
+
+	jm_mutex_lock(&q->lock);
+	if(q->size == q->capacity) {
+		size_t newCapacity = q->capacity ? 2 * q->capacity : JM_THREAD_POOL_INITIAL_CAPACITY, i;
+		jm_thread_pool_task_t* tasks = (jm_thread_pool_task_t*)pool->callbacks->malloc(newCapacity * sizeof(jm_thread_pool_task_t));
+		if(!tasks) {
+			jm_mutex_unlock(&q->lock);
+			jm_log_fatal(pool->callbacks, module, "Could not allocate memory");
+			return 0;
+		}
+		for(i = 0; i < q->size; i++) tasks[i] = q->tasks[(q->first + i) % q->capacity];
+		pool->callbacks->free(q->tasks);
+		q->tasks = tasks;
+		q->capacity = newCapacity;
+		q->first = 0;
+	}
+	pos = (q->first + q->size) % q->capacity;
+	q->tasks[pos].func = func;
+	q->tasks[pos].data = data;
+	q->size++;
+	jm_mutex_unlock(&q->lock);
+	return 1;
+}
+
+/* Take a task from the back (owner) or the front (thief) of a queue */
+static int jm_thread_pool_pop(jm_thread_pool_queue_t* q, int back, jm_thread_pool_task_t* task) {
+	int found = 0;
+
+	jm_mutex_lock(&q->lock);
+	if(q->size > 0) {
+		if(back) {
+			*task = q->tasks[(q->first + q->size - 1) % q->capacity];
+		}
+		else {
+			*task = q->tasks[q->first];
+			q->first = (q->first + 1) % q->capacity;
+		}
+		q->size--;
+		found = 1;
+	}
+	jm_mutex_unlock(&q->lock);
+	return found;
+}
+
+static void jm_thread_pool_worker(void* arg) {
+	jm_thread_pool_worker_t* self = (jm_thread_pool_worker_t*)arg;
+	jm_thread_pool_t* pool = self->pool;
+	size_t n = pool->numThreads;
+
+	for(;;) {
+		jm_thread_pool_task_t task;
+		size_t k;
+
+		jm_mutex_lock(&pool->lock);
+		while(pool->queued == 0 && !pool->stop)
+			jm_cond_wait(&pool->workAvailable, &pool->lock);
+		if(pool->queued == 0) {
+			jm_mutex_unlock(&pool->lock);
+			break;
+		}
+		pool->queued--;
+		jm_mutex_unlock(&pool->lock);
+
+		/* A task is reserved for this worker; it is in one of the queues */
+		for(k = 0; ; k++) {
+			if(k % n == 0) {
+				if(jm_thread_pool_pop(&self->queue, 1, &task)) break;
+			}
+			else if(jm_thread_pool_pop(&pool->workers[(self->index + k) % n].queue, 0, &task)) {
+				break;
+			}
+		}
+		task.func(pool, self->index, task.data);
+
+		jm_mutex_lock(&pool->lock);
+		if(--pool->pending == 0) jm_cond_broadcast(&pool->allDone);
+		jm_mutex_unlock(&pool->lock);
+	}
+}
+
+static jm_status_enu_t jm_thread_pool_enqueue(jm_thread_pool_t* pool, size_t worker, jm_thread_pool_task_ft task, void* data) {
+	jm_mutex_lock(&pool->lock);
+	pool->pending++;
+	jm_mutex_unlock(&pool->lock);
+
+	if(!jm_thread_pool_push(pool, &pool->workers[worker].queue, task, data)) {
+		jm_mutex_lock(&pool->lock);
+		if(--pool->pending == 0) jm_cond_broadcast(&pool->allDone);
+		jm_mutex_unlock(&pool->lock);
+		return jm_status_error;
+	}
+
+	jm_mutex_lock(&pool->lock);
+	pool->queued++;
+	jm_cond_signal(&pool->workAvailable);
+	jm_mutex_unlock(&pool->lock);
+	return jm_status_success;
+}
+
+jm_status_enu_t jm_thread_pool_submit(jm_thread_pool_t* pool, jm_thread_pool_task_ft task, void* data) {
+	size_t worker;
+
+	jm_mutex_lock(&pool->lock);
+	worker = pool->next;
+	pool->next = (pool->next + 1) % pool->numThreads;
+	jm_mutex_unlock(&pool->lock);
+	return jm_thread_pool_enqueue(pool, worker, task, data);
+}
+
+jm_status_enu_t jm_thread_pool_submit_local(jm_thread_pool_t* pool, size_t worker, jm_thread_pool_task_ft task, void* data) {
+	return jm_thread_pool_enqueue(pool, worker % pool->numThreads, task, data);
+}
+
+void jm_thread_pool_wait(jm_thread_pool_t* pool) {
+	jm_mutex_lock(&pool->lock);
+	while(pool->pending > 0)
+		jm_cond_wait(&pool->allDone, &pool->lock);
+	jm_mutex_unlock(&pool->lock);
+}
+
+size_t jm_thread_pool_get_number_of_threads(jm_thread_pool_t* pool) {
+	return pool->numThreads;
+}
+
+jm_thread_pool_t* jm_thread_pool_create(jm_callbacks* cb, size_t numThreads) {
+	jm_thread_pool_t* pool;
+	size_t i;
+
+	if(!cb) cb = jm_get_default_callbacks();
+	if(numThreads == 0) numThreads = jm_thread_get_number_of_processors();
+
+	pool = (jm_thread_pool_t*)cb->calloc(1, sizeof(jm_thread_pool_t));
+	if(pool) pool->workers = (jm_thread_pool_worker_t*)cb->calloc(numThreads, sizeof(jm_thread_pool_worker_t));
+	if(!pool || !pool->workers) {
+		if(pool) cb->free(pool);
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	pool->callbacks = cb;
+	if(jm_mutex_init(&pool->lock) != jm_status_success ||
+		jm_cond_init(&pool->workAvailable) != jm_status_success ||
+		jm_cond_init(&pool->allDone) != jm_status_success) {
+		jm_log_fatal(cb, module, "Could not initialize the synchronization primitives");
+		cb->free(pool->workers);
+		cb->free(pool);
+		return 0;
+	}
+	for(i = 0; i < numThreads; i++) {
+		jm_thread_pool_worker_t* w = &pool->workers[i];
+		w->pool = pool;
+		w->index = i;
+		jm_mutex_init(&w->queue.lock);
+	}
+	/* numThreads must be set before the workers start since they use it for stealing */
+	pool->numThreads = numThreads;
+	for(i = 0; i < numThreads; i++) {
+		if(jm_thread_create(&pool->workers[i].thread, jm_thread_pool_worker, &pool->workers[i]) != jm_status_success) {
+			jm_log_error(cb, module, "Could not start worker thread %u", (unsigned)i);
+			break;
+		}
+	}
+	if(i < numThreads) {
+		/* stop the threads already started */
+		size_t started = i;
+		jm_mutex_lock(&pool->lock);
+		pool->stop = 1;
+		jm_cond_broadcast(&pool->workAvailable);
+		jm_mutex_unlock(&pool->lock);
+		for(i = 0; i < started; i++) jm_thread_join(&pool->workers[i].thread);
+		for(i = 0; i < numThreads; i++) jm_mutex_destroy(&pool->workers[i].queue.lock);
+		jm_cond_destroy(&pool->allDone);
+		jm_cond_destroy(&pool->workAvailable);
+		jm_mutex_destroy(&pool->lock);
+		cb->free(pool->workers);
+		cb->free(pool);
+		return 0;
+	}
+	jm_log_verbose(cb, module, "Started thread pool with %u threads", (unsigned)numThreads);
+	return pool;
+}
+
+void jm_thread_pool_free(jm_thread_pool_t* pool) {
+	jm_callbacks* cb;
+	size_t i;
+
+	if(!pool) return;
+	cb = pool->callbacks;
+	jm_thread_pool_wait(pool);
+
+	jm_mutex_lock(&pool->lock);
+	pool->stop = 1;
+	jm_cond_broadcast(&pool->workAvailable);
+	jm_mutex_unlock(&pool->lock);
+	for(i = 0; i < pool->numThreads; i++) jm_thread_join(&pool->workers[i].thread);
+
+	for(i = 0; i < pool->numThreads; i++) {
+		jm_mutex_destroy(&pool->workers[i].queue.lock);
+		cb->free(pool->workers[i].queue.tasks);
+	}
+	jm_cond_destroy(&pool->allDone);
+	jm_cond_destroy(&pool->workAvailable);
+	jm_mutex_destroy(&pool->lock);
+	cb->free(pool->workers);
+	cb->free(pool);
+}
@@ -0,0 +1,298 @@
+/*
+    Copyright (C) 2012 Modelon AB
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the BSD style license.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    FMILIB_License.txt file for more details.
+
+    You should have received a copy of the FMILIB_License.txt file
+    along with this program. If not, contact Modelon AB <http://www.modelon.com>.
+*/
+
+#include <stdio.h>
+
+#include <JM/jm_thread.h>
+#include <JM/jm_call_statistics.h>
+#include <JM/jm_trace.h>
+
+static const char* module = "JMTRACE";
+
+#define JM_TRACE_CHUNK_EVENTS 4096
+
+typedef struct jm_trace_event_t {
+	const char* category;
+	const char* name;
+	double start;
+	double duration;
+	char phase;
+} jm_trace_event_t;
+
+typedef struct jm_trace_chunk_t {
+	struct jm_trace_chunk_t* next;
+	size_t size;
+	jm_trace_event_t events[JM_TRACE_CHUNK_EVENTS];
+} jm_trace_chunk_t;
+
+/* Event buffer of one thread. Only the owning thread appends to it. The lock of the buffer
+   is only contended while jm_trace_start() or jm_trace_stop() visit the buffers, so that the
+   chunks are never freed under a thread that is recording. The buffers are never freed since
+   the thread local pointers refer to them; the buffer of a thread that has exited is reused
+   once its events are written. */
+typedef struct jm_trace_thread_t {
+	struct jm_trace_thread_t* next;
+	jm_mutex_t lock;
+	unsigned id;
+	int exited;
+	size_t dropped;
+	jm_trace_chunk_t* first;
+	jm_trace_chunk_t* last;
+} jm_trace_thread_t;
+
+static jm_callbacks* trace_cb = 0;
+static volatile int trace_active = 0;
+static double trace_origin = 0;
+static int trace_initialized = 0;
+static jm_mutex_t trace_lock;
+static jm_trace_thread_t* trace_threads = 0;
+static unsigned trace_next_id = 0;
+
+#ifdef JM_THREAD_WIN32
+static DWORD trace_tls;
+
+static VOID WINAPI jm_trace_thread_exit(PVOID p) {
+	jm_trace_thread_t* t = (jm_trace_thread_t*)p;
+	if(!t) return;
+	jm_mutex_lock(&trace_lock);
+	t->exited = 1;
+	jm_mutex_unlock(&trace_lock);
+}
+
+static int jm_trace_tls_init(void) {
+	trace_tls = FlsAlloc(jm_trace_thread_exit);
+	return trace_tls != FLS_OUT_OF_INDEXES;
+}
+#define jm_trace_tls_get() ((jm_trace_thread_t*)FlsGetValue(trace_tls))
+#define jm_trace_tls_set(t) FlsSetValue(trace_tls, t)
+#else
+static pthread_key_t trace_tls;
+
+static void jm_trace_thread_exit(void* p) {
+	jm_trace_thread_t* t = (jm_trace_thread_t*)p;
+	jm_mutex_lock(&trace_lock);
+	t->exited = 1;
+	jm_mutex_unlock(&trace_lock);
+}
+
+static int jm_trace_tls_init(void) {
+	return pthread_key_create(&trace_tls, jm_trace_thread_exit) == 0;
+}
+#define jm_trace_tls_get() ((jm_trace_thread_t*)pthread_getspecific(trace_tls))
+#define jm_trace_tls_set(t) pthread_setspecific(trace_tls, t)
+#endif
+
+/* Get the buffer of the calling thread, registering the thread on first use */
+static jm_trace_thread_t* jm_trace_get_thread(void) {
+	jm_trace_thread_t* t = jm_trace_tls_get();
+	if(t) return t;
+
+	jm_mutex_lock(&trace_lock);
+	for(t = trace_threads; t; t = t->next) {
+		if(t->exited && !t->first) break;
+	}
+	if(!t) {
+		t = (jm_trace_thread_t*)trace_cb->calloc(1, sizeof(jm_trace_thread_t));
+		if(t && jm_mutex_init(&t->lock) != jm_status_success) {
+			trace_cb->free(t);
+			t = 0;
+		}
+		if(t) {
+			t->next = trace_threads;
+			trace_threads = t;
+		}
+	}
+	if(t) {
+		t->id = ++trace_next_id;
+		t->exited = 0;
+		t->dropped = 0;
+	}
+	jm_mutex_unlock(&trace_lock);
+	if(t) jm_trace_tls_set(t);
+	return t;
+}
+
+static void jm_trace_add(char phase, const char* category, const char* name, double start, double duration) {
+	jm_trace_thread_t* t = jm_trace_get_thread();
+	jm_trace_chunk_t* chunk;
+	jm_trace_event_t* e;
+
+	if(!t) return;
+	jm_mutex_lock(&t->lock);
+	/* Tracing may have been stopped since the caller checked */
+	if(!trace_active) {
+		jm_mutex_unlock(&t->lock);
+		return;
+	}
+	chunk = t->last;
+	if(!chunk || chunk->size == JM_TRACE_CHUNK_EVENTS) {
+		chunk = (jm_trace_chunk_t*)trace_cb->malloc(sizeof(jm_trace_chunk_t));
+		if(!chunk) {
+			t->dropped++;
+			jm_mutex_unlock(&t->lock);
+			return;
+		}
+		chunk->next = 0;
+		chunk->size = 0;
+		if(t->last) t->last->next = chunk;
+		else t->first = chunk;
+		t->last = chunk;
+	}
+	e = &chunk->events[chunk->size];
+	e->category = category;
+	e->name = name;
+	e->start = start;
+	e->duration = duration;
+	e->phase = phase;
+	chunk->size++;
+	jm_mutex_unlock(&t->lock);
+}
+
+static void jm_trace_write_string(FILE* f, const char* s) {
+	fputc('"', f);
+	for(; *s; s++) {
+		if(*s == '"' || *s == '\\') fprintf(f, "\\%c", *s);
+		else if((unsigned char)*s < 0x20) fprintf(f, "\\u%04x", (unsigned)(unsigned char)*s);
+		else fputc(*s, f);
+	}
+	fputc('"', f);
+}
+
+/* Write the events of a thread (if f is not NULL) and free them. Returns the number of events. */
+static size_t jm_trace_flush_thread(jm_trace_thread_t* t, FILE* f, int* first) {
+	jm_trace_chunk_t* chunk = t->first;
+	size_t k, count = 0;
+
+	if(f && chunk) {
+		fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+			*first ? "" : ",\n", t->id, t->id);
+		*first = 0;
+	}
+	while(chunk) {
+		jm_trace_chunk_t* next = chunk->next;
+		for(k = 0; f && k < chunk->size; k++) {
+			jm_trace_event_t* e = &chunk->events[k];
+			fputs(",\n{\"name\":", f);
+			jm_trace_write_string(f, e->name);
+			fputs(",\"cat\":", f);
+			jm_trace_write_string(f, e->category);
+			fprintf(f, ",\"ph\":\"%c\",\"ts\":%.3f", e->phase, (e->start - trace_origin) * 1e6);
+			if(e->phase == 'X') fprintf(f, ",\"dur\":%.3f", e->duration * 1e6);
+			fprintf(f, ",\"pid\":1,\"tid\":%u}", t->id);
+		}
+		count += chunk->size;
+		trace_cb->free(chunk);
+		chunk = next;
+	}
+	t->first = t->last = 0;
+	return count;
+}
+
+jm_status_enu_t jm_trace_start(jm_callbacks* cb) {
+	jm_trace_thread_t* t;
+
+	if(!cb) cb = jm_get_default_callbacks();
+	if(trace_active) {
+		jm_log_error(cb, module, "Tracing is already active");
+		return jm_status_error;
+	}
+	if(!trace_initialized) {
+		if(jm_mutex_init(&trace_lock) != jm_status_success) {
+			jm_log_fatal(cb, module, "Could not initialize a mutex");
+			return jm_status_error;
+		}
+		if(!jm_trace_tls_init()) {
+			jm_mutex_destroy(&trace_lock);
+			jm_log_fatal(cb, module, "Could not allocate thread local storage");
+			return jm_status_error;
+		}
+		trace_initialized = 1;
+	}
+	jm_mutex_lock(&trace_lock);
+	trace_cb = cb;
+	trace_origin = jm_get_monotonic_time();
+	for(t = trace_threads; t; t = t->next) {
+		jm_mutex_lock(&t->lock);
+		t->dropped = 0;
+		jm_mutex_unlock(&t->lock);
+	}
+	trace_active = 1;
+	jm_mutex_unlock(&trace_lock);
+	jm_log_verbose(cb, module, "Started tracing");
+	return jm_status_success;
+}
+
+jm_status_enu_t jm_trace_stop(const char* fileName) {
+	jm_trace_thread_t* t;
+	FILE* f = 0;
+	size_t count = 0, dropped = 0;
+	int first = 1;
+	jm_status_enu_t status = jm_status_success;
+
+	if(!trace_active) {
+		jm_log_error(trace_cb ? trace_cb : jm_get_default_callbacks(), module, "Tracing is not active");
+		return jm_status_error;
+	}
+	trace_active = 0;
+
+	if(fileName) {
+		f = fopen(fileName, "w");
+		if(!f) {
+			jm_log_error(trace_cb, module, "Could not open %s for writing", fileName);
+			status = jm_status_error;
+		}
+		else fputs("{\"traceEvents\":[\n", f);
+	}
+	jm_mutex_lock(&trace_lock);
+	for(t = trace_threads; t; t = t->next) {
+		/* Wait for an event that is being added, later events see that tracing is stopped */
+		jm_mutex_lock(&t->lock);
+		count += jm_trace_flush_thread(t, f, &first);
+		dropped += t->dropped;
+		jm_mutex_unlock(&t->lock);
+	}
+	jm_mutex_unlock(&trace_lock);
+	if(f) {
+		fputs("\n],\"displayTimeUnit\":\"ns\"}\n", f);
+		if(ferror(f)) {
+			jm_log_error(trace_cb, module, "Could not write the trace to %s", fileName);
+			status = jm_status_error;
+		}
+		if(fclose(f) != 0) status = jm_status_error;
+	}
+	if(dropped)
+		jm_log_warning(trace_cb, module, "%u trace events were lost since memory could not be allocated", (unsigned)dropped);
+	jm_log_verbose(trace_cb, module, "Stopped tracing, %u events recorded", (unsigned)count);
+	return status;
+}
+
+int jm_trace_is_active(void) {
+	return trace_active;
+}
+
+void jm_trace_begin(const char* category, const char* name) {
+	if(!trace_active) return;
+	jm_trace_add('B', category, name, jm_get_monotonic_time(), 0);
+}
+
+void jm_trace_end(const char* category, const char* name) {
+	if(!trace_active) return;
+	jm_trace_add('E', category, name, jm_get_monotonic_time(), 0);
+}
+
+void jm_trace_complete(const char* category, const char* name, double start, double end) {
+	if(!trace_active) return;
+	jm_trace_add('X', category, name, start, end - start);
+}
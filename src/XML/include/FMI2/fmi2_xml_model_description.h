@@ -51,6 +51,9 @@ extern "C" {
 /** \brief Model structure object */
 typedef struct fmi2_xml_model_structure_t fmi2_xml_model_structure_t;
 
+/** \brief Compiled variable query */
+typedef struct fmi2_xml_query_t fmi2_xml_query_t;
+
 /**\name  Type definitions supporting structures
 @{ */
 typedef struct fmi2_xml_real_typedef_t fmi2_xml_real_typedef_t;
@@ -196,6 +199,14 @@ unsigned int fmi2_xml_get_capability(fmi2_xml_model_description_t* , fmi2_capabi
 
 jm_vector(jm_voidp)* fmi2_xml_get_variables_original_order(fmi2_xml_model_description_t* md);
 
+/**
+	\brief Get the position of a variable in fmi2_xml_get_variables_original_order().
+
+	The position equals fmi2_xml_get_variable_original_order() unless variables were removed as bad aliases.
+	\return The position or the number of variables if the variable is not in the model description.
+*/
+size_t fmi2_xml_get_variable_position(fmi2_xml_model_description_t* md, fmi2_xml_variable_t* v);
+
 jm_vector(jm_named_ptr)* fmi2_xml_get_variables_alphabetical_order(fmi2_xml_model_description_t* md);
 
 jm_vector(jm_voidp)* fmi2_xml_get_variables_vr_order(fmi2_xml_model_description_t* md);
@@ -208,6 +219,40 @@ jm_vector(jm_voidp)* fmi2_xml_get_variables_vr_order(fmi2_xml_model_description_
 */
 fmi2_xml_variable_t* fmi2_xml_get_variable_by_name(fmi2_xml_model_description_t* md, const char* name);
 
+/**
+	\brief Match a hierarchical variable name against a name pattern.
+
+	'*' matches any characters within one component of the name, i.e., not '.', '**' (or more
+	stars) matches any characters, '?' matches one character that is not '.'. A subscript with ranges or '*',
+	e.g., "[2:4]" or "[*,1]", matches array subscripts with the same number of indices that
+	are in the ranges. Other characters match themselves.
+*/
+int fmi2_xml_match_variable_name(const char* pattern, const char* name);
+
+/** \brief Get the length of the literal prefix of a name pattern, i.e., the characters before the first wildcard */
+size_t fmi2_xml_get_name_pattern_prefix_len(const char* pattern);
+
+/**
+	\brief Get the variables whose names start with a prefix.
+	\param md - the model description
+	\param prefix - the prefix
+	\param prefixLen - number of characters of prefix to use
+	\param first - output index of the first variable in fmi2_xml_get_variables_alphabetical_order()
+	\return number of variables with the prefix
+*/
+size_t fmi2_xml_get_variable_name_prefix_range(fmi2_xml_model_description_t* md, const char* prefix, size_t prefixLen, size_t* first);
+
+/**
+	\brief Append the variables with names matching a pattern to a vector in alphabetical order.
+
+	Only the variables with the literal prefix of the pattern are visited.
+	\param md - the model description
+	\param pattern - a name pattern, see fmi2_xml_match_variable_name()
+	\param out - the vector to append to
+	\return jm_status_error if memory allocation failed
+*/
+jm_status_enu_t fmi2_xml_get_variables_by_name_pattern(fmi2_xml_model_description_t* md, const char* pattern, jm_vector(jm_voidp)* out);
+
 /**
 	\brief Get variable by value reference.
 	\param md - the model description
@@ -217,6 +262,52 @@ fmi2_xml_variable_t* fmi2_xml_get_variable_by_name(fmi2_xml_model_description_t*
 */
 fmi2_xml_variable_t* fmi2_xml_get_variable_by_vr(fmi2_xml_model_description_t* md, fmi2_base_type_enu_t baseType, fmi2_value_reference_t vr);
 
+/** \brief Attributes of the elementary queries that may be evaluated with precomputed masks */
+typedef enum fmi2_xml_query_mask_enu_t {
+	fmi2_xml_query_mask_causality,   /**< \brief Value is a ::fmi2_causality_enu_t */
+	fmi2_xml_query_mask_variability, /**< \brief Value is a ::fmi2_variability_enu_t */
+	fmi2_xml_query_mask_initial,     /**< \brief Value is a ::fmi2_initial_enu_t */
+	fmi2_xml_query_mask_base_type,   /**< \brief Value is a ::fmi2_base_type_enu_t */
+	fmi2_xml_query_mask_alias_kind,  /**< \brief Value is a ::fmi2_variable_alias_kind_enu_t */
+	fmi2_xml_query_mask_has_start    /**< \brief Value is 1 */
+} fmi2_xml_query_mask_enu_t;
+
+/**
+	\brief Get a precomputed mask for fmi2_xml_query_evaluate().
+	\return The words of a bitset in the layout of fmi2_xml_query_evaluate() or NULL if the
+		elementary query is to be evaluated variable by variable.
+*/
+typedef const size_t* (*fmi2_xml_query_mask_ft)(void* context, fmi2_xml_query_mask_enu_t attribute, int value);
+
+/**
+	\brief Compile a variable query, see fmi2_xml_query.h for the syntax.
+	\param md - the model description
+	\param query - the query string
+	\return The compiled query or NULL if the query has a syntax error (logged) or memory allocation failed.
+*/
+fmi2_xml_query_t* fmi2_xml_compile_query(fmi2_xml_model_description_t* md, const char* query);
+
+/** \brief Free a compiled query */
+void fmi2_xml_free_query(fmi2_xml_query_t* q);
+
+/** \brief Evaluate a compiled query for one variable. Returns non-zero if the variable matches. */
+int fmi2_xml_query_variable(fmi2_xml_query_t* q, fmi2_xml_variable_t* v);
+
+/**
+	\brief Evaluate a compiled query for all the variables of a model description.
+
+	The result is a bitset of size_t words with bit k (word k / bits per word, bit k % bits per word)
+	set if variable k of fmi2_xml_get_variables_original_order() matches the query. The bits
+	after the last variable are cleared.
+	\param q - the compiled query
+	\param md - the model description, must be the one the query was compiled for
+	\param getMask - function that provides precomputed masks, may be NULL
+	\param context - passed to getMask
+	\param words - output bitset
+	\return jm_status_error if md is not the model description of the query or memory allocation failed.
+*/
+jm_status_enu_t fmi2_xml_query_evaluate(fmi2_xml_query_t* q, fmi2_xml_model_description_t* md, fmi2_xml_query_mask_ft getMask, void* context, size_t* words);
+
 /** \brief Get the number of vendors that had annotations in the XML*/
 size_t fmi2_xml_get_vendors_num(fmi2_xml_model_description_t* md);
 
@@ -41,6 +41,7 @@ fmi_xml_context_t* fmi_xml_allocate_context( jm_callbacks* callbacks) {
 	c->callbacks = callbacks;
 	c->parser = 0;
 	c->fmi_version = fmi_version_unknown_enu;
+	c->memoryAccounting = 0;
 	jm_log_debug(callbacks, MODULE, "Returning allocated context");
     return c;
 }
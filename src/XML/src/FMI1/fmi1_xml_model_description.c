@@ -14,6 +14,7 @@
 */
 
 #include <stdio.h>
+#include <string.h>
 
 
 #include <JM/jm_named_ptr.h>
@@ -23,6 +24,55 @@
 
 static const char* module = "FMI1XML";
 
+static void fmi1_xml_free_vr_index(fmi1_xml_model_description_t* md) {
+	size_t k;
+	for(k = 0; k < FMI1_XML_VR_INDEX_NUM; k++) {
+		md->callbacks->free(md->vrIndex[k].variables);
+		md->vrIndex[k].variables = 0;
+		md->vrIndex[k].size = 0;
+	}
+}
+
+/* Enumerations share the value references of integers */
+static fmi1_base_type_enu_t fmi1_xml_vr_index_type(fmi1_xml_variable_t* v) {
+	fmi1_base_type_enu_t bt = fmi1_xml_get_variable_base_type(v);
+	return (bt == fmi1_base_type_enum) ? fmi1_base_type_int : bt;
+}
+
+void fmi1_xml_build_vr_index(fmi1_xml_model_description_t* md) {
+	size_t n = md->variablesByVR ? jm_vector_get_size(jm_voidp)(md->variablesByVR) : 0, i = 0, j;
+
+	fmi1_xml_free_vr_index(md);
+	while(i < n) {
+		fmi1_xml_variable_t* v = (fmi1_xml_variable_t*)jm_vector_get_item(jm_voidp)(md->variablesByVR, i);
+		fmi1_base_type_enu_t bt = fmi1_xml_vr_index_type(v);
+		fmi1_xml_vr_index_t* index = &md->vrIndex[bt];
+		fmi1_value_reference_t last = v->vr;
+		size_t count = 0, range;
+
+		for(j = i; j < n; j++) {
+			fmi1_xml_variable_t* w = (fmi1_xml_variable_t*)jm_vector_get_item(jm_voidp)(md->variablesByVR, j);
+			if(fmi1_xml_vr_index_type(w) != bt) break;
+			last = w->vr;
+			if(w->aliasKind == fmi1_variable_is_not_alias) count++;
+		}
+		/* A table of pointers is used if at most 3/4 of it would be empty */
+		range = (size_t)(last - v->vr) + 1;
+		if(range && range / 4 <= count) {
+			index->variables = (fmi1_xml_variable_t**)md->callbacks->calloc(range, sizeof(fmi1_xml_variable_t*));
+		}
+		if(index->variables) {
+			index->first = v->vr;
+			index->size = range;
+			for(; i < j; i++) {
+				fmi1_xml_variable_t* w = (fmi1_xml_variable_t*)jm_vector_get_item(jm_voidp)(md->variablesByVR, i);
+				if(w->aliasKind == fmi1_variable_is_not_alias) index->variables[w->vr - index->first] = w;
+			}
+		}
+		i = j;
+	}
+}
+
 fmi1_xml_model_description_t * fmi1_xml_allocate_model_description( jm_callbacks* callbacks) {
     jm_callbacks* cb;
     fmi1_xml_model_description_t* md;
@@ -77,6 +127,8 @@ fmi1_xml_model_description_t * fmi1_xml_allocate_model_description( jm_callbacks
 
 	md->variablesByVR = 0;
 
+	memset(md->vrIndex, 0, sizeof(md->vrIndex));
+
 	md->inputVariables = 0;
 
 	md->outputVariables = 0;
@@ -138,6 +190,7 @@ void fmi1_xml_clear_model_description( fmi1_xml_model_description_t* md) {
 		jm_vector_free(jm_voidp)(md->variablesByVR);
 		md->variablesByVR = 0;
 	}
+	fmi1_xml_free_vr_index(md);
 
 	if(md->inputVariables) {
 		jm_vector_free(jm_voidp)(md->inputVariables);
@@ -391,6 +444,13 @@ fmi1_xml_variable_t* fmi1_xml_get_variable_by_vr(fmi1_xml_model_description_t* m
 	fmi1_xml_variable_t *v = 0;
     void ** found;
 	if(!md->variablesByVR) return 0;
+	if(baseType >= fmi1_base_type_real && baseType <= fmi1_base_type_enum) {
+		fmi1_xml_vr_index_t* index = &md->vrIndex[(baseType == fmi1_base_type_enum) ? fmi1_base_type_int : baseType];
+		if(index->variables) {
+			if(vr < index->first || vr - index->first >= index->size) return 0;
+			return index->variables[vr - index->first];
+		}
+	}
 	keyType.structKind = fmi1_xml_type_struct_enu_base;
 	keyType.baseType = baseType;
 	key.typeBase = &keyType;
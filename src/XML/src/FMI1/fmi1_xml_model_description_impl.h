@@ -18,6 +18,16 @@
 extern "C" {
 #endif
 
+/* Direct lookup of the non-alias variables by value reference for one base type */
+typedef struct fmi1_xml_vr_index_t {
+	fmi1_value_reference_t first;
+	size_t size;
+	fmi1_xml_variable_t** variables; /* NULL if the value references are too sparse; bsearch is used then */
+} fmi1_xml_vr_index_t;
+
+/* Real, Integer and Enumeration, Boolean, String */
+#define FMI1_XML_VR_INDEX_NUM 4
+
 typedef enum fmi1_xml_model_description_status_enu_t {
     fmi1_xml_model_description_enu_empty,
     fmi1_xml_model_description_enu_ok,
@@ -76,6 +86,8 @@ struct fmi1_xml_model_description_t {
 
 	jm_vector(jm_voidp)* variablesByVR;
 
+	fmi1_xml_vr_index_t vrIndex[FMI1_XML_VR_INDEX_NUM];
+
 	jm_vector(jm_voidp)* inputVariables;
 
 	jm_vector(jm_voidp)* outputVariables;
@@ -90,6 +102,9 @@ struct fmi1_xml_model_description_t {
     jm_vector(jm_string) additionalModels;
 };
 
+/* Build the direct value reference lookup from variablesByVR, which must be sorted with fmi1_xml_compare_vr */
+void fmi1_xml_build_vr_index(fmi1_xml_model_description_t* md);
+
 void fmi1_xml_report_error(fmi1_xml_model_description_t* md, const char* module, const char* fmt, ...);
 
 void fmi1_xml_report_error_v(fmi1_xml_model_description_t* md, const char* module, const char* fmt, va_list ap);
@@ -17,6 +17,7 @@
 #include <stdio.h>
 
 #include <JM/jm_vector.h>
+#include <JM/jm_trace.h>
 
 #include "fmi1_xml_parser.h"
 #include "fmi1_xml_type_impl.h"
@@ -932,6 +933,7 @@ int fmi1_xml_handle_ModelVariables(fmi1_xml_parser_context_t *context, const cha
 		jm_vector_free_data(jm_voidp)(inputVars);
 		jm_vector_free_data(jm_voidp)(outputVars);
 		
+        jm_trace_begin("fmilib", "Resolve aliases");
 		/* sort the variables by names */
         jm_vector_qsort(jm_named_ptr)(&md->variablesByName,jm_compare_named);
 
@@ -952,6 +954,7 @@ int fmi1_xml_handle_ModelVariables(fmi1_xml_parser_context_t *context, const cha
         md->status = fmi1_xml_model_description_enu_empty;
 		if(!md->variablesByVR || !md->variablesOrigOrder || !md->inputVariables || !md->outputVariables) {
             fmi1_xml_parse_fatal(context, "Could not allocate memory");
+            jm_trace_end("fmilib", "Resolve aliases");
             return -1;
         }
         varByVR = md->variablesByVR;
@@ -1031,6 +1034,8 @@ int fmi1_xml_handle_ModelVariables(fmi1_xml_parser_context_t *context, const cha
                 }
             } while(foundBadAlias);
         }
+        fmi1_xml_build_vr_index(md);
+        jm_trace_end("fmilib", "Resolve aliases");
 
         numvar = jm_vector_get_size(jm_named_ptr)(&md->variablesByName);
 		jm_log_verbose(context->callbacks, module,"Setting up direct dependencies cross-references");
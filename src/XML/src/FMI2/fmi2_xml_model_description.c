@@ -14,6 +14,9 @@
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 
 
 #include <JM/jm_named_ptr.h>
@@ -23,6 +26,55 @@
 
 static const char* module = "FMI2XML";
 
+static void fmi2_xml_free_vr_index(fmi2_xml_model_description_t* md) {
+	size_t k;
+	for(k = 0; k < FMI2_XML_VR_INDEX_NUM; k++) {
+		md->callbacks->free(md->vrIndex[k].variables);
+		md->vrIndex[k].variables = 0;
+		md->vrIndex[k].size = 0;
+	}
+}
+
+/* Enumerations share the value references of integers */
+static fmi2_base_type_enu_t fmi2_xml_vr_index_type(fmi2_xml_variable_t* v) {
+	fmi2_base_type_enu_t bt = fmi2_xml_get_variable_base_type(v);
+	return (bt == fmi2_base_type_enum) ? fmi2_base_type_int : bt;
+}
+
+void fmi2_xml_build_vr_index(fmi2_xml_model_description_t* md) {
+	size_t n = md->variablesByVR ? jm_vector_get_size(jm_voidp)(md->variablesByVR) : 0, i = 0, j;
+
+	fmi2_xml_free_vr_index(md);
+	while(i < n) {
+		fmi2_xml_variable_t* v = (fmi2_xml_variable_t*)jm_vector_get_item(jm_voidp)(md->variablesByVR, i);
+		fmi2_base_type_enu_t bt = fmi2_xml_vr_index_type(v);
+		fmi2_xml_vr_index_t* index = &md->vrIndex[bt];
+		fmi2_value_reference_t last = v->vr;
+		size_t count = 0, range;
+
+		for(j = i; j < n; j++) {
+			fmi2_xml_variable_t* w = (fmi2_xml_variable_t*)jm_vector_get_item(jm_voidp)(md->variablesByVR, j);
+			if(fmi2_xml_vr_index_type(w) != bt) break;
+			last = w->vr;
+			if(w->aliasKind == fmi2_variable_is_not_alias) count++;
+		}
+		/* A table of pointers is used if at most 3/4 of it would be empty */
+		range = (size_t)(last - v->vr) + 1;
+		if(range && range / 4 <= count) {
+			index->variables = (fmi2_xml_variable_t**)md->callbacks->calloc(range, sizeof(fmi2_xml_variable_t*));
+		}
+		if(index->variables) {
+			index->first = v->vr;
+			index->size = range;
+			for(; i < j; i++) {
+				fmi2_xml_variable_t* w = (fmi2_xml_variable_t*)jm_vector_get_item(jm_voidp)(md->variablesByVR, i);
+				if(w->aliasKind == fmi2_variable_is_not_alias) index->variables[w->vr - index->first] = w;
+			}
+		}
+		i = j;
+	}
+}
+
 fmi2_xml_model_description_t * fmi2_xml_allocate_model_description( jm_callbacks* callbacks) {
     jm_callbacks* cb;
     fmi2_xml_model_description_t* md;
@@ -86,6 +138,8 @@ fmi2_xml_model_description_t * fmi2_xml_allocate_model_description( jm_callbacks
 
 	md->variablesByVR = 0;
 
+	memset(md->vrIndex, 0, sizeof(md->vrIndex));
+
     jm_vector_init(jm_string)(&md->descriptions, 0, cb);
 
     md->fmuKind = fmi2_fmu_kind_unknown;
@@ -155,6 +209,7 @@ void fmi2_xml_clear_model_description( fmi2_xml_model_description_t* md) {
 		jm_vector_free(jm_voidp)(md->variablesByVR);
 		md->variablesByVR = 0;
 	}
+	fmi2_xml_free_vr_index(md);
 
     jm_vector_foreach(jm_string)(&md->descriptions, (void(*)(const char*))md->callbacks->free);
     jm_vector_free_data(jm_string)(&md->descriptions);
@@ -644,6 +699,23 @@ jm_vector(jm_voidp)* fmi2_xml_get_variables_original_order(fmi2_xml_model_descri
 	return md->variablesOrigOrder;
 }
 
+/* The original indices are increasing but may have gaps if variables were removed as bad aliases */
+size_t fmi2_xml_get_variable_position(fmi2_xml_model_description_t* md, fmi2_xml_variable_t* v) {
+	jm_vector(jm_voidp)* vars = md->variablesOrigOrder;
+	size_t n = vars ? jm_vector_get_size(jm_voidp)(vars) : 0;
+	size_t index = fmi2_xml_get_variable_original_order(v);
+	size_t lo = 0, hi = n;
+	if((index < n) && (jm_vector_get_item(jm_voidp)(vars, index) == (jm_voidp)v)) return index;
+	while(lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		size_t mi = fmi2_xml_get_variable_original_order((fmi2_xml_variable_t*)jm_vector_get_item(jm_voidp)(vars, mid));
+		if(mi < index) lo = mid + 1;
+		else hi = mid;
+	}
+	if((lo < n) && (jm_vector_get_item(jm_voidp)(vars, lo) == (jm_voidp)v)) return lo;
+	return n;
+}
+
 jm_vector(jm_named_ptr)* fmi2_xml_get_variables_alphabetical_order(fmi2_xml_model_description_t* md){
 	return &md->variablesByName;
 }
@@ -661,6 +733,170 @@ fmi2_xml_variable_t* fmi2_xml_get_variable_by_name(fmi2_xml_model_description_t*
 	return found->ptr;
 }
 
+/* Length of a subscript pattern like "[1:3,*]" at p, or 0 if p does not start one.
+   Subscripts without ranges or '*' are matched as plain text. */
+static size_t fmi2_xml_subscript_pattern_len(const char* p) {
+	size_t i = 1;
+	int isPattern = 0;
+	if(p[0] != '[') return 0;
+	while(p[i] && (p[i] != ']')) {
+		if((p[i] == ':') || (p[i] == '*'))
+			isPattern = 1;
+		else if(!isdigit((unsigned char)p[i]) && (p[i] != ','))
+			return 0;
+		i++;
+	}
+	return (isPattern && p[i]) ? i + 1 : 0;
+}
+
+/* Match the subscript of a name against a subscript pattern of length len.
+   Returns the length of the subscript in the name or 0 if it does not match. */
+static size_t fmi2_xml_match_subscript(const char* p, size_t len, const char* s) {
+	const char* end = p + len - 1;
+	const char* start = s;
+	if(*s != '[') return 0;
+	p++;
+	s++;
+	for(;;) {
+		unsigned long lo = 0, hi = (unsigned long)-1, index;
+		char* next;
+		if(*p == '*')
+			p++;
+		else {
+			lo = hi = strtoul(p, &next, 10);
+			p = next;
+			if(*p == ':') {
+				hi = strtoul(p + 1, &next, 10);
+				p = next;
+			}
+		}
+		if(!isdigit((unsigned char)*s)) return 0;
+		index = strtoul(s, &next, 10);
+		s = next;
+		if((index < lo) || (index > hi)) return 0;
+		if(p == end) break;
+		if((*p != ',') || (*s != ',')) return 0;
+		p++;
+		s++;
+	}
+	if(*s != ']') return 0;
+	return (size_t)(s - start) + 1;
+}
+
+/* The stars are matched without recursion: a mismatch lets the last '*' match one more
+   character. A '*' does not match '.', so once it would have to, the last '**' is extended
+   instead. A '.' in the pattern fixes the position of the name, the '*' before it is
+   then not extended any more. */
+int fmi2_xml_match_variable_name(const char* pattern, const char* name) {
+	const char* p = pattern;
+	const char* s = name;
+	const char *starP = 0, *starS = 0; /* pattern after the last '*' and the name position it is retried at */
+	const char *deepP = 0, *deepS = 0; /* the same for the last '**' */
+	size_t len, matched;
+
+	for(;;) {
+		if(*p == '*') {
+			/* Consecutive stars are one star; two or more also match '.' */
+			size_t stars = 0;
+			while(*p == '*') {
+				stars++;
+				p++;
+			}
+			if(stars > 1) {
+				deepP = p;
+				deepS = s;
+				starP = 0;
+			}
+			else {
+				starP = p;
+				starS = s;
+			}
+			continue;
+		}
+		if(!*p && !*s) return 1;
+		if(*p == '?') {
+			if(*s && (*s != '.')) {
+				p++;
+				s++;
+				continue;
+			}
+		}
+		else if((len = fmi2_xml_subscript_pattern_len(p)) > 0) {
+			if((matched = fmi2_xml_match_subscript(p, len, s)) > 0) {
+				p += len;
+				s += matched;
+				continue;
+			}
+		}
+		else if(*p == *s) {
+			if(*p == '.') starP = 0;
+			p++;
+			s++;
+			continue;
+		}
+		/* Mismatch: retry with one more character matched by the last star */
+		if(starP && *starS && (*starS != '.')) {
+			p = starP;
+			s = ++starS;
+		}
+		else if(deepP && *deepS) {
+			starP = 0;
+			p = deepP;
+			s = ++deepS;
+		}
+		else
+			return 0;
+	}
+}
+
+size_t fmi2_xml_get_name_pattern_prefix_len(const char* pattern) {
+	size_t i = 0;
+	while(pattern[i] && (pattern[i] != '*') && (pattern[i] != '?') && !fmi2_xml_subscript_pattern_len(pattern + i)) i++;
+	return i;
+}
+
+size_t fmi2_xml_get_variable_name_prefix_range(fmi2_xml_model_description_t* md, const char* prefix, size_t prefixLen, size_t* first) {
+	jm_vector(jm_named_ptr)* vars = &md->variablesByName;
+	size_t lo = 0, hi = jm_vector_get_size(jm_named_ptr)(vars), begin;
+
+	/* First name that is not below the prefix */
+	while(lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if(strncmp(jm_vector_get_itemp(jm_named_ptr)(vars, mid)->name, prefix, prefixLen) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	begin = lo;
+	/* First name that is above the prefix */
+	hi = jm_vector_get_size(jm_named_ptr)(vars);
+	while(lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		if(strncmp(jm_vector_get_itemp(jm_named_ptr)(vars, mid)->name, prefix, prefixLen) <= 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	*first = begin;
+	return lo - begin;
+}
+
+jm_status_enu_t fmi2_xml_get_variables_by_name_pattern(fmi2_xml_model_description_t* md, const char* pattern, jm_vector(jm_voidp)* out) {
+	size_t first, k;
+	size_t n = fmi2_xml_get_variable_name_prefix_range(md, pattern, fmi2_xml_get_name_pattern_prefix_len(pattern), &first);
+
+	for(k = first; k < first + n; k++) {
+		jm_named_ptr* item = jm_vector_get_itemp(jm_named_ptr)(&md->variablesByName, k);
+		if(fmi2_xml_match_variable_name(pattern, item->name)) {
+			if(!jm_vector_push_back(jm_voidp)(out, item->ptr)) {
+				jm_log_fatal(md->callbacks, module, "Could not allocate memory");
+				return jm_status_error;
+			}
+		}
+	}
+	return jm_status_success;
+}
+
 
 fmi2_xml_variable_t* fmi2_xml_get_variable_by_vr(fmi2_xml_model_description_t* md, fmi2_base_type_enu_t baseType, fmi2_value_reference_t vr) {
     fmi2_xml_variable_t key;
@@ -669,6 +905,13 @@ fmi2_xml_variable_t* fmi2_xml_get_variable_by_vr(fmi2_xml_model_description_t* m
 	fmi2_xml_variable_t *v = 0;
     void ** found;
 	if(!md->variablesByVR) return 0;
+	if(baseType >= fmi2_base_type_real && baseType <= fmi2_base_type_enum) {
+		fmi2_xml_vr_index_t* index = &md->vrIndex[(baseType == fmi2_base_type_enum) ? fmi2_base_type_int : baseType];
+		if(index->variables) {
+			if(vr < index->first || vr - index->first >= index->size) return 0;
+			return index->variables[vr - index->first];
+		}
+	}
 	keyType.structKind = fmi2_xml_type_struct_enu_props;
 	keyType.baseType = baseType;
 	key.typeBase = &keyType;
@@ -17,6 +17,16 @@
 extern "C" {
 #endif
 
+/* Direct lookup of the non-alias variables by value reference for one base type */
+typedef struct fmi2_xml_vr_index_t {
+	fmi2_value_reference_t first;
+	size_t size;
+	fmi2_xml_variable_t** variables; /* NULL if the value references are too sparse; bsearch is used then */
+} fmi2_xml_vr_index_t;
+
+/* Real, Integer and Enumeration, Boolean, String */
+#define FMI2_XML_VR_INDEX_NUM 4
+
 typedef enum fmi2_xml_model_description_status_enu_t {
     fmi2_xml_model_description_enu_empty,
     fmi2_xml_model_description_enu_ok,
@@ -89,6 +99,8 @@ struct fmi2_xml_model_description_t {
 
 	jm_vector(jm_voidp)* variablesByVR;
 
+	fmi2_xml_vr_index_t vrIndex[FMI2_XML_VR_INDEX_NUM];
+
     fmi2_fmu_kind_enu_t fmuKind;
 
     unsigned int capabilities[fmi2_capabilities_Num];
@@ -96,6 +108,9 @@ struct fmi2_xml_model_description_t {
 	fmi2_xml_model_structure_t* modelStructure;
 };
 
+/* Build the direct value reference lookup from variablesByVR, which must be sorted with fmi2_xml_compare_vr */
+void fmi2_xml_build_vr_index(fmi2_xml_model_description_t* md);
+
 void fmi2_xml_report_error(fmi2_xml_model_description_t* md, const char* module, const char* fmt, ...);
 
 void fmi2_xml_report_error_v(fmi2_xml_model_description_t* md, const char* module, const char* fmt, va_list ap);
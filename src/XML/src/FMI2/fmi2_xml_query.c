@@ -13,13 +13,20 @@
     along with this program. If not, contact Modelon AB <http://www.modelon.com>.
 */
 #include <stdio.h>
-#include <ctype.h>
-
-#include <jm_vector.h>
-#include <jm_stack.h>
-#include <jm_wc_match.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <JM/jm_vector.h>
+#include <FMI2/fmi2_xml_type.h>
+#include <FMI2/fmi2_xml_unit.h>
+#include "fmi2_xml_model_description_impl.h"
+#include "fmi2_xml_type_impl.h"
+#include "fmi2_xml_variable_impl.h"
 #include "fmi2_xml_query.h"
 
+static const char* module = "FMI2XML";
+
+#define FMI2_XML_Q_WORD_BITS (sizeof(size_t) * 8)
 
 jm_name_ID_map_t fmi2_xml_q_elementary_map[fmi2_xml_elementary_enu_num+1] =
 {
@@ -44,410 +51,648 @@ jm_name_ID_map_t fmi2_xml_q_op_map[] = {
 	{"or", fmi2_xml_q_term_enu_OR},
 	{"and", fmi2_xml_q_term_enu_AND},
 	{"not", fmi2_xml_q_term_enu_NOT},
-	{"&&", fmi2_xml_q_term_enu_AND},
-	{"||", fmi2_xml_q_term_enu_OR},
-	{"!", fmi2_xml_q_term_enu_NOT},
 	{0,-1}
 };
 
-static void fmi2_xml_q_skip_space(jm_string* cur) {
-    jm_string curChP = *cur;
-    char curCh;
-    if(!curChP) return;
-    curCh = *curChP;
-    while(curCh || (curCh == ' ') || (curCh == '\t')) {
-        curChP++; curCh = *curChP;
-    }
-    *cur = curChP;
-}
-
-int fmi2_xml_q_scan_string(fmi2_xml_q_context_t* context, char** param_str) {
-	fmi2_xml_q_expression_t* expr = &context->expr;
-	char* dest; 
-	jm_string cur = context->query + context->curCh;
-    char ch = *cur;
-    char strterm ;
-    size_t strlen = 0; 
-
-	if((ch == '\'') || (ch == '"')) /* either ' or " can be used as string terminator */
-		strterm = ch;
-    else 
-		return -1;
-    do {
-        ch = cur[strlen+1];
-        dest = jm_vector_push_back(char)(&expr->strbuf, ch);
-		assert(dest);
-        strlen++;
-    } while((ch != strterm) && ch);
-    if(!ch) return -1; /* string is not terminated */
-	*dest = 0; /* put terminating 0*/
-	strlen--; /* last zero is not a part of the string */
-	*param_str = dest - strlen;
-    return strlen;
+/* Compare len characters of a with the zero terminated b ignoring the case */
+static int fmi2_xml_q_equal_nocase(const char* a, size_t len, const char* b) {
+	size_t i;
+	for(i = 0; i < len; i++) {
+		if(!b[i] || (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i]))) return 0;
+	}
+	return (b[len] == 0);
 }
 
+/* Match a string against a pattern with the wildcards '*' and '?' */
+static int fmi2_xml_q_wc_match(const char* pattern, const char* str) {
+	const char* star = 0;
+	const char* retry = str;
+	while(*str) {
+		if((*pattern == '?') || (*pattern == *str)) {
+			pattern++;
+			str++;
+		}
+		else if(*pattern == '*') {
+			star = pattern++;
+			retry = str;
+		}
+		else if(star) {
+			pattern = star + 1;
+			str = ++retry;
+		}
+		else
+			return 0;
+	}
+	while(*pattern == '*') pattern++;
+	return (*pattern == 0);
+}
 
-int fmi2_xml_q_scan_elementary_name(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term) {
-	jm_string startCh = &context->query[context->curCh];
-	jm_string curCh = startCh;
-	size_t len;
+static int fmi2_xml_q_match_string(fmi2_xml_q_terminal_t* term, const char* str) {
+	if(!str) str = "";
+	if(term->param_i < 0)
+		return fmi2_xml_q_wc_match(term->param_str, str);
+	return (strcmp(term->param_str, str) == 0);
+}
 
-	/* expecting: [<spaces>]'='[<spaces>]<string> */
+/* Copy a string value into the string buffer of the query */
+static int fmi2_xml_q_scan_string(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	fmi2_xml_query_t* q = context->query;
+	char* dest = q->strbuf + q->strlen;
+
+	memcpy(dest, value, len);
+	dest[len] = 0;
+	q->strlen += len + 1;
+	term->param_str = dest;
+	term->param_i = (int)len;
+	if(memchr(dest, '*', len) || memchr(dest, '?', len)) {
+		/* treat as wildcard */
+		term->param_i *= -1;
+	}
+	return 0;
+}
 
-	fmi2_xml_q_skip_space(&curCh);
-	if(*curCh != '=') 
-		return (int)(startCh - curCh);
-	curCh++;
-	fmi2_xml_q_skip_space(&curCh);
+static int fmi2_xml_q_scan_bool(fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	if(fmi2_xml_q_equal_nocase(value, len, "true"))
+		term->param_i = 1;
+	else if(fmi2_xml_q_equal_nocase(value, len, "false"))
+		term->param_i = 0;
+	else
+		return -1;
+	return 0;
+}
 
-	len = (int)(curCh - startCh);
+/* Names are matched as hierarchical name patterns, see fmi2_xml_match_variable_name() */
+int fmi2_xml_q_scan_elementary_name(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	fmi2_xml_q_scan_string(context, term, value, len);
+	len = strlen(term->param_str);
+	term->param_i = (fmi2_xml_get_name_pattern_prefix_len(term->param_str) < len) ? -(int)len : (int)len;
+	return 0;
+}
 
-	context->curCh += len;
-	startCh += len;
+int fmi2_xml_q_eval_elementary_name(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
+	assert(term->specific == fmi2_xml_q_elmentary_enu_name);
+	if(term->param_i < 0)
+		return fmi2_xml_match_variable_name(term->param_str, fmi2_xml_get_variable_name(var));
+	return (strcmp(term->param_str, fmi2_xml_get_variable_name(var)) == 0);
+}
 
-	if( fmi2_xml_q_scan_string(context, &term->param_str)  < 0) 
-		return (int)(startCh - curCh);
-	
-	/*	treat as regexp - > skip for now
-	if(term->param_str[0] == '^') {		
+int fmi2_xml_q_scan_elementary_quantity(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	return fmi2_xml_q_scan_string(context, term, value, len);
+}
 
+int fmi2_xml_q_eval_elementary_quantity(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
+	fmi2_xml_variable_type_base_t* props = fmi2_xml_find_type_props(var->typeBase);
+	const char* quantity = 0;
+	if(props) {
+		switch(props->baseType) {
+		case fmi2_base_type_real:
+			quantity = ((fmi2_xml_real_type_props_t*)props)->quantity;
+			break;
+		case fmi2_base_type_int:
+			quantity = ((fmi2_xml_integer_type_props_t*)props)->quantity;
+			break;
+		case fmi2_base_type_enum:
+			quantity = ((fmi2_xml_enum_variable_props_t*)props)->quantity;
+			break;
+		default:
+			break;
+		}
 	}
-	else  */
-	{		
-		term->param_i = strlen(term->param_str);
-		if( (strchr ( term->param_str, '*') != 0) || (strchr ( term->param_str, '?') != 0) ){
-			/* treat as wildcard */
-			term->param_i *= -1;
+	return fmi2_xml_q_match_string(term, quantity);
+}
+
+int fmi2_xml_q_scan_elementary_basetype(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	int k;
+	for(k = fmi2_base_type_real; k <= fmi2_base_type_enum; k++) {
+		if(fmi2_xml_q_equal_nocase(value, len, fmi2_base_type_to_string((fmi2_base_type_enu_t)k))) {
+			term->param_i = k;
+			return 0;
 		}
 	}
-	return (int)(curCh - startCh);
+	return -1;
 }
 
-int fmi2_xml_q_eval_elementary_name(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
-	assert(term->specific == fmi2_xml_q_elmentary_enu_name);
+int fmi2_xml_q_eval_elementary_basetype(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
+	return (fmi2_xml_get_variable_base_type(var) == (fmi2_base_type_enu_t)term->param_i);
+}
 
-	if(term->param_i < 0) {
-		return jm_wc_match(term->param_str, fmi2_xml_get_variable_name(var));
-	}
-	else
-		return (strncmp(term->param_str, fmi2_xml_get_variable_name(var), term->param_i) == 0);
-	return 0;
+int fmi2_xml_q_scan_elementary_type(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	return fmi2_xml_q_scan_string(context, term, value, len);
 }
 
-int fmi2_xml_q_scan_elementary_unit(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term) {
-	jm_string startCh = &context->query[context->curCh];
-	jm_string curCh = startCh;
-	size_t len;
+int fmi2_xml_q_eval_elementary_type(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
+	fmi2_xml_variable_typedef_t* t = fmi2_xml_get_variable_declared_type(var);
+	return fmi2_xml_q_match_string(term, t ? fmi2_xml_get_type_name(t) : 0);
+}
 
-	/* expecting: [<spaces>]'='[<spaces>]<string> */
+int fmi2_xml_q_scan_elementary_unit(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	return fmi2_xml_q_scan_string(context, term, value, len);
+}
 
-	fmi2_xml_q_skip_space(&curCh);
-	if(*curCh != '=') 
-		return (int)(startCh - curCh);
-	curCh++;
-	fmi2_xml_q_skip_space(&curCh);
+int fmi2_xml_q_eval_elementary_unit(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
+	fmi2_xml_unit_t* u = 0;
+	if(fmi2_xml_get_variable_base_type(var) == fmi2_base_type_real)
+		u = fmi2_xml_get_real_variable_unit((fmi2_xml_real_variable_t*)var);
+	return fmi2_xml_q_match_string(term, u ? fmi2_xml_get_unit_name(u) : 0);
+}
 
-	len = (int)(curCh - startCh);
+int fmi2_xml_q_scan_elementary_displayunit(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	return fmi2_xml_q_scan_string(context, term, value, len);
+}
 
-	context->curCh += len;
-	startCh += len;
+int fmi2_xml_q_eval_elementary_displayunit(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
+	fmi2_xml_display_unit_t* du = 0;
+	if(fmi2_xml_get_variable_base_type(var) == fmi2_base_type_real)
+		du = fmi2_xml_get_real_variable_display_unit((fmi2_xml_real_variable_t*)var);
+	return fmi2_xml_q_match_string(term, du ? fmi2_xml_get_display_unit_name(du) : 0);
+}
 
-	if( fmi2_xml_q_scan_string(context, &term->param_str)  < 0) 
-		return (int)(startCh - curCh);
-	return (int)(curCh - startCh);
+int fmi2_xml_q_scan_elementary_hasstart(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	return fmi2_xml_q_scan_bool(term, value, len);
 }
 
-int fmi2_xml_q_eval_elementary_unit(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
+int fmi2_xml_q_eval_elementary_hasstart(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
+	return ((fmi2_xml_get_variable_has_start(var) != 0) == (term->param_i != 0));
+}
+
+int fmi2_xml_q_scan_elementary_isalias(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	return fmi2_xml_q_scan_bool(term, value, len);
+}
+
+int fmi2_xml_q_eval_elementary_isalias(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
+	return ((fmi2_xml_get_variable_alias_kind(var) != fmi2_variable_is_not_alias) == (term->param_i != 0));
+}
+
+/* The variable is looked up when the query is compiled. An unknown name matches no variable. */
+int fmi2_xml_q_scan_elementary_alias(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	fmi2_xml_q_scan_string(context, term, value, len);
+	term->param_p = fmi2_xml_get_variable_by_name(context->query->md, term->param_str);
 	return 0;
 }
 
-int fmi2_xml_q_get_number(fmi2_xml_q_context_t* context, char* cur, double* val, char* buf) {
-	int len;
-	if(sscanf(cur, "%lg%s", val, buf) != 2) return 0;
-	len = strlen(cur) - strlen(buf);
-	return len;
+int fmi2_xml_q_eval_elementary_alias(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
+	fmi2_xml_variable_t* v = (fmi2_xml_variable_t*)term->param_p;
+	if(!v) return 0;
+	return (fmi2_xml_get_variable_vr(var) == fmi2_xml_get_variable_vr(v))
+		&& (fmi2_xml_get_variable_base_type(var) == fmi2_xml_get_variable_base_type(v));
 }
 
-int fmi2_xml_q_get_keyword(fmi2_xml_q_context_t* context, char* cur, size_t* len, char* buf) {
-    char ch = *cur;
-    size_t i = 0, id;
-    *len = 0;
-	if( (ch == '|') || (ch == '&') ) {		
-		if(ch ==  cur[i+1]) {
-			buf[i++] = ch;
-			buf[i++] = ch;
+int fmi2_xml_q_scan_elementary_causality(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	int k;
+	for(k = fmi2_causality_enu_parameter; k < fmi2_causality_enu_unknown; k++) {
+		if(fmi2_xml_q_equal_nocase(value, len, fmi2_causality_to_string((fmi2_causality_enu_t)k))) {
+			term->param_i = k;
+			return 0;
 		}
 	}
-	else {
-		while(isalpha(ch)) {
-			buf[i++] = tolower(ch);
-			ch = cur[i];
+	return -1;
+}
+
+int fmi2_xml_q_eval_elementary_causality(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
+	return (fmi2_xml_get_causality(var) == (fmi2_causality_enu_t)term->param_i);
+}
+
+int fmi2_xml_q_scan_elementary_variability(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	int k;
+	for(k = fmi2_variability_enu_constant; k < fmi2_variability_enu_unknown; k++) {
+		if(fmi2_xml_q_equal_nocase(value, len, fmi2_variability_to_string((fmi2_variability_enu_t)k))) {
+			term->param_i = k;
+			return 0;
 		}
 	}
-	
-    if(!i) return -1;
-
-	{
-		jm_name_ID_map_t key;
-		jm_name_ID_map_t* map;
-		key.name = buf;
-		map = jm_vector_bsearch(jm_name_ID_map_t)(&context->elementary_map, &key,jm_compare_name);
-		if(!map) return -1;
-		id = map->ID;
+	return -1;
+}
+
+int fmi2_xml_q_eval_elementary_variability(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
+	return (fmi2_xml_get_variability(var) == (fmi2_variability_enu_t)term->param_i);
+}
+
+int fmi2_xml_q_scan_elementary_initial(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term, const char* value, size_t len) {
+	int k;
+	for(k = fmi2_initial_enu_exact; k < fmi2_initial_enu_unknown; k++) {
+		if(fmi2_xml_q_equal_nocase(value, len, fmi2_initial_to_string((fmi2_initial_enu_t)k))) {
+			term->param_i = k;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+int fmi2_xml_q_eval_elementary_initial(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
+	return (fmi2_xml_get_initial(var) == (fmi2_initial_enu_t)term->param_i);
+}
+
+/* Scan the next token of the query. Quoted strings and words that are not operators are values. */
+static void fmi2_xml_q_next_token(fmi2_xml_q_context_t* c) {
+	jm_string s = c->str;
+	size_t i = c->curCh, len = 1;
+
+	while(isspace((unsigned char)s[i])) i++;
+	c->tokStart = i;
+	switch(s[i]) {
+	case 0:
+		c->tok = fmi2_xml_q_term_enu_END;
+		len = 0;
+		break;
+	case '(':
+		c->tok = fmi2_xml_q_term_enu_LP;
+		break;
+	case ')':
+		c->tok = fmi2_xml_q_term_enu_RP;
+		break;
+	case '&':
+		c->tok = fmi2_xml_q_term_enu_AND;
+		if(s[i + 1] == '&') len = 2;
+		break;
+	case '|':
+		c->tok = fmi2_xml_q_term_enu_OR;
+		if(s[i + 1] == '|') len = 2;
+		break;
+	case '!':
+		if(s[i + 1] == '=') {
+			c->tok = fmi2_xml_q_term_enu_NE;
+			len = 2;
+		}
+		else
+			c->tok = fmi2_xml_q_term_enu_NOT;
+		break;
+	case '=':
+		c->tok = fmi2_xml_q_term_enu_EQ;
+		if(s[i + 1] == '=') len = 2;
+		break;
+	case '\'':
+	case '"': /* either ' or " can be used as string terminator */
+		{
+			char strterm = s[i];
+			size_t j = i + 1;
+			while(s[j] && (s[j] != strterm)) j++;
+			if(!s[j]) {
+				/* string is not terminated */
+				c->tok = fmi2_xml_q_term_enu_FALSE;
+				len = 0;
+				break;
+			}
+			c->tok = fmi2_xml_q_term_enu_VALUE;
+			c->tokStart = i + 1;
+			c->tokLen = j - i - 1;
+			c->curCh = j + 1;
+			return;
+		}
+	default:
+		{
+			size_t j = i;
+			jm_name_ID_map_t* op;
+			while(s[j] && !isspace((unsigned char)s[j]) && !strchr("()&|!=\"'", s[j])) j++;
+			len = j - i;
+			c->tok = fmi2_xml_q_term_enu_VALUE;
+			for(op = fmi2_xml_q_op_map; op->name; op++) {
+				if(fmi2_xml_q_equal_nocase(s + i, len, op->name)) {
+					c->tok = (fmi2_xml_q_terminal_enu_t)op->ID;
+					break;
+				}
+			}
+		}
+	}
+	c->tokLen = len;
+	c->curCh = i + len;
+}
+
+/* Append a term to the program. Returns 0 on success and -2 if memory allocation failed. */
+static int fmi2_xml_q_emit(fmi2_xml_q_context_t* c, fmi2_xml_q_terminal_enu_t kind, fmi2_xml_q_terminal_t* term) {
+	fmi2_xml_query_t* q = c->query;
+	fmi2_xml_q_terminal_t* pterm = jm_vector_resize1(fmi2_xml_q_terminal_t)(&q->program);
+	if(!pterm) {
+		jm_log_fatal(c->cb, module, "Could not allocate memory");
+		return -2;
+	}
+	if(term)
+		*pterm = *term;
+	else
+		memset(pterm, 0, sizeof(fmi2_xml_q_terminal_t));
+	pterm->kind = kind;
+	switch(kind) {
+	case fmi2_xml_q_term_enu_elementary:
+	case fmi2_xml_q_term_enu_TRUE:
+		c->depth++;
+		if(c->depth > q->depth) q->depth = c->depth;
+		break;
+	case fmi2_xml_q_term_enu_AND:
+	case fmi2_xml_q_term_enu_OR:
+		c->depth--;
+		break;
+	default:
+		break;
 	}
-    *len = i;
-    return id;
-}
-
-
-/* if we ever get to regex then this might be a good function */ 
-int pattern2regexp(const char* pattern, jm_vector(char)* re) {
-    size_t plen = strlen(pattern), i;
-    if(jm_vector_reserve_char(re, plen * 2 + 3) < plen) return -1;
-    jm_vector_resize_char(re, 0);
-    jm_vector_push_back_char(re, '^');
-    for(i=0; i < plen; i++) {
-        char cur = pattern[i];
-        switch(cur) {
-        case '*':
-            jm_vector_push_back_char(re, '.');
-            jm_vector_push_back_char(re,'*');
-            break;
-        case '?':
-            jm_vector_push_back_char(re,'.');
-            break;
-        default:
-            jm_vector_push_back_char(re,'\\');
-            jm_vector_push_back_char(re,cur);
-        }
-    }
-    jm_vector_push_back_char(re, '$');
-    jm_vector_push_back_char(re, 0);
-    return 0;
-}
-
-int fmi2_xml_evaluate_terminal(fmi2_xml_variable_t* var, fmi2_xml_q_terminal_t* term) {
-	return fmi2_xml_q_eval_elementary_handles[term->specific](var, term);
-}
-
-int fmi2_xml_q_filter_variable(fmi2_xml_variable_t* var, fmi2_xml_q_expression_t* expr) {
-    size_t cur, len = jm_vector_get_size(jm_voidp)(&expr->expression);
-	jm_vector(jm_voidp)* stack = &expr->stack;
-	fmi2_xml_q_terminal_t * term;
-    for(cur = 0; cur < len; cur++) {
-        fmi2_xml_q_terminal_t *argL, *argR;
-        size_t curlen = jm_vector_get_size(jm_voidp)(stack);
-
-		term = (fmi2_xml_q_terminal_t *)jm_vector_get_item(jm_voidp)(&expr->expression, cur);
-        argL = (curlen > 0) ? (fmi2_xml_q_terminal_t *)jm_vector_get_item(jm_voidp)(stack,curlen -1):0;
-        argR = (curlen > 1) ? (fmi2_xml_q_terminal_t *)jm_vector_get_item(jm_voidp)(stack,curlen -2):0;
-
-        switch(term -> kind) {
-        case fmi2_xml_q_term_enu_AND:
-            assert(argL && argR);
-            jm_vector_resize(jm_voidp)(stack, curlen -2);
-            if((argL->kind == fmi2_xml_q_term_enu_FALSE) || (argR->kind == fmi2_xml_q_term_enu_FALSE))
-                jm_vector_push_back(jm_voidp)(stack, &expr->termFalse);
-            else {
-                jm_vector_push_back(jm_voidp)(stack, (fmi2_xml_evaluate_terminal(var, argL) && fmi2_xml_evaluate_terminal(var, argR))?   &expr->termTrue: &expr->termFalse );
-            }
-            break;
-        case fmi2_xml_q_term_enu_OR:
-            assert(argL && argR);
-            jm_vector_resize(jm_voidp)(stack, curlen -2);
-            if((argL->kind == fmi2_xml_q_term_enu_TRUE) || (argR->kind == fmi2_xml_q_term_enu_TRUE))
-                jm_vector_push_back(jm_voidp)(stack, &expr->termTrue);
-            else {
-                jm_vector_push_back(jm_voidp)(stack, (fmi2_xml_evaluate_terminal(var, argL) || fmi2_xml_evaluate_terminal(var, argR))?   &expr->termTrue: &expr->termFalse);
-            }
-            break;
-        case fmi2_xml_q_term_enu_NOT:
-			assert(argL);
-            jm_vector_resize(jm_voidp)(stack, curlen -1);
-            if(argL->kind == fmi2_xml_q_term_enu_TRUE)
-                jm_vector_push_back(jm_voidp)(stack, &expr->termFalse);
-			else if(argL->kind == fmi2_xml_q_term_enu_TRUE)
-                jm_vector_push_back(jm_voidp)(stack, &expr->termTrue);
-            else {
-                jm_vector_push_back(jm_voidp)(stack, (fmi2_xml_evaluate_terminal(var, argL)?   &expr->termFalse: &expr->termTrue));
-            }
-			break;
-		case fmi2_xml_q_term_enu_LP:
-		case fmi2_xml_q_term_enu_RP:
-			assert(0);
-			break;
-        default:
-            jm_vector_push_back(jm_voidp)(stack, term); /* only evaluate when needed. push as is at first */
-        }
-    }
-    assert(jm_vector_get_size(jm_voidp)(stack) == 1);
-	
-    term = (fmi2_xml_q_terminal_t *)jm_vector_get_item(jm_voidp)(stack,0);
-    if(term->kind == fmi2_xml_q_term_enu_FALSE) return 0;
-	assert(term->kind == fmi2_xml_q_term_enu_TRUE);
-    return 1;
-}
-
-fmi2_xml_q_expression_t* fmi2_xml_alloc_expression(jm_string query) {
 	return 0;
 }
 
-int fmi2_xml_q_parse_elementary(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t* term) {
+static int fmi2_xml_q_parse_or(fmi2_xml_q_context_t* c);
+
+static int fmi2_xml_q_parse_elementary(fmi2_xml_q_context_t* c) {
+	fmi2_xml_q_terminal_t term;
+	size_t k;
+	int negate = 0, isBool, ret;
+
+	if(c->tok != fmi2_xml_q_term_enu_VALUE) return -1;
+	for(k = 0; k < fmi2_xml_elementary_enu_num; k++) {
+		if(fmi2_xml_q_equal_nocase(c->str + c->tokStart, c->tokLen, fmi2_xml_q_elementary_map[k].name)) break;
+	}
+	if(k == fmi2_xml_elementary_enu_num) return -1;
+
+	memset(&term, 0, sizeof(term));
+	term.specific = (fmi2_xml_elementary_enu_t)fmi2_xml_q_elementary_map[k].ID;
+	isBool = (term.specific == fmi2_xml_q_elmentary_enu_hasstart) || (term.specific == fmi2_xml_q_elmentary_enu_isalias);
+	fmi2_xml_q_next_token(c);
+	if((c->tok == fmi2_xml_q_term_enu_EQ) || (c->tok == fmi2_xml_q_term_enu_NE)) {
+		negate = (c->tok == fmi2_xml_q_term_enu_NE);
+		fmi2_xml_q_next_token(c);
+		if(c->tok != fmi2_xml_q_term_enu_VALUE) return -1;
+		if(fmi2_xml_q_scan_elementary_handles[term.specific](c, &term, c->str + c->tokStart, c->tokLen)) return -1;
+		fmi2_xml_q_next_token(c);
+	}
+	else if(isBool)
+		term.param_i = 1;
+	else
+		return -1;
+
+	/* Boolean terms are always compiled for 'true' so that they can be evaluated with a mask */
+	if(isBool && !term.param_i) {
+		term.param_i = 1;
+		negate = !negate;
+	}
+	ret = fmi2_xml_q_emit(c, fmi2_xml_q_term_enu_elementary, &term);
+	if(!ret && negate) ret = fmi2_xml_q_emit(c, fmi2_xml_q_term_enu_NOT, 0);
+	return ret;
+}
+
+static int fmi2_xml_q_parse_primary(fmi2_xml_q_context_t* c) {
+	int ret;
+	if(c->tok != fmi2_xml_q_term_enu_LP)
+		return fmi2_xml_q_parse_elementary(c);
+	fmi2_xml_q_next_token(c);
+	ret = fmi2_xml_q_parse_or(c);
+	if(ret) return ret;
+	if(c->tok != fmi2_xml_q_term_enu_RP) return -1;
+	fmi2_xml_q_next_token(c);
 	return 0;
 }
 
-void fmi2_xml_q_init_context(fmi2_xml_q_context_t* c, jm_callbacks* cb) {
-	size_t l = jm_vector_init(jm_name_ID_map_t)(&c->elementary_map, fmi2_xml_elementary_enu_num, cb);
-	assert(l);
-	for(l = 0; l < fmi2_xml_elementary_enu_num; l++) {
-		jm_vector_set_item(jm_name_ID_map_t)(&c->elementary_map, l,fmi2_xml_q_elementary_map[l]);
+static int fmi2_xml_q_parse_not(fmi2_xml_q_context_t* c) {
+	int ret;
+	if(c->tok != fmi2_xml_q_term_enu_NOT)
+		return fmi2_xml_q_parse_primary(c);
+	fmi2_xml_q_next_token(c);
+	ret = fmi2_xml_q_parse_not(c);
+	if(ret) return ret;
+	return fmi2_xml_q_emit(c, fmi2_xml_q_term_enu_NOT, 0);
+}
+
+static int fmi2_xml_q_parse_and(fmi2_xml_q_context_t* c) {
+	int ret = fmi2_xml_q_parse_not(c);
+	while(!ret && (c->tok == fmi2_xml_q_term_enu_AND)) {
+		fmi2_xml_q_next_token(c);
+		ret = fmi2_xml_q_parse_not(c);
+		if(!ret) ret = fmi2_xml_q_emit(c, fmi2_xml_q_term_enu_AND, 0);
+	}
+	return ret;
+}
+
+static int fmi2_xml_q_parse_or(fmi2_xml_q_context_t* c) {
+	int ret = fmi2_xml_q_parse_and(c);
+	while(!ret && (c->tok == fmi2_xml_q_term_enu_OR)) {
+		fmi2_xml_q_next_token(c);
+		ret = fmi2_xml_q_parse_and(c);
+		if(!ret) ret = fmi2_xml_q_emit(c, fmi2_xml_q_term_enu_OR, 0);
+	}
+	return ret;
+}
+
+fmi2_xml_query_t* fmi2_xml_compile_query(fmi2_xml_model_description_t* md, const char* query) {
+	jm_callbacks* cb = md->callbacks;
+	fmi2_xml_q_context_t c;
+	fmi2_xml_query_t* q;
+	size_t qlen;
+	int ret;
+
+	if(!query) query = "";
+	qlen = strlen(query);
+	q = (fmi2_xml_query_t*)cb->calloc(1, sizeof(fmi2_xml_query_t));
+	if(!q) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		return 0;
+	}
+	q->md = md;
+	jm_vector_init(fmi2_xml_q_terminal_t)(&q->program, 0, cb);
+	/* The strings of the query are never longer than the query itself */
+	q->strbuf = (char*)cb->malloc(qlen + 1);
+	if(!q->strbuf) {
+		jm_log_fatal(cb, module, "Could not allocate memory");
+		fmi2_xml_free_query(q);
+		return 0;
+	}
+
+	c.cb = cb;
+	c.query = q;
+	c.str = query;
+	c.curCh = 0;
+	c.depth = 0;
+	fmi2_xml_q_next_token(&c);
+	if(c.tok == fmi2_xml_q_term_enu_END)
+		ret = fmi2_xml_q_emit(&c, fmi2_xml_q_term_enu_TRUE, 0);
+	else {
+		ret = fmi2_xml_q_parse_or(&c);
+		if(!ret && (c.tok != fmi2_xml_q_term_enu_END)) ret = -1;
+	}
+	if(!ret) {
+		q->values = (int*)cb->malloc(q->depth * sizeof(int));
+		if(!q->values) {
+			jm_log_fatal(cb, module, "Could not allocate memory");
+			ret = -2;
+		}
+	}
+	if(ret) {
+		if(ret == -1)
+			jm_log_error(cb, module, "Syntax error in variable query at position %u: '%s'", (unsigned)c.tokStart, query);
+		fmi2_xml_free_query(q);
+		return 0;
 	}
-	jm_vector_qsort(jm_name_ID_map_t)(&c->elementary_map,jm_compare_name);
-	c->query = 0;
-	c->qlen = 0;
-	c->curCh = 0;
-	jm_vector_init(char)(&c->buf,0,cb);
-
-	{
-		fmi2_xml_q_expression_t* expr = &c->expr;
-		jm_vector_init(jm_voidp)(&expr->expression,0,cb);
-		jm_vector_init(jm_voidp)(&expr->stack,0,cb);
-		expr->termFalse.kind = 	fmi2_xml_q_term_enu_FALSE;
-		expr->termTrue.kind = 	fmi2_xml_q_term_enu_TRUE;
-		jm_vector_init(fmi2_xml_q_terminal_t)(&expr->terms,0,cb);
-		jm_vector_init(char)(&expr->strbuf, 0, cb);
+	return q;
+}
+
+void fmi2_xml_free_query(fmi2_xml_query_t* q) {
+	jm_callbacks* cb;
+	if(!q) return;
+	cb = q->md->callbacks;
+	jm_vector_free_data(fmi2_xml_q_terminal_t)(&q->program);
+	cb->free(q->strbuf);
+	cb->free(q->values);
+	cb->free(q->words);
+	cb->free(q);
+}
+
+int fmi2_xml_query_variable(fmi2_xml_query_t* q, fmi2_xml_variable_t* v) {
+	size_t k, n = jm_vector_get_size(fmi2_xml_q_terminal_t)(&q->program), sp = 0;
+	int* values = q->values;
+
+	for(k = 0; k < n; k++) {
+		fmi2_xml_q_terminal_t* term = jm_vector_get_itemp(fmi2_xml_q_terminal_t)(&q->program, k);
+		switch(term->kind) {
+		case fmi2_xml_q_term_enu_elementary:
+			values[sp++] = fmi2_xml_q_eval_elementary_handles[term->specific](v, term);
+			break;
+		case fmi2_xml_q_term_enu_TRUE:
+			values[sp++] = 1;
+			break;
+		case fmi2_xml_q_term_enu_AND:
+			sp--;
+			values[sp - 1] = values[sp - 1] && values[sp];
+			break;
+		case fmi2_xml_q_term_enu_OR:
+			sp--;
+			values[sp - 1] = values[sp - 1] || values[sp];
+			break;
+		case fmi2_xml_q_term_enu_NOT:
+			values[sp - 1] = !values[sp - 1];
+			break;
+		default:
+			assert(0);
+		}
 	}
+	assert(sp == 1);
+	return values[0];
 }
 
-void fmi2_xml_q_free_context_data(fmi2_xml_q_context_t* c){
-	fmi2_xml_q_expression_t* expr = &c->expr;
-	jm_vector_free_data(jm_name_ID_map_t)(&c->elementary_map);
-	jm_vector_free_data(char)(&c->buf);
-	jm_vector_free_data(jm_voidp)(&expr->expression);
-	jm_vector_free_data(jm_voidp)(&expr->stack);
-	jm_vector_free_data(fmi2_xml_q_terminal_t)(&expr->terms);
-	jm_vector_free_data(char)(&expr->strbuf);
-}
-
-int fmi2_xml_q_parse_terminal(fmi2_xml_q_context_t* context, fmi2_xml_q_terminal_t** ppterm) {
-	int offset = 0;
-    fmi2_xml_q_terminal_t* pterm;
-	jm_string startCh = context->query + context->curCh;
-	jm_string cur = startCh;
-	pterm = jm_vector_resize1(fmi2_xml_q_terminal_t)(&context->expr.terms);
-    if(!pterm) return -1;
-	*ppterm = pterm;
-    fmi2_xml_q_skip_space(&cur);
-    switch(*cur) {
-    case '(':
-		pterm->kind = fmi2_xml_q_term_enu_LP;
+/* Get the mask attribute of an elementary term. Returns 0 if the term has no mask. */
+static int fmi2_xml_q_get_mask_attribute(fmi2_xml_q_terminal_t* term, fmi2_xml_query_mask_enu_t* attribute, int* value) {
+	*value = term->param_i;
+	switch(term->specific) {
+	case fmi2_xml_q_elmentary_enu_causality:
+		*attribute = fmi2_xml_query_mask_causality;
 		break;
-    case ')':
-		pterm->kind = fmi2_xml_q_term_enu_RP;
+	case fmi2_xml_q_elmentary_enu_variability:
+		*attribute = fmi2_xml_query_mask_variability;
 		break;
-    case '&':
-		pterm->kind = fmi2_xml_q_term_enu_AND;
+	case fmi2_xml_q_elmentary_enu_initial:
+		*attribute = fmi2_xml_query_mask_initial;
 		break;
-    case '|':
-		pterm->kind = fmi2_xml_q_term_enu_OR;
+	case fmi2_xml_q_elmentary_enu_basetype:
+		*attribute = fmi2_xml_query_mask_base_type;
 		break;
-    case '!':
-		pterm->kind = fmi2_xml_q_term_enu_NOT;
+	case fmi2_xml_q_elmentary_enu_isalias:
+		*attribute = fmi2_xml_query_mask_alias_kind;
+		*value = fmi2_variable_is_alias;
 		break;
-    case 0:
-		pterm->kind = fmi2_xml_q_term_enu_END;
+	case fmi2_xml_q_elmentary_enu_hasstart:
+		*attribute = fmi2_xml_query_mask_has_start;
 		break;
-    default:
-        fmi2_xml_q_parse_elementary(context, pterm);
-    }
-	fmi2_xml_q_skip_space(&cur);
-	return (int)(cur - startCh);
-}
-
-int fmi2_xml_q_parse_query(fmi2_xml_q_context_t* context, jm_string query) {
-	fmi2_xml_q_expression_t* expr = &context->expr;
-    int qlen = strlen(query);
-	int offset = 0, curCh = 0;
-	int expectOperand = 1;
-	size_t stacklen = 0;
-    fmi2_xml_q_terminal_t* stackTop = 0;
-
-	context->query = query;
-	context->qlen = qlen;
-	if(jm_vector_reserve(char)(&context->buf, qlen) < (size_t)qlen) return -1;
-	if(jm_vector_reserve(char)(&context->expr.strbuf, qlen) < (size_t)qlen) return -1;
-
-    while(curCh < qlen) {
-        fmi2_xml_q_terminal_t* term;
-        size_t explen = jm_vector_get_size(jm_voidp)(&expr->expression);
-        fmi2_xml_q_terminal_t* expTop =  explen? (fmi2_xml_q_terminal_t*)jm_vector_get_item(jm_voidp)(&expr->expression,explen -1):0;
-
-		offset = fmi2_xml_q_parse_terminal(context,  &term);
-
-        if(offset < 0) return -curCh;		
-
-		stacklen = jm_vector_get_size(jm_voidp)(&expr->stack);
-        stackTop =  stacklen ? (fmi2_xml_q_terminal_t*)jm_vector_get_item(jm_voidp)(&expr->stack,stacklen -1):(fmi2_xml_q_terminal_t*)0;
-
-        switch(term -> kind) {
-        case fmi2_xml_q_term_enu_LP:
-			if(!expectOperand) return -curCh;
-            jm_vector_push_back(jm_voidp)(&expr->stack, term);
-            break;
-        case fmi2_xml_q_term_enu_RP:
-			if(expectOperand) return -curCh;
-            while(stackTop && (stackTop->kind != fmi2_xml_q_term_enu_LP)) {
-                jm_vector_push_back(jm_voidp)(&expr->expression, stackTop);
-                stacklen--;
-                jm_vector_resize(jm_voidp)(&expr->stack, stacklen);
-                stackTop =  stacklen? (fmi2_xml_q_terminal_t*)jm_vector_get_item(jm_voidp)(&expr->stack,stacklen -1):0;
-            }
-            if(!stackTop) return -curCh;
-            jm_vector_resize(jm_voidp)(&expr->stack, stacklen -1);
-            break;
-
-        case fmi2_xml_q_term_enu_AND:
-			if(expectOperand) return -curCh;
-			expectOperand = 1;
-            if(!expTop) return -curCh;
-            if(stackTop && (stackTop->kind == fmi2_xml_q_term_enu_AND))
-                    jm_vector_push_back(jm_voidp)(&expr->expression, term);
-                else
-                    jm_vector_push_back(jm_voidp)(&expr->stack, term);
-            break;
-        case fmi2_xml_q_term_enu_OR:
-			if(expectOperand) return -curCh;
-			expectOperand = 1;
-            if(!expTop) return -curCh;
-            while(stackTop && ((stackTop->kind == fmi2_xml_q_term_enu_AND)||(stackTop->kind == fmi2_xml_q_term_enu_OR))) {
-                jm_vector_push_back(jm_voidp)(&expr->expression, stackTop);
-                jm_vector_resize(jm_voidp)(&expr->stack, stacklen -1);
-                stacklen--;
-                stackTop =  stacklen? jm_vector_get_item(jm_voidp)(&expr->stack,stacklen -1):0;
-            }
-            jm_vector_push_back(jm_voidp)(&expr->stack, term);
-            break;
-        default:
-			if(!expectOperand) return -curCh;
-			expectOperand = 0;
-            jm_vector_push_back(jm_voidp)(&expr->expression, term);
-
-        }
-		curCh += offset;
-		context->curCh = curCh;
-    }
-	if(expectOperand) return -curCh;
-    while(stackTop && (stackTop->kind != fmi2_xml_q_term_enu_LP)) {
-		jm_vector_push_back(jm_voidp)(&expr->expression, stackTop);
-        jm_vector_resize(jm_voidp)(&expr->stack, stacklen -1);
-        stacklen--;
-        stackTop =  stacklen? (fmi2_xml_q_terminal_t*)jm_vector_get_item(jm_voidp)(&expr->stack,stacklen -1):0;
-    }
-    if(!stackTop) return -curCh;
-    jm_vector_resize(jm_voidp)(&expr->stack, stacklen -1);
-
-    return 0;
+	default:
+		return 0;
+	}
+	return 1;
+}
+
+/* Evaluate a name term with the alphabetical order: only the names with the literal prefix are visited */
+static void fmi2_xml_q_eval_name_bits(fmi2_xml_query_t* q, fmi2_xml_q_terminal_t* term, jm_vector(jm_voidp)* vars, size_t n, size_t* dst) {
+	jm_vector(jm_named_ptr)* byName = fmi2_xml_get_variables_alphabetical_order(q->md);
+	size_t first, k, count;
+	size_t prefixLen = (term->param_i < 0) ? fmi2_xml_get_name_pattern_prefix_len(term->param_str) : strlen(term->param_str);
+
+	count = fmi2_xml_get_variable_name_prefix_range(q->md, term->param_str, prefixLen, &first);
+	for(k = first; k < first + count; k++) {
+		jm_named_ptr* item = jm_vector_get_itemp(jm_named_ptr)(byName, k);
+		if((term->param_i < 0) ? fmi2_xml_match_variable_name(term->param_str, item->name) : (strcmp(term->param_str, item->name) == 0)) {
+			size_t j = fmi2_xml_get_variable_position(q->md, (fmi2_xml_variable_t*)item->ptr);
+			if(j < n) dst[j / FMI2_XML_Q_WORD_BITS] |= (size_t)1 << (j % FMI2_XML_Q_WORD_BITS);
+		}
+	}
+}
+
+static void fmi2_xml_q_clear_tail(size_t* words, size_t numWords, size_t numBits) {
+	if(numBits % FMI2_XML_Q_WORD_BITS)
+		words[numWords - 1] &= ((size_t)1 << (numBits % FMI2_XML_Q_WORD_BITS)) - 1;
+}
+
+jm_status_enu_t fmi2_xml_query_evaluate(fmi2_xml_query_t* q, fmi2_xml_model_description_t* md, fmi2_xml_query_mask_ft getMask, void* context, size_t* words) {
+	jm_vector(jm_voidp)* vars = fmi2_xml_get_variables_original_order(md);
+	size_t n = vars ? jm_vector_get_size(jm_voidp)(vars) : 0;
+	size_t numWords = (n + FMI2_XML_Q_WORD_BITS - 1) / FMI2_XML_Q_WORD_BITS;
+	size_t k, i, j, sp = 0, len = jm_vector_get_size(fmi2_xml_q_terminal_t)(&q->program);
+
+	if(md != q->md) {
+		jm_log_error(md->callbacks, module, "The query was compiled for another model description");
+		return jm_status_error;
+	}
+	if(!numWords) return jm_status_success;
+	if(q->numWords != numWords) {
+		md->callbacks->free(q->words);
+		q->words = (size_t*)md->callbacks->malloc(q->depth * numWords * sizeof(size_t));
+		q->numWords = q->words ? numWords : 0;
+		if(!q->words) {
+			jm_log_fatal(md->callbacks, module, "Could not allocate memory");
+			return jm_status_error;
+		}
+	}
+
+	for(k = 0; k < len; k++) {
+		fmi2_xml_q_terminal_t* term = jm_vector_get_itemp(fmi2_xml_q_terminal_t)(&q->program, k);
+		size_t* a = q->words + (sp ? sp - 1 : 0) * numWords;
+		size_t* b = a + numWords;
+		switch(term->kind) {
+		case fmi2_xml_q_term_enu_elementary:
+			{
+				fmi2_xml_query_mask_enu_t attribute;
+				const size_t* mask = 0;
+				int value;
+				size_t* dst = q->words + sp * numWords;
+				if(getMask && fmi2_xml_q_get_mask_attribute(term, &attribute, &value))
+					mask = getMask(context, attribute, value);
+				if(mask)
+					memcpy(dst, mask, numWords * sizeof(size_t));
+				else if(term->specific == fmi2_xml_q_elmentary_enu_name) {
+					memset(dst, 0, numWords * sizeof(size_t));
+					fmi2_xml_q_eval_name_bits(q, term, vars, n, dst);
+				}
+				else {
+					fmi2_xml_q_eval_elementary_ft eval = fmi2_xml_q_eval_elementary_handles[term->specific];
+					memset(dst, 0, numWords * sizeof(size_t));
+					for(j = 0; j < n; j++) {
+						if(eval((fmi2_xml_variable_t*)jm_vector_get_item(jm_voidp)(vars, j), term))
+							dst[j / FMI2_XML_Q_WORD_BITS] |= (size_t)1 << (j % FMI2_XML_Q_WORD_BITS);
+					}
+				}
+				sp++;
+			}
+			break;
+		case fmi2_xml_q_term_enu_TRUE:
+			a = q->words + sp * numWords;
+			memset(a, 0xFF, numWords * sizeof(size_t));
+			fmi2_xml_q_clear_tail(a, numWords, n);
+			sp++;
+			break;
+		case fmi2_xml_q_term_enu_AND:
+			a -= numWords;
+			b -= numWords;
+			for(i = 0; i < numWords; i++) a[i] &= b[i];
+			sp--;
+			break;
+		case fmi2_xml_q_term_enu_OR:
+			a -= numWords;
+			b -= numWords;
+			for(i = 0; i < numWords; i++) a[i] |= b[i];
+			sp--;
+			break;
+		case fmi2_xml_q_term_enu_NOT:
+			for(i = 0; i < numWords; i++) a[i] = ~a[i];
+			fmi2_xml_q_clear_tail(a, numWords, n);
+			break;
+		default:
+			assert(0);
+		}
+	}
+	assert(sp == 1);
+	memcpy(words, q->words, numWords * sizeof(size_t));
+	return jm_status_success;
 }
 
 #define JM_TEMPLATE_INSTANCE_TYPE fmi2_xml_q_terminal_t
-#include "jm_vector_template.h"
+#include "JM/jm_vector_template.h"
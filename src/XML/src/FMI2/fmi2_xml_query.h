@@ -15,8 +15,8 @@
 #ifndef FMI2_XML_QUERY_H
 #define FMI2_XML_QUERY_H
 
-#include <jm_vector.h>
-#include <jm_stack.h>
+#include <JM/jm_vector.h>
+#include <FMI2/fmi2_xml_model_description.h>
 #include <FMI2/fmi2_xml_variable.h>
 #ifdef __cplusplus
 extern "C" {
@@ -28,33 +28,50 @@ extern "C" {
                   | query 'or' query
                   | query 'and' query
                   | 'not' query
-  elementary_query =  "name" '=' <string>
-                    | "quantity" '=' <string>
-                    | "basetype" '=' (real| integer | enumeration |boolean |string)
-                    | "type" '=' <string>
-                    | "unit" '=' <string>
-                    | "displayUnit" '=' <string>
-                    | "fixed" '=' ("true"|"false")
-                    | "hasStart" '='  ("true"|"false")
-                    | "isAlias"
-                    | "alias" '=' ['-']<variable name> (negative value for negated-aliases)
-
-Example: "name='a.*' & fixed=false"
+                  | <empty> (selects all the variables)
+  elementary_query =  "name" op <string>
+                    | "quantity" op <string>
+                    | "basetype" op (real| integer | enumeration |boolean |string)
+                    | "type" op <string>
+                    | "unit" op <string>
+                    | "displayUnit" op <string>
+                    | "hasStart" [op ("true"|"false")]
+                    | "isAlias" [op ("true"|"false")]
+                    | "alias" op <variable name> (the variable and its aliases)
+                    | "causality" op <causality>
+                    | "variability" op <variability>
+                    | "initial" op <initial>
+  op = '=' | '!='
+
+Keywords and enumeration values are case insensitive. 'and', 'or' and 'not' may also be
+written as '&&', '||' and '!'. Strings are quoted with ' or " or are written without quotes
+if they contain no spaces, parentheses or operator characters. String comparisons are exact
+unless the string contains the wildcards '*' or '?'. Names are hierarchical: '*' does not
+match '.' but '**' does, and subscripts may have ranges, see fmi2_xml_match_variable_name().
+Name queries only visit the variables with the literal prefix of the pattern.
+The FMI 1.0 "fixed" attribute does not exist in FMI 2.0 and is not supported.
+
+Example: "name='a.*' and causality=output"
+
+A query is compiled into a flat postfix program of fmi2_xml_q_terminal_t items. Negations
+('!=', "hasStart=false") are compiled into an elementary term followed by NOT so that the
+elementary terms on causality, variability, initial, base type, alias kind and start value can
+be evaluated with precomputed masks, see fmi2_xml_query_evaluate().
 */
 
 #define FMI2_XML_Q_ELEMENTARY(HANDLE) \
     HANDLE(name) \
-    HANDLE(unit) \
-
-/*
-    HANDLE(type) \
-    HANDLE(fixed) \
-    HANDLE(hasstart) \
-    HANDLE(isalias) 
-    HANDLE(alias)
+    HANDLE(quantity) \
     HANDLE(basetype) \
+    HANDLE(type) \
+    HANDLE(unit) \
     HANDLE(displayunit) \
-*/
+    HANDLE(hasstart) \
+    HANDLE(isalias) \
+    HANDLE(alias) \
+    HANDLE(causality) \
+    HANDLE(variability) \
+    HANDLE(initial)
 
 typedef enum fmi2_xml_elementary_enu_t {
 #define FMI2_XML_Q_ELEMENTARY_PREFIX(elem) fmi2_xml_q_elmentary_enu_##elem,
@@ -65,9 +82,10 @@ typedef enum fmi2_xml_elementary_enu_t {
 typedef struct fmi2_xml_q_context_t fmi2_xml_q_context_t;
 typedef struct fmi2_xml_q_terminal_t fmi2_xml_q_terminal_t;
 
-typedef int (*fmi2_xml_q_scan_elementary_ft)(fmi2_xml_q_context_t*, fmi2_xml_q_terminal_t* term);
+/* Scan the value of an elementary query. Returns 0 on success and -1 if the value is not valid. */
+typedef int (*fmi2_xml_q_scan_elementary_ft)(fmi2_xml_q_context_t*, fmi2_xml_q_terminal_t* term, const char* value, size_t len);
 
-#define FMI2_XML_Q_ELEMENTARY_DECLARE_SCAN(name) int fmi2_xml_q_scan_elementary_##name(fmi2_xml_q_context_t*, fmi2_xml_q_terminal_t* term);
+#define FMI2_XML_Q_ELEMENTARY_DECLARE_SCAN(name) int fmi2_xml_q_scan_elementary_##name(fmi2_xml_q_context_t*, fmi2_xml_q_terminal_t* term, const char* value, size_t len);
 FMI2_XML_Q_ELEMENTARY(FMI2_XML_Q_ELEMENTARY_DECLARE_SCAN)
 
 
@@ -85,7 +103,10 @@ typedef enum fmi2_xml_q_term_enu_t {
 	fmi2_xml_q_term_enu_NOT,
 	fmi2_xml_q_term_enu_END,
 	fmi2_xml_q_term_enu_TRUE,
-	fmi2_xml_q_term_enu_FALSE
+	fmi2_xml_q_term_enu_FALSE,
+	fmi2_xml_q_term_enu_EQ,
+	fmi2_xml_q_term_enu_NE,
+	fmi2_xml_q_term_enu_VALUE
 } fmi2_xml_q_terminal_enu_t;
 
 
@@ -94,46 +115,56 @@ struct fmi2_xml_q_terminal_t {
 
 	fmi2_xml_elementary_enu_t specific;
 
-	int param_i;
-	double param_d;
-	void* param_p;
+	int param_i;   /* enumeration or boolean value, string length (negative for wildcards) */
+	void* param_p; /* variable for "alias" */
 	char* param_str;
-
 };
 
 jm_vector_declare_template(fmi2_xml_q_terminal_t)
 
 typedef jm_vector(fmi2_xml_q_terminal_t) fmi2_xml_q_term_vt;
 
-typedef struct fmi2_xml_q_expression_t fmi2_xml_q_expression_t;
+/* Compiled query */
+struct fmi2_xml_query_t {
+	fmi2_xml_model_description_t* md;
+
+	/* Postfix program */
+	fmi2_xml_q_term_vt program;
 
-struct fmi2_xml_q_expression_t {
-    jm_vector(jm_voidp) expression;
+	/* Maximum depth of the evaluation stack */
+	size_t depth;
 
-    jm_vector(jm_voidp) stack;
+	/* Evaluation stack for single variables */
+	int* values;
 
-    fmi2_xml_q_terminal_t termFalse, termTrue;
-    fmi2_xml_q_term_vt terms;
-	jm_vector(char) strbuf;
+	/* Evaluation stack of bitsets, allocated on the first call to fmi2_xml_query_evaluate() */
+	size_t* words;
+	size_t numWords;
+
+	/* Strings of the elementary queries, one block of the query length */
+	char* strbuf;
+	size_t strlen;
 };
 
+/* Parsing context */
 struct fmi2_xml_q_context_t {
-    jm_vector(jm_name_ID_map_t) elementary_map;
+	jm_callbacks* cb;
 
-	jm_string query;
+	fmi2_xml_query_t* query;
 
-	size_t qlen;
-	int curCh;
+	jm_string str;
 
-	jm_vector(char) buf;
+	/* Current token */
+	fmi2_xml_q_terminal_enu_t tok;
+	size_t tokStart;
+	size_t tokLen;
 
-	fmi2_xml_q_expression_t expr;
-};
+	/* Position after the current token */
+	size_t curCh;
 
-void fmi2_xml_q_init_context(fmi2_xml_q_context_t*, jm_callbacks* cb);
-void fmi2_xml_q_free_context_data(fmi2_xml_q_context_t*);
-int fmi2_xml_q_filter_variable(fmi2_xml_variable_t* var, fmi2_xml_q_expression_t* );
-int fmi2_xml_q_parse_query(fmi2_xml_q_context_t* context, jm_string query);
+	/* Current depth of the evaluation stack */
+	size_t depth;
+};
 
 #ifdef __cplusplus
 }
@@ -17,6 +17,7 @@
 #include <stdio.h>
 
 #include <JM/jm_vector.h>
+#include <JM/jm_trace.h>
 
 #include "fmi2_xml_parser.h"
 #include "fmi2_xml_type_impl.h"
@@ -927,6 +928,7 @@ int fmi2_xml_handle_ModelVariables(fmi2_xml_parser_context_t *context, const cha
             }
         }
 
+        jm_trace_begin("fmilib", "Resolve aliases");
         /* sort the variables by names */
         jm_vector_qsort(jm_named_ptr)(&md->variablesByName,jm_compare_named);
 
@@ -946,6 +948,7 @@ int fmi2_xml_handle_ModelVariables(fmi2_xml_parser_context_t *context, const cha
         md->status = fmi2_xml_model_description_enu_empty;
 		if(!md->variablesByVR || !md->variablesOrigOrder) {
             fmi2_xml_parse_fatal(context, "Could not allocate memory");
+            jm_trace_end("fmilib", "Resolve aliases");
             return -1;
         }
         varByVR = md->variablesByVR;
@@ -996,6 +999,8 @@ int fmi2_xml_handle_ModelVariables(fmi2_xml_parser_context_t *context, const cha
                 }
             } while(foundBadAlias);
         }
+        fmi2_xml_build_vr_index(md);
+        jm_trace_end("fmilib", "Resolve aliases");
 
         numvar = jm_vector_get_size(jm_named_ptr)(&md->variablesByName);
 